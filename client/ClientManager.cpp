@@ -55,6 +55,10 @@ void ClientHandle::commit(const commitmanager::SnapshotDescriptor& snapshot) {
     mProcessor.commit(mFiber, snapshot);
 }
 
+void ClientHandle::abort(const commitmanager::SnapshotDescriptor& snapshot) {
+    mProcessor.abort(mFiber, snapshot);
+}
+
 Table ClientHandle::createTable(const crossbow::string& name, Schema schema) {
     return mProcessor.createTable(mFiber, name, std::move(schema));
 }
@@ -81,6 +85,21 @@ std::shared_ptr<GetResponse> ClientHandle::get(const Table& table, uint64_t key,
     return mProcessor.get(mFiber, table.tableId(), key, snapshot);
 }
 
+std::vector<std::shared_ptr<MultiGetResponse>> ClientHandle::multiGet(const Table& table,
+        const std::vector<uint64_t>& keys) {
+    checkTableType(table, TableType::NON_TRANSACTIONAL);
+
+    auto snapshot = createNonTransactionalSnapshot(std::numeric_limits<uint64_t>::max());
+    return mProcessor.multiGet(mFiber, table.tableId(), keys, *snapshot);
+}
+
+std::vector<std::shared_ptr<MultiGetResponse>> ClientHandle::multiGet(const Table& table,
+        const std::vector<uint64_t>& keys, const commitmanager::SnapshotDescriptor& snapshot) {
+    checkTableType(table, TableType::TRANSACTIONAL);
+
+    return mProcessor.multiGet(mFiber, table.tableId(), keys, snapshot);
+}
+
 std::shared_ptr<ModificationResponse> ClientHandle::insert(const Table& table, uint64_t key, uint64_t version,
         GenericTuple data) {
     GenericTupleSerializer tuple(table.record(), std::move(data));
@@ -156,13 +175,41 @@ std::shared_ptr<ModificationResponse> ClientHandle::revert(const Table& table, u
     return mProcessor.revert(mFiber, table.tableId(), key, snapshot);
 }
 
+std::vector<std::shared_ptr<BatchWriteResponse>> ClientHandle::batchWrite(
+        const std::vector<BatchWriteOperation>& batch, const commitmanager::SnapshotDescriptor& snapshot) {
+    return mProcessor.batchWrite(mFiber, batch, snapshot);
+}
+
+std::vector<std::shared_ptr<IndexScanResponse>> ClientHandle::indexScan(const Table& table,
+        const crossbow::string& indexName, const GenericTuple& lower, const GenericTuple& upper) {
+    checkTableType(table, TableType::NON_TRANSACTIONAL);
+
+    auto snapshot = createNonTransactionalSnapshot(std::numeric_limits<uint64_t>::max());
+    return indexScan(table, indexName, lower, upper, *snapshot);
+}
+
+std::vector<std::shared_ptr<IndexScanResponse>> ClientHandle::indexScan(const Table& table,
+        const crossbow::string& indexName, const GenericTuple& lower, const GenericTuple& upper,
+        const commitmanager::SnapshotDescriptor& snapshot) {
+    // Bounds of an unknown index are left empty, the request will be rejected by the storage
+    auto& indexes = table.record().schema().indexes();
+    auto i = indexes.find(indexName);
+    std::string lowerKey, upperKey;
+    if (i != indexes.end()) {
+        lowerKey = table.record().indexKey(lower, i->second.second);
+        upperKey = table.record().indexKey(upper, i->second.second);
+    }
+    return mProcessor.indexScan(mFiber, table.tableId(), indexName, lowerKey, upperKey, snapshot);
+}
+
 std::shared_ptr<ScanIterator> ClientHandle::scan(const Table& table, const commitmanager::SnapshotDescriptor& snapshot,
         ScanMemoryManager& memoryManager, ScanQueryType queryType, uint32_t selectionLength, const char* selection,
-        uint32_t queryLength, const char* query) {
+        uint32_t queryLength, const char* query, uint64_t lowKey, uint64_t highKey, uint64_t limit, ScanOrder order,
+        uint16_t orderField) {
     checkTableType(table, TableType::TRANSACTIONAL);
 
     return mProcessor.scan(mFiber, table.tableId(), snapshot, table.record(), memoryManager, queryType, selectionLength,
-            selection, queryLength, query);
+            selection, queryLength, query, lowKey, highKey, limit, order, orderField);
 }
 
 BaseClientProcessor::BaseClientProcessor(crossbow::infinio::InfinibandService& service, const ClientConfig& config,
@@ -203,6 +250,30 @@ std::unique_ptr<commitmanager::SnapshotDescriptor> BaseClientProcessor::start(cr
 void BaseClientProcessor::commit(crossbow::infinio::Fiber& fiber, const commitmanager::SnapshotDescriptor& snapshot) {
     // TODO Return a commit future?
 
+    // The servers only release the transaction's resources so the commit manager does not have to wait for them
+    auto requests = completeTransaction(fiber, snapshot, true);
+
+    auto commitResponse = mCommitManagerSocket.commitTransaction(fiber, snapshot.version());
+    for (auto& i : requests) {
+        if (!i->waitForResult()) {
+            LOG_ERROR("Error while completing transaction on server [error = %1% %2%]", i->error(),
+                    i->error().message());
+        }
+    }
+    if (!commitResponse->get()) {
+        throw std::runtime_error("Commit transaction did not succeed");
+    }
+}
+
+void BaseClientProcessor::abort(crossbow::infinio::Fiber& fiber, const commitmanager::SnapshotDescriptor& snapshot) {
+    // All writes have to be reverted before the transaction is marked as completed in the commit manager
+    auto requests = completeTransaction(fiber, snapshot, false);
+    for (auto& i : requests) {
+        if (!i->waitForResult()) {
+            throw std::system_error(i->error());
+        }
+    }
+
     auto commitResponse = mCommitManagerSocket.commitTransaction(fiber, snapshot.version());
     if (!commitResponse->get()) {
         throw std::runtime_error("Commit transaction did not succeed");
@@ -225,10 +296,67 @@ Table BaseClientProcessor::createTable(crossbow::infinio::Fiber& fiber, const cr
     return Table(tableId, name, std::move(schema));
 }
 
+std::vector<std::shared_ptr<MultiGetResponse>> BaseClientProcessor::multiGet(crossbow::infinio::Fiber& fiber,
+        uint64_t tableId, const std::vector<uint64_t>& keys, const commitmanager::SnapshotDescriptor& snapshot) {
+    std::vector<std::vector<uint64_t>> shardKeys(mTellStoreSocket.size());
+    for (auto key : keys) {
+        shardKeys[key % mTellStoreSocket.size()].emplace_back(key);
+    }
+
+    std::vector<std::shared_ptr<MultiGetResponse>> requests;
+    for (decltype(shardKeys.size()) i = 0; i < shardKeys.size(); ++i) {
+        if (shardKeys[i].empty()) {
+            continue;
+        }
+        requests.emplace_back(mTellStoreSocket[i]->multiGet(fiber, tableId, std::move(shardKeys[i]), snapshot));
+    }
+    return requests;
+}
+
+std::vector<std::shared_ptr<BatchWriteResponse>> BaseClientProcessor::batchWrite(crossbow::infinio::Fiber& fiber,
+        const std::vector<BatchWriteOperation>& batch, const commitmanager::SnapshotDescriptor& snapshot) {
+    std::vector<std::vector<size_t>> shardOperations(mTellStoreSocket.size());
+    for (decltype(batch.size()) i = 0; i < batch.size(); ++i) {
+        shardOperations[batch[i].key % mTellStoreSocket.size()].emplace_back(i);
+    }
+
+    std::vector<std::shared_ptr<BatchWriteResponse>> requests;
+    for (decltype(shardOperations.size()) i = 0; i < shardOperations.size(); ++i) {
+        if (shardOperations[i].empty()) {
+            continue;
+        }
+        requests.emplace_back(mTellStoreSocket[i]->batchWrite(fiber, batch, std::move(shardOperations[i]), snapshot));
+    }
+    return requests;
+}
+
+std::vector<std::shared_ptr<CommitResponse>> BaseClientProcessor::completeTransaction(
+        crossbow::infinio::Fiber& fiber, const commitmanager::SnapshotDescriptor& snapshot, bool commit) {
+    std::vector<std::shared_ptr<CommitResponse>> requests;
+    for (auto& socket : mTellStoreSocket) {
+        if (auto response = socket->commit(fiber, snapshot, commit)) {
+            requests.emplace_back(std::move(response));
+        }
+    }
+    return requests;
+}
+
+std::vector<std::shared_ptr<IndexScanResponse>> BaseClientProcessor::indexScan(crossbow::infinio::Fiber& fiber,
+        uint64_t tableId, const crossbow::string& indexName, const std::string& lower, const std::string& upper,
+        const commitmanager::SnapshotDescriptor& snapshot) {
+    // The records are partitioned by key so every shard has to scan its part of the index
+    std::vector<std::shared_ptr<IndexScanResponse>> requests;
+    requests.reserve(mTellStoreSocket.size());
+    for (auto& socket : mTellStoreSocket) {
+        requests.emplace_back(socket->indexScan(fiber, tableId, indexName, lower, upper, snapshot));
+    }
+    return requests;
+}
+
 std::shared_ptr<ScanIterator> BaseClientProcessor::scan(crossbow::infinio::Fiber& fiber, uint64_t tableId,
         const commitmanager::SnapshotDescriptor& snapshot, Record record, ScanMemoryManager& memoryManager,
         ScanQueryType queryType, uint32_t selectionLength, const char* selection, uint32_t queryLength,
-        const char* query) {
+        const char* query, uint64_t lowKey, uint64_t highKey, uint64_t limit, ScanOrder order, uint16_t orderField) {
     auto scanId = ++mScanId;
 
     auto iterator = std::make_shared<ScanIterator>(fiber, std::move(record), mTellStoreSocket.size());
@@ -243,7 +371,7 @@ std::shared_ptr<ScanIterator> BaseClientProcessor::scan(crossbow::infinio::Fiber
         iterator->addScanResponse(response);
 
         socket->scanStart(scanId, std::move(response), tableId, queryType, selectionLength, selection, queryLength,
-                query, snapshot);
+                query, lowKey, highKey, limit, order, orderField, snapshot);
     }
     return iterator;
 }
@@ -35,12 +35,23 @@ namespace tell {
 namespace store {
 namespace {
 
-void writeSnapshot(crossbow::buffer_writer& message, const commitmanager::SnapshotDescriptor& snapshot) {
-    // TODO Implement snapshot caching
-    message.write<uint8_t>(0x0u); // Cached
-    message.write<uint8_t>(0x1u); // HasDescriptor
+/**
+ * @brief Length of the snapshot in the request (without the 8 byte header containing the cache flags)
+ */
+uint32_t snapshotLength(const commitmanager::SnapshotDescriptor& snapshot, bool sendDescriptor) {
+    return sizeof(uint64_t) + (sendDescriptor ? sizeof(uint64_t) + snapshot.serializedLength() : 0u);
+}
+
+void writeSnapshot(crossbow::buffer_writer& message, const commitmanager::SnapshotDescriptor& snapshot,
+        bool sendDescriptor) {
+    message.write<uint8_t>(0x1u); // Cached
+    message.write<uint8_t>(sendDescriptor ? 0x1u : 0x0u); // HasDescriptor
     message.align(sizeof(uint64_t));
-    snapshot.serialize(message);
+    message.write<uint64_t>(snapshot.version());
+    if (sendDescriptor) {
+        message.write<uint64_t>(snapshot.serializedLength());
+        snapshot.serialize(message);
+    }
 }
 
 } // anonymous namespace
@@ -82,10 +93,66 @@ void GetResponse::processResponse(crossbow::buffer_reader& message) {
     setResult(Tuple::deserialize(message));
 }
 
+void MultiGetResponse::processResponse(crossbow::buffer_reader& message) {
+    std::vector<std::tuple<std::error_code, std::unique_ptr<Tuple>>> result;
+
+    auto resultSize = message.read<uint64_t>();
+    LOG_ASSERT(resultSize == mKeys.size(), "Number of results does not match number of requested keys");
+    result.reserve(resultSize);
+
+    for (decltype(resultSize) i = 0; i < resultSize; ++i) {
+        auto ec = message.read<uint16_t>();
+        message.align(sizeof(uint64_t));
+        if (ec != 0u) {
+            result.emplace_back(std::error_code(ec, error::get_error_category()), nullptr);
+            continue;
+        }
+
+        result.emplace_back(std::error_code(), Tuple::deserialize(message));
+        message.align(sizeof(uint64_t));
+    }
+
+    setResult(std::move(result));
+}
+
 void ModificationResponse::processResponse(crossbow::buffer_reader& /* message */) {
     // Nothing to do
 }
 
+void CommitResponse::processResponse(crossbow::buffer_reader& /* message */) {
+    // Nothing to do
+}
+
+void BatchWriteResponse::processResponse(crossbow::buffer_reader& message) {
+    std::vector<std::error_code> result;
+
+    auto resultSize = message.read<uint64_t>();
+    LOG_ASSERT(resultSize == mOperations.size(), "Number of results does not match number of modifications");
+    result.reserve(resultSize);
+
+    for (decltype(resultSize) i = 0; i < resultSize; ++i) {
+        auto ec = message.read<uint16_t>();
+        result.emplace_back(ec == 0u ? std::error_code() : std::error_code(ec, error::get_error_category()));
+    }
+
+    setResult(std::move(result));
+}
+
+void IndexScanResponse::processResponse(crossbow::buffer_reader& message) {
+    std::vector<std::tuple<uint64_t, std::unique_ptr<Tuple>>> result;
+
+    auto resultSize = message.read<uint64_t>();
+    result.reserve(resultSize);
+
+    for (decltype(resultSize) i = 0; i < resultSize; ++i) {
+        auto key = message.read<uint64_t>();
+        result.emplace_back(key, Tuple::deserialize(message));
+        message.align(sizeof(uint64_t));
+    }
+
+    setResult(std::move(result));
+}
+
 ScanResponse::ScanResponse(crossbow::infinio::Fiber& fiber, std::shared_ptr<ScanIterator> iterator,
         ClientSocket& socket, ScanMemory memory, uint16_t scanId)
         : crossbow::infinio::RpcResponse(fiber),
@@ -307,13 +374,33 @@ std::shared_ptr<GetResponse> ClientSocket::get(crossbow::infinio::Fiber& fiber,
         const commitmanager::SnapshotDescriptor& snapshot) {
     auto response = std::make_shared<GetResponse>(fiber);
 
-    uint32_t messageLength = 3 * sizeof(uint64_t) + snapshot.serializedLength();
+    auto sendDescriptor = cacheSnapshot(snapshot);
+    uint32_t messageLength = 3 * sizeof(uint64_t) + snapshotLength(snapshot, sendDescriptor);
 
-    sendRequest(response, RequestType::GET, messageLength, [tableId, key, &snapshot]
+    sendRequest(response, RequestType::GET, messageLength, [tableId, key, &snapshot, sendDescriptor]
             (crossbow::buffer_writer& message, std::error_code& /* ec */) {
         message.write<uint64_t>(tableId);
         message.write<uint64_t>(key);
-        writeSnapshot(message, snapshot);
+        writeSnapshot(message, snapshot, sendDescriptor);
+    });
+
+    return response;
+}
+
+std::shared_ptr<MultiGetResponse> ClientSocket::multiGet(crossbow::infinio::Fiber& fiber, uint64_t tableId,
+        std::vector<uint64_t> keys, const commitmanager::SnapshotDescriptor& snapshot) {
+    auto response = std::make_shared<MultiGetResponse>(fiber, std::move(keys));
+    auto& requestKeys = response->keys();
+
+    auto sendDescriptor = cacheSnapshot(snapshot);
+    uint32_t messageLength = (3 + requestKeys.size()) * sizeof(uint64_t) + snapshotLength(snapshot, sendDescriptor);
+
+    sendRequest(response, RequestType::MULTI_GET, messageLength, [tableId, &requestKeys, &snapshot, sendDescriptor]
+            (crossbow::buffer_writer& message, std::error_code& /* ec */) {
+        message.write<uint64_t>(tableId);
+        message.write<uint64_t>(requestKeys.size());
+        message.write(reinterpret_cast<const char*>(requestKeys.data()), requestKeys.size() * sizeof(uint64_t));
+        writeSnapshot(message, snapshot, sendDescriptor);
     });
 
     return response;
@@ -326,9 +413,10 @@ std::shared_ptr<ModificationResponse> ClientSocket::insert(crossbow::infinio::Fi
     auto tupleLength = tuple.size();
     LOG_ASSERT(tupleLength % 8 == 0, "Data must be 8 byte padded");
 
-    uint32_t messageLength = 4 * sizeof(uint64_t) + tupleLength + snapshot.serializedLength();
-    sendRequest(response, RequestType::INSERT, messageLength, [tableId, key, tupleLength, &tuple, &snapshot]
-            (crossbow::buffer_writer& message, std::error_code& /* ec */) {
+    auto sendDescriptor = cacheSnapshot(snapshot);
+    uint32_t messageLength = 4 * sizeof(uint64_t) + tupleLength + snapshotLength(snapshot, sendDescriptor);
+    sendRequest(response, RequestType::INSERT, messageLength, [tableId, key, tupleLength, &tuple, &snapshot,
+            sendDescriptor] (crossbow::buffer_writer& message, std::error_code& /* ec */) {
         message.write<uint64_t>(tableId);
         message.write<uint64_t>(key);
 
@@ -337,7 +425,7 @@ std::shared_ptr<ModificationResponse> ClientSocket::insert(crossbow::infinio::Fi
         tuple.serialize(message.data());
         message.advance(tupleLength);
 
-        writeSnapshot(message, snapshot);
+        writeSnapshot(message, snapshot, sendDescriptor);
     });
 
     return response;
@@ -350,9 +438,10 @@ std::shared_ptr<ModificationResponse> ClientSocket::update(crossbow::infinio::Fi
     auto tupleLength = tuple.size();
     LOG_ASSERT(tupleLength % 8 == 0, "Data must be 8 byte padded");
 
-    uint32_t messageLength = 4 * sizeof(uint64_t) + tupleLength + snapshot.serializedLength();
-    sendRequest(response, RequestType::UPDATE, messageLength, [tableId, key, tupleLength, &tuple, &snapshot]
-            (crossbow::buffer_writer& message, std::error_code& /* ec */) {
+    auto sendDescriptor = cacheSnapshot(snapshot);
+    uint32_t messageLength = 4 * sizeof(uint64_t) + tupleLength + snapshotLength(snapshot, sendDescriptor);
+    sendRequest(response, RequestType::UPDATE, messageLength, [tableId, key, tupleLength, &tuple, &snapshot,
+            sendDescriptor] (crossbow::buffer_writer& message, std::error_code& /* ec */) {
         message.write<uint64_t>(tableId);
         message.write<uint64_t>(key);
 
@@ -361,7 +450,7 @@ std::shared_ptr<ModificationResponse> ClientSocket::update(crossbow::infinio::Fi
         tuple.serialize(message.data());
         message.advance(tupleLength);
 
-        writeSnapshot(message, snapshot);
+        writeSnapshot(message, snapshot, sendDescriptor);
     });
 
     return response;
@@ -371,13 +460,14 @@ std::shared_ptr<ModificationResponse> ClientSocket::remove(crossbow::infinio::Fi
         uint64_t key, const commitmanager::SnapshotDescriptor& snapshot) {
     auto response = std::make_shared<ModificationResponse>(fiber);
 
-    uint32_t messageLength = 3 * sizeof(uint64_t) + snapshot.serializedLength();
+    auto sendDescriptor = cacheSnapshot(snapshot);
+    uint32_t messageLength = 3 * sizeof(uint64_t) + snapshotLength(snapshot, sendDescriptor);
 
-    sendRequest(response, RequestType::REMOVE, messageLength, [tableId, key, &snapshot]
+    sendRequest(response, RequestType::REMOVE, messageLength, [tableId, key, &snapshot, sendDescriptor]
             (crossbow::buffer_writer& message, std::error_code& /* ec */) {
         message.write<uint64_t>(tableId);
         message.write<uint64_t>(key);
-        writeSnapshot(message, snapshot);
+        writeSnapshot(message, snapshot, sendDescriptor);
     });
 
     return response;
@@ -387,13 +477,90 @@ std::shared_ptr<ModificationResponse> ClientSocket::revert(crossbow::infinio::Fi
         uint64_t key, const commitmanager::SnapshotDescriptor& snapshot) {
     auto response = std::make_shared<ModificationResponse>(fiber);
 
-    uint32_t messageLength = 3 * sizeof(uint64_t) + snapshot.serializedLength();
+    auto sendDescriptor = cacheSnapshot(snapshot);
+    uint32_t messageLength = 3 * sizeof(uint64_t) + snapshotLength(snapshot, sendDescriptor);
 
-    sendRequest(response, RequestType::REVERT, messageLength, [table, key, &snapshot]
+    sendRequest(response, RequestType::REVERT, messageLength, [table, key, &snapshot, sendDescriptor]
             (crossbow::buffer_writer& message, std::error_code& /* ec */) {
         message.write<uint64_t>(table);
         message.write<uint64_t>(key);
-        writeSnapshot(message, snapshot);
+        writeSnapshot(message, snapshot, sendDescriptor);
+    });
+
+    return response;
+}
+
+std::shared_ptr<BatchWriteResponse> ClientSocket::batchWrite(crossbow::infinio::Fiber& fiber,
+        const std::vector<BatchWriteOperation>& batch, std::vector<size_t> operations,
+        const commitmanager::SnapshotDescriptor& snapshot) {
+    auto response = std::make_shared<BatchWriteResponse>(fiber, std::move(operations));
+    auto& requestOperations = response->operations();
+
+    auto sendDescriptor = cacheSnapshot(snapshot);
+    uint32_t messageLength = 2 * sizeof(uint64_t) + snapshotLength(snapshot, sendDescriptor);
+    for (auto i : requestOperations) {
+        auto& op = batch[i];
+        messageLength += 3 * sizeof(uint64_t);
+        if (op.tuple) {
+            auto tupleLength = op.tuple->size();
+            LOG_ASSERT(tupleLength % 8 == 0, "Data must be 8 byte padded");
+            messageLength += tupleLength;
+        }
+    }
+
+    sendRequest(response, RequestType::BATCH_WRITE, messageLength, [&batch, &requestOperations, &snapshot,
+            sendDescriptor] (crossbow::buffer_writer& message, std::error_code& /* ec */) {
+        message.write<uint64_t>(requestOperations.size());
+        for (auto i : requestOperations) {
+            auto& op = batch[i];
+            message.write<uint64_t>(op.tableId);
+            message.write<uint64_t>(op.key);
+            message.write<uint8_t>(crossbow::to_underlying(op.type));
+            message.set(0, sizeof(uint32_t) - sizeof(uint8_t));
+
+            auto tupleLength = (op.tuple ? op.tuple->size() : 0u);
+            message.write<uint32_t>(tupleLength);
+            if (tupleLength != 0u) {
+                op.tuple->serialize(message.data());
+                message.advance(tupleLength);
+            }
+        }
+        writeSnapshot(message, snapshot, sendDescriptor);
+    });
+
+    return response;
+}
+
+std::shared_ptr<IndexScanResponse> ClientSocket::indexScan(crossbow::infinio::Fiber& fiber, uint64_t tableId,
+        const crossbow::string& indexName, const std::string& lower, const std::string& upper,
+        const commitmanager::SnapshotDescriptor& snapshot) {
+    auto response = std::make_shared<IndexScanResponse>(fiber);
+
+    auto sendDescriptor = cacheSnapshot(snapshot);
+    uint32_t messageLength = sizeof(uint64_t);
+    messageLength += crossbow::align(sizeof(uint32_t) + indexName.size(), sizeof(uint32_t));
+    messageLength += crossbow::align(sizeof(uint32_t) + lower.size(), sizeof(uint32_t));
+    messageLength += sizeof(uint32_t) + upper.size();
+    messageLength = crossbow::align(messageLength, sizeof(uint64_t));
+    messageLength += sizeof(uint64_t) + snapshotLength(snapshot, sendDescriptor);
+
+    sendRequest(response, RequestType::INDEX_SCAN, messageLength, [tableId, &indexName, &lower, &upper, &snapshot,
+            sendDescriptor] (crossbow::buffer_writer& message, std::error_code& /* ec */) {
+        message.write<uint64_t>(tableId);
+
+        message.write<uint32_t>(indexName.size());
+        message.write(indexName.data(), indexName.size());
+        message.align(sizeof(uint32_t));
+
+        message.write<uint32_t>(lower.size());
+        message.write(lower.data(), lower.size());
+        message.align(sizeof(uint32_t));
+
+        message.write<uint32_t>(upper.size());
+        message.write(upper.data(), upper.size());
+        message.align(sizeof(uint64_t));
+
+        writeSnapshot(message, snapshot, sendDescriptor);
     });
 
     return response;
@@ -401,24 +568,33 @@ std::shared_ptr<ModificationResponse> ClientSocket::revert(crossbow::infinio::Fi
 
 void ClientSocket::scanStart(uint16_t scanId, std::shared_ptr<ScanResponse> response, uint64_t tableId,
         ScanQueryType queryType, uint32_t selectionLength, const char* selection, uint32_t queryLength,
-        const char* query, const commitmanager::SnapshotDescriptor& snapshot) {
+        const char* query, uint64_t lowKey, uint64_t highKey, uint64_t limit, ScanOrder order, uint16_t orderField,
+        const commitmanager::SnapshotDescriptor& snapshot) {
     if (!startAsyncRequest(scanId, response)) {
         response->onAbort(error::invalid_scan);
         return;
     }
 
-    uint32_t messageLength = 6 * sizeof(uint64_t) + selectionLength + queryLength;
+    auto sendDescriptor = cacheSnapshot(snapshot);
+    uint32_t messageLength = 10 * sizeof(uint64_t) + selectionLength + queryLength;
     messageLength = crossbow::align(messageLength, sizeof(uint64_t));
-    messageLength += sizeof(uint64_t) + snapshot.serializedLength();
+    messageLength += sizeof(uint64_t) + snapshotLength(snapshot, sendDescriptor);
 
     sendAsyncRequest(scanId, response, RequestType::SCAN, messageLength,
-            [response, tableId, queryType, selectionLength, selection, queryLength, query, &snapshot]
+            [response, tableId, queryType, selectionLength, selection, queryLength, query, lowKey, highKey, limit,
+            order, orderField, &snapshot, sendDescriptor]
             (crossbow::buffer_writer& message, std::error_code& /* ec */) {
         message.write<uint64_t>(tableId);
         message.write<uint8_t>(crossbow::to_underlying(queryType));
 
         auto& memory = response->scanMemory();
         message.set(0, sizeof(uint64_t) - sizeof(uint8_t));
+        message.write<uint64_t>(lowKey);
+        message.write<uint64_t>(highKey);
+        message.write<uint64_t>(limit);
+        message.write<uint16_t>(orderField);
+        message.write<uint8_t>(crossbow::to_underlying(order));
+        message.set(0, sizeof(uint64_t) - sizeof(uint16_t) - sizeof(uint8_t));
         message.write<uint64_t>(reinterpret_cast<uintptr_t>(memory.data()));
         message.write<uint64_t>(memory.length());
         message.write<uint32_t>(memory.key());
@@ -431,8 +607,45 @@ void ClientSocket::scanStart(uint16_t scanId, std::shared_ptr<ScanResponse> resp
         message.write(query, queryLength);
 
         message.align(sizeof(uint64_t));
-        writeSnapshot(message, snapshot);
+        writeSnapshot(message, snapshot, sendDescriptor);
+    });
+}
+
+std::shared_ptr<CommitResponse> ClientSocket::commit(crossbow::infinio::Fiber& fiber,
+        const commitmanager::SnapshotDescriptor& snapshot, bool commit) {
+    // The server releases the snapshot so it has to be sent again in case it is used afterwards
+    if (mCachedSnapshots.erase(snapshot.version()) == 0u) {
+        return nullptr;
+    }
+
+    auto response = std::make_shared<CommitResponse>(fiber);
+
+    uint32_t messageLength = 2 * sizeof(uint64_t);
+
+    sendRequest(response, RequestType::COMMIT, messageLength, [&snapshot, commit]
+            (crossbow::buffer_writer& message, std::error_code& /* ec */) {
+        message.write<uint64_t>(snapshot.version());
+        message.write<uint8_t>(commit ? 0x1u : 0x0u);
+        message.set(0, sizeof(uint64_t) - sizeof(uint8_t));
     });
+
+    return response;
+}
+
+bool ClientSocket::cacheSnapshot(const commitmanager::SnapshotDescriptor& snapshot) {
+    if (!mCachedSnapshots.emplace(snapshot.version()).second) {
+        return false;
+    }
+
+    auto lowestActiveVersion = snapshot.lowestActiveVersion();
+    for (auto i = mCachedSnapshots.begin(); i != mCachedSnapshots.end();) {
+        if (*i < lowestActiveVersion) {
+            i = mCachedSnapshots.erase(i);
+        } else {
+            ++i;
+        }
+    }
+    return true;
 }
 
 void ClientSocket::scanProgress(uint16_t scanId, std::shared_ptr<ScanResponse> response, size_t offset) {
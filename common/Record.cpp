@@ -27,7 +27,74 @@
 
 namespace tell {
 namespace store {
+namespace {
 
+template <typename T>
+void appendBigEndian(std::string& key, T value) {
+    for (auto i = sizeof(T); i > 0; --i) {
+        key.push_back(static_cast<char>((value >> ((i - 1) * 8)) & 0xFFu));
+    }
+}
+
+/**
+ * @brief Appends the order preserving encoding of the value to the index key
+ *
+ * Integers are written in big endian with flipped sign bit, floating point numbers additionally have all bits
+ * inverted if they are negative. Variable sized values escape every 0x00 byte with 0x00 0xFF and are terminated by
+ * 0x00 0x01 so that a value sorts before all values it is a prefix of.
+ */
+void appendIndexValue(std::string& key, FieldType type, const char* data, size_t size) {
+    key.push_back(static_cast<char>(0x1u));
+    switch (type) {
+    case FieldType::SMALLINT: {
+        uint16_t value;
+        memcpy(&value, data, sizeof(value));
+        appendBigEndian<uint16_t>(key, value ^ 0x8000u);
+    } break;
+
+    case FieldType::INT: {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        appendBigEndian<uint32_t>(key, value ^ 0x80000000u);
+    } break;
+
+    case FieldType::BIGINT: {
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        appendBigEndian<uint64_t>(key, value ^ 0x8000000000000000u);
+    } break;
+
+    case FieldType::FLOAT: {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        appendBigEndian<uint32_t>(key, (value & 0x80000000u) ? ~value : (value | 0x80000000u));
+    } break;
+
+    case FieldType::DOUBLE: {
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        appendBigEndian<uint64_t>(key, (value & 0x8000000000000000u) ? ~value : (value | 0x8000000000000000u));
+    } break;
+
+    case FieldType::TEXT:
+    case FieldType::BLOB: {
+        for (size_t i = 0; i < size; ++i) {
+            key.push_back(data[i]);
+            if (data[i] == '\0') {
+                key.push_back(static_cast<char>(0xFFu));
+            }
+        }
+        key.push_back(static_cast<char>(0x0u));
+        key.push_back(static_cast<char>(0x1u));
+    } break;
+
+    default: {
+        LOG_ASSERT(false, "Unsupported field type in index");
+    } break;
+    }
+}
+
+} // anonymous namespace
 
 Field::Field(Field&& other)
     : FieldBase(other.mType)
@@ -390,5 +457,76 @@ bool Record::idOf(const crossbow::string& name, id_t& result) const {
     return true;
 }
 
+std::string Record::indexKey(const char* ptr, const std::vector<id_t>& fields) const {
+    std::string key;
+    for (auto id : fields) {
+        auto& f = mFieldMetaData.at(id);
+        auto& field = f.field;
+        if (!field.isNotNull() && isFieldNull(ptr, f.nullIdx)) {
+            key.push_back(static_cast<char>(0x0u));
+            continue;
+        }
+
+        auto data = ptr + f.offset;
+        size_t size = field.staticSize();
+        if (!field.isFixedSized()) {
+            auto offset = reinterpret_cast<const uint32_t*>(data);
+            data = ptr + offset[0];
+            size = offset[1] - offset[0];
+        }
+        appendIndexValue(key, field.type(), data, size);
+    }
+    return key;
+}
+
+std::string Record::indexKey(const GenericTuple& tuple, const std::vector<id_t>& fields) const {
+    std::string key;
+    for (auto id : fields) {
+        auto& field = mFieldMetaData.at(id).field;
+        auto iter = tuple.find(field.name());
+        if (iter == tuple.end()) {
+            break;
+        }
+
+        switch (field.type()) {
+        case FieldType::SMALLINT: {
+            auto value = boost::any_cast<int16_t>(iter->second);
+            appendIndexValue(key, field.type(), reinterpret_cast<const char*>(&value), sizeof(value));
+        } break;
+
+        case FieldType::INT: {
+            auto value = boost::any_cast<int32_t>(iter->second);
+            appendIndexValue(key, field.type(), reinterpret_cast<const char*>(&value), sizeof(value));
+        } break;
+
+        case FieldType::BIGINT: {
+            auto value = boost::any_cast<int64_t>(iter->second);
+            appendIndexValue(key, field.type(), reinterpret_cast<const char*>(&value), sizeof(value));
+        } break;
+
+        case FieldType::FLOAT: {
+            auto value = boost::any_cast<float>(iter->second);
+            appendIndexValue(key, field.type(), reinterpret_cast<const char*>(&value), sizeof(value));
+        } break;
+
+        case FieldType::DOUBLE: {
+            auto value = boost::any_cast<double>(iter->second);
+            appendIndexValue(key, field.type(), reinterpret_cast<const char*>(&value), sizeof(value));
+        } break;
+
+        case FieldType::TEXT:
+        case FieldType::BLOB: {
+            auto& value = boost::any_cast<const crossbow::string&>(iter->second);
+            appendIndexValue(key, field.type(), value.data(), value.size());
+        } break;
+
+        default: {
+            LOG_ASSERT(false, "Unsupported field type in index");
+        } break;
+        }
+    }
+    return key;
+}
+
 } // namespace store
 } // namespace tell
@@ -33,6 +33,8 @@
 #include <crossbow/non_copyable.hpp>
 #include <crossbow/string.hpp>
 
+#include <string>
+
 namespace tell {
 namespace commitmanager {
 class SnapshotDescriptor;
@@ -52,16 +54,18 @@ struct DeltaMainRewriteStore : crossbow::non_copyable, crossbow::non_movable {
     }
 
     DeltaMainRewriteStore(const StorageConfig& config)
-        : mPageManager(PageManager::construct(config.totalMemory))
+        : mPageManager(PageManager::construct(config.totalMemory, config.hugePages))
         , tableManager(*mPageManager, config, gc, mVersionManager)
     {
+        tableManager.openRedoLog(config.hashMapCapacity);
     }
 
 
     DeltaMainRewriteStore(const StorageConfig& config, size_t totalMem)
-        : mPageManager(PageManager::construct(totalMem))
+        : mPageManager(PageManager::construct(totalMem, config.hugePages))
         , tableManager(*mPageManager, config, gc, mVersionManager)
     {
+        tableManager.openRedoLog(config.hashMapCapacity);
     }
 
     bool createTable(const crossbow::string &name,
@@ -92,6 +96,13 @@ struct DeltaMainRewriteStore : crossbow::non_copyable, crossbow::non_movable {
         return tableManager.get(tableId, key, snapshot, std::move(fun));
     }
 
+    template <typename Fun, typename ErrorFun>
+    int multiGet(uint64_t tableId, const uint64_t* keys, size_t count,
+            const commitmanager::SnapshotDescriptor& snapshot, Fun fun, ErrorFun errorFun)
+    {
+        return tableManager.multiGet(tableId, keys, count, snapshot, std::move(fun), std::move(errorFun));
+    }
+
     int update(uint64_t tableId, uint64_t key, size_t size, const char* data,
             const commitmanager::SnapshotDescriptor& snapshot)
     {
@@ -114,11 +125,42 @@ struct DeltaMainRewriteStore : crossbow::non_copyable, crossbow::non_movable {
         return tableManager.revert(tableId, key, snapshot);
     }
 
+    void batchWrite(const WriteOperation* operations, size_t count, const commitmanager::SnapshotDescriptor& snapshot,
+            int* results)
+    {
+        tableManager.batchWrite(operations, count, snapshot, results);
+    }
+
+    void syncRedoLog()
+    {
+        tableManager.syncRedoLog();
+    }
+
+    template <typename Fun>
+    int indexScan(uint64_t tableId, const crossbow::string& indexName, const std::string& lower,
+            const std::string& upper, const commitmanager::SnapshotDescriptor& snapshot, Fun fun)
+    {
+        return tableManager.indexScan(tableId, indexName, lower, upper, snapshot, std::move(fun));
+    }
+
     int scan(uint64_t tableId, ScanQuery* query)
     {
         return tableManager.scan(tableId, query);
     }
 
+    /**
+     * @brief The version manager tracking the lowest active version of the storage
+     */
+    const VersionManager& versionManager() const
+    {
+        return mVersionManager;
+    }
+
+    VersionManager& versionManager()
+    {
+        return mVersionManager;
+    }
+
     /**
      * We use this method mostly for test purposes. But
      * it might be handy in the future as well. If possible,
@@ -129,6 +171,14 @@ struct DeltaMainRewriteStore : crossbow::non_copyable, crossbow::non_movable {
         tableManager.forceGC();
     }
 
+    /**
+     * @brief Runs a garbage collection pass and blocks until it finished
+     */
+    void runGC()
+    {
+        tableManager.runGC();
+    }
+
 private:
     PageManager::Ptr mPageManager;
     GC gc;
@@ -63,6 +63,10 @@ const void* InsertTable::get(uint64_t key) const {
     });
 }
 
+void InsertTable::prefetch(uint64_t key) const {
+    __builtin_prefetch(&mBuckets[mHash(key)]);
+}
+
 bool InsertTable::insert(uint64_t key, void* data, void** actualData /* = nullptr */) {
     LOG_ASSERT(data != nullptr, "Data pointer not allowed to be null");
 
@@ -208,6 +212,12 @@ const void* DynamicInsertTable::get(uint64_t key, DynamicInsertTableEntry** head
     return nullptr;
 }
 
+void DynamicInsertTable::prefetch(uint64_t key) const {
+    for (auto currentList = mHeadList.load(); currentList; currentList = currentList->nextList.load()) {
+        currentList->table.prefetch(key);
+    }
+}
+
 bool DynamicInsertTable::insert(uint64_t key, void* data) {
     DynamicInsertTableEntry* headList = nullptr;
     if (get(key, &headList)) {
@@ -66,6 +66,11 @@ public:
      */
     const void* get(uint64_t key) const;
 
+    /**
+     * @brief Issues a prefetch for the first bucket of the key without waiting for it
+     */
+    void prefetch(uint64_t key) const;
+
     /**
      * @brief Tries to insert the element into the hash table
      *
@@ -223,6 +228,11 @@ public:
         return const_cast<void*>(const_cast<const DynamicInsertTable*>(this)->get(key, headList));
     }
 
+    /**
+     * @brief Issues a prefetch for the first bucket of the key in every insert table
+     */
+    void prefetch(uint64_t key) const;
+
     bool insert(uint64_t key, void* data);
 
     bool insert(uint64_t key, void* data, DynamicInsertTableEntry* headList);
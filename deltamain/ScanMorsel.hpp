@@ -0,0 +1,118 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#pragma once
+
+#include <util/Log.hpp>
+#include <util/ScanMorsel.hpp>
+#include <util/ScanQuery.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace tell {
+namespace store {
+namespace deltamain {
+
+/**
+ * @brief Unit of work of a delta-main scan
+ *
+ * Covers a range of pages in the main and a range of entries in the insert log. Either of the two ranges may be empty.
+ */
+struct ScanMorsel {
+    using LogIterator = Log<OrderedLogImpl>::ConstLogIterator;
+
+    ScanMorsel(size_t pageIdx, size_t pageEndIdx, const LogIterator& logIter, const LogIterator& logEnd)
+            : pageIdx(pageIdx),
+              pageEndIdx(pageEndIdx),
+              logIter(logIter),
+              logEnd(logEnd) {
+    }
+
+    /// Index of the first main page in the morsel
+    size_t pageIdx;
+
+    /// Index of the page succeeding the last main page in the morsel
+    size_t pageEndIdx;
+
+    /// Iterator pointing to the first insert log entry in the morsel
+    LogIterator logIter;
+
+    /// Iterator pointing to the first insert log entry not contained in the morsel
+    LogIterator logEnd;
+};
+
+using MorselQueue = ScanMorselQueue<ScanMorsel>;
+
+/**
+ * @brief Key range covering the key ranges of all queries of a shared scan
+ *
+ * Main pages whose key fence does not overlap the range contain no tuple any of the queries is interested in and can
+ * be skipped. The range is unrestricted if any query scans all keys.
+ */
+class ScanKeyRange {
+public:
+    ScanKeyRange(const std::vector<ScanQuery*>& queries)
+            : mRestricted(!queries.empty()),
+              mLowKey(std::numeric_limits<uint64_t>::max()),
+              mHighKey(std::numeric_limits<uint64_t>::min()) {
+        for (auto query : queries) {
+            if (!query->hasKeyRange()) {
+                mRestricted = false;
+                break;
+            }
+            mLowKey = std::min(mLowKey, query->lowKey());
+            mHighKey = std::max(mHighKey, query->highKey());
+        }
+    }
+
+    /**
+     * @brief Whether any query is interested in keys of a page with the given fence
+     *
+     * @param fence Smallest and largest key stored in the page
+     */
+    bool overlaps(const std::pair<uint64_t, uint64_t>& fence) const {
+        if (!mRestricted) {
+            return true;
+        }
+        return (fence.second >= mLowKey && (fence.first < mHighKey || mHighKey == ScanQuery::UNBOUNDED_KEY));
+    }
+
+private:
+    /// Whether all queries are restricted to a key range
+    bool mRestricted;
+
+    /// Smallest lower (inclusive) bound of all queries
+    uint64_t mLowKey;
+
+    /// Largest upper (exclusive) bound of all queries
+    uint64_t mHighKey;
+};
+
+} // namespace deltamain
+} // namespace store
+} // namespace tell
@@ -24,9 +24,14 @@
 #include "Table.hpp"
 
 #include <config.h>
+#include <util/Checkpoint.hpp>
 
 #include <boost/config.hpp>
 
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace tell {
 namespace store {
 namespace deltamain {
@@ -38,6 +43,7 @@ Table<Context>::Table(PageManager& pageManager, const crossbow::string& name, co
     , mTableName(name)
     , mRecord(std::move(schema))
     , mTableId(idx)
+    , mIndexes(mRecord)
     , mInsertTable(insertTableCapacity)
     , mInsertLog(pageManager)
     , mUpdateLog(pageManager)
@@ -62,6 +68,12 @@ Table<Context>::~Table() {
 template <typename Context>
 int Table<Context>::insert(uint64_t key, size_t size, const char* data,
         const commitmanager::SnapshotDescriptor& snapshot) {
+    return internalInsert(key, size, data, snapshot, nullptr);
+}
+
+template <typename Context>
+int Table<Context>::internalInsert(uint64_t key, size_t size, const char* data,
+        const commitmanager::SnapshotDescriptor& snapshot, LogEntry** reserved) {
     int ec;
 
     // Check main
@@ -83,11 +95,17 @@ int Table<Context>::insert(uint64_t key, size_t size, const char* data,
         mInsertTable.remove(key, ptr, insertList);
     }
 
-    // Write into insert log
-    auto logEntry = mInsertLog.append(size + sizeof(InsertLogEntry));
-    if (!logEntry) {
-        LOG_FATAL("Failed to append to log");
-        return error::out_of_memory;
+    // Write into insert log (into the entry reserved by the batch if there is one)
+    LogEntry* logEntry;
+    if (reserved && *reserved) {
+        logEntry = *reserved;
+        *reserved = nullptr;
+    } else {
+        logEntry = mInsertLog.append(size + sizeof(InsertLogEntry));
+        if (!logEntry) {
+            LOG_ERROR("Failed to append to log");
+            return error::out_of_memory;
+        }
     }
     auto insertEntry = new (logEntry->data()) InsertLogEntry(key, snapshot.version());
     memcpy(insertEntry->data(), data, size);
@@ -166,22 +184,102 @@ int Table<Context>::revert(uint64_t key, const commitmanager::SnapshotDescriptor
     return 0;
 }
 
+template <typename Context>
+void Table<Context>::batchWrite(const WriteOperation* operations, size_t count,
+        const commitmanager::SnapshotDescriptor& snapshot, int* results) {
+    // Reserve the entries of all inserts in the insert log and of all updates and removes in the update log
+    std::vector<uint32_t> insertSizes;
+    std::vector<uint32_t> insertTypes;
+    std::vector<uint32_t> updateSizes;
+    std::vector<uint32_t> updateTypes;
+    for (size_t i = 0; i < count; ++i) {
+        auto& op = operations[i];
+        switch (op.type) {
+        case WriteType::INSERT: {
+            insertSizes.emplace_back(op.size + sizeof(InsertLogEntry));
+            insertTypes.emplace_back(0x0u);
+        } break;
+        case WriteType::UPDATE: {
+            updateSizes.emplace_back(op.size + sizeof(UpdateLogEntry));
+            updateTypes.emplace_back(RecordType::DATA);
+        } break;
+        case WriteType::REMOVE: {
+            updateSizes.emplace_back(sizeof(UpdateLogEntry));
+            updateTypes.emplace_back(RecordType::DELETE);
+        } break;
+        default:
+            break;
+        }
+    }
+
+    // Entries that could not be reserved are appended by their modification
+    std::vector<LogEntry*> insertEntries(insertSizes.size(), nullptr);
+    if (!insertSizes.empty()) {
+        mInsertLog.append(insertSizes.data(), insertTypes.data(), insertSizes.size(), insertEntries.data());
+    }
+    std::vector<LogEntry*> updateEntries(updateSizes.size(), nullptr);
+    if (!updateSizes.empty()) {
+        mUpdateLog.append(updateSizes.data(), updateTypes.data(), updateSizes.size(), updateEntries.data());
+    }
+
+    auto insertEntry = insertEntries.begin();
+    auto updateEntry = updateEntries.begin();
+    for (size_t i = 0; i < count; ++i) {
+        auto& op = operations[i];
+        switch (op.type) {
+        case WriteType::INSERT: {
+            auto& logEntry = *(insertEntry++);
+            results[i] = internalInsert(op.key, op.size, op.data, snapshot, &logEntry);
+
+            // The insert did not need the reserved entry - Invalidate it so it is skipped by scans and the GC
+            if (logEntry) {
+                auto entry = new (logEntry->data()) InsertLogEntry(op.key, snapshot.version());
+                entry->newest.store(crossbow::to_underlying(NewestPointerTag::INVALID));
+                mInsertLog.seal(logEntry);
+            }
+        } break;
+        case WriteType::UPDATE:
+        case WriteType::REMOVE: {
+            auto& logEntry = *(updateEntry++);
+            if (op.type == WriteType::UPDATE) {
+                results[i] = genericUpdate(op.key, op.size, op.data, snapshot, RecordType::DATA, &logEntry);
+            } else {
+                results[i] = genericUpdate(op.key, 0, nullptr, snapshot, RecordType::DELETE, &logEntry);
+            }
+
+            // The update did not need the reserved entry - It is never linked into a version chain
+            if (logEntry) {
+                auto entry = new (logEntry->data()) UpdateLogEntry(op.key, snapshot.version(), nullptr);
+                entry->previous.store(crossbow::to_underlying(NewestPointerTag::INVALID));
+                mUpdateLog.seal(logEntry);
+            }
+        } break;
+        case WriteType::REVERT: {
+            results[i] = revert(op.key, snapshot);
+        } break;
+        default: {
+            results[i] = error::unkown_request;
+        } break;
+        }
+    }
+}
+
 template <typename Context>
 int Table<Context>::genericUpdate(uint64_t key, size_t size, const char* data,
-        const commitmanager::SnapshotDescriptor& snapshot, RecordType newType) {
+        const commitmanager::SnapshotDescriptor& snapshot, RecordType newType, LogEntry** reserved) {
     int ec;
 
     // Check main
     auto mainTable = mMainTable.load();
     if (auto ptr = mainTable->get(key)) {
-        if (internalUpdate<MainRecord>(ptr, size, data, snapshot, RecordType::DATA, newType, ec)) {
+        if (internalUpdate<MainRecord>(ptr, size, data, snapshot, RecordType::DATA, newType, ec, reserved)) {
             return ec;
         }
     }
 
     // Lookup in the insert hash table
     if (auto ptr = getFromInsert(key)) {
-        if (internalUpdate<InsertRecord>(ptr, size, data, snapshot, RecordType::DATA, newType, ec)) {
+        if (internalUpdate<InsertRecord>(ptr, size, data, snapshot, RecordType::DATA, newType, ec, reserved)) {
             return ec;
         }
     }
@@ -192,7 +290,7 @@ int Table<Context>::genericUpdate(uint64_t key, size_t size, const char* data,
     auto newMainTable = mMainTable.load();
     if (newMainTable != mainTable) {
         if (auto ptr = newMainTable->get(key)) {
-            if (internalUpdate<MainRecord>(ptr, size, data, snapshot, RecordType::DATA, newType, ec)) {
+            if (internalUpdate<MainRecord>(ptr, size, data, snapshot, RecordType::DATA, newType, ec, reserved)) {
                 return ec;
             }
         }
@@ -202,6 +300,25 @@ int Table<Context>::genericUpdate(uint64_t key, size_t size, const char* data,
     return error::invalid_write;
 }
 
+template <typename Context>
+void Table<Context>::prefetch(uint64_t key) const {
+    mMainTable.load()->prefetch(key);
+    mInsertTable.prefetch(key);
+}
+
+template <typename Context>
+void Table<Context>::prefetchRecord(uint64_t key) const {
+    if (auto ptr = mMainTable.load()->get(key)) {
+        __builtin_prefetch(ptr);
+        return;
+    }
+
+    if (auto ptr = mInsertTable.get(key)) {
+        __builtin_prefetch(LogEntry::entryFromData(reinterpret_cast<const char*>(ptr)));
+        __builtin_prefetch(ptr);
+    }
+}
+
 template <typename Context>
 const InsertLogEntry* Table<Context>::getFromInsert(uint64_t key, DynamicInsertTableEntry** headList) const {
     auto ptr = mInsertTable.get(key, headList);
@@ -244,6 +361,8 @@ void Table<Context>::runGC(uint64_t minVersion) {
     auto insBegin = oldPageList->insertEnd;
     auto insEnd = mInsertLog.end();
 
+    // The inserts are appended in log order: Scans running concurrently rely on the relocated main entries of
+    // consecutive log entries forming a consecutive range in the main page
     for (auto insIter = insBegin; insIter != insEnd; ++insIter) {
         // Busy wait until the entry is sealed
         while (!insIter->sealed());
@@ -258,6 +377,7 @@ void Table<Context>::runGC(uint64_t minVersion) {
         }
     }
     pageList->pages = pageListModifier.done();
+    summarizePages(*pageList, oldPageList);
 
     // The garbage collection is finished - we can now reset the read only table
     __attribute__((unused)) auto insertRes = mInsertLog.truncateLog(insBegin, insEnd);
@@ -287,10 +407,73 @@ void Table<Context>::runGC(uint64_t minVersion) {
     LOG_TRACE("Completing garbage collection");
 }
 
+template <typename Context>
+void Table<Context>::summarizePages(PageList& pageList, const PageList* oldPageList) const {
+    std::unordered_map<const Page*, size_t> oldIndex;
+    if (oldPageList) {
+        for (decltype(oldPageList->pages.size()) i = 0; i < oldPageList->pages.size(); ++i) {
+            oldIndex.emplace(oldPageList->pages[i], i);
+        }
+    }
+
+    pageList.fences.clear();
+    pageList.fences.reserve(pageList.pages.size());
+    pageList.zoneMaps.clear();
+    pageList.zoneMaps.reserve(pageList.pages.size());
+    for (auto page : pageList.pages) {
+        auto i = oldIndex.find(page);
+        if (i != oldIndex.end()) {
+            pageList.fences.emplace_back(oldPageList->fences[i->second]);
+            pageList.zoneMaps.emplace_back(oldPageList->zoneMaps[i->second]);
+        } else {
+            pageList.fences.emplace_back(page->keyRange());
+            pageList.zoneMaps.emplace_back(mContext.zoneMap(page));
+        }
+    }
+}
+
+template <typename Context>
+void Table<Context>::writeCheckpoint(CheckpointWriter& writer) const {
+    auto pageList = mPages.load();
+    writer.write<uint64_t>(pageList->pages.size());
+    for (auto page : pageList->pages) {
+        writer.writePage(page);
+    }
+}
+
+template <typename Context>
+bool Table<Context>::readCheckpoint(CheckpointReader& reader) {
+    auto pageCount = reader.read<uint64_t>();
+
+    crossbow::allocator _;
+    auto oldMainTable = mMainTable.load();
+    auto mainTableModifier = oldMainTable->modifier();
+
+    PageModifier pageListModifier(mContext, mPageManager, mainTableModifier, 0x0u);
+    for (decltype(pageCount) i = 0; i < pageCount; ++i) {
+        auto page = mPageManager.allocUninitialized();
+        if (!page) {
+            LOG_ERROR("PageManager ran out of space");
+            return false;
+        }
+        reader.readPage(page);
+        pageListModifier.restore(reinterpret_cast<Page*>(page));
+    }
+
+    auto pageList = mPages.load();
+    pageList->pages = pageListModifier.done();
+    summarizePages(*pageList, nullptr);
+
+    mMainTable.store(mainTableModifier.done());
+    crossbow::allocator::destroy(oldMainTable);
+    return true;
+}
+
 template <typename Context>
 template <typename Rec>
 bool Table<Context>::internalUpdate(void* ptr, size_t size, const char* data,
-        const commitmanager::SnapshotDescriptor& snapshot, RecordType expectedType, RecordType newType, int& ec) {
+        const commitmanager::SnapshotDescriptor& snapshot, RecordType expectedType, RecordType newType, int& ec,
+        LogEntry** reserved) {
     Rec record(ptr, mContext);
     if (!record.valid()) {
         return false;
@@ -298,7 +481,7 @@ bool Table<Context>::internalUpdate(void* ptr, size_t size, const char* data,
 
     // Check if the entry was garbage collected: Follow link in case it is
     if (auto main = newestMainRecord(record.newest())) {
-        return internalUpdate<MainRecord>(main, size, data, snapshot, expectedType, newType, ec);
+        return internalUpdate<MainRecord>(main, size, data, snapshot, expectedType, newType, ec, reserved);
     }
 
     LOG_ASSERT(record.newest() % 8 == crossbow::to_underlying(NewestPointerTag::UPDATE),
@@ -309,12 +492,18 @@ bool Table<Context>::internalUpdate(void* ptr, size_t size, const char* data,
         return true;
     }
 
-    // Write update
-    auto logEntry = mUpdateLog.append(size + sizeof(UpdateLogEntry), newType);
-    if (!logEntry) {
-        LOG_FATAL("Failed to append to log");
-        ec = error::out_of_memory;
-        return true;
+    // Write update (into the entry reserved by the batch if there is one)
+    LogEntry* logEntry;
+    if (reserved && *reserved) {
+        logEntry = *reserved;
+        *reserved = nullptr;
+    } else {
+        logEntry = mUpdateLog.append(size + sizeof(UpdateLogEntry), newType);
+        if (!logEntry) {
+            LOG_ERROR("Failed to append to log");
+            ec = error::out_of_memory;
+            return true;
+        }
     }
     auto previous = reinterpret_cast<const UpdateLogEntry*>(record.newest());
     auto updateEntry = new (logEntry->data()) UpdateLogEntry(record.key(), snapshot.version(), previous);
@@ -328,7 +517,7 @@ bool Table<Context>::internalUpdate(void* ptr, size_t size, const char* data,
         // If the newest pointer points to a main record then the base was garbage collected in the meantime
         // Retry the write again on the new main record.
         if (auto main = newestMainRecord(record.newest())) {
-            return internalUpdate<MainRecord>(main, size, data, snapshot, expectedType, newType, ec);
+            return internalUpdate<MainRecord>(main, size, data, snapshot, expectedType, newType, ec, reserved);
         }
 
         // Another update happened in the meantime
@@ -407,7 +596,7 @@ bool Table<Context>::internalRevert(void* ptr, const commitmanager::SnapshotDesc
     // Write update
     auto logEntry = mUpdateLog.append(sizeof(UpdateLogEntry), RecordType::REVERT);
     if (!logEntry) {
-        LOG_FATAL("Failed to append to log");
+        LOG_ERROR("Failed to append to log");
         ec = error::out_of_memory;
         return true;
     }
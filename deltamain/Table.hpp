@@ -23,14 +23,19 @@
 
 #pragma once
 
+#include <config.h>
 #include "InsertHash.hpp"
 #include "Record.hpp"
+#include "ScanMorsel.hpp"
 #include "colstore/ColumnMapContext.hpp"
 #include "colstore/ColumnMapRecord.hpp"
 #include "rowstore/RowStoreContext.hpp"
 
 #include <util/CuckooHash.hpp>
 #include <util/Log.hpp>
+#include <util/ScanQuery.hpp>
+#include <util/SecondaryIndex.hpp>
+#include <util/WriteOperation.hpp>
 
 #include <tellstore/ErrorCode.hpp>
 #include <tellstore/Record.hpp>
@@ -40,6 +45,7 @@
 #include <crossbow/allocator.hpp>
 
 #include <memory>
+#include <utility>
 #include <vector>
 #include <atomic>
 #include <functional>
@@ -51,8 +57,9 @@ class SnapshotDescriptor;
 
 namespace store {
 
+class CheckpointReader;
+class CheckpointWriter;
 class PageManager;
-class ScanQuery;
 
 namespace deltamain {
 
@@ -96,9 +103,30 @@ public:
         return mRecord.schema().type();
     }
 
+    /**
+     * @brief The secondary indexes declared in the schema of the table
+     */
+    SecondaryIndexes& indexes() {
+        return mIndexes;
+    }
+
+    const SecondaryIndexes& indexes() const {
+        return mIndexes;
+    }
+
     template <typename Fun>
     int get(uint64_t key, const commitmanager::SnapshotDescriptor& snapshot, Fun fun) const;
 
+    /**
+     * @brief Issues prefetches for the main and insert hash table buckets of the key
+     */
+    void prefetch(uint64_t key) const;
+
+    /**
+     * @brief Looks up the key in the (already prefetched) hash tables and issues a prefetch for its record header
+     */
+    void prefetchRecord(uint64_t key) const;
+
     int insert(uint64_t key, size_t size, const char* data, const commitmanager::SnapshotDescriptor& snapshot);
 
     int update(uint64_t key, size_t size, const char* data, const commitmanager::SnapshotDescriptor& snapshot);
@@ -107,15 +135,50 @@ public:
 
     int revert(uint64_t key, const commitmanager::SnapshotDescriptor& snapshot);
 
+    /**
+     * @brief Executes the modifications of a batch on the table
+     *
+     * The log space of all inserts is reserved with a single append to the insert log and the space of all updates and
+     * removes with a single append to the update log. Reserved entries not needed by their modification (e.g. an insert
+     * that has to be written as an update of a deleted tuple) are invalidated.
+     *
+     * @param operations The modifications to execute (all on this table)
+     * @param count Number of modifications in the batch
+     * @param results Array receiving the error code (or 0 on success) of every modification
+     */
+    void batchWrite(const WriteOperation* operations, size_t count, const commitmanager::SnapshotDescriptor& snapshot,
+            int* results);
+
     void runGC(uint64_t minVersion);
 
+    /**
+     * @brief Writes the current main pages to the checkpoint
+     *
+     * Only the main is written: Records still in the insert or update log have to be recovered from the redo log. The
+     * pages are written as they are, the newest pointers are reset when restoring the pages.
+     */
+    void writeCheckpoint(CheckpointWriter& writer) const;
+
+    /**
+     * @brief Restores the main pages from the checkpoint and rebuilds the main hash table from them
+     *
+     * Must be called on a freshly created table before any other operation.
+     *
+     * @return Whether the pages were successfully restored
+     */
+    bool readCheckpoint(CheckpointReader& reader);
+
     /**
      * prepares a shared scan executed in parallel for the given number
      * of threads, the queryBuffer and the queries themselves. Returns one
      * ScanProcessor object per thread that encapsulates all relevant information
-     * to perform the scan (using ScanProcessor.process()). The method assigns
-     * each thread the same amount (storage) pages and the last thread gets the
-     * insert log in addition.
+     * to perform the scan (using ScanProcessor.processNext()). The main pages and the
+     * insert log are split into morsels of SCAN_MORSEL_SIZE pages each which the
+     * processors pull from a shared queue until all morsels are processed.
+     *
+     * If all queries are restricted to a key range only the main pages whose key
+     * fences overlap one of the ranges are scanned. The zone maps of the pages are
+     * passed to the processors so they can skip pages no query can match.
      */
     template <typename... Args>
     std::vector<std::unique_ptr<ScanProcessor>> startScan(size_t numThreads, const std::vector<ScanQuery*>& queries,
@@ -133,6 +196,13 @@ private:
         /// List of pages in the main
         std::vector<Page*> pages;
 
+        /// Smallest and largest key stored in every page of the main (in the same order as the pages)
+        /// The pages are not sorted by key so the fences only bound the keys of a page, they do not partition the keys.
+        std::vector<std::pair<uint64_t, uint64_t>> fences;
+
+        /// Zone map of every page of the main (in the same order as the pages)
+        std::vector<typename Context::ZoneMap> zoneMaps;
+
         /// Iterator pointing to the first element in the insert log not contained in the main pages
         Log<OrderedLogImpl>::LogIterator insertEnd;
 
@@ -140,21 +210,37 @@ private:
         Log<OrderedLogImpl>::LogIterator updateEnd;
     };
 
+    /**
+     * @brief Computes the key fences and zone maps of all pages in the page list
+     *
+     * Pages carried over unchanged from the old page list keep their fences and zone maps.
+     */
+    void summarizePages(PageList& pageList, const PageList* oldPageList) const;
+
     const InsertLogEntry* getFromInsert(uint64_t key, DynamicInsertTableEntry** headList = nullptr) const;
 
     InsertLogEntry* getFromInsert(uint64_t key, DynamicInsertTableEntry** headList = nullptr) {
         return const_cast<InsertLogEntry*>(const_cast<const Table<Context>*>(this)->getFromInsert(key, headList));
     }
 
+    /**
+     * @param reserved Entry in the insert log reserved by a batch write, reset to null if the entry was used
+     */
+    int internalInsert(uint64_t key, size_t size, const char* data, const commitmanager::SnapshotDescriptor& snapshot,
+            LogEntry** reserved);
+
+    /**
+     * @param reserved Entry in the update log reserved by a batch write, reset to null if the entry was used
+     */
     int genericUpdate(uint64_t key, size_t size, const char* data, const commitmanager::SnapshotDescriptor& snapshot,
-            RecordType type);
+            RecordType type, LogEntry** reserved = nullptr);
 
     template <typename Rec, typename Fun>
     bool internalGet(const void* ptr, const commitmanager::SnapshotDescriptor& snapshot, Fun fun, int& ec) const;
 
     template <typename Rec>
     bool internalUpdate(void* ptr, size_t size, const char* data, const commitmanager::SnapshotDescriptor& snapshot,
-            RecordType expectedType, RecordType newType, int& ec);
+            RecordType expectedType, RecordType newType, int& ec, LogEntry** reserved = nullptr);
 
     template <typename Rec>
     int canUpdate(const Rec& record, const commitmanager::SnapshotDescriptor& snapshot, RecordType expectedType);
@@ -167,6 +253,7 @@ private:
     crossbow::string mTableName;
     Record mRecord;
     uint64_t mTableId;
+    SecondaryIndexes mIndexes;
 
     DynamicInsertTable mInsertTable;
     Log<OrderedLogImpl> mInsertLog;
@@ -223,16 +310,55 @@ std::vector<std::unique_ptr<typename Table<Context>::ScanProcessor>> Table<Conte
     // TODO Make LogIterator convertible to ConstLogIterator
     decltype(insEnd) insIter(pageList->insertEnd.page(), pageList->insertEnd.offset());
     auto numPages = pageList->pages.size();
+
+    // Compute the key range covering all queries - Pages outside of the range can be skipped
+    ScanKeyRange keyRange(queries);
+
+    // Every morsel only contains pages from a single NUMA node so it can be processed by a thread on that node
+    std::vector<std::vector<ScanMorsel>> morsels(mPageManager.numaNodes());
+    auto addMorsel = [this, pageList, insEnd, &morsels] (size_t begin, size_t end) {
+        if (begin != end) {
+            morsels[mPageManager.numaNode(pageList->pages[begin])].emplace_back(begin, end, insEnd, insEnd);
+        }
+    };
+    size_t morselBegin = 0;
+    for (decltype(numPages) i = 0; i < numPages; ++i) {
+        if (!keyRange.overlaps(pageList->fences[i])) {
+            addMorsel(morselBegin, i);
+            morselBegin = i + 1;
+            continue;
+        }
+
+        auto node = mPageManager.numaNode(pageList->pages[morselBegin]);
+        if (i - morselBegin == SCAN_MORSEL_SIZE || mPageManager.numaNode(pageList->pages[i]) != node) {
+            addMorsel(morselBegin, i);
+            morselBegin = i;
+        }
+    }
+    addMorsel(morselBegin, numPages);
+
+    // Split the insert log at page boundaries, the last morsel takes the log up to the (moving) end
+    auto logIter = insIter;
+    size_t logPages = 0;
+    for (auto page = insIter.page(); page != insEnd.page();) {
+        auto next = page->next().load();
+        if (++logPages == SCAN_MORSEL_SIZE || mPageManager.numaNode(next) != mPageManager.numaNode(logIter.page())) {
+            decltype(insEnd) logEnd(next, 0);
+            morsels[mPageManager.numaNode(logIter.page())].emplace_back(0, 0, logIter, logEnd);
+            logIter = logEnd;
+            logPages = 0;
+        }
+        page = next;
+    }
+    morsels[mPageManager.numaNode(logIter.page())].emplace_back(0, 0, logIter, insEnd);
+
+    auto morselQueue = std::make_shared<MorselQueue>(std::move(morsels));
+
     std::vector<std::unique_ptr<ScanProcessor>> result;
     result.reserve(numThreads);
-    size_t beginIdx = 0;
-    auto mod = numPages % numThreads;
     for (decltype(numThreads) i = 0; i < numThreads; ++i) {
-        const auto& startIter = (i == numThreads - 1 ? insIter : insEnd);
-        auto endIdx = beginIdx + numPages / numThreads + (i < mod ? 1 : 0);
-        result.emplace_back(new ScanProcessor(mContext, mRecord, queries, pageList->pages, beginIdx, endIdx, startIter,
-                insEnd, std::forward<Args>(args)...));
-        beginIdx = endIdx;
+        result.emplace_back(new ScanProcessor(mContext, mRecord, queries, pageList->pages, pageList->zoneMaps,
+                morselQueue, std::forward<Args>(args)...));
     }
     return result;
 }
@@ -25,6 +25,7 @@
 
 #include "ColumnMapPage.hpp"
 #include "ColumnMapScanProcessor.hpp"
+#include "ColumnMapZoneMap.hpp"
 #include "LLVMColumnMapMaterialize.hpp"
 
 #include <util/LLVMJIT.hpp>
@@ -66,6 +67,7 @@ public:
     using Scan = ColumnMapScan;
     using Page = ColumnMapMainPage;
     using PageModifier = ColumnMapPageModifier;
+    using ZoneMap = ColumnMapZoneMap;
 
     using MainRecord = ColumnMapRecord;
     using ConstMainRecord = ConstColumnMapRecord;
@@ -140,6 +142,13 @@ public:
         return mFixedMetaData;
     }
 
+    /**
+     * @brief Computes the zone maps of the fixed size columns of the given page
+     */
+    ColumnMapZoneMap zoneMap(const ColumnMapMainPage* page) const {
+        return ColumnMapZoneMap(*this, page);
+    }
+
     /**
      * @brief The page the given element is located on
      */
@@ -0,0 +1,286 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+
+#include "ColumnMapEncoding.hpp"
+
+#include "ColumnMapPage.hpp"
+
+#include <crossbow/logger.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace tell {
+namespace store {
+namespace deltamain {
+namespace {
+
+/**
+ * @brief Reads the value of the given length as unsigned integer
+ */
+uint64_t readValue(const char* data, uint32_t length) {
+    uint64_t value = 0u;
+    memcpy(&value, data, length);
+    return value;
+}
+
+/**
+ * @brief Sign extends the unsigned integer value of the given length
+ */
+int64_t signExtend(uint64_t value, uint32_t length) {
+    auto shift = (sizeof(uint64_t) - length) * 8u;
+    return static_cast<int64_t>(value << shift) >> shift;
+}
+
+/**
+ * @brief Smallest width (1, 2 or 4 bytes) able to store the distance or 0 if none can
+ */
+uint8_t packedWidth(uint64_t distance) {
+    if (distance <= std::numeric_limits<uint8_t>::max()) {
+        return sizeof(uint8_t);
+    }
+    if (distance <= std::numeric_limits<uint16_t>::max()) {
+        return sizeof(uint16_t);
+    }
+    if (distance <= std::numeric_limits<uint32_t>::max()) {
+        return sizeof(uint32_t);
+    }
+    return 0u;
+}
+
+} // anonymous namespace
+
+ColumnEncoding encodeFixedColumn(char* data, uint32_t count, FieldType type, uint32_t length) {
+    // The encoded column must fit into the space of the raw column
+    auto headerData = const_cast<char*>(reinterpret_cast<const char*>(ColumnMapEncodedColumn::fromColumn(data)));
+    auto rawSize = static_cast<size_t>(count) * length;
+    auto overhead = static_cast<size_t>(headerData - data) + sizeof(ColumnMapEncodedColumn);
+    if (count == 0u || rawSize <= overhead) {
+        return ColumnEncoding::RAW;
+    }
+    auto capacity = rawSize - overhead;
+
+    std::vector<uint64_t> values;
+    values.reserve(count);
+    for (decltype(count) i = 0; i < count; ++i) {
+        values.emplace_back(readValue(data + i * length, length));
+    }
+
+    auto encoding = ColumnEncoding::RAW;
+    auto encodedSize = capacity + 1u;
+
+    // Frame of reference: Only for integers where the range of the values fits into a smaller width
+    uint64_t base = 0u;
+    uint8_t width = 0u;
+    if (type == FieldType::SMALLINT || type == FieldType::INT || type == FieldType::BIGINT) {
+        auto minValue = std::numeric_limits<int64_t>::max();
+        auto maxValue = std::numeric_limits<int64_t>::min();
+        for (auto value : values) {
+            auto signedValue = signExtend(value, length);
+            minValue = std::min(minValue, signedValue);
+            maxValue = std::max(maxValue, signedValue);
+        }
+        base = static_cast<uint64_t>(minValue);
+        width = packedWidth(static_cast<uint64_t>(maxValue) - base);
+        if (width != 0u && width < length) {
+            auto size = static_cast<size_t>(count) * width + ColumnMapEncodedColumn::PACKED_PADDING;
+            if (size < encodedSize) {
+                encoding = ColumnEncoding::FRAME_OF_REFERENCE;
+                encodedSize = size;
+            }
+        }
+    }
+
+    // Dictionary: Only if the number of distinct values fits into a single byte code
+    std::unordered_map<uint64_t, uint8_t> codes;
+    std::vector<uint64_t> dictionary;
+    for (auto value : values) {
+        if (codes.find(value) != codes.end()) {
+            continue;
+        }
+        if (dictionary.size() == ColumnMapEncodedColumn::MAX_DICTIONARY_SIZE) {
+            dictionary.clear();
+            break;
+        }
+        codes.emplace(value, static_cast<uint8_t>(dictionary.size()));
+        dictionary.emplace_back(value);
+    }
+    if (!dictionary.empty()) {
+        auto size = crossbow::align(static_cast<size_t>(count), 8u) + dictionary.size() * length;
+        if (size < encodedSize) {
+            encoding = ColumnEncoding::DICTIONARY;
+            encodedSize = size;
+        }
+    }
+
+    // Run length
+    size_t runCount = 1u;
+    for (decltype(count) i = 1; i < count; ++i) {
+        if (values[i] != values[i - 1]) {
+            ++runCount;
+        }
+    }
+    auto runSize = crossbow::align(runCount * sizeof(uint32_t), 8u) + runCount * length;
+    if (runSize < encodedSize) {
+        encoding = ColumnEncoding::RUN_LENGTH;
+        encodedSize = runSize;
+    }
+
+    if (encoding == ColumnEncoding::RAW) {
+        return encoding;
+    }
+
+    // Write the encoded column into a separate buffer first as it overlaps the raw values
+    std::vector<char> buffer(sizeof(ColumnMapEncodedColumn) + encodedSize, 0);
+    auto encodedData = buffer.data() + sizeof(ColumnMapEncodedColumn);
+    switch (encoding) {
+    case ColumnEncoding::FRAME_OF_REFERENCE: {
+        new (buffer.data()) ColumnMapEncodedColumn(encoding, width, 0u, base);
+        for (decltype(count) i = 0; i < count; ++i) {
+            auto packed = static_cast<uint64_t>(signExtend(values[i], length)) - base;
+            memcpy(encodedData + i * width, &packed, width);
+        }
+    } break;
+
+    case ColumnEncoding::DICTIONARY: {
+        new (buffer.data()) ColumnMapEncodedColumn(encoding, 0u, static_cast<uint32_t>(dictionary.size()), 0u);
+        for (decltype(count) i = 0; i < count; ++i) {
+            encodedData[i] = static_cast<char>(codes[values[i]]);
+        }
+        auto dictionaryData = encodedData + crossbow::align(count, 8u);
+        for (decltype(dictionary.size()) i = 0; i < dictionary.size(); ++i) {
+            memcpy(dictionaryData + i * length, &dictionary[i], length);
+        }
+    } break;
+
+    case ColumnEncoding::RUN_LENGTH: {
+        new (buffer.data()) ColumnMapEncodedColumn(encoding, 0u, static_cast<uint32_t>(runCount), 0u);
+        auto runEnds = reinterpret_cast<uint32_t*>(encodedData);
+        auto runValues = encodedData + crossbow::align(runCount * sizeof(uint32_t), 8u);
+        size_t run = 0u;
+        for (decltype(count) i = 1; i <= count; ++i) {
+            if (i == count || values[i] != values[i - 1]) {
+                runEnds[run] = i;
+                memcpy(runValues + run * length, &values[i - 1], length);
+                ++run;
+            }
+        }
+        LOG_ASSERT(run == runCount, "Number of written runs does not match");
+    } break;
+
+    default: {
+        LOG_ASSERT(false, "Unknown column encoding");
+    } break;
+    }
+
+    memcpy(headerData, buffer.data(), buffer.size());
+    return encoding;
+}
+
+void decodeFixedColumn(const char* data, uint32_t count, uint32_t length, uint32_t startIdx, uint32_t endIdx,
+        char* dest) {
+    auto column = ColumnMapEncodedColumn::fromColumn(data);
+    switch (column->encoding) {
+    case ColumnEncoding::FRAME_OF_REFERENCE: {
+        auto packedData = column->data();
+        for (auto i = startIdx; i < endIdx; ++i, dest += length) {
+            auto value = column->base + readValue(packedData + i * column->width, column->width);
+            memcpy(dest, &value, length);
+        }
+    } break;
+
+    case ColumnEncoding::DICTIONARY: {
+        auto codes = reinterpret_cast<const uint8_t*>(column->data());
+        auto dictionaryData = column->valueData(count);
+        for (auto i = startIdx; i < endIdx; ++i, dest += length) {
+            memcpy(dest, dictionaryData + codes[i] * length, length);
+        }
+    } break;
+
+    case ColumnEncoding::RUN_LENGTH: {
+        auto runEnds = reinterpret_cast<const uint32_t*>(column->data());
+        auto runValues = column->valueData(count);
+        auto run = static_cast<size_t>(std::upper_bound(runEnds, runEnds + column->valueCount, startIdx) - runEnds);
+        for (auto i = startIdx; i < endIdx; ++i, dest += length) {
+            if (i == runEnds[run]) {
+                ++run;
+            }
+            memcpy(dest, runValues + run * length, length);
+        }
+    } break;
+
+    default: {
+        LOG_ASSERT(false, "Column is not encoded");
+    } break;
+    }
+}
+
+int compareVariableValues(const char* lhs, size_t lhsLength, const char* rhs, size_t rhsLength) {
+    auto res = memcmp(lhs, rhs, std::min(lhsLength, rhsLength));
+    if (res != 0) {
+        return res;
+    }
+    return (lhsLength < rhsLength ? -1 : (lhsLength > rhsLength ? 1 : 0));
+}
+
+bool collectDistinctValues(const char* page, const ColumnMapHeapEntry* startEntries,
+        const ColumnMapHeapEntry* endEntries, const char* nullData, uint32_t count, uint32_t maxValues,
+        std::vector<uint32_t>& distinctValues) {
+    distinctValues.clear();
+    for (decltype(count) i = 0; i < count; ++i) {
+        if (nullData && nullData[i] != 0) {
+            continue;
+        }
+
+        auto data = page + startEntries[i].offset;
+        auto length = static_cast<size_t>(endEntries[i].offset - startEntries[i].offset);
+        auto compare = [page, startEntries, endEntries] (uint32_t idx, const char* value, size_t valueLength) {
+            return compareVariableValues(page + startEntries[idx].offset,
+                    endEntries[idx].offset - startEntries[idx].offset, value, valueLength);
+        };
+
+        auto pos = std::lower_bound(distinctValues.begin(), distinctValues.end(), data,
+                [&compare, length] (uint32_t idx, const char* value) {
+            return compare(idx, value, length) < 0;
+        });
+        if (pos != distinctValues.end() && compare(*pos, data, length) == 0) {
+            continue;
+        }
+
+        if (distinctValues.size() == maxValues) {
+            distinctValues.clear();
+            return false;
+        }
+        distinctValues.emplace(pos, i);
+    }
+    return true;
+}
+
+} // namespace deltamain
+} // namespace store
+} // namespace tell
@@ -0,0 +1,202 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+
+#pragma once
+
+#include <tellstore/Record.hpp>
+
+#include <crossbow/alignment.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tell {
+namespace store {
+namespace deltamain {
+
+struct ColumnMapHeapEntry;
+
+/**
+ * @brief Lightweight encodings of a fixed size column in a column map page
+ */
+enum class ColumnEncoding : uint8_t {
+    /// The values are stored uncompressed
+    RAW = 0x0u,
+
+    /// The values are stored as their distance to the smallest value packed into 1, 2 or 4 bytes
+    FRAME_OF_REFERENCE,
+
+    /// The values are stored as 1 byte codes into a dictionary of the distinct values
+    DICTIONARY,
+
+    /// Consecutive equal values are stored as a single run
+    RUN_LENGTH,
+};
+
+/**
+ * @brief Struct storing the header of an encoded fixed size column in a column map page
+ *
+ * The encoded column is stored in the space reserved for the raw values of the column, starting at the first 8 byte
+ * aligned address. The header is followed by the encoded data:
+ * - Frame of reference: An array of size N containing the packed value of every element (width bytes each). The value
+ *     of an element is the base plus its packed value (truncated to the size of the field).
+ * - Dictionary: An array of size N containing the 1 byte code of every element followed by the 8 byte aligned
+ *     dictionary of valueCount values in order of their first occurrence.
+ * - Run length: An array of size valueCount containing the index past the last element of every run followed by the 8
+ *     byte aligned array of valueCount run values.
+ */
+struct alignas(8) ColumnMapEncodedColumn {
+    /// Maximum number of values in a dictionary (the codes are stored in a single byte)
+    static constexpr uint32_t MAX_DICTIONARY_SIZE = 256u;
+
+    /// Number of bytes reserved after the packed values (packed values are loaded with a single 8 byte load)
+    static constexpr uint32_t PACKED_PADDING = 8u;
+
+    /**
+     * @brief The encoded column stored in the space of the fixed size column starting at the given data pointer
+     */
+    static const ColumnMapEncodedColumn* fromColumn(const char* columnData) {
+        return reinterpret_cast<const ColumnMapEncodedColumn*>(crossbow::align(
+                reinterpret_cast<uintptr_t>(columnData), alignof(ColumnMapEncodedColumn)));
+    }
+
+    ColumnMapEncodedColumn(ColumnEncoding _encoding, uint8_t _width, uint32_t _valueCount, uint64_t _base)
+            : encoding(_encoding),
+              width(_width),
+              valueCount(_valueCount),
+              base(_base) {
+    }
+
+    /**
+     * @brief Pointer to the encoded data following the header
+     */
+    const char* data() const {
+        return reinterpret_cast<const char*>(this) + sizeof(ColumnMapEncodedColumn);
+    }
+
+    /**
+     * @brief Pointer to the dictionary or run values of a column with count elements
+     */
+    const char* valueData(uint32_t count) const {
+        return data() + (encoding == ColumnEncoding::DICTIONARY
+                ? crossbow::align(count, 8u)
+                : crossbow::align(valueCount * sizeof(uint32_t), 8u));
+    }
+
+    ColumnEncoding encoding;
+
+    /// Width in bytes of a packed value (frame of reference only)
+    uint8_t width;
+
+    /// Number of values in the dictionary or number of runs
+    uint32_t valueCount;
+
+    /// Value all packed values are relative to (frame of reference only)
+    uint64_t base;
+};
+
+/**
+ * @brief Encodes the fixed size column in place if an encoding requires less space than the raw values
+ *
+ * Picks the encoding requiring the least space. The frame of reference encoding is only considered for integer
+ * columns.
+ *
+ * @param data Pointer to the raw values of the column
+ * @param count Number of elements in the column
+ * @param type Type of the column
+ * @param length Size of a single value of the column
+ * @return The encoding of the column (RAW if the column was left untouched)
+ */
+ColumnEncoding encodeFixedColumn(char* data, uint32_t count, FieldType type, uint32_t length);
+
+/**
+ * @brief Decodes the values of the elements [startIdx, endIdx) of an encoded fixed size column
+ *
+ * @param data Pointer to the space of the column
+ * @param count Number of elements in the column
+ * @param length Size of a single value of the column
+ * @param startIdx Index of the first element to decode
+ * @param endIdx Index past the last element to decode
+ * @param dest Destination buffer receiving the raw values
+ */
+void decodeFixedColumn(const char* data, uint32_t count, uint32_t length, uint32_t startIdx, uint32_t endIdx,
+        char* dest);
+
+/**
+ * @brief Struct storing the location of the dictionary of a single variable size column in a column map page
+ *
+ * The dictionaries of the variable size columns are stored between the heap entries and the variable size heap. They
+ * start with one ColumnMapDictionaryColumn for every variable size column followed by the ColumnMapDictionaryEntry of
+ * every dictionary value.
+ */
+struct ColumnMapDictionaryColumn {
+    /// Index of the first value of the column in the dictionary entries
+    uint32_t offset;
+
+    /// Number of values in the dictionary of the column (0 if the column is not encoded)
+    uint32_t size;
+};
+
+/**
+ * @brief Struct storing a single value in the dictionary of a variable size column
+ *
+ * The values of a dictionary are sorted in ascending order, the heap entry of every element of an encoded column stores
+ * the index of its value (the code) instead of the prefix. The value data itself remains in the variable size heap.
+ */
+struct ColumnMapDictionaryEntry {
+    /// Offset from the end of the variable sized heap to the value
+    uint32_t offset;
+
+    /// Size of the value
+    uint32_t size;
+
+    /// First 4 bytes of the value (zero padded)
+    char prefix[4];
+};
+
+/**
+ * @brief Lexicographically compares two variable size values (a value is smaller than all values it is a prefix of)
+ */
+int compareVariableValues(const char* lhs, size_t lhsLength, const char* rhs, size_t rhsLength);
+
+/**
+ * @brief Collects the distinct non-NULL values of a variable size column in ascending order
+ *
+ * @param page Pointer to the page the heap entries belong to
+ * @param startEntries Pointer to the heap entries of the column
+ * @param endEntries Pointer to the heap entries marking the end of every value of the column
+ * @param nullData Pointer to the null bytes of the column or null if the column is not nullable
+ * @param count Number of elements in the column
+ * @param maxValues Maximum number of distinct values to collect
+ * @param distinctValues Receives the index of one element for every distinct value
+ * @return False if the column contains more than maxValues distinct values
+ */
+bool collectDistinctValues(const char* page, const ColumnMapHeapEntry* startEntries,
+        const ColumnMapHeapEntry* endEntries, const char* nullData, uint32_t count, uint32_t maxValues,
+        std::vector<uint32_t>& distinctValues);
+
+} // namespace deltamain
+} // namespace store
+} // namespace tell
@@ -24,6 +24,7 @@
 #include "ColumnMapPage.hpp"
 
 #include "ColumnMapContext.hpp"
+#include "ColumnMapEncoding.hpp"
 
 #include <deltamain/Record.hpp>
 #include <deltamain/Table.hpp>
@@ -31,7 +32,9 @@
 #include <util/PageManager.hpp>
 #include <tellstore/Record.hpp>
 
+#include <algorithm>
 #include <cstring>
+#include <limits>
 #include <type_traits>
 
 namespace tell {
@@ -54,7 +57,8 @@ ColumnMapMainPage::ColumnMapMainPage(const ColumnMapContext& context, uint32_t _
           headerOffset(crossbow::align(sizeof(ColumnMapMainPage)
                 + count * (sizeof(ColumnMapMainEntry) + sizeof(uint32_t)), 8u)),
           fixedOffset(crossbow::align(headerOffset + count * context.headerSize(), 8u)),
-          variableOffset(crossbow::align(fixedOffset + count * context.fixedSize(), 8u)) {
+          variableOffset(crossbow::align(fixedOffset + count * context.fixedSize(), 8u)),
+          encodedColumns(0x0u) {
     // Create sentinel heap entry
     auto& record = context.record();
     if (record.varSizeFieldCount() != 0) {
@@ -63,6 +67,139 @@ ColumnMapMainPage::ColumnMapMainPage(const ColumnMapContext& context, uint32_t _
     }
 }
 
+std::pair<uint64_t, uint64_t> ColumnMapMainPage::keyRange() const {
+    auto result = std::make_pair(std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::min());
+    auto entries = entryData();
+    for (decltype(count) i = 0; i < count; ++i) {
+        result.first = std::min(result.first, entries[i].key);
+        result.second = std::max(result.second, entries[i].key);
+    }
+    return result;
+}
+
+void ColumnMapMainPage::readFixedColumn(const ColumnMapContext& context, uint32_t column, uint32_t startIdx,
+        uint32_t endIdx, char* dest) const {
+    auto& columnMeta = context.fixedMetaData()[column];
+    auto columnData = fixedData() + count * columnMeta.offset;
+    if (isEncoded(column)) {
+        decodeFixedColumn(columnData, count, columnMeta.length, startIdx, endIdx, dest);
+    } else {
+        memcpy(dest, columnData + startIdx * columnMeta.length, (endIdx - startIdx) * columnMeta.length);
+    }
+}
+
+void ColumnMapMainPage::encodeFixedColumns(const ColumnMapContext& context) {
+    auto& record = context.record();
+    auto& fixedMetaData = context.fixedMetaData();
+    for (decltype(fixedMetaData.size()) i = 0; i < fixedMetaData.size() && i < MAX_ENCODED_COLUMNS; ++i) {
+        auto& columnMeta = fixedMetaData[i];
+        auto encoding = encodeFixedColumn(fixedData() + count * columnMeta.offset, count,
+                record.getFieldMeta(i).field.type(), columnMeta.length);
+        if (encoding != ColumnEncoding::RAW) {
+            encodedColumns |= (0x1ull << i);
+        }
+    }
+}
+
+const char* ColumnMapMainPage::dictionaryData(const ColumnMapContext& context) const {
+    return reinterpret_cast<const char*>(variableData() + count * context.record().varSizeFieldCount());
+}
+
+void ColumnMapMainPage::encodeVariableColumns(const ColumnMapContext& context) {
+    auto& record = context.record();
+    auto varSizeFieldCount = record.varSizeFieldCount();
+    if (varSizeFieldCount == 0u || count == 0u) {
+        return;
+    }
+
+    // The value of an element ends where the value in the next column starts, the value in the last column ends where
+    // the value of the previous element in the first column starts (a sentinel precedes the first heap entry)
+    // The value of the last element in the first column is the start of the variable size heap.
+    auto heapEntries = variableData();
+    auto pageData = reinterpret_cast<const char*>(this);
+    auto dictionaryStart = dictionaryData(context);
+    auto freeSpace = (pageData + heapEntries[count - 1].offset) - dictionaryStart;
+    auto requiredSpace = static_cast<decltype(freeSpace)>(varSizeFieldCount * sizeof(ColumnMapDictionaryColumn));
+
+    std::vector<std::vector<uint32_t>> dictionaries(varSizeFieldCount);
+    auto encoded = false;
+    for (decltype(varSizeFieldCount) i = 0; i < varSizeFieldCount; ++i) {
+        auto id = record.fixedSizeFieldCount() + i;
+        if (id >= MAX_ENCODED_COLUMNS) {
+            break;
+        }
+        auto& fieldMeta = record.getFieldMeta(id);
+        auto nullData = (fieldMeta.field.isNotNull() ? nullptr : headerData() + count * fieldMeta.nullIdx);
+        auto startEntries = heapEntries + count * i;
+        auto endEntries = (i + 1u == varSizeFieldCount ? heapEntries - 1 : startEntries + count);
+
+        // Only columns with at most one distinct value for every two elements benefit from a dictionary
+        auto maxValues = count / 2u;
+        if (maxValues > ColumnMapEncodedColumn::MAX_DICTIONARY_SIZE) {
+            maxValues = ColumnMapEncodedColumn::MAX_DICTIONARY_SIZE;
+        }
+        auto& dictionary = dictionaries[i];
+        if (!collectDistinctValues(pageData, startEntries, endEntries, nullData, count, maxValues, dictionary)
+                || dictionary.empty()) {
+            dictionary.clear();
+            continue;
+        }
+        auto dictionarySpace = static_cast<decltype(freeSpace)>(dictionary.size() * sizeof(ColumnMapDictionaryEntry));
+        if (requiredSpace + dictionarySpace > freeSpace) {
+            dictionary.clear();
+            continue;
+        }
+        requiredSpace += dictionarySpace;
+        encoded = true;
+    }
+    if (!encoded) {
+        return;
+    }
+
+    auto dictionaryColumns = reinterpret_cast<ColumnMapDictionaryColumn*>(dictionaryStart);
+    auto dictionaryEntries = reinterpret_cast<ColumnMapDictionaryEntry*>(dictionaryColumns + varSizeFieldCount);
+    uint32_t entryIdx = 0u;
+    for (decltype(varSizeFieldCount) i = 0; i < varSizeFieldCount; ++i) {
+        auto& dictionary = dictionaries[i];
+        dictionaryColumns[i].offset = entryIdx;
+        dictionaryColumns[i].size = static_cast<uint32_t>(dictionary.size());
+        if (dictionary.empty()) {
+            continue;
+        }
+
+        auto id = record.fixedSizeFieldCount() + i;
+        auto& fieldMeta = record.getFieldMeta(id);
+        auto nullData = (fieldMeta.field.isNotNull() ? nullptr : headerData() + count * fieldMeta.nullIdx);
+        auto startEntries = heapEntries + count * i;
+        auto endEntries = (i + 1u == varSizeFieldCount ? heapEntries - 1 : startEntries + count);
+
+        for (auto idx : dictionary) {
+            auto& entry = dictionaryEntries[entryIdx++];
+            entry.offset = startEntries[idx].offset;
+            entry.size = endEntries[idx].offset - startEntries[idx].offset;
+            memcpy(entry.prefix, startEntries[idx].prefix, sizeof(entry.prefix));
+        }
+
+        // Replace the prefix of every element with the index of its value in the dictionary (NULL values get code 0)
+        for (decltype(count) j = 0; j < count; ++j) {
+            uint32_t code = 0u;
+            if (!nullData || nullData[j] == 0) {
+                auto data = pageData + startEntries[j].offset;
+                auto length = static_cast<size_t>(endEntries[j].offset - startEntries[j].offset);
+                auto pos = std::lower_bound(dictionary.begin(), dictionary.end(), data,
+                        [pageData, startEntries, endEntries, length] (uint32_t idx, const char* value) {
+                    return compareVariableValues(pageData + startEntries[idx].offset,
+                            endEntries[idx].offset - startEntries[idx].offset, value, length) < 0;
+                });
+                LOG_ASSERT(pos != dictionary.end(), "Value not in dictionary");
+                code = static_cast<uint32_t>(pos - dictionary.begin());
+            }
+            memcpy(startEntries[j].prefix, &code, sizeof(code));
+        }
+        encodedColumns |= (0x1ull << id);
+    }
+}
+
 ColumnMapPageModifier::ColumnMapPageModifier(const ColumnMapContext& context, PageManager& pageManager,
         Modifier& mainTableModifier, uint64_t minVersion)
         : mContext(context),
@@ -372,6 +509,21 @@ bool ColumnMapPageModifier::append(InsertRecord& oldRecord) {
     }
 }
 
+void ColumnMapPageModifier::restore(ColumnMapMainPage* page) {
+    auto entries = page->entryData();
+    for (decltype(page->count) i = 0; i < page->count; ++i) {
+        entries[i].newest.store(0x0u);
+
+        // All versions of a key are clustered with the newest version first
+        if (i != 0 && entries[i].key == entries[i - 1].key) {
+            continue;
+        }
+        __attribute__((unused)) auto res = mMainTableModifier.insert(entries[i].key, &entries[i], false);
+        LOG_ASSERT(res, "Inserting key into hash table did not succeed");
+    }
+    mPageList.emplace_back(page);
+}
+
 std::vector<ColumnMapMainPage*> ColumnMapPageModifier::done() {
     if (mFillEndIdx != 0u) {
         flushFillPage();
@@ -645,28 +797,23 @@ void ColumnMapPageModifier::flushFillPage() {
         }
     }
 
-    // Copy all fixed size fields into the fill page
+    // Copy all fixed size fields into the fill page (decoding the columns of encoded source pages) and encode them
     if (mRecord.fixedSizeFieldCount() != 0) {
-        size_t fieldOffset = 0;
         auto fixedData = mFillPage->fixedData();
         for (decltype(mRecord.fixedSizeFieldCount()) i = 0; i < mRecord.fixedSizeFieldCount(); ++i) {
-            auto& field = mRecord.getFieldMeta(i).field;
-            auto fieldLength = field.staticSize();
+            auto fieldLength = mContext.fixedMetaData()[i].length;
 
             for (const auto& action : mCleanActions) {
-                auto srcData = action.page->fixedData() + action.page->count * fieldOffset
-                        + action.startIdx * fieldLength;
-                auto length = (action.endIdx - action.startIdx) * fieldLength;
-                memcpy(fixedData, srcData, length);
-                fixedData += length;
+                action.page->readFixedColumn(mContext, i, action.startIdx, action.endIdx, fixedData);
+                fixedData += (action.endIdx - action.startIdx) * fieldLength;
             }
-            fieldOffset += fieldLength;
         }
+        mFillPage->encodeFixedColumns(mContext);
     }
 
-    // Copy all variable size field heap entries
+    // Copy all variable size field heap entries and encode them
     // If the offset correction is 0 we can do a single memory copy otherwise we have to adjust the offset for every
-    // element.
+    // element. Columns encoded in the source page have to restore the prefix of every element.
     if (mRecord.varSizeFieldCount() != 0) {
 #ifndef NDEBUG
         auto minOffset = mFillPage->variableOffset + sizeof(ColumnMapHeapEntry) * mFillPage->count
@@ -677,7 +824,23 @@ void ColumnMapPageModifier::flushFillPage() {
             for (const auto& action : mCleanActions) {
                 auto heapEntries = action.page->variableData() + (action.page->count * i) + action.startIdx;
                 auto count = (action.endIdx - action.startIdx);
-                if (action.offsetCorrection == 0) {
+                if (action.page->isEncoded(mRecord.fixedSizeFieldCount() + i)) {
+                    // The prefix of an encoded column holds the dictionary code: Read the prefix from the heap instead
+                    auto endEntries = (i + 1u == mRecord.varSizeFieldCount()
+                            ? action.page->variableData() + action.startIdx - 1
+                            : heapEntries + action.page->count);
+                    for (auto endData = heapEntries + count; heapEntries != endData;
+                            ++heapEntries, ++endEntries, ++variableData) {
+                        auto newOffset = static_cast<int32_t>(heapEntries->offset) + action.offsetCorrection;
+                        LOG_ASSERT(newOffset >= static_cast<int32_t>(minOffset),
+                                "Corrected offset must be larger than page metadata");
+                        LOG_ASSERT(newOffset <= static_cast<int32_t>(TELL_PAGE_SIZE),
+                                "Corrected offset larger than page size");
+                        new (variableData) ColumnMapHeapEntry(static_cast<uint32_t>(newOffset),
+                                endEntries->offset - heapEntries->offset,
+                                reinterpret_cast<const char*>(action.page) + heapEntries->offset);
+                    }
+                } else if (action.offsetCorrection == 0) {
                     memcpy(variableData, heapEntries, count * sizeof(ColumnMapHeapEntry));
                     variableData += count;
                 } else {
@@ -692,6 +855,7 @@ void ColumnMapPageModifier::flushFillPage() {
                 }
             }
         }
+        mFillPage->encodeVariableColumns(mContext);
     }
     mCleanActions.clear();
 
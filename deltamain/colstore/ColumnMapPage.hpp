@@ -29,6 +29,7 @@
 #include <atomic>
 #include <cstdint>
 #include <cstddef>
+#include <utility>
 #include <vector>
 
 namespace tell {
@@ -93,21 +94,29 @@ struct alignas(8) ColumnMapHeapEntry {
  * --- Header: The first array contains the header (null bitmap) for every element stored in the page iff the schema
  *       requires a header. All headers are 8 byte padded like in the final record layout.
  * --- Fixed size fields: One array for every fixed size column in the schema storing the data associated with the field
- *       of every record.
+ *       of every record. The column is stored encoded in the space of the array if its bit in the encoded columns
+ *       bitmap is set (see ColumnMapEncodedColumn).
  * --- Variable size fields: One array for every variable size field in the schema containing the offset into the
  *       variable size heap and the 4 byte prefix of the value of every element stored in the page. As the heap grows
- *       backwards the offset is always calculated from the end of the heap.
+ *       backwards the offset is always calculated from the end of the heap. If the bit of the field in the encoded
+ *       columns bitmap is set the prefix is replaced by the code of the value in the dictionary of the column.
+ * - Dictionaries: The sorted distinct values of every encoded variable size column (only present if any variable size
+ *     column is encoded, see ColumnMapDictionaryColumn).
  * - Variable size heap: Heap containing all the variable sized data of the elements stored in the page. The data of an
  *     element is stored in a single contigous memory block in the heap (no split into columns). The heap grows from the
  *     end of the page and the data must be inserted with increasing offset so that the variable size data for the first
  *     element is stored right before the end of the variable size heap.
  */
 struct alignas(8) ColumnMapMainPage {
+    /// Maximum number of columns that can be stored encoded
+    static constexpr uint32_t MAX_ENCODED_COLUMNS = 64u;
+
     ColumnMapMainPage()
             : count(0u),
               headerOffset(0u),
               fixedOffset(0u),
-              variableOffset(0u) {
+              variableOffset(0u),
+              encodedColumns(0x0u) {
     }
 
     ColumnMapMainPage(const ColumnMapContext& context, uint32_t _count);
@@ -123,6 +132,13 @@ struct alignas(8) ColumnMapMainPage {
         return const_cast<ColumnMapMainEntry*>(const_cast<const ColumnMapMainPage*>(this)->entryData());
     }
 
+    /**
+     * @brief The smallest and largest key stored in this page
+     *
+     * Returns an empty range (smallest key larger than the largest key) if the page contains no elements.
+     */
+    std::pair<uint64_t, uint64_t> keyRange() const;
+
     /**
      * @brief Pointer to the array holding the size of the elements stored in this page
      */
@@ -156,6 +172,28 @@ struct alignas(8) ColumnMapMainPage {
         return const_cast<char*>(const_cast<const ColumnMapMainPage*>(this)->fixedData());
     }
 
+    /**
+     * @brief Whether the column (the field ID) is stored encoded in this page
+     */
+    bool isEncoded(uint32_t column) const {
+        return (column < MAX_ENCODED_COLUMNS) && ((encodedColumns >> column) & 0x1u) != 0u;
+    }
+
+    /**
+     * @brief Copies the values of the elements [startIdx, endIdx) of the fixed size column into the destination buffer
+     *
+     * Decodes the values in case the column is stored encoded.
+     */
+    void readFixedColumn(const ColumnMapContext& context, uint32_t column, uint32_t startIdx, uint32_t endIdx,
+            char* dest) const;
+
+    /**
+     * @brief Encodes every fixed size column of this page that can be stored in less space than the raw values
+     *
+     * Must only be called on a completely written page before it is made visible.
+     */
+    void encodeFixedColumns(const ColumnMapContext& context);
+
     /**
      * @brief Pointer to the beginning of the section where variable size fields are stored
      */
@@ -167,6 +205,26 @@ struct alignas(8) ColumnMapMainPage {
         return const_cast<ColumnMapHeapEntry*>(const_cast<const ColumnMapMainPage*>(this)->variableData());
     }
 
+    /**
+     * @brief Pointer to the dictionaries of the variable size columns following the heap entries
+     *
+     * Only valid if any variable size column is stored encoded.
+     */
+    const char* dictionaryData(const ColumnMapContext& context) const;
+
+    char* dictionaryData(const ColumnMapContext& context) {
+        return const_cast<char*>(const_cast<const ColumnMapMainPage*>(this)->dictionaryData(context));
+    }
+
+    /**
+     * @brief Encodes every variable size column of this page with only a few distinct values into a sorted dictionary
+     *
+     * The prefix in the heap entries of an encoded column is replaced by the code of the value. The dictionaries are
+     * only written if they fit into the free space between the heap entries and the variable size heap. Must only be
+     * called on a completely written page before it is made visible.
+     */
+    void encodeVariableColumns(const ColumnMapContext& context);
+
     /**
      * @brief Pointer to the variable size heap stored in this page
      *
@@ -199,6 +257,9 @@ struct alignas(8) ColumnMapMainPage {
     uint32_t fixedOffset;
 
     uint32_t variableOffset;
+
+    /// Bitmap containing a set bit for every column stored encoded (indexed by the field ID)
+    uint64_t encodedColumns;
 };
 
 /**
@@ -247,6 +308,14 @@ public:
      */
     bool append(InsertRecord& oldRecord);
 
+    /**
+     * @brief Adds a page restored from a checkpoint to the main
+     *
+     * Clears the newest pointers of all elements in the page (they refer to memory of the previous process) and inserts
+     * the newest version of every key into the main hash table.
+     */
+    void restore(ColumnMapMainPage* page);
+
     /**
      * @brief Completes the garbage collection process
      */
@@ -31,96 +31,84 @@
 #include <deltamain/Table.hpp>
 
 #include <util/LLVMBuilder.hpp>
+#include <util/LLVMRowScan.hpp>
 
 namespace tell {
 namespace store {
 namespace deltamain {
 
-namespace {
-
-const std::string COLUMN_MATERIALIZE_NAME = "colMaterialize.";
-
-} // anonymous namespace
-
-ColumnMapScan::ColumnMapScan(Table<ColumnMapContext>* table, std::vector<ScanQuery*> queries)
-        : LLVMRowScanBase(table->record(), std::move(queries)),
+ColumnMapScan::ColumnMapScan(Table<ColumnMapContext>* table, std::vector<ScanQuery*> queries,
+        LLVMCodeCache& codeCache)
+        : LLVMRowScanBase(table->tableId(), table->record(), std::move(queries), codeCache),
           mTable(table),
-          mColumnScanFun(nullptr) {
+          mColumnScanFun(nullptr),
+          mZoneMapFilter(table->record(), mQueries) {
 }
 
 void ColumnMapScan::prepareQuery() {
     LOG_ASSERT(!mColumnScanFun, "Scan already finalized");
-    LLVMColumnMapScanBuilder::createFunction(mTable->context(), mQueryModule.getModule(),
-            mQueryModule.getTargetMachine(), mScanAst);
+    if (!lookupQueryCode()) {
+        auto& module = createQueryModule();
+        LLVMColumnMapScanBuilder::createFunction(mTable->context(), module.getModule(), module.getTargetMachine(),
+                mScanAst);
+        LLVMRowScanBuilder::createFunction(module.getModule(), module.getTargetMachine(), mScanAst);
 
-    LLVMRowScanBase::prepareQuery();
+        compileQueryCode({ LLVMRowScanBuilder::FUNCTION_NAME, LLVMColumnMapScanBuilder::FUNCTION_NAME });
+    }
 
-    mColumnScanFun = mQueryModule.findFunction<ColumnScanFun>(LLVMColumnMapScanBuilder::FUNCTION_NAME);
+    mRowScanFun = reinterpret_cast<RowScanFun>(mQueryCode->functions.at(0));
+    mColumnScanFun = reinterpret_cast<ColumnScanFun>(mQueryCode->functions.at(1));
 }
 
 void ColumnMapScan::prepareMaterialization() {
     LOG_ASSERT(mColumnMaterializeFuns.empty(), "Scan already finalized");
     auto& context = mTable->context();
 
-    std::unordered_map<QueryDataHolder, std::string> materializeCache;
-    for (decltype(mQueries.size()) i = 0; i < mQueries.size(); ++i) {
-        auto q = mQueries[i];
-        if (q->queryType() == ScanQueryType::FULL) {
-            continue;
-        }
-
-        QueryDataHolder holder(q->query(), q->queryLength(), crossbow::to_underlying(q->queryType()));
-        if (materializeCache.find(holder) != materializeCache.end()) {
-            continue;
-        }
-
-        std::stringstream ss;
-        ss << COLUMN_MATERIALIZE_NAME << i;
-        auto name = ss.str();
-        materializeCache.emplace(holder, name);
-
-        switch (q->queryType()) {
-        case ScanQueryType::PROJECTION: {
-            LLVMColumnMapProjectionBuilder::createFunction(context, mMaterializationModule.getModule(),
-                    mMaterializationModule.getTargetMachine(), name, q);
-        } break;
-
-        case ScanQueryType::AGGREGATION: {
-            LLVMColumnMapAggregationBuilder::createFunction(context, mMaterializationModule.getModule(),
-                    mMaterializationModule.getTargetMachine(), name, q);
-        } break;
-
-        default: {
-            LOG_ASSERT(false, "Unknown query type");
-        } break;
+    compileMaterializationCode({
+        [this] (llvm::Module& module, llvm::TargetMachine* target, const std::string& name, ScanQuery* query) {
+            buildRowMaterialization(module, target, name, query);
+        },
+        [&context] (llvm::Module& module, llvm::TargetMachine* target, const std::string& name, ScanQuery* query) {
+            switch (query->queryType()) {
+            case ScanQueryType::PROJECTION: {
+                LLVMColumnMapProjectionBuilder::createFunction(context, module, target, name, query);
+            } break;
+
+            case ScanQueryType::AGGREGATION: {
+                LLVMColumnMapAggregationBuilder::createFunction(context, module, target, name, query);
+            } break;
+
+            case ScanQueryType::GROUP_BY: {
+                LLVMColumnMapGroupAggregationBuilder::createFunction(context, module, target, name, query);
+            } break;
+
+            default: {
+                LOG_ASSERT(false, "Unknown query type");
+            } break;
+            }
         }
-    }
+    });
 
-    LLVMRowScanBase::prepareMaterialization();
+    loadRowMaterialization();
 
     for (decltype(mQueries.size()) i = 0; i < mQueries.size(); ++i) {
-        auto q = mQueries[i];
-
-        if (q->queryType() == ScanQueryType::FULL) {
+        if (mQueries[i]->queryType() == ScanQueryType::FULL) {
             mColumnMaterializeFuns.emplace_back(reinterpret_cast<void*>(context.materializeFunction()));
             continue;
         }
-
-        QueryDataHolder holder(q->query(), q->queryLength(), crossbow::to_underlying(q->queryType()));
-        auto& name = materializeCache.at(holder);
-        auto fun = mMaterializationModule.findFunction<void*>(name);
-        mColumnMaterializeFuns.emplace_back(fun);
+        mColumnMaterializeFuns.emplace_back(mMaterializationCode[i]->functions.at(1));
     }
 }
 
 std::vector<std::unique_ptr<ColumnMapScanProcessor>> ColumnMapScan::startScan(size_t numThreads) {
-    return mTable->startScan(numThreads, mQueries, mColumnScanFun, mColumnMaterializeFuns, mRowScanFun,
-            mRowMaterializeFuns, mScanAst.numConjunct);
+    return mTable->startScan(numThreads, mQueries, mZoneMapFilter, mColumnScanFun, mColumnMaterializeFuns,
+            mRowScanFun, mRowMaterializeFuns, mNumConjunct);
 }
 
 ColumnMapScanProcessor::ColumnMapScanProcessor(const ColumnMapContext& context, const Record& record,
-        const std::vector<ScanQuery*>& queries, const PageList& pages, size_t pageIdx, size_t pageEndIdx,
-        const LogIterator& logIter, const LogIterator& logEnd, ColumnMapScan::ColumnScanFun columnScanFun,
+        const std::vector<ScanQuery*>& queries, const PageList& pages, const ZoneMapList& zoneMaps,
+        std::shared_ptr<MorselQueue> morsels, const ZoneMapFilter& zoneMapFilter,
+        ColumnMapScan::ColumnScanFun columnScanFun,
         const std::vector<void*>& columnMaterializeFuns, ColumnMapScan::RowScanFun rowScanFun,
         const std::vector<ColumnMapScan::RowMaterializeFun>& rowMaterializeFuns, uint32_t numConjuncts)
         : LLVMRowScanProcessorBase(record, queries, rowScanFun, rowMaterializeFuns, numConjuncts),
@@ -128,18 +116,34 @@ ColumnMapScanProcessor::ColumnMapScanProcessor(const ColumnMapContext& context,
           mColumnScanFun(columnScanFun),
           mColumnMaterializeFuns(columnMaterializeFuns),
           pages(pages),
-          pageIdx(pageIdx),
-          pageEndIdx(pageEndIdx),
-          logIter(logIter),
-          logEnd(logEnd) {
+          zoneMaps(zoneMaps),
+          morsels(std::move(morsels)),
+          mZoneMapFilter(zoneMapFilter),
+          mActiveData(queries.size(), 1u) {
 }
 
-void ColumnMapScanProcessor::process() {
-    for (auto i = pageIdx; i < pageEndIdx; ++i) {
+bool ColumnMapScanProcessor::processNext() {
+    // Stop early when every query already received all the tuples it asked for
+    if (queriesDone()) {
+        return false;
+    }
+
+    auto morsel = morsels->next();
+    if (!morsel) {
+        return false;
+    }
+
+    for (auto i = morsel->pageIdx; i < morsel->pageEndIdx; ++i) {
+        if (canSkipPage(pages[i], zoneMaps[i])) {
+            continue;
+        }
         processMainPage(pages[i], 0, pages[i]->count);
     }
+    processInsertLog(morsel->logIter, morsel->logEnd);
+    return true;
+}
 
-    auto insIter = logIter;
+void ColumnMapScanProcessor::processInsertLog(LogIterator insIter, const LogIterator& logEnd) {
     while (insIter != logEnd) {
         if (!insIter->sealed()) {
             ++insIter;
@@ -204,6 +208,20 @@ void ColumnMapScanProcessor::process() {
     }
 }
 
+bool ColumnMapScanProcessor::canSkipPage(const ColumnMapMainPage* page, const ColumnMapZoneMap& zoneMap) const {
+    if (!mZoneMapFilter.canSkip(zoneMap)) {
+        return false;
+    }
+
+    auto entries = page->entryData();
+    for (decltype(page->count) i = 0; i < page->count; ++i) {
+        if (entries[i].newest.load() != 0u) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void ColumnMapScanProcessor::processMainPage(const ColumnMapMainPage* page, uint64_t startIdx, uint64_t endIdx) {
     mKeyData.resize(page->count, 0u);
     mValidFromData.resize(page->count, 0u);
@@ -313,13 +331,26 @@ void ColumnMapScanProcessor::evaluateMainQueries(const ColumnMapMainPage* page,
     LOG_ASSERT(mValidFromData.size() == page->count, "Size of valid-from array does not match the page size");
     LOG_ASSERT(mValidToData.size() == page->count, "Size of valid-to array does not match the page size");
 
+    // Queries that reached their limit do not need any more tuples
+    for (decltype(mQueries.size()) i = 0; i < mQueries.size(); ++i) {
+        mActiveData[i] = (mQueries[i].done() ? 0u : 1u);
+    }
+
     mColumnScanFun(&mKeyData.front(), &mValidFromData.front(), &mValidToData.front(),
-            reinterpret_cast<const char*>(page), startIdx, endIdx, &mResult.front());
+            reinterpret_cast<const char*>(page), startIdx, endIdx, &mResult.front(), mVersionData.data(),
+            mActiveData.data());
 
     auto entries = page->entryData();
     auto sizeData = page->sizeData();
     auto result = &mResult.front();
     for (decltype(mQueries.size()) i = 0; i < mQueries.size(); ++i) {
+        // The scan did not evaluate the selection of queries that reached their limit before the page, queries reaching
+        // their limit in the meantime do not need any more tuples either
+        if (mActiveData[i] == 0u || mQueries[i].done()) {
+            result += page->count;
+            continue;
+        }
+
         switch (mQueries[i].data()->queryType()) {
         case ScanQueryType::FULL: {
         case ScanQueryType::PROJECTION:
@@ -336,10 +367,45 @@ void ColumnMapScanProcessor::evaluateMainQueries(const ColumnMapMainPage* page,
         } break;
 
         case ScanQueryType::AGGREGATION: {
+            // Aggregations do not pass through writeRecord - Remove the elements outside the key range from the result
+            auto query = mQueries[i].data();
+            if (query->hasKeyRange()) {
+                for (decltype(startIdx) j = startIdx; j < endIdx; ++j) {
+                    if (!query->inKeyRange(entries[j].key)) {
+                        result[j] = 0u;
+                    }
+                }
+            }
+
             auto fun = reinterpret_cast<ColumnMapScan::ColumnAggregationFun>(mColumnMaterializeFuns[i]);
             fun(reinterpret_cast<const char*>(page), startIdx, endIdx, result, mQueries[i].mBuffer + 8);
         } break;
 
+        case ScanQueryType::GROUP_BY: {
+            // Look up the aggregation state of the group of every element matching the selection - Remove the elements
+            // not part of the scan (outside the key range or the snapshot) from the result
+            auto query = mQueries[i].data();
+            if (mGroupStates.size() < page->count) {
+                mGroupStates.resize(page->count, nullptr);
+            }
+            for (decltype(startIdx) j = startIdx; j < endIdx; ++j) {
+                if (result[j] == 0u) {
+                    continue;
+                }
+                mGroupStates[j] = mQueries[i].groupState(entries[j].key, entries[j].version, mValidToData[j],
+                        [this, query, page, j] (std::string& groupKey) {
+                    appendGroupKey(query, page, j, groupKey);
+                });
+                if (!mGroupStates[j]) {
+                    result[j] = 0u;
+                }
+            }
+
+            // Aggregate all remaining elements into the state of their group in a single pass over the page
+            auto fun = reinterpret_cast<ColumnMapScan::ColumnGroupAggregationFun>(mColumnMaterializeFuns[i]);
+            fun(reinterpret_cast<const char*>(page), startIdx, endIdx, result, mGroupStates.data());
+        } break;
+
         }
         result += page->count;
     }
@@ -349,6 +415,47 @@ void ColumnMapScanProcessor::evaluateMainQueries(const ColumnMapMainPage* page,
     mValidToData.clear();
 }
 
+void ColumnMapScanProcessor::appendGroupKey(const ScanQuery* query, const ColumnMapMainPage* page, uint64_t idx,
+        std::string& groupKey) const {
+    auto& fixedMetaData = mContext.fixedMetaData();
+    auto fixedSizeFieldCount = mRecord.fixedSizeFieldCount();
+    auto varSizeFieldCount = mRecord.varSizeFieldCount();
+    auto heapEntries = page->variableData();
+
+    for (auto i = query->groupByBegin(); i != query->groupByEnd(); ++i) {
+        auto id = *i;
+        auto& fieldMeta = mRecord.getFieldMeta(id);
+        auto& field = fieldMeta.field;
+        if (!field.isNotNull()) {
+            auto isNull = (page->headerData()[page->count * fieldMeta.nullIdx + idx] != 0);
+            groupKey.push_back(isNull ? 1 : 0);
+            if (isNull) {
+                continue;
+            }
+        }
+
+        if (field.isFixedSized()) {
+            auto length = fixedMetaData[id].length;
+            if (page->isEncoded(id)) {
+                char value[sizeof(uint64_t)];
+                page->readFixedColumn(mContext, id, idx, idx + 1u, value);
+                groupKey.append(value, length);
+            } else {
+                groupKey.append(page->fixedData() + page->count * fixedMetaData[id].offset + idx * length, length);
+            }
+        } else {
+            // The value ends where the value in the next column starts, the value in the last column ends where the
+            // value of the previous element in the first column starts
+            auto varIdx = id - fixedSizeFieldCount;
+            auto startEntries = heapEntries + page->count * varIdx;
+            auto endEntries = (varIdx + 1u == varSizeFieldCount ? heapEntries - 1 : startEntries + page->count);
+            auto length = endEntries[idx].offset - startEntries[idx].offset;
+            groupKey.append(reinterpret_cast<const char*>(&length), sizeof(uint32_t));
+            groupKey.append(reinterpret_cast<const char*>(page) + startEntries[idx].offset, length);
+        }
+    }
+}
+
 uint64_t ColumnMapScanProcessor::processUpdateRecord(const UpdateLogEntry* ptr, uint64_t baseVersion,
         uint64_t& validTo) {
     UpdateRecordIterator updateIter(ptr, baseVersion);
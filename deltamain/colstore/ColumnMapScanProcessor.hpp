@@ -23,16 +23,21 @@
 
 #pragma once
 
+#include "ColumnMapZoneMap.hpp"
 #include "LLVMColumnMapAggregation.hpp"
+#include "LLVMColumnMapGroupAggregation.hpp"
 #include "LLVMColumnMapProjection.hpp"
 #include "LLVMColumnMapScan.hpp"
 
+#include <deltamain/ScanMorsel.hpp>
+
 #include <util/LLVMScan.hpp>
 #include <util/Log.hpp>
 
 #include <crossbow/allocator.hpp>
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace tell {
@@ -63,7 +68,9 @@ public:
 
     using ColumnAggregationFun = LLVMColumnMapAggregationBuilder::Signature;
 
-    ColumnMapScan(Table<ColumnMapContext>* table, std::vector<ScanQuery*> queries);
+    using ColumnGroupAggregationFun = LLVMColumnMapGroupAggregationBuilder::Signature;
+
+    ColumnMapScan(Table<ColumnMapContext>* table, std::vector<ScanQuery*> queries, LLVMCodeCache& codeCache);
 
     void prepareQuery();
 
@@ -77,26 +84,53 @@ private:
     ColumnScanFun mColumnScanFun;
 
     std::vector<void*> mColumnMaterializeFuns;
+
+    ZoneMapFilter mZoneMapFilter;
 };
 
 class ColumnMapScanProcessor : public LLVMRowScanProcessorBase {
 public:
     using LogIterator = Log<OrderedLogImpl>::ConstLogIterator;
     using PageList = std::vector<ColumnMapMainPage*>;
+    using ZoneMapList = std::vector<ColumnMapZoneMap>;
 
     ColumnMapScanProcessor(const ColumnMapContext& context, const Record& record,
-            const std::vector<ScanQuery*>& queries, const PageList& pages, size_t pageIdx, size_t pageEndIdx,
-            const LogIterator& logIter, const LogIterator& logEnd, ColumnMapScan::ColumnScanFun columnScanFun,
+            const std::vector<ScanQuery*>& queries, const PageList& pages, const ZoneMapList& zoneMaps,
+            std::shared_ptr<MorselQueue> morsels, const ZoneMapFilter& zoneMapFilter,
+            ColumnMapScan::ColumnScanFun columnScanFun,
             const std::vector<void*>& columnMaterializeFuns, ColumnMapScan::RowScanFun rowScanFun,
             const std::vector<ColumnMapScan::RowMaterializeFun>& rowMaterializeFuns, uint32_t numConjuncts);
 
-    void process();
+    /**
+     * @brief Processes the next morsel from the shared morsel queue
+     *
+     * @return False if all morsels of the scan have been handed out and the processor has no more work
+     */
+    bool processNext();
 
 private:
+    void processInsertLog(LogIterator insIter, const LogIterator& logEnd);
+
+    /**
+     * @brief Whether the page can be skipped because no query can match any of its elements
+     *
+     * Pages containing elements with pending updates or relocations are never skipped as the newer versions are not
+     * covered by the zone map.
+     */
+    bool canSkipPage(const ColumnMapMainPage* page, const ColumnMapZoneMap& zoneMap) const;
+
     void processMainPage(const ColumnMapMainPage* page, uint64_t startIdx, uint64_t endIdx);
 
     void evaluateMainQueries(const ColumnMapMainPage* page, uint64_t startIdx, uint64_t endIdx);
 
+    /**
+     * @brief Appends the group key of the element in the page to the given string
+     *
+     * Produces the same encoding as ScanQuery::appendGroupKey does for the element in row format.
+     */
+    void appendGroupKey(const ScanQuery* query, const ColumnMapMainPage* page, uint64_t idx,
+            std::string& groupKey) const;
+
     uint64_t processUpdateRecord(const UpdateLogEntry* ptr, uint64_t baseVersion, uint64_t& validTo);
 
     const ColumnMapContext& mContext;
@@ -106,14 +140,20 @@ private:
     std::vector<void*> mColumnMaterializeFuns;
 
     const PageList& pages;
-    size_t pageIdx;
-    size_t pageEndIdx;
-    LogIterator logIter;
-    LogIterator logEnd;
+    const ZoneMapList& zoneMaps;
+    std::shared_ptr<MorselQueue> morsels;
+
+    const ZoneMapFilter& mZoneMapFilter;
 
     std::vector<uint64_t> mKeyData;
     std::vector<uint64_t> mValidFromData;
     std::vector<uint64_t> mValidToData;
+
+    /// Whether the query still needs tuples, conjuncts only used by finished queries are not evaluated by the scan
+    std::vector<uint8_t> mActiveData;
+
+    /// Aggregation state of the group of every element in the page (only valid for elements of a group by query)
+    std::vector<char*> mGroupStates;
 };
 
 } // namespace deltamain
@@ -0,0 +1,531 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include "ColumnMapZoneMap.hpp"
+
+#include "ColumnMapContext.hpp"
+#include "ColumnMapEncoding.hpp"
+#include "ColumnMapPage.hpp"
+
+#include <util/ScanQuery.hpp>
+
+#include <tellstore/Record.hpp>
+
+#include <crossbow/byte_buffer.hpp>
+#include <crossbow/logger.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace tell {
+namespace store {
+namespace deltamain {
+namespace {
+
+/**
+ * @brief Computes the zone map of a single column with values of type T stored as member V of the zone map value
+ *
+ * @param data Pointer to the values of the column
+ * @param nullData Pointer to the null bytes of the column or null if the column is not nullable
+ * @param count Number of elements in the column
+ */
+template <typename T, typename V>
+ColumnZoneMap buildZoneMap(const char* data, const char* nullData, uint32_t count, V ZoneMapValue::* member) {
+    ColumnZoneMap zoneMap;
+    zoneMap.min.*member = std::numeric_limits<V>::max();
+    zoneMap.max.*member = std::numeric_limits<V>::lowest();
+    zoneMap.valueCount = 0u;
+    zoneMap.nullCount = 0u;
+    zoneMap.distinctCount = 0u;
+    auto distinctFull = false;
+
+    auto values = reinterpret_cast<const T*>(data);
+    for (decltype(count) i = 0; i < count; ++i) {
+        if (nullData && nullData[i] != 0) {
+            ++zoneMap.nullCount;
+            continue;
+        }
+
+        // NaN values never satisfy any comparison and are not part of the range
+        auto value = static_cast<V>(values[i]);
+        if (value != value) {
+            continue;
+        }
+        zoneMap.min.*member = std::min(zoneMap.min.*member, value);
+        zoneMap.max.*member = std::max(zoneMap.max.*member, value);
+        ++zoneMap.valueCount;
+
+        if (distinctFull) {
+            continue;
+        }
+        auto distinctEnd = zoneMap.distinctValues + zoneMap.distinctCount;
+        auto known = std::any_of(zoneMap.distinctValues, distinctEnd, [member, value] (const ZoneMapValue& entry) {
+            return entry.*member == value;
+        });
+        if (known) {
+            continue;
+        }
+        if (zoneMap.distinctCount == ColumnZoneMap::MAX_DISTINCT_VALUES) {
+            distinctFull = true;
+            continue;
+        }
+        zoneMap.distinctValues[zoneMap.distinctCount++].*member = value;
+    }
+
+    if (distinctFull) {
+        zoneMap.distinctCount = 0u;
+    }
+    return zoneMap;
+}
+
+/**
+ * @brief Whether any of the distinct values satisfies the equality comparison with the value
+ */
+template <typename T>
+bool distinctMightMatch(PredicateType type, const ZoneMapValue* begin, const ZoneMapValue* end, T value,
+        T ZoneMapValue::* member) {
+    return std::any_of(begin, end, [type, value, member] (const ZoneMapValue& entry) {
+        return (type == PredicateType::EQUAL ? entry.*member == value : entry.*member != value);
+    });
+}
+
+/**
+ * @brief Whether any value of the column lies in the inclusive range [lower, upper]
+ *
+ * The distinct values are checked exactly if the column has only a few of them.
+ */
+template <typename T>
+bool betweenMightMatch(const ColumnZoneMap& zoneMap, T lower, T upper, T ZoneMapValue::* member) {
+    if (zoneMap.distinctCount != 0u) {
+        return std::any_of(zoneMap.distinctValues, zoneMap.distinctValues + zoneMap.distinctCount,
+                [lower, upper, member] (const ZoneMapValue& entry) {
+            return (lower <= entry.*member && entry.*member <= upper);
+        });
+    }
+    return (lower <= zoneMap.max.*member && zoneMap.min.*member <= upper);
+}
+
+/**
+ * @brief Reads a single 8 byte value of an IN_LIST or BETWEEN predicate on a fixed size column
+ */
+ZoneMapValue readListValue(FieldType type, crossbow::buffer_reader& reader) {
+    ZoneMapValue value;
+    switch (type) {
+    case FieldType::SMALLINT: {
+        value.integer = reader.read<int16_t>();
+        reader.advance(6);
+    } break;
+
+    case FieldType::INT: {
+        value.integer = reader.read<int32_t>();
+        reader.advance(4);
+    } break;
+
+    case FieldType::FLOAT: {
+        value.floating = reader.read<float>();
+        reader.advance(4);
+    } break;
+
+    case FieldType::DOUBLE: {
+        value.floating = reader.read<double>();
+    } break;
+
+    default: {
+        value.integer = reader.read<int64_t>();
+    } break;
+    }
+    return value;
+}
+
+/**
+ * @brief Whether any value in the range [min, max] might satisfy the comparison with the value
+ */
+template <typename T>
+bool rangeMightMatch(PredicateType type, T min, T max, T value) {
+    switch (type) {
+    case PredicateType::EQUAL:
+        return (min <= value && value <= max);
+
+    case PredicateType::NOT_EQUAL:
+        return !(min == value && max == value);
+
+    case PredicateType::LESS:
+        return (min < value);
+
+    case PredicateType::LESS_EQUAL:
+        return (min <= value);
+
+    case PredicateType::GREATER:
+        return (max > value);
+
+    case PredicateType::GREATER_EQUAL:
+        return (max >= value);
+
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Lexicographically compares the distinct value with the given data
+ */
+int compareText(const crossbow::string& lhs, const char* data, size_t length) {
+    return compareVariableValues(lhs.data(), lhs.size(), data, length);
+}
+
+/**
+ * @brief Computes the zone map of a single variable size column
+ *
+ * @param page The page the column is stored in
+ * @param startEntries Pointer to the heap entries of the column
+ * @param endEntries Pointer to the heap entries marking the end of every value of the column
+ * @param nullData Pointer to the null bytes of the column or null if the column is not nullable
+ * @param count Number of elements in the column
+ */
+VariableZoneMap buildVariableZoneMap(const ColumnMapMainPage* page, const ColumnMapHeapEntry* startEntries,
+        const ColumnMapHeapEntry* endEntries, const char* nullData, uint32_t count) {
+    VariableZoneMap zoneMap;
+    zoneMap.nullCount = 0u;
+    if (nullData) {
+        zoneMap.nullCount = static_cast<uint32_t>(std::count_if(nullData, nullData + count, [] (char isNull) {
+            return isNull != 0;
+        }));
+    }
+
+    auto pageData = reinterpret_cast<const char*>(page);
+    std::vector<uint32_t> distinctIdx;
+    zoneMap.hasDistinctValues = collectDistinctValues(pageData, startEntries, endEntries, nullData, count,
+            VariableZoneMap::MAX_DISTINCT_VALUES, distinctIdx);
+
+    zoneMap.distinctValues.reserve(distinctIdx.size());
+    for (auto i : distinctIdx) {
+        zoneMap.distinctValues.emplace_back(pageData + startEntries[i].offset,
+                endEntries[i].offset - startEntries[i].offset);
+    }
+    return zoneMap;
+}
+
+/**
+ * @brief Whether the distinct value satisfies the comparison with the value
+ */
+bool textMatches(PredicateType type, const crossbow::string& entry, const crossbow::string& value) {
+    switch (type) {
+    case PredicateType::EQUAL:
+        return (compareText(entry, value.data(), value.size()) == 0);
+
+    case PredicateType::NOT_EQUAL:
+        return (compareText(entry, value.data(), value.size()) != 0);
+
+    case PredicateType::PREFIX_LIKE:
+    case PredicateType::PREFIX_NOT_LIKE: {
+        auto match = (entry.size() >= value.size() && memcmp(entry.data(), value.data(), value.size()) == 0);
+        return (type == PredicateType::PREFIX_LIKE ? match : !match);
+    }
+
+    case PredicateType::POSTFIX_LIKE:
+    case PredicateType::POSTFIX_NOT_LIKE: {
+        auto match = (entry.size() >= value.size()
+                && memcmp(entry.data() + (entry.size() - value.size()), value.data(), value.size()) == 0);
+        return (type == PredicateType::POSTFIX_LIKE ? match : !match);
+    }
+
+    default:
+        return true;
+    }
+}
+
+} // anonymous namespace
+
+ColumnMapZoneMap::ColumnMapZoneMap(const ColumnMapContext& context, const ColumnMapMainPage* page)
+        : mCount(page->count) {
+    auto& record = context.record();
+    auto& fixedMetaData = context.fixedMetaData();
+
+    std::vector<char> decodedData;
+    mColumns.reserve(fixedMetaData.size());
+    for (decltype(fixedMetaData.size()) i = 0; i < fixedMetaData.size(); ++i) {
+        auto& fieldMeta = record.getFieldMeta(i);
+        auto& field = fieldMeta.field;
+
+        const char* data = page->fixedData() + page->count * fixedMetaData[i].offset;
+        if (page->isEncoded(i)) {
+            decodedData.resize(page->count * fixedMetaData[i].length);
+            page->readFixedColumn(context, i, 0u, page->count, decodedData.data());
+            data = decodedData.data();
+        }
+        auto nullData = (field.isNotNull() ? nullptr : page->headerData() + page->count * fieldMeta.nullIdx);
+
+        switch (field.type()) {
+        case FieldType::SMALLINT: {
+            mColumns.emplace_back(buildZoneMap<int16_t>(data, nullData, mCount, &ZoneMapValue::integer));
+        } break;
+
+        case FieldType::INT: {
+            mColumns.emplace_back(buildZoneMap<int32_t>(data, nullData, mCount, &ZoneMapValue::integer));
+        } break;
+
+        case FieldType::BIGINT: {
+            mColumns.emplace_back(buildZoneMap<int64_t>(data, nullData, mCount, &ZoneMapValue::integer));
+        } break;
+
+        case FieldType::FLOAT: {
+            mColumns.emplace_back(buildZoneMap<float>(data, nullData, mCount, &ZoneMapValue::floating));
+        } break;
+
+        case FieldType::DOUBLE: {
+            mColumns.emplace_back(buildZoneMap<double>(data, nullData, mCount, &ZoneMapValue::floating));
+        } break;
+
+        default: {
+            LOG_ASSERT(false, "Unknown fixed size field type");
+            mColumns.emplace_back(ColumnZoneMap());
+        } break;
+        }
+    }
+
+    auto varSizeFieldCount = record.varSizeFieldCount();
+    if (varSizeFieldCount == 0u) {
+        return;
+    }
+
+    // The value of an element ends where the value in the next column starts, the value in the last column ends where
+    // the value of the previous element in the first column starts (a sentinel precedes the first heap entry)
+    auto heapEntries = page->variableData();
+    mVariableColumns.reserve(varSizeFieldCount);
+    for (decltype(varSizeFieldCount) i = 0; i < varSizeFieldCount; ++i) {
+        auto& fieldMeta = record.getFieldMeta(record.fixedSizeFieldCount() + i);
+        auto nullData = (fieldMeta.field.isNotNull()
+                ? nullptr
+                : page->headerData() + page->count * fieldMeta.nullIdx);
+
+        auto startEntries = heapEntries + page->count * i;
+        auto endEntries = (i + 1u == varSizeFieldCount ? heapEntries - 1 : startEntries + page->count);
+        mVariableColumns.emplace_back(buildVariableZoneMap(page, startEntries, endEntries, nullData, mCount));
+    }
+}
+
+ZoneMapFilter::ZoneMapFilter(const Record& record, const std::vector<ScanQuery*>& queries) {
+    mQueries.reserve(queries.size());
+    for (auto query : queries) {
+        crossbow::buffer_reader queryReader(query->selection(), query->selectionLength());
+
+        auto numColumns = queryReader.read<uint32_t>();
+        auto numConjunct = queryReader.read<uint16_t>();
+        queryReader.advance(sizeof(uint16_t) + 2 * sizeof(uint32_t));
+
+        std::vector<Conjunct> conjuncts(numConjunct);
+        for (decltype(numColumns) i = 0; i < numColumns; ++i) {
+            auto column = queryReader.read<uint16_t>();
+            auto numPredicates = queryReader.read<uint16_t>();
+            queryReader.advance(4);
+
+            auto& field = record.getFieldMeta(column).field;
+            auto isVariable = !field.isFixedSized();
+            for (decltype(numPredicates) j = 0; j < numPredicates; ++j) {
+                Predicate predicate;
+                predicate.type = queryReader.read<PredicateType>();
+                predicate.checkable = true;
+                predicate.isFloat = (field.type() == FieldType::FLOAT || field.type() == FieldType::DOUBLE);
+                predicate.isVariable = isVariable;
+                predicate.column = (isVariable ? column - record.fixedSizeFieldCount() : column);
+                predicate.value.integer = 0;
+                auto conjunct = queryReader.read<uint8_t>();
+
+                if (predicate.type == PredicateType::IS_NULL || predicate.type == PredicateType::IS_NOT_NULL) {
+                    queryReader.advance(6);
+                } else if (predicate.type == PredicateType::IN_LIST || predicate.type == PredicateType::BETWEEN) {
+                    queryReader.advance(2);
+                    auto numValues = queryReader.read<uint32_t>();
+                    LOG_ASSERT(conjunct < conjuncts.size(), "Conjunct out of range");
+
+                    if (predicate.type == PredicateType::BETWEEN) {
+                        LOG_ASSERT(numValues == 2u && !isVariable, "Invalid BETWEEN predicate");
+                        predicate.value = readListValue(field.type(), queryReader);
+                        predicate.upper = readListValue(field.type(), queryReader);
+                        conjuncts[conjunct].emplace_back(predicate);
+                        continue;
+                    }
+
+                    // An IN-list matches if any of its values matches: Split it into equality predicates
+                    predicate.type = PredicateType::EQUAL;
+                    for (decltype(numValues) k = 0; k < numValues; ++k) {
+                        if (isVariable) {
+                            auto size = queryReader.read<uint32_t>();
+                            auto data = queryReader.read(size);
+                            queryReader.align(8u);
+                            predicate.text = crossbow::string(data, size);
+                        } else {
+                            predicate.value = readListValue(field.type(), queryReader);
+                        }
+                        conjuncts[conjunct].emplace_back(predicate);
+                    }
+                    continue;
+                } else {
+                    switch (field.type()) {
+                    case FieldType::SMALLINT: {
+                        predicate.value.integer = queryReader.read<int16_t>();
+                        queryReader.advance(4);
+                    } break;
+
+                    case FieldType::INT: {
+                        queryReader.advance(2);
+                        predicate.value.integer = queryReader.read<int32_t>();
+                    } break;
+
+                    case FieldType::BIGINT: {
+                        queryReader.advance(6);
+                        predicate.value.integer = queryReader.read<int64_t>();
+                    } break;
+
+                    case FieldType::FLOAT: {
+                        queryReader.advance(2);
+                        predicate.value.floating = queryReader.read<float>();
+                    } break;
+
+                    case FieldType::DOUBLE: {
+                        queryReader.advance(6);
+                        predicate.value.floating = queryReader.read<double>();
+                    } break;
+
+                    default: {
+                        queryReader.advance(2);
+                        auto size = queryReader.read<uint32_t>();
+                        auto data = queryReader.read(size);
+                        queryReader.align(8u);
+                        predicate.text = crossbow::string(data, size);
+
+                        // Range comparisons are not supported on variable size columns
+                        predicate.checkable = (predicate.type == PredicateType::EQUAL
+                                || predicate.type == PredicateType::NOT_EQUAL
+                                || predicate.type == PredicateType::PREFIX_LIKE
+                                || predicate.type == PredicateType::PREFIX_NOT_LIKE
+                                || predicate.type == PredicateType::POSTFIX_LIKE
+                                || predicate.type == PredicateType::POSTFIX_NOT_LIKE);
+                    } break;
+                    }
+                }
+
+                LOG_ASSERT(conjunct < conjuncts.size(), "Conjunct out of range");
+                conjuncts[conjunct].emplace_back(predicate);
+            }
+        }
+        mQueries.emplace_back(std::move(conjuncts));
+    }
+}
+
+bool ZoneMapFilter::canSkip(const ColumnMapZoneMap& zoneMap) const {
+    auto& columns = zoneMap.columns();
+    auto& variableColumns = zoneMap.variableColumns();
+    auto predicateMightMatch = [&columns, &variableColumns, &zoneMap] (const Predicate& predicate) {
+        if (!predicate.checkable) {
+            return true;
+        }
+        if (predicate.isVariable) {
+            return (predicate.column >= variableColumns.size()
+                    || mightMatch(predicate, variableColumns[predicate.column], zoneMap.count()));
+        }
+        return (predicate.column >= columns.size()
+                || mightMatch(predicate, columns[predicate.column], zoneMap.count()));
+    };
+
+    // Every query must contain a conjunct of which no predicate might match
+    return std::all_of(mQueries.begin(), mQueries.end(), [&predicateMightMatch] (const std::vector<Conjunct>& query) {
+        return std::any_of(query.begin(), query.end(), [&predicateMightMatch] (const Conjunct& conjunct) {
+            return !conjunct.empty() && std::none_of(conjunct.begin(), conjunct.end(), predicateMightMatch);
+        });
+    });
+}
+
+bool ZoneMapFilter::mightMatch(const Predicate& predicate, const ColumnZoneMap& zoneMap, uint32_t count) {
+    switch (predicate.type) {
+    case PredicateType::IS_NULL:
+        return (zoneMap.nullCount != 0u);
+
+    case PredicateType::IS_NOT_NULL:
+        return (zoneMap.nullCount != count);
+
+    default:
+        break;
+    }
+
+    // Comparisons never match NULL values
+    if (zoneMap.valueCount == 0u) {
+        return false;
+    }
+
+    // Equality predicates are checked exactly against the distinct values if the column has only a few of them
+    if (zoneMap.distinctCount != 0u
+            && (predicate.type == PredicateType::EQUAL || predicate.type == PredicateType::NOT_EQUAL)) {
+        auto distinctEnd = zoneMap.distinctValues + zoneMap.distinctCount;
+        if (predicate.isFloat) {
+            return distinctMightMatch(predicate.type, zoneMap.distinctValues, distinctEnd, predicate.value.floating,
+                    &ZoneMapValue::floating);
+        }
+        return distinctMightMatch(predicate.type, zoneMap.distinctValues, distinctEnd, predicate.value.integer,
+                &ZoneMapValue::integer);
+    }
+
+    if (predicate.type == PredicateType::BETWEEN) {
+        if (predicate.isFloat) {
+            return betweenMightMatch(zoneMap, predicate.value.floating, predicate.upper.floating,
+                    &ZoneMapValue::floating);
+        }
+        return betweenMightMatch(zoneMap, predicate.value.integer, predicate.upper.integer, &ZoneMapValue::integer);
+    }
+
+    if (predicate.isFloat) {
+        return rangeMightMatch(predicate.type, zoneMap.min.floating, zoneMap.max.floating, predicate.value.floating);
+    }
+    return rangeMightMatch(predicate.type, zoneMap.min.integer, zoneMap.max.integer, predicate.value.integer);
+}
+
+bool ZoneMapFilter::mightMatch(const Predicate& predicate, const VariableZoneMap& zoneMap, uint32_t count) {
+    switch (predicate.type) {
+    case PredicateType::IS_NULL:
+        return (zoneMap.nullCount != 0u);
+
+    case PredicateType::IS_NOT_NULL:
+        return (zoneMap.nullCount != count);
+
+    default:
+        break;
+    }
+
+    // Comparisons never match NULL values
+    if (zoneMap.nullCount == count) {
+        return false;
+    }
+
+    if (!zoneMap.hasDistinctValues) {
+        return true;
+    }
+    return std::any_of(zoneMap.distinctValues.begin(), zoneMap.distinctValues.end(),
+            [&predicate] (const crossbow::string& entry) {
+        return textMatches(predicate.type, entry, predicate.text);
+    });
+}
+
+} // namespace deltamain
+} // namespace store
+} // namespace tell
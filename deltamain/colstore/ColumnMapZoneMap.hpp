@@ -0,0 +1,212 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#pragma once
+
+#include <tellstore/StdTypes.hpp>
+
+#include <crossbow/string.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace tell {
+namespace store {
+
+class Record;
+class ScanQuery;
+
+namespace deltamain {
+
+class ColumnMapContext;
+struct ColumnMapMainPage;
+
+/**
+ * @brief Value stored in a zone map
+ *
+ * Integer columns store their values as 64 bit integer, floating point columns as double.
+ */
+union ZoneMapValue {
+    int64_t integer;
+    double floating;
+};
+
+/**
+ * @brief Statistics about the values of a single fixed size column in a column map page
+ *
+ * Columns with only a few distinct values additionally record all of them so equality predicates can be checked
+ * exactly. The statistics are only used to skip pages: The column data in the page itself is stored uncompressed.
+ */
+struct ColumnZoneMap {
+    /// Maximum number of distinct values recorded per column
+    static constexpr uint32_t MAX_DISTINCT_VALUES = 8u;
+
+    /// Smallest non-NULL value stored in the column
+    ZoneMapValue min;
+
+    /// Largest non-NULL value stored in the column
+    ZoneMapValue max;
+
+    /// Number of non-NULL values (excluding NaN) covered by the min and max value
+    uint32_t valueCount;
+
+    /// Number of NULL values stored in the column
+    uint32_t nullCount;
+
+    /// Number of recorded distinct values or 0 if the column has more than MAX_DISTINCT_VALUES values
+    uint32_t distinctCount;
+
+    /// Distinct non-NULL values stored in the column (in no particular order)
+    ZoneMapValue distinctValues[MAX_DISTINCT_VALUES];
+};
+
+/**
+ * @brief Statistics about the values of a single variable size column in a column map page
+ *
+ * Low cardinality columns record all their distinct values in sorted order so equality and LIKE predicates can be
+ * checked against them once per page. The statistics are only used to skip pages: The values are still stored in the
+ * heap of the page and pages that can not be skipped evaluate the predicates on the prefix and the heap data.
+ */
+struct VariableZoneMap {
+    /// Maximum number of distinct values recorded per column
+    static constexpr uint32_t MAX_DISTINCT_VALUES = 16u;
+
+    /// Number of NULL values stored in the column
+    uint32_t nullCount;
+
+    /// Whether all distinct values of the column are recorded
+    bool hasDistinctValues;
+
+    /// Sorted distinct non-NULL values stored in the column
+    std::vector<crossbow::string> distinctValues;
+};
+
+/**
+ * @brief Zone maps of all columns of a column map page
+ *
+ * Covers every element stored in the page (i.e. all versions of all keys).
+ */
+class ColumnMapZoneMap {
+public:
+    ColumnMapZoneMap()
+            : mCount(0u) {
+    }
+
+    /**
+     * @brief Computes the zone maps from the columns of the page
+     */
+    ColumnMapZoneMap(const ColumnMapContext& context, const ColumnMapMainPage* page);
+
+    /**
+     * @brief Number of elements stored in the page
+     */
+    uint32_t count() const {
+        return mCount;
+    }
+
+    /**
+     * @brief Zone maps of the fixed size columns (indexed by the field ID)
+     */
+    const std::vector<ColumnZoneMap>& columns() const {
+        return mColumns;
+    }
+
+    /**
+     * @brief Zone maps of the variable size columns (indexed by the field ID minus the number of fixed size fields)
+     */
+    const std::vector<VariableZoneMap>& variableColumns() const {
+        return mVariableColumns;
+    }
+
+private:
+    uint32_t mCount;
+
+    std::vector<ColumnZoneMap> mColumns;
+
+    std::vector<VariableZoneMap> mVariableColumns;
+};
+
+/**
+ * @brief Checks the selections of the queries of a scan against the zone maps of a page
+ *
+ * A query can not match any element of a page if one of its conjuncts consists only of predicates that no value in the
+ * page satisfies according to the zone maps.
+ */
+class ZoneMapFilter {
+public:
+    ZoneMapFilter(const Record& record, const std::vector<ScanQuery*>& queries);
+
+    /**
+     * @brief Whether no query can match any element of the page described by the zone map
+     */
+    bool canSkip(const ColumnMapZoneMap& zoneMap) const;
+
+private:
+    /**
+     * @brief A single predicate of a conjunct
+     */
+    struct Predicate {
+        /// Type of the predicate
+        PredicateType type;
+
+        /// Whether the predicate can be checked against the zone maps
+        bool checkable;
+
+        /// Whether the column stores floating point values
+        bool isFloat;
+
+        /// Whether the column is a variable size column
+        bool isVariable;
+
+        /// Index of the column in the fixed size or variable size zone maps
+        uint16_t column;
+
+        /// Value the predicate compares against (fixed size columns)
+        ZoneMapValue value;
+
+        /// Inclusive upper bound of a BETWEEN predicate (value holds the inclusive lower bound)
+        ZoneMapValue upper;
+
+        /// Value the predicate compares against (variable size columns)
+        crossbow::string text;
+    };
+
+    using Conjunct = std::vector<Predicate>;
+
+    /**
+     * @brief Whether any value in the column might satisfy the predicate
+     */
+    static bool mightMatch(const Predicate& predicate, const ColumnZoneMap& zoneMap, uint32_t count);
+
+    /**
+     * @brief Whether any value in the variable size column might satisfy the predicate
+     */
+    static bool mightMatch(const Predicate& predicate, const VariableZoneMap& zoneMap, uint32_t count);
+
+    /// The conjuncts of every query in the scan
+    std::vector<std::vector<Conjunct>> mQueries;
+};
+
+} // namespace deltamain
+} // namespace store
+} // namespace tell
@@ -24,6 +24,7 @@
 #include "LLVMColumnMapAggregation.hpp"
 
 #include "ColumnMapContext.hpp"
+#include "ColumnMapPage.hpp"
 #include "LLVMColumnMapUtils.hpp"
 
 #include <util/ScanQuery.hpp>
@@ -48,7 +49,7 @@ LLVMColumnMapAggregationBuilder::LLVMColumnMapAggregationBuilder(const ColumnMap
 
 void LLVMColumnMapAggregationBuilder::build(ScanQuery* query) {
     auto& srcRecord = mContext.record();
-    auto& destRecord = query->record();
+    auto& destRecord = query->aggregationRecord();
 
     // -> auto mainPage = reinterpret_cast<const ColumnMapMainPage*>(page);
     auto mainPage = CreateBitCast(getParam(page), mMainPageStructTy->getPointerTo());
@@ -200,6 +201,70 @@ void LLVMColumnMapAggregationBuilder::build(ScanQuery* query) {
             destNullValue = CreateAlignedLoad(destNullData, 1u);
         }
 
+        // Aggregate encoded columns element by element from the decoded values
+        llvm::BasicBlock* encodedEndBlock = nullptr;
+        llvm::Value* encodedNullAgg = nullptr;
+        llvm::Value* encodedAgg = nullptr;
+        if (aggregationType != AggregationType::CNT && srcFieldIdx < ColumnMapMainPage::MAX_ENCODED_COLUMNS) {
+            auto rawBlock = createBasicBlock("agg.raw." + llvm::Twine(destFieldIdx));
+            auto encodedBodyBlock = createBasicBlock("agg.encodedbody." + llvm::Twine(destFieldIdx));
+            encodedEndBlock = createBasicBlock("agg.encodedend." + llvm::Twine(destFieldIdx));
+
+            // -> if ((mainPage->encodedColumns & (1 << srcFieldIdx)) != 0 && startIdx != endIdx)
+            auto encodedColumns = CreateInBoundsGEP(mainPage, { getInt64(0), getInt32(4) });
+            encodedColumns = CreateAlignedLoad(encodedColumns, 8u);
+            auto isEncoded = CreateAnd(encodedColumns, getInt64(0x1ull << srcFieldIdx));
+            isEncoded = CreateICmp(llvm::CmpInst::ICMP_NE, isEncoded, getInt64(0));
+            isEncoded = CreateAnd(isEncoded, CreateICmp(llvm::CmpInst::ICMP_NE, getParam(startIdx), getParam(endIdx)));
+            CreateCondBr(isEncoded, encodedBodyBlock, rawBlock);
+
+            // Encoded body
+            SetInsertPoint(encodedBodyBlock);
+
+            // -> auto idx = startIdx;
+            auto encodedIdx = CreatePHI(getInt64Ty(), 2);
+            encodedIdx->addIncoming(getParam(startIdx), previousBlock);
+
+            llvm::PHINode* encodedNull = nullptr;
+            if (!destField.isNotNull()) {
+                encodedNull = CreatePHI(getInt8Ty(), 2);
+                encodedNull->addIncoming(destNullValue, previousBlock);
+            }
+
+            auto encodedDest = CreatePHI(destFieldType, 2);
+            encodedDest->addIncoming(destValue, previousBlock);
+
+            // -> auto result = resultData[idx] & ~srcNullData[idx];
+            llvm::Value* encodedResult = CreateAlignedLoad(CreateInBoundsGEP(getParam(result), encodedIdx), 1u);
+            if (!srcField.isNotNull()) {
+                auto srcNullValue = CreateInBoundsGEP(srcNullData, CreateSub(encodedIdx, getParam(startIdx)));
+                srcNullValue = CreateAlignedLoad(srcNullValue, 1u);
+                encodedResult = CreateAnd(encodedResult, CreateXor(srcNullValue, getInt8(1)));
+            }
+
+            if (!destField.isNotNull()) {
+                encodedNullAgg = CreateAnd(encodedNull, CreateXor(encodedResult, getInt8(1)));
+            }
+
+            auto encodedSrc = createFixedColumnLoad(*this, mContext, mainPage, count, fixedData, srcFieldIdx,
+                    encodedIdx);
+            encodedAgg = buildAggregation(encodedSrc, encodedDest, CreateTruncOrBitCast(encodedResult, getInt1Ty()));
+
+            // -> ++idx;
+            auto encodedIdxNext = CreateAdd(encodedIdx, getInt64(1));
+            encodedIdx->addIncoming(encodedIdxNext, GetInsertBlock());
+            if (encodedNull) {
+                encodedNull->addIncoming(encodedNullAgg, GetInsertBlock());
+            }
+            encodedDest->addIncoming(encodedAgg, GetInsertBlock());
+            CreateCondBr(CreateICmp(llvm::CmpInst::ICMP_NE, encodedIdxNext, getParam(endIdx)), encodedBodyBlock,
+                    encodedEndBlock);
+
+            // Raw columns are aggregated by the vector and scalar code paths
+            SetInsertPoint(rawBlock);
+            previousBlock = rawBlock;
+        }
+
         // Check how many vector iterations can be executed
         // Skip to the vector end if no vectorized iterations can be executed
         auto vectorCount = CreateSub(getParam(endIdx), getParam(startIdx));
@@ -524,6 +589,21 @@ void LLVMColumnMapAggregationBuilder::build(ScanQuery* query) {
         }
 
         CreateAlignedStore(aggResult, destData, destFieldAlignment);
+
+        // Store the result of the encoded code path and continue with the next aggregation
+        if (encodedEndBlock) {
+            auto nextBlock = createBasicBlock("agg.next." + llvm::Twine(destFieldIdx));
+            CreateBr(nextBlock);
+
+            SetInsertPoint(encodedEndBlock);
+            if (!destField.isNotNull()) {
+                CreateAlignedStore(encodedNullAgg, destNullData, 1u);
+            }
+            CreateAlignedStore(encodedAgg, destData, destFieldAlignment);
+            CreateBr(nextBlock);
+
+            SetInsertPoint(nextBlock);
+        }
     }
 
     // -> return destRecord.staticSize();
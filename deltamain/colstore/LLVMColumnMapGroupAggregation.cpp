@@ -0,0 +1,242 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include "LLVMColumnMapGroupAggregation.hpp"
+
+#include "ColumnMapContext.hpp"
+#include "LLVMColumnMapUtils.hpp"
+
+#include <util/ScanQuery.hpp>
+
+#include <tuple>
+#include <vector>
+
+namespace tell {
+namespace store {
+namespace deltamain {
+
+LLVMColumnMapGroupAggregationBuilder::LLVMColumnMapGroupAggregationBuilder(const ColumnMapContext& context,
+        llvm::Module& module, llvm::TargetMachine* target, const std::string& name)
+        : FunctionBuilder(module, target, buildReturnTy(module.getContext()), buildParamTy(module.getContext()), name),
+          mContext(context),
+          mMainPageStructTy(getColumnMapMainPageTy(module.getContext())) {
+    // Set noalias hints (data pointers are not allowed to overlap)
+    mFunction->setDoesNotAlias(1);
+    mFunction->setOnlyReadsMemory(1);
+    mFunction->setDoesNotAlias(4);
+    mFunction->setOnlyReadsMemory(4);
+    mFunction->setDoesNotAlias(5);
+}
+
+void LLVMColumnMapGroupAggregationBuilder::build(ScanQuery* query) {
+    auto& srcRecord = mContext.record();
+    auto& destRecord = query->aggregationRecord();
+
+    // -> auto mainPage = reinterpret_cast<const ColumnMapMainPage*>(page);
+    auto mainPage = CreateBitCast(getParam(page), mMainPageStructTy->getPointerTo());
+
+    // -> auto count = static_cast<uint64_t>(mainPage->count);
+    auto count = CreateInBoundsGEP(mainPage, { getInt64(0), getInt32(0) });
+    count = CreateZExt(CreateAlignedLoad(count, 4u), getInt64Ty());
+
+    // -> auto headerOffset = static_cast<uint64_t>(mainPage->headerOffset);
+    auto headerOffset = CreateInBoundsGEP(mainPage, { getInt64(0), getInt32(1) });
+    headerOffset = CreateZExt(CreateAlignedLoad(headerOffset, 4u), getInt64Ty());
+
+    // -> auto headerData = page + headerOffset;
+    auto headerData = CreateInBoundsGEP(getParam(page), headerOffset);
+
+    // -> auto fixedOffset = static_cast<uint64_t>(mainPage->fixedOffset);
+    auto fixedOffset = CreateInBoundsGEP(mainPage, { getInt64(0), getInt32(2) });
+    fixedOffset = CreateZExt(CreateAlignedLoad(fixedOffset, 4u), getInt64Ty());
+
+    // -> auto fixedData = page + fixedOffset;
+    auto fixedData = CreateInBoundsGEP(getParam(page), fixedOffset);
+
+    // Compute the start of the null bytevector of every aggregation outside of the loop
+    std::vector<llvm::Value*> srcNullColumns;
+    srcNullColumns.reserve(destRecord.fieldCount());
+    auto i = query->aggregationBegin();
+    for (decltype(destRecord.fieldCount()) j = 0u; j < destRecord.fieldCount(); ++i, ++j) {
+        auto& srcMeta = srcRecord.getFieldMeta(std::get<0>(*i));
+
+        // -> auto srcNullData = headerData + count * srcNullIdx;
+        llvm::Value* srcNullData = nullptr;
+        if (!srcMeta.field.isNotNull()) {
+            srcNullData = headerData;
+            if (srcMeta.nullIdx != 0) {
+                srcNullData = CreateInBoundsGEP(srcNullData, createConstMul(count, srcMeta.nullIdx));
+            }
+        }
+        srcNullColumns.emplace_back(srcNullData);
+    }
+
+    // Create code blocks
+    auto previousBlock = GetInsertBlock();
+    auto bodyBlock = createBasicBlock("group.body");
+    auto aggregateBlock = createBasicBlock("group.aggregate");
+    auto nextBlock = createBasicBlock("group.next");
+    auto endBlock = createBasicBlock("group.end");
+    CreateCondBr(CreateICmp(llvm::CmpInst::ICMP_NE, getParam(startIdx), getParam(endIdx)), bodyBlock, endBlock);
+
+    // Body
+    // Skips elements not matching the query
+    SetInsertPoint(bodyBlock);
+
+    // -> auto idx = startIdx;
+    auto idx = CreatePHI(getInt64Ty(), 2);
+    idx->addIncoming(getParam(startIdx), previousBlock);
+
+    // -> if (result[idx] != 0)
+    auto resultValue = CreateAlignedLoad(CreateInBoundsGEP(getParam(result), idx), 1u);
+    CreateCondBr(CreateICmp(llvm::CmpInst::ICMP_NE, resultValue, getInt8(0)), aggregateBlock, nextBlock);
+
+    // Aggregate
+    // Aggregates the element into the aggregation state of its group
+    SetInsertPoint(aggregateBlock);
+
+    // -> auto state = dest[idx];
+    llvm::Value* state = CreateAlignedLoad(CreateInBoundsGEP(getParam(dest), idx), 8u);
+
+    i = query->aggregationBegin();
+    for (decltype(destRecord.fieldCount()) j = 0u; j < destRecord.fieldCount(); ++i, ++j) {
+        uint16_t srcFieldIdx;
+        AggregationType aggregationType;
+        std::tie(srcFieldIdx, aggregationType) = *i;
+
+        uint16_t destFieldIdx;
+        destRecord.idOf(crossbow::to_string(j), destFieldIdx);
+
+        auto& srcField = srcRecord.getFieldMeta(srcFieldIdx).field;
+        auto& destMeta = destRecord.getFieldMeta(destFieldIdx);
+        auto& destField = destMeta.field;
+        LOG_ASSERT(srcField.isFixedSized() && destField.isFixedSized(), "Only fixed size supported");
+
+        auto srcNullData = srcNullColumns[j];
+
+        // -> auto nullValue = srcNullData[idx];
+        llvm::Value* nullValue = nullptr;
+        if (srcNullData) {
+            nullValue = CreateAlignedLoad(CreateInBoundsGEP(srcNullData, idx), 1u);
+        }
+
+        if (!destField.isNotNull()) {
+            auto destNullData = state;
+            if (destMeta.nullIdx != 0) {
+                destNullData = CreateInBoundsGEP(destNullData, getInt64(destMeta.nullIdx));
+            }
+            llvm::Value* destNullValue;
+            if (nullValue) {
+                destNullValue = CreateAlignedLoad(destNullData, 1u);
+                destNullValue = CreateAnd(destNullValue, nullValue);
+            } else {
+                destNullValue = getInt8(0);
+            }
+            CreateAlignedStore(destNullValue, destNullData, 1u);
+        }
+
+        // -> auto srcValue = reinterpret_cast<const T*>(fixedData + count * srcFieldOffset)[idx];
+        llvm::Value* srcValue = nullptr;
+        if (aggregationType != AggregationType::CNT) {
+            srcValue = createFixedColumnLoad(*this, mContext, mainPage, count, fixedData, srcFieldIdx, idx);
+        }
+
+        auto destData = state;
+        if (destMeta.offset != 0) {
+            destData = CreateInBoundsGEP(destData, getInt64(destMeta.offset));
+        }
+        destData = CreateBitCast(destData, getFieldPtrTy(destField.type()));
+        llvm::Value* destValue = CreateAlignedLoad(destData, destField.alignOf());
+
+        if (nullValue) {
+            nullValue = CreateXor(nullValue, getInt8(1));
+            nullValue = CreateTruncOrBitCast(nullValue, getInt1Ty());
+        }
+
+        auto isFloat = (srcField.type() == FieldType::FLOAT) || (srcField.type() == FieldType::DOUBLE);
+
+        switch (aggregationType) {
+        case AggregationType::MIN: {
+            auto cond = (isFloat
+                    ? CreateFCmp(llvm::CmpInst::FCMP_OLT, srcValue, destValue)
+                    : CreateICmp(llvm::CmpInst::ICMP_SLT, srcValue, destValue));
+            if (nullValue) {
+                cond = CreateAnd(cond, nullValue);
+            }
+            destValue = CreateSelect(cond, srcValue, destValue);
+        } break;
+
+        case AggregationType::MAX: {
+            auto cond = (isFloat
+                    ? CreateFCmp(llvm::CmpInst::FCMP_OGT, srcValue, destValue)
+                    : CreateICmp(llvm::CmpInst::ICMP_SGT, srcValue, destValue));
+            if (nullValue) {
+                cond = CreateAnd(cond, nullValue);
+            }
+            destValue = CreateSelect(cond, srcValue, destValue);
+        } break;
+
+        case AggregationType::SUM: {
+            if (srcField.type() == FieldType::SMALLINT || srcField.type() == FieldType::INT) {
+                srcValue = CreateSExt(srcValue, getInt64Ty());
+            } else if (srcField.type() == FieldType::FLOAT) {
+                srcValue = CreateFPExt(srcValue, getDoubleTy());
+            }
+
+            auto res = (isFloat
+                    ? CreateFAdd(destValue, srcValue)
+                    : CreateAdd(destValue, srcValue));
+            destValue = (nullValue ? CreateSelect(nullValue, res, destValue) : res);
+        } break;
+
+        case AggregationType::CNT: {
+            destValue = CreateAdd(destValue, (nullValue ? CreateZExt(nullValue, getInt64Ty()) : getInt64(1)));
+        } break;
+
+        default: {
+            LOG_ASSERT(false, "Unknown aggregation type");
+            destValue = nullptr;
+        } break;
+        }
+
+        CreateAlignedStore(destValue, destData, destField.alignOf());
+    }
+    CreateBr(nextBlock);
+
+    // Next
+    // Advances the loop
+    SetInsertPoint(nextBlock);
+
+    // -> ++idx;
+    auto idxNext = CreateAdd(idx, getInt64(1));
+    idx->addIncoming(idxNext, nextBlock);
+    CreateCondBr(CreateICmp(llvm::CmpInst::ICMP_NE, idxNext, getParam(endIdx)), bodyBlock, endBlock);
+
+    // End
+    SetInsertPoint(endBlock);
+    CreateRetVoid();
+}
+
+} // namespace deltamain
+} // namespace store
+} // namespace tell
@@ -0,0 +1,97 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#pragma once
+
+#include <util/LLVMBuilder.hpp>
+
+#include <crossbow/string.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace tell {
+namespace store {
+
+class ScanQuery;
+
+namespace deltamain {
+
+class ColumnMapContext;
+
+/**
+ * @brief Helper class creating the column map group aggregation function
+ *
+ * In contrast to the aggregation function every element is aggregated into its own destination: The function aggregates
+ * every element in the range whose result byte is set into the aggregation state referenced by its dest entry (both
+ * indexed by the position of the element in the page) in a single pass over the page.
+ */
+class LLVMColumnMapGroupAggregationBuilder : private FunctionBuilder {
+public:
+    using Signature = void (*) (
+            const char* /* page */,
+            uint64_t /* startIdx */,
+            uint64_t /* endIdx */,
+            const char* /* result */,
+            char* const* /* dest */);
+
+    static void createFunction(const ColumnMapContext& context, llvm::Module& module, llvm::TargetMachine* target,
+            const std::string& name, ScanQuery* query) {
+        LLVMColumnMapGroupAggregationBuilder builder(context, module, target, name);
+        builder.build(query);
+    }
+
+private:
+    static constexpr size_t page = 0;
+    static constexpr size_t startIdx = 1;
+    static constexpr size_t endIdx = 2;
+    static constexpr size_t result = 3;
+    static constexpr size_t dest = 4;
+
+    static llvm::Type* buildReturnTy(llvm::LLVMContext& context) {
+        return llvm::Type::getVoidTy(context);
+    }
+
+    static std::vector<std::pair<llvm::Type*, crossbow::string>> buildParamTy(llvm::LLVMContext& context) {
+        return {
+            { llvm::Type::getInt8Ty(context)->getPointerTo(), "page" },
+            { llvm::Type::getInt64Ty(context), "startIdx" },
+            { llvm::Type::getInt64Ty(context), "endIdx" },
+            { llvm::Type::getInt8Ty(context)->getPointerTo(), "result" },
+            { llvm::Type::getInt8Ty(context)->getPointerTo()->getPointerTo(), "dest" }
+        };
+    }
+
+    LLVMColumnMapGroupAggregationBuilder(const ColumnMapContext& context, llvm::Module& module,
+            llvm::TargetMachine* target, const std::string& name);
+
+    void build(ScanQuery* query);
+
+    const ColumnMapContext& mContext;
+
+    llvm::StructType* mMainPageStructTy;
+};
+
+} // namespace deltamain
+} // namespace store
+} // namespace tell
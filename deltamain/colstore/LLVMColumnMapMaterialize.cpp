@@ -102,22 +102,13 @@ void LLVMColumnMapMaterializeBuilder::build() {
         auto fixedData = CreateInBoundsGEP(getParam(page), fixedOffset);
 
         for (decltype(record.fixedSizeFieldCount()) i = 0; i < record.fixedSizeFieldCount(); ++i) {
-            auto& colMeta = mContext.fixedMetaData()[i];
             auto& rowMeta = record.getFieldMeta(i);
             auto& field = rowMeta.field;
             auto fieldAlignment = field.alignOf();
             auto fieldPtrTy = getFieldPtrTy(field.type());
 
-            // -> auto src = reinterpret_cast<const T*>(fixedData + page->count * fieldOffset) + idx;
-            auto src = fixedData;
-            if (colMeta.offset != 0) {
-                src = CreateInBoundsGEP(src, createConstMul(count, colMeta.offset));
-            }
-            src = CreateBitCast(src, fieldPtrTy);
-            src = CreateInBoundsGEP(src, index);
-
-            // -> auto value = *src;
-            auto value = CreateAlignedLoad(src, fieldAlignment);
+            // -> auto value = reinterpret_cast<const T*>(fixedData + page->count * fieldOffset)[idx];
+            auto value = createFixedColumnLoad(*this, mContext, mainPage, count, fixedData, i, index);
 
             // -> auto dest = reinterpret_cast<const T*>(data + fieldOffset);
             auto destData = getParam(dest);
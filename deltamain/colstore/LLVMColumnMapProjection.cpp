@@ -110,7 +110,6 @@ void LLVMColumnMapProjectionBuilder::build(ScanQuery* query) {
         for (decltype(destRecord.fixedSizeFieldCount()) destFieldIdx = 0u;
                 destFieldIdx < destRecord.fixedSizeFieldCount(); ++i, ++destFieldIdx) {
             auto srcFieldIdx = *i;
-            auto& srcMeta = mContext.fixedMetaData()[srcFieldIdx];
             auto& destMeta = destRecord.getFieldMeta(destFieldIdx);
             auto& field = destMeta.field;
             LOG_ASSERT(field.isFixedSized(), "Field must be fixed size");
@@ -118,16 +117,8 @@ void LLVMColumnMapProjectionBuilder::build(ScanQuery* query) {
             auto fieldAlignment = field.alignOf();
             auto fieldPtrType = getFieldPtrTy(field.type());
 
-            // -> auto srcData = reinterpret_cast<const T*>(fixedData + srcMeta.offset) + index;
-            auto srcData = fixedData;
-            if (srcMeta.offset != 0) {
-                srcData = CreateInBoundsGEP(srcData, createConstMul(count, srcMeta.offset));
-            }
-            srcData = CreateBitCast(srcData, fieldPtrType);
-            srcData = CreateInBoundsGEP(srcData, index);
-
-            // -> auto value = *srcData;
-            auto value = CreateAlignedLoad(srcData, fieldAlignment);
+            // -> auto value = reinterpret_cast<const T*>(fixedData + page->count * srcFieldOffset)[index];
+            auto value = createFixedColumnLoad(*this, mContext, mainPage, count, fixedData, srcFieldIdx, index);
 
             // -> auto destData = reinterpret_cast<const T*>(dest + destMeta.offset);
             auto destData = getParam(dest);
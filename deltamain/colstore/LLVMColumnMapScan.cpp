@@ -24,11 +24,28 @@
 #include "LLVMColumnMapScan.hpp"
 
 #include "ColumnMapContext.hpp"
+#include "ColumnMapEncoding.hpp"
+#include "ColumnMapPage.hpp"
 #include "LLVMColumnMapUtils.hpp"
 
 namespace tell {
 namespace store {
 namespace deltamain {
+namespace {
+
+/**
+ * @brief The conjuncts all predicates on the field are attached to
+ */
+std::vector<uint32_t> fieldConjuncts(const FieldAST& fieldAst) {
+    std::vector<uint32_t> conjuncts;
+    conjuncts.reserve(fieldAst.predicates.size());
+    for (auto& predicateAst : fieldAst.predicates) {
+        conjuncts.emplace_back(predicateAst.conjunct);
+    }
+    return conjuncts;
+}
+
+} // anonymous namespace
 
 const std::string LLVMColumnMapScanBuilder::FUNCTION_NAME = "columnScan";
 
@@ -39,6 +56,7 @@ LLVMColumnMapScanBuilder::LLVMColumnMapScanBuilder(const ColumnMapContext& conte
           mContext(context),
           mMainPageStructTy(getColumnMapMainPageTy(module.getContext())),
           mHeapEntryStructTy(getColumnMapHeapEntriesTy(module.getContext())),
+          mEncodedColumnStructTy(getColumnMapEncodedColumnTy(module.getContext())),
           mCount(nullptr),
           mFixedData(nullptr),
           mVariableData(nullptr),
@@ -53,6 +71,10 @@ LLVMColumnMapScanBuilder::LLVMColumnMapScanBuilder(const ColumnMapContext& conte
     mFunction->setDoesNotAlias(4);
     mFunction->setOnlyReadsMemory(4);
     mFunction->setDoesNotAlias(7);
+    mFunction->setDoesNotAlias(8);
+    mFunction->setOnlyReadsMemory(8);
+    mFunction->setDoesNotAlias(9);
+    mFunction->setOnlyReadsMemory(9);
 }
 
 void LLVMColumnMapScanBuilder::buildScan(const ScanAST& scanAst) {
@@ -69,6 +91,8 @@ void LLVMColumnMapScanBuilder::buildScan(const ScanAST& scanAst) {
     mScalarConjunctsGenerated.resize(scanAst.numConjunct, false);
     mVectorConjunctsGenerated.resize(scanAst.numConjunct, false);
 
+    buildConjunctActive(scanAst);
+
     // Field evaluation
     if (!scanAst.fields.empty()) {
         if (scanAst.needsNull) {
@@ -91,7 +115,11 @@ void LLVMColumnMapScanBuilder::buildScan(const ScanAST& scanAst) {
             mFixedData = CreateInBoundsGEP(getParam(page), fixedOffset);
 
             for (; i != scanAst.fields.end() && i->second.isFixedSize; ++i) {
-                buildFixedField(scanAst, i->second);
+                auto& fieldAst = i->second;
+                buildIfActive(fieldConjuncts(fieldAst), "col." + llvm::Twine(fieldAst.id) + ".guard",
+                        [this, &scanAst, &fieldAst] () {
+                    buildFixedField(scanAst, fieldAst);
+                });
             }
         }
 
@@ -105,7 +133,11 @@ void LLVMColumnMapScanBuilder::buildScan(const ScanAST& scanAst) {
             mVariableData = CreateBitCast(mVariableData, mHeapEntryStructTy->getPointerTo());
 
             for (; i != scanAst.fields.end(); ++i) {
-                buildVariableField(scanAst, i->second);
+                auto& fieldAst = i->second;
+                buildIfActive(fieldConjuncts(fieldAst), "col." + llvm::Twine(fieldAst.id) + ".guard",
+                        [this, &scanAst, &fieldAst] () {
+                    buildVariableField(scanAst, fieldAst);
+                });
             }
         }
     }
@@ -119,210 +151,549 @@ void LLVMColumnMapScanBuilder::buildScan(const ScanAST& scanAst) {
     CreateRetVoid();
 }
 
+void LLVMColumnMapScanBuilder::buildConjunctActive(const ScanAST& scanAst) {
+    mConjunctActive.resize(scanAst.numConjunct, nullptr);
+    for (decltype(scanAst.queries.size()) i = 0; i < scanAst.queries.size(); ++i) {
+        auto& query = scanAst.queries[i];
+
+        // -> auto active = (activeData[i] != 0);
+        llvm::Value* active = CreateAlignedLoad(CreateInBoundsGEP(getParam(activeData), getInt64(i)), 1u);
+        active = CreateICmp(llvm::CmpInst::ICMP_NE, active, getInt8(0));
+
+        // Queries with the same selection share their conjuncts
+        for (decltype(query.numConjunct) j = 0; j < query.numConjunct; ++j) {
+            auto& conjunctActive = mConjunctActive[query.conjunctOffset + j];
+            conjunctActive = (conjunctActive ? CreateOr(conjunctActive, active) : active);
+        }
+    }
+}
+
+template <typename Fun>
+void LLVMColumnMapScanBuilder::buildIfActive(const std::vector<uint32_t>& conjuncts, const llvm::Twine& name,
+        Fun fun) {
+    llvm::Value* active = nullptr;
+    for (auto conjunct : conjuncts) {
+        if (auto conjunctActive = mConjunctActive[conjunct]) {
+            active = (active ? CreateOr(active, conjunctActive) : conjunctActive);
+        }
+    }
+    if (!active) {
+        fun();
+        return;
+    }
+
+    // Conjuncts of inactive queries are left unevaluated, their results are never read
+    auto activeBlock = createBasicBlock(name + ".active");
+    auto endBlock = createBasicBlock(name + ".skip");
+    CreateCondBr(active, activeBlock, endBlock);
+
+    SetInsertPoint(activeBlock);
+    fun();
+    CreateBr(endBlock);
+
+    SetInsertPoint(endBlock);
+}
+
+template <typename Load, typename Evaluate>
+void LLVMColumnMapScanBuilder::buildFixedFieldEvaluation(llvm::Value* nullData, llvm::Value* vectorEnd,
+        uint64_t vectorSize, const ScanAST& scanAst, const FieldAST& fieldAst, const llvm::Twine& name, Load load,
+        Evaluate evaluate) {
+    if (vectorSize != 1) {
+        // Vectorized field evaluation
+        buildFixedFieldLoop(nullData, getParam(startIdx), vectorEnd, vectorSize, mVectorConjunctsGenerated, scanAst,
+                fieldAst, name + ".vector", load, evaluate);
+    }
+
+    // Scalar field evaluation
+    buildFixedFieldLoop(nullData, vectorEnd, getParam(endIdx), 1, mScalarConjunctsGenerated, scanAst, fieldAst,
+            name + ".scalar", load, evaluate);
+}
+
+template <typename Load, typename Evaluate>
+void LLVMColumnMapScanBuilder::buildFixedFieldLoop(llvm::Value* nullData, llvm::Value* start, llvm::Value* end,
+        uint64_t vectorSize, std::vector<uint8_t>& conjunctsGenerated, const ScanAST& scanAst,
+        const FieldAST& fieldAst, const llvm::Twine& name, Load load, Evaluate evaluate) {
+    auto nullTy = getInt8VectorTy(vectorSize);
+    auto conjunctTy = getInt8VectorTy(vectorSize);
+
+    createLoop(start, end, vectorSize, "col." + llvm::Twine(fieldAst.id) + "." + name, [&] (llvm::Value* idx) {
+        // -> auto lhsValue = load(idx);
+        auto lhsValue = load(idx, vectorSize);
+
+        // -> auto nullValue = nullData[idx];
+        llvm::Value* nullValue = nullptr;
+        if (nullData) {
+            nullValue = CreateInBoundsGEP(nullData, idx);
+            nullValue = CreateBitCast(nullValue, nullTy->getPointerTo());
+            nullValue = CreateAlignedLoad(nullValue, 1u);
+        }
+
+        // Evaluate all predicates attached to this field
+        for (decltype(fieldAst.predicates.size()) i = 0; i < fieldAst.predicates.size(); ++i) {
+            auto& predicateAst = fieldAst.predicates[i];
+
+            llvm::Value* res;
+            if (predicateAst.type == PredicateType::IS_NULL) {
+                // Check if the field is null
+                res = nullValue;
+            } else if (predicateAst.type == PredicateType::IS_NOT_NULL) {
+                res = CreateXor(nullValue, getInt8Vector(vectorSize, 1));
+            } else {
+                // Execute the comparison
+                res = CreateZExtOrBitCast(evaluate(predicateAst, i, lhsValue, vectorSize), conjunctTy);
+
+                // The predicate evaluates to false if the value is null
+                if (nullData) {
+                    res = CreateAnd(res, CreateXor(nullValue, getInt8Vector(vectorSize, 1)));
+                }
+            }
+
+            // Store resulting conjunct value
+            auto& conjunctProperties = scanAst.conjunctProperties[predicateAst.conjunct];
+            LOG_ASSERT(conjunctProperties.predicateCount > 0, "Conjunct must have predicates");
+
+            llvm::Value* conjunctPtr;
+            if (conjunctProperties.predicateCount == 1) {
+                auto queryIndex = conjunctProperties.queryIndex;
+                auto& query = scanAst.queries[queryIndex];
+                decltype(predicateAst.conjunct) conjunctIdx;
+                if (!query.shared) {
+                    conjunctIdx = queryIndex;
+                } else {
+                    for (conjunctIdx = query.conjunctOffset; conjunctIdx < predicateAst.conjunct; ++conjunctIdx) {
+                        if (scanAst.conjunctProperties[conjunctIdx].predicateCount < 2) {
+                            break;
+                        }
+                    }
+                }
+
+                conjunctPtr = idx;
+                if (conjunctIdx > 0) {
+                    conjunctPtr = CreateAdd(createConstMul(mCount, conjunctIdx), conjunctPtr);
+                }
+                conjunctPtr = CreateInBoundsGEP(getParam(resultData), conjunctPtr);
+                conjunctPtr = CreateBitCast(conjunctPtr, conjunctTy->getPointerTo());
+                if (conjunctsGenerated[conjunctIdx]) {
+                    res = CreateAnd(CreateAlignedLoad(conjunctPtr, 1u), res);
+                } else {
+                    conjunctsGenerated[conjunctIdx] = true;
+                }
+            } else {
+                conjunctPtr = CreateAdd(createConstMul(mCount, predicateAst.conjunct), idx);
+                conjunctPtr = CreateInBoundsGEP(getParam(resultData), conjunctPtr);
+                conjunctPtr = CreateBitCast(conjunctPtr, conjunctTy->getPointerTo());
+                if (conjunctsGenerated[predicateAst.conjunct]) {
+                    res = CreateOr(CreateAlignedLoad(conjunctPtr, 1u), res);
+                } else {
+                    conjunctsGenerated[predicateAst.conjunct] = true;
+                }
+            }
+            CreateAlignedStore(res, conjunctPtr, 1u);
+        }
+    });
+}
+
 void LLVMColumnMapScanBuilder::buildFixedField(const ScanAST& scanAst, const FieldAST& fieldAst) {
     auto start = getParam(startIdx);
     auto vectorSize = mRegisterWidth / (fieldAst.size * 8);
 
+    // Compute the end of the range processed by the vectorized field evaluation
+    auto vectorEnd = start;
+    if (vectorSize != 1) {
+        auto count = CreateSub(getParam(endIdx), start);
+        count = CreateAnd(count, getInt64(-vectorSize));
+        vectorEnd = CreateAdd(start, count);
+    }
+
     // Load the start pointer of the column
-    llvm::Value* srcData = nullptr;
+    llvm::Value* columnData = nullptr;
     if (fieldAst.needsValue) {
         auto& fixedMetaData = mContext.fixedMetaData();
         auto offset = fixedMetaData[fieldAst.id].offset;
 
-        srcData = mFixedData;
+        columnData = mFixedData;
         if (offset != 0) {
-            srcData = CreateInBoundsGEP(srcData, createConstMul(mCount, offset));
+            columnData = CreateInBoundsGEP(columnData, createConstMul(mCount, offset));
         }
-        srcData = CreateBitCast(srcData, getFieldPtrTy(fieldAst.type));
-        srcData = CreateInBoundsGEP(srcData, start);
     }
 
     // Load the start pointer to the null bytevector
     llvm::Value* nullData = nullptr;
     if (!fieldAst.isNotNull) {
-        auto startOffset = start;
+        nullData = mHeaderData;
         if (fieldAst.nullIdx != 0) {
-            startOffset = CreateAdd(startOffset, createConstMul(mCount, fieldAst.nullIdx));
+            nullData = CreateInBoundsGEP(nullData, createConstMul(mCount, fieldAst.nullIdx));
         }
-        nullData = CreateInBoundsGEP(mHeaderData, startOffset);
     }
 
-    if (vectorSize != 1) {
-        // Vectorized field evaluation
-        std::tie(start, srcData, nullData) = buildFixedFieldEvaluation(srcData, nullData, start, vectorSize,
-                mVectorConjunctsGenerated, scanAst, fieldAst, llvm::Twine("vector"));
+    // The values are never read when only checking the null status
+    if (!columnData || fieldAst.id >= ColumnMapMainPage::MAX_ENCODED_COLUMNS) {
+        buildRawFixedField(scanAst, fieldAst, columnData, nullData, vectorEnd, vectorSize);
+        return;
     }
 
-    // Scalar field evaluation
-    buildFixedFieldEvaluation(srcData, nullData, start, 1, mScalarConjunctsGenerated, scanAst, fieldAst,
-            llvm::Twine("scalar"));
-}
-
-std::tuple<llvm::Value*, llvm::Value*, llvm::Value*> LLVMColumnMapScanBuilder::buildFixedFieldEvaluation(
-        llvm::Value* srcData, llvm::Value* nullData, llvm::Value* start, uint64_t vectorSize,
-        std::vector<uint8_t>& conjunctsGenerated, const ScanAST& scanAst, const FieldAST& fieldAst,
-        const llvm::Twine& name) {
-    auto end = getParam(endIdx);
-    if (vectorSize != 1) {
-        auto count = CreateSub(end, start);
-        count = CreateAnd(count, getInt64(-vectorSize));
-        end = CreateAdd(start, count);
+    auto rawBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".raw");
+    auto encodedBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".encoded");
+    auto forBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".for");
+    auto dictBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".dict");
+    auto rleBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".rle");
+    auto endBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".end");
+
+    // -> if (mainPage->encodedColumns & (1 << id))
+    auto encodedColumns = CreateInBoundsGEP(mMainPage, { getInt64(0), getInt32(4) });
+    encodedColumns = CreateAlignedLoad(encodedColumns, 8u);
+    auto isEncoded = CreateAnd(encodedColumns, getInt64(0x1ull << fieldAst.id));
+    CreateCondBr(CreateICmp(llvm::CmpInst::ICMP_NE, isEncoded, getInt64(0)), encodedBlock, rawBlock);
+
+    // Every code path writes the same conjuncts: Each one has to start with the conjuncts generated before this field
+    auto vectorConjunctsGenerated = mVectorConjunctsGenerated;
+    auto scalarConjunctsGenerated = mScalarConjunctsGenerated;
+    auto resetConjunctsGenerated = [this, &vectorConjunctsGenerated, &scalarConjunctsGenerated] () {
+        mVectorConjunctsGenerated = vectorConjunctsGenerated;
+        mScalarConjunctsGenerated = scalarConjunctsGenerated;
+    };
+
+    // Raw
+    SetInsertPoint(rawBlock);
+    buildRawFixedField(scanAst, fieldAst, columnData, nullData, vectorEnd, vectorSize);
+    CreateBr(endBlock);
+
+    // Encoded
+    // -> auto header = ColumnMapEncodedColumn::fromColumn(columnData);
+    SetInsertPoint(encodedBlock);
+    auto headerData = createPointerAlign(columnData, alignof(ColumnMapEncodedColumn));
+    auto header = CreateBitCast(headerData, mEncodedColumnStructTy->getPointerTo());
+
+    // -> auto encodedData = header->data();
+    auto encodedData = CreateInBoundsGEP(headerData, getInt64(sizeof(ColumnMapEncodedColumn)));
+
+    // -> switch (header->encoding)
+    auto encoding = CreateInBoundsGEP(header, { getInt64(0), getInt32(0) });
+    encoding = CreateAlignedLoad(encoding, 8u);
+    auto encodingSwitch = CreateSwitch(encoding, rleBlock, 2);
+    encodingSwitch->addCase(getInt8(static_cast<uint8_t>(ColumnEncoding::FRAME_OF_REFERENCE)), forBlock);
+    encodingSwitch->addCase(getInt8(static_cast<uint8_t>(ColumnEncoding::DICTIONARY)), dictBlock);
+
+    // Frame of reference (only integer columns)
+    SetInsertPoint(forBlock);
+    if (fieldAst.type == FieldType::SMALLINT || fieldAst.type == FieldType::INT || fieldAst.type == FieldType::BIGINT) {
+        resetConjunctsGenerated();
+        buildFrameOfReferenceFixedField(scanAst, fieldAst, header, encodedData, nullData, vectorEnd, vectorSize);
+        CreateBr(endBlock);
+    } else {
+        CreateUnreachable();
     }
 
-    auto previousBlock = GetInsertBlock();
-    auto bodyBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + "." + name + ".body");
-    auto endBlock = llvm::BasicBlock::Create(Context, "col." + llvm::Twine(fieldAst.id) + "." + name + ".end");
-    CreateCondBr(CreateICmp(llvm::CmpInst::ICMP_NE, start, end), bodyBlock, endBlock);
-    SetInsertPoint(bodyBlock);
+    // Dictionary
+    SetInsertPoint(dictBlock);
+    resetConjunctsGenerated();
+    buildDictionaryFixedField(scanAst, fieldAst, header, encodedData, nullData, vectorEnd, vectorSize);
+    CreateBr(endBlock);
 
-    // -> auto idx = start;
-    auto idx = CreatePHI(getInt64Ty(), 2);
-    idx->addIncoming(start, previousBlock);
+    // Run length
+    SetInsertPoint(rleBlock);
+    resetConjunctsGenerated();
+    buildRunLengthFixedField(scanAst, fieldAst, header, encodedData, nullData, vectorEnd);
+    CreateBr(endBlock);
 
-    // -> auto lhsPhi = srcData;
-    llvm::PHINode* lhsPhi = nullptr;
-    if (srcData) {
-        lhsPhi = CreatePHI(srcData->getType(), 2);
-        lhsPhi->addIncoming(srcData, previousBlock);
-    }
+    SetInsertPoint(endBlock);
+}
 
-    // -> auto nullPhi = nullData;
-    llvm::PHINode* nullPhi = nullptr;
-    if (nullData) {
-        nullPhi = CreatePHI(nullData->getType(), 2);
-        nullPhi->addIncoming(nullData, previousBlock);
+void LLVMColumnMapScanBuilder::buildRawFixedField(const ScanAST& scanAst, const FieldAST& fieldAst,
+        llvm::Value* columnData, llvm::Value* nullData, llvm::Value* vectorEnd, uint64_t vectorSize) {
+    llvm::Value* srcData = nullptr;
+    if (columnData) {
+        srcData = CreateBitCast(columnData, getFieldPtrTy(fieldAst.type));
     }
 
-    auto fieldTy = getFieldVectorTy(fieldAst.type, vectorSize);
-    auto nullTy = getInt8VectorTy(vectorSize);
-    auto conjunctTy = getInt8VectorTy(vectorSize);
+    // -> auto lhsValue = *reinterpret_cast<const T[vectorSize]*>(srcData + idx);
+    auto load = [this, &fieldAst, srcData] (llvm::Value* idx, uint64_t vectorSize) {
+        llvm::Value* lhsValue = nullptr;
+        if (srcData) {
+            lhsValue = CreateInBoundsGEP(srcData, idx);
+            lhsValue = CreateBitCast(lhsValue, getFieldVectorTy(fieldAst.type, vectorSize)->getPointerTo());
+            lhsValue = CreateAlignedLoad(lhsValue, fieldAst.alignment);
+        }
+        return lhsValue;
+    };
 
-    // -> auto lhsValue = *lhsPhi;
-    llvm::Value* lhsValue = nullptr;
-    if (srcData) {
-        lhsValue = CreateBitCast(lhsPhi, fieldTy->getPointerTo());
-        lhsValue = CreateAlignedLoad(lhsValue, fieldAst.alignment);
-    }
+    auto evaluate = [this] (const PredicateAST& predicateAst, size_t /* predicateIdx */, llvm::Value* lhsValue,
+            uint64_t vectorSize) {
+        return buildFixedPredicate(predicateAst, lhsValue, vectorSize);
+    };
 
-    // -> auto nullValue = *nullPhi;
-    llvm::Value* nullValue = nullptr;
-    if (nullData) {
-        nullValue = CreateBitCast(nullPhi, nullTy->getPointerTo());
-        nullValue = CreateAlignedLoad(nullValue, 1u);
+    buildFixedFieldEvaluation(nullData, vectorEnd, vectorSize, scanAst, fieldAst, "raw", load, evaluate);
+}
+
+void LLVMColumnMapScanBuilder::buildFrameOfReferenceFixedField(const ScanAST& scanAst, const FieldAST& fieldAst,
+        llvm::Value* header, llvm::Value* encodedData, llvm::Value* nullData, llvm::Value* vectorEnd,
+        uint64_t vectorSize) {
+    auto fieldTy = getFieldTy(fieldAst.type);
+
+    // -> auto base = static_cast<T>(header->base);
+    auto base = CreateInBoundsGEP(header, { getInt64(0), getInt32(3) });
+    base = CreateTruncOrBitCast(CreateAlignedLoad(base, 8u), fieldTy);
+
+    // -> auto width = header->width;
+    auto width = CreateInBoundsGEP(header, { getInt64(0), getInt32(1) });
+    width = CreateAlignedLoad(width, 1u);
+
+    // Generate a separate evaluation for every packed width smaller than the field
+    auto endBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".for.end");
+    auto defaultBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".for.default");
+    auto widthSwitch = CreateSwitch(width, defaultBlock, 3);
+
+    auto vectorConjunctsGenerated = mVectorConjunctsGenerated;
+    auto scalarConjunctsGenerated = mScalarConjunctsGenerated;
+    for (uint32_t packedWidth = 1u; packedWidth < fieldAst.size; packedWidth *= 2) {
+        auto widthBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".for." + llvm::Twine(packedWidth));
+        widthSwitch->addCase(getInt8(packedWidth), widthBlock);
+        SetInsertPoint(widthBlock);
+
+        mVectorConjunctsGenerated = vectorConjunctsGenerated;
+        mScalarConjunctsGenerated = scalarConjunctsGenerated;
+
+        auto packedTy = getIntNTy(packedWidth * 8);
+        auto packedData = CreateBitCast(encodedData, packedTy->getPointerTo());
+
+        // The predicates are evaluated on the packed values widened to the field and moved by the base
+        // -> auto lhsValue = base + *reinterpret_cast<const P[vectorSize]*>(packedData + idx);
+        auto load = [this, &fieldAst, fieldTy, packedTy, packedData, packedWidth, base] (llvm::Value* idx,
+                uint64_t vectorSize) {
+            auto packedValue = CreateInBoundsGEP(packedData, idx);
+            packedValue = CreateBitCast(packedValue, getVectorTy(packedTy, vectorSize)->getPointerTo());
+            packedValue = CreateAlignedLoad(packedValue, packedWidth);
+
+            auto baseValue = (vectorSize == 1 ? base : CreateVectorSplat(vectorSize, base));
+            return CreateAdd(CreateZExt(packedValue, getFieldVectorTy(fieldAst.type, vectorSize)), baseValue);
+        };
+
+        auto evaluate = [this] (const PredicateAST& predicateAst, size_t /* predicateIdx */, llvm::Value* lhsValue,
+                uint64_t vectorSize) {
+            return buildFixedPredicate(predicateAst, lhsValue, vectorSize);
+        };
+
+        buildFixedFieldEvaluation(nullData, vectorEnd, vectorSize, scanAst, fieldAst, "for", load, evaluate);
+        CreateBr(endBlock);
     }
 
-    // Evaluate all predicates attached to this field
-    for (auto& predicateAst : fieldAst.predicates) {
-        auto& rhsAst = predicateAst.fixed;
+    SetInsertPoint(defaultBlock);
+    CreateUnreachable();
 
-        llvm::Value* res;
-        if (predicateAst.type == PredicateType::IS_NULL) {
-            // Check if the field is null
-            res = nullValue;
-        } else if (predicateAst.type == PredicateType::IS_NOT_NULL) {
-            res = CreateXor(nullValue, getInt8Vector(vectorSize, 1));
-        } else {
-            LOG_ASSERT(lhsValue != nullptr, "lhs must not be null for this kind of comparison");
-            // Execute the comparison
-            auto rhsValue = getVector(vectorSize, rhsAst.value);
-            res = (rhsAst.isFloat
-                ? CreateFCmp(rhsAst.predicate, lhsValue, rhsValue)
-                : CreateICmp(rhsAst.predicate, lhsValue, rhsValue));
-            res = CreateZExtOrBitCast(res, conjunctTy);
+    SetInsertPoint(endBlock);
+}
 
-            // The predicate evaluates to false if the value is null
-            if (nullData) {
-                res = CreateAnd(res, CreateXor(nullValue, getInt8Vector(vectorSize, 1)));
-            }
+void LLVMColumnMapScanBuilder::buildDictionaryFixedField(const ScanAST& scanAst, const FieldAST& fieldAst,
+        llvm::Value* header, llvm::Value* encodedData, llvm::Value* nullData, llvm::Value* vectorEnd,
+        uint64_t vectorSize) {
+    // -> auto dictionarySize = static_cast<uint64_t>(header->valueCount);
+    auto dictionarySize = CreateInBoundsGEP(header, { getInt64(0), getInt32(2) });
+    dictionarySize = CreateZExt(CreateAlignedLoad(dictionarySize, 4u), getInt64Ty());
+
+    // -> auto dictionary = reinterpret_cast<const T*>(encodedData + align(count, 8));
+    auto dictionaryOffset = CreateAnd(CreateAdd(mCount, getInt64(7)), getInt64(-8));
+    auto dictionaryData = CreateInBoundsGEP(encodedData, dictionaryOffset);
+    dictionaryData = CreateBitCast(dictionaryData, getFieldPtrTy(fieldAst.type));
+
+    // Every predicate is evaluated once on every value in the dictionary, the result is stored in a map by code
+    llvm::IRBuilder<> entryBuilder(&mFunction->getEntryBlock(), mFunction->getEntryBlock().begin());
+    auto mapTy = llvm::ArrayType::get(getInt8Ty(), ColumnMapEncodedColumn::MAX_DICTIONARY_SIZE);
+    std::vector<llvm::Value*> maps(fieldAst.predicates.size(), nullptr);
+    for (decltype(fieldAst.predicates.size()) i = 0; i < fieldAst.predicates.size(); ++i) {
+        auto type = fieldAst.predicates[i].type;
+        if (type != PredicateType::IS_NULL && type != PredicateType::IS_NOT_NULL) {
+            maps[i] = entryBuilder.CreateInBoundsGEP(entryBuilder.CreateAlloca(mapTy),
+                    { getInt64(0), getInt64(0) });
         }
+    }
 
-        // Store resulting conjunct value
-        auto& conjunctProperties = scanAst.conjunctProperties[predicateAst.conjunct];
-        LOG_ASSERT(conjunctProperties.predicateCount > 0, "Conjunct must have predicates");
-
-        llvm::Value* conjunctPtr;
-        if (conjunctProperties.predicateCount == 1) {
-            auto queryIndex = conjunctProperties.queryIndex;
-            auto& query = scanAst.queries[queryIndex];
-            decltype(predicateAst.conjunct) conjunctIdx;
-            if (!query.shared) {
-                conjunctIdx = queryIndex;
-            } else {
-                for (conjunctIdx = query.conjunctOffset; conjunctIdx < predicateAst.conjunct; ++conjunctIdx) {
-                    if (scanAst.conjunctProperties[conjunctIdx].predicateCount < 2) {
-                        break;
-                    }
-                }
+    // -> for (auto code = 0; code < dictionarySize; ++code) map[code] = predicate(dictionary[code]);
+    createLoop(getInt64(0), dictionarySize, 1, "col." + llvm::Twine(fieldAst.id) + ".dict.map",
+            [this, &fieldAst, &maps, dictionaryData] (llvm::Value* code) {
+        auto value = CreateAlignedLoad(CreateInBoundsGEP(dictionaryData, code), fieldAst.alignment);
+        for (decltype(fieldAst.predicates.size()) i = 0; i < fieldAst.predicates.size(); ++i) {
+            if (maps[i]) {
+                auto res = buildFixedPredicate(fieldAst.predicates[i], value, 1);
+                CreateAlignedStore(CreateZExt(res, getInt8Ty()), CreateInBoundsGEP(maps[i], code), 1u);
             }
+        }
+    });
+
+    // -> auto codes = *reinterpret_cast<const uint8_t[vectorSize]*>(encodedData + idx);
+    auto load = [this, encodedData] (llvm::Value* idx, uint64_t vectorSize) {
+        auto codes = CreateInBoundsGEP(encodedData, idx);
+        codes = CreateBitCast(codes, getInt8VectorTy(vectorSize)->getPointerTo());
+        return static_cast<llvm::Value*>(CreateAlignedLoad(codes, 1u));
+    };
+
+    // -> auto res = map[codes];
+    auto evaluate = [this, &maps] (const PredicateAST& /* predicateAst */, size_t predicateIdx, llvm::Value* codes,
+            uint64_t vectorSize) {
+        return buildDictionaryLookup(maps[predicateIdx], codes, vectorSize);
+    };
+
+    buildFixedFieldEvaluation(nullData, vectorEnd, vectorSize, scanAst, fieldAst, "dict", load, evaluate);
+}
 
-            conjunctPtr = idx;
-            if (conjunctIdx > 0) {
-                conjunctPtr = CreateAdd(createConstMul(mCount, conjunctIdx), conjunctPtr);
-            }
-            conjunctPtr = CreateInBoundsGEP(getParam(resultData), conjunctPtr);
-            conjunctPtr = CreateBitCast(conjunctPtr, conjunctTy->getPointerTo());
-            if (conjunctsGenerated[conjunctIdx]) {
-                res = CreateAnd(CreateAlignedLoad(conjunctPtr, 1u), res);
-            } else {
-                conjunctsGenerated[conjunctIdx] = true;
-            }
-        } else {
-            conjunctPtr = CreateAdd(createConstMul(mCount, predicateAst.conjunct), idx);
-            conjunctPtr = CreateInBoundsGEP(getParam(resultData), conjunctPtr);
-            conjunctPtr = CreateBitCast(conjunctPtr, conjunctTy->getPointerTo());
-            if (conjunctsGenerated[predicateAst.conjunct]) {
-                res = CreateOr(CreateAlignedLoad(conjunctPtr, 1u), res);
-            } else {
-                conjunctsGenerated[predicateAst.conjunct] = true;
+llvm::Value* LLVMColumnMapScanBuilder::buildDictionaryLookup(llvm::Value* map, llvm::Value* codes,
+        uint64_t vectorSize) {
+    // Look up the entry of every element (there is no vector gather in the IR)
+    llvm::Value* entries;
+    if (vectorSize == 1) {
+        entries = CreateAlignedLoad(CreateInBoundsGEP(map, CreateZExt(codes, getInt64Ty())), 1u);
+    } else {
+        entries = llvm::UndefValue::get(getInt8VectorTy(vectorSize));
+        for (decltype(vectorSize) i = 0; i < vectorSize; ++i) {
+            auto code = CreateZExt(CreateExtractElement(codes, getInt32(i)), getInt64Ty());
+            auto entry = CreateAlignedLoad(CreateInBoundsGEP(map, code), 1u);
+            entries = CreateInsertElement(entries, entry, getInt32(i));
+        }
+    }
+    return CreateICmp(llvm::CmpInst::ICMP_NE, entries, getInt8Vector(vectorSize, 0));
+}
+
+void LLVMColumnMapScanBuilder::buildRunLengthFixedField(const ScanAST& scanAst, const FieldAST& fieldAst,
+        llvm::Value* header, llvm::Value* encodedData, llvm::Value* nullData, llvm::Value* vectorEnd) {
+    // -> auto runCount = static_cast<uint64_t>(header->valueCount);
+    auto runCount = CreateInBoundsGEP(header, { getInt64(0), getInt32(2) });
+    runCount = CreateZExt(CreateAlignedLoad(runCount, 4u), getInt64Ty());
+
+    // -> auto runEnds = reinterpret_cast<const uint32_t*>(encodedData);
+    auto runEnds = CreateBitCast(encodedData, getInt32PtrTy());
+
+    // -> auto runValues = reinterpret_cast<const T*>(encodedData + align(runCount * 4, 8));
+    auto runValuesOffset = CreateAnd(CreateAdd(CreateShl(runCount, getInt64(2)), getInt64(7)), getInt64(-8));
+    auto runValues = CreateInBoundsGEP(encodedData, runValuesOffset);
+    runValues = CreateBitCast(runValues, getFieldPtrTy(fieldAst.type));
+
+    // The predicates are evaluated once per run, the result is then applied to every element in the run
+    // The range of the vectorized evaluation is processed separately to keep the generated conjuncts consistent
+    auto buildRunLoop = [this, &scanAst, &fieldAst, nullData, runCount, runEnds, runValues] (llvm::Value* start,
+            llvm::Value* end, std::vector<uint8_t>& conjunctsGenerated, const llvm::Twine& name) {
+        auto searchBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".rle." + name + ".start");
+        auto bodyBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".rle." + name + ".body");
+        auto endBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".rle." + name + ".end");
+        CreateCondBr(CreateICmp(llvm::CmpInst::ICMP_NE, start, end), searchBlock, endBlock);
+
+        // -> auto run = upper_bound(runEnds, runEnds + runCount, start) - runEnds;
+        SetInsertPoint(searchBlock);
+        auto firstRun = createRunLengthSearch(*this, runEnds, runCount, start,
+                "col." + llvm::Twine(fieldAst.id) + ".rle." + name);
+        auto searchEndBlock = GetInsertBlock();
+        CreateBr(bodyBlock);
+
+        SetInsertPoint(bodyBlock);
+        auto run = CreatePHI(getInt64Ty(), 2);
+        run->addIncoming(firstRun, searchEndBlock);
+        auto runStart = CreatePHI(getInt64Ty(), 2);
+        runStart->addIncoming(start, searchEndBlock);
+
+        // -> auto runEnd = std::min(static_cast<uint64_t>(runEnds[run]), end);
+        llvm::Value* runEnd = CreateAlignedLoad(CreateInBoundsGEP(runEnds, run), 4u);
+        runEnd = CreateZExt(runEnd, getInt64Ty());
+        runEnd = CreateSelect(CreateICmp(llvm::CmpInst::ICMP_ULT, runEnd, end), runEnd, end);
+
+        // -> auto res = predicate(runValues[run]);
+        auto runValue = CreateAlignedLoad(CreateInBoundsGEP(runValues, run), fieldAst.alignment);
+        std::vector<llvm::Value*> runResults(fieldAst.predicates.size(), nullptr);
+        for (decltype(fieldAst.predicates.size()) i = 0; i < fieldAst.predicates.size(); ++i) {
+            auto type = fieldAst.predicates[i].type;
+            if (type != PredicateType::IS_NULL && type != PredicateType::IS_NOT_NULL) {
+                runResults[i] = buildFixedPredicate(fieldAst.predicates[i], runValue, 1);
             }
         }
-        CreateAlignedStore(res, conjunctPtr, 1u);
+
+        auto load = [] (llvm::Value* /* idx */, uint64_t /* vectorSize */) {
+            return static_cast<llvm::Value*>(nullptr);
+        };
+        auto evaluate = [&runResults] (const PredicateAST& /* predicateAst */, size_t predicateIdx,
+                llvm::Value* /* lhsValue */, uint64_t /* vectorSize */) {
+            return runResults[predicateIdx];
+        };
+        buildFixedFieldLoop(nullData, runStart, runEnd, 1, conjunctsGenerated, scanAst, fieldAst, "rle." + name,
+                load, evaluate);
+
+        // -> ++run;
+        auto runNext = CreateAdd(run, getInt64(1));
+        run->addIncoming(runNext, GetInsertBlock());
+        runStart->addIncoming(runEnd, GetInsertBlock());
+
+        // -> runEnd != end
+        CreateCondBr(CreateICmp(llvm::CmpInst::ICMP_NE, runEnd, end), bodyBlock, endBlock);
+
+        SetInsertPoint(endBlock);
+    };
+
+    if (vectorEnd != getParam(startIdx)) {
+        buildRunLoop(getParam(startIdx), vectorEnd, mVectorConjunctsGenerated, "vector");
     }
+    buildRunLoop(vectorEnd, getParam(endIdx), mScalarConjunctsGenerated, "scalar");
+}
 
-    // -> idx += vectorSize;
-    auto idxNext = CreateAdd(idx, getInt64(vectorSize));
-    idx->addIncoming(idxNext, GetInsertBlock());
+llvm::Value* LLVMColumnMapScanBuilder::buildFixedPredicate(const PredicateAST& predicateAst, llvm::Value* lhsValue,
+        uint64_t vectorSize) {
+    LOG_ASSERT(lhsValue != nullptr, "lhs must not be null for this kind of comparison");
+    auto& rhsAst = predicateAst.fixed;
 
-    // -> lhs += vectorSize;
-    llvm::Value* lhsNext = nullptr;
-    if (srcData) {
-        lhsNext = CreateInBoundsGEP(lhsPhi, getInt64(vectorSize));
-        lhsPhi->addIncoming(lhsNext, GetInsertBlock());
+    switch (predicateAst.type) {
+    case PredicateType::BETWEEN: {
+        return createRangeCheck(lhsValue, rhsAst.value, rhsAst.upperValue, rhsAst.isFloat, vectorSize);
+    } break;
+
+    case PredicateType::IN_LIST: {
+        if (rhsAst.valueMap) {
+            return createMapCheck(lhsValue, rhsAst.value, rhsAst.valueMap, rhsAst.mapSize, vectorSize);
+        }
+        if (rhsAst.sortedValues) {
+            return createSearchCheck(lhsValue, rhsAst.sortedValues, rhsAst.sortedSize, rhsAst.isFloat, vectorSize);
+        }
+        return createListCheck(lhsValue, rhsAst.values, rhsAst.valueCount, rhsAst.isFloat, vectorSize);
+    } break;
+
+    default: {
+        auto rhsValue = getVector(vectorSize, rhsAst.value);
+        return (rhsAst.isFloat
+            ? CreateFCmp(rhsAst.predicate, lhsValue, rhsValue)
+            : CreateICmp(rhsAst.predicate, lhsValue, rhsValue));
+    } break;
     }
+}
 
-    // -> nullValue += vectorSize;
-    llvm::Value* nullNext = nullptr;
-    if (nullData) {
-        nullNext = CreateInBoundsGEP(nullPhi, getInt64(vectorSize));
-        nullPhi->addIncoming(nullNext, GetInsertBlock());
+void LLVMColumnMapScanBuilder::buildVariableField(const ScanAST& scanAst, const FieldAST& fieldAst) {
+    // The values are never read when only checking the null status
+    if (!fieldAst.needsValue || fieldAst.id >= ColumnMapMainPage::MAX_ENCODED_COLUMNS) {
+        buildRawVariableField(scanAst, fieldAst);
+        return;
     }
 
-    // -> idx != end
-    CreateCondBr(CreateICmp(llvm::CmpInst::ICMP_NE, idxNext, end), bodyBlock, endBlock);
+    auto rawBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".raw");
+    auto dictBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".dict");
+    auto endBlock = createBasicBlock("col." + llvm::Twine(fieldAst.id) + ".end");
 
-    mFunction->getBasicBlockList().push_back(endBlock);
-    SetInsertPoint(endBlock);
+    // -> if (mainPage->encodedColumns & (1 << id))
+    auto encodedColumns = CreateInBoundsGEP(mMainPage, { getInt64(0), getInt32(4) });
+    encodedColumns = CreateAlignedLoad(encodedColumns, 8u);
+    auto isEncoded = CreateAnd(encodedColumns, getInt64(0x1ull << fieldAst.id));
+    CreateCondBr(CreateICmp(llvm::CmpInst::ICMP_NE, isEncoded, getInt64(0)), dictBlock, rawBlock);
 
-    llvm::PHINode* nullEnd = nullptr;
-    llvm::PHINode* lhsEnd = nullptr;
-    if (vectorSize != 1) {
-        if (nullData) {
-            nullEnd = CreatePHI(nullData->getType(), 2);
-            nullEnd->addIncoming(nullData, previousBlock);
-            nullEnd->addIncoming(nullNext, bodyBlock);
-        }
+    // Both code paths write the same conjuncts: Each one has to start with the conjuncts generated before this field
+    auto scalarConjunctsGenerated = mScalarConjunctsGenerated;
 
-        if (srcData) {
-            lhsEnd = CreatePHI(srcData->getType(), 2);
-            lhsEnd->addIncoming(srcData, previousBlock);
-            lhsEnd->addIncoming(lhsNext, bodyBlock);
-        }
-    }
+    // Raw
+    SetInsertPoint(rawBlock);
+    buildRawVariableField(scanAst, fieldAst);
+    CreateBr(endBlock);
 
-    return std::make_tuple(end, lhsEnd, nullEnd);
+    // Dictionary
+    SetInsertPoint(dictBlock);
+    mScalarConjunctsGenerated = scalarConjunctsGenerated;
+    buildDictionaryVariableField(scanAst, fieldAst);
+    CreateBr(endBlock);
+
+    SetInsertPoint(endBlock);
 }
 
-void LLVMColumnMapScanBuilder::buildVariableField(const ScanAST& scanAst, const FieldAST& fieldAst) {
+void LLVMColumnMapScanBuilder::buildRawVariableField(const ScanAST& scanAst, const FieldAST& fieldAst) {
     auto start = getParam(startIdx);
     auto end = getParam(endIdx);
 
@@ -418,7 +789,6 @@ void LLVMColumnMapScanBuilder::buildVariableField(const ScanAST& scanAst, const
     // Evaluate all predicates attached to this field
     for (decltype(fieldAst.predicates.size()) i = 0; i < fieldAst.predicates.size(); ++i) {
         auto& predicateAst = fieldAst.predicates[i];
-        auto& rhsAst = predicateAst.variable;
 
         // Execute the comparison
         llvm::Value* res = nullptr;
@@ -432,94 +802,9 @@ void LLVMColumnMapScanBuilder::buildVariableField(const ScanAST& scanAst, const
             res = CreateXor(nullValue, getInt8(1));
         } break;
 
-        case PredicateType::EQUAL:
-        case PredicateType::NOT_EQUAL: {
-            LOG_ASSERT(srcStartData != nullptr, "lhs must not be null for this kind of comparison");
-
-            auto negateResult = (predicateAst.type == PredicateType::NOT_EQUAL);
-            if (rhsAst.size == 0) {
-                res = CreateICmp((negateResult ? llvm::CmpInst::ICMP_NE : llvm::CmpInst::ICMP_EQ), length, getInt32(0));
-            } else {
-                auto lengthComp = CreateICmp(llvm::CmpInst::ICMP_EQ, length, getInt32(rhsAst.size));
-                auto prefixComp = CreateICmp(llvm::CmpInst::ICMP_EQ, prefix, getInt32(rhsAst.prefix));
-                res = CreateAnd(lengthComp, prefixComp);
-
-                if (rhsAst.size > 4) {
-                    auto dataStart = CreateInBoundsGEP(lhsStart, getInt64(4));
-                    auto rhsStart = CreateInBoundsGEP(rhsAst.value->getValueType(), rhsAst.value,
-                            { getInt64(0), getInt32(4) });
-                    auto rhsEnd = CreateGEP(rhsAst.value->getValueType(), rhsAst.value,
-                            { getInt64(1), getInt32(0) });
-
-                    res = createMemCmp(res, dataStart, rhsStart, rhsEnd,
-                            "col." + llvm::Twine(fieldAst.id) + "." + llvm::Twine(i));
-                }
-                if (negateResult) {
-                    res = CreateNot(res);
-                }
-            }
-            res = CreateZExtOrBitCast(res, getInt8Ty());
-
-            // The predicate evaluates to false if the value is null
-            if (nullData) {
-                res = CreateAnd(res, CreateXor(nullValue, getInt8(1)));
-            }
-        } break;
-
-        case PredicateType::PREFIX_LIKE:
-        case PredicateType::PREFIX_NOT_LIKE: {
-            LOG_ASSERT(srcStartData != nullptr, "lhs must not be null for this kind of comparison");
-
-            auto negateResult = (predicateAst.type == PredicateType::PREFIX_NOT_LIKE);
-            if (rhsAst.size == 0) {
-                res = (negateResult ? getFalse() : getTrue());
-            } else {
-                auto lengthComp = CreateICmp(llvm::CmpInst::ICMP_UGE, length, getInt32(rhsAst.size));
-                auto maskedPrefix = prefix;
-                if (rhsAst.size < 4) {
-                    uint32_t mask = 0;
-                    memset(&mask, 0xFFu, rhsAst.size);
-                    maskedPrefix = CreateAnd(maskedPrefix, getInt32(mask));
-                }
-                auto prefixComp = CreateICmp(llvm::CmpInst::ICMP_EQ, maskedPrefix, getInt32(rhsAst.prefix));
-                res = CreateAnd(lengthComp, prefixComp);
-
-                if (rhsAst.size > 4) {
-                    auto dataStart = CreateInBoundsGEP(lhsStart, getInt64(4));
-                    auto rhsStart = CreateInBoundsGEP(rhsAst.value->getValueType(), rhsAst.value,
-                            { getInt64(0), getInt32(4) });
-                    auto rhsEnd = CreateGEP(rhsAst.value->getValueType(), rhsAst.value,
-                            { getInt64(1), getInt32(0) });
-
-                    res = createMemCmp(res, dataStart, rhsStart, rhsEnd,
-                            "col." + llvm::Twine(fieldAst.id) + "." + llvm::Twine(i));
-                }
-                if (negateResult) {
-                    res = CreateNot(res);
-                }
-            }
-            res = CreateZExtOrBitCast(res, getInt8Ty());
-
-            // The predicate evaluates to false if the value is null
-            if (nullData) {
-                res = CreateAnd(res, CreateXor(nullValue, getInt8(1)));
-            }
-        } break;
-
-        case PredicateType::POSTFIX_LIKE:
-        case PredicateType::POSTFIX_NOT_LIKE: {
+        default: {
             LOG_ASSERT(srcStartData != nullptr, "lhs must not be null for this kind of comparison");
-
-            auto negateResult = (predicateAst.type == PredicateType::POSTFIX_NOT_LIKE);
-            if (rhsAst.size == 0) {
-                res = (negateResult ? getFalse() : getTrue());
-            } else {
-                res = createPostfixMemCmp(lhsStart, length, rhsAst.value, rhsAst.size,
-                        "col." + llvm::Twine(fieldAst.id) + "." + llvm::Twine(i));
-                if (negateResult) {
-                    res = CreateNot(res);
-                }
-            }
+            res = buildVariablePredicate(fieldAst, i, lhsStart, length, prefix);
             res = CreateZExtOrBitCast(res, getInt8Ty());
 
             // The predicate evaluates to false if the value is null
@@ -527,11 +812,6 @@ void LLVMColumnMapScanBuilder::buildVariableField(const ScanAST& scanAst, const
                 res = CreateAnd(res, CreateXor(nullValue, getInt8(1)));
             }
         } break;
-
-        default: {
-            LOG_ASSERT(false, "Unknown predicate");
-            res = nullptr;
-        } break;
         }
 
         // Store resulting conjunct value
@@ -602,6 +882,269 @@ void LLVMColumnMapScanBuilder::buildVariableField(const ScanAST& scanAst, const
     SetInsertPoint(endBlock);
 }
 
+void LLVMColumnMapScanBuilder::buildDictionaryVariableField(const ScanAST& scanAst, const FieldAST& fieldAst) {
+    static_assert(sizeof(ColumnMapDictionaryColumn) == 2 * sizeof(uint32_t), "Unexpected dictionary column size");
+    static_assert(sizeof(ColumnMapDictionaryEntry) == 3 * sizeof(uint32_t), "Unexpected dictionary entry size");
+
+    auto& record = mContext.record();
+    auto varSizeFieldCount = record.varSizeFieldCount();
+    auto destIdx = fieldAst.id - record.fixedSizeFieldCount();
+
+    // The codes are stored in the upper half of the 8 byte heap entries
+    auto start = getParam(startIdx);
+    auto vectorSize = mRegisterWidth / 64;
+    auto vectorEnd = start;
+    if (vectorSize > 1) {
+        auto count = CreateSub(getParam(endIdx), start);
+        count = CreateAnd(count, getInt64(-vectorSize));
+        vectorEnd = CreateAdd(start, count);
+    } else {
+        vectorSize = 1;
+    }
+
+    // -> auto dictionaryData = reinterpret_cast<const uint32_t*>(variableData + count * varSizeFieldCount);
+    auto dictionaryData = CreateInBoundsGEP(mVariableData, createConstMul(mCount, varSizeFieldCount));
+    dictionaryData = CreateBitCast(dictionaryData, getInt32PtrTy());
+
+    // -> auto dictionaryOffset = static_cast<uint64_t>(dictionaryColumns[destIdx].offset);
+    auto dictionaryOffset = CreateInBoundsGEP(dictionaryData, getInt64(destIdx * 2));
+    dictionaryOffset = CreateZExt(CreateAlignedLoad(dictionaryOffset, 4u), getInt64Ty());
+
+    // -> auto dictionarySize = static_cast<uint64_t>(dictionaryColumns[destIdx].size);
+    auto dictionarySize = CreateInBoundsGEP(dictionaryData, getInt64(destIdx * 2 + 1));
+    dictionarySize = CreateZExt(CreateAlignedLoad(dictionarySize, 4u), getInt64Ty());
+
+    // -> auto dictionaryEntries = reinterpret_cast<const ColumnMapDictionaryEntry*>(dictionaryColumns
+    // ->         + varSizeFieldCount) + dictionaryOffset;
+    auto dictionaryEntries = CreateInBoundsGEP(dictionaryData, getInt64(varSizeFieldCount * 2));
+    dictionaryEntries = CreateInBoundsGEP(dictionaryEntries, createConstMul(dictionaryOffset, 3));
+
+    // Every predicate is evaluated once on every value in the dictionary. As the dictionary is sorted the values
+    // matching an equality or prefix predicate form a single range of codes (the NOT variants match the complement of
+    // the range): These predicates only record the first code and the size of the range. Postfix predicates store
+    // their result in a map by code.
+    llvm::IRBuilder<> entryBuilder(&mFunction->getEntryBlock(), mFunction->getEntryBlock().begin());
+    auto mapTy = llvm::ArrayType::get(getInt8Ty(), ColumnMapEncodedColumn::MAX_DICTIONARY_SIZE);
+    std::vector<llvm::Value*> maps(fieldAst.predicates.size(), nullptr);
+    std::vector<llvm::Value*> rangeStarts(fieldAst.predicates.size(), nullptr);
+    std::vector<llvm::Value*> rangeSizes(fieldAst.predicates.size(), nullptr);
+    std::vector<uint8_t> negateResults(fieldAst.predicates.size(), false);
+    for (decltype(fieldAst.predicates.size()) i = 0; i < fieldAst.predicates.size(); ++i) {
+        switch (fieldAst.predicates[i].type) {
+        case PredicateType::IS_NULL:
+        case PredicateType::IS_NOT_NULL:
+            break;
+
+        case PredicateType::POSTFIX_LIKE:
+        case PredicateType::POSTFIX_NOT_LIKE: {
+            maps[i] = entryBuilder.CreateInBoundsGEP(entryBuilder.CreateAlloca(mapTy), { getInt64(0), getInt64(0) });
+        } break;
+
+        default: {
+            // -> auto rangeStart = 0u;
+            // -> auto rangeSize = 0u;
+            rangeStarts[i] = entryBuilder.CreateAlloca(getInt32Ty());
+            rangeSizes[i] = entryBuilder.CreateAlloca(getInt32Ty());
+            CreateAlignedStore(getInt32(0), rangeStarts[i], 4u);
+            CreateAlignedStore(getInt32(0), rangeSizes[i], 4u);
+            negateResults[i] = (fieldAst.predicates[i].type == PredicateType::NOT_EQUAL
+                    || fieldAst.predicates[i].type == PredicateType::PREFIX_NOT_LIKE);
+        } break;
+        }
+    }
+
+    createLoop(getInt64(0), dictionarySize, 1, "col." + llvm::Twine(fieldAst.id) + ".dict.map",
+            [this, &fieldAst, &maps, &rangeStarts, &rangeSizes, &negateResults, dictionaryEntries] (llvm::Value* code) {
+        // -> auto& entry = dictionaryEntries[code];
+        auto entry = CreateInBoundsGEP(dictionaryEntries, createConstMul(code, 3));
+
+        // -> auto lhsStart = page + static_cast<uint64_t>(entry.offset);
+        auto lhsStart = CreateZExt(CreateAlignedLoad(entry, 4u), getInt64Ty());
+        lhsStart = CreateInBoundsGEP(getParam(page), lhsStart);
+
+        // -> auto length = entry.size;
+        auto length = CreateAlignedLoad(CreateInBoundsGEP(entry, getInt64(1)), 4u);
+
+        // -> auto prefix = entry.prefix;
+        auto prefix = CreateAlignedLoad(CreateInBoundsGEP(entry, getInt64(2)), 4u);
+
+        auto code32 = CreateTrunc(code, getInt32Ty());
+        for (decltype(fieldAst.predicates.size()) i = 0; i < fieldAst.predicates.size(); ++i) {
+            if (maps[i]) {
+                // -> map[code] = predicate(entry);
+                auto res = buildVariablePredicate(fieldAst, i, lhsStart, length, prefix);
+                CreateAlignedStore(CreateZExt(res, getInt8Ty()), CreateInBoundsGEP(maps[i], code), 1u);
+            } else if (rangeStarts[i]) {
+                // -> if (predicate(entry) != negateResult) {
+                // ->     rangeStart = (rangeSize == 0 ? code : rangeStart);
+                // ->     ++rangeSize;
+                // -> }
+                auto match = buildVariablePredicate(fieldAst, i, lhsStart, length, prefix);
+                if (negateResults[i]) {
+                    match = CreateNot(match);
+                }
+                auto rangeStart = CreateAlignedLoad(rangeStarts[i], 4u);
+                auto rangeSize = CreateAlignedLoad(rangeSizes[i], 4u);
+                auto first = CreateAnd(match, CreateICmp(llvm::CmpInst::ICMP_EQ, rangeSize, getInt32(0)));
+                CreateAlignedStore(CreateSelect(first, code32, rangeStart), rangeStarts[i], 4u);
+                CreateAlignedStore(CreateAdd(rangeSize, CreateZExt(match, getInt32Ty())), rangeSizes[i], 4u);
+            }
+        }
+    });
+
+    std::vector<llvm::Value*> rangeStartValues(fieldAst.predicates.size(), nullptr);
+    std::vector<llvm::Value*> rangeSizeValues(fieldAst.predicates.size(), nullptr);
+    for (decltype(fieldAst.predicates.size()) i = 0; i < fieldAst.predicates.size(); ++i) {
+        if (rangeStarts[i]) {
+            rangeStartValues[i] = CreateAlignedLoad(rangeStarts[i], 4u);
+            rangeSizeValues[i] = CreateAlignedLoad(rangeSizes[i], 4u);
+        }
+    }
+
+    // -> auto heapEntries = reinterpret_cast<const uint64_t*>(variableData + destIdx * count);
+    auto heapEntries = mVariableData;
+    if (destIdx != 0) {
+        heapEntries = CreateInBoundsGEP(heapEntries, createConstMul(mCount, destIdx));
+    }
+    heapEntries = CreateBitCast(heapEntries, getInt64PtrTy());
+
+    // -> auto codes = static_cast<uint32_t[vectorSize]>(*reinterpret_cast<const uint64_t[vectorSize]*>(heapEntries
+    // ->         + idx) >> 32);
+    auto load = [this, heapEntries] (llvm::Value* idx, uint64_t vectorSize) {
+        auto codes = CreateInBoundsGEP(heapEntries, idx);
+        codes = CreateBitCast(codes, getInt64VectorPtrTy(vectorSize));
+        codes = CreateLShr(CreateAlignedLoad(codes, 8u), getInt64Vector(vectorSize, 32));
+        return CreateTrunc(codes, getInt32VectorTy(vectorSize));
+    };
+
+    // -> auto res = (map ? map[codes] : (codes - rangeStart < rangeSize) != negateResult);
+    auto evaluate = [this, &maps, &rangeStartValues, &rangeSizeValues, &negateResults] (
+            const PredicateAST& /* predicateAst */, size_t predicateIdx, llvm::Value* codes, uint64_t vectorSize) {
+        if (maps[predicateIdx]) {
+            return buildDictionaryLookup(maps[predicateIdx], codes, vectorSize);
+        }
+
+        auto rangeStart = rangeStartValues[predicateIdx];
+        auto rangeSize = rangeSizeValues[predicateIdx];
+        if (vectorSize != 1) {
+            rangeStart = CreateVectorSplat(vectorSize, rangeStart);
+            rangeSize = CreateVectorSplat(vectorSize, rangeSize);
+        }
+        auto res = CreateICmp(llvm::CmpInst::ICMP_ULT, CreateSub(codes, rangeStart), rangeSize);
+        return (negateResults[predicateIdx] ? CreateNot(res) : res);
+    };
+
+    // Load the start pointer to the null bytevector
+    llvm::Value* nullData = nullptr;
+    if (!fieldAst.isNotNull) {
+        nullData = mHeaderData;
+        if (fieldAst.nullIdx != 0) {
+            nullData = CreateInBoundsGEP(nullData, createConstMul(mCount, fieldAst.nullIdx));
+        }
+    }
+
+    // The raw evaluation of variable size fields processes the complete range as scalar conjuncts: The vectorized range
+    // has to start with the scalar conjuncts generated before this field
+    if (vectorSize != 1) {
+        auto vectorConjunctsGenerated = mScalarConjunctsGenerated;
+        buildFixedFieldLoop(nullData, start, vectorEnd, vectorSize, vectorConjunctsGenerated, scanAst, fieldAst,
+                "dict.vector", load, evaluate);
+    }
+    buildFixedFieldLoop(nullData, vectorEnd, getParam(endIdx), 1, mScalarConjunctsGenerated, scanAst, fieldAst,
+            "dict.scalar", load, evaluate);
+}
+
+llvm::Value* LLVMColumnMapScanBuilder::buildVariablePredicate(const FieldAST& fieldAst, size_t predicateIdx,
+        llvm::Value* lhsStart, llvm::Value* length, llvm::Value* prefix) {
+    auto& predicateAst = fieldAst.predicates[predicateIdx];
+    auto& rhsAst = predicateAst.variable;
+
+    switch (predicateAst.type) {
+    case PredicateType::EQUAL:
+    case PredicateType::NOT_EQUAL: {
+        llvm::Value* res = nullptr;
+        auto negateResult = (predicateAst.type == PredicateType::NOT_EQUAL);
+        if (rhsAst.size == 0) {
+            res = CreateICmp((negateResult ? llvm::CmpInst::ICMP_NE : llvm::CmpInst::ICMP_EQ), length, getInt32(0));
+        } else {
+            auto lengthComp = CreateICmp(llvm::CmpInst::ICMP_EQ, length, getInt32(rhsAst.size));
+            auto prefixComp = CreateICmp(llvm::CmpInst::ICMP_EQ, prefix, getInt32(rhsAst.prefix));
+            res = CreateAnd(lengthComp, prefixComp);
+
+            if (rhsAst.size > 4) {
+                auto dataStart = CreateInBoundsGEP(lhsStart, getInt64(4));
+                auto rhsStart = CreateInBoundsGEP(rhsAst.value->getValueType(), rhsAst.value,
+                        { getInt64(0), getInt32(4) });
+                auto rhsEnd = CreateGEP(rhsAst.value->getValueType(), rhsAst.value,
+                        { getInt64(1), getInt32(0) });
+
+                res = createMemCmp(res, dataStart, rhsStart, rhsEnd,
+                        "col." + llvm::Twine(fieldAst.id) + "." + llvm::Twine(predicateIdx));
+            }
+            if (negateResult) {
+                res = CreateNot(res);
+            }
+        }
+        return res;
+    } break;
+
+    case PredicateType::PREFIX_LIKE:
+    case PredicateType::PREFIX_NOT_LIKE: {
+        llvm::Value* res = nullptr;
+        auto negateResult = (predicateAst.type == PredicateType::PREFIX_NOT_LIKE);
+        if (rhsAst.size == 0) {
+            res = (negateResult ? getFalse() : getTrue());
+        } else {
+            auto lengthComp = CreateICmp(llvm::CmpInst::ICMP_UGE, length, getInt32(rhsAst.size));
+            auto maskedPrefix = prefix;
+            if (rhsAst.size < 4) {
+                uint32_t mask = 0;
+                memset(&mask, 0xFFu, rhsAst.size);
+                maskedPrefix = CreateAnd(maskedPrefix, getInt32(mask));
+            }
+            auto prefixComp = CreateICmp(llvm::CmpInst::ICMP_EQ, maskedPrefix, getInt32(rhsAst.prefix));
+            res = CreateAnd(lengthComp, prefixComp);
+
+            if (rhsAst.size > 4) {
+                auto dataStart = CreateInBoundsGEP(lhsStart, getInt64(4));
+                auto rhsStart = CreateInBoundsGEP(rhsAst.value->getValueType(), rhsAst.value,
+                        { getInt64(0), getInt32(4) });
+                auto rhsEnd = CreateGEP(rhsAst.value->getValueType(), rhsAst.value,
+                        { getInt64(1), getInt32(0) });
+
+                res = createMemCmp(res, dataStart, rhsStart, rhsEnd,
+                        "col." + llvm::Twine(fieldAst.id) + "." + llvm::Twine(predicateIdx));
+            }
+            if (negateResult) {
+                res = CreateNot(res);
+            }
+        }
+        return res;
+    } break;
+
+    case PredicateType::POSTFIX_LIKE:
+    case PredicateType::POSTFIX_NOT_LIKE: {
+        llvm::Value* res = nullptr;
+        auto negateResult = (predicateAst.type == PredicateType::POSTFIX_NOT_LIKE);
+        if (rhsAst.size == 0) {
+            res = (negateResult ? getFalse() : getTrue());
+        } else {
+            res = createPostfixMemCmp(lhsStart, length, rhsAst.value, rhsAst.size,
+                    "col." + llvm::Twine(fieldAst.id) + "." + llvm::Twine(predicateIdx));
+            if (negateResult) {
+                res = CreateNot(res);
+            }
+        }
+        return res;
+    } break;
+
+    default: {
+        LOG_ASSERT(false, "Unknown predicate");
+        return nullptr;
+    } break;
+    }
+}
+
 void LLVMColumnMapScanBuilder::buildQuery(bool needsKey, const std::vector<QueryAST>& queries) {
     auto start = getParam(startIdx);
     auto validFromStart = CreateInBoundsGEP(getParam(validFromData), start);
@@ -612,17 +1155,27 @@ void LLVMColumnMapScanBuilder::buildQuery(bool needsKey, const std::vector<Query
     }
     auto vectorSize = mRegisterWidth / (sizeof(uint64_t) * 8);
 
+    // Load the snapshot versions (base version and version) of every query
+    std::vector<std::pair<llvm::Value*, llvm::Value*>> versions;
+    versions.reserve(queries.size());
+    for (decltype(queries.size()) i = 0; i < queries.size(); ++i) {
+        auto baseVersion = CreateAlignedLoad(CreateInBoundsGEP(getParam(versionData), getInt64(2 * i)), 8u);
+        auto version = CreateAlignedLoad(CreateInBoundsGEP(getParam(versionData), getInt64(2 * i + 1)), 8u);
+        versions.emplace_back(baseVersion, version);
+    }
+
     // Vectorized query evaluation
     std::tie(start, validFromStart, validToStart, keyStart) = buildQueryEvaluation(start, validFromStart, validToStart,
-            keyStart, vectorSize, queries, llvm::Twine("vector"));
+            keyStart, vectorSize, queries, versions, llvm::Twine("vector"));
 
     // Scalar query evaluation
-    buildQueryEvaluation(start, validFromStart, validToStart, keyStart, 1, queries, llvm::Twine("scalar"));
+    buildQueryEvaluation(start, validFromStart, validToStart, keyStart, 1, queries, versions, llvm::Twine("scalar"));
 }
 
 std::tuple<llvm::Value*, llvm::Value*, llvm::Value*, llvm::Value*> LLVMColumnMapScanBuilder::buildQueryEvaluation(
         llvm::Value* start, llvm::Value* validFromStart, llvm::Value* validToStart, llvm::Value* keyStart,
-        uint64_t vectorSize, const std::vector<QueryAST>& queries, const llvm::Twine& name) {
+        uint64_t vectorSize, const std::vector<QueryAST>& queries,
+        const std::vector<std::pair<llvm::Value*, llvm::Value*>>& versions, const llvm::Twine& name) {
     auto end = getParam(endIdx);
     if (vectorSize != 1) {
         auto count = CreateSub(end, start);
@@ -630,6 +1183,18 @@ std::tuple<llvm::Value*, llvm::Value*, llvm::Value*, llvm::Value*> LLVMColumnMap
         end = CreateAdd(start, count);
     }
 
+    // Broadcast the snapshot versions into vectors outside of the loop
+    std::vector<std::pair<llvm::Value*, llvm::Value*>> versionVectors;
+    versionVectors.reserve(versions.size());
+    for (auto& v : versions) {
+        if (vectorSize == 1) {
+            versionVectors.emplace_back(v);
+        } else {
+            versionVectors.emplace_back(CreateVectorSplat(vectorSize, v.first),
+                    CreateVectorSplat(vectorSize, v.second));
+        }
+    }
+
     auto previousBlock = GetInsertBlock();
     auto bodyBlock = createBasicBlock("check." + name + ".body");
     auto endBlock = llvm::BasicBlock::Create(Context, "check." + name + ".end");
@@ -680,8 +1245,8 @@ std::tuple<llvm::Value*, llvm::Value*, llvm::Value*, llvm::Value*> LLVMColumnMap
         auto& query = queries[i];
 
         // Evaluate validFrom <= version && validTo > baseVersion
-        auto validFromRes = CreateICmp(llvm::CmpInst::ICMP_ULE, validFrom, getInt64Vector(vectorSize, query.version));
-        auto validToRes = CreateICmp(llvm::CmpInst::ICMP_UGT, validTo, getInt64Vector(vectorSize, query.baseVersion));
+        auto validFromRes = CreateICmp(llvm::CmpInst::ICMP_ULE, validFrom, versionVectors[i].second);
+        auto validToRes = CreateICmp(llvm::CmpInst::ICMP_UGT, validTo, versionVectors[i].first);
         auto res = CreateAnd(validFromRes, validToRes);
 
         // Evaluate (key >> partitionShift) % partitionModulo == partitionNumber
@@ -780,14 +1345,19 @@ void LLVMColumnMapScanBuilder::buildResult(const std::vector<QueryAST>& queries)
                     continue;
                 }
 
-                buildConjunctMerge(vectorSize, src, mergeConjunct);
+                buildIfActive({src}, "conj." + llvm::Twine(src), [this, vectorSize, src, mergeConjunct] () {
+                    buildConjunctMerge(vectorSize, src, mergeConjunct);
+                });
             }
             mergedOffset += query.numConjunct;
         }
 
         // Merge last conjunct of the query into the final result conjunct
         if (query.shared) {
-            buildConjunctMerge(vectorSize, mergeConjunct, i);
+            buildIfActive({mergeConjunct}, "conj." + llvm::Twine(mergeConjunct),
+                    [this, vectorSize, mergeConjunct, i] () {
+                buildConjunctMerge(vectorSize, mergeConjunct, i);
+            });
         }
     }
 }
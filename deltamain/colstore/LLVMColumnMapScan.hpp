@@ -49,7 +49,9 @@ public:
             const char* /* page */,
             uint64_t /* startIdx */,
             uint64_t /* endIdx */,
-            char* /* resultData */);
+            char* /* resultData */,
+            const uint64_t* /* versionData */,
+            const uint8_t* /* activeData */);
 
     static const std::string FUNCTION_NAME;
 
@@ -67,6 +69,8 @@ private:
     static constexpr size_t startIdx = 4;
     static constexpr size_t endIdx = 5;
     static constexpr size_t resultData = 6;
+    static constexpr size_t versionData = 7;
+    static constexpr size_t activeData = 8;
 
     static llvm::Type* buildReturnTy(llvm::LLVMContext& context) {
         return llvm::Type::getVoidTy(context);
@@ -80,7 +84,9 @@ private:
             { llvm::Type::getInt8Ty(context)->getPointerTo(), "page" },
             { llvm::Type::getInt64Ty(context), "startIdx" },
             { llvm::Type::getInt64Ty(context), "endIdx" },
-            { llvm::Type::getInt8Ty(context)->getPointerTo(), "resultData" }
+            { llvm::Type::getInt8Ty(context)->getPointerTo(), "resultData" },
+            { llvm::Type::getInt64Ty(context)->getPointerTo(), "versionData" },
+            { llvm::Type::getInt8Ty(context)->getPointerTo(), "activeData" }
         };
     }
 
@@ -88,19 +94,59 @@ private:
 
     void buildScan(const ScanAST& scanAst);
 
+    /**
+     * @brief Loads whether any query evaluating the conjunct still needs tuples for every conjunct
+     */
+    void buildConjunctActive(const ScanAST& scanAst);
+
+    /**
+     * @brief Branches around the code created by the function if no query evaluating any of the conjuncts is active
+     */
+    template <typename Fun>
+    void buildIfActive(const std::vector<uint32_t>& conjuncts, const llvm::Twine& name, Fun fun);
+
     void buildFixedField(const ScanAST& scanAst, const FieldAST& fieldAst);
 
-    std::tuple<llvm::Value*, llvm::Value*, llvm::Value*> buildFixedFieldEvaluation(llvm::Value* srcData,
-            llvm::Value* nullData, llvm::Value* start, uint64_t vectorSize, std::vector<uint8_t>& conjunctsGenerated,
-            const ScanAST& scanAst, const FieldAST& fieldAst, const llvm::Twine& name);
+    void buildRawFixedField(const ScanAST& scanAst, const FieldAST& fieldAst, llvm::Value* columnData,
+            llvm::Value* nullData, llvm::Value* vectorEnd, uint64_t vectorSize);
+
+    void buildFrameOfReferenceFixedField(const ScanAST& scanAst, const FieldAST& fieldAst, llvm::Value* header,
+            llvm::Value* encodedData, llvm::Value* nullData, llvm::Value* vectorEnd, uint64_t vectorSize);
+
+    void buildDictionaryFixedField(const ScanAST& scanAst, const FieldAST& fieldAst, llvm::Value* header,
+            llvm::Value* encodedData, llvm::Value* nullData, llvm::Value* vectorEnd, uint64_t vectorSize);
+
+    void buildRunLengthFixedField(const ScanAST& scanAst, const FieldAST& fieldAst, llvm::Value* header,
+            llvm::Value* encodedData, llvm::Value* nullData, llvm::Value* vectorEnd);
+
+    template <typename Load, typename Evaluate>
+    void buildFixedFieldEvaluation(llvm::Value* nullData, llvm::Value* vectorEnd, uint64_t vectorSize,
+            const ScanAST& scanAst, const FieldAST& fieldAst, const llvm::Twine& name, Load load, Evaluate evaluate);
+
+    template <typename Load, typename Evaluate>
+    void buildFixedFieldLoop(llvm::Value* nullData, llvm::Value* start, llvm::Value* end, uint64_t vectorSize,
+            std::vector<uint8_t>& conjunctsGenerated, const ScanAST& scanAst, const FieldAST& fieldAst,
+            const llvm::Twine& name, Load load, Evaluate evaluate);
+
+    llvm::Value* buildFixedPredicate(const PredicateAST& predicateAst, llvm::Value* lhsValue, uint64_t vectorSize);
+
+    llvm::Value* buildDictionaryLookup(llvm::Value* map, llvm::Value* codes, uint64_t vectorSize);
 
     void buildVariableField(const ScanAST& scanAst, const FieldAST& fieldAst);
 
+    void buildRawVariableField(const ScanAST& scanAst, const FieldAST& fieldAst);
+
+    void buildDictionaryVariableField(const ScanAST& scanAst, const FieldAST& fieldAst);
+
+    llvm::Value* buildVariablePredicate(const FieldAST& fieldAst, size_t predicateIdx, llvm::Value* lhsStart,
+            llvm::Value* length, llvm::Value* prefix);
+
     void buildQuery(bool needsKey, const std::vector<QueryAST>& queries);
 
     std::tuple<llvm::Value*, llvm::Value*, llvm::Value*, llvm::Value*> buildQueryEvaluation(llvm::Value* start,
             llvm::Value* validFromStart, llvm::Value* validToStart, llvm::Value* keyStart, uint64_t vectorSize,
-            const std::vector<QueryAST>& queries, const llvm::Twine& name);
+            const std::vector<QueryAST>& queries, const std::vector<std::pair<llvm::Value*, llvm::Value*>>& versions,
+            const llvm::Twine& name);
 
     void buildResult(const std::vector<QueryAST>& queries);
 
@@ -113,6 +159,7 @@ private:
 
     llvm::StructType* mMainPageStructTy;
     llvm::StructType* mHeapEntryStructTy;
+    llvm::StructType* mEncodedColumnStructTy;
 
     llvm::Value* mMainPage;
     llvm::Value* mCount;
@@ -124,6 +171,9 @@ private:
 
     std::vector<uint8_t> mVectorConjunctsGenerated;
     std::vector<uint8_t> mScalarConjunctsGenerated;
+
+    /// Whether any query evaluating the conjunct still needs tuples (or null if no query uses the conjunct)
+    std::vector<llvm::Value*> mConjunctActive;
 };
 
 } // namespace deltamain
@@ -23,23 +23,31 @@
 
 #include "LLVMColumnMapUtils.hpp"
 
+#include "ColumnMapContext.hpp"
+#include "ColumnMapEncoding.hpp"
 #include "ColumnMapPage.hpp"
 
+#include <util/LLVMBuilder.hpp>
+
+#include <tellstore/Record.hpp>
+
 namespace tell {
 namespace store {
 namespace deltamain {
 
 llvm::StructType* getColumnMapMainPageTy(llvm::LLVMContext& context) {
-    static_assert(sizeof(ColumnMapMainPage) == 16, "Size of ColumnMapHeapEntry must be 16");
+    static_assert(sizeof(ColumnMapMainPage) == 24, "Size of ColumnMapMainPage must be 24");
     static_assert(offsetof(ColumnMapMainPage, count) == 0, "Offset of count must be 0");
     static_assert(offsetof(ColumnMapMainPage, headerOffset) == 4, "Offset of headerOffset must be 4");
     static_assert(offsetof(ColumnMapMainPage, fixedOffset) == 8, "Offset of fixedOffset must be 8");
     static_assert(offsetof(ColumnMapMainPage, variableOffset) == 12, "Offset of variableOffset must be 12");
+    static_assert(offsetof(ColumnMapMainPage, encodedColumns) == 16, "Offset of encodedColumns must be 16");
     return llvm::StructType::get(context, {
         llvm::Type::getInt32Ty(context),    // count
         llvm::Type::getInt32Ty(context),    // headerOffset
         llvm::Type::getInt32Ty(context),    // fixedOffset
-        llvm::Type::getInt32Ty(context)     // variableOffset
+        llvm::Type::getInt32Ty(context),    // variableOffset
+        llvm::Type::getInt64Ty(context)     // encodedColumns
     });
 }
 
@@ -53,6 +61,174 @@ llvm::StructType* getColumnMapHeapEntriesTy(llvm::LLVMContext& context) {
     });
 }
 
+llvm::StructType* getColumnMapEncodedColumnTy(llvm::LLVMContext& context) {
+    static_assert(sizeof(ColumnMapEncodedColumn) == 16, "Size of ColumnMapEncodedColumn must be 16");
+    static_assert(offsetof(ColumnMapEncodedColumn, encoding) == 0, "Offset of encoding must be 0");
+    static_assert(offsetof(ColumnMapEncodedColumn, width) == 1, "Offset of width must be 1");
+    static_assert(offsetof(ColumnMapEncodedColumn, valueCount) == 4, "Offset of valueCount must be 4");
+    static_assert(offsetof(ColumnMapEncodedColumn, base) == 8, "Offset of base must be 8");
+    return llvm::StructType::get(context, {
+        llvm::Type::getInt8Ty(context),     // encoding
+        llvm::Type::getInt8Ty(context),     // width
+        llvm::Type::getInt32Ty(context),    // valueCount
+        llvm::Type::getInt64Ty(context)     // base
+    });
+}
+
+llvm::Value* createRunLengthSearch(FunctionBuilder& builder, llvm::Value* runEnds, llvm::Value* runCount,
+        llvm::Value* idx, const llvm::Twine& name) {
+    auto previousBlock = builder.GetInsertBlock();
+    auto searchBlock = builder.createBasicBlock(name + ".search");
+    auto foundBlock = builder.createBasicBlock(name + ".found");
+    builder.CreateBr(searchBlock);
+
+    // -> do { ... } while (low < high)
+    builder.SetInsertPoint(searchBlock);
+    auto low = builder.CreatePHI(builder.getInt64Ty(), 2);
+    low->addIncoming(builder.getInt64(0), previousBlock);
+    auto high = builder.CreatePHI(builder.getInt64Ty(), 2);
+    high->addIncoming(builder.CreateSub(runCount, builder.getInt64(1)), previousBlock);
+
+    // -> auto mid = (low + high) / 2;
+    // -> if (runEnds[mid] <= idx) low = mid + 1; else high = mid;
+    auto mid = builder.CreateLShr(builder.CreateAdd(low, high), builder.getInt64(1));
+    auto midEnd = builder.CreateAlignedLoad(builder.CreateInBoundsGEP(runEnds, mid), 4u);
+    auto before = builder.CreateICmp(llvm::CmpInst::ICMP_ULE, builder.CreateZExt(midEnd, builder.getInt64Ty()), idx);
+    auto lowNext = builder.CreateSelect(before, builder.CreateAdd(mid, builder.getInt64(1)), low);
+    auto highNext = builder.CreateSelect(before, high, mid);
+    low->addIncoming(lowNext, searchBlock);
+    high->addIncoming(highNext, searchBlock);
+    builder.CreateCondBr(builder.CreateICmp(llvm::CmpInst::ICMP_ULT, lowNext, highNext), searchBlock, foundBlock);
+
+    builder.SetInsertPoint(foundBlock);
+    return lowNext;
+}
+
+llvm::Value* createFixedColumnLoad(FunctionBuilder& builder, const ColumnMapContext& context, llvm::Value* mainPage,
+        llvm::Value* count, llvm::Value* fixedData, uint16_t column, llvm::Value* idx) {
+    auto& columnMeta = context.fixedMetaData()[column];
+    auto& field = context.record().getFieldMeta(column).field;
+    auto fieldTy = builder.getFieldTy(field.type());
+    auto fieldPtrTy = builder.getFieldPtrTy(field.type());
+    auto fieldAlignment = field.alignOf();
+
+    // -> auto columnData = fixedData + count * columnOffset;
+    auto columnData = fixedData;
+    if (columnMeta.offset != 0) {
+        columnData = builder.CreateInBoundsGEP(columnData, builder.createConstMul(count, columnMeta.offset));
+    }
+
+    // -> auto rawValue = reinterpret_cast<const T*>(columnData)[idx];
+    auto loadRaw = [&builder, fieldPtrTy, fieldAlignment, columnData, idx] () {
+        auto rawData = builder.CreateBitCast(columnData, fieldPtrTy);
+        return builder.CreateAlignedLoad(builder.CreateInBoundsGEP(rawData, idx), fieldAlignment);
+    };
+    if (column >= ColumnMapMainPage::MAX_ENCODED_COLUMNS) {
+        return loadRaw();
+    }
+
+    auto rawBlock = builder.createBasicBlock("fixed." + llvm::Twine(column) + ".raw");
+    auto encodedBlock = builder.createBasicBlock("fixed." + llvm::Twine(column) + ".encoded");
+    auto forBlock = builder.createBasicBlock("fixed." + llvm::Twine(column) + ".for");
+    auto dictBlock = builder.createBasicBlock("fixed." + llvm::Twine(column) + ".dict");
+    auto rleBlock = builder.createBasicBlock("fixed." + llvm::Twine(column) + ".rle");
+    auto endBlock = builder.createBasicBlock("fixed." + llvm::Twine(column) + ".end");
+
+    // -> if (mainPage->encodedColumns & (1 << column))
+    auto encodedColumns = builder.CreateInBoundsGEP(mainPage, { builder.getInt64(0), builder.getInt32(4) });
+    encodedColumns = builder.CreateAlignedLoad(encodedColumns, 8u);
+    auto isEncoded = builder.CreateAnd(encodedColumns, builder.getInt64(0x1ull << column));
+    builder.CreateCondBr(builder.CreateICmp(llvm::CmpInst::ICMP_NE, isEncoded, builder.getInt64(0)), encodedBlock,
+            rawBlock);
+
+    // Raw
+    builder.SetInsertPoint(rawBlock);
+    auto rawValue = loadRaw();
+    builder.CreateBr(endBlock);
+
+    // Encoded
+    // -> auto header = ColumnMapEncodedColumn::fromColumn(columnData);
+    builder.SetInsertPoint(encodedBlock);
+    auto headerData = builder.createPointerAlign(columnData, alignof(ColumnMapEncodedColumn));
+    auto header = builder.CreateBitCast(headerData,
+            getColumnMapEncodedColumnTy(builder.getContext())->getPointerTo());
+
+    // -> auto encodedData = header->data();
+    auto encodedData = builder.CreateInBoundsGEP(headerData, builder.getInt64(sizeof(ColumnMapEncodedColumn)));
+
+    // -> switch (header->encoding)
+    auto encoding = builder.CreateInBoundsGEP(header, { builder.getInt64(0), builder.getInt32(0) });
+    encoding = builder.CreateAlignedLoad(encoding, 8u);
+    auto encodingSwitch = builder.CreateSwitch(encoding, rleBlock, 2);
+    encodingSwitch->addCase(builder.getInt8(static_cast<uint8_t>(ColumnEncoding::FRAME_OF_REFERENCE)), forBlock);
+    encodingSwitch->addCase(builder.getInt8(static_cast<uint8_t>(ColumnEncoding::DICTIONARY)), dictBlock);
+
+    // Frame of reference (only integer columns)
+    // -> auto value = static_cast<T>(header->base + (*reinterpret_cast<const uint64_t*>(encodedData + idx * width)
+    // ->         & ((1 << (width * 8)) - 1)));
+    builder.SetInsertPoint(forBlock);
+    llvm::Value* forValue = nullptr;
+    if (field.type() == FieldType::SMALLINT || field.type() == FieldType::INT || field.type() == FieldType::BIGINT) {
+        auto width = builder.CreateInBoundsGEP(header, { builder.getInt64(0), builder.getInt32(1) });
+        width = builder.CreateZExt(builder.CreateAlignedLoad(width, 1u), builder.getInt64Ty());
+
+        auto base = builder.CreateInBoundsGEP(header, { builder.getInt64(0), builder.getInt32(3) });
+        base = builder.CreateAlignedLoad(base, 8u);
+
+        auto packedData = builder.CreateInBoundsGEP(encodedData, builder.CreateMul(idx, width));
+        packedData = builder.CreateBitCast(packedData, builder.getInt64PtrTy());
+        auto packed = builder.CreateAlignedLoad(packedData, 1u);
+
+        auto mask = builder.CreateShl(builder.getInt64(1), builder.CreateShl(width, builder.getInt64(3)));
+        mask = builder.CreateSub(mask, builder.getInt64(1));
+
+        forValue = builder.CreateAdd(builder.CreateAnd(packed, mask), base);
+        forValue = builder.CreateTruncOrBitCast(forValue, fieldTy);
+        builder.CreateBr(endBlock);
+    } else {
+        builder.CreateUnreachable();
+    }
+
+    // Dictionary
+    // -> auto value = reinterpret_cast<const T*>(encodedData + align(count, 8))[encodedData[idx]];
+    builder.SetInsertPoint(dictBlock);
+    llvm::Value* code = builder.CreateAlignedLoad(builder.CreateInBoundsGEP(encodedData, idx), 1u);
+    code = builder.CreateZExt(code, builder.getInt64Ty());
+
+    auto dictionaryOffset = builder.CreateAnd(builder.CreateAdd(count, builder.getInt64(7)), builder.getInt64(-8));
+    auto dictionaryData = builder.CreateInBoundsGEP(encodedData, dictionaryOffset);
+    dictionaryData = builder.CreateBitCast(dictionaryData, fieldPtrTy);
+    auto dictValue = builder.CreateAlignedLoad(builder.CreateInBoundsGEP(dictionaryData, code), fieldAlignment);
+    builder.CreateBr(endBlock);
+
+    // Run length
+    builder.SetInsertPoint(rleBlock);
+    auto runCount = builder.CreateInBoundsGEP(header, { builder.getInt64(0), builder.getInt32(2) });
+    runCount = builder.CreateZExt(builder.CreateAlignedLoad(runCount, 4u), builder.getInt64Ty());
+    auto runEnds = builder.CreateBitCast(encodedData, builder.getInt32PtrTy());
+    auto run = createRunLengthSearch(builder, runEnds, runCount, idx, "fixed." + llvm::Twine(column) + ".rle");
+
+    // -> auto value = reinterpret_cast<const T*>(encodedData + align(runCount * 4, 8))[run];
+    auto runValuesOffset = builder.CreateAnd(builder.CreateAdd(builder.CreateShl(runCount, builder.getInt64(2)),
+            builder.getInt64(7)), builder.getInt64(-8));
+    auto runValues = builder.CreateInBoundsGEP(encodedData, runValuesOffset);
+    runValues = builder.CreateBitCast(runValues, fieldPtrTy);
+    auto rleValue = builder.CreateAlignedLoad(builder.CreateInBoundsGEP(runValues, run), fieldAlignment);
+    auto rleFoundBlock = builder.GetInsertBlock();
+    builder.CreateBr(endBlock);
+
+    // End
+    builder.SetInsertPoint(endBlock);
+    auto value = builder.CreatePHI(fieldTy, 4);
+    value->addIncoming(rawValue, rawBlock);
+    if (forValue) {
+        value->addIncoming(forValue, forBlock);
+    }
+    value->addIncoming(dictValue, dictBlock);
+    value->addIncoming(rleValue, rleFoundBlock);
+    return value;
+}
+
 } // namespace deltamain
 } // namespace store
 } // namespace tell
@@ -23,17 +23,59 @@
 
 #pragma once
 
+#include <llvm/ADT/Twine.h>
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/LLVMContext.h>
 
+#include <cstdint>
+
 namespace tell {
 namespace store {
+
+class FunctionBuilder;
+
 namespace deltamain {
 
+class ColumnMapContext;
+
 llvm::StructType* getColumnMapMainPageTy(llvm::LLVMContext& context);
 
 llvm::StructType* getColumnMapHeapEntriesTy(llvm::LLVMContext& context);
 
+llvm::StructType* getColumnMapEncodedColumnTy(llvm::LLVMContext& context);
+
+/**
+ * @brief Create a binary search for the run of a run length encoded column containing the element
+ *
+ * Leaves the builder positioned in the block following the search.
+ *
+ * @param builder Builder of the function the search is created in
+ * @param runEnds Pointer to the array of indices past the last element of every run
+ * @param runCount Number of runs in the column
+ * @param idx Index of the element
+ * @param name Name of the search blocks
+ * @return Index of the run containing the element
+ */
+llvm::Value* createRunLengthSearch(FunctionBuilder& builder, llvm::Value* runEnds, llvm::Value* runCount,
+        llvm::Value* idx, const llvm::Twine& name);
+
+/**
+ * @brief Create a load of the value of a single element from a fixed size column of a column map page
+ *
+ * Decodes the value if the column is stored encoded in the page.
+ *
+ * @param builder Builder of the function the load is created in
+ * @param context The column map context of the table
+ * @param mainPage Pointer to the ColumnMapMainPage
+ * @param count Number of elements in the page
+ * @param fixedData Pointer to the fixed size section of the page
+ * @param column Index of the fixed size column
+ * @param idx Index of the element
+ * @return The value of the element
+ */
+llvm::Value* createFixedColumnLoad(FunctionBuilder& builder, const ColumnMapContext& context, llvm::Value* mainPage,
+        llvm::Value* count, llvm::Value* fixedData, uint16_t column, llvm::Value* idx);
+
 } // namespace deltamain
 } // namespace store
 } // namespace tell
@@ -40,6 +40,7 @@ public:
     using Scan = RowStoreScan;
     using Page = RowStoreMainPage;
     using PageModifier = RowStorePageModifier;
+    using ZoneMap = RowStoreZoneMap;
 
     using MainRecord = RowStoreRecord;
     using ConstMainRecord = ConstRowStoreRecord;
@@ -50,6 +51,10 @@ public:
 
     RowStoreContext(const PageManager& /* pageManager */, const Record& /* record */) {
     }
+
+    RowStoreZoneMap zoneMap(const RowStoreMainPage* /* page */) const {
+        return RowStoreZoneMap();
+    }
 };
 
 } // namespace deltamain
@@ -30,6 +30,9 @@
 
 #include <crossbow/logger.hpp>
 
+#include <algorithm>
+#include <limits>
+
 namespace tell {
 namespace store {
 namespace deltamain {
@@ -49,6 +52,15 @@ bool RowStoreMainPage::needsCleaning(uint64_t minVersion) const {
     return false;
 }
 
+std::pair<uint64_t, uint64_t> RowStoreMainPage::keyRange() const {
+    auto result = std::make_pair(std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::min());
+    for (auto& ptr : *this) {
+        result.first = std::min(result.first, ptr.key);
+        result.second = std::max(result.second, ptr.key);
+    }
+    return result;
+}
+
 RowStoreMainEntry* RowStoreMainPage::append(uint64_t key, const std::vector<RecordHolder>& elements) {
     static_assert(std::is_standard_layout<RowStoreMainEntry>::value, "Record class must be a POD");
 
@@ -127,6 +139,16 @@ bool RowStorePageModifier::append(InsertRecord& oldRecord) {
     return true;
 }
 
+void RowStorePageModifier::restore(RowStoreMainPage* page) {
+    for (auto& ptr : *page) {
+        ptr.newest.store(0x0u);
+
+        __attribute__((unused)) auto res = mMainTableModifier.insert(ptr.key, &ptr, false);
+        LOG_ASSERT(res, "Inserting key into hash table did not succeed");
+    }
+    mPageList.emplace_back(page);
+}
+
 template <typename Rec>
 bool RowStorePageModifier::collectElements(Rec& rec) {
     while (true) {
@@ -179,7 +201,7 @@ void RowStorePageModifier::recycleEntry(Rec& oldRecord, RowStoreMainEntry* newRe
 template <typename Fun>
 RowStoreMainEntry* RowStorePageModifier::internalAppend(Fun fun) {
     if (!mFillPage) {
-        auto page = mPageManager.alloc();
+        auto page = mPageManager.allocUninitialized();
         if (!page) {
             LOG_ERROR("PageManager ran out of space");
             std::terminate();
@@ -192,7 +214,7 @@ RowStoreMainEntry* RowStorePageModifier::internalAppend(Fun fun) {
         return newRecord;
     }
 
-    auto page = mPageManager.alloc();
+    auto page = mPageManager.allocUninitialized();
     if (!page) {
         LOG_ERROR("PageManager ran out of space");
         std::terminate();
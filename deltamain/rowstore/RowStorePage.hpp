@@ -31,6 +31,7 @@
 
 #include <cstdint>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace tell {
@@ -41,6 +42,14 @@ class PageManager;
 
 namespace deltamain {
 
+/**
+ * @brief Zone map of a row store page
+ *
+ * The row store does not maintain any statistics about its pages.
+ */
+struct RowStoreZoneMap {
+};
+
 class alignas(8) RowStoreMainPage {
 public:
     template <typename EntryType>
@@ -121,6 +130,13 @@ public:
 
     bool needsCleaning(uint64_t minVersion) const;
 
+    /**
+     * @brief The smallest and largest key stored in the page
+     *
+     * Returns an empty range (smallest key larger than the largest key) if the page contains no records.
+     */
+    std::pair<uint64_t, uint64_t> keyRange() const;
+
     RowStoreMainEntry* append(uint64_t key, const std::vector<RecordHolder>& elements);
 
     RowStoreMainEntry* append(const RowStoreMainEntry* record);
@@ -151,6 +167,14 @@ public:
 
     bool append(InsertRecord& oldRecord);
 
+    /**
+     * @brief Adds a page restored from a checkpoint to the main
+     *
+     * Clears the newest pointers of all records in the page (they refer to memory of the previous process) and inserts
+     * the records into the main hash table.
+     */
+    void restore(RowStoreMainPage* page);
+
     std::vector<RowStoreMainPage*> done() {
         return std::move(mPageList);
     }
@@ -33,39 +33,47 @@ namespace tell {
 namespace store {
 namespace deltamain {
 
-RowStoreScan::RowStoreScan(Table<RowStoreContext>* table, std::vector<ScanQuery*> queries)
-        : LLVMRowScanBase(table->record(), std::move(queries)),
+RowStoreScan::RowStoreScan(Table<RowStoreContext>* table, std::vector<ScanQuery*> queries, LLVMCodeCache& codeCache)
+        : LLVMRowScanBase(table->tableId(), table->record(), std::move(queries), codeCache),
           mTable(table) {
 }
 
 std::vector<std::unique_ptr<RowStoreScanProcessor>> RowStoreScan::startScan(size_t numThreads) {
-    return mTable->startScan(numThreads, mQueries, mRowScanFun, mRowMaterializeFuns, mScanAst.numConjunct);
+    return mTable->startScan(numThreads, mQueries, mRowScanFun, mRowMaterializeFuns, mNumConjunct);
 }
 
 RowStoreScanProcessor::RowStoreScanProcessor(const RowStoreContext& /* context */, const Record& record,
-        const std::vector<ScanQuery*>& queries, const PageList& pages, size_t pageIdx, size_t pageEndIdx,
-        const LogIterator& logIter, const LogIterator& logEnd, RowStoreScan::RowScanFun rowScanFun,
+        const std::vector<ScanQuery*>& queries, const PageList& pages, const ZoneMapList& /* zoneMaps */,
+        std::shared_ptr<MorselQueue> morsels, RowStoreScan::RowScanFun rowScanFun,
         const std::vector<RowStoreScan::RowMaterializeFun>& rowMaterializeFuns, uint32_t numConjuncts)
         : LLVMRowScanProcessorBase(record, queries, rowScanFun, rowMaterializeFuns, numConjuncts),
           pages(pages),
-          pageIdx(pageIdx),
-          pageEndIdx(pageEndIdx),
-          logIter(logIter),
-          logEnd(logEnd) {
+          morsels(std::move(morsels)) {
 }
 
-void RowStoreScanProcessor::process() {
-    for (auto i = pageIdx; i < pageEndIdx; ++i) {
+bool RowStoreScanProcessor::processNext() {
+    // Stop early when every query already received all the tuples it asked for
+    if (queriesDone()) {
+        return false;
+    }
+
+    auto morsel = morsels->next();
+    if (!morsel) {
+        return false;
+    }
+
+    for (auto i = morsel->pageIdx; i < morsel->pageEndIdx; ++i) {
         for (auto& ptr : *pages[i]) {
             processMainRecord(&ptr);
         }
     }
-    for (auto insIter = logIter; insIter != logEnd; ++insIter) {
+    for (auto insIter = morsel->logIter; insIter != morsel->logEnd; ++insIter) {
         if (!insIter->sealed()) {
             continue;
         }
         processInsertRecord(reinterpret_cast<const InsertLogEntry*>(insIter->data()));
     }
+    return true;
 }
 
 void RowStoreScanProcessor::processMainRecord(const RowStoreMainEntry* ptr) {
@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <deltamain/ScanMorsel.hpp>
+
 #include <util/LLVMScan.hpp>
 #include <util/Log.hpp>
 #include <util/ScanQuery.hpp>
@@ -30,6 +32,7 @@
 #include <crossbow/allocator.hpp>
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace tell {
@@ -43,6 +46,7 @@ struct InsertLogEntry;
 class RowStoreContext;
 struct RowStoreMainEntry;
 class RowStoreMainPage;
+struct RowStoreZoneMap;
 struct UpdateLogEntry;
 
 template <typename Context>
@@ -54,7 +58,7 @@ class RowStoreScan : public LLVMRowScanBase {
 public:
     using ScanProcessor = RowStoreScanProcessor;
 
-    RowStoreScan(Table<RowStoreContext>* table, std::vector<ScanQuery*> queries);
+    RowStoreScan(Table<RowStoreContext>* table, std::vector<ScanQuery*> queries, LLVMCodeCache& codeCache);
 
     using LLVMRowScanBase::prepareQuery;
 
@@ -70,13 +74,19 @@ class RowStoreScanProcessor : public LLVMRowScanProcessorBase {
 public:
     using LogIterator = Log<OrderedLogImpl>::ConstLogIterator;
     using PageList = std::vector<RowStoreMainPage*>;
+    using ZoneMapList = std::vector<RowStoreZoneMap>;
 
     RowStoreScanProcessor(const RowStoreContext& context, const Record& record, const std::vector<ScanQuery*>& queries,
-            const PageList& pages, size_t pageIdx, size_t pageEndIdx, const LogIterator& logIter,
-            const LogIterator& logEnd, RowStoreScan::RowScanFun rowScanFun,
+            const PageList& pages, const ZoneMapList& zoneMaps, std::shared_ptr<MorselQueue> morsels,
+            RowStoreScan::RowScanFun rowScanFun,
             const std::vector<RowStoreScan::RowMaterializeFun>& rowMaterializeFuns, uint32_t numConjuncts);
 
-    void process();
+    /**
+     * @brief Processes the next morsel from the shared morsel queue
+     *
+     * @return False if all morsels of the scan have been handed out and the processor has no more work
+     */
+    bool processNext();
 
 private:
     void processMainRecord(const RowStoreMainEntry* ptr);
@@ -86,10 +96,7 @@ private:
     uint64_t processUpdateRecord(const UpdateLogEntry* ptr, uint64_t baseVersion, uint64_t& validTo);
 
     const PageList& pages;
-    size_t pageIdx;
-    size_t pageEndIdx;
-    LogIterator logIter;
-    LogIterator logEnd;
+    std::shared_ptr<MorselQueue> morsels;
 };
 
 } // namespace deltamain
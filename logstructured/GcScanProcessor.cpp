@@ -28,6 +28,8 @@
 #include "Table.hpp"
 #include "VersionRecordIterator.hpp"
 
+#include <config.h>
+
 #include <crossbow/logger.hpp>
 
 #include <boost/config.hpp>
@@ -44,8 +46,8 @@ constexpr size_t gGcThreshold = 50;
 
 } // anonymous namespace
 
-GcScan::GcScan(Table* table, std::vector<ScanQuery*> queries)
-        : LLVMRowScanBase(table->record(), std::move(queries)),
+GcScan::GcScan(Table* table, std::vector<ScanQuery*> queries, LLVMCodeCache& codeCache)
+        : LLVMRowScanBase(table->tableId(), table->record(), std::move(queries), codeCache),
           mTable(table) {
 }
 
@@ -60,41 +62,42 @@ std::vector<std::unique_ptr<GcScanProcessor>> GcScan::startScan(size_t numThread
     auto version = mTable->minVersion();
     auto& log = mTable->mLog;
 
-    auto numPages = log.pages();
     auto begin = log.pageBegin();
     auto end = log.pageEnd();
 
-    auto mod = numPages % numThreads;
-    auto iter = begin;
-    for (decltype(numThreads) i = 1; i < numThreads; ++i) {
-        auto step = numPages / numThreads + (i < mod ? 1 : 0);
-        // Increment the page iterator by step pages (but not beyond the end page)
-        for (decltype(step) j = 0; j < step && iter != end; ++j, ++iter) {
+    // Every morsel only contains pages from a single NUMA node so it can be processed by a thread on that node
+    auto& pageManager = log.pageManager();
+    std::vector<std::vector<GcScanMorsel>> morsels(pageManager.numaNodes());
+    while (begin != end) {
+        // Increment the page iterator by the morsel size (but not beyond the end page or a page of another node)
+        auto node = pageManager.numaNode(begin.operator->());
+        auto iter = begin;
+        for (size_t j = 0; j < SCAN_MORSEL_SIZE && iter != end && pageManager.numaNode(iter.operator->()) == node;
+                ++j, ++iter) {
         }
-
-        result.emplace_back(new GcScanProcessor(*mTable, mQueries, begin, iter, version, mRowScanFun,
-                mRowMaterializeFuns, mScanAst.numConjunct));
+        morsels[node].emplace_back(begin, iter);
         begin = iter;
     }
 
-    // The last scan takes the remaining pages
-    result.emplace_back(new GcScanProcessor (*mTable, mQueries, begin, end, version, mRowScanFun, mRowMaterializeFuns,
-            mScanAst.numConjunct));
+    auto morselQueue = std::make_shared<GcScanProcessor::MorselQueue>(std::move(morsels));
+    for (decltype(numThreads) i = 0; i < numThreads; ++i) {
+        result.emplace_back(new GcScanProcessor(*mTable, mQueries, morselQueue, version, mRowScanFun,
+                mRowMaterializeFuns, mNumConjunct));
+    }
 
     return result;
 }
 
-GcScanProcessor::GcScanProcessor(Table& table, const std::vector<ScanQuery*>& queries, const PageIterator& begin,
-        const PageIterator& end, uint64_t minVersion, GcScan::RowScanFun rowScanFun,
+GcScanProcessor::GcScanProcessor(Table& table, const std::vector<ScanQuery*>& queries,
+        std::shared_ptr<MorselQueue> morsels, uint64_t minVersion, GcScan::RowScanFun rowScanFun,
         const std::vector<GcScan::RowMaterializeFun>& rowMaterializeFuns, uint32_t numConjuncts)
         : LLVMRowScanProcessorBase(table.record(), queries, rowScanFun, rowMaterializeFuns, numConjuncts),
           mTable(table),
+          mMorsels(std::move(morsels)),
           mMinVersion(minVersion),
-          mPagePrev(begin),
-          mPageIt(begin),
-          mPageEnd(end),
-          mEntryIt(mPageIt == mPageEnd ? LogPage::EntryIterator() : mPageIt->begin()),
-          mEntryEnd(mPageIt == mPageEnd ? LogPage::EntryIterator() : mPageIt->end()),
+          mPagePrev(nullptr),
+          mPageIt(nullptr),
+          mPageEnd(nullptr),
           mRecyclingHead(nullptr),
           mRecyclingTail(nullptr),
           mGarbage(0x0u),
@@ -102,11 +105,36 @@ GcScanProcessor::GcScanProcessor(Table& table, const std::vector<ScanQuery*>& qu
           mRecycle(false) {
 }
 
-void GcScanProcessor::process() {
-    // Abort if the processor already is at the end
+bool GcScanProcessor::processNext() {
+    if (auto morsel = mMorsels->next()) {
+        processMorsel(*morsel);
+        return true;
+    }
+
+    // Append recycled entries to the log
+    if (mRecyclingHead != nullptr) {
+        LOG_ASSERT(mRecyclingTail, "Recycling tail is null despite head being non null");
+        mTable.mLog.appendPage(mRecyclingHead, mRecyclingTail);
+        mRecyclingHead = nullptr;
+        mRecyclingTail = nullptr;
+    }
+    return false;
+}
+
+void GcScanProcessor::processMorsel(const GcScanMorsel& morsel) {
+    mPagePrev = morsel.begin;
+    mPageIt = morsel.begin;
+    mPageEnd = morsel.end;
+    mGarbage = 0x0u;
+    mSealed = false;
+    mRecycle = false;
+
+    // Abort if the morsel is empty
     if (mPageIt == mPageEnd) {
         return;
     }
+    mEntryIt = mPageIt->begin();
+    mEntryEnd = mPageIt->end();
 
     // Advance to the next page if the first page contains no entries
     if (mEntryIt == mEntryEnd && !advancePage()) {
@@ -170,12 +198,6 @@ void GcScanProcessor::process() {
         auto recordLength = mEntryIt->size() - sizeof(ChainedVersionRecord);
         processRowRecord(record->key(), record->validFrom(), context.validTo(), record->data(), recordLength);
     } while (advanceEntry());
-
-    // Append recycled entries to the log
-    if (mRecyclingHead != nullptr) {
-        LOG_ASSERT(mRecyclingTail, "Recycling tail is null despite head being non null");
-        mTable.mLog.appendPage(mRecyclingHead, mRecyclingTail);
-    }
 }
 
 bool GcScanProcessor::advanceEntry() {
@@ -25,12 +25,14 @@
 
 #include <util/LLVMScan.hpp>
 #include <util/Log.hpp>
+#include <util/ScanMorsel.hpp>
 #include <util/ScanQuery.hpp>
 
 #include <crossbow/allocator.hpp>
 #include <crossbow/non_copyable.hpp>
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace tell {
@@ -45,12 +47,30 @@ class GcScanGarbageCollector;
 class GcScanProcessor;
 class Table;
 
+/**
+ * @brief Unit of work of a GC scan covering a contiguous range of log pages
+ */
+struct GcScanMorsel {
+    using PageIterator = Log<UnorderedLogImpl>::PageIterator;
+
+    GcScanMorsel(const PageIterator& begin, const PageIterator& end)
+            : begin(begin),
+              end(end) {
+    }
+
+    /// Iterator pointing to the first page in the morsel
+    PageIterator begin;
+
+    /// Iterator pointing to the first page not contained in the morsel
+    PageIterator end;
+};
+
 class GcScan : public LLVMRowScanBase {
 public:
     using ScanProcessor = GcScanProcessor;
     using GarbageCollector = GcScanGarbageCollector;
 
-    GcScan(Table* table, std::vector<ScanQuery*> queries);
+    GcScan(Table* table, std::vector<ScanQuery*> queries, LLVMCodeCache& codeCache);
 
     using LLVMRowScanBase::prepareQuery;
 
@@ -59,6 +79,8 @@ public:
     /**
      * @brief Start a full scan of this table
      *
+     * The log is split into morsels of SCAN_MORSEL_SIZE pages each that are distributed to the processors on demand.
+     *
      * @param numThreads Number of threads to use for the scan
      * @return A scan processor for each thread
      */
@@ -75,21 +97,32 @@ class GcScanProcessor : public LLVMRowScanProcessorBase {
 public:
     using LogImpl = Log<UnorderedLogImpl>;
     using PageIterator = LogImpl::PageIterator;
+    using MorselQueue = ScanMorselQueue<GcScanMorsel>;
 
-    GcScanProcessor(Table& table, const std::vector<ScanQuery*>& queries, const PageIterator& begin,
-            const PageIterator& end, uint64_t minVersion, GcScan::RowScanFun rowScanFun,
+    GcScanProcessor(Table& table, const std::vector<ScanQuery*>& queries, std::shared_ptr<MorselQueue> morsels,
+            uint64_t minVersion, GcScan::RowScanFun rowScanFun,
             const std::vector<GcScan::RowMaterializeFun>& rowMaterializeFuns, uint32_t numConjuncts);
 
     /**
-     * @brief Scans over all entries in the log
+     * @brief Scans over all entries in the next morsel from the shared morsel queue
      *
      * Processes all valid entries with the associated scan queries.
      *
-     * Performs garbage collection while scanning over a page.
+     * Performs garbage collection while scanning over a page. The recycled entries are appended to the log as soon as
+     * all morsels of the scan have been handed out.
+     *
+     * @return False if all morsels of the scan have been handed out and the processor has no more work
      */
-    void process();
+    bool processNext();
 
 private:
+    /**
+     * @brief Scans over all entries in the given morsel
+     *
+     * The first page of every morsel is never recycled as it serves as anchor for erasing the succeeding pages.
+     */
+    void processMorsel(const GcScanMorsel& morsel);
+
     /**
      * @brief Advance the entry iterator to the next entry, advancing to the next page if necessary
      *
@@ -131,6 +164,7 @@ private:
     bool replaceElement(ChainedVersionRecord* oldElement, ChainedVersionRecord* newElement);
 
     Table& mTable;
+    std::shared_ptr<MorselQueue> mMorsels;
     uint64_t mMinVersion;
 
     LogImpl::PageIterator mPagePrev;
@@ -150,7 +184,7 @@ private:
     bool mSealed;
 
     /// Whether the current page is being recycled
-    /// Initialized to false to prevent the first page from being garbage collected
+    /// Reset to false for every morsel to prevent the first page from being garbage collected
     bool mRecycle;
 };
 
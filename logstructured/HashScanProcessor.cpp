@@ -32,12 +32,22 @@
 
 #include <boost/config.hpp>
 
+#include <algorithm>
+
 namespace tell {
 namespace store {
 namespace logstructured {
+namespace {
+
+/**
+ * @brief Number of hash table buckets processed in one unit of work
+ */
+constexpr size_t gBucketsPerMorsel = 0x10000u;
 
-HashScan::HashScan(Table* table, std::vector<ScanQuery*> queries)
-        : LLVMRowScanBase(table->record(), std::move(queries)),
+} // anonymous namespace
+
+HashScan::HashScan(Table* table, std::vector<ScanQuery*> queries, LLVMCodeCache& codeCache)
+        : LLVMRowScanBase(table->tableId(), table->record(), std::move(queries), codeCache),
           mTable(table) {
 }
 
@@ -50,33 +60,49 @@ std::vector<std::unique_ptr<HashScanProcessor>> HashScan::startScan(size_t numTh
     result.reserve(numThreads);
 
     auto version = mTable->minVersion();
-    auto capacity = mTable->mHashMap.capacity();
 
-    auto step = capacity / numThreads;
-    auto mod = capacity % numThreads;
-    for (decltype(numThreads) i = 0; i < numThreads; ++i) {
-        auto start = i * step + std::min(i, mod);
-        auto end = start + step + (i < mod ? 1 : 0);
+    // The morsels refer to the buckets of the view so the scan is not affected by concurrent resizes of the hash table
+    auto view = mTable->mHashMap.view();
+    auto capacity = view.capacity();
+
+    std::vector<HashScanMorsel> morsels;
+    morsels.reserve(capacity / gBucketsPerMorsel + 1);
+    for (decltype(capacity) start = 0; start < capacity; start += gBucketsPerMorsel) {
+        morsels.emplace_back(start, std::min(start + gBucketsPerMorsel, capacity));
+    }
 
-        result.emplace_back(new HashScanProcessor(*mTable, mQueries, start, end, version, mRowScanFun,
-                mRowMaterializeFuns, mScanAst.numConjunct));
+    auto morselQueue = std::make_shared<HashScanProcessor::MorselQueue>(std::move(morsels));
+    for (decltype(numThreads) i = 0; i < numThreads; ++i) {
+        result.emplace_back(new HashScanProcessor(*mTable, mQueries, view, morselQueue, version, mRowScanFun,
+                mRowMaterializeFuns, mNumConjunct));
     }
 
     return result;
 }
 
-HashScanProcessor::HashScanProcessor(Table& table, const std::vector<ScanQuery*>& queries, size_t start, size_t end,
-        uint64_t minVersion, HashScan::RowScanFun rowScanFun,
-        const std::vector<HashScan::RowMaterializeFun>& rowMaterializeFuns, uint32_t numConjuncts)
+HashScanProcessor::HashScanProcessor(Table& table, const std::vector<ScanQuery*>& queries,
+        OpenAddressingTable::View view, std::shared_ptr<MorselQueue> morsels, uint64_t minVersion,
+        HashScan::RowScanFun rowScanFun, const std::vector<HashScan::RowMaterializeFun>& rowMaterializeFuns,
+        uint32_t numConjuncts)
         : LLVMRowScanProcessorBase(table.record(), queries, rowScanFun, rowMaterializeFuns, numConjuncts),
           mTable(table),
-          mMinVersion(minVersion),
-          mStart(start),
-          mEnd(end) {
+          mView(view),
+          mMorsels(std::move(morsels)),
+          mMinVersion(minVersion) {
 }
 
-void HashScanProcessor::process() {
-    mTable.mHashMap.forEach(mStart, mEnd, [this] (uint64_t tableId, uint64_t key, void* ptr) {
+bool HashScanProcessor::processNext() {
+    // Stop early when every query already received all the tuples it asked for
+    if (queriesDone()) {
+        return false;
+    }
+
+    auto morsel = mMorsels->next();
+    if (!morsel) {
+        return false;
+    }
+
+    mTable.mHashMap.forEach(mView, morsel->start, morsel->end, [this] (uint64_t tableId, uint64_t key, void* ptr) {
         if (tableId != mTable.tableId()) {
             return;
         }
@@ -115,6 +141,7 @@ void HashScanProcessor::process() {
             }
         }
     });
+    return true;
 }
 
 void HashScanGarbageCollector::run(const std::vector<Table*>& /* tables */, uint64_t /* minVersion */) {
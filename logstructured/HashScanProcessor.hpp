@@ -24,12 +24,15 @@
 #pragma once
 
 #include <util/LLVMScan.hpp>
+#include <util/OpenAddressingHash.hpp>
+#include <util/ScanMorsel.hpp>
 #include <util/ScanQuery.hpp>
 
 #include <crossbow/allocator.hpp>
 #include <crossbow/non_copyable.hpp>
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace tell {
@@ -43,12 +46,28 @@ class HashScanGarbageCollector;
 class HashScanProcessor;
 class Table;
 
+/**
+ * @brief Unit of work of a hash scan covering a range of buckets in the hash table
+ */
+struct HashScanMorsel {
+    HashScanMorsel(size_t start, size_t end)
+            : start(start),
+              end(end) {
+    }
+
+    /// Index of the first bucket in the morsel
+    size_t start;
+
+    /// Index of the bucket succeeding the last bucket in the morsel
+    size_t end;
+};
+
 class HashScan : public LLVMRowScanBase {
 public:
     using ScanProcessor = HashScanProcessor;
     using GarbageCollector = HashScanGarbageCollector;
 
-    HashScan(Table* table, std::vector<ScanQuery*> queries);
+    HashScan(Table* table, std::vector<ScanQuery*> queries, LLVMCodeCache& codeCache);
 
     using LLVMRowScanBase::prepareQuery;
 
@@ -65,23 +84,29 @@ private:
  */
 class HashScanProcessor : public LLVMRowScanProcessorBase {
 public:
-    HashScanProcessor(Table& table, const std::vector<ScanQuery*>& queries, size_t start, size_t end,
-            uint64_t minVersion, HashScan::RowScanFun rowScanFun,
+    using MorselQueue = ScanMorselQueue<HashScanMorsel>;
+
+    HashScanProcessor(Table& table, const std::vector<ScanQuery*>& queries, OpenAddressingTable::View view,
+            std::shared_ptr<MorselQueue> morsels, uint64_t minVersion, HashScan::RowScanFun rowScanFun,
             const std::vector<HashScan::RowMaterializeFun>& rowMaterializeFuns, uint32_t numConjuncts);
 
     /**
-     * @brief Scans over all entries in the hash table
+     * @brief Scans over all entries in the next bucket range from the shared morsel queue
      *
      * Processes all valid entries with the associated scan queries.
+     *
+     * @return False if all morsels of the scan have been handed out and the processor has no more work
      */
-    void process();
+    bool processNext();
 
 private:
     Table& mTable;
-    uint64_t mMinVersion;
 
-    size_t mStart;
-    size_t mEnd;
+    /// View on the hash table the bucket ranges of the morsels refer to
+    OpenAddressingTable::View mView;
+
+    std::shared_ptr<MorselQueue> mMorsels;
+    uint64_t mMinVersion;
 };
 
 /**
@@ -30,10 +30,14 @@
 #include <util/TableManager.hpp>
 #include <util/VersionManager.hpp>
 
+#include <crossbow/allocator.hpp>
+#include <crossbow/logger.hpp>
 #include <crossbow/non_copyable.hpp>
 #include <crossbow/string.hpp>
 
 #include <cstdint>
+#include <memory>
+#include <string>
 
 namespace tell {
 namespace commitmanager {
@@ -57,14 +61,27 @@ public:
     }
 
     LogstructuredMemoryStore(const StorageConfig& config)
-            : mPageManager(PageManager::construct(config.totalMemory)),
+            : mPageManager(PageManager::construct(config.totalMemory, config.hugePages)),
               mGc(*this),
               mTableManager(*mPageManager, config, mGc, mVersionManager),
-              mHashMap(config.hashMapCapacity) {
+              mHashMap(config.hashMapPerTable ? nullptr : new Table::HashTable(config.hashMapCapacity)),
+              mHashMapCapacity(config.hashMapCapacity) {
+        mTableManager.openRedoLog(mVersionManager, mHashMap.get(), mHashMapCapacity);
+    }
+
+    ~LogstructuredMemoryStore() {
+        if (mHashMap) {
+            logHashMapStatistics("shared", *mHashMap);
+        }
+        for (auto table : mTableManager.getTables()) {
+            if (table->ownsHashMap()) {
+                logHashMapStatistics(table->tableName(), table->hashMap());
+            }
+        }
     }
 
     bool createTable(const crossbow::string& name, const Schema& schema, uint64_t& idx) {
-        return mTableManager.createTable(name, schema, idx, mVersionManager, mHashMap);
+        return mTableManager.createTable(name, schema, idx, mVersionManager, mHashMap.get(), mHashMapCapacity);
     }
 
     std::vector<const Table*> getTables() const {
@@ -84,6 +101,12 @@ public:
         return mTableManager.get(tableId, key, snapshot, std::move(fun));
     }
 
+    template <typename Fun, typename ErrorFun>
+    int multiGet(uint64_t tableId, const uint64_t* keys, size_t count,
+            const commitmanager::SnapshotDescriptor& snapshot, Fun fun, ErrorFun errorFun) {
+        return mTableManager.multiGet(tableId, keys, count, snapshot, std::move(fun), std::move(errorFun));
+    }
+
     int update(uint64_t tableId, uint64_t key, size_t size, const char* data,
             const commitmanager::SnapshotDescriptor& snapshot) {
         return mTableManager.update(tableId, key, size, data, snapshot);
@@ -102,6 +125,21 @@ public:
         return mTableManager.revert(tableId, key, snapshot);
     }
 
+    void batchWrite(const WriteOperation* operations, size_t count, const commitmanager::SnapshotDescriptor& snapshot,
+            int* results) {
+        mTableManager.batchWrite(operations, count, snapshot, results);
+    }
+
+    void syncRedoLog() {
+        mTableManager.syncRedoLog();
+    }
+
+    template <typename Fun>
+    int indexScan(uint64_t tableId, const crossbow::string& indexName, const std::string& lower,
+            const std::string& upper, const commitmanager::SnapshotDescriptor& snapshot, Fun fun) {
+        return mTableManager.indexScan(tableId, indexName, lower, upper, snapshot, std::move(fun));
+    }
+
     int scan(uint64_t tableId, ScanQuery* query) {
         return mTableManager.scan(tableId, query);
     }
@@ -115,13 +153,41 @@ public:
         mTableManager.forceGC();
     }
 
+    /**
+     * @brief Runs a garbage collection pass and blocks until it finished
+     */
+    void runGC() {
+        mTableManager.runGC();
+    }
+
+    /**
+     * @brief The version manager tracking the lowest active version of the storage
+     */
+    const VersionManager& versionManager() const {
+        return mVersionManager;
+    }
+
+    VersionManager& versionManager() {
+        return mVersionManager;
+    }
+
 private:
+    static void logHashMapStatistics(const crossbow::string& name, const Table::HashTable& hashMap) {
+        crossbow::allocator _;
+        auto statistics = hashMap.statistics();
+        LOG_INFO("Hash table statistics of %1% [capacity = %2%, size = %3%, load factor = %4%, average probe length = "
+                "%5%, max probe length = %6%]", name, statistics.capacity, statistics.size, statistics.loadFactor,
+                statistics.averageProbeLength, statistics.maxProbeLength);
+    }
+
     PageManager::Ptr mPageManager;
     GC mGc;
     VersionManager mVersionManager;
     TableManager<Table, GC> mTableManager;
 
-    Table::HashTable mHashMap;
+    /// Hash table shared by all tables or null if every table maintains its own hash table
+    std::unique_ptr<Table::HashTable> mHashMap;
+    size_t mHashMapCapacity;
 };
 
 } // namespace store
@@ -29,6 +29,8 @@
 
 #include <boost/config.hpp>
 
+#include <vector>
+
 namespace tell {
 namespace store {
 namespace logstructured {
@@ -39,17 +41,21 @@ namespace logstructured {
  * Implements the RAII pattern for writing a log record, ensures that the object is either successfully written and
  * sealed (by calling LazyRecordWriter::seal()) or the log record is invalidated and sealed when the writer object goes
  * out of scope.
+ *
+ * The record is either appended to the log or written to a log entry reserved in advance by a batch write. A reserved
+ * entry is always sealed, if the record was never needed it is written and invalidated right away.
  */
 class LazyRecordWriter {
 public:
     LazyRecordWriter(Table& table, uint64_t key, const char* data, uint32_t size, VersionRecordType type,
-            uint64_t version)
+            uint64_t version, LogEntry* reserved = nullptr)
             : mTable(table),
               mKey(key),
               mData(data),
               mSize(size),
               mType(type),
               mVersion(version),
+              mReserved(reserved),
               mRecord(nullptr) {
     }
 
@@ -74,10 +80,14 @@ private:
     uint32_t mSize;
     VersionRecordType mType;
     uint64_t mVersion;
+    LogEntry* mReserved;
     ChainedVersionRecord* mRecord;
 };
 
 LazyRecordWriter::~LazyRecordWriter() {
+    if (mReserved) {
+        record();
+    }
     if (!mRecord) {
         return;
     }
@@ -92,10 +102,15 @@ ChainedVersionRecord* LazyRecordWriter::record() {
         return mRecord;
     }
 
-    auto entry = mTable.mLog.append(mSize + sizeof(ChainedVersionRecord), crossbow::to_underlying(mType));
-    if (!entry) {
-        LOG_FATAL("Failed to append to log");
-        return nullptr;
+    auto entry = mReserved;
+    if (entry) {
+        mReserved = nullptr;
+    } else {
+        entry = mTable.mLog.append(mSize + sizeof(ChainedVersionRecord), crossbow::to_underlying(mType));
+        if (!entry) {
+            LOG_ERROR("Failed to append to log");
+            return nullptr;
+        }
     }
 
     // Write entry to log
@@ -116,17 +131,31 @@ void LazyRecordWriter::seal() {
 }
 
 Table::Table(PageManager& pageManager, const crossbow::string& tableName, const Schema& schema, uint64_t tableId,
-        VersionManager& versionManager, HashTable& hashMap)
+        VersionManager& versionManager, HashTable* hashMap, size_t hashMapCapacity)
         : mVersionManager(versionManager),
-          mHashMap(hashMap),
+          mOwnedHashMap(hashMap ? nullptr : new HashTable(hashMapCapacity)),
+          mHashMap(hashMap ? *hashMap : *mOwnedHashMap),
           mTableName(tableName),
           mRecord(schema),
           mTableId(tableId),
+          mIndexes(mRecord),
           mLog(pageManager) {
 }
 
+void Table::prefetchRecord(uint64_t key) const {
+    if (auto ptr = mHashMap.get(mTableId, key)) {
+        __builtin_prefetch(LogEntry::entryFromData(reinterpret_cast<const char*>(ptr)));
+        __builtin_prefetch(ptr);
+    }
+}
+
 int Table::insert(uint64_t key, size_t size, const char* data, const commitmanager::SnapshotDescriptor& snapshot) {
-    LazyRecordWriter recordWriter(*this, key, data, size, VersionRecordType::DATA, snapshot.version());
+    return internalInsert(key, size, data, snapshot, nullptr);
+}
+
+int Table::internalInsert(uint64_t key, size_t size, const char* data,
+        const commitmanager::SnapshotDescriptor& snapshot, LogEntry* reserved) {
+    LazyRecordWriter recordWriter(*this, key, data, size, VersionRecordType::DATA, snapshot.version(), reserved);
     VersionRecordIterator recIter(*this, key);
     LOG_ASSERT(mRecord.schema().type() == TableType::NON_TRANSACTIONAL || snapshot.version() >= minVersion(),
             "Version of the snapshot already committed");
@@ -232,10 +261,55 @@ uint64_t Table::minVersion() const {
     }
 }
 
+void Table::batchWrite(const WriteOperation* operations, size_t count,
+        const commitmanager::SnapshotDescriptor& snapshot, int* results) {
+    // Reserve the records of all inserts, updates and removes with a single append
+    std::vector<uint32_t> sizes;
+    std::vector<uint32_t> types;
+    sizes.reserve(count);
+    types.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto& op = operations[i];
+        if (op.type == WriteType::INSERT || op.type == WriteType::UPDATE || op.type == WriteType::REMOVE) {
+            auto type = (op.type == WriteType::REMOVE ? VersionRecordType::DELETION : VersionRecordType::DATA);
+            sizes.emplace_back(op.size + sizeof(ChainedVersionRecord));
+            types.emplace_back(crossbow::to_underlying(type));
+        }
+    }
+
+    // Records that could not be reserved are appended by their modification
+    std::vector<LogEntry*> entries(sizes.size(), nullptr);
+    if (!sizes.empty()) {
+        mLog.append(sizes.data(), types.data(), sizes.size(), entries.data());
+    }
+
+    auto entry = entries.begin();
+    for (size_t i = 0; i < count; ++i) {
+        auto& op = operations[i];
+        switch (op.type) {
+        case WriteType::INSERT: {
+            results[i] = internalInsert(op.key, op.size, op.data, snapshot, *(entry++));
+        } break;
+        case WriteType::UPDATE: {
+            results[i] = internalUpdate(op.key, op.size, op.data, snapshot, false, *(entry++));
+        } break;
+        case WriteType::REMOVE: {
+            results[i] = internalUpdate(op.key, 0, nullptr, snapshot, true, *(entry++));
+        } break;
+        case WriteType::REVERT: {
+            results[i] = revert(op.key, snapshot);
+        } break;
+        default: {
+            results[i] = error::unkown_request;
+        } break;
+        }
+    }
+}
+
 int Table::internalUpdate(uint64_t key, size_t size, const char* data,
-        const commitmanager::SnapshotDescriptor& snapshot, bool deletion) {
+        const commitmanager::SnapshotDescriptor& snapshot, bool deletion, LogEntry* reserved) {
     auto type = (deletion ? VersionRecordType::DELETION : VersionRecordType::DATA);
-    LazyRecordWriter recordWriter(*this, key, data, size, type, snapshot.version());
+    LazyRecordWriter recordWriter(*this, key, data, size, type, snapshot.version(), reserved);
     VersionRecordIterator recIter(*this, key);
     LOG_ASSERT(mRecord.schema().type() == TableType::NON_TRANSACTIONAL || snapshot.version() >= minVersion(),
             "Version of the snapshot already committed");
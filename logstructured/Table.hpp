@@ -37,6 +37,8 @@
 
 #include <util/Log.hpp>
 #include <util/OpenAddressingHash.hpp>
+#include <util/SecondaryIndex.hpp>
+#include <util/WriteOperation.hpp>
 
 #include <tellstore/ErrorCode.hpp>
 #include <tellstore/Record.hpp>
@@ -47,6 +49,7 @@
 #include <crossbow/non_copyable.hpp>
 
 #include <cstdint>
+#include <memory>
 
 namespace tell {
 namespace store {
@@ -79,8 +82,12 @@ public:
     using ScanProcessor = Scan::ScanProcessor;
     using GarbageCollector = Scan::GarbageCollector;
 
+    /**
+     * @param hashMap The hash table shared by all tables or null if the table maintains its own hash table
+     * @param hashMapCapacity The initial capacity of the table's own hash table
+     */
     Table(PageManager& pageManager, const crossbow::string& tableName, const Schema& schema, uint64_t tableId,
-            VersionManager& versionManager, HashTable& hashMap);
+            VersionManager& versionManager, HashTable* hashMap, size_t hashMapCapacity);
 
     const crossbow::string& tableName() const {
         return mTableName;
@@ -98,6 +105,28 @@ public:
         return mTableId;
     }
 
+    const HashTable& hashMap() const {
+        return mHashMap;
+    }
+
+    /**
+     * @brief Whether the table maintains its own hash table instead of sharing it with the other tables
+     */
+    bool ownsHashMap() const {
+        return static_cast<bool>(mOwnedHashMap);
+    }
+
+    /**
+     * @brief The secondary indexes declared in the schema of the table
+     */
+    SecondaryIndexes& indexes() {
+        return mIndexes;
+    }
+
+    const SecondaryIndexes& indexes() const {
+        return mIndexes;
+    }
+
     /**
      * @brief Reads a tuple from the table
      *
@@ -110,6 +139,18 @@ public:
     template <typename Fun>
     int get(uint64_t key, const commitmanager::SnapshotDescriptor& snapshot, Fun fun);
 
+    /**
+     * @brief Issues a prefetch for the hash table bucket of the key
+     */
+    void prefetch(uint64_t key) const {
+        mHashMap.prefetch(mTableId, key);
+    }
+
+    /**
+     * @brief Looks up the key in the (already prefetched) hash table and issues a prefetch for its newest record
+     */
+    void prefetchRecord(uint64_t key) const;
+
     /**
      * @brief Inserts a tuple into the table
      *
@@ -152,6 +193,20 @@ public:
      */
     int revert(uint64_t key, const commitmanager::SnapshotDescriptor& snapshot);
 
+    /**
+     * @brief Executes the modifications of a batch on the table
+     *
+     * The log space of all inserts, updates and removes in the batch is reserved with a single append to the log. A
+     * reserved record not needed by its modification is invalidated like any other unused record.
+     *
+     * @param operations The modifications to execute (all on this table)
+     * @param count Number of modifications in the batch
+     * @param snapshot Descriptor containing the version to write
+     * @param results Array receiving the error code (or 0 on success) of every modification
+     */
+    void batchWrite(const WriteOperation* operations, size_t count, const commitmanager::SnapshotDescriptor& snapshot,
+            int* results);
+
 private:
     friend class GcScan;
     friend class GcScanProcessor;
@@ -173,17 +228,28 @@ private:
      * @param data Pointer to the data to write
      * @param snapshot Descriptor containing the version to write
      * @param deleted Whether the entry marks a deletion
+     * @param reserved Log entry reserved for the record by a batch write (null to append the record to the log)
      * @return Whether the entry was successfully written
      */
     int internalUpdate(uint64_t key, size_t size, const char* data, const commitmanager::SnapshotDescriptor& snapshot,
-            bool deletion);
+            bool deletion, LogEntry* reserved = nullptr);
+
+    /**
+     * @brief Helper function to insert a tuple
+     *
+     * @param reserved Log entry reserved for the record by a batch write (null to append the record to the log)
+     */
+    int internalInsert(uint64_t key, size_t size, const char* data, const commitmanager::SnapshotDescriptor& snapshot,
+            LogEntry* reserved);
 
     VersionManager& mVersionManager;
+    std::unique_ptr<HashTable> mOwnedHashMap;
     HashTable& mHashMap;
 
     crossbow::string mTableName;
     Record mRecord;
     const uint64_t mTableId;
+    SecondaryIndexes mIndexes;
 
     LogImpl mLog;
 };
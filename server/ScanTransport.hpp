@@ -0,0 +1,88 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#pragma once
+
+#include <crossbow/infinio/InfinibandBuffer.hpp>
+#include <crossbow/infinio/InfinibandSocket.hpp>
+#include <crossbow/non_copyable.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+
+namespace tell {
+namespace store {
+
+class ScanBufferManager;
+
+/**
+ * @brief Interface of the transport writing the scan buffers into the scan memory of a client
+ *
+ * Every ServerSocket owns one transport. Writes are issued concurrently by the scan threads, their completion is
+ * reported to the ServerSocket from within the socket's processing thread.
+ *
+ * The transport only carries the scan data, requests, responses and the scan progress messages are exchanged over the
+ * RPC connection of the socket. The only implementation writes the data with RDMA.
+ */
+class ScanTransport : crossbow::non_copyable, crossbow::non_movable {
+public:
+    virtual ~ScanTransport() = default;
+
+    /**
+     * @brief Writes the data into the destination region at the given offset
+     *
+     * The data must point into a buffer acquired from the ScanBufferManager, the buffer is released as soon as the
+     * write completed. A write without data only signals the completion with the given user ID.
+     *
+     * @param data Pointer to the data to write (or null)
+     * @param length Length of the data to write
+     * @param destRegion Scan memory region of the client
+     * @param offset Offset into the destination region to write the data to
+     * @param userId User ID passed on to the completion of the write
+     * @param ec Error in case the write fails (the buffer is not released)
+     */
+    virtual void write(const char* data, uint32_t length, crossbow::infinio::RemoteMemoryRegion& destRegion,
+            size_t offset, uint32_t userId, std::error_code& ec) = 0;
+};
+
+/**
+ * @brief Transport writing the scan buffers with RDMA writes directly into the scan memory of the client
+ */
+class InfinibandScanTransport final : public ScanTransport {
+public:
+    InfinibandScanTransport(crossbow::infinio::InfinibandSocket socket, ScanBufferManager& scanBufferManager)
+            : mSocket(std::move(socket)),
+              mScanBufferManager(scanBufferManager) {
+    }
+
+    virtual void write(const char* data, uint32_t length, crossbow::infinio::RemoteMemoryRegion& destRegion,
+            size_t offset, uint32_t userId, std::error_code& ec) final override;
+
+private:
+    crossbow::infinio::InfinibandSocket mSocket;
+
+    ScanBufferManager& mScanBufferManager;
+};
+
+} // namespace store
+} // namespace tell
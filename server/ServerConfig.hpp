@@ -50,6 +50,9 @@ struct ServerConfig {
 
     /// Maximum number of messages per batch
     size_t maxBatchSize = 16;
+
+    /// Number of slots in the snapshot cache shared by all connections
+    size_t snapshotCacheCapacity = 0x1000;
 };
 
 } // namespace store
@@ -60,18 +60,23 @@ void ScanBufferManager::releaseBuffer(uint16_t id) {
     while (!mBufferStack.push(id));
 }
 
+uint16_t ScanBufferManager::bufferId(const char* data) const {
+    auto offset = reinterpret_cast<size_t>(data - mRegion.address());
+    return static_cast<uint16_t>(offset / static_cast<size_t>(mScanBufferLength));
+}
+
 crossbow::infinio::InfinibandBuffer ScanBufferManager::getBuffer(const char* data, uint32_t length) {
     auto offset = reinterpret_cast<size_t>(data - mRegion.address());
-    auto id = static_cast<uint16_t>(offset / static_cast<size_t>(mScanBufferLength));
-    return mRegion.acquireBuffer(id, offset, length);
+    return mRegion.acquireBuffer(bufferId(data), offset, length);
 }
 
 ServerScanQuery::ServerScanQuery(uint16_t scanId, ScanQueryType queryType, std::unique_ptr<char[]> selectionData,
-        size_t selectionLength, std::unique_ptr<char[]> queryData, size_t queryLength,
+        size_t selectionLength, std::unique_ptr<char[]> queryData, size_t queryLength, uint64_t lowKey,
+        uint64_t highKey, uint64_t limit, ScanOrder order, Record::id_t orderField,
         std::unique_ptr<commitmanager::SnapshotDescriptor> snapshot, const Record& record,
         ScanBufferManager& scanBufferManager, crossbow::infinio::RemoteMemoryRegion destRegion, ServerSocket& socket)
-        : ScanQuery(queryType, std::move(selectionData), selectionLength, std::move(queryData), queryLength,
-                std::move(snapshot), record),
+        : ScanQuery(queryType, std::move(selectionData), selectionLength, std::move(queryData), queryLength, lowKey,
+                highKey, limit, order, orderField, std::move(snapshot), record),
           mActive(0u),
           mScanId(scanId),
           mProgressRequest(true),
@@ -117,10 +122,9 @@ void ServerScanQuery::writeLast(const char* start, const char* end, std::error_c
 
     if (ec == crossbow::infinio::error::out_of_range && mActive == 0) {
         auto userId = (static_cast<uint32_t>(mScanId) << 16) | static_cast<uint32_t>(ScanStatusIndicator::DONE);
-        crossbow::infinio::ScatterGatherBuffer buffer(crossbow::infinio::InfinibandBuffer::INVALID_ID);
 
         std::error_code ec2;
-        mSocket.writeScanBuffer(buffer, mDestRegion, mOffset, userId, ec2);
+        mSocket.writeScanBuffer(nullptr, 0u, mDestRegion, mOffset, userId, ec2);
     }
 }
 
@@ -130,9 +134,8 @@ void ServerScanQuery::writeLast(std::error_code& ec) {
     --mActive;
     if (mActive == 0) {
         auto userId = (static_cast<uint32_t>(mScanId) << 16) | static_cast<uint32_t>(ScanStatusIndicator::DONE);
-        crossbow::infinio::ScatterGatherBuffer buffer(crossbow::infinio::InfinibandBuffer::INVALID_ID);
 
-        mSocket.writeScanBuffer(buffer, mDestRegion, mOffset, userId, ec);
+        mSocket.writeScanBuffer(nullptr, 0u, mDestRegion, mOffset, userId, ec);
     }
 }
 
@@ -142,6 +145,10 @@ ScanQueryProcessor ServerScanQuery::createProcessor() {
     ScanQueryProcessor processor(this);
     if (queryType() == ScanQueryType::AGGREGATION) {
         processor.initAggregationRecord();
+    } else if (queryType() == ScanQueryType::GROUP_BY) {
+        processor.initGroupAggregation();
+    } else if (order() != ScanOrder::NONE) {
+        processor.initOrderedLimit();
     }
     return processor;
 }
@@ -152,11 +159,10 @@ void ServerScanQuery::doWrite(const char* start, const char* end, ScanStatusIndi
     auto userId = (static_cast<uint32_t>(mScanId) << 16) | static_cast<uint32_t>(status);
 
     auto length = static_cast<uint32_t>(end - start);
-    auto buffer = mScanBufferManager.getBuffer(start, length);
 
-    mSocket.writeScanBuffer(buffer, mDestRegion, mOffset, userId, ec);
+    mSocket.writeScanBuffer(start, length, mDestRegion, mOffset, userId, ec);
     if (ec) {
-        mScanBufferManager.releaseBuffer(buffer.id());
+        mScanBufferManager.releaseBuffer(mScanBufferManager.bufferId(start));
         return;
     }
     mOffset += length;
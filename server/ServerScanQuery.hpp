@@ -74,6 +74,11 @@ public:
      */
     void releaseBuffer(uint16_t id);
 
+    /**
+     * @brief Get the ID of the buffer the data pointer points into
+     */
+    uint16_t bufferId(const char* data) const;
+
     /**
      * @brief Get the InfinibandBuffer associated with the data pointer
      */
@@ -95,7 +100,8 @@ private:
 class ServerScanQuery final : public ScanQuery {
 public:
     ServerScanQuery(uint16_t scanId, ScanQueryType queryType, std::unique_ptr<char[]> selectionData,
-            size_t selectionLength, std::unique_ptr<char[]> queryData, size_t queryLength,
+            size_t selectionLength, std::unique_ptr<char[]> queryData, size_t queryLength, uint64_t lowKey,
+            uint64_t highKey, uint64_t limit, ScanOrder order, Record::id_t orderField,
             std::unique_ptr<commitmanager::SnapshotDescriptor> snapshot, const Record& record,
             ScanBufferManager& scanBufferManager, crossbow::infinio::RemoteMemoryRegion destRegion,
             ServerSocket& socket);
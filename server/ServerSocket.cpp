@@ -28,13 +28,27 @@
 #include <tellstore/ErrorCode.hpp>
 #include <tellstore/MessageTypes.hpp>
 
+#include <crossbow/allocator.hpp>
 #include <crossbow/enum_underlying.hpp>
 #include <crossbow/infinio/InfinibandBuffer.hpp>
 #include <crossbow/logger.hpp>
 
+#include <string>
+#include <vector>
+
 namespace tell {
 namespace store {
 
+ServerSocket::ServerSocket(ServerManager& manager, Storage& storage, crossbow::infinio::InfinibandProcessor& processor,
+        crossbow::infinio::InfinibandSocket socket, size_t maxBatchSize, uint64_t maxInflightScanBuffer)
+        : Base(manager, processor, std::move(socket), crossbow::string(), maxBatchSize),
+          mStorage(storage),
+          mMaxInflightScanBuffer(maxInflightScanBuffer),
+          mInflightScanBuffer(0u),
+          mTransactions(manager.snapshotCache(), storage.versionManager()) {
+    mScanTransport.reset(new InfinibandScanTransport(mSocket, manager.scanBufferManager()));
+}
+
 void ServerSocket::writeScanProgress(uint16_t scanId, bool done, size_t offset) {
     uint32_t messageLength = 2 * sizeof(size_t);
     writeResponse(crossbow::infinio::MessageId(scanId, true), ResponseType::SCAN, messageLength, [done, offset]
@@ -71,6 +85,10 @@ void ServerSocket::onRequest(crossbow::infinio::MessageId messageId, uint32_t me
         handleGet(messageId, request);
     } break;
 
+    case crossbow::to_underlying(RequestType::MULTI_GET): {
+        handleMultiGet(messageId, request);
+    } break;
+
     case crossbow::to_underlying(RequestType::UPDATE): {
         handleUpdate(messageId, request);
     } break;
@@ -87,6 +105,14 @@ void ServerSocket::onRequest(crossbow::infinio::MessageId messageId, uint32_t me
         handleRevert(messageId, request);
     } break;
 
+    case crossbow::to_underlying(RequestType::BATCH_WRITE): {
+        handleBatchWrite(messageId, request);
+    } break;
+
+    case crossbow::to_underlying(RequestType::INDEX_SCAN): {
+        handleIndexScan(messageId, request);
+    } break;
+
     case crossbow::to_underlying(RequestType::SCAN): {
         handleScan(messageId, request);
     } break;
@@ -96,7 +122,7 @@ void ServerSocket::onRequest(crossbow::infinio::MessageId messageId, uint32_t me
     } break;
 
     case crossbow::to_underlying(RequestType::COMMIT): {
-        // TODO Implement commit logic
+        handleCommit(messageId, request);
     } break;
 
     default: {
@@ -213,6 +239,54 @@ void ServerSocket::handleGet(crossbow::infinio::MessageId messageId, crossbow::b
     });
 }
 
+void ServerSocket::handleMultiGet(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request) {
+    auto tableId = request.read<uint64_t>();
+    auto count = request.read<uint64_t>();
+    auto keys = reinterpret_cast<const uint64_t*>(request.read(count * sizeof(uint64_t)));
+    handleSnapshot(messageId, request, [this, messageId, tableId, count, keys]
+            (const commitmanager::SnapshotDescriptor& snapshot) {
+        // The size of the tuples is only known after the lookup so the results are collected in a temporary buffer
+        // Every element is 8 bytes error code plus 8 bytes version plus 8 bytes (isNewest, size) and data
+        // The buffer is zero initialized when resized so the padding after the data does not have to be written
+        std::vector<char> results;
+        results.reserve(count * 4 * sizeof(uint64_t));
+
+        auto ec = mStorage.multiGet(tableId, keys, count, snapshot, [&results]
+                (size_t /* idx */, size_t size, uint64_t version, bool isNewest) {
+            auto offset = results.size();
+            results.resize(offset + 3 * sizeof(uint64_t) + crossbow::align(size, 8u));
+
+            crossbow::buffer_writer message(results.data() + offset, results.size() - offset);
+            message.write<uint16_t>(0x0u);
+            message.set(0, sizeof(uint64_t) - sizeof(uint16_t));
+            message.write<uint64_t>(version);
+            message.write<uint8_t>(isNewest ? 0x1u : 0x0u);
+            message.set(0, sizeof(uint32_t) - sizeof(uint8_t));
+            message.write<uint32_t>(size);
+            return message.data();
+        }, [&results] (size_t /* idx */, int ec) {
+            auto offset = results.size();
+            results.resize(offset + sizeof(uint64_t));
+
+            crossbow::buffer_writer message(results.data() + offset, sizeof(uint64_t));
+            message.write<uint16_t>(static_cast<uint16_t>(ec));
+            message.set(0, sizeof(uint64_t) - sizeof(uint16_t));
+        });
+
+        if (ec) {
+            writeErrorResponse(messageId, static_cast<error::errors>(ec));
+            return;
+        }
+
+        uint32_t messageLength = sizeof(uint64_t) + results.size();
+        writeResponse(messageId, ResponseType::MULTI_GET, messageLength, [count, &results]
+                (crossbow::buffer_writer& message, std::error_code& /* ec */) {
+            message.write<uint64_t>(count);
+            message.write(results.data(), results.size());
+        });
+    });
+}
+
 void ServerSocket::handleUpdate(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request) {
     auto tableId = request.read<uint64_t>();
     auto key = request.read<uint64_t>();
@@ -225,6 +299,9 @@ void ServerSocket::handleUpdate(crossbow::infinio::MessageId messageId, crossbow
     handleSnapshot(messageId, request, [this, messageId, tableId, key, dataLength, data]
             (const commitmanager::SnapshotDescriptor& snapshot) {
         auto ec = mStorage.update(tableId, key, dataLength, data, snapshot);
+        if (!ec) {
+            mTransactions.addWrite(snapshot, tableId, key);
+        }
         writeModificationResponse(messageId, ec);
     });
 }
@@ -241,6 +318,9 @@ void ServerSocket::handleInsert(crossbow::infinio::MessageId messageId, crossbow
     handleSnapshot(messageId, request, [this, messageId, tableId, key, dataLength, data]
             (const commitmanager::SnapshotDescriptor& snapshot) {
         auto ec = mStorage.insert(tableId, key, dataLength, data, snapshot);
+        if (!ec) {
+            mTransactions.addWrite(snapshot, tableId, key);
+        }
         writeModificationResponse(messageId, ec);
     });
 }
@@ -252,6 +332,9 @@ void ServerSocket::handleRemove(crossbow::infinio::MessageId messageId, crossbow
     handleSnapshot(messageId, request, [this, messageId, tableId, key]
             (const commitmanager::SnapshotDescriptor& snapshot) {
         auto ec = mStorage.remove(tableId, key, snapshot);
+        if (!ec) {
+            mTransactions.addWrite(snapshot, tableId, key);
+        }
         writeModificationResponse(messageId, ec);
     });
 }
@@ -263,15 +346,120 @@ void ServerSocket::handleRevert(crossbow::infinio::MessageId messageId, crossbow
     handleSnapshot(messageId, request, [this, messageId, tableId, key]
             (const commitmanager::SnapshotDescriptor& snapshot) {
         auto ec = mStorage.revert(tableId, key, snapshot);
+        if (!ec) {
+            mTransactions.removeWrite(snapshot, tableId, key);
+        }
         writeModificationResponse(messageId, ec);
     });
 }
 
+void ServerSocket::handleBatchWrite(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request) {
+    auto count = request.read<uint64_t>();
+
+    std::vector<WriteOperation> operations;
+    operations.reserve(count);
+    for (decltype(count) i = 0; i < count; ++i) {
+        auto tableId = request.read<uint64_t>();
+        auto key = request.read<uint64_t>();
+        auto type = crossbow::from_underlying<WriteType>(request.read<uint8_t>());
+
+        request.advance(sizeof(uint32_t) - sizeof(uint8_t));
+        auto dataLength = request.read<uint32_t>();
+        auto data = (dataLength == 0u ? nullptr : request.read(dataLength));
+        request.align(8u);
+
+        operations.emplace_back(type, tableId, key, dataLength, data);
+    }
+
+    handleSnapshot(messageId, request, [this, messageId, &operations]
+            (const commitmanager::SnapshotDescriptor& snapshot) {
+        std::vector<int> results(operations.size(), 0);
+        mStorage.batchWrite(operations.data(), operations.size(), snapshot, results.data());
+        for (decltype(operations.size()) i = 0; i < operations.size(); ++i) {
+            if (results[i] != 0) {
+                continue;
+            }
+            auto& operation = operations[i];
+            if (operation.type == WriteType::REVERT) {
+                mTransactions.removeWrite(snapshot, operation.tableId, operation.key);
+            } else {
+                mTransactions.addWrite(snapshot, operation.tableId, operation.key);
+            }
+        }
+
+        uint32_t messageLength = sizeof(uint64_t) + crossbow::align(results.size() * sizeof(uint16_t), 8u);
+        writeResponse(messageId, ResponseType::BATCH_WRITE, messageLength, [&results]
+                (crossbow::buffer_writer& message, std::error_code& /* ec */) {
+            message.write<uint64_t>(results.size());
+            for (auto ec : results) {
+                message.write<uint16_t>(static_cast<uint16_t>(ec));
+            }
+            message.set(0, crossbow::align(results.size() * sizeof(uint16_t), 8u) - results.size() * sizeof(uint16_t));
+        });
+    });
+}
+
+void ServerSocket::handleIndexScan(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request) {
+    auto tableId = request.read<uint64_t>();
+
+    auto indexNameLength = request.read<uint32_t>();
+    crossbow::string indexName(request.read(indexNameLength), indexNameLength);
+    request.align(sizeof(uint32_t));
+
+    auto lowerLength = request.read<uint32_t>();
+    std::string lower(request.read(lowerLength), lowerLength);
+    request.align(sizeof(uint32_t));
+
+    auto upperLength = request.read<uint32_t>();
+    std::string upper(request.read(upperLength), upperLength);
+    request.align(sizeof(uint64_t));
+
+    handleSnapshot(messageId, request, [this, messageId, tableId, &indexName, &lower, &upper]
+            (const commitmanager::SnapshotDescriptor& snapshot) {
+        // The number of tuples in the range is only known after the lookup so the results are collected in a temporary
+        // buffer, the buffer is zero initialized when resized so the padding after the data does not have to be written
+        size_t count = 0;
+        std::vector<char> results;
+        auto ec = mStorage.indexScan(tableId, indexName, lower, upper, snapshot, [&count, &results]
+                (uint64_t key, size_t size, uint64_t version, bool isNewest) {
+            auto offset = results.size();
+            results.resize(offset + 3 * sizeof(uint64_t) + crossbow::align(size, 8u));
+            ++count;
+
+            crossbow::buffer_writer message(results.data() + offset, results.size() - offset);
+            message.write<uint64_t>(key);
+            message.write<uint64_t>(version);
+            message.write<uint8_t>(isNewest ? 0x1u : 0x0u);
+            message.set(0, sizeof(uint32_t) - sizeof(uint8_t));
+            message.write<uint32_t>(size);
+            return message.data();
+        });
+
+        if (ec) {
+            writeErrorResponse(messageId, static_cast<error::errors>(ec));
+            return;
+        }
+
+        uint32_t messageLength = sizeof(uint64_t) + results.size();
+        writeResponse(messageId, ResponseType::INDEX_SCAN, messageLength, [count, &results]
+                (crossbow::buffer_writer& message, std::error_code& /* ec */) {
+            message.write<uint64_t>(count);
+            message.write(results.data(), results.size());
+        });
+    });
+}
+
 void ServerSocket::handleScan(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request) {
     auto tableId = request.read<uint64_t>();
     auto queryType = crossbow::from_underlying<ScanQueryType>(request.read<uint8_t>());
 
     request.advance(sizeof(uint64_t) - sizeof(uint8_t));
+    auto lowKey = request.read<uint64_t>();
+    auto highKey = request.read<uint64_t>();
+    auto limit = request.read<uint64_t>();
+    auto orderField = request.read<uint16_t>();
+    auto order = crossbow::from_underlying<ScanOrder>(request.read<uint8_t>());
+    request.advance(sizeof(uint64_t) - sizeof(uint16_t) - sizeof(uint8_t));
     auto remoteAddress = request.read<uint64_t>();
     auto remoteLength = request.read<uint64_t>();
     auto remoteKey = request.read<uint32_t>();
@@ -294,8 +482,8 @@ void ServerSocket::handleScan(crossbow::infinio::MessageId messageId, crossbow::
 
     request.align(sizeof(uint64_t));
     handleSnapshot(messageId, request,
-            [this, messageId, tableId, &remoteRegion, selectionLength, &selection, queryType, queryLength, &query]
-            (const commitmanager::SnapshotDescriptor& snapshot) {
+            [this, messageId, tableId, &remoteRegion, selectionLength, &selection, queryType, queryLength, &query,
+            lowKey, highKey, limit, order, orderField] (const commitmanager::SnapshotDescriptor& snapshot) {
         auto scanId = static_cast<uint16_t>(messageId.userId() & 0xFFFFu);
 
         // Copy snapshot descriptor
@@ -305,8 +493,13 @@ void ServerSocket::handleScan(crossbow::infinio::MessageId messageId, crossbow::
         auto table = mStorage.getTable(tableId);
 
         std::unique_ptr<ServerScanQuery> scanData(new ServerScanQuery(scanId, queryType, std::move(selection),
-                selectionLength, std::move(query), queryLength, std::move(scanSnapshot), table->record(),
-                manager().scanBufferManager(), std::move(remoteRegion), *this));
+                selectionLength, std::move(query), queryLength, lowKey, highKey, limit, order, orderField,
+                std::move(scanSnapshot), table->record(), manager().scanBufferManager(), std::move(remoteRegion),
+                *this));
+        if (!scanData->validLimit()) {
+            writeErrorResponse(messageId, error::invalid_scan);
+            return;
+        }
         auto scanDataPtr = scanData.get();
         auto res = mScans.emplace(scanId, std::move(scanData));
         if (!res.second) {
@@ -337,6 +530,31 @@ void ServerSocket::handleScanProgress(crossbow::infinio::MessageId messageId, cr
     i->second->requestProgress(offsetRead);
 }
 
+void ServerSocket::handleCommit(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request) {
+    auto version = request.read<uint64_t>();
+    bool commit = (request.read<uint8_t>() != 0x0u);
+
+    if (!commit) {
+        auto ec = mTransactions.revert(mStorage, version);
+        if (ec) {
+            // The write set is kept so the abort can be retried
+            LOG_ERROR("Reverting the write set of transaction %1% failed [error = %2%]", version, ec);
+            writeErrorResponse(messageId, static_cast<error::errors>(ec));
+            return;
+        }
+    }
+
+    // The writes (or their reverts) have to be durable before the completion of the transaction is acknowledged
+    mStorage.syncRedoLog();
+
+    // The transaction will not issue any further requests so the snapshot can be released immediately
+    mTransactions.complete(version);
+
+    writeResponse(messageId, ResponseType::COMMIT, 0, []
+            (crossbow::buffer_writer& /* message */, std::error_code& /* ec */) {
+    });
+}
+
 void ServerSocket::onWrite(uint32_t userId, uint16_t bufferId, const std::error_code& ec) {
     // TODO We have to propagate the error to the ServerScanQuery so we can detach the scan
     if (ec) {
@@ -382,26 +600,26 @@ void ServerSocket::handleSnapshot(crossbow::infinio::MessageId messageId, crossb
     bool hasDescriptor = (message.read<uint8_t>() != 0x0u);
     message.align(sizeof(uint64_t));
     if (cached) {
-        typename decltype(mSnapshots)::iterator i;
+        // The snapshot returned by the shared cache is only guaranteed to be valid as long as the guard is held
+        crossbow::allocator _;
+
+        auto version = message.read<uint64_t>();
+        const commitmanager::SnapshotDescriptor* snapshot = nullptr;
         if (!hasDescriptor) {
             // The client did not send a snapshot so it has to be in the cache
-            auto version = message.read<uint64_t>();
-            i = mSnapshots.find(version);
-            if (i == mSnapshots.end()) {
-                writeErrorResponse(messageId, error::invalid_snapshot);
-                return;
-            }
+            snapshot = mTransactions.find(version);
         } else {
-            // The client send a snapshot so we have to add it to the cache (it must not already be there)
-            auto snapshot = commitmanager::SnapshotDescriptor::deserialize(message);
-            auto res = mSnapshots.emplace(snapshot->version(), std::move(snapshot));
-            if (!res.second) { // Snapshot descriptor already is in the cache
-                writeErrorResponse(messageId, error::invalid_snapshot);
-                return;
-            }
-            i = res.first;
+            // The client sent the snapshot for the first time on this connection
+            auto descriptorLength = message.read<uint64_t>();
+            auto descriptorData = message.read(descriptorLength);
+            snapshot = mTransactions.acquire(version, descriptorData, descriptorLength);
+        }
+
+        if (!snapshot) {
+            writeErrorResponse(messageId, error::invalid_snapshot);
+            return;
         }
-        f(*i->second);
+        f(*snapshot);
     } else if (hasDescriptor) {
         auto snapshot = commitmanager::SnapshotDescriptor::deserialize(message);
         f(*snapshot);
@@ -410,14 +628,6 @@ void ServerSocket::handleSnapshot(crossbow::infinio::MessageId messageId, crossb
     }
 }
 
-void ServerSocket::removeSnapshot(uint64_t version) {
-    auto i = mSnapshots.find(version);
-    if (i == mSnapshots.end()) {
-        return;
-    }
-    mSnapshots.erase(i);
-}
-
 void ServerSocket::writeModificationResponse(crossbow::infinio::MessageId messageId, int ec) {
     if (ec) {
         writeErrorResponse(messageId, static_cast<error::errors>(ec));
@@ -434,7 +644,8 @@ ServerManager::ServerManager(crossbow::infinio::InfinibandService& service, Stor
           mStorage(storage),
           mMaxBatchSize(config.maxBatchSize),
           mScanBufferManager(service, config),
-          mMaxInflightScanBuffer(config.maxInflightScanBuffer) {
+          mMaxInflightScanBuffer(config.maxInflightScanBuffer),
+          mSnapshotCache(storage.versionManager(), config.snapshotCacheCapacity) {
     for (decltype(config.numNetworkThreads) i = 0; i < config.numNetworkThreads; ++i) {
         mProcessors.emplace_back(service.createProcessor());
     }
@@ -22,9 +22,12 @@
  */
 #pragma once
 
+#include "ScanTransport.hpp"
 #include "ServerConfig.hpp"
 #include "ServerScanQuery.hpp"
+#include "SnapshotCache.hpp"
 #include "Storage.hpp"
+#include "TransactionTracker.hpp"
 
 #include <commitmanager/SnapshotDescriptor.hpp>
 
@@ -37,6 +40,7 @@
 #include <memory>
 #include <unordered_map>
 #include <system_error>
+#include <vector>
 
 namespace tell {
 namespace store {
@@ -53,12 +57,7 @@ class ServerSocket : public crossbow::infinio::RpcServerSocket<ServerManager, Se
 
 public:
     ServerSocket(ServerManager& manager, Storage& storage, crossbow::infinio::InfinibandProcessor& processor,
-            crossbow::infinio::InfinibandSocket socket, size_t maxBatchSize, uint64_t maxInflightScanBuffer)
-            : Base(manager, processor, std::move(socket), crossbow::string(), maxBatchSize),
-              mStorage(storage),
-              mMaxInflightScanBuffer(maxInflightScanBuffer),
-              mInflightScanBuffer(0u) {
-    }
+            crossbow::infinio::InfinibandSocket socket, size_t maxBatchSize, uint64_t maxInflightScanBuffer);
 
     /**
      * @brief Execute the function in the event loop
@@ -69,11 +68,12 @@ public:
     }
 
     /**
-     * @brief Writes the buffer into the scan destination region
+     * @brief Writes the scan buffer into the scan destination region using the socket's scan transport
+     *
+     * A write without data only signals the completion with the given user ID.
      */
-    template <typename Buffer>
-    void writeScanBuffer(Buffer& buffer, crossbow::infinio::RemoteMemoryRegion& destRegion, size_t offset,
-            uint32_t userId, std::error_code& ec) {
+    void writeScanBuffer(const char* data, uint32_t length, crossbow::infinio::RemoteMemoryRegion& destRegion,
+            size_t offset, uint32_t userId, std::error_code& ec) {
         // Wait in case the network is overloaded
         // For performance reasons this is not really thread safe but as the number of threads accessing this variable
         // is bounded and small (2-4) the actual limit will not be exceeded by much.
@@ -81,13 +81,14 @@ public:
             std::this_thread::yield();
         }
 
+        // The write might complete before the transport returns so the buffer has to be counted beforehand
+        ++mInflightScanBuffer;
+
         ec = std::error_code();
-        mSocket->write(buffer, destRegion, offset, userId, ec);
+        mScanTransport->write(data, length, destRegion, offset, userId, ec);
         if (ec) {
-            return;
+            --mInflightScanBuffer;
         }
-
-        ++mInflightScanBuffer;
     }
 
     /**
@@ -158,6 +159,30 @@ private:
      */
     void handleGet(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request);
 
+    /**
+     * The multi get request has the following format:
+     * - 8 bytes: The table ID of the requested tuples
+     * - 8 bytes: Number of requested keys
+     * - x bytes: The keys of the requested tuples (8 bytes each)
+     * - x bytes: Snapshot descriptor
+     *
+     * All keys are read with the same snapshot and the results are sent back in a single response.
+     *
+     * The response consists of the following format:
+     * - 8 bytes: Number of elements in the list
+     * - For every requested key (in the order of the request)
+     *   - 2 bytes: Error code of the lookup or 0 when the tuple was found
+     *   - 6 bytes: Padding
+     *   If the tuple was found:
+     *   - 8 bytes: The version of the tuple
+     *   - 1 byte:  Whether the tuple is the newest one
+     *   - 3 bytes: Padding
+     *   - 4 bytes: Length of the tuple's data field
+     *   - x bytes: The tuple's data
+     *   - y bytes: Variable padding to make the element 8 byte aligned
+     */
+    void handleMultiGet(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request);
+
     /**
      * The update request has the following format:
      * - 8 bytes: The table ID of the requested tuple
@@ -208,11 +233,63 @@ private:
      */
     void handleRevert(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request);
 
+    /**
+     * The batch write request has the following format:
+     * - 8 bytes: Number of modifications in the batch
+     * - For every modification
+     *   - 8 bytes: The table ID of the modified tuple
+     *   - 8 bytes: The key of the modified tuple
+     *   - 1 byte:  The type of the modification
+     *   - 3 bytes: Padding
+     *   - 4 bytes: Length of the tuple's data field (0 for remove and revert)
+     *   - x bytes: The tuple's data
+     *   - y bytes: Variable padding to make the modification 8 byte aligned
+     * - x bytes: Snapshot descriptor
+     *
+     * All modifications are executed with the same snapshot.
+     *
+     * The response consists of the following format:
+     * - 8 bytes: Number of modifications in the batch
+     * - For every modification (in the order of the request)
+     *   - 2 bytes: Error code of the modification or 0 when it was successful
+     * - y bytes: Variable padding to make message 8 byte aligned
+     */
+    void handleBatchWrite(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request);
+
+    /**
+     * The index scan request has the following format:
+     * - 8 bytes: The table ID of the requested tuples
+     * - 4 bytes: Length of the index name
+     * - x bytes: The name of the secondary index
+     * - y bytes: Variable padding to make the bound 4 byte aligned
+     * - 4 bytes: Length of the encoded lower bound (0 for an open bound)
+     * - x bytes: The encoded lower bound
+     * - y bytes: Variable padding to make the bound 4 byte aligned
+     * - 4 bytes: Length of the encoded upper bound (0 for an open bound)
+     * - x bytes: The encoded upper bound
+     * - y bytes: Variable padding to make the snapshot 8 byte aligned
+     * - x bytes: Snapshot descriptor
+     *
+     * The response consists of the following format:
+     * - 8 bytes: Number of tuples in the list
+     * - For every tuple in the range (in the order of the index)
+     *   - 8 bytes: The key of the tuple
+     *   - 8 bytes: The version of the tuple
+     *   - 1 byte:  Whether the tuple is the newest one
+     *   - 3 bytes: Padding
+     *   - 4 bytes: Length of the tuple's data field
+     *   - x bytes: The tuple's data
+     *   - y bytes: Variable padding to make the element 8 byte aligned
+     */
+    void handleIndexScan(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request);
+
     /**
      * The scan request has the following format:
      * - 8 bytes: The table ID of the requested tuple
      * - 1 byte:  The type of the query data
      * - 7 bytes: Padding
+     * - 8 bytes: The smallest key (inclusive) to scan
+     * - 8 bytes: The largest key (exclusive) to scan or the maximum 64 bit value for no upper bound
      * - 8 bytes: The address of the remote memory region
      * - 8 bytes: Length of the remote memory region
      * - 4 bytes: The access key of the remote memory region
@@ -232,25 +309,45 @@ private:
      */
     void handleScanProgress(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request);
 
+    /**
+     * The commit request has the following format:
+     * - 8 bytes: The version of the snapshot of the completed transaction
+     * - 1 byte:  Whether the transaction committed (1) or aborted (0)
+     * - 7 bytes: Padding
+     *
+     * If the transaction aborted all tuples in the write set of the transaction on this connection are reverted in a
+     * single batch. In case any revert fails an error is returned and the tuples not yet reverted are kept in the write
+     * set so the abort can be retried. Otherwise the write set is discarded and the reference on the cached snapshot is
+     * released.
+     *
+     * The response is empty.
+     */
+    void handleCommit(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& request);
+
     virtual void onWrite(uint32_t userId, uint16_t bufferId, const std::error_code& ec) final override;
 
     /**
      * @brief Get the snapshot associated with the request and pass it to the function
      *
      * The snapshot can come from different sources: If the client requested a cached snapshot the snapshot is
-     * retrieved from the local cache or added to the cache in case the data was supplied in the snapshot message. The
-     * snapshot has to be either in the cache or sent with the request (not both and not none of them at the same
-     * time). If the client requested an uncached snapshot then the snapshot is parsed from the message without
-     * considering the cache.
+     * retrieved from the snapshot cache shared by all connections. In case the data was supplied in the snapshot
+     * message the connection acquires a reference on the snapshot in the shared cache, the descriptor is only
+     * deserialized when no other connection added the snapshot to the cache before. Snapshots not fitting into the
+     * shared cache are kept in a connection local cache. If the client requested an uncached snapshot then the snapshot
+     * is parsed from the message without considering the cache.
      *
-     * In case of an error (no snapshot descriptor or conflicting data found) an error response will be written back and
-     * the function will not be invoked.
+     * In case of an error (no snapshot descriptor found) an error response will be written back and the function will
+     * not be invoked.
      *
      * The snapshot descriptor has the following format:
      * - 1 byte:  Whether we want to get / put the snapshot descriptor from / into the cache
      * - 1 byte:  Whether we sent the full descriptor
-     * If the message contains a full descriptor:
      * - 6 bytes: Padding
+     * If the snapshot is cached:
+     * - 8 bytes: The version of the snapshot
+     * If the snapshot is cached and the message contains a full descriptor:
+     * - 8 bytes: Length of the descriptor data
+     * If the message contains a full descriptor:
      * - x bytes: The descriptor data
      *
      * @param transactionId The transaction ID of the current message
@@ -261,11 +358,6 @@ private:
     template <typename Fun>
     void handleSnapshot(crossbow::infinio::MessageId messageId, crossbow::buffer_reader& message, Fun f);
 
-    /**
-     * @brief Removes the snapshot from the cache
-     */
-    void removeSnapshot(uint64_t version);
-
     /**
      * @brief Writes the result of the modification response back to the client
      */
@@ -279,9 +371,11 @@ private:
     /// Current number of scan buffers that are in flight
     std::atomic<uint64_t> mInflightScanBuffer;
 
-    // TODO Replace with google dense map (SnapshotDescriptor has no copy / default constructor)
-    /// Snapshot cache mapping the version number to the snapshot descriptor
-    std::unordered_map<uint64_t, std::unique_ptr<commitmanager::SnapshotDescriptor>> mSnapshots;
+    /// Transport writing the scan buffers to the client
+    std::unique_ptr<ScanTransport> mScanTransport;
+
+    /// Snapshots and write sets of the transactions active on this connection
+    TransactionTracker mTransactions;
 
     /// Map from Scan ID to the shared data class associated with the scan
     /// The Connection has the ownership because we can only free this after all RDMA writes have been processed
@@ -304,6 +398,10 @@ private:
         return mScanBufferManager;
     }
 
+    SnapshotCache& snapshotCache() {
+        return mSnapshotCache;
+    }
+
     Storage& mStorage;
 
     size_t mMaxBatchSize;
@@ -311,6 +409,9 @@ private:
     ScanBufferManager mScanBufferManager;
     uint64_t mMaxInflightScanBuffer;
 
+    /// Snapshot descriptors cached for the clients of all connections
+    SnapshotCache mSnapshotCache;
+
     std::vector<std::unique_ptr<crossbow::infinio::InfinibandProcessor>> mProcessors;
 };
 
@@ -0,0 +1,102 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include "SnapshotCache.hpp"
+
+namespace tell {
+namespace store {
+namespace {
+
+size_t roundCapacity(size_t capacity) {
+    size_t result = 1u;
+    while (result < capacity) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+SnapshotCache::SnapshotCache(const VersionManager& versionManager, size_t capacity)
+        : mVersionManager(versionManager),
+          mMask(roundCapacity(capacity) - 1u),
+          mSlots(new std::atomic<Entry*>[mMask + 1u]) {
+    for (size_t i = 0u; i <= mMask; ++i) {
+        mSlots[i].store(nullptr);
+    }
+}
+
+SnapshotCache::~SnapshotCache() {
+    for (size_t i = 0u; i <= mMask; ++i) {
+        if (auto entry = mSlots[i].load()) {
+            crossbow::allocator::destroy_now(entry);
+        }
+    }
+}
+
+const commitmanager::SnapshotDescriptor* SnapshotCache::find(uint64_t version) const {
+    auto entry = slot(version).load();
+    if (!entry || entry->snapshot->version() != version || entry->references.load() == 0u) {
+        return nullptr;
+    }
+    return entry->snapshot.get();
+}
+
+void SnapshotCache::release(uint64_t version) {
+    auto& s = slot(version);
+    auto entry = s.load();
+    if (!entry || entry->snapshot->version() != version) {
+        return;
+    }
+
+    auto references = entry->references.load();
+    while (true) {
+        if (references == 0u) {
+            return;
+        }
+        if (entry->references.compare_exchange_weak(references, references - 1u)) {
+            break;
+        }
+    }
+    if (references != 1u) {
+        return;
+    }
+
+    // The last reference was released - Whoever removes the entry from the slot is responsible for destroying it
+    if (s.compare_exchange_strong(entry, nullptr)) {
+        crossbow::allocator::destroy(entry);
+    }
+}
+
+bool SnapshotCache::tryReference(Entry* entry) {
+    auto references = entry->references.load();
+    while (references != 0u) {
+        if (entry->references.compare_exchange_weak(references, references + 1u)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace store
+} // namespace tell
@@ -0,0 +1,163 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#pragma once
+
+#include <util/VersionManager.hpp>
+
+#include <commitmanager/SnapshotDescriptor.hpp>
+
+#include <crossbow/allocator.hpp>
+#include <crossbow/non_copyable.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace tell {
+namespace store {
+
+/**
+ * @brief Lock-free cache of snapshot descriptors shared by all connections of the server
+ *
+ * Snapshots are keyed by their version and stored in a direct mapped table: As versions are handed out consecutively
+ * by the commit manager, every snapshot between the lowest active version and the newest version gets its own slot as
+ * long as the capacity is larger than the number of concurrently active versions.
+ *
+ * Every connection using a cached snapshot holds a reference on it, the snapshot is removed as soon as the last
+ * reference is released. Snapshots older than the lowest active version of the VersionManager are expired and evicted
+ * as soon as their slot is needed by a newer snapshot, regardless of any references still held.
+ *
+ * Removed entries are reclaimed through the epoch mechanism: Callers must hold a crossbow::allocator guard for as long
+ * as they access a snapshot returned by the cache.
+ */
+class SnapshotCache : crossbow::non_copyable, crossbow::non_movable {
+public:
+    /**
+     * @param versionManager Version manager tracking the lowest active version
+     * @param capacity Number of slots in the cache (rounded up to the next power of two)
+     */
+    SnapshotCache(const VersionManager& versionManager, size_t capacity);
+
+    ~SnapshotCache();
+
+    /**
+     * @brief Looks up the snapshot with the given version
+     *
+     * @return The cached snapshot or null if the snapshot is not in the cache
+     */
+    const commitmanager::SnapshotDescriptor* find(uint64_t version) const;
+
+    /**
+     * @brief Acquires a reference on the snapshot with the given version
+     *
+     * Inserts the snapshot created by the function in case it is not yet cached. The function is only invoked when the
+     * snapshot has to be inserted.
+     *
+     * @param version Version of the snapshot
+     * @param fun Function with the signature () -> std::unique_ptr<commitmanager::SnapshotDescriptor>
+     * @return The cached snapshot or null if the slot is occupied by another active snapshot
+     */
+    template <typename Fun>
+    const commitmanager::SnapshotDescriptor* acquire(uint64_t version, Fun fun);
+
+    /**
+     * @brief Releases a reference on the snapshot with the given version
+     *
+     * The snapshot is removed from the cache when the last reference was released.
+     */
+    void release(uint64_t version);
+
+private:
+    struct Entry {
+        Entry(std::unique_ptr<commitmanager::SnapshotDescriptor> snapshot)
+                : snapshot(std::move(snapshot)),
+                  references(1u) {
+        }
+
+        std::unique_ptr<commitmanager::SnapshotDescriptor> snapshot;
+
+        /// Number of connections holding a reference on the snapshot
+        /// The entry is about to be removed when the count dropped to 0 and can not be acquired anymore.
+        std::atomic<uint64_t> references;
+    };
+
+    std::atomic<Entry*>& slot(uint64_t version) const {
+        return mSlots[version & mMask];
+    }
+
+    /**
+     * @brief Increments the reference count of the entry unless it already dropped to 0
+     */
+    static bool tryReference(Entry* entry);
+
+    /**
+     * @brief Whether the entry can be replaced by another snapshot
+     */
+    bool expired(const Entry* entry) const {
+        return (entry->references.load() == 0u
+                || entry->snapshot->version() < mVersionManager.lowestActiveVersion());
+    }
+
+    const VersionManager& mVersionManager;
+
+    size_t mMask;
+
+    std::unique_ptr<std::atomic<Entry*>[]> mSlots;
+};
+
+template <typename Fun>
+const commitmanager::SnapshotDescriptor* SnapshotCache::acquire(uint64_t version, Fun fun) {
+    auto& s = slot(version);
+    Entry* newEntry = nullptr;
+
+    auto entry = s.load();
+    while (true) {
+        if (entry && entry->snapshot->version() == version && tryReference(entry)) {
+            break;
+        }
+        if (entry && !expired(entry)) {
+            entry = nullptr;
+            break;
+        }
+
+        if (!newEntry) {
+            newEntry = crossbow::allocator::construct<Entry>(fun());
+        }
+        if (s.compare_exchange_strong(entry, newEntry)) {
+            if (entry) {
+                crossbow::allocator::destroy(entry);
+            }
+            return newEntry->snapshot.get();
+        }
+    }
+
+    // The new entry was never published so it can be destroyed right away
+    if (newEntry) {
+        crossbow::allocator::destroy_now(newEntry);
+    }
+    return (entry ? entry->snapshot.get() : nullptr);
+}
+
+} // namespace store
+} // namespace tell
@@ -0,0 +1,128 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include "TransactionTracker.hpp"
+
+#include <crossbow/byte_buffer.hpp>
+
+namespace tell {
+namespace store {
+
+TransactionTracker::~TransactionTracker() {
+    crossbow::allocator _;
+    for (auto version : mCachedSnapshots) {
+        mSnapshotCache.release(version);
+    }
+}
+
+const commitmanager::SnapshotDescriptor* TransactionTracker::find(uint64_t version) const {
+    if (auto snapshot = mSnapshotCache.find(version)) {
+        return snapshot;
+    }
+    auto i = mLocalSnapshots.find(version);
+    return (i == mLocalSnapshots.end() ? nullptr : i->second.get());
+}
+
+const commitmanager::SnapshotDescriptor* TransactionTracker::acquire(uint64_t version, const char* data,
+        uint64_t length) {
+    if (holdsSnapshot(version)) {
+        return find(version);
+    }
+
+    removeExpired();
+
+    auto snapshot = mSnapshotCache.acquire(version, [data, length] () {
+        crossbow::buffer_reader reader(data, length);
+        return commitmanager::SnapshotDescriptor::deserialize(reader);
+    });
+    if (snapshot) {
+        mCachedSnapshots.emplace(version);
+    } else {
+        crossbow::buffer_reader reader(data, length);
+        auto i = mLocalSnapshots.emplace(version, commitmanager::SnapshotDescriptor::deserialize(reader));
+        snapshot = i.first->second.get();
+    }
+    return snapshot;
+}
+
+void TransactionTracker::addWrite(const commitmanager::SnapshotDescriptor& snapshot, uint64_t tableId,
+        uint64_t key) {
+    if (snapshot.lowestActiveVersion() == 0x0u) {
+        return;
+    }
+    auto i = mWriteSets.find(snapshot.version());
+    if (i == mWriteSets.end()) {
+        i = mWriteSets.emplace(snapshot.version(), WriteSet(snapshot)).first;
+    }
+    i->second.writes.emplace_back(tableId, key);
+}
+
+void TransactionTracker::removeWrite(const commitmanager::SnapshotDescriptor& snapshot, uint64_t tableId,
+        uint64_t key) {
+    auto i = mWriteSets.find(snapshot.version());
+    if (i == mWriteSets.end()) {
+        return;
+    }
+    auto& writes = i->second.writes;
+    writes.erase(std::remove(writes.begin(), writes.end(), std::make_pair(tableId, key)), writes.end());
+}
+
+void TransactionTracker::complete(uint64_t version) {
+    mWriteSets.erase(version);
+
+    if (mCachedSnapshots.erase(version) != 0u) {
+        crossbow::allocator _;
+        mSnapshotCache.release(version);
+        return;
+    }
+    mLocalSnapshots.erase(version);
+}
+
+void TransactionTracker::removeExpired() {
+    auto lowestActiveVersion = mVersionManager.lowestActiveVersion();
+    for (auto i = mCachedSnapshots.begin(); i != mCachedSnapshots.end();) {
+        if (*i >= lowestActiveVersion) {
+            ++i;
+            continue;
+        }
+        mSnapshotCache.release(*i);
+        i = mCachedSnapshots.erase(i);
+    }
+    for (auto i = mLocalSnapshots.begin(); i != mLocalSnapshots.end();) {
+        if (i->first >= lowestActiveVersion) {
+            ++i;
+            continue;
+        }
+        i = mLocalSnapshots.erase(i);
+    }
+    for (auto i = mWriteSets.begin(); i != mWriteSets.end();) {
+        if (i->first >= lowestActiveVersion) {
+            ++i;
+            continue;
+        }
+        i = mWriteSets.erase(i);
+    }
+}
+
+} // namespace store
+} // namespace tell
@@ -0,0 +1,210 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#pragma once
+
+#include "SnapshotCache.hpp"
+
+#include <util/VersionManager.hpp>
+#include <util/WriteOperation.hpp>
+
+#include <tellstore/StdTypes.hpp>
+
+#include <commitmanager/SnapshotDescriptor.hpp>
+
+#include <crossbow/allocator.hpp>
+#include <crossbow/non_copyable.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace tell {
+namespace store {
+
+/**
+ * @brief Tracks the snapshots and write sets of the transactions active on one connection
+ *
+ * Snapshots sent by the client are acquired from the snapshot cache shared by all connections, snapshots not fitting
+ * into the shared cache are kept in a connection local cache.
+ *
+ * The table ID and key of every tuple written by a transaction are recorded in the write set of the transaction so
+ * the transaction can be aborted with a single request. The write set keeps its own copy of the snapshot so the writes
+ * can be reverted even after the snapshot was evicted from the shared cache.
+ *
+ * Not thread-safe, all functions must be called from the connection's processing thread.
+ */
+class TransactionTracker : crossbow::non_copyable, crossbow::non_movable {
+public:
+    TransactionTracker(SnapshotCache& snapshotCache, VersionManager& versionManager)
+            : mSnapshotCache(snapshotCache),
+              mVersionManager(versionManager) {
+    }
+
+    /**
+     * @brief Releases all snapshots held by the connection
+     */
+    ~TransactionTracker();
+
+    /**
+     * @brief Looks up the snapshot with the given version in the shared or the connection local cache
+     *
+     * The caller must hold a crossbow::allocator guard for as long as it accesses the snapshot.
+     *
+     * @return The snapshot or null if it is not cached
+     */
+    const commitmanager::SnapshotDescriptor* find(uint64_t version) const;
+
+    /**
+     * @brief Acquires the snapshot sent by the client
+     *
+     * The descriptor is only deserialized when the connection does not yet hold the snapshot and no other connection
+     * added the snapshot to the shared cache before. Snapshots of completed transactions held by the connection are
+     * released beforehand.
+     *
+     * The caller must hold a crossbow::allocator guard for as long as it accesses the snapshot.
+     */
+    const commitmanager::SnapshotDescriptor* acquire(uint64_t version, const char* data, uint64_t length);
+
+    /**
+     * @brief Adds the tuple to the write set of the snapshot's transaction
+     *
+     * Writes of non-transactional snapshots (lowest active version of 0) are not tracked.
+     */
+    void addWrite(const commitmanager::SnapshotDescriptor& snapshot, uint64_t tableId, uint64_t key);
+
+    /**
+     * @brief Removes the tuple from the write set of the snapshot's transaction after it was explicitly reverted
+     */
+    void removeWrite(const commitmanager::SnapshotDescriptor& snapshot, uint64_t tableId, uint64_t key);
+
+    /**
+     * @brief Reverts all tuples in the write set of the aborted transaction with a single batch write
+     *
+     * Successfully reverted tuples are removed from the write set, tuples that could not be reverted are kept.
+     *
+     * @param storage Storage with a batchWrite function
+     * @return The error code of the first failed revert or 0 if all tuples were reverted
+     */
+    template <typename Storage>
+    int revert(Storage& storage, uint64_t version);
+
+    /**
+     * @brief Completes the transaction
+     *
+     * Discards the write set of the transaction and releases the snapshot.
+     */
+    void complete(uint64_t version);
+
+    /**
+     * @brief Releases all snapshots and write sets older than the lowest active version
+     *
+     * The transactions of these snapshots have completed and will not issue any further requests. The caller must
+     * hold a crossbow::allocator guard.
+     */
+    void removeExpired();
+
+    /**
+     * @brief Whether the connection holds the snapshot with the given version
+     */
+    bool holdsSnapshot(uint64_t version) const {
+        return (mCachedSnapshots.count(version) != 0u || mLocalSnapshots.count(version) != 0u);
+    }
+
+    /**
+     * @brief Number of tuples in the write set of the transaction with the given version
+     */
+    size_t writeSetSize(uint64_t version) const {
+        auto i = mWriteSets.find(version);
+        return (i == mWriteSets.end() ? 0u : i->second.writes.size());
+    }
+
+private:
+    struct WriteSet {
+        WriteSet(const commitmanager::SnapshotDescriptor& s)
+                : snapshot(commitmanager::SnapshotDescriptor::create(s.lowestActiveVersion(), s.baseVersion(),
+                        s.version(), s.data())) {
+        }
+
+        /// Copy of the snapshot the tuples were written with
+        std::unique_ptr<commitmanager::SnapshotDescriptor> snapshot;
+
+        /// Table ID and key of all tuples written by the transaction
+        std::vector<std::pair<uint64_t, uint64_t>> writes;
+    };
+
+    SnapshotCache& mSnapshotCache;
+
+    VersionManager& mVersionManager;
+
+    /// Versions of the snapshots in the shared snapshot cache this connection holds a reference on
+    std::unordered_set<uint64_t> mCachedSnapshots;
+
+    /// Snapshots cached by the client that did not fit into the shared snapshot cache
+    std::unordered_map<uint64_t, std::unique_ptr<commitmanager::SnapshotDescriptor>> mLocalSnapshots;
+
+    /// Map from snapshot version to the tuples written by the transaction on this connection
+    std::unordered_map<uint64_t, WriteSet> mWriteSets;
+};
+
+template <typename Storage>
+int TransactionTracker::revert(Storage& storage, uint64_t version) {
+    auto i = mWriteSets.find(version);
+    if (i == mWriteSets.end()) {
+        return 0;
+    }
+    auto& writes = i->second.writes;
+
+    // Tuples written multiple times by the transaction only have to be reverted once
+    std::sort(writes.begin(), writes.end());
+    writes.erase(std::unique(writes.begin(), writes.end()), writes.end());
+
+    std::vector<WriteOperation> operations;
+    operations.reserve(writes.size());
+    for (auto& write : writes) {
+        operations.emplace_back(WriteType::REVERT, write.first, write.second, 0u, nullptr);
+    }
+
+    std::vector<int> results(operations.size(), 0);
+    storage.batchWrite(operations.data(), operations.size(), *i->second.snapshot, results.data());
+
+    int ec = 0;
+    decltype(writes.size()) failed = 0;
+    for (decltype(writes.size()) j = 0; j < writes.size(); ++j) {
+        if (results[j] == 0) {
+            continue;
+        }
+        if (!ec) {
+            ec = results[j];
+        }
+        writes[failed++] = writes[j];
+    }
+    writes.resize(failed);
+    return ec;
+}
+
+} // namespace store
+} // namespace tell
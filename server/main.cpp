@@ -38,6 +38,7 @@ int main(int argc, const char** argv) {
     tell::store::ServerConfig serverConfig;
     bool help = false;
     crossbow::string logLevel("DEBUG");
+    crossbow::string hugePages("transparent");
 
     auto opts = crossbow::program_options::create_options(argv[0],
             crossbow::program_options::value<'h'>("help", &help),
@@ -50,6 +51,28 @@ int main(int argc, const char** argv) {
             crossbow::program_options::value<-2>("scan-threads", &storageConfig.numScanThreads,
                     crossbow::program_options::tag::ignore_short<true>{}),
             crossbow::program_options::value<-3>("gc-interval", &storageConfig.gcInterval,
+                    crossbow::program_options::tag::ignore_short<true>{}),
+            crossbow::program_options::value<-4>("code-cache", &storageConfig.scanCodeCacheCapacity,
+                    crossbow::program_options::tag::ignore_short<true>{}),
+            crossbow::program_options::value<-5>("active-scans", &storageConfig.maxActiveScans,
+                    crossbow::program_options::tag::ignore_short<true>{}),
+            crossbow::program_options::value<-6>("scan-quantum", &storageConfig.scanQuantum,
+                    crossbow::program_options::tag::ignore_short<true>{}),
+            crossbow::program_options::value<-7>("redo-log", &storageConfig.redoLogPath,
+                    crossbow::program_options::tag::ignore_short<true>{}),
+            crossbow::program_options::value<-8>("redo-log-sync", &storageConfig.redoLogSyncInterval,
+                    crossbow::program_options::tag::ignore_short<true>{}),
+            crossbow::program_options::value<-9>("checkpoint", &storageConfig.checkpointInterval,
+                    crossbow::program_options::tag::ignore_short<true>{}),
+            crossbow::program_options::value<-10>("huge-pages", &hugePages,
+                    crossbow::program_options::tag::ignore_short<true>{}),
+            crossbow::program_options::value<-11>("hash-map-per-table", &storageConfig.hashMapPerTable,
+                    crossbow::program_options::tag::ignore_short<true>{}),
+            crossbow::program_options::value<-12>("snapshot-cache", &serverConfig.snapshotCacheCapacity,
+                    crossbow::program_options::tag::ignore_short<true>{}),
+            crossbow::program_options::value<-13>("scan-round", &storageConfig.scanRoundSize,
+                    crossbow::program_options::tag::ignore_short<true>{}),
+            crossbow::program_options::value<-14>("redo-log-commit-sync", &storageConfig.redoLogSyncOnCommit,
                     crossbow::program_options::tag::ignore_short<true>{}));
 
     try {
@@ -65,6 +88,17 @@ int main(int argc, const char** argv) {
         return 0;
     }
 
+    if (hugePages == "none") {
+        storageConfig.hugePages = tell::store::HugePageMode::NONE;
+    } else if (hugePages == "transparent") {
+        storageConfig.hugePages = tell::store::HugePageMode::TRANSPARENT;
+    } else if (hugePages == "explicit") {
+        storageConfig.hugePages = tell::store::HugePageMode::EXPLICIT;
+    } else {
+        std::cerr << "Huge page mode must be one of none, transparent or explicit" << std::endl;
+        return 1;
+    }
+
     crossbow::infinio::InfinibandLimits infinibandLimits;
     infinibandLimits.receiveBufferCount = 1024;
     infinibandLimits.sendBufferCount = 256;
@@ -78,10 +112,28 @@ int main(int argc, const char** argv) {
     LOG_INFO("--- Backend: %1%", tell::store::Storage::implementationName());
     LOG_INFO("--- Port: %1%", serverConfig.port);
     LOG_INFO("--- Network Threads: %1%", serverConfig.numNetworkThreads);
+    LOG_INFO("--- Snapshot Cache Capacity: %1%", serverConfig.snapshotCacheCapacity);
     LOG_INFO("--- GC Interval: %1%s", storageConfig.gcInterval);
     LOG_INFO("--- Total Memory: %1%GB", double(storageConfig.totalMemory) / double(1024 * 1024 * 1024));
+    LOG_INFO("--- Huge Pages: %1%", tell::store::hugePageModeName(storageConfig.hugePages));
     LOG_INFO("--- Scan Threads: %1%", storageConfig.numScanThreads);
-    LOG_INFO("--- Hash Map Capacity: %1%", storageConfig.hashMapCapacity);
+    LOG_INFO("--- Hash Map Capacity: %1% (%2%)", storageConfig.hashMapCapacity,
+            (storageConfig.hashMapPerTable ? "per table" : "shared"));
+    LOG_INFO("--- Scan Code Cache Capacity: %1%", storageConfig.scanCodeCacheCapacity);
+    LOG_INFO("--- Max Active Scans: %1%", storageConfig.maxActiveScans);
+    LOG_INFO("--- Scan Quantum: %1%", storageConfig.scanQuantum);
+    LOG_INFO("--- Scan Round Size: %1%", storageConfig.scanRoundSize);
+    if (storageConfig.redoLogPath.empty()) {
+        LOG_INFO("--- Redo Log: disabled");
+    } else {
+        LOG_INFO("--- Redo Log: %1% (sync every %2%ms)", storageConfig.redoLogPath, storageConfig.redoLogSyncInterval);
+        LOG_INFO("--- Redo Log Sync On Commit: %1%", (storageConfig.redoLogSyncOnCommit ? "yes" : "no"));
+        if (storageConfig.checkpointInterval == 0u) {
+            LOG_INFO("--- Checkpoint: disabled");
+        } else {
+            LOG_INFO("--- Checkpoint: every %1%s", storageConfig.checkpointInterval);
+        }
+    }
 
     // Initialize allocator
     crossbow::allocator::init();
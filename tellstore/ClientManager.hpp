@@ -43,7 +43,9 @@
 #include <atomic>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <string>
 #include <system_error>
 #include <thread>
 #include <tuple>
@@ -81,6 +83,11 @@ public:
 
     void commit(const commitmanager::SnapshotDescriptor& snapshot);
 
+    /**
+     * @brief Aborts the transaction and reverts all its writes on the TellStore servers
+     */
+    void abort(const commitmanager::SnapshotDescriptor& snapshot);
+
     Table createTable(const crossbow::string& name, Schema schema);
 
     std::shared_ptr<GetTablesResponse> getTables();
@@ -92,6 +99,16 @@ public:
     std::shared_ptr<GetResponse> get(const Table& table, uint64_t key,
             const commitmanager::SnapshotDescriptor& snapshot);
 
+    /**
+     * @brief Reads the tuples of all keys with a single request to every shard owning any of the keys
+     *
+     * @return The responses of the shards, each containing the results of the keys owned by the shard
+     */
+    std::vector<std::shared_ptr<MultiGetResponse>> multiGet(const Table& table, const std::vector<uint64_t>& keys);
+
+    std::vector<std::shared_ptr<MultiGetResponse>> multiGet(const Table& table, const std::vector<uint64_t>& keys,
+            const commitmanager::SnapshotDescriptor& snapshot);
+
     std::shared_ptr<ModificationResponse> insert(const Table& table, uint64_t key, uint64_t version, GenericTuple data);
 
     std::shared_ptr<ModificationResponse> insert(const Table& table, uint64_t key, uint64_t version,
@@ -122,9 +139,55 @@ public:
     std::shared_ptr<ModificationResponse> revert(const Table& table, uint64_t key,
             const commitmanager::SnapshotDescriptor& snapshot);
 
+    /**
+     * @brief Executes all modifications with a single request to every shard owning any of the modified keys
+     *
+     * @return The responses of the shards, each containing the results of the modifications sent to the shard
+     */
+    std::vector<std::shared_ptr<BatchWriteResponse>> batchWrite(const std::vector<BatchWriteOperation>& batch,
+            const commitmanager::SnapshotDescriptor& snapshot);
+
+    /**
+     * @brief Reads all tuples whose values of the index fields lie in the range [lower, upper] from every shard
+     *
+     * The bounds contain the values of the leading fields of the index, the remaining fields are not restricted. An
+     * empty bound leaves the range open on that side.
+     *
+     * @return The responses of the shards, each containing the tuples in the range owned by the shard in index order
+     */
+    std::vector<std::shared_ptr<IndexScanResponse>> indexScan(const Table& table, const crossbow::string& indexName,
+            const GenericTuple& lower, const GenericTuple& upper);
+
+    std::vector<std::shared_ptr<IndexScanResponse>> indexScan(const Table& table, const crossbow::string& indexName,
+            const GenericTuple& lower, const GenericTuple& upper, const commitmanager::SnapshotDescriptor& snapshot);
+
+    /**
+     * @brief Reads all tuples with the given values of the index fields from every shard
+     */
+    std::vector<std::shared_ptr<IndexScanResponse>> indexLookup(const Table& table, const crossbow::string& indexName,
+            const GenericTuple& values, const commitmanager::SnapshotDescriptor& snapshot) {
+        return indexScan(table, indexName, values, values, snapshot);
+    }
+
+    /**
+     * @brief Starts a scan over the table on every shard
+     *
+     * The scan can be restricted to the keys in the range [lowKey, highKey), the maximum 64 bit value as highKey
+     * denotes a range without upper bound. Only the main pages whose keys overlap the range are scanned.
+     *
+     * Group by queries return one tuple (with key 0) per group and shard containing the group by columns followed by
+     * the aggregations.
+     *
+     * Full and projection scans can be limited to return at most limit tuples per shard (a limit of 0 denotes no
+     * limit). If an order is given only the tuples with the smallest (or largest) values in the orderField column of
+     * the result record are returned in order. The order column must be a fixed size numeric column, tuples where it
+     * is NULL are ordered last.
+     */
     std::shared_ptr<ScanIterator> scan(const Table& table, const commitmanager::SnapshotDescriptor& snapshot,
             ScanMemoryManager& memoryManager, ScanQueryType queryType, uint32_t selectionLength, const char* selection,
-            uint32_t queryLength, const char* query);
+            uint32_t queryLength, const char* query, uint64_t lowKey = 0x0u,
+            uint64_t highKey = std::numeric_limits<uint64_t>::max(), uint64_t limit = 0x0u,
+            ScanOrder order = ScanOrder::NONE, uint16_t orderField = 0u);
 
 private:
     BaseClientProcessor& mProcessor;
@@ -142,6 +205,8 @@ public:
 
     void commit(crossbow::infinio::Fiber& fiber, const commitmanager::SnapshotDescriptor& snapshot);
 
+    void abort(crossbow::infinio::Fiber& fiber, const commitmanager::SnapshotDescriptor& snapshot);
+
     Table createTable(crossbow::infinio::Fiber& fiber, const crossbow::string& name, Schema schema);
 
     std::shared_ptr<GetTablesResponse> getTables(crossbow::infinio::Fiber& fiber) {
@@ -157,6 +222,9 @@ public:
         return shard(key)->get(fiber, tableId, key, snapshot);
     }
 
+    std::vector<std::shared_ptr<MultiGetResponse>> multiGet(crossbow::infinio::Fiber& fiber, uint64_t tableId,
+            const std::vector<uint64_t>& keys, const commitmanager::SnapshotDescriptor& snapshot);
+
     std::shared_ptr<ModificationResponse> insert(crossbow::infinio::Fiber& fiber, uint64_t tableId, uint64_t key,
             const commitmanager::SnapshotDescriptor& snapshot, const AbstractTuple& tuple) {
         return shard(key)->insert(fiber, tableId, key, snapshot, tuple);
@@ -177,10 +245,18 @@ public:
         return shard(key)->revert(fiber, tableId, key, snapshot);
     }
 
+    std::vector<std::shared_ptr<BatchWriteResponse>> batchWrite(crossbow::infinio::Fiber& fiber,
+            const std::vector<BatchWriteOperation>& batch, const commitmanager::SnapshotDescriptor& snapshot);
+
+    std::vector<std::shared_ptr<IndexScanResponse>> indexScan(crossbow::infinio::Fiber& fiber, uint64_t tableId,
+            const crossbow::string& indexName, const std::string& lower, const std::string& upper,
+            const commitmanager::SnapshotDescriptor& snapshot);
+
     std::shared_ptr<ScanIterator> scan(crossbow::infinio::Fiber& fiber, uint64_t tableId,
             const commitmanager::SnapshotDescriptor& snapshot, Record record, ScanMemoryManager& memoryManager,
             ScanQueryType queryType, uint32_t selectionLength, const char* selection, uint32_t queryLength,
-            const char* query);
+            const char* query, uint64_t lowKey, uint64_t highKey, uint64_t limit, ScanOrder order,
+            uint16_t orderField);
 
 protected:
     BaseClientProcessor(crossbow::infinio::InfinibandService& service, const ClientConfig& config,
@@ -195,6 +271,12 @@ protected:
     }
 
 private:
+    /**
+     * @brief Sends the commit request for the transaction to all shards the transaction interacted with
+     */
+    std::vector<std::shared_ptr<CommitResponse>> completeTransaction(crossbow::infinio::Fiber& fiber,
+            const commitmanager::SnapshotDescriptor& snapshot, bool commit);
+
     /**
      * @brief The socket associated with the shard for the given table and key
      */
@@ -38,8 +38,11 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <system_error>
 #include <tuple>
+#include <unordered_set>
+#include <vector>
 
 namespace tell {
 namespace commitmanager {
@@ -144,6 +147,44 @@ private:
     void processResponse(crossbow::buffer_reader& message);
 };
 
+/**
+ * @brief Response for a Multi-Get request
+ *
+ * Contains the error code and tuple for every requested key in the order of the keys. The tuple is null if the lookup
+ * of the key failed.
+ */
+class MultiGetResponse final : public crossbow::infinio::RpcResponseResult<MultiGetResponse,
+        std::vector<std::tuple<std::error_code, std::unique_ptr<Tuple>>>> {
+    using Base = crossbow::infinio::RpcResponseResult<MultiGetResponse,
+            std::vector<std::tuple<std::error_code, std::unique_ptr<Tuple>>>>;
+
+public:
+    MultiGetResponse(crossbow::infinio::Fiber& fiber, std::vector<uint64_t> keys)
+            : Base(fiber),
+              mKeys(std::move(keys)) {
+    }
+
+    /**
+     * @brief The keys requested from the remote server
+     */
+    const std::vector<uint64_t>& keys() const {
+        return mKeys;
+    }
+
+private:
+    friend Base;
+
+    static constexpr ResponseType MessageType = ResponseType::MULTI_GET;
+
+    static const std::error_category& errorCategory() {
+        return error::get_error_category();
+    }
+
+    void processResponse(crossbow::buffer_reader& message);
+
+    std::vector<uint64_t> mKeys;
+};
+
 /**
  * @brief Response for a Modificatoin (insert, update, remove, revert) request
  */
@@ -165,6 +206,107 @@ private:
     void processResponse(crossbow::buffer_reader& message);
 };
 
+/**
+ * @brief Response for a Commit request
+ */
+class CommitResponse final : public crossbow::infinio::RpcResponseResult<CommitResponse, void> {
+    using Base = crossbow::infinio::RpcResponseResult<CommitResponse, void>;
+
+public:
+    using Base::Base;
+
+private:
+    friend Base;
+
+    static constexpr ResponseType MessageType = ResponseType::COMMIT;
+
+    static const std::error_category& errorCategory() {
+        return error::get_error_category();
+    }
+
+    void processResponse(crossbow::buffer_reader& message);
+};
+
+/**
+ * @brief A single modification sent as part of a batch write
+ */
+struct BatchWriteOperation {
+    BatchWriteOperation(WriteType t, uint64_t table, uint64_t k, const AbstractTuple* tup = nullptr)
+            : type(t),
+              tableId(table),
+              key(k),
+              tuple(tup) {
+    }
+
+    WriteType type;
+    uint64_t tableId;
+    uint64_t key;
+
+    /// The tuple to write (null for remove and revert)
+    const AbstractTuple* tuple;
+};
+
+/**
+ * @brief Response for a Batch-Write request
+ *
+ * Contains the error code of every modification sent to the remote server in the order of the modifications.
+ */
+class BatchWriteResponse final
+        : public crossbow::infinio::RpcResponseResult<BatchWriteResponse, std::vector<std::error_code>> {
+    using Base = crossbow::infinio::RpcResponseResult<BatchWriteResponse, std::vector<std::error_code>>;
+
+public:
+    BatchWriteResponse(crossbow::infinio::Fiber& fiber, std::vector<size_t> operations)
+            : Base(fiber),
+              mOperations(std::move(operations)) {
+    }
+
+    /**
+     * @brief Index of the modifications sent to the remote server in the batch passed by the user
+     */
+    const std::vector<size_t>& operations() const {
+        return mOperations;
+    }
+
+private:
+    friend Base;
+
+    static constexpr ResponseType MessageType = ResponseType::BATCH_WRITE;
+
+    static const std::error_category& errorCategory() {
+        return error::get_error_category();
+    }
+
+    void processResponse(crossbow::buffer_reader& message);
+
+    std::vector<size_t> mOperations;
+};
+
+/**
+ * @brief Response for an Index-Scan request
+ *
+ * Contains the key and tuple of every record in the index range on the remote server in the order of the index.
+ */
+class IndexScanResponse final : public crossbow::infinio::RpcResponseResult<IndexScanResponse,
+        std::vector<std::tuple<uint64_t, std::unique_ptr<Tuple>>>> {
+    using Base = crossbow::infinio::RpcResponseResult<IndexScanResponse,
+            std::vector<std::tuple<uint64_t, std::unique_ptr<Tuple>>>>;
+
+public:
+    using Base::Base;
+
+private:
+    friend Base;
+
+    static constexpr ResponseType MessageType = ResponseType::INDEX_SCAN;
+
+    static const std::error_category& errorCategory() {
+        return error::get_error_category();
+    }
+
+    void processResponse(crossbow::buffer_reader& message);
+};
+
 /**
  * @brief Response for a Scan request
  */
@@ -310,6 +452,9 @@ public:
     std::shared_ptr<GetResponse> get(crossbow::infinio::Fiber& fiber, uint64_t tableId, uint64_t key,
             const commitmanager::SnapshotDescriptor& snapshot);
 
+    std::shared_ptr<MultiGetResponse> multiGet(crossbow::infinio::Fiber& fiber, uint64_t tableId,
+            std::vector<uint64_t> keys, const commitmanager::SnapshotDescriptor& snapshot);
+
     std::shared_ptr<ModificationResponse> insert(crossbow::infinio::Fiber& fiber, uint64_t tableId, uint64_t key,
             const commitmanager::SnapshotDescriptor& snapshot, const AbstractTuple& tuple);
 
@@ -322,8 +467,27 @@ public:
     std::shared_ptr<ModificationResponse> revert(crossbow::infinio::Fiber& fiber, uint64_t tableId, uint64_t key,
             const commitmanager::SnapshotDescriptor& snapshot);
 
+    std::shared_ptr<BatchWriteResponse> batchWrite(crossbow::infinio::Fiber& fiber,
+            const std::vector<BatchWriteOperation>& batch, std::vector<size_t> operations,
+            const commitmanager::SnapshotDescriptor& snapshot);
+
+    std::shared_ptr<IndexScanResponse> indexScan(crossbow::infinio::Fiber& fiber, uint64_t tableId,
+            const crossbow::string& indexName, const std::string& lower, const std::string& upper,
+            const commitmanager::SnapshotDescriptor& snapshot);
+
+    /**
+     * @brief Notifies the server that the transaction of the snapshot has completed
+     *
+     * If the transaction aborted the server reverts all tuples the transaction wrote over this connection.
+     *
+     * @return The pending response or null if the snapshot was never sent to the server over this connection
+     */
+    std::shared_ptr<CommitResponse> commit(crossbow::infinio::Fiber& fiber,
+            const commitmanager::SnapshotDescriptor& snapshot, bool commit);
+
     void scanStart(uint16_t scanId, std::shared_ptr<ScanResponse> response, uint64_t tableId, ScanQueryType queryType,
-            uint32_t selectionLength, const char* selection, uint32_t queryLength, const char* query,
+            uint32_t selectionLength, const char* selection, uint32_t queryLength, const char* query, uint64_t lowKey,
+            uint64_t highKey, uint64_t limit, ScanOrder order, uint16_t orderField,
             const commitmanager::SnapshotDescriptor& snapshot);
 
     void scanProgress(uint16_t scanId, std::shared_ptr<ScanResponse> response, size_t offset);
@@ -331,6 +495,19 @@ public:
     void scanComplete(uint16_t scanId) {
         completeAsyncRequest(scanId);
     }
+
+private:
+    /**
+     * @brief Marks the snapshot as cached on the server
+     *
+     * Snapshots of transactions older than the lowest active version have completed and are forgotten.
+     *
+     * @return Whether the snapshot is not yet cached on the server and the full descriptor has to be sent
+     */
+    bool cacheSnapshot(const commitmanager::SnapshotDescriptor& snapshot);
+
+    /// Versions of the snapshots already sent to the server over this connection
+    std::unordered_set<uint64_t> mCachedSnapshots;
 };
 
 } // namespace store
@@ -66,6 +66,9 @@ enum errors {
 
     /// Write operation unable to complete.
     invalid_write,
+
+    /// Secondary index does not exist.
+    invalid_index,
 };
 
 /**
@@ -112,6 +115,9 @@ public:
         case invalid_write:
             return "Write operation unable to complete";
 
+        case invalid_index:
+            return "Secondary index does not exist";
+
         default:
             return "tell.store.server error";
         }
@@ -50,6 +50,9 @@ enum class RequestType : uint32_t {
     SCAN,
     SCAN_PROGRESS,
     COMMIT,
+    MULTI_GET,
+    BATCH_WRITE,
+    INDEX_SCAN,
 };
 
 /**
@@ -63,6 +66,9 @@ enum class ResponseType : uint32_t {
     MODIFICATION,
     SCAN,
     COMMIT,
+    MULTI_GET,
+    BATCH_WRITE,
+    INDEX_SCAN,
 };
 
 } // namespace store
@@ -33,6 +33,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <cstring>
+#include <string>
 #include <type_traits>
 #include <vector>
 #include <unordered_map>
@@ -495,6 +496,22 @@ public:
     bool create(char* result, const GenericTuple& tuple, uint32_t recSize) const;
     char* create(const GenericTuple& tuple, size_t& size) const;
 
+    /**
+     * @brief Encodes the values of the given fields of the record into a secondary index key
+     *
+     * The encoding preserves the order of the values: Comparing two keys with memcmp yields the same order as comparing
+     * the values field by field. NULL values are ordered before all other values.
+     */
+    std::string indexKey(const char* ptr, const std::vector<id_t>& fields) const;
+
+    /**
+     * @brief Encodes the values of the given fields from the tuple into a secondary index key
+     *
+     * The encoding stops at the first field without a value in the tuple. The resulting key is a prefix of the keys of
+     * all records starting with the given values and can be used as bound for a range over the leading fields.
+     */
+    std::string indexKey(const GenericTuple& tuple, const std::vector<id_t>& fields) const;
+
     size_t fieldCount() const {
         return mFieldMetaData.size();
     }
@@ -57,7 +57,9 @@ enum class PredicateType : uint8_t {
     POSTFIX_LIKE,
     POSTFIX_NOT_LIKE,
     IS_NULL,
-    IS_NOT_NULL
+    IS_NOT_NULL,
+    IN_LIST,
+    BETWEEN
 };
 
 enum class AggregationType : uint8_t {
@@ -67,10 +69,24 @@ enum class AggregationType : uint8_t {
     CNT,
 };
 
+enum class WriteType : uint8_t {
+    INSERT = 0x1u,
+    UPDATE,
+    REMOVE,
+    REVERT,
+};
+
 enum ScanQueryType : uint8_t {
     FULL = 0x1u,
     PROJECTION,
     AGGREGATION,
+    GROUP_BY,
+};
+
+enum class ScanOrder : uint8_t {
+    NONE = 0x0u,
+    ASCENDING,
+    DESCENDING,
 };
 
 } // namespace store
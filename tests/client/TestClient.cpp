@@ -22,6 +22,7 @@
  */
 #include <tellstore/ClientConfig.hpp>
 #include <tellstore/ClientManager.hpp>
+#include <tellstore/ErrorCode.hpp>
 #include <tellstore/GenericTuple.hpp>
 #include <tellstore/Record.hpp>
 #include <tellstore/ScanMemory.hpp>
@@ -92,6 +93,8 @@ private:
 
     void executeTransaction(ClientHandle& client, uint64_t startKey, uint64_t endKey, bool check);
 
+    void executeAbort(ClientHandle& client, uint64_t startKey, uint64_t endKey);
+
     void executeScan(ClientHandle& handle, float selectivity, bool check);
 
     void executeProjection(ClientHandle& client, float selectivity, bool check);
@@ -146,6 +149,10 @@ void TestClient::run(bool check) {
     }
     runner.wait();
 
+    LOG_INFO("Starting test abort transaction");
+    TransactionRunner::executeBlocking(mManager, std::bind(&TestClient::executeAbort, this, std::placeholders::_1,
+            mNumTransactions * mNumTuple, (mNumTransactions + 1) * mNumTuple));
+
     LOG_INFO("Starting test scan transaction(s)");
     TransactionRunner::executeBlocking(mManager, std::bind(&TestClient::executeScan, this, std::placeholders::_1, 1.0,
             check));
@@ -285,6 +292,41 @@ void TestClient::executeTransaction(ClientHandle& client, uint64_t startKey, uin
              std::chrono::duration_cast<std::chrono::microseconds>(getTimer.total()).count() / (endKey - startKey));
 }
 
+void TestClient::executeAbort(ClientHandle& client, uint64_t startKey, uint64_t endKey) {
+    auto snapshot = client.startTransaction();
+    LOG_INFO("TID %1%] Started abort transaction", snapshot->version());
+
+    for (auto key = startKey; key < endKey; ++key) {
+        auto insertFuture = client.insert(mTable, key, *snapshot, mTuple[key % mTuple.size()]);
+        if (auto ec = insertFuture->error()) {
+            LOG_ERROR("Error inserting tuple [error = %1% %2%]", ec, ec.message());
+            return;
+        }
+    }
+
+    // All inserted tuples are reverted on the servers with a single request per shard
+    auto startTime = std::chrono::steady_clock::now();
+    client.abort(*snapshot);
+    auto endTime = std::chrono::steady_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    LOG_INFO("TID %1%] Abort of %2% tuples took %3%us", snapshot->version(), endKey - startKey, duration.count());
+
+    auto checkSnapshot = client.startTransaction(TransactionType::READ_ONLY);
+    for (auto key = startKey; key < endKey; ++key) {
+        auto getFuture = client.get(mTable, key, *checkSnapshot);
+        if (getFuture->waitForResult()) {
+            LOG_ERROR("Tuple %1% still exists after the abort", key);
+            break;
+        }
+        auto& ec = getFuture->error();
+        if (ec != error::not_found) {
+            LOG_ERROR("Error getting tuple [error = %1% %2%]", ec, ec.message());
+            break;
+        }
+    }
+    client.commit(*checkSnapshot);
+}
+
 void TestClient::executeScan(ClientHandle& client, float selectivity, bool check) {
     LOG_TRACE("Starting transaction");
     auto& fiber = client.fiber();
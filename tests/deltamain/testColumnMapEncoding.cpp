@@ -0,0 +1,541 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include <deltamain/DeltaMainRewriteStore.hpp>
+#include <deltamain/colstore/ColumnMapEncoding.hpp>
+
+#include "../DummyCommitManager.hpp"
+
+#include <util/EmbeddedStore.hpp>
+
+#include <tellstore/Record.hpp>
+
+#include <crossbow/alignment.hpp>
+#include <crossbow/allocator.hpp>
+#include <crossbow/byte_buffer.hpp>
+#include <crossbow/enum_underlying.hpp>
+#include <crossbow/string.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace tell;
+using namespace tell::store;
+using namespace tell::store::deltamain;
+
+namespace {
+
+/**
+ * @brief Writes the values into a column buffer and encodes it
+ */
+template <typename T>
+ColumnEncoding encodeValues(const std::vector<T>& values, FieldType type, std::vector<char>& column) {
+    column.resize(values.size() * sizeof(T));
+    memcpy(column.data(), values.data(), column.size());
+    return encodeFixedColumn(column.data(), static_cast<uint32_t>(values.size()), type, sizeof(T));
+}
+
+/**
+ * @brief Decodes the elements [startIdx, endIdx) of the encoded column
+ */
+template <typename T>
+std::vector<T> decodeValues(const std::vector<char>& column, uint32_t count, uint32_t startIdx, uint32_t endIdx) {
+    std::vector<T> values(endIdx - startIdx);
+    decodeFixedColumn(column.data(), count, sizeof(T), startIdx, endIdx, reinterpret_cast<char*>(values.data()));
+    return values;
+}
+
+/**
+ * @class ColumnMapEncoding
+ * @test Check if integer columns with a small value range are packed relative to their smallest value
+ */
+TEST(ColumnMapEncodingTest, frameOfReference) {
+    std::vector<int64_t> values;
+    for (int64_t i = 0; i < 1000; ++i) {
+        values.emplace_back(-500 + (i * 7) % 1000);
+    }
+
+    std::vector<char> column;
+    ASSERT_EQ(ColumnEncoding::FRAME_OF_REFERENCE, encodeValues(values, FieldType::BIGINT, column));
+
+    auto header = ColumnMapEncodedColumn::fromColumn(column.data());
+    EXPECT_EQ(2u, header->width);
+    EXPECT_EQ(-500, static_cast<int64_t>(header->base));
+
+    EXPECT_EQ(values, decodeValues<int64_t>(column, 1000u, 0u, 1000u));
+}
+
+/**
+ * @class ColumnMapEncoding
+ * @test Check if columns with few distinct values in no particular order are dictionary encoded
+ */
+TEST(ColumnMapEncodingTest, dictionary) {
+    std::vector<double> values;
+    for (uint32_t i = 0; i < 1000u; ++i) {
+        values.emplace_back(static_cast<double>((i * 13u) % 5u) * 1.5);
+    }
+
+    std::vector<char> column;
+    ASSERT_EQ(ColumnEncoding::DICTIONARY, encodeValues(values, FieldType::DOUBLE, column));
+    EXPECT_EQ(5u, ColumnMapEncodedColumn::fromColumn(column.data())->valueCount);
+
+    EXPECT_EQ(values, decodeValues<double>(column, 1000u, 0u, 1000u));
+}
+
+/**
+ * @class ColumnMapEncoding
+ * @test Check if columns with long runs of equal values are run length encoded and can be decoded from within a run
+ */
+TEST(ColumnMapEncodingTest, runLength) {
+    std::vector<int32_t> values;
+    for (int32_t i = 0; i < 1000; ++i) {
+        values.emplace_back((i / 100) * 100000000);
+    }
+
+    std::vector<char> column;
+    ASSERT_EQ(ColumnEncoding::RUN_LENGTH, encodeValues(values, FieldType::INT, column));
+    EXPECT_EQ(10u, ColumnMapEncodedColumn::fromColumn(column.data())->valueCount);
+
+    EXPECT_EQ(values, decodeValues<int32_t>(column, 1000u, 0u, 1000u));
+    EXPECT_EQ(std::vector<int32_t>(values.begin() + 150, values.begin() + 420),
+            decodeValues<int32_t>(column, 1000u, 150u, 420u)) << "Decoding must start in the middle of a run";
+    EXPECT_EQ(std::vector<int32_t>(values.begin() + 200, values.begin() + 201),
+            decodeValues<int32_t>(column, 1000u, 200u, 201u)) << "Decoding must start at the first element of a run";
+}
+
+/**
+ * @class ColumnMapEncoding
+ * @test Check if columns no encoding can compress are left untouched
+ */
+TEST(ColumnMapEncodingTest, rawFallback) {
+    std::vector<int64_t> values;
+    for (int64_t i = 0; i < 1000; ++i) {
+        values.emplace_back(i * 0x100000000ll + (i % 3));
+    }
+
+    std::vector<char> column;
+    EXPECT_EQ(ColumnEncoding::RAW, encodeValues(values, FieldType::BIGINT, column));
+    EXPECT_EQ(0, memcmp(values.data(), column.data(), column.size()));
+
+    std::vector<int32_t> single({42});
+    EXPECT_EQ(ColumnEncoding::RAW, encodeValues(single, FieldType::INT, column))
+            << "Encoded column must not exceed the space of the raw column";
+}
+
+/**
+ * @brief Serializes the INT predicates into a selection with every predicate in its own conjunct
+ */
+std::unique_ptr<char[]> createSelection(std::vector<std::tuple<Record::id_t, PredicateType, int32_t>> predicates,
+        size_t& selectionLength) {
+    std::stable_sort(predicates.begin(), predicates.end(), [] (
+            const std::tuple<Record::id_t, PredicateType, int32_t>& lhs,
+            const std::tuple<Record::id_t, PredicateType, int32_t>& rhs) {
+        return std::get<0>(lhs) < std::get<0>(rhs);
+    });
+
+    uint32_t numColumns = 0u;
+    for (decltype(predicates.size()) i = 0; i < predicates.size(); ++i) {
+        if (i == 0 || std::get<0>(predicates[i]) != std::get<0>(predicates[i - 1])) {
+            ++numColumns;
+        }
+    }
+
+    selectionLength = 16u + numColumns * 8u + predicates.size() * 8u;
+    std::unique_ptr<char[]> selection(new char[selectionLength]);
+    memset(selection.get(), 0, selectionLength);
+    crossbow::buffer_writer writer(selection.get(), selectionLength);
+    writer.write<uint32_t>(numColumns);
+    writer.write<uint16_t>(static_cast<uint16_t>(predicates.size()));
+    writer.write<uint16_t>(0x0u);
+    writer.write<uint32_t>(0x0u);
+    writer.write<uint32_t>(0x0u);
+    for (decltype(predicates.size()) i = 0; i < predicates.size();) {
+        auto column = std::get<0>(predicates[i]);
+        auto end = i;
+        while (end < predicates.size() && std::get<0>(predicates[end]) == column) {
+            ++end;
+        }
+        writer.write<uint16_t>(column);
+        writer.write<uint16_t>(static_cast<uint16_t>(end - i));
+        writer.align(sizeof(uint64_t));
+        for (; i != end; ++i) {
+            writer.write<uint8_t>(crossbow::to_underlying(std::get<1>(predicates[i])));
+            writer.write<uint8_t>(static_cast<uint8_t>(i));
+            writer.align(sizeof(uint32_t));
+            writer.write<int32_t>(std::get<2>(predicates[i]));
+        }
+    }
+    return selection;
+}
+
+/**
+ * @brief Serializes a single predicate on a TEXT column into a selection
+ */
+std::unique_ptr<char[]> createTextSelection(Record::id_t column, PredicateType type, const crossbow::string& value,
+        size_t& selectionLength) {
+    selectionLength = 32u + crossbow::align(value.size(), 8u);
+    std::unique_ptr<char[]> selection(new char[selectionLength]);
+    memset(selection.get(), 0, selectionLength);
+
+    crossbow::buffer_writer writer(selection.get(), selectionLength);
+    writer.write<uint32_t>(0x1u);
+    writer.write<uint16_t>(0x1u);
+    writer.write<uint16_t>(0x0u);
+    writer.write<uint32_t>(0x0u);
+    writer.write<uint32_t>(0x0u);
+    writer.write<uint16_t>(column);
+    writer.write<uint16_t>(0x1u);
+    writer.align(sizeof(uint64_t));
+    writer.write<uint8_t>(crossbow::to_underlying(type));
+    writer.write<uint8_t>(0x0u);
+    writer.align(sizeof(uint32_t));
+    writer.write<uint32_t>(static_cast<uint32_t>(value.size()));
+    writer.write(value.data(), value.size());
+    return selection;
+}
+
+class ColumnMapEncodingScanTest : public ::testing::Test {
+protected:
+    static constexpr uint64_t TUPLE_COUNT = 1000u;
+
+    ColumnMapEncodingScanTest()
+            : mSchema(TableType::TRANSACTIONAL),
+              mStore(createConfig(), 0x1000u),
+              mTableId(0u) {
+        mSchema.addField(FieldType::INT, "run", true);
+        mSchema.addField(FieldType::INT, "code", true);
+        mSchema.addField(FieldType::INT, "offset", true);
+        mSchema.addField(FieldType::DOUBLE, "raw", true);
+        mSchema.addField(FieldType::TEXT, "status", true);
+        mRecord = Record(mSchema);
+        mRecord.idOf("run", mRunField);
+        mRecord.idOf("code", mCodeField);
+        mRecord.idOf("offset", mOffsetField);
+        mRecord.idOf("raw", mRawField);
+        mRecord.idOf("status", mStatusField);
+    }
+
+    static StorageConfig createConfig() {
+        StorageConfig config;
+        config.totalMemory = 0x10000000ull;
+        config.numScanThreads = 1u;
+        config.hashMapCapacity = 0x100000ull;
+        return config;
+    }
+
+    static int32_t runOf(uint64_t key) {
+        return static_cast<int32_t>(key / 100u);
+    }
+
+    static int32_t codeOf(uint64_t key) {
+        return static_cast<int32_t>(key % 7u) * 1000000;
+    }
+
+    static int32_t offsetOf(uint64_t key) {
+        return 100000 + static_cast<int32_t>(key) * 3;
+    }
+
+    static double rawOf(uint64_t key) {
+        return static_cast<double>(key) * 0.5;
+    }
+
+    static crossbow::string statusOf(uint64_t key) {
+        static const crossbow::string statuses[] = {"pending", "active", "closed", "archived", "blocked"};
+        return statuses[key % 5u];
+    }
+
+    /**
+     * @brief Inserts the tuples [1, TUPLE_COUNT] and moves them into the column map pages
+     *
+     * The run column is run length encoded, the code column dictionary encoded, the offset column frame of reference
+     * encoded and the raw column is left uncompressed. The status column is dictionary encoded as variable size column.
+     */
+    virtual void SetUp() override {
+        ASSERT_TRUE(mStore.createTable("encodingTable", mSchema, mTableId)) << "Creating table failed";
+
+        auto tx = mCommitManager.startTx();
+        for (uint64_t key = 1u; key <= TUPLE_COUNT; ++key) {
+            size_t size;
+            std::unique_ptr<char[]> rec(mRecord.create(GenericTuple({
+                    std::make_pair<crossbow::string, boost::any>("run", runOf(key)),
+                    std::make_pair<crossbow::string, boost::any>("code", codeOf(key)),
+                    std::make_pair<crossbow::string, boost::any>("offset", offsetOf(key)),
+                    std::make_pair<crossbow::string, boost::any>("raw", rawOf(key)),
+                    std::make_pair<crossbow::string, boost::any>("status", statusOf(key))
+            }), size));
+            ASSERT_EQ(0, mStore.insert(mTableId, key, size, rec.get(), tx));
+        }
+        tx.commit();
+        mStore.runGC();
+    }
+
+    /**
+     * @brief Checks if the materialized tuple holds the values of the key
+     */
+    void checkTuple(uint64_t key, const char* data) {
+        bool isNull;
+        EXPECT_EQ(runOf(key), *reinterpret_cast<const int32_t*>(mRecord.data(data, mRunField, isNull)));
+        EXPECT_EQ(codeOf(key), *reinterpret_cast<const int32_t*>(mRecord.data(data, mCodeField, isNull)));
+        EXPECT_EQ(offsetOf(key), *reinterpret_cast<const int32_t*>(mRecord.data(data, mOffsetField, isNull)));
+        EXPECT_EQ(rawOf(key), *reinterpret_cast<const double*>(mRecord.data(data, mRawField, isNull)));
+    }
+
+    /**
+     * @brief Returns the keys of all tuples matching every predicate
+     */
+    std::vector<uint64_t> scanKeys(const commitmanager::SnapshotDescriptor& snapshot,
+            std::vector<std::tuple<Record::id_t, PredicateType, int32_t>> predicates) {
+        size_t selectionLength;
+        auto selection = createSelection(std::move(predicates), selectionLength);
+        return scanKeys(snapshot, std::move(selection), selectionLength);
+    }
+
+    /**
+     * @brief Returns the keys of all tuples matching the predicate on the status column
+     */
+    std::vector<uint64_t> scanStatusKeys(const commitmanager::SnapshotDescriptor& snapshot, PredicateType type,
+            const crossbow::string& value) {
+        size_t selectionLength;
+        auto selection = createTextSelection(mStatusField, type, value, selectionLength);
+        return scanKeys(snapshot, std::move(selection), selectionLength);
+    }
+
+    /**
+     * @brief Returns the keys of all tuples matching the selection
+     */
+    std::vector<uint64_t> scanKeys(const commitmanager::SnapshotDescriptor& snapshot,
+            std::unique_ptr<char[]> selection, size_t selectionLength) {
+        std::mutex keysMutex;
+        std::vector<uint64_t> keys;
+        auto ec = mStore.scan(mTableId, snapshot, ScanQueryType::FULL, std::move(selection), selectionLength, nullptr,
+                0u, [this, &keysMutex, &keys] (const char* start, const char* end) {
+            std::unique_lock<decltype(keysMutex)> _(keysMutex);
+            while (start < end) {
+                auto key = *reinterpret_cast<const uint64_t*>(start);
+                start += sizeof(uint64_t);
+                checkTuple(key, start);
+                keys.emplace_back(key);
+                start += mRecord.sizeOfTuple(start);
+            }
+        });
+        EXPECT_EQ(0, ec) << "Scan failed";
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+    /**
+     * @brief Returns the keys in [1, TUPLE_COUNT] satisfying the condition
+     */
+    template <typename Fun>
+    static std::vector<uint64_t> expectedKeys(Fun fun) {
+        std::vector<uint64_t> keys;
+        for (uint64_t key = 1u; key <= TUPLE_COUNT; ++key) {
+            if (fun(key)) {
+                keys.emplace_back(key);
+            }
+        }
+        return keys;
+    }
+
+    crossbow::allocator mAlloc;
+    DummyCommitManager mCommitManager;
+    Schema mSchema;
+    Record mRecord;
+    EmbeddedStore<DeltaMainRewriteColumnStore> mStore;
+    uint64_t mTableId;
+
+    Record::id_t mRunField;
+    Record::id_t mCodeField;
+    Record::id_t mOffsetField;
+    Record::id_t mRawField;
+    Record::id_t mStatusField;
+};
+
+constexpr uint64_t ColumnMapEncodingScanTest::TUPLE_COUNT;
+
+/**
+ * @class LLVMColumnMapScanBuilder
+ * @test Check if predicates on run length, dictionary and frame of reference encoded columns select the right tuples
+ */
+TEST_F(ColumnMapEncodingScanTest, predicates) {
+    auto tx = mCommitManager.startTx();
+
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return runOf(key) == 5; }),
+            scanKeys(tx, {std::make_tuple(mRunField, PredicateType::EQUAL, 5)}));
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return runOf(key) >= 3 && runOf(key) < 8; }),
+            scanKeys(tx, {std::make_tuple(mRunField, PredicateType::GREATER_EQUAL, 3),
+                    std::make_tuple(mRunField, PredicateType::LESS, 8)}));
+
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return codeOf(key) == 3000000; }),
+            scanKeys(tx, {std::make_tuple(mCodeField, PredicateType::EQUAL, 3000000)}));
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return codeOf(key) > 4500000; }),
+            scanKeys(tx, {std::make_tuple(mCodeField, PredicateType::GREATER, 4500000)}));
+
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return offsetOf(key) >= 102970; }),
+            scanKeys(tx, {std::make_tuple(mOffsetField, PredicateType::GREATER_EQUAL, 102970)}));
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return offsetOf(key) != 100300; }),
+            scanKeys(tx, {std::make_tuple(mOffsetField, PredicateType::NOT_EQUAL, 100300)}));
+
+    EXPECT_EQ(expectedKeys([] (uint64_t key) {
+        return runOf(key) == 9 && codeOf(key) != 0 && offsetOf(key) < 102800;
+    }), scanKeys(tx, {std::make_tuple(mRunField, PredicateType::EQUAL, 9),
+            std::make_tuple(mCodeField, PredicateType::NOT_EQUAL, 0),
+            std::make_tuple(mOffsetField, PredicateType::LESS, 102800)}));
+
+    EXPECT_EQ(expectedKeys([] (uint64_t /* key */) { return true; }), scanKeys(tx, {}))
+            << "Every tuple must be materialized with its decoded values";
+    tx.commit();
+}
+
+/**
+ * @class LLVMColumnMapScanBuilder
+ * @test Check if predicates on a dictionary encoded TEXT column select the right tuples
+ */
+TEST_F(ColumnMapEncodingScanTest, textPredicates) {
+    auto tx = mCommitManager.startTx();
+
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return statusOf(key) == "closed"; }),
+            scanStatusKeys(tx, PredicateType::EQUAL, "closed"));
+    EXPECT_EQ(expectedKeys([] (uint64_t /* key */) { return false; }),
+            scanStatusKeys(tx, PredicateType::EQUAL, "missing"));
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return statusOf(key) != "active"; }),
+            scanStatusKeys(tx, PredicateType::NOT_EQUAL, "active"));
+
+    // Matches "active" and "archived"
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return key % 5u == 1u || key % 5u == 3u; }),
+            scanStatusKeys(tx, PredicateType::PREFIX_LIKE, "a"));
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return key % 5u != 1u && key % 5u != 3u; }),
+            scanStatusKeys(tx, PredicateType::PREFIX_NOT_LIKE, "a"));
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return statusOf(key) == "pending"; }),
+            scanStatusKeys(tx, PredicateType::PREFIX_LIKE, "pending"));
+
+    // Matches "closed" and "archived"
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return key % 5u == 2u || key % 5u == 3u; }),
+            scanStatusKeys(tx, PredicateType::POSTFIX_LIKE, "ed"));
+    EXPECT_EQ(expectedKeys([] (uint64_t key) { return key % 5u != 2u && key % 5u != 3u; }),
+            scanStatusKeys(tx, PredicateType::POSTFIX_NOT_LIKE, "ed"));
+    tx.commit();
+}
+
+/**
+ * @class ColumnMapMainPage
+ * @test Check if point lookups return the decoded values
+ */
+TEST_F(ColumnMapEncodingScanTest, get) {
+    auto tx = mCommitManager.startTx();
+    for (auto key : {1u, 99u, 100u, 555u, 999u, 1000u}) {
+        std::string data;
+        uint64_t version;
+        bool isNewest;
+        ASSERT_EQ(0, mStore.get(mTableId, key, tx, data, version, isNewest)) << "Get of key " << key << " failed";
+        checkTuple(key, data.data());
+    }
+    tx.commit();
+}
+
+/**
+ * @class LLVMColumnMapAggregationBuilder
+ * @test Check if aggregations over encoded columns operate on the decoded values
+ */
+TEST_F(ColumnMapEncodingScanTest, aggregation) {
+    Schema resultSchema(TableType::UNKNOWN);
+    resultSchema.addField(FieldType::BIGINT, "sum", false);
+    resultSchema.addField(FieldType::INT, "min", false);
+    resultSchema.addField(FieldType::INT, "max", false);
+    resultSchema.addField(FieldType::BIGINT, "runSum", false);
+    Record resultRecord(std::move(resultSchema));
+
+    Record::id_t sumField, minField, maxField, runSumField;
+    ASSERT_TRUE(resultRecord.idOf("sum", sumField) && resultRecord.idOf("min", minField)
+            && resultRecord.idOf("max", maxField) && resultRecord.idOf("runSum", runSumField)) << "Field not found";
+
+    // Aggregate the tuples with code 2000000
+    size_t selectionLength;
+    auto selection = createSelection({std::make_tuple(mCodeField, PredicateType::EQUAL, 2000000)}, selectionLength);
+
+    size_t aggregationLength = 16u;
+    std::unique_ptr<char[]> aggregation(new char[aggregationLength]);
+    crossbow::buffer_writer aggregationWriter(aggregation.get(), aggregationLength);
+    aggregationWriter.write<uint16_t>(mOffsetField);
+    aggregationWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::SUM));
+    aggregationWriter.write<uint16_t>(mOffsetField);
+    aggregationWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::MIN));
+    aggregationWriter.write<uint16_t>(mOffsetField);
+    aggregationWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::MAX));
+    aggregationWriter.write<uint16_t>(mRunField);
+    aggregationWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::SUM));
+
+    int64_t sum = 0;
+    auto min = std::numeric_limits<int32_t>::max();
+    auto max = std::numeric_limits<int32_t>::min();
+    int64_t runSum = 0;
+    std::mutex resultMutex;
+
+    auto tx = mCommitManager.startTx();
+    auto ec = mStore.scan(mTableId, tx, ScanQueryType::AGGREGATION, std::move(selection), selectionLength,
+            std::move(aggregation), aggregationLength,
+            [&resultRecord, sumField, minField, maxField, runSumField, &resultMutex, &sum, &min, &max, &runSum]
+            (const char* start, const char* end) {
+        std::unique_lock<decltype(resultMutex)> _(resultMutex);
+        while (start < end) {
+            start += sizeof(uint64_t);
+
+            bool isNull;
+            auto value = resultRecord.data(start, sumField, isNull);
+            if (!isNull) {
+                sum += *reinterpret_cast<const int64_t*>(value);
+                min = std::min(min, *reinterpret_cast<const int32_t*>(resultRecord.data(start, minField, isNull)));
+                max = std::max(max, *reinterpret_cast<const int32_t*>(resultRecord.data(start, maxField, isNull)));
+                runSum += *reinterpret_cast<const int64_t*>(resultRecord.data(start, runSumField, isNull));
+            }
+            start += resultRecord.staticSize();
+        }
+    });
+    EXPECT_EQ(0, ec) << "Scan failed";
+    tx.commit();
+
+    int64_t expectedSum = 0;
+    auto expectedMin = std::numeric_limits<int32_t>::max();
+    auto expectedMax = std::numeric_limits<int32_t>::min();
+    int64_t expectedRunSum = 0;
+    for (auto key : expectedKeys([] (uint64_t key) { return codeOf(key) == 2000000; })) {
+        expectedSum += offsetOf(key);
+        expectedMin = std::min(expectedMin, offsetOf(key));
+        expectedMax = std::max(expectedMax, offsetOf(key));
+        expectedRunSum += runOf(key);
+    }
+    EXPECT_EQ(expectedSum, sum);
+    EXPECT_EQ(expectedMin, min);
+    EXPECT_EQ(expectedMax, max);
+    EXPECT_EQ(expectedRunSum, runSum);
+}
+
+} // anonymous namespace
@@ -0,0 +1,672 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include <deltamain/DeltaMainRewriteStore.hpp>
+#include <deltamain/colstore/ColumnMapContext.hpp>
+#include <deltamain/colstore/ColumnMapEncoding.hpp>
+#include <deltamain/colstore/ColumnMapPage.hpp>
+#include <deltamain/colstore/ColumnMapZoneMap.hpp>
+
+#include "../DummyCommitManager.hpp"
+
+#include <util/EmbeddedStore.hpp>
+#include <util/LocalScanQuery.hpp>
+#include <util/PageManager.hpp>
+
+#include <tellstore/Record.hpp>
+
+#include <crossbow/alignment.hpp>
+#include <crossbow/allocator.hpp>
+#include <crossbow/byte_buffer.hpp>
+#include <crossbow/enum_underlying.hpp>
+#include <crossbow/string.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+using namespace tell;
+using namespace tell::store;
+using namespace tell::store::deltamain;
+
+namespace {
+
+/**
+ * @brief A single predicate of a selection: The conjunct it belongs to, the column, its type and the value
+ */
+struct TestPredicate {
+    TestPredicate(uint8_t _conjunct, Record::id_t _column, PredicateType _type, double _value = 0.0)
+            : conjunct(_conjunct),
+              column(_column),
+              type(_type),
+              value(_value) {
+    }
+
+    TestPredicate(uint8_t _conjunct, Record::id_t _column, PredicateType _type, crossbow::string _text)
+            : conjunct(_conjunct),
+              column(_column),
+              type(_type),
+              value(0.0),
+              text(std::move(_text)) {
+    }
+
+    uint8_t conjunct;
+    Record::id_t column;
+    PredicateType type;
+    double value;
+    crossbow::string text;
+};
+
+/**
+ * @brief Serializes the predicates into a selection
+ *
+ * Only INT, BIGINT, DOUBLE and TEXT columns are supported, the value is converted to the type of the column (TEXT
+ * columns use the text of the predicate).
+ */
+std::unique_ptr<char[]> createSelection(const Record& record, std::vector<TestPredicate> predicates,
+        uint16_t numConjuncts, size_t& selectionLength) {
+    std::stable_sort(predicates.begin(), predicates.end(), [] (const TestPredicate& lhs, const TestPredicate& rhs) {
+        return lhs.column < rhs.column;
+    });
+
+    selectionLength = 16u;
+    uint32_t numColumns = 0u;
+    for (decltype(predicates.size()) i = 0; i < predicates.size(); ++i) {
+        if (i == 0 || predicates[i].column != predicates[i - 1].column) {
+            ++numColumns;
+            selectionLength += 8u;
+        }
+        auto type = predicates[i].type;
+        auto fieldType = record.getFieldMeta(predicates[i].column).field.type();
+        selectionLength += 8u;
+        if (type == PredicateType::IS_NULL || type == PredicateType::IS_NOT_NULL) {
+            continue;
+        }
+        if (fieldType == FieldType::TEXT) {
+            selectionLength += crossbow::align(predicates[i].text.size(), 8u);
+        } else if (fieldType != FieldType::INT) {
+            selectionLength += 8u;
+        }
+    }
+
+    std::unique_ptr<char[]> selection(new char[selectionLength]);
+    memset(selection.get(), 0, selectionLength);
+    crossbow::buffer_writer writer(selection.get(), selectionLength);
+    writer.write<uint32_t>(numColumns);
+    writer.write<uint16_t>(numConjuncts);
+    writer.write<uint16_t>(0x0u);
+    writer.write<uint32_t>(0x0u);
+    writer.write<uint32_t>(0x0u);
+    for (auto i = predicates.begin(); i != predicates.end();) {
+        auto column = i->column;
+        auto end = std::find_if(i, predicates.end(), [column] (const TestPredicate& predicate) {
+            return predicate.column != column;
+        });
+        writer.write<uint16_t>(column);
+        writer.write<uint16_t>(static_cast<uint16_t>(end - i));
+        writer.align(sizeof(uint64_t));
+        for (; i != end; ++i) {
+            writer.write<uint8_t>(crossbow::to_underlying(i->type));
+            writer.write<uint8_t>(i->conjunct);
+            if (i->type == PredicateType::IS_NULL || i->type == PredicateType::IS_NOT_NULL) {
+                writer.align(sizeof(uint64_t));
+                continue;
+            }
+            switch (record.getFieldMeta(column).field.type()) {
+            case FieldType::INT: {
+                writer.align(sizeof(uint32_t));
+                writer.write<int32_t>(static_cast<int32_t>(i->value));
+            } break;
+
+            case FieldType::BIGINT: {
+                writer.align(sizeof(uint64_t));
+                writer.write<int64_t>(static_cast<int64_t>(i->value));
+            } break;
+
+            case FieldType::TEXT: {
+                writer.align(sizeof(uint32_t));
+                writer.write<uint32_t>(static_cast<uint32_t>(i->text.size()));
+                writer.write(i->text.data(), i->text.size());
+                writer.align(sizeof(uint64_t));
+            } break;
+
+            default: {
+                writer.align(sizeof(uint64_t));
+                writer.write<double>(i->value);
+            } break;
+            }
+        }
+    }
+    return selection;
+}
+
+class ColumnMapZoneMapTest : public ::testing::Test {
+protected:
+    ColumnMapZoneMapTest()
+            : mPageManager(PageManager::construct(4 * TELL_PAGE_SIZE)),
+              mSchema(TableType::TRANSACTIONAL) {
+        mSchema.addField(FieldType::INT, "number", true);
+        mSchema.addField(FieldType::DOUBLE, "value", false);
+        mSchema.addField(FieldType::BIGINT, "nothing", false);
+        mRecord = Record(mSchema);
+        mRecord.idOf("number", mNumberField);
+        mRecord.idOf("value", mValueField);
+        mRecord.idOf("nothing", mNothingField);
+        mContext.reset(new ColumnMapContext(*mPageManager, mRecord));
+    }
+
+    /**
+     * @brief Writes a page containing one element for every number
+     *
+     * The values of the value column are taken from the values vector (NULL if the entry in the nulls vector is set),
+     * the nothing column is NULL for all elements.
+     */
+    const ColumnMapMainPage* createPage(const std::vector<int32_t>& numbers, const std::vector<double>& values,
+            const std::vector<bool>& nulls) {
+        auto count = static_cast<uint32_t>(numbers.size());
+        auto page = new (mPageManager->alloc()) ColumnMapMainPage(*mContext, count);
+
+        auto& fixedMetaData = mContext->fixedMetaData();
+        auto numberData = reinterpret_cast<int32_t*>(page->fixedData() + count * fixedMetaData[mNumberField].offset);
+        auto valueData = reinterpret_cast<double*>(page->fixedData() + count * fixedMetaData[mValueField].offset);
+        auto valueNulls = page->headerData() + count * mRecord.getFieldMeta(mValueField).nullIdx;
+        auto nothingNulls = page->headerData() + count * mRecord.getFieldMeta(mNothingField).nullIdx;
+        for (decltype(count) i = 0; i < count; ++i) {
+            new (page->entryData() + i) ColumnMapMainEntry(i + 1u, 1u);
+            numberData[i] = numbers[i];
+            valueData[i] = values[i];
+            valueNulls[i] = (nulls[i] ? 1 : 0);
+            nothingNulls[i] = 1;
+        }
+        return page;
+    }
+
+    /**
+     * @brief Adds a query with the given predicates to the scan
+     */
+    void addQuery(std::vector<TestPredicate> predicates, uint16_t numConjuncts) {
+        size_t selectionLength;
+        auto selection = createSelection(mRecord, std::move(predicates), numConjuncts, selectionLength);
+        mQueries.emplace_back(new LocalScanQuery(ScanQueryType::FULL, std::move(selection), selectionLength, nullptr,
+                0u, 0u, ScanQuery::UNBOUNDED_KEY, 0u, ScanOrder::NONE, 0u, nullptr, mRecord, 0x1000u,
+                [] (const char* /* start */, const char* /* end */) {
+        }));
+    }
+
+    /**
+     * @brief Whether the queries added so far can skip the page
+     */
+    bool canSkip(const ColumnMapMainPage* page) const {
+        std::vector<ScanQuery*> queries;
+        for (auto& query : mQueries) {
+            queries.emplace_back(query.get());
+        }
+        ZoneMapFilter filter(mRecord, queries);
+        return filter.canSkip(mContext->zoneMap(page));
+    }
+
+    crossbow::allocator mAlloc;
+    PageManager::Ptr mPageManager;
+    Schema mSchema;
+    Record mRecord;
+    Record::id_t mNumberField;
+    Record::id_t mValueField;
+    Record::id_t mNothingField;
+    std::unique_ptr<ColumnMapContext> mContext;
+
+    std::vector<std::unique_ptr<LocalScanQuery>> mQueries;
+};
+
+/**
+ * @class ColumnMapZoneMap
+ * @test Check if NaN values are excluded from the value range of the zone map
+ */
+TEST_F(ColumnMapZoneMapTest, nanValues) {
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    auto page = createPage({1, 2, 3}, {nan, 1.0, 2.0}, {false, false, false});
+
+    auto zoneMap = mContext->zoneMap(page);
+    auto& column = zoneMap.columns()[mValueField];
+    EXPECT_EQ(2u, column.valueCount);
+    EXPECT_EQ(0u, column.nullCount);
+    EXPECT_EQ(1.0, column.min.floating);
+    EXPECT_EQ(2.0, column.max.floating);
+
+    addQuery({TestPredicate(0u, mValueField, PredicateType::LESS, 0.5)}, 1u);
+    EXPECT_TRUE(canSkip(page)) << "NaN must not extend the range of the column";
+}
+
+/**
+ * @class ZoneMapFilter
+ * @test Check if a column containing only NaN values is skipped by comparisons but not by IS NOT NULL
+ */
+TEST_F(ColumnMapZoneMapTest, nanOnlyColumn) {
+    auto nan = std::numeric_limits<double>::quiet_NaN();
+    auto page = createPage({1, 2}, {nan, nan}, {false, false});
+
+    auto zoneMap = mContext->zoneMap(page);
+    EXPECT_EQ(0u, zoneMap.columns()[mValueField].valueCount);
+
+    addQuery({TestPredicate(0u, mValueField, PredicateType::GREATER_EQUAL,
+            std::numeric_limits<double>::lowest())}, 1u);
+    EXPECT_TRUE(canSkip(page)) << "No comparison matches NaN";
+
+    mQueries.clear();
+    addQuery({TestPredicate(0u, mValueField, PredicateType::NOT_EQUAL, 1.0)}, 1u);
+    EXPECT_TRUE(canSkip(page)) << "NaN is not unequal to any value (ordered comparison)";
+
+    mQueries.clear();
+    addQuery({TestPredicate(0u, mValueField, PredicateType::IS_NOT_NULL)}, 1u);
+    EXPECT_FALSE(canSkip(page)) << "NaN is not NULL";
+}
+
+/**
+ * @class ZoneMapFilter
+ * @test Check if a column containing only NULL values is only matched by IS NULL
+ */
+TEST_F(ColumnMapZoneMapTest, nullOnlyColumn) {
+    auto page = createPage({1, 2, 3}, {1.0, 2.0, 3.0}, {false, false, false});
+
+    auto zoneMap = mContext->zoneMap(page);
+    auto& column = zoneMap.columns()[mNothingField];
+    EXPECT_EQ(0u, column.valueCount);
+    EXPECT_EQ(3u, column.nullCount);
+
+    addQuery({TestPredicate(0u, mNothingField, PredicateType::IS_NULL)}, 1u);
+    EXPECT_FALSE(canSkip(page));
+
+    mQueries.clear();
+    addQuery({TestPredicate(0u, mNothingField, PredicateType::IS_NOT_NULL)}, 1u);
+    EXPECT_TRUE(canSkip(page));
+
+    mQueries.clear();
+    addQuery({TestPredicate(0u, mNothingField, PredicateType::EQUAL, 5.0)}, 1u);
+    EXPECT_TRUE(canSkip(page)) << "Comparisons never match NULL";
+
+    mQueries.clear();
+    addQuery({TestPredicate(0u, mNothingField, PredicateType::NOT_EQUAL, 5.0)}, 1u);
+    EXPECT_TRUE(canSkip(page)) << "Comparisons never match NULL";
+}
+
+/**
+ * @class ZoneMapFilter
+ * @test Check if NULL values in a partially NULL column do not affect the value range
+ */
+TEST_F(ColumnMapZoneMapTest, partiallyNullColumn) {
+    auto page = createPage({1, 2, 3}, {-100.0, 5.0, 6.0}, {true, false, false});
+
+    auto zoneMap = mContext->zoneMap(page);
+    auto& column = zoneMap.columns()[mValueField];
+    EXPECT_EQ(2u, column.valueCount);
+    EXPECT_EQ(1u, column.nullCount);
+    EXPECT_EQ(5.0, column.min.floating);
+
+    addQuery({TestPredicate(0u, mValueField, PredicateType::LESS, 0.0)}, 1u);
+    EXPECT_TRUE(canSkip(page)) << "The value of a NULL element must not be part of the range";
+
+    mQueries.clear();
+    addQuery({TestPredicate(0u, mValueField, PredicateType::IS_NULL)}, 1u);
+    EXPECT_FALSE(canSkip(page));
+}
+
+/**
+ * @class ZoneMapFilter
+ * @test Check if equality predicates are checked against the distinct values of low cardinality columns
+ */
+TEST_F(ColumnMapZoneMapTest, distinctValues) {
+    auto page = createPage({2, 4, 6, 4}, {7.0, 7.0, 7.0, 7.0}, {false, false, false, false});
+
+    auto zoneMap = mContext->zoneMap(page);
+    EXPECT_EQ(3u, zoneMap.columns()[mNumberField].distinctCount);
+
+    addQuery({TestPredicate(0u, mNumberField, PredicateType::EQUAL, 3.0)}, 1u);
+    EXPECT_TRUE(canSkip(page)) << "Value inside the range but not among the distinct values must be skipped";
+
+    mQueries.clear();
+    addQuery({TestPredicate(0u, mNumberField, PredicateType::EQUAL, 4.0)}, 1u);
+    EXPECT_FALSE(canSkip(page));
+
+    mQueries.clear();
+    addQuery({TestPredicate(0u, mValueField, PredicateType::NOT_EQUAL, 7.0)}, 1u);
+    EXPECT_TRUE(canSkip(page)) << "Column with a single value must be skipped for NOT_EQUAL on that value";
+}
+
+/**
+ * @class ZoneMapFilter
+ * @test Check if a query is skipped iff one of its conjuncts can not match and a scan iff all of its queries are
+ */
+TEST_F(ColumnMapZoneMapTest, conjunctions) {
+    std::vector<int32_t> numbers;
+    std::vector<double> values;
+    std::vector<bool> nulls;
+    for (int32_t i = 1; i <= 10; ++i) {
+        numbers.emplace_back(i);
+        values.emplace_back(static_cast<double>(i) / 2.0);
+        nulls.emplace_back(false);
+    }
+    auto page = createPage(numbers, values, nulls);
+
+    // (number == 5) AND (number > 100 OR value < 0) can not match
+    addQuery({
+        TestPredicate(0u, mNumberField, PredicateType::EQUAL, 5.0),
+        TestPredicate(1u, mNumberField, PredicateType::GREATER, 100.0),
+        TestPredicate(1u, mValueField, PredicateType::LESS, 0.0)
+    }, 2u);
+    EXPECT_TRUE(canSkip(page));
+
+    // (number == 5) AND (number > 100 OR value < 1) might match
+    mQueries.clear();
+    addQuery({
+        TestPredicate(0u, mNumberField, PredicateType::EQUAL, 5.0),
+        TestPredicate(1u, mNumberField, PredicateType::GREATER, 100.0),
+        TestPredicate(1u, mValueField, PredicateType::LESS, 1.0)
+    }, 2u);
+    EXPECT_FALSE(canSkip(page)) << "A conjunct matches if any of its predicates matches";
+
+    // A shared scan can only skip the page if no query matches
+    mQueries.clear();
+    addQuery({TestPredicate(0u, mNumberField, PredicateType::GREATER, 100.0)}, 1u);
+    EXPECT_TRUE(canSkip(page));
+    addQuery({TestPredicate(0u, mNumberField, PredicateType::LESS_EQUAL, 1.0)}, 1u);
+    EXPECT_FALSE(canSkip(page)) << "Page must be scanned if any query might match";
+
+    // A query without predicates matches every element
+    mQueries.clear();
+    addQuery({TestPredicate(0u, mNumberField, PredicateType::GREATER, 100.0)}, 1u);
+    addQuery({}, 0u);
+    EXPECT_FALSE(canSkip(page));
+}
+
+class ColumnMapVariableZoneMapTest : public ::testing::Test {
+protected:
+    ColumnMapVariableZoneMapTest()
+            : mPageManager(PageManager::construct(4 * TELL_PAGE_SIZE)),
+              mSchema(TableType::TRANSACTIONAL) {
+        mSchema.addField(FieldType::TEXT, "status", false);
+        mRecord = Record(mSchema);
+        mRecord.idOf("status", mStatusField);
+        mContext.reset(new ColumnMapContext(*mPageManager, mRecord));
+    }
+
+    /**
+     * @brief Writes a page containing one element for every status (NULL if the entry in the nulls vector is set)
+     *
+     * The value of the first element is stored right before the end of the heap, every following value right before
+     * the previous one.
+     */
+    ColumnMapMainPage* createPage(const std::vector<crossbow::string>& values, const std::vector<bool>& nulls) {
+        auto count = static_cast<uint32_t>(values.size());
+        auto page = new (mPageManager->alloc()) ColumnMapMainPage(*mContext, count);
+
+        auto statusNulls = page->headerData() + count * mRecord.getFieldMeta(mStatusField).nullIdx;
+        auto heapEntries = page->variableData();
+        auto offset = static_cast<uint32_t>(TELL_PAGE_SIZE);
+        for (decltype(count) i = 0; i < count; ++i) {
+            new (page->entryData() + i) ColumnMapMainEntry(i + 1u, 1u);
+            statusNulls[i] = (nulls[i] ? 1 : 0);
+
+            auto size = static_cast<uint32_t>(nulls[i] ? 0u : values[i].size());
+            offset -= size;
+            memcpy(reinterpret_cast<char*>(page) + offset, values[i].data(), size);
+            new (heapEntries + i) ColumnMapHeapEntry(offset, size, values[i].data());
+        }
+        return page;
+    }
+
+    /**
+     * @brief Whether a query with the single predicate on the status column can skip the page
+     */
+    bool canSkip(const ColumnMapMainPage* page, PredicateType type, crossbow::string text = crossbow::string()) {
+        size_t selectionLength;
+        auto selection = createSelection(mRecord, {TestPredicate(0u, mStatusField, type, std::move(text))}, 1u,
+                selectionLength);
+        LocalScanQuery query(ScanQueryType::FULL, std::move(selection), selectionLength, nullptr, 0u, 0u,
+                ScanQuery::UNBOUNDED_KEY, 0u, ScanOrder::NONE, 0u, nullptr, mRecord, 0x1000u,
+                [] (const char* /* start */, const char* /* end */) {
+        });
+
+        ZoneMapFilter filter(mRecord, {&query});
+        return filter.canSkip(mContext->zoneMap(page));
+    }
+
+    crossbow::allocator mAlloc;
+    PageManager::Ptr mPageManager;
+    Schema mSchema;
+    Record mRecord;
+    Record::id_t mStatusField;
+    std::unique_ptr<ColumnMapContext> mContext;
+};
+
+/**
+ * @class ZoneMapFilter
+ * @test Check if predicates on a variable size column are checked against its sorted distinct values
+ */
+TEST_F(ColumnMapVariableZoneMapTest, distinctValues) {
+    auto page = createPage({"pending", "active", "closed", "active", "", "pending"},
+            {false, false, false, false, true, false});
+
+    auto zoneMap = mContext->zoneMap(page);
+    auto& column = zoneMap.variableColumns()[0];
+    EXPECT_EQ(1u, column.nullCount);
+    ASSERT_TRUE(column.hasDistinctValues);
+    EXPECT_EQ(std::vector<crossbow::string>({"active", "closed", "pending"}), column.distinctValues);
+
+    EXPECT_FALSE(canSkip(page, PredicateType::IS_NULL));
+    EXPECT_FALSE(canSkip(page, PredicateType::IS_NOT_NULL));
+
+    EXPECT_FALSE(canSkip(page, PredicateType::EQUAL, "closed"));
+    EXPECT_TRUE(canSkip(page, PredicateType::EQUAL, "blocked")) << "Value not among the distinct values";
+    EXPECT_TRUE(canSkip(page, PredicateType::EQUAL, "clos")) << "Prefix of a value is not equal to the value";
+    EXPECT_FALSE(canSkip(page, PredicateType::NOT_EQUAL, "active"));
+
+    EXPECT_FALSE(canSkip(page, PredicateType::PREFIX_LIKE, "pen"));
+    EXPECT_TRUE(canSkip(page, PredicateType::PREFIX_LIKE, "open"));
+    EXPECT_FALSE(canSkip(page, PredicateType::POSTFIX_LIKE, "sed"));
+    EXPECT_TRUE(canSkip(page, PredicateType::POSTFIX_LIKE, "ive ")) << "Postfix must match the end of the value";
+}
+
+/**
+ * @class ZoneMapFilter
+ * @test Check if NOT variants are only skipped if every distinct value matches the positive predicate
+ */
+TEST_F(ColumnMapVariableZoneMapTest, singleValue) {
+    auto page = createPage({"active", "active", "active"}, {false, false, false});
+
+    EXPECT_TRUE(canSkip(page, PredicateType::IS_NULL)) << "Column without NULL values";
+    EXPECT_TRUE(canSkip(page, PredicateType::NOT_EQUAL, "active"));
+    EXPECT_FALSE(canSkip(page, PredicateType::NOT_EQUAL, "activ"));
+    EXPECT_TRUE(canSkip(page, PredicateType::PREFIX_NOT_LIKE, "act"));
+    EXPECT_FALSE(canSkip(page, PredicateType::PREFIX_NOT_LIKE, "ive"));
+    EXPECT_TRUE(canSkip(page, PredicateType::POSTFIX_NOT_LIKE, "ive"));
+    EXPECT_FALSE(canSkip(page, PredicateType::POSTFIX_NOT_LIKE, "act"));
+}
+
+/**
+ * @class ZoneMapFilter
+ * @test Check if a column with more distinct values than recorded by the zone map is never skipped by its values
+ */
+TEST_F(ColumnMapVariableZoneMapTest, highCardinality) {
+    std::vector<crossbow::string> values;
+    std::vector<bool> nulls;
+    for (uint32_t i = 0; i <= VariableZoneMap::MAX_DISTINCT_VALUES; ++i) {
+        values.emplace_back("value" + crossbow::to_string(i));
+        nulls.emplace_back(false);
+    }
+    auto page = createPage(values, nulls);
+
+    auto zoneMap = mContext->zoneMap(page);
+    auto& column = zoneMap.variableColumns()[0];
+    EXPECT_FALSE(column.hasDistinctValues);
+    EXPECT_TRUE(column.distinctValues.empty());
+
+    EXPECT_FALSE(canSkip(page, PredicateType::EQUAL, "missing"));
+    EXPECT_FALSE(canSkip(page, PredicateType::PREFIX_LIKE, "other"));
+    EXPECT_FALSE(canSkip(page, PredicateType::POSTFIX_LIKE, "suffix"));
+    EXPECT_TRUE(canSkip(page, PredicateType::IS_NULL)) << "NULL count is recorded independent of the values";
+}
+
+/**
+ * @class ColumnMapMainPage
+ * @test Check if low cardinality variable size columns are encoded into a sorted dictionary without changing the zone
+ *     map
+ */
+TEST_F(ColumnMapVariableZoneMapTest, dictionaryEncoding) {
+    auto page = createPage({"pending", "active", "closed", "active", "", "pending", "closed", "active"},
+            {false, false, false, false, true, false, false, false});
+    auto zoneMap = mContext->zoneMap(page);
+
+    page->encodeVariableColumns(*mContext);
+    ASSERT_TRUE(page->isEncoded(mStatusField));
+
+    auto dictionaryColumns = reinterpret_cast<const ColumnMapDictionaryColumn*>(page->dictionaryData(*mContext));
+    auto dictionaryEntries = reinterpret_cast<const ColumnMapDictionaryEntry*>(dictionaryColumns + 1);
+    ASSERT_EQ(3u, dictionaryColumns[0].size);
+
+    std::vector<crossbow::string> dictionary;
+    for (uint32_t i = 0; i < dictionaryColumns[0].size; ++i) {
+        auto& entry = dictionaryEntries[dictionaryColumns[0].offset + i];
+        dictionary.emplace_back(reinterpret_cast<const char*>(page) + entry.offset, entry.size);
+        EXPECT_EQ(0, memcmp(entry.prefix, dictionary.back().data(), 4u));
+    }
+    EXPECT_EQ(std::vector<crossbow::string>({"active", "closed", "pending"}), dictionary);
+
+    std::vector<uint32_t> codes;
+    for (uint32_t i = 0; i < page->count; ++i) {
+        uint32_t code;
+        memcpy(&code, page->variableData()[i].prefix, sizeof(code));
+        codes.emplace_back(code);
+    }
+    EXPECT_EQ(std::vector<uint32_t>({2u, 0u, 1u, 0u, 0u, 2u, 1u, 0u}), codes);
+
+    auto encodedZoneMap = mContext->zoneMap(page);
+    EXPECT_EQ(zoneMap.variableColumns()[0].distinctValues, encodedZoneMap.variableColumns()[0].distinctValues);
+    EXPECT_EQ(1u, encodedZoneMap.variableColumns()[0].nullCount);
+}
+
+/**
+ * @class ColumnMapMainPage
+ * @test Check if columns with too many distinct values are not encoded
+ */
+TEST_F(ColumnMapVariableZoneMapTest, noDictionaryEncoding) {
+    auto page = createPage({"pending", "active", "closed", "active"}, {false, false, false, false});
+    page->encodeVariableColumns(*mContext);
+    EXPECT_FALSE(page->isEncoded(mStatusField)) << "Dictionary must have at most one value for every two elements";
+    EXPECT_EQ(0, memcmp(page->variableData()[0].prefix, "pend", 4u)) << "Prefix must not be changed";
+}
+
+/**
+ * @class ColumnMapScanProcessor
+ * @test Check if pages with updates not covered by the zone map are still scanned
+ */
+TEST(ColumnMapZoneMapScanTest, pageWithNewestPointers) {
+    crossbow::allocator _;
+    DummyCommitManager commitManager;
+
+    Schema schema(TableType::TRANSACTIONAL);
+    schema.addField(FieldType::INT, "number", true);
+    Record record(schema);
+    Record::id_t numberField;
+    ASSERT_TRUE(record.idOf("number", numberField));
+
+    StorageConfig config;
+    config.totalMemory = 0x10000000ull;
+    config.numScanThreads = 1u;
+    config.hashMapCapacity = 0x100000ull;
+    EmbeddedStore<DeltaMainRewriteColumnStore> store(config, 0x1000u);
+
+    uint64_t tableId = 0u;
+    ASSERT_TRUE(store.createTable("zoneMapTable", schema, tableId)) << "Creating table failed";
+
+    auto writeNumber = [&store, &record, tableId] (const commitmanager::SnapshotDescriptor& snapshot, uint64_t key,
+            int32_t number, bool update) {
+        size_t size;
+        std::unique_ptr<char[]> rec(record.create(GenericTuple({
+                std::make_pair<crossbow::string, boost::any>("number", number)
+        }), size));
+        return (update ? store.update(tableId, key, size, rec.get(), snapshot)
+                : store.insert(tableId, key, size, rec.get(), snapshot));
+    };
+
+    // Returns the keys of all tuples with a negative number
+    auto scanNegative = [&store, &record, tableId, numberField] (const commitmanager::SnapshotDescriptor& snapshot) {
+        size_t selectionLength;
+        auto selection = createSelection(record, {TestPredicate(0u, numberField, PredicateType::LESS, 0.0)}, 1u,
+                selectionLength);
+
+        std::mutex keysMutex;
+        std::vector<uint64_t> keys;
+        auto ec = store.scan(tableId, snapshot, ScanQueryType::FULL, std::move(selection), selectionLength, nullptr,
+                0u, [&record, &keysMutex, &keys] (const char* start, const char* end) {
+            std::unique_lock<decltype(keysMutex)> _(keysMutex);
+            while (start < end) {
+                keys.emplace_back(*reinterpret_cast<const uint64_t*>(start));
+                start += sizeof(uint64_t);
+                start += record.sizeOfTuple(start);
+            }
+        });
+        EXPECT_EQ(0, ec) << "Scan failed";
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    };
+
+    {
+        auto tx = commitManager.startTx();
+        for (uint64_t key = 1u; key <= 1000u; ++key) {
+            ASSERT_EQ(0, writeNumber(tx, key, static_cast<int32_t>(key), false));
+        }
+        tx.commit();
+    }
+    store.runGC();
+
+    {
+        auto tx = commitManager.startTx();
+        EXPECT_TRUE(scanNegative(tx).empty());
+
+        // The update is only in the update log, the zone map of the page still has no negative values
+        ASSERT_EQ(0, writeNumber(tx, 500u, -1, true));
+        tx.commit();
+    }
+
+    {
+        auto tx = commitManager.startTx();
+        EXPECT_EQ(std::vector<uint64_t>({500u}), scanNegative(tx)) << "Page with pending update must not be skipped";
+        tx.commit();
+    }
+
+    // The rewritten page includes the update in its zone map
+    store.runGC();
+    {
+        auto tx = commitManager.startTx();
+        EXPECT_EQ(std::vector<uint64_t>({500u}), scanNegative(tx));
+        tx.commit();
+    }
+}
+
+} // anonymous namespace
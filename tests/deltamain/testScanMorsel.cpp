@@ -0,0 +1,232 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include <deltamain/ScanMorsel.hpp>
+
+#include <util/LocalScanQuery.hpp>
+#include <util/Numa.hpp>
+
+#include <tellstore/Record.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace tell::store;
+using namespace tell::store::deltamain;
+
+namespace {
+
+class ScanKeyRangeTest : public ::testing::Test {
+protected:
+    ScanKeyRangeTest()
+            : mSchema(TableType::TRANSACTIONAL) {
+        mSchema.addField(FieldType::INT, "foo", true);
+        mRecord = Record(mSchema);
+    }
+
+    /**
+     * @brief Adds a full scan query over the key range [lowKey, highKey)
+     */
+    void addQuery(uint64_t lowKey, uint64_t highKey) {
+        size_t selectionLength = 16u;
+        std::unique_ptr<char[]> selection(new char[selectionLength]);
+        memset(selection.get(), 0, selectionLength);
+
+        mQueries.emplace_back(new LocalScanQuery(ScanQueryType::FULL, std::move(selection), selectionLength, nullptr,
+                0u, lowKey, highKey, 0u, ScanOrder::NONE, 0u, nullptr, mRecord, 0x1000u,
+                [] (const char* /* start */, const char* /* end */) {
+        }));
+    }
+
+    std::vector<ScanQuery*> queries() const {
+        std::vector<ScanQuery*> result;
+        for (auto& query : mQueries) {
+            result.emplace_back(query.get());
+        }
+        return result;
+    }
+
+    Schema mSchema;
+    Record mRecord;
+    std::vector<std::unique_ptr<LocalScanQuery>> mQueries;
+};
+
+/**
+ * @class ScanKeyRange
+ * @test Check if only pages whose fence overlaps the key range are scanned
+ */
+TEST_F(ScanKeyRangeTest, fenceBoundaries) {
+    addQuery(100u, 200u);
+    ScanKeyRange keyRange(queries());
+
+    EXPECT_FALSE(keyRange.overlaps(std::make_pair(50u, 99u))) << "Page before the range must be skipped";
+    EXPECT_TRUE(keyRange.overlaps(std::make_pair(50u, 100u))) << "Page ending on the lower bound must be scanned";
+    EXPECT_TRUE(keyRange.overlaps(std::make_pair(120u, 150u))) << "Page inside the range must be scanned";
+    EXPECT_TRUE(keyRange.overlaps(std::make_pair(50u, 300u))) << "Page covering the range must be scanned";
+    EXPECT_TRUE(keyRange.overlaps(std::make_pair(199u, 300u))) << "Page starting before the upper bound must be scanned";
+    EXPECT_FALSE(keyRange.overlaps(std::make_pair(200u, 300u))) << "Page starting on the upper bound must be skipped";
+}
+
+/**
+ * @class ScanKeyRange
+ * @test Check if an empty key range skips all pages
+ */
+TEST_F(ScanKeyRangeTest, emptyRange) {
+    addQuery(100u, 100u);
+    ScanKeyRange keyRange(queries());
+
+    EXPECT_FALSE(keyRange.overlaps(std::make_pair(0u, 99u)));
+    EXPECT_FALSE(keyRange.overlaps(std::make_pair(100u, 100u)));
+    EXPECT_FALSE(keyRange.overlaps(std::make_pair(101u, 200u)));
+}
+
+/**
+ * @class ScanKeyRange
+ * @test Check if a range without upper bound scans all pages after the lower bound
+ */
+TEST_F(ScanKeyRangeTest, unboundedHighKey) {
+    addQuery(100u, ScanQuery::UNBOUNDED_KEY);
+    ScanKeyRange keyRange(queries());
+
+    EXPECT_FALSE(keyRange.overlaps(std::make_pair(0u, 99u)));
+    EXPECT_TRUE(keyRange.overlaps(std::make_pair(uint64_t(1000u), std::numeric_limits<uint64_t>::max())));
+}
+
+/**
+ * @class ScanKeyRange
+ * @test Check if the pages between the ranges of two queries are scanned as the range covers both queries
+ */
+TEST_F(ScanKeyRangeTest, sharedScanHull) {
+    addQuery(100u, 200u);
+    addQuery(500u, 600u);
+    ScanKeyRange keyRange(queries());
+
+    EXPECT_FALSE(keyRange.overlaps(std::make_pair(0u, 99u)));
+    EXPECT_TRUE(keyRange.overlaps(std::make_pair(150u, 160u)));
+    EXPECT_TRUE(keyRange.overlaps(std::make_pair(300u, 400u)));
+    EXPECT_TRUE(keyRange.overlaps(std::make_pair(550u, 560u)));
+    EXPECT_FALSE(keyRange.overlaps(std::make_pair(600u, 700u)));
+}
+
+/**
+ * @class ScanKeyRange
+ * @test Check if no page is skipped when any query of the shared scan has no key range
+ */
+TEST_F(ScanKeyRangeTest, unrestrictedQuery) {
+    addQuery(100u, 200u);
+    addQuery(0u, ScanQuery::UNBOUNDED_KEY);
+    ScanKeyRange keyRange(queries());
+
+    EXPECT_TRUE(keyRange.overlaps(std::make_pair(0u, 99u)));
+    EXPECT_TRUE(keyRange.overlaps(std::make_pair(600u, 700u)));
+}
+
+/**
+ * @class ScanKeyRange
+ * @test Check if no page is skipped without any queries
+ */
+TEST_F(ScanKeyRangeTest, noQueries) {
+    ScanKeyRange keyRange(queries());
+
+    EXPECT_TRUE(keyRange.overlaps(std::make_pair(0u, 99u)));
+}
+
+/**
+ * @class ScanMorselQueue
+ * @test Check if the morsels of the calling thread's node are handed out before morsels of the other nodes
+ */
+TEST(ScanMorselQueueTest, localNodeFirst) {
+    ScanMorselQueue<int> queue(std::vector<std::vector<int>>({{0, 1}, {10, 11, 12}, {}}));
+    EXPECT_EQ(5u, queue.size());
+
+    // The test thread is assumed not to migrate to a different node between the calls
+    auto localNode = numaCurrentNode() % 3u;
+    std::vector<int> expected;
+    for (size_t i = 0; i < 3u; ++i) {
+        switch ((localNode + i) % 3u) {
+        case 0u: {
+            expected.insert(expected.end(), {0, 1});
+        } break;
+
+        case 1u: {
+            expected.insert(expected.end(), {10, 11, 12});
+        } break;
+
+        default:
+            break;
+        }
+    }
+
+    std::vector<int> result;
+    while (auto morsel = queue.next()) {
+        result.emplace_back(*morsel);
+    }
+    EXPECT_EQ(expected, result);
+    EXPECT_EQ(nullptr, queue.next());
+}
+
+/**
+ * @class ScanMorselQueue
+ * @test Check if concurrent threads process every morsel of every node exactly once
+ */
+TEST(ScanMorselQueueTest, concurrentNext) {
+    std::vector<std::vector<int>> nodeMorsels(2);
+    for (int i = 0; i < 1000; ++i) {
+        nodeMorsels[i % 2].emplace_back(i);
+    }
+    ScanMorselQueue<int> queue(std::move(nodeMorsels));
+
+    std::mutex resultMutex;
+    std::vector<int> result;
+    std::vector<std::thread> threads;
+    for (auto t = 0; t < 4; ++t) {
+        threads.emplace_back([&queue, &resultMutex, &result] () {
+            std::vector<int> processed;
+            while (auto morsel = queue.next()) {
+                processed.emplace_back(*morsel);
+            }
+            std::unique_lock<decltype(resultMutex)> _(resultMutex);
+            result.insert(result.end(), processed.begin(), processed.end());
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::sort(result.begin(), result.end());
+    ASSERT_EQ(1000u, result.size());
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(i, result[i]);
+    }
+}
+
+} // anonymous namespace
@@ -0,0 +1,231 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#include <server/SnapshotCache.hpp>
+#include <server/TransactionTracker.hpp>
+
+#include <util/VersionManager.hpp>
+
+#include <commitmanager/SnapshotDescriptor.hpp>
+
+#include <crossbow/allocator.hpp>
+#include <crossbow/byte_buffer.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace tell;
+using namespace tell::store;
+
+namespace {
+
+class SnapshotCacheTest : public ::testing::Test {
+protected:
+    /// Number of slots in the cache
+    static constexpr size_t CAPACITY = 16u;
+
+    SnapshotCacheTest()
+            : mSnapshotCache(mVersionManager, CAPACITY) {
+    }
+
+    static std::unique_ptr<commitmanager::SnapshotDescriptor> createSnapshot(uint64_t lowestActiveVersion,
+            uint64_t version) {
+        commitmanager::SnapshotDescriptor::BlockType descriptor = 0x0u;
+        return commitmanager::SnapshotDescriptor::create(lowestActiveVersion, version - 1, version,
+                reinterpret_cast<const char*>(&descriptor));
+    }
+
+    static std::vector<char> serialize(const commitmanager::SnapshotDescriptor& snapshot) {
+        std::vector<char> data(snapshot.serializedLength());
+        crossbow::buffer_writer writer(data.data(), data.size());
+        snapshot.serialize(writer);
+        return data;
+    }
+
+    /**
+     * @brief Acquires the snapshot from the cache and counts how often it had to be created
+     */
+    const commitmanager::SnapshotDescriptor* acquire(uint64_t lowestActiveVersion, uint64_t version) {
+        return mSnapshotCache.acquire(version, [this, lowestActiveVersion, version] () {
+            ++mCreated;
+            return createSnapshot(lowestActiveVersion, version);
+        });
+    }
+
+    crossbow::allocator mAlloc;
+
+    VersionManager mVersionManager;
+
+    SnapshotCache mSnapshotCache;
+
+    std::atomic<size_t> mCreated{0u};
+};
+
+constexpr size_t SnapshotCacheTest::CAPACITY;
+
+/**
+ * @class SnapshotCache
+ * @test Check if a snapshot acquired by multiple connections is only created once and removed with the last reference
+ */
+TEST_F(SnapshotCacheTest, sharedAcquire) {
+    auto snapshot1 = acquire(1u, 10u);
+    ASSERT_NE(nullptr, snapshot1);
+    EXPECT_EQ(10u, snapshot1->version());
+
+    auto snapshot2 = acquire(1u, 10u);
+    EXPECT_EQ(snapshot1, snapshot2);
+    EXPECT_EQ(1u, mCreated.load());
+    EXPECT_EQ(snapshot1, mSnapshotCache.find(10u));
+
+    mSnapshotCache.release(10u);
+    EXPECT_EQ(snapshot1, mSnapshotCache.find(10u));
+    mSnapshotCache.release(10u);
+    EXPECT_EQ(nullptr, mSnapshotCache.find(10u));
+
+    // Acquiring the snapshot after the last reference was released has to create it again
+    auto snapshot3 = acquire(1u, 10u);
+    ASSERT_NE(nullptr, snapshot3);
+    EXPECT_EQ(10u, snapshot3->version());
+    EXPECT_EQ(2u, mCreated.load());
+    mSnapshotCache.release(10u);
+}
+
+/**
+ * @class SnapshotCache
+ * @test Check if a snapshot colliding with an active snapshot is not cached
+ */
+TEST_F(SnapshotCacheTest, slotCollision) {
+    ASSERT_NE(nullptr, acquire(1u, 10u));
+    EXPECT_EQ(nullptr, acquire(1u, 10u + CAPACITY));
+    EXPECT_EQ(nullptr, mSnapshotCache.find(10u + CAPACITY));
+    EXPECT_EQ(1u, mCreated.load());
+
+    // Releasing the colliding version must not release the cached snapshot
+    mSnapshotCache.release(10u + CAPACITY);
+    EXPECT_NE(nullptr, mSnapshotCache.find(10u));
+    mSnapshotCache.release(10u);
+}
+
+/**
+ * @class SnapshotCache
+ * @test Check if an expired snapshot is evicted by a colliding snapshot even though it is still referenced
+ */
+TEST_F(SnapshotCacheTest, evictExpired) {
+    ASSERT_NE(nullptr, acquire(1u, 10u));
+
+    auto newerSnapshot = createSnapshot(12u, 13u);
+    mVersionManager.addSnapshot(*newerSnapshot);
+
+    auto snapshot = acquire(12u, 10u + CAPACITY);
+    ASSERT_NE(nullptr, snapshot);
+    EXPECT_EQ(10u + CAPACITY, snapshot->version());
+    EXPECT_EQ(nullptr, mSnapshotCache.find(10u));
+
+    // Releasing the reference on the evicted snapshot must not touch the new snapshot
+    mSnapshotCache.release(10u);
+    EXPECT_EQ(snapshot, mSnapshotCache.find(10u + CAPACITY));
+    mSnapshotCache.release(10u + CAPACITY);
+    EXPECT_EQ(nullptr, mSnapshotCache.find(10u + CAPACITY));
+}
+
+/**
+ * @class SnapshotCache
+ * @test Check if concurrent acquires and releases of the same snapshot always return a valid snapshot
+ *
+ * The threads race on entries whose reference count just dropped to 0 and are about to be removed.
+ */
+TEST_F(SnapshotCacheTest, concurrentAcquireRelease) {
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4u; ++i) {
+        threads.emplace_back([this, &failed] () {
+            for (size_t j = 0; j < 10000u; ++j) {
+                crossbow::allocator _;
+                auto snapshot = acquire(1u, 10u);
+                if (!snapshot || snapshot->version() != 10u) {
+                    failed.store(true);
+                    return;
+                }
+                mSnapshotCache.release(10u);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_FALSE(failed.load());
+    EXPECT_EQ(nullptr, mSnapshotCache.find(10u));
+}
+
+/**
+ * @class TransactionTracker
+ * @test Check if a request containing only the version is served from the snapshot cache of another connection
+ */
+TEST_F(SnapshotCacheTest, versionOnlyRequest) {
+    TransactionTracker connection1(mSnapshotCache, mVersionManager);
+    TransactionTracker connection2(mSnapshotCache, mVersionManager);
+
+    auto snapshot = createSnapshot(1u, 10u);
+    auto data = serialize(*snapshot);
+    auto cached = connection1.acquire(10u, data.data(), data.size());
+    ASSERT_NE(nullptr, cached);
+
+    // The second connection did not receive the descriptor but finds it in the shared cache
+    EXPECT_EQ(cached, connection2.find(10u));
+    EXPECT_EQ(cached, connection2.acquire(10u, data.data(), data.size()));
+
+    connection1.complete(10u);
+    EXPECT_EQ(cached, connection2.find(10u));
+    connection2.complete(10u);
+    EXPECT_EQ(nullptr, connection2.find(10u));
+}
+
+/**
+ * @class TransactionTracker
+ * @test Check if a snapshot colliding in the shared cache is kept in the connection local cache
+ */
+TEST_F(SnapshotCacheTest, localFallback) {
+    TransactionTracker connection(mSnapshotCache, mVersionManager);
+
+    auto snapshot1 = createSnapshot(1u, 10u);
+    auto data1 = serialize(*snapshot1);
+    ASSERT_NE(nullptr, connection.acquire(10u, data1.data(), data1.size()));
+
+    auto snapshot2 = createSnapshot(1u, 10u + CAPACITY);
+    auto data2 = serialize(*snapshot2);
+    auto local = connection.acquire(10u + CAPACITY, data2.data(), data2.size());
+    ASSERT_NE(nullptr, local);
+    EXPECT_EQ(10u + CAPACITY, local->version());
+    EXPECT_EQ(nullptr, mSnapshotCache.find(10u + CAPACITY));
+    EXPECT_EQ(local, connection.find(10u + CAPACITY));
+    EXPECT_TRUE(connection.holdsSnapshot(10u + CAPACITY));
+
+    connection.complete(10u + CAPACITY);
+    EXPECT_FALSE(connection.holdsSnapshot(10u + CAPACITY));
+    EXPECT_NE(nullptr, mSnapshotCache.find(10u));
+}
+
+}
@@ -0,0 +1,204 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#include <server/SnapshotCache.hpp>
+#include <server/TransactionTracker.hpp>
+
+#include <util/VersionManager.hpp>
+#include <util/WriteOperation.hpp>
+
+#include <tellstore/ErrorCode.hpp>
+
+#include <commitmanager/SnapshotDescriptor.hpp>
+
+#include <crossbow/allocator.hpp>
+#include <crossbow/byte_buffer.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace tell;
+using namespace tell::store;
+
+namespace {
+
+/**
+ * @brief Storage recording all batch writes
+ */
+class RecordingStorage {
+public:
+    void batchWrite(const WriteOperation* operations, size_t count, const commitmanager::SnapshotDescriptor& snapshot,
+            int* results) {
+        ++batches;
+        for (size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(WriteType::REVERT, operations[i].type);
+            EXPECT_EQ(version, snapshot.version());
+            writes.emplace_back(operations[i].tableId, operations[i].key);
+            results[i] = (failingKeys.count(operations[i].key) != 0u ? error::not_in_snapshot : 0);
+        }
+    }
+
+    size_t batches = 0u;
+
+    uint64_t version = 0u;
+
+    std::vector<std::pair<uint64_t, uint64_t>> writes;
+
+    std::set<uint64_t> failingKeys;
+};
+
+class TransactionTrackerTest : public ::testing::Test {
+protected:
+    TransactionTrackerTest()
+            : mSnapshotCache(mVersionManager, 16u),
+              mTracker(mSnapshotCache, mVersionManager),
+              mSnapshot(createSnapshot(5u, 6u, 11u)) {
+        mStorage.version = mSnapshot->version();
+    }
+
+    static std::unique_ptr<commitmanager::SnapshotDescriptor> createSnapshot(uint64_t lowestActiveVersion,
+            uint64_t baseVersion, uint64_t version) {
+        commitmanager::SnapshotDescriptor::BlockType descriptor = 0x0u;
+        return commitmanager::SnapshotDescriptor::create(lowestActiveVersion, baseVersion, version,
+                reinterpret_cast<const char*>(&descriptor));
+    }
+
+    static std::vector<char> serialize(const commitmanager::SnapshotDescriptor& snapshot) {
+        std::vector<char> data(snapshot.serializedLength());
+        crossbow::buffer_writer writer(data.data(), data.size());
+        snapshot.serialize(writer);
+        return data;
+    }
+
+    crossbow::allocator mAlloc;
+
+    VersionManager mVersionManager;
+
+    SnapshotCache mSnapshotCache;
+
+    TransactionTracker mTracker;
+
+    RecordingStorage mStorage;
+
+    std::unique_ptr<commitmanager::SnapshotDescriptor> mSnapshot;
+};
+
+/**
+ * @class TransactionTracker
+ * @test Check if an abort reverts every written tuple exactly once in a single batch
+ */
+TEST_F(TransactionTrackerTest, revertInSingleBatch) {
+    mTracker.addWrite(*mSnapshot, 1u, 10u);
+    mTracker.addWrite(*mSnapshot, 1u, 11u);
+    mTracker.addWrite(*mSnapshot, 1u, 10u);
+    mTracker.addWrite(*mSnapshot, 2u, 10u);
+    EXPECT_EQ(4u, mTracker.writeSetSize(mSnapshot->version()));
+
+    EXPECT_EQ(0, mTracker.revert(mStorage, mSnapshot->version()));
+    EXPECT_EQ(1u, mStorage.batches);
+    std::vector<std::pair<uint64_t, uint64_t>> expected = {{1u, 10u}, {1u, 11u}, {2u, 10u}};
+    EXPECT_EQ(expected, mStorage.writes);
+    EXPECT_EQ(0u, mTracker.writeSetSize(mSnapshot->version()));
+}
+
+/**
+ * @class TransactionTracker
+ * @test Check if explicitly reverted tuples are removed from the write set
+ */
+TEST_F(TransactionTrackerTest, removeRevertedWrite) {
+    mTracker.addWrite(*mSnapshot, 1u, 10u);
+    mTracker.addWrite(*mSnapshot, 1u, 11u);
+    mTracker.removeWrite(*mSnapshot, 1u, 10u);
+    EXPECT_EQ(1u, mTracker.writeSetSize(mSnapshot->version()));
+
+    EXPECT_EQ(0, mTracker.revert(mStorage, mSnapshot->version()));
+    std::vector<std::pair<uint64_t, uint64_t>> expected = {{1u, 11u}};
+    EXPECT_EQ(expected, mStorage.writes);
+}
+
+/**
+ * @class TransactionTracker
+ * @test Check if tuples that could not be reverted are kept in the write set
+ */
+TEST_F(TransactionTrackerTest, failedRevertKeepsWrites) {
+    mTracker.addWrite(*mSnapshot, 1u, 10u);
+    mTracker.addWrite(*mSnapshot, 1u, 11u);
+
+    mStorage.failingKeys.emplace(11u);
+    EXPECT_EQ(error::not_in_snapshot, mTracker.revert(mStorage, mSnapshot->version()));
+    EXPECT_EQ(1u, mTracker.writeSetSize(mSnapshot->version()));
+
+    mStorage.failingKeys.clear();
+    mStorage.writes.clear();
+    EXPECT_EQ(0, mTracker.revert(mStorage, mSnapshot->version()));
+    std::vector<std::pair<uint64_t, uint64_t>> expected = {{1u, 11u}};
+    EXPECT_EQ(expected, mStorage.writes);
+    EXPECT_EQ(0u, mTracker.writeSetSize(mSnapshot->version()));
+}
+
+/**
+ * @class TransactionTracker
+ * @test Check if the write set can be reverted when the connection does not hold the snapshot anymore
+ */
+TEST_F(TransactionTrackerTest, revertWithoutCachedSnapshot) {
+    mTracker.addWrite(*mSnapshot, 1u, 10u);
+    EXPECT_FALSE(mTracker.holdsSnapshot(mSnapshot->version()));
+    EXPECT_EQ(nullptr, mTracker.find(mSnapshot->version()));
+
+    EXPECT_EQ(0, mTracker.revert(mStorage, mSnapshot->version()));
+    EXPECT_EQ(1u, mStorage.batches);
+}
+
+/**
+ * @class TransactionTracker
+ * @test Check if writes with non-transactional snapshots are not tracked
+ */
+TEST_F(TransactionTrackerTest, nonTransactionalWritesIgnored) {
+    auto snapshot = createSnapshot(0u, 10u, 11u);
+    mTracker.addWrite(*snapshot, 1u, 10u);
+    EXPECT_EQ(0u, mTracker.writeSetSize(snapshot->version()));
+}
+
+/**
+ * @class TransactionTracker
+ * @test Check if completing a transaction releases the snapshot and the write set
+ */
+TEST_F(TransactionTrackerTest, completeReleasesSnapshot) {
+    auto data = serialize(*mSnapshot);
+    auto snapshot = mTracker.acquire(mSnapshot->version(), data.data(), data.size());
+    ASSERT_NE(nullptr, snapshot);
+    EXPECT_EQ(mSnapshot->version(), snapshot->version());
+    EXPECT_TRUE(mTracker.holdsSnapshot(mSnapshot->version()));
+    EXPECT_EQ(snapshot, mSnapshotCache.find(mSnapshot->version()));
+
+    mTracker.addWrite(*snapshot, 1u, 10u);
+    mTracker.complete(mSnapshot->version());
+    EXPECT_FALSE(mTracker.holdsSnapshot(mSnapshot->version()));
+    EXPECT_EQ(0u, mTracker.writeSetSize(mSnapshot->version()));
+    EXPECT_EQ(nullptr, mSnapshotCache.find(mSnapshot->version()));
+}
+
+}
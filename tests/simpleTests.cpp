@@ -27,10 +27,22 @@
 
 #include "DummyCommitManager.hpp"
 
+#include <util/EmbeddedStore.hpp>
+
 #include <crossbow/allocator.hpp>
+#include <crossbow/byte_buffer.hpp>
+#include <crossbow/enum_underlying.hpp>
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace tell;
 using namespace tell::store;
 
 namespace {
@@ -54,6 +66,7 @@ protected:
         mStorage.reset(new Impl(config));
 
         mSchema.addField(FieldType::INT, "foo", true);
+        mSchema.addIndex(crossbow::string("fooIndex"), std::make_pair(false, std::vector<Schema::id_t>({0u})));
     }
 
     virtual void SetUp() final override {
@@ -117,6 +130,557 @@ TYPED_TEST(StorageTest, insert_and_get) {
     this->mStorage->forceGC();
 }
 
+TYPED_TEST(StorageTest, multi_get) {
+    crossbow::allocator _;
+    Record record(this->mSchema);
+
+    auto tx = this->mCommitManager.startTx();
+    std::vector<uint64_t> keys;
+    for (uint64_t key = 1; key <= 40; ++key) {
+        keys.emplace_back(key);
+        if (key % 2 != 0) {
+            continue;
+        }
+        size_t size;
+        std::unique_ptr<char[]> rec(record.create(GenericTuple({
+                std::make_pair<crossbow::string, boost::any>("foo", static_cast<int32_t>(key))
+        }), size));
+        ASSERT_TRUE(!this->mStorage->insert(this->mTableId, key, size, rec.get(), tx)) << "This insert must not fail!";
+    }
+
+    std::vector<std::unique_ptr<char[]>> dest(keys.size());
+    std::vector<int> errors(keys.size(), 0);
+    auto res = this->mStorage->multiGet(this->mTableId, keys.data(), keys.size(), tx, [&tx, &dest]
+            (size_t idx, size_t size, uint64_t version, bool /* isNewest */) {
+        EXPECT_EQ(tx->version(), version) << "Tuple has not the version of the snapshot descriptor";
+        dest[idx].reset(new char[size]);
+        return dest[idx].get();
+    }, [&errors] (size_t idx, int ec) {
+        errors[idx] = ec;
+    });
+    ASSERT_TRUE(!res) << "Multi get failed";
+
+    Record::id_t fooField;
+    ASSERT_TRUE(record.idOf("foo", fooField)) << "Field not found";
+    for (size_t i = 0; i < keys.size(); ++i) {
+        bool isNull;
+        if (keys[i] % 2 != 0) {
+            EXPECT_EQ(error::not_found, errors[i]) << "Key " << keys[i] << " must not be found";
+            continue;
+        }
+        ASSERT_EQ(0, errors[i]) << "Key " << keys[i] << " not found";
+        auto field = record.data(dest[i].get(), fooField, isNull);
+        EXPECT_EQ(static_cast<int32_t>(keys[i]), *reinterpret_cast<const int32_t*>(field));
+    }
+    tx.commit();
+}
+
+TYPED_TEST(StorageTest, batch_write) {
+    crossbow::allocator _;
+    Record record(this->mSchema);
+
+    size_t size;
+    std::unique_ptr<char[]> rec(record.create(GenericTuple({
+            std::make_pair<crossbow::string, boost::any>("foo", 12)
+    }), size));
+
+    auto tx = this->mCommitManager.startTx();
+    std::vector<WriteOperation> operations;
+    operations.emplace_back(WriteType::INSERT, this->mTableId, 1u, size, rec.get());
+    operations.emplace_back(WriteType::INSERT, this->mTableId, 2u, size, rec.get());
+    operations.emplace_back(WriteType::UPDATE, this->mTableId, 1u, size, rec.get());
+    operations.emplace_back(WriteType::REMOVE, this->mTableId, 2u, 0u, nullptr);
+    operations.emplace_back(WriteType::REMOVE, this->mTableId, 3u, 0u, nullptr);
+    operations.emplace_back(WriteType::INSERT, this->mTableId + 1, 4u, size, rec.get());
+
+    std::vector<int> results(operations.size(), -1);
+    this->mStorage->batchWrite(operations.data(), operations.size(), tx, results.data());
+    EXPECT_EQ(0, results[0]);
+    EXPECT_EQ(0, results[1]);
+    EXPECT_EQ(0, results[2]);
+    EXPECT_EQ(0, results[3]);
+    EXPECT_EQ(error::invalid_write, results[4]) << "Removing a non existing tuple must fail";
+    EXPECT_EQ(error::invalid_table, results[5]) << "Writing to a non existing table must fail";
+
+    std::unique_ptr<char[]> dest;
+    EXPECT_EQ(0, this->mStorage->get(this->mTableId, 1u, tx, [&dest] (size_t size, uint64_t, bool) {
+        dest.reset(new char[size]);
+        return dest.get();
+    }));
+    EXPECT_EQ(error::not_found, this->mStorage->get(this->mTableId, 2u, tx, [&dest] (size_t size, uint64_t, bool) {
+        dest.reset(new char[size]);
+        return dest.get();
+    }));
+    tx.commit();
+}
+
+TYPED_TEST(StorageTest, batch_write_reserved) {
+    crossbow::allocator _;
+    Record record(this->mSchema);
+    Record::id_t fooField;
+    ASSERT_TRUE(record.idOf("foo", fooField)) << "Field not found";
+
+    std::vector<std::unique_ptr<char[]>> tuples;
+    auto createTuple = [&record, &tuples] (int32_t value, size_t& size) {
+        tuples.emplace_back(record.create(GenericTuple({
+                std::make_pair<crossbow::string, boost::any>("foo", value)
+        }), size));
+        return tuples.back().get();
+    };
+    auto executeBatch = [this] (const std::vector<WriteOperation>& operations,
+            const commitmanager::SnapshotDescriptor& snapshot) {
+        std::vector<int> results(operations.size(), -1);
+        this->mStorage->batchWrite(operations.data(), operations.size(), snapshot, results.data());
+        for (size_t i = 0; i < results.size(); ++i) {
+            EXPECT_EQ(0, results[i]) << "Operation " << i << " of the batch failed";
+        }
+    };
+
+    // Insert keys 1 to 100 with their key as value
+    {
+        auto tx = this->mCommitManager.startTx();
+        std::vector<WriteOperation> operations;
+        for (uint64_t key = 1; key <= 100; ++key) {
+            size_t size;
+            auto data = createTuple(static_cast<int32_t>(key), size);
+            operations.emplace_back(WriteType::INSERT, this->mTableId, key, size, data);
+        }
+        executeBatch(operations, tx);
+        tx.commit();
+    }
+
+    // Remove keys 1 to 10 and update keys 11 to 20
+    {
+        auto tx = this->mCommitManager.startTx();
+        std::vector<WriteOperation> operations;
+        for (uint64_t key = 1; key <= 20; ++key) {
+            if (key <= 10) {
+                operations.emplace_back(WriteType::REMOVE, this->mTableId, key, 0u, nullptr);
+            } else {
+                size_t size;
+                auto data = createTuple(static_cast<int32_t>(key + 1000), size);
+                operations.emplace_back(WriteType::UPDATE, this->mTableId, key, size, data);
+            }
+        }
+        executeBatch(operations, tx);
+        tx.commit();
+    }
+
+    // Insert the removed keys again (these inserts overwrite the deletions instead of using their reserved entry)
+    {
+        auto tx = this->mCommitManager.startTx();
+        std::vector<WriteOperation> operations;
+        for (uint64_t key = 1; key <= 10; ++key) {
+            size_t size;
+            auto data = createTuple(static_cast<int32_t>(key + 2000), size);
+            operations.emplace_back(WriteType::INSERT, this->mTableId, key, size, data);
+        }
+        executeBatch(operations, tx);
+        tx.commit();
+    }
+
+    auto tx = this->mCommitManager.startTx();
+    for (uint64_t key = 1; key <= 100; ++key) {
+        std::unique_ptr<char[]> dest;
+        ASSERT_EQ(0, this->mStorage->get(this->mTableId, key, tx, [&dest] (size_t size, uint64_t, bool) {
+            dest.reset(new char[size]);
+            return dest.get();
+        })) << "Key " << key << " not found";
+
+        bool isNull;
+        auto value = *reinterpret_cast<const int32_t*>(record.data(dest.get(), fooField, isNull));
+        auto expected = static_cast<int32_t>(key <= 10 ? key + 2000 : (key <= 20 ? key + 1000 : key));
+        EXPECT_EQ(expected, value) << "Wrong value for key " << key;
+    }
+    tx.commit();
+    this->mStorage->forceGC();
+}
+
+TYPED_TEST(StorageTest, index_scan) {
+    crossbow::allocator _;
+    Record record(this->mSchema);
+    auto& fields = this->mSchema.indexes().at("fooIndex").second;
+
+    auto insertTuple = [this, &record] (const commitmanager::SnapshotDescriptor& snapshot, uint64_t key,
+            int32_t value, bool update) {
+        size_t size;
+        std::unique_ptr<char[]> rec(record.create(GenericTuple({
+                std::make_pair<crossbow::string, boost::any>("foo", value)
+        }), size));
+        return (update ? this->mStorage->update(this->mTableId, key, size, rec.get(), snapshot)
+                       : this->mStorage->insert(this->mTableId, key, size, rec.get(), snapshot));
+    };
+    auto scanKeys = [this, &record, &fields] (const commitmanager::SnapshotDescriptor& snapshot, int32_t lower,
+            int32_t upper) {
+        std::vector<uint64_t> keys;
+        std::unique_ptr<char[]> dest;
+        auto res = this->mStorage->indexScan(this->mTableId, "fooIndex",
+                record.indexKey(GenericTuple({std::make_pair<crossbow::string, boost::any>("foo", lower)}), fields),
+                record.indexKey(GenericTuple({std::make_pair<crossbow::string, boost::any>("foo", upper)}), fields),
+                snapshot, [&keys, &dest] (uint64_t key, size_t size, uint64_t /* version */, bool /* isNewest */) {
+            keys.emplace_back(key);
+            dest.reset(new char[size]);
+            return dest.get();
+        });
+        EXPECT_EQ(0, res) << "Index scan failed";
+        return keys;
+    };
+
+    auto tx = this->mCommitManager.startTx();
+    ASSERT_EQ(0, insertTuple(tx, 1u, 30, false));
+    ASSERT_EQ(0, insertTuple(tx, 2u, -10, false));
+    ASSERT_EQ(0, insertTuple(tx, 3u, 20, false));
+    EXPECT_EQ(std::vector<uint64_t>({3u, 1u}), scanKeys(tx, 15, 30)) << "Range must be returned in index order";
+    EXPECT_EQ(std::vector<uint64_t>({2u}), scanKeys(tx, -10, -10)) << "Point lookup must find negative values";
+    tx.commit();
+
+    auto tx2 = this->mCommitManager.startTx();
+    ASSERT_EQ(0, insertTuple(tx2, 1u, 5, true));
+    EXPECT_EQ(std::vector<uint64_t>({3u}), scanKeys(tx2, 15, 30)) << "Overwritten values must not be returned";
+    EXPECT_EQ(std::vector<uint64_t>({1u}), scanKeys(tx2, 5, 5)) << "Updated value must be returned";
+
+    auto tx3 = this->mCommitManager.startTx();
+    EXPECT_EQ(std::vector<uint64_t>({3u, 1u}), scanKeys(tx3, 15, 30)) << "Snapshot must not see uncommitted update";
+    EXPECT_EQ(error::invalid_index, this->mStorage->indexScan(this->mTableId, "barIndex", std::string(),
+            std::string(), tx3, [] (uint64_t, size_t, uint64_t, bool) -> char* {
+        return nullptr;
+    })) << "Scanning a non existing index must fail";
+    tx3.commit();
+    tx2.commit();
+}
+
+TYPED_TEST(StorageTest, embedded_scan) {
+    crossbow::allocator _;
+    Record record(this->mSchema);
+
+    StorageConfig config;
+    config.totalMemory = 0x10000000ull;
+    config.numScanThreads = 2u;
+    config.hashMapCapacity = 0x100000ull;
+    EmbeddedStore<TypeParam> store(config, 0x1000u);
+
+    uint64_t tableId = 0u;
+    ASSERT_TRUE(store.createTable("embeddedTable", this->mSchema, tableId)) << "Creating table failed";
+
+    auto tx = this->mCommitManager.startTx();
+    for (uint64_t key = 1; key <= 1000; ++key) {
+        size_t size;
+        std::unique_ptr<char[]> rec(record.create(GenericTuple({
+                std::make_pair<crossbow::string, boost::any>("foo", static_cast<int32_t>(key))
+        }), size));
+        ASSERT_EQ(0, store.insert(tableId, key, size, rec.get(), tx)) << "This insert must not fail!";
+    }
+
+    std::string data;
+    uint64_t version = 0u;
+    bool isNewest = false;
+    ASSERT_EQ(0, store.get(tableId, 500u, tx, data, version, isNewest)) << "Tuple not found";
+    EXPECT_EQ(tx->version(), version);
+    EXPECT_TRUE(isNewest);
+
+    // Full scan without predicates over the keys [100, 200)
+    uint32_t selectionLength = 16u;
+    std::unique_ptr<char[]> selection(new char[selectionLength]);
+    memset(selection.get(), 0, selectionLength);
+
+    std::mutex keysMutex;
+    std::vector<uint64_t> keys;
+    auto ec = store.scan(tableId, tx, ScanQueryType::FULL, std::move(selection), selectionLength, nullptr, 0u,
+            [&record, &keysMutex, &keys] (const char* start, const char* end) {
+        std::unique_lock<decltype(keysMutex)> _(keysMutex);
+        while (start < end) {
+            keys.emplace_back(*reinterpret_cast<const uint64_t*>(start));
+            start += sizeof(uint64_t);
+            start += record.sizeOfTuple(start);
+        }
+    }, 100u, 200u);
+    ASSERT_EQ(0, ec) << "Scan failed";
+
+    std::sort(keys.begin(), keys.end());
+    ASSERT_EQ(100u, keys.size());
+    EXPECT_EQ(100u, keys.front());
+    EXPECT_EQ(199u, keys.back());
+    tx.commit();
+}
+
+/**
+ * @brief Creates a selection without any predicates
+ */
+std::unique_ptr<char[]> emptySelection(size_t& selectionLength) {
+    selectionLength = 16u;
+    std::unique_ptr<char[]> selection(new char[selectionLength]);
+    memset(selection.get(), 0, selectionLength);
+    return selection;
+}
+
+/**
+ * @brief Writes a tuple with the field foo set to key + offset for every key in [begin, end)
+ *
+ * Keys without a tuple are inserted, existing tuples are updated.
+ */
+template <typename Store>
+void writeRange(Store& store, uint64_t tableId, const Record& record, const commitmanager::SnapshotDescriptor& snapshot,
+        uint64_t begin, uint64_t end, int32_t offset, bool update = false) {
+    for (auto key = begin; key < end; ++key) {
+        size_t size;
+        std::unique_ptr<char[]> rec(record.create(GenericTuple({
+                std::make_pair<crossbow::string, boost::any>("foo", static_cast<int32_t>(key) + offset)
+        }), size));
+        auto ec = (update ? store.update(tableId, key, size, rec.get(), snapshot)
+                : store.insert(tableId, key, size, rec.get(), snapshot));
+        EXPECT_EQ(0, ec) << "Writing key " << key << " failed";
+    }
+}
+
+/**
+ * @brief Scans the tuples in the key range [lowKey, highKey) and returns the key and field foo ordered by key
+ */
+template <typename Store>
+std::vector<std::pair<uint64_t, int32_t>> scanRange(Store& store, uint64_t tableId, const Record& record,
+        const commitmanager::SnapshotDescriptor& snapshot, uint64_t lowKey, uint64_t highKey) {
+    Record::id_t fooField;
+    EXPECT_TRUE(record.idOf("foo", fooField)) << "Field not found";
+
+    size_t selectionLength;
+    auto selection = emptySelection(selectionLength);
+
+    std::mutex tuplesMutex;
+    std::vector<std::pair<uint64_t, int32_t>> tuples;
+    auto ec = store.scan(tableId, snapshot, ScanQueryType::FULL, std::move(selection), selectionLength, nullptr, 0u,
+            [&record, fooField, &tuplesMutex, &tuples] (const char* start, const char* end) {
+        std::unique_lock<decltype(tuplesMutex)> _(tuplesMutex);
+        while (start < end) {
+            auto key = *reinterpret_cast<const uint64_t*>(start);
+            start += sizeof(uint64_t);
+
+            bool isNull;
+            auto value = *reinterpret_cast<const int32_t*>(record.data(start, fooField, isNull));
+            tuples.emplace_back(key, value);
+            start += record.sizeOfTuple(start);
+        }
+    }, lowKey, highKey);
+    EXPECT_EQ(0, ec) << "Scan failed";
+
+    std::sort(tuples.begin(), tuples.end());
+    return tuples;
+}
+
+/**
+ * @brief Expected result of scanRange when field foo is set to key + offset for every key in [begin, end)
+ */
+std::vector<std::pair<uint64_t, int32_t>> expectedRange(uint64_t begin, uint64_t end, int32_t offset) {
+    std::vector<std::pair<uint64_t, int32_t>> result;
+    for (auto key = begin; key < end; ++key) {
+        result.emplace_back(key, static_cast<int32_t>(key) + offset);
+    }
+    return result;
+}
+
+TYPED_TEST(StorageTest, embedded_scan_empty_range) {
+    crossbow::allocator _;
+    Record record(this->mSchema);
+
+    StorageConfig config;
+    config.totalMemory = 0x10000000ull;
+    config.numScanThreads = 2u;
+    config.hashMapCapacity = 0x100000ull;
+    EmbeddedStore<TypeParam> store(config, 0x1000u);
+
+    uint64_t tableId = 0u;
+    ASSERT_TRUE(store.createTable("embeddedTable", this->mSchema, tableId)) << "Creating table failed";
+
+    {
+        auto tx = this->mCommitManager.startTx();
+        writeRange(store, tableId, record, tx, 1u, 1001u, 0);
+        tx.commit();
+    }
+    store.runGC();
+
+    auto tx = this->mCommitManager.startTx();
+    EXPECT_TRUE(scanRange(store, tableId, record, tx, 500u, 500u).empty()) << "Empty range must not return tuples";
+    EXPECT_TRUE(scanRange(store, tableId, record, tx, 2000u, 3000u).empty())
+            << "Range after the last key must not return tuples";
+    EXPECT_TRUE(scanRange(store, tableId, record, tx, 0u, 1u).empty())
+            << "Range before the first key must not return tuples";
+    EXPECT_EQ(expectedRange(1000u, 1001u, 0), scanRange(store, tableId, record, tx, 1000u, ScanQuery::UNBOUNDED_KEY))
+            << "Range without upper bound must return the last key";
+    tx.commit();
+}
+
+TYPED_TEST(StorageTest, embedded_scan_rewritten_pages) {
+    crossbow::allocator _;
+    Record record(this->mSchema);
+
+    StorageConfig config;
+    config.totalMemory = 0x10000000ull;
+    config.numScanThreads = 2u;
+    config.hashMapCapacity = 0x100000ull;
+    EmbeddedStore<TypeParam> store(config, 0x1000u);
+
+    uint64_t tableId = 0u;
+    ASSERT_TRUE(store.createTable("embeddedTable", this->mSchema, tableId)) << "Creating table failed";
+
+    // Move the initial tuples to the main
+    {
+        auto tx = this->mCommitManager.startTx();
+        writeRange(store, tableId, record, tx, 1u, 10001u, 0);
+        tx.commit();
+    }
+    store.runGC();
+
+    // Update and remove keys in the middle of the range and rewrite the pages holding them while an older snapshot
+    // still requires the previous versions
+    auto oldTx = this->mCommitManager.startTx();
+    {
+        auto tx = this->mCommitManager.startTx();
+        writeRange(store, tableId, record, tx, 4000u, 4500u, 100000, true);
+        for (uint64_t key = 4500u; key < 5500u; ++key) {
+            EXPECT_EQ(0, store.remove(tableId, key, tx)) << "Removing key " << key << " failed";
+        }
+        writeRange(store, tableId, record, tx, 5500u, 6000u, 100000, true);
+        tx.commit();
+    }
+    store.runGC();
+
+    // Keys inserted after the GC are still in the insert log
+    {
+        auto tx = this->mCommitManager.startTx();
+        writeRange(store, tableId, record, tx, 10001u, 10101u, 0);
+        tx.commit();
+    }
+
+    auto tx = this->mCommitManager.startTx();
+    auto expected = expectedRange(3000u, 4000u, 0);
+    auto updated = expectedRange(4000u, 4500u, 100000);
+    expected.insert(expected.end(), updated.begin(), updated.end());
+    updated = expectedRange(5500u, 6000u, 100000);
+    expected.insert(expected.end(), updated.begin(), updated.end());
+    auto unchanged = expectedRange(6000u, 7000u, 0);
+    expected.insert(expected.end(), unchanged.begin(), unchanged.end());
+    EXPECT_EQ(expected, scanRange(store, tableId, record, tx, 3000u, 7000u))
+            << "Range across rewritten pages must return the newest values";
+
+    EXPECT_EQ(expectedRange(9950u, 10101u, 0), scanRange(store, tableId, record, tx, 9950u, 10101u))
+            << "Range across main and insert log must return all tuples";
+
+    EXPECT_EQ(expectedRange(4400u, 4600u, 0), scanRange(store, tableId, record, oldTx, 4400u, 4600u))
+            << "Older snapshot must see the values before the rewrite";
+    tx.commit();
+    oldTx.commit();
+}
+
+TYPED_TEST(StorageTest, embedded_aggregation_range) {
+    crossbow::allocator _;
+    Record record(this->mSchema);
+
+    StorageConfig config;
+    config.totalMemory = 0x10000000ull;
+    config.numScanThreads = 2u;
+    config.hashMapCapacity = 0x100000ull;
+    EmbeddedStore<TypeParam> store(config, 0x1000u);
+
+    uint64_t tableId = 0u;
+    ASSERT_TRUE(store.createTable("embeddedTable", this->mSchema, tableId)) << "Creating table failed";
+
+    // Keys [1, 1001) are in the main, keys [1001, 1101) in the insert log
+    {
+        auto tx = this->mCommitManager.startTx();
+        writeRange(store, tableId, record, tx, 1u, 1001u, 0);
+        tx.commit();
+    }
+    store.runGC();
+    {
+        auto tx = this->mCommitManager.startTx();
+        writeRange(store, tableId, record, tx, 1001u, 1101u, 0);
+        tx.commit();
+    }
+
+    Record::id_t fooField;
+    ASSERT_TRUE(record.idOf("foo", fooField)) << "Field not found";
+
+    Schema resultSchema(TableType::UNKNOWN);
+    resultSchema.addField(FieldType::BIGINT, "sum", false);
+    resultSchema.addField(FieldType::INT, "min", false);
+    resultSchema.addField(FieldType::INT, "max", false);
+    resultSchema.addField(FieldType::BIGINT, "cnt", true);
+    Record resultRecord(std::move(resultSchema));
+
+    Record::id_t sumField, minField, maxField, cntField;
+    ASSERT_TRUE(resultRecord.idOf("sum", sumField) && resultRecord.idOf("min", minField)
+            && resultRecord.idOf("max", maxField) && resultRecord.idOf("cnt", cntField)) << "Field not found";
+
+    auto aggregate = [&store, tableId, fooField, &resultRecord, sumField, minField, maxField, cntField]
+            (const commitmanager::SnapshotDescriptor& snapshot, uint64_t lowKey, uint64_t highKey, int64_t& sum,
+            int32_t& min, int32_t& max, int64_t& cnt) {
+        size_t selectionLength;
+        auto selection = emptySelection(selectionLength);
+
+        size_t aggregationLength = 16u;
+        std::unique_ptr<char[]> aggregation(new char[aggregationLength]);
+        crossbow::buffer_writer aggregationWriter(aggregation.get(), aggregationLength);
+        aggregationWriter.write<uint16_t>(fooField);
+        aggregationWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::SUM));
+        aggregationWriter.write<uint16_t>(fooField);
+        aggregationWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::MIN));
+        aggregationWriter.write<uint16_t>(fooField);
+        aggregationWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::MAX));
+        aggregationWriter.write<uint16_t>(fooField);
+        aggregationWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::CNT));
+
+        sum = 0;
+        min = std::numeric_limits<int32_t>::max();
+        max = std::numeric_limits<int32_t>::min();
+        cnt = 0;
+        std::mutex resultMutex;
+        auto ec = store.scan(tableId, snapshot, ScanQueryType::AGGREGATION, std::move(selection), selectionLength,
+                std::move(aggregation), aggregationLength,
+                [&resultRecord, sumField, minField, maxField, cntField, &resultMutex, &sum, &min, &max, &cnt]
+                (const char* start, const char* end) {
+            std::unique_lock<decltype(resultMutex)> _(resultMutex);
+            while (start < end) {
+                start += sizeof(uint64_t);
+
+                // Partial results of processors without any matching tuple are NULL
+                bool isNull;
+                auto value = resultRecord.data(start, sumField, isNull);
+                if (!isNull) {
+                    sum += *reinterpret_cast<const int64_t*>(value);
+                    min = std::min(min, *reinterpret_cast<const int32_t*>(resultRecord.data(start, minField, isNull)));
+                    max = std::max(max, *reinterpret_cast<const int32_t*>(resultRecord.data(start, maxField, isNull)));
+                }
+                cnt += *reinterpret_cast<const int64_t*>(resultRecord.data(start, cntField, isNull));
+                start += resultRecord.staticSize();
+            }
+        }, lowKey, highKey);
+        EXPECT_EQ(0, ec) << "Scan failed";
+    };
+
+    auto tx = this->mCommitManager.startTx();
+    int64_t sum;
+    int32_t min;
+    int32_t max;
+    int64_t cnt;
+
+    // The range covers main pages and insert log entries
+    aggregate(tx, 900u, 1050u, sum, min, max, cnt);
+    EXPECT_EQ(150, cnt) << "Tuples outside of the key range must not be counted";
+    EXPECT_EQ((900 + 1049) * 150 / 2, sum);
+    EXPECT_EQ(900, min);
+    EXPECT_EQ(1049, max);
+
+    // The range only covers main pages
+    aggregate(tx, 10u, 20u, sum, min, max, cnt);
+    EXPECT_EQ(10, cnt);
+    EXPECT_EQ((10 + 19) * 10 / 2, sum);
+    EXPECT_EQ(10, min);
+    EXPECT_EQ(19, max);
+
+    aggregate(tx, 5000u, 6000u, sum, min, max, cnt);
+    EXPECT_EQ(0, cnt) << "Empty range must not count any tuples";
+    EXPECT_EQ(0, sum);
+    tx.commit();
+}
+
 TYPED_TEST(StorageTest, concurrent_transactions) {
     Record record(this->mSchema);
 
@@ -0,0 +1,92 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#include <util/LLVMCodeCache.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+using namespace tell::store;
+
+namespace {
+
+LLVMCodeCache::EntryPtr createEntry(uint32_t numConjunct) {
+    auto entry = std::make_shared<LLVMCodeCacheEntry>();
+    entry->numConjunct = numConjunct;
+    return entry;
+}
+
+/**
+ * @class LLVMCodeCache
+ * @test Check if a lookup after insert returns the entry and a lookup of an unknown key misses
+ */
+TEST(LLVMCodeCacheTest, insertAndLookup) {
+    LLVMCodeCache cache(4u);
+    auto entry = createEntry(1u);
+    cache.insert("a", entry);
+
+    EXPECT_EQ(entry, cache.lookup("a"));
+    EXPECT_EQ(nullptr, cache.lookup("b"));
+    EXPECT_EQ(1u, cache.hits());
+    EXPECT_EQ(1u, cache.misses());
+}
+
+/**
+ * @class LLVMCodeCache
+ * @test Check if the least recently used entry is evicted when the cache is full
+ */
+TEST(LLVMCodeCacheTest, evictLeastRecentlyUsed) {
+    LLVMCodeCache cache(2u);
+    auto entry1 = createEntry(1u);
+    auto entry2 = createEntry(2u);
+    auto entry3 = createEntry(3u);
+    cache.insert("a", entry1);
+    cache.insert("b", entry2);
+
+    // Touch a so that b becomes the least recently used entry
+    EXPECT_EQ(entry1, cache.lookup("a"));
+    cache.insert("c", entry3);
+
+    EXPECT_EQ(2u, cache.size());
+    EXPECT_EQ(1u, cache.evictions());
+    EXPECT_EQ(entry1, cache.lookup("a"));
+    EXPECT_EQ(nullptr, cache.lookup("b"));
+    EXPECT_EQ(entry3, cache.lookup("c"));
+
+    // The evicted entry must still be valid for any holder
+    EXPECT_EQ(2u, entry2->numConjunct);
+}
+
+/**
+ * @class LLVMCodeCache
+ * @test Check if a cache with capacity 0 never stores entries
+ */
+TEST(LLVMCodeCacheTest, disabled) {
+    LLVMCodeCache cache(0u);
+    cache.insert("a", createEntry(1u));
+
+    EXPECT_EQ(0u, cache.size());
+    EXPECT_EQ(nullptr, cache.lookup("a"));
+}
+
+}
@@ -0,0 +1,437 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#include <config.h>
+
+#include <deltamain/DeltaMainRewriteStore.hpp>
+#include <logstructured/LogstructuredMemoryStore.hpp>
+
+#include "DummyCommitManager.hpp"
+
+#include <util/EmbeddedStore.hpp>
+
+#include <crossbow/alignment.hpp>
+#include <crossbow/allocator.hpp>
+#include <crossbow/byte_buffer.hpp>
+#include <crossbow/enum_underlying.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace tell;
+using namespace tell::store;
+
+namespace {
+
+/// Values stored in the number column, contains the boundaries of the 32 bit range
+const std::vector<int32_t> gNumbers = {
+    std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::min() + 1, -4097, -100, -6, -5, -1, 0, 1, 5,
+    6, 7, 12, 100, 4095, 4096, std::numeric_limits<int32_t>::max() - 1, std::numeric_limits<int32_t>::max()
+};
+
+/// Offset of the keys of the tuples that are not yet garbage collected (i.e. stay in the log)
+constexpr uint64_t gLogKeyOffset = 1000u;
+
+/**
+ * @brief Value of the big column of the tuple with the given number
+ *
+ * Maps the number range onto the full 64 bit range.
+ */
+int64_t bigValue(int32_t number) {
+    return static_cast<int64_t>(number) * 0x100000000ll + (number < 0 ? 0 : 0xFFFFFFFFll);
+}
+
+/**
+ * @brief Value of the text column of the tuple with the given number
+ */
+crossbow::string textValue(int32_t number) {
+    return crossbow::string("text") + crossbow::to_string(number);
+}
+
+/**
+ * @brief Creates a selection with a single IN_LIST or BETWEEN predicate on a fixed size column
+ *
+ * The values are written into 8 byte slots in the format of the column.
+ */
+std::unique_ptr<char[]> createListSelection(Record::id_t column, FieldType type, PredicateType predicate,
+        const std::vector<int64_t>& values, size_t& selectionLength) {
+    selectionLength = 32u + values.size() * 8u;
+    std::unique_ptr<char[]> selection(new char[selectionLength]);
+    memset(selection.get(), 0, selectionLength);
+
+    crossbow::buffer_writer writer(selection.get(), selectionLength);
+    writer.write<uint32_t>(0x1u);
+    writer.write<uint16_t>(0x1u);
+    writer.write<uint16_t>(0x0u);
+    writer.write<uint32_t>(0x0u);
+    writer.write<uint32_t>(0x0u);
+    writer.write<uint16_t>(column);
+    writer.write<uint16_t>(0x1u);
+    writer.set(0, sizeof(uint32_t));
+    writer.write<uint8_t>(crossbow::to_underlying(predicate));
+    writer.write<uint8_t>(0x0u);
+    writer.set(0, sizeof(uint16_t));
+    writer.write<uint32_t>(static_cast<uint32_t>(values.size()));
+    for (auto value : values) {
+        if (type == FieldType::INT) {
+            writer.write<int32_t>(static_cast<int32_t>(value));
+            writer.set(0, sizeof(uint32_t));
+        } else {
+            writer.write<int64_t>(value);
+        }
+    }
+    return selection;
+}
+
+/**
+ * @brief Creates a selection with a single IN_LIST predicate on a variable size column
+ */
+std::unique_ptr<char[]> createTextListSelection(Record::id_t column, const std::vector<crossbow::string>& values,
+        size_t& selectionLength) {
+    selectionLength = 32u;
+    for (auto& value : values) {
+        selectionLength += crossbow::align(sizeof(uint32_t) + value.size(), 8u);
+    }
+    std::unique_ptr<char[]> selection(new char[selectionLength]);
+    memset(selection.get(), 0, selectionLength);
+
+    crossbow::buffer_writer writer(selection.get(), selectionLength);
+    writer.write<uint32_t>(0x1u);
+    writer.write<uint16_t>(0x1u);
+    writer.write<uint16_t>(0x0u);
+    writer.write<uint32_t>(0x0u);
+    writer.write<uint32_t>(0x0u);
+    writer.write<uint16_t>(column);
+    writer.write<uint16_t>(0x1u);
+    writer.set(0, sizeof(uint32_t));
+    writer.write<uint8_t>(crossbow::to_underlying(PredicateType::IN_LIST));
+    writer.write<uint8_t>(0x0u);
+    writer.set(0, sizeof(uint16_t));
+    writer.write<uint32_t>(static_cast<uint32_t>(values.size()));
+    for (auto& value : values) {
+        writer.write<uint32_t>(static_cast<uint32_t>(value.size()));
+        writer.write(value.data(), value.size());
+        writer.align(8u);
+    }
+    return selection;
+}
+
+/**
+ * @brief Tests the range, list and byte map checks generated for BETWEEN and IN_LIST predicates
+ *
+ * Half of the tuples are garbage collected into the main pages, the other half stays in the log so the predicates are
+ * evaluated by every scan kernel of the storage.
+ */
+template <typename Impl>
+class LLVMScanTest : public ::testing::Test {
+protected:
+    LLVMScanTest()
+            : mSchema(TableType::TRANSACTIONAL),
+              mTableId(0u) {
+        StorageConfig config;
+        config.totalMemory = 0x10000000ull;
+        config.numScanThreads = 2u;
+        config.hashMapCapacity = 0x100000ull;
+        mStore.reset(new EmbeddedStore<Impl>(config, 0x1000u));
+
+        mSchema.addField(FieldType::INT, "number", true);
+        mSchema.addField(FieldType::BIGINT, "big", true);
+        mSchema.addField(FieldType::TEXT, "text", true);
+        mRecord = Record(mSchema);
+        mRecord.idOf("number", mNumberField);
+        mRecord.idOf("big", mBigField);
+        mRecord.idOf("text", mTextField);
+    }
+
+    virtual void SetUp() final override {
+        ASSERT_TRUE(mStore->createTable("scanTable", mSchema, mTableId)) << "Creating table failed";
+
+        {
+            auto tx = mCommitManager.startTx();
+            writeNumbers(tx, 1u);
+            tx.commit();
+        }
+        mStore->runGC();
+        {
+            auto tx = mCommitManager.startTx();
+            writeNumbers(tx, gLogKeyOffset + 1u);
+            tx.commit();
+        }
+    }
+
+    void writeNumbers(const commitmanager::SnapshotDescriptor& snapshot, uint64_t firstKey) {
+        for (decltype(gNumbers.size()) i = 0; i < gNumbers.size(); ++i) {
+            auto number = gNumbers[i];
+            size_t size;
+            std::unique_ptr<char[]> rec(mRecord.create(GenericTuple({
+                    std::make_pair<crossbow::string, boost::any>("number", number),
+                    std::make_pair<crossbow::string, boost::any>("big", bigValue(number)),
+                    std::make_pair<crossbow::string, boost::any>("text", textValue(number))
+            }), size));
+            EXPECT_EQ(0, mStore->insert(mTableId, firstKey + i, size, rec.get(), snapshot)) << "Insert failed";
+        }
+    }
+
+    /**
+     * @brief Scans the table with the selection and returns the numbers of all matching tuples in order
+     *
+     * Expects the same tuples from the main pages and the log.
+     */
+    std::vector<int32_t> scanNumbers(std::unique_ptr<char[]> selection, size_t selectionLength) {
+        std::mutex tuplesMutex;
+        std::vector<std::pair<uint64_t, int32_t>> tuples;
+
+        auto tx = mCommitManager.startTx();
+        auto ec = mStore->scan(mTableId, tx, ScanQueryType::FULL, std::move(selection), selectionLength, nullptr, 0u,
+                [this, &tuplesMutex, &tuples] (const char* start, const char* end) {
+            std::unique_lock<decltype(tuplesMutex)> _(tuplesMutex);
+            while (start < end) {
+                auto key = *reinterpret_cast<const uint64_t*>(start);
+                start += sizeof(uint64_t);
+
+                bool isNull;
+                tuples.emplace_back(key, *reinterpret_cast<const int32_t*>(mRecord.data(start, mNumberField, isNull)));
+                start += mRecord.sizeOfTuple(start);
+            }
+        });
+        EXPECT_EQ(0, ec) << "Scan failed";
+        tx.commit();
+
+        std::sort(tuples.begin(), tuples.end());
+        std::vector<int32_t> mainNumbers;
+        std::vector<int32_t> logNumbers;
+        for (auto& tuple : tuples) {
+            (tuple.first > gLogKeyOffset ? logNumbers : mainNumbers).emplace_back(tuple.second);
+        }
+        EXPECT_EQ(mainNumbers, logNumbers) << "Main pages and log return different tuples";
+        return mainNumbers;
+    }
+
+    /**
+     * @brief The numbers satisfying the predicate in order
+     */
+    template <typename Fun>
+    static std::vector<int32_t> expectedNumbers(Fun fun) {
+        std::vector<int32_t> result;
+        for (auto number : gNumbers) {
+            if (fun(number)) {
+                result.emplace_back(number);
+            }
+        }
+        return result;
+    }
+
+    crossbow::allocator mAlloc;
+
+    DummyCommitManager mCommitManager;
+
+    std::unique_ptr<EmbeddedStore<Impl>> mStore;
+
+    Schema mSchema;
+    Record mRecord;
+    Record::id_t mNumberField;
+    Record::id_t mBigField;
+    Record::id_t mTextField;
+
+    uint64_t mTableId;
+};
+
+using LLVMScanTestImplementations = ::testing::Types<DeltaMainRewriteRowStore, DeltaMainRewriteColumnStore,
+        LogstructuredMemoryStore>;
+TYPED_TEST_CASE(LLVMScanTest, LLVMScanTestImplementations);
+
+/**
+ * @class LLVMBuilder
+ * @test Check if a BETWEEN predicate with the lower bound above the upper bound never matches
+ */
+TYPED_TEST(LLVMScanTest, emptyRange) {
+    size_t selectionLength;
+    auto selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::BETWEEN, {6, 5},
+            selectionLength);
+    EXPECT_TRUE(this->scanNumbers(std::move(selection), selectionLength).empty());
+
+    selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::BETWEEN,
+            {std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min()}, selectionLength);
+    EXPECT_TRUE(this->scanNumbers(std::move(selection), selectionLength).empty())
+            << "Reversed full range must not wrap around";
+
+    selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::BETWEEN, {5, 5},
+            selectionLength);
+    EXPECT_EQ(std::vector<int32_t>({5}), this->scanNumbers(std::move(selection), selectionLength))
+            << "Single value range must match the value";
+}
+
+/**
+ * @class LLVMBuilder
+ * @test Check the boundaries of the unsigned distance comparison of BETWEEN predicates
+ */
+TYPED_TEST(LLVMScanTest, rangeBoundaries) {
+    auto min = std::numeric_limits<int32_t>::min();
+    auto max = std::numeric_limits<int32_t>::max();
+
+    size_t selectionLength;
+    auto selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::BETWEEN, {-5, 5},
+            selectionLength);
+    EXPECT_EQ(this->expectedNumbers([] (int32_t number) {
+        return (number >= -5 && number <= 5);
+    }), this->scanNumbers(std::move(selection), selectionLength));
+
+    // The distance to the lower bound exceeds the signed range
+    selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::BETWEEN, {min, max},
+            selectionLength);
+    EXPECT_EQ(gNumbers, this->scanNumbers(std::move(selection), selectionLength));
+
+    selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::BETWEEN, {min, -1},
+            selectionLength);
+    EXPECT_EQ(this->expectedNumbers([] (int32_t number) {
+        return (number < 0);
+    }), this->scanNumbers(std::move(selection), selectionLength));
+
+    selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::BETWEEN, {max - 1, max},
+            selectionLength);
+    EXPECT_EQ(std::vector<int32_t>({max - 1, max}), this->scanNumbers(std::move(selection), selectionLength));
+
+    selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::BETWEEN, {min + 1, max - 1},
+            selectionLength);
+    EXPECT_EQ(this->expectedNumbers([min, max] (int32_t number) {
+        return (number != min && number != max);
+    }), this->scanNumbers(std::move(selection), selectionLength));
+
+    // Same boundaries on a 64 bit column
+    selection = createListSelection(this->mBigField, FieldType::BIGINT, PredicateType::BETWEEN,
+            {std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max()}, selectionLength);
+    EXPECT_EQ(gNumbers, this->scanNumbers(std::move(selection), selectionLength));
+
+    selection = createListSelection(this->mBigField, FieldType::BIGINT, PredicateType::BETWEEN,
+            {bigValue(-1), bigValue(1)}, selectionLength);
+    EXPECT_EQ(std::vector<int32_t>({-1, 0, 1}), this->scanNumbers(std::move(selection), selectionLength));
+}
+
+/**
+ * @class LLVMBuilder
+ * @test Check if short IN_LIST predicates are compared value by value
+ */
+TYPED_TEST(LLVMScanTest, shortList) {
+    size_t selectionLength;
+    auto selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::IN_LIST,
+            {std::numeric_limits<int32_t>::min(), 3, 5, std::numeric_limits<int32_t>::max()}, selectionLength);
+    EXPECT_EQ(std::vector<int32_t>({std::numeric_limits<int32_t>::min(), 5, std::numeric_limits<int32_t>::max()}),
+            this->scanNumbers(std::move(selection), selectionLength));
+}
+
+/**
+ * @class LLVMBuilder
+ * @test Check if IN_LIST predicates with more than 8 values looked up in a byte map match exactly the list values
+ */
+TYPED_TEST(LLVMScanTest, byteMapList) {
+    // 12 values in [-6, 100]: Includes the first and last entry of the map and values between list entries
+    std::vector<int64_t> values = {-6, -5, -2, 0, 1, 2, 3, 6, 12, 50, 99, 100};
+    size_t selectionLength;
+    auto selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::IN_LIST, values,
+            selectionLength);
+    EXPECT_EQ(this->expectedNumbers([&values] (int32_t number) {
+        return std::find(values.begin(), values.end(), number) != values.end();
+    }), this->scanNumbers(std::move(selection), selectionLength))
+            << "Values outside the map (including wrap around of the offset) must not match";
+
+    // Values spread over a range too large for a byte map
+    values = {-4097, -6, -1, 0, 1, 5, 7, 12, 4096};
+    selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::IN_LIST, values,
+            selectionLength);
+    EXPECT_EQ(this->expectedNumbers([&values] (int32_t number) {
+        return std::find(values.begin(), values.end(), number) != values.end();
+    }), this->scanNumbers(std::move(selection), selectionLength));
+
+    // Byte map on a 64 bit column around a value far from zero
+    values.clear();
+    for (int64_t offset = -4; offset <= 4; ++offset) {
+        values.emplace_back(bigValue(0) + offset);
+    }
+    selection = createListSelection(this->mBigField, FieldType::BIGINT, PredicateType::IN_LIST, values,
+            selectionLength);
+    EXPECT_EQ(std::vector<int32_t>({0}), this->scanNumbers(std::move(selection), selectionLength));
+}
+
+/**
+ * @class LLVMBuilder
+ * @test Check if large sparse IN_LIST predicates searched in a sorted array match exactly the list values
+ */
+TYPED_TEST(LLVMScanTest, sortedList) {
+    // 50 scattered values in unsorted order with duplicates: Includes the boundaries of the 32 bit range and values
+    // between and next to the stored numbers
+    std::vector<int64_t> values = {std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min()};
+    for (int64_t i = 0; i < 44; ++i) {
+        values.emplace_back((i % 2 == 0 ? 1 : -1) * (i * 7919 + 13));
+    }
+    values.insert(values.end(), {-6, 4096, 7, -6});
+
+    size_t selectionLength;
+    auto selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::IN_LIST, values,
+            selectionLength);
+    EXPECT_EQ(this->expectedNumbers([&values] (int32_t number) {
+        return std::find(values.begin(), values.end(), number) != values.end();
+    }), this->scanNumbers(std::move(selection), selectionLength));
+
+    // Values smaller than the first and larger than the last entry of the array must not match
+    values = {-100, -5, -1, 0, 1, 5, 6, 12, 100, 4095};
+    selection = createListSelection(this->mNumberField, FieldType::INT, PredicateType::IN_LIST, values,
+            selectionLength);
+    EXPECT_EQ(this->expectedNumbers([&values] (int32_t number) {
+        return std::find(values.begin(), values.end(), number) != values.end();
+    }), this->scanNumbers(std::move(selection), selectionLength));
+
+    // Signed comparison on a 64 bit column
+    values.clear();
+    for (auto number : {std::numeric_limits<int32_t>::min(), -4097, -1, 0, 12, std::numeric_limits<int32_t>::max()}) {
+        values.emplace_back(bigValue(number));
+        values.emplace_back(bigValue(number) + (number < 0 ? 1 : -1));
+    }
+    selection = createListSelection(this->mBigField, FieldType::BIGINT, PredicateType::IN_LIST, values,
+            selectionLength);
+    EXPECT_EQ(std::vector<int32_t>({std::numeric_limits<int32_t>::min(), -4097, -1, 0, 12,
+            std::numeric_limits<int32_t>::max()}), this->scanNumbers(std::move(selection), selectionLength));
+}
+
+/**
+ * @class LLVMScanBuilder
+ * @test Check if an IN_LIST predicate on a variable size column matches like equality predicates on every value
+ */
+TYPED_TEST(LLVMScanTest, textList) {
+    size_t selectionLength;
+    auto selection = createTextListSelection(this->mTextField, {textValue(-5), crossbow::string("text"),
+            textValue(4096), crossbow::string("text10")}, selectionLength);
+    EXPECT_EQ(std::vector<int32_t>({-5, 4096}), this->scanNumbers(std::move(selection), selectionLength))
+            << "Only exact matches of the values must match, not prefixes";
+
+    selection = createTextListSelection(this->mTextField, {textValue(7)}, selectionLength);
+    EXPECT_EQ(std::vector<int32_t>({7}), this->scanNumbers(std::move(selection), selectionLength));
+}
+
+} // anonymous namespace
@@ -146,6 +146,26 @@ TEST_F(LogPageTest, entryIterator) {
     EXPECT_TRUE(end == i) << "Iterator not pointing to end";
 }
 
+/**
+ * @class LogPage
+ * @test Check that appending multiple entries at once splits the block into the individual entries
+ */
+TEST_F(LogPageTest, appendEntries) {
+    uint32_t sizes[] = {31u, 8u, 55u};
+    uint32_t types[] = {1u, 2u, 3u};
+    LogEntry* entries[3];
+    ASSERT_EQ(3u, mPage->appendEntries(sizes, types, 3u, entries)) << "Failed to allocate entries";
+
+    auto i = mPage->begin();
+    for (size_t j = 0; j < 3u; ++j, ++i) {
+        EXPECT_EQ(entries[j], &(*i)) << "Iterator not pointing to entry " << j;
+        EXPECT_EQ(sizes[j], i->size()) << "Size is not the same as in append";
+        EXPECT_EQ(types[j], i->type()) << "Type is not the same as in append";
+        EXPECT_FALSE(i->sealed()) << "Newly created entry is sealed";
+    }
+    EXPECT_TRUE(mPage->end() == i) << "Iterator not pointing to end";
+}
+
 /**
  * @brief Test fixture for testing Log implementation classes
  */
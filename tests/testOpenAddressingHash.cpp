@@ -24,6 +24,8 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 using namespace tell::store;
 
 namespace {
@@ -133,4 +135,53 @@ TEST_F(OpenAddressingTableTest, updateChanged) {
     EXPECT_EQ(&mElement1, mTable.get(10u, 11u));
 }
 
+/**
+ * @class OpenAddressingTable
+ * @test Check if the table grows when inserting more elements than its initial capacity
+ */
+TEST(OpenAddressingTableResizeTest, insertBeyondCapacity) {
+    OpenAddressingTable table(16);
+    std::vector<uint64_t> elements(1024);
+    for (uint64_t i = 0; i < elements.size(); ++i) {
+        EXPECT_TRUE(table.insert(10u, i, &elements[i]));
+    }
+    EXPECT_GE(table.capacity(), elements.size());
+
+    for (uint64_t i = 0; i < elements.size(); ++i) {
+        EXPECT_EQ(&elements[i], table.get(10u, i));
+    }
+    EXPECT_TRUE(table.update(10u, 7u, &elements[7], &elements[8]));
+    EXPECT_EQ(&elements[8], table.get(10u, 7u));
+
+    auto statistics = table.statistics();
+    EXPECT_EQ(elements.size(), statistics.size);
+    EXPECT_LE(statistics.loadFactor, 0.75);
+    EXPECT_GE(statistics.averageProbeLength, 1.0);
+    EXPECT_GE(statistics.maxProbeLength, 1u);
+}
+
+/**
+ * @class OpenAddressingTable
+ * @test Check if iterating over a view returns every element exactly once
+ */
+TEST(OpenAddressingTableResizeTest, forEachView) {
+    OpenAddressingTable table(16);
+    std::vector<uint64_t> elements(100);
+    for (uint64_t i = 0; i < elements.size(); ++i) {
+        EXPECT_TRUE(table.insert(10u, i, &elements[i]));
+    }
+
+    auto view = table.view();
+    std::vector<size_t> seen(elements.size(), 0u);
+    table.forEach(view, 0u, view.capacity(), [&elements, &seen] (uint64_t tableId, uint64_t key, void* ptr) {
+        EXPECT_EQ(10u, tableId);
+        ASSERT_LT(key, elements.size());
+        EXPECT_EQ(&elements[key], ptr);
+        ++seen[key];
+    });
+    for (auto count : seen) {
+        EXPECT_EQ(1u, count);
+    }
+}
+
 }
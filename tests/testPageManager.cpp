@@ -0,0 +1,300 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#include <config.h>
+#include <util/PageManager.hpp>
+
+#include <crossbow/allocator.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace tell::store;
+
+namespace {
+
+class PageManagerTest : public ::testing::Test {
+protected:
+    PageManagerTest()
+            : mPageManager(PageManager::construct(2 * TELL_PAGE_SIZE)) {
+    }
+
+    static bool isZeroed(const void* page) {
+        auto data = reinterpret_cast<const char*>(page);
+        return std::all_of(data, data + TELL_PAGE_SIZE, [] (char c) {
+            return c == 0;
+        });
+    }
+
+    crossbow::allocator mAlloc;
+    PageManager::Ptr mPageManager;
+};
+
+/**
+ * @brief Whether the first system page of the page is backed by physical memory
+ */
+bool isResident(void* page) {
+    unsigned char vec = 0;
+    EXPECT_EQ(0, mincore(page, static_cast<size_t>(sysconf(_SC_PAGESIZE)), &vec));
+    return (vec & 0x1u) != 0;
+}
+
+/**
+ * @brief Reads a single number from a file in procfs (or 0 if the file does not exist)
+ */
+uint64_t readProcValue(const char* path) {
+    uint64_t value = 0u;
+    std::ifstream in(path);
+    in >> value;
+    return value;
+}
+
+/**
+ * @brief Allocates every page, checks the page is zeroed and writable and frees all pages again
+ */
+void checkAllPages(PageManager& pageManager) {
+    std::vector<void*> pages;
+    while (auto page = pageManager.alloc()) {
+        EXPECT_EQ(0u, (reinterpret_cast<const char*>(page) - reinterpret_cast<const char*>(pageManager.data()))
+                % TELL_PAGE_SIZE);
+        EXPECT_EQ(0, *reinterpret_cast<const char*>(page));
+        memset(page, 0xFF, TELL_PAGE_SIZE);
+        pages.emplace_back(page);
+    }
+    EXPECT_EQ(pageManager.size() / TELL_PAGE_SIZE, pages.size());
+    for (auto page : pages) {
+        pageManager.free(page);
+    }
+}
+
+/**
+ * @class PageManager
+ * @test Check if pages released with data are zeroed again when allocated
+ */
+TEST_F(PageManagerTest, allocReturnsZeroedPage) {
+    auto page1 = mPageManager->alloc();
+    auto page2 = mPageManager->alloc();
+    ASSERT_NE(nullptr, page1);
+    ASSERT_NE(nullptr, page2);
+    EXPECT_TRUE(isZeroed(page1));
+    EXPECT_TRUE(isZeroed(page2));
+    EXPECT_EQ(nullptr, mPageManager->alloc());
+
+    memset(page1, 0xFF, TELL_PAGE_SIZE);
+    mPageManager->free(page1);
+
+    auto page = mPageManager->alloc();
+    ASSERT_EQ(page1, page);
+    EXPECT_TRUE(isZeroed(page));
+
+    mPageManager->free(page);
+    mPageManager->free(page2);
+}
+
+/**
+ * @class PageManager
+ * @test Check if uninitialized allocations return pages until the pool is exhausted
+ */
+TEST_F(PageManagerTest, allocUninitialized) {
+    auto page1 = mPageManager->allocUninitialized();
+    auto page2 = mPageManager->allocUninitialized();
+    ASSERT_NE(nullptr, page1);
+    ASSERT_NE(nullptr, page2);
+    EXPECT_NE(page1, page2);
+    EXPECT_EQ(nullptr, mPageManager->allocUninitialized());
+
+    mPageManager->free(page1);
+    mPageManager->free(page2);
+}
+
+/**
+ * @class PageManager
+ * @test Check if the page manager falls back to transparent huge pages when the huge page pool is empty
+ */
+TEST(PageManagerHugePageTest, explicitFallback) {
+    crossbow::allocator _;
+    auto pageManager = PageManager::construct(4 * TELL_PAGE_SIZE, HugePageMode::EXPLICIT);
+    if (readProcValue("/proc/sys/vm/nr_hugepages") == 0u
+            && readProcValue("/proc/sys/vm/nr_overcommit_hugepages") == 0u) {
+        EXPECT_NE(HugePageMode::EXPLICIT, pageManager->hugePages()) << "Huge page pool is empty";
+    }
+    if (pageManager->hugePages() != HugePageMode::NONE) {
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(pageManager->data()) % 0x200000u)
+                << "Region must be aligned to the huge page size";
+    }
+    checkAllPages(*pageManager);
+}
+
+/**
+ * @class PageManager
+ * @test Check if the region requested with transparent huge pages is aligned and usable or falls back to regular pages
+ */
+TEST(PageManagerHugePageTest, transparentFallback) {
+    crossbow::allocator _;
+    auto pageManager = PageManager::construct(4 * TELL_PAGE_SIZE, HugePageMode::TRANSPARENT);
+    EXPECT_NE(HugePageMode::EXPLICIT, pageManager->hugePages());
+    if (pageManager->hugePages() == HugePageMode::TRANSPARENT) {
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(pageManager->data()) % 0x200000u)
+                << "Region must be aligned to the huge page size";
+    }
+    checkAllPages(*pageManager);
+}
+
+/**
+ * @class PageManager
+ * @test Check if regular pages are used when no huge pages are requested
+ */
+TEST(PageManagerHugePageTest, noHugePages) {
+    crossbow::allocator _;
+    auto pageManager = PageManager::construct(4 * TELL_PAGE_SIZE);
+    EXPECT_EQ(HugePageMode::NONE, pageManager->hugePages());
+    checkAllPages(*pageManager);
+}
+
+/**
+ * @class PageManager
+ * @test Check if the region is split into contiguous partitions with the last node holding the remaining pages
+ */
+TEST(PageManagerNumaTest, partitionPages) {
+    crossbow::allocator _;
+    auto pageManager = PageManager::construct(5 * TELL_PAGE_SIZE, HugePageMode::NONE, 2u);
+    ASSERT_EQ(2u, pageManager->numaNodes());
+
+    auto data = reinterpret_cast<char*>(pageManager->data());
+    EXPECT_EQ(0u, pageManager->numaNode(data));
+    EXPECT_EQ(0u, pageManager->numaNode(data + 2 * TELL_PAGE_SIZE));
+    EXPECT_EQ(1u, pageManager->numaNode(data + 3 * TELL_PAGE_SIZE));
+    EXPECT_EQ(1u, pageManager->numaNode(data + 4 * TELL_PAGE_SIZE));
+
+    auto single = PageManager::construct(TELL_PAGE_SIZE, HugePageMode::NONE, 4u);
+    EXPECT_EQ(1u, single->numaNodes()) << "Every node must hold at least one page";
+    checkAllPages(*single);
+}
+
+/**
+ * @class PageManager
+ * @test Check if pages of the calling thread's node are allocated first and freed pages return to their node
+ */
+TEST(PageManagerNumaTest, allocPrefersLocalNode) {
+    crossbow::allocator _;
+    auto pageManager = PageManager::construct(4 * TELL_PAGE_SIZE, HugePageMode::NONE, 2u);
+    ASSERT_EQ(2u, pageManager->numaNodes());
+
+    // The test thread is assumed not to migrate to a different node between the allocations
+    std::vector<void*> pages;
+    for (auto i = 0; i < 4; ++i) {
+        auto page = pageManager->alloc();
+        ASSERT_NE(nullptr, page);
+        pages.emplace_back(page);
+    }
+    EXPECT_EQ(nullptr, pageManager->alloc());
+
+    auto localNode = pageManager->numaNode(pages[0]);
+    EXPECT_EQ(localNode, pageManager->numaNode(pages[1])) << "Local node must be used before stealing";
+    EXPECT_NE(localNode, pageManager->numaNode(pages[2]));
+    EXPECT_NE(localNode, pageManager->numaNode(pages[3]));
+
+    // A page freed on the remote node is taken only after the page of the local node
+    pageManager->freeEmpty(pages[2]);
+    pageManager->freeEmpty(pages[0]);
+    EXPECT_EQ(pages[0], pageManager->alloc());
+    EXPECT_EQ(pages[2], pageManager->alloc());
+
+    for (auto page : pages) {
+        pageManager->free(page);
+    }
+}
+
+/**
+ * @class PageManager
+ * @test Check if releasing the clean pages returns their physical memory and the pages are still zeroed afterwards
+ */
+TEST_F(PageManagerTest, releaseCleanPages) {
+    auto page = mPageManager->alloc();
+    ASSERT_NE(nullptr, page);
+    memset(page, 0, TELL_PAGE_SIZE);
+    EXPECT_TRUE(isResident(page));
+    mPageManager->freeEmpty(page);
+
+    mPageManager->releaseCleanPages();
+    EXPECT_FALSE(isResident(page)) << "Physical memory of the free page must be released";
+    EXPECT_EQ(2u, mPageManager->freePages());
+
+    auto page1 = mPageManager->alloc();
+    auto page2 = mPageManager->alloc();
+    ASSERT_NE(nullptr, page1);
+    ASSERT_NE(nullptr, page2);
+    EXPECT_TRUE(isZeroed(page1));
+    EXPECT_TRUE(isZeroed(page2));
+
+    mPageManager->free(page1);
+    mPageManager->free(page2);
+}
+
+/**
+ * @class PageManager
+ * @test Check if the pressure callback is invoked once when crossing the low watermark and on every failed allocation
+ */
+TEST(PageManagerPressureTest, lowWatermarkCallback) {
+    crossbow::allocator _;
+    auto pageManager = PageManager::construct(32 * TELL_PAGE_SIZE);
+    ASSERT_EQ(2u, pageManager->lowWatermark());
+
+    size_t invocations = 0u;
+    pageManager->setPressureCallback([&invocations] () {
+        ++invocations;
+    });
+
+    std::vector<void*> pages;
+    for (auto i = 0; i < 30; ++i) {
+        pages.emplace_back(pageManager->allocUninitialized());
+        ASSERT_NE(nullptr, pages.back());
+    }
+    EXPECT_EQ(0u, invocations) << "Callback must not be invoked above the low watermark";
+
+    pages.emplace_back(pageManager->allocUninitialized());
+    EXPECT_EQ(1u, invocations) << "Callback must be invoked when the free pages drop below the low watermark";
+
+    pages.emplace_back(pageManager->allocUninitialized());
+    EXPECT_EQ(1u, invocations) << "Callback must only be invoked once when crossing the low watermark";
+
+    EXPECT_EQ(nullptr, pageManager->allocUninitialized());
+    EXPECT_EQ(2u, invocations) << "Callback must be invoked on every failed allocation";
+
+    pageManager->setPressureCallback(std::function<void()>());
+    EXPECT_EQ(nullptr, pageManager->alloc());
+    EXPECT_EQ(2u, invocations) << "Removed callback must not be invoked";
+
+    for (auto page : pages) {
+        pageManager->free(page);
+    }
+}
+
+}
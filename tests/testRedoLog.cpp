@@ -0,0 +1,240 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#include <config.h>
+#include <util/PageManager.hpp>
+#include <util/RedoLog.hpp>
+
+#include <crossbow/allocator.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+using namespace tell::store;
+
+namespace {
+
+class RedoLogTest : public ::testing::Test {
+protected:
+    RedoLogTest()
+            : mPageManager(PageManager::construct(4 * TELL_PAGE_SIZE)),
+              mPath(crossbow::string("/tmp/tellstore-redolog-test.") + crossbow::to_string(::getpid())) {
+    }
+
+    virtual void TearDown() {
+        std::remove(mPath.c_str());
+    }
+
+    std::vector<std::tuple<RedoRecordType, uint64_t, uint64_t, std::string>> replay(uint64_t offset = 0u) {
+        std::vector<std::tuple<RedoRecordType, uint64_t, uint64_t, std::string>> records;
+        RedoLog::replay(mPath, offset, [&records] (RedoRecordType type, const RedoLogEntry& record, uint32_t size) {
+            records.emplace_back(type, record.key, record.version, std::string(record.data(), size));
+        });
+        return records;
+    }
+
+    crossbow::allocator mAlloc;
+    PageManager::Ptr mPageManager;
+    crossbow::string mPath;
+};
+
+/**
+ * @class RedoLog
+ * @test Check if synced records are replayed with their data
+ */
+TEST_F(RedoLogTest, appendAndReplay) {
+    {
+        RedoLog log(*mPageManager, mPath, 1000);
+        EXPECT_TRUE(log.append(RedoRecordType::INSERT, 1u, 10u, 5u, "Hello", 5u));
+        EXPECT_TRUE(log.append(RedoRecordType::REMOVE, 1u, 11u, 6u, nullptr, 0u));
+        log.sync();
+    }
+
+    auto records = replay();
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ(RedoRecordType::INSERT, std::get<0>(records[0]));
+    EXPECT_EQ(10u, std::get<1>(records[0]));
+    EXPECT_EQ(5u, std::get<2>(records[0]));
+    EXPECT_EQ("Hello", std::get<3>(records[0]));
+    EXPECT_EQ(RedoRecordType::REMOVE, std::get<0>(records[1]));
+    EXPECT_EQ(11u, std::get<1>(records[1]));
+    EXPECT_TRUE(std::get<3>(records[1]).empty());
+}
+
+/**
+ * @class RedoLog
+ * @test Check if records are replayed in version order while table creations are replayed first
+ */
+TEST_F(RedoLogTest, replayVersionOrder) {
+    {
+        RedoLog log(*mPageManager, mPath, 1000);
+        EXPECT_TRUE(log.append(RedoRecordType::UPDATE, 1u, 10u, 8u, "B", 1u));
+        EXPECT_TRUE(log.append(RedoRecordType::INSERT, 1u, 10u, 7u, "A", 1u));
+        EXPECT_TRUE(log.append(RedoRecordType::CREATE_TABLE, 1u, 0u, 0u, "T", 1u));
+    }
+
+    auto records = replay();
+    ASSERT_EQ(3u, records.size());
+    EXPECT_EQ(RedoRecordType::CREATE_TABLE, std::get<0>(records[0]));
+    EXPECT_EQ(7u, std::get<2>(records[1]));
+    EXPECT_EQ(8u, std::get<2>(records[2]));
+}
+
+/**
+ * @class RedoLog
+ * @test Check if a truncated log does not replay any records
+ */
+TEST_F(RedoLogTest, truncate) {
+    {
+        RedoLog log(*mPageManager, mPath, 1000);
+        EXPECT_TRUE(log.append(RedoRecordType::INSERT, 1u, 10u, 5u, "Hello", 5u));
+        log.sync();
+        log.truncate();
+    }
+
+    EXPECT_TRUE(replay().empty());
+}
+
+/**
+ * @class RedoLog
+ * @test Check if only the records after a discarded offset are replayed
+ */
+TEST_F(RedoLogTest, discardAndReplayFromOffset) {
+    uint64_t offset;
+    {
+        RedoLog log(*mPageManager, mPath, 1000);
+        EXPECT_TRUE(log.append(RedoRecordType::INSERT, 1u, 10u, 5u, "Hello", 5u));
+        offset = log.sync();
+        EXPECT_TRUE(log.append(RedoRecordType::UPDATE, 1u, 10u, 6u, "World", 5u));
+        log.discard(offset);
+    }
+
+    auto records = replay(offset);
+    ASSERT_EQ(1u, records.size());
+    EXPECT_EQ(RedoRecordType::UPDATE, std::get<0>(records[0]));
+    EXPECT_EQ("World", std::get<3>(records[0]));
+}
+
+
+/**
+ * @class RedoLog
+ * @test Check if appends fail once the page manager runs out of pages and only the appended records are replayed
+ *
+ * Every record fills a complete log page, the page manager only provides the page of the log and one more page.
+ */
+TEST_F(RedoLogTest, appendFailsWithoutPages) {
+    auto pageManager = PageManager::construct(2 * TELL_PAGE_SIZE);
+    std::string data(LogPage::MAX_DATA_SIZE - sizeof(RedoLogEntry), 'x');
+    {
+        RedoLog log(*pageManager, mPath, 1000);
+        EXPECT_TRUE(log.append(RedoRecordType::INSERT, 1u, 10u, 5u, data.data(), data.size()));
+        EXPECT_TRUE(log.append(RedoRecordType::INSERT, 1u, 11u, 5u, data.data(), data.size()));
+        EXPECT_FALSE(log.append(RedoRecordType::INSERT, 1u, 12u, 5u, data.data(), data.size()));
+
+        std::vector<RedoRecord> batch;
+        batch.emplace_back(RedoRecordType::UPDATE, 1u, 13u, 6u, data.data(), data.size());
+        batch.emplace_back(RedoRecordType::UPDATE, 1u, 14u, 6u, data.data(), data.size());
+        EXPECT_EQ(0u, log.append(batch.data(), batch.size()));
+        log.sync();
+    }
+
+    auto records = replay();
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ(10u, std::get<1>(records[0]));
+    EXPECT_EQ(11u, std::get<1>(records[1]));
+    EXPECT_EQ(data, std::get<3>(records[1]));
+}
+
+/**
+ * @class RedoLog
+ * @test Check if completed reservations are replayed with their data while cancelled reservations are skipped
+ */
+TEST_F(RedoLogTest, reserveCompleteAndCancel) {
+    {
+        RedoLog log(*mPageManager, mPath, 1000);
+        RedoRecord insert(RedoRecordType::INSERT, 1u, 10u, 5u, "Hello", 5u);
+        auto insertEntry = log.reserve(insert);
+        ASSERT_NE(nullptr, insertEntry);
+
+        std::vector<RedoRecord> batch;
+        batch.emplace_back(RedoRecordType::UPDATE, 1u, 11u, 6u, "World", 5u);
+        batch.emplace_back(RedoRecordType::REMOVE, 1u, 12u, 6u, nullptr, 0u);
+        std::vector<RedoLogEntry*> batchEntries(batch.size(), nullptr);
+        ASSERT_EQ(2u, log.reserve(batch.data(), batch.size(), batchEntries.data()));
+
+        log.cancel(batchEntries[0]);
+        log.complete(batchEntries[1], batch[1]);
+        log.cancel(insertEntry);
+        log.sync();
+    }
+
+    auto records = replay();
+    ASSERT_EQ(1u, records.size());
+    EXPECT_EQ(RedoRecordType::REMOVE, std::get<0>(records[0]));
+    EXPECT_EQ(12u, std::get<1>(records[0]));
+    EXPECT_EQ(6u, std::get<2>(records[0]));
+}
+
+/**
+ * @class RedoLog
+ * @test Check if a sync waits for an outstanding reservation so records appended after it are written as well
+ */
+TEST_F(RedoLogTest, syncWaitsForReservation) {
+    {
+        RedoLog log(*mPageManager, mPath, 1000);
+        RedoRecord insert(RedoRecordType::INSERT, 1u, 10u, 5u, "Hello", 5u);
+        auto insertEntry = log.reserve(insert);
+        ASSERT_NE(nullptr, insertEntry);
+        EXPECT_TRUE(log.append(RedoRecordType::UPDATE, 1u, 11u, 6u, "World", 5u));
+
+        std::atomic<bool> synced(false);
+        std::thread syncThread([&log, &synced] () {
+            log.sync();
+            synced.store(true);
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_FALSE(synced.load()) << "Sync returned before the reservation was completed";
+
+        log.complete(insertEntry, insert);
+        syncThread.join();
+        EXPECT_TRUE(synced.load());
+
+        // The records must be on disk without a further sync
+        auto records = replay();
+        ASSERT_EQ(2u, records.size());
+        EXPECT_EQ(10u, std::get<1>(records[0]));
+        EXPECT_EQ("Hello", std::get<3>(records[0]));
+        EXPECT_EQ(11u, std::get<1>(records[1]));
+    }
+}
+
+}
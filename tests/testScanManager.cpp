@@ -0,0 +1,207 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#include <util/Scan.hpp>
+#include <util/StorageConfig.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace tell::store;
+
+namespace {
+
+/**
+ * @brief Table stub whose scans either complete immediately or block until they are released
+ */
+class FakeTable {
+public:
+    class ScanProcessor {
+    public:
+        ScanProcessor(FakeTable& table)
+                : mTable(table) {
+        }
+
+        ~ScanProcessor() {
+            ++mTable.finishedProcessors;
+        }
+
+        bool processNext() {
+            if (mTable.blocking.load()) {
+                std::this_thread::yield();
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        FakeTable& mTable;
+    };
+
+    class Scan {
+    public:
+        Scan(FakeTable* table, std::vector<ScanQuery*>, LLVMCodeCache&)
+                : mTable(table) {
+        }
+
+        void prepareMaterialization() {
+        }
+
+        void prepareQuery() {
+        }
+
+        std::vector<std::unique_ptr<ScanProcessor>> startScan(size_t numThreads) {
+            ++mTable->startedScans;
+            std::vector<std::unique_ptr<ScanProcessor>> processors;
+            processors.reserve(numThreads);
+            for (decltype(numThreads) i = 0; i < numThreads; ++i) {
+                processors.emplace_back(new ScanProcessor(*mTable));
+            }
+            return processors;
+        }
+
+    private:
+        FakeTable* mTable;
+    };
+
+    FakeTable(bool blocking)
+            : blocking(blocking),
+              startedScans(0u),
+              finishedProcessors(0u) {
+    }
+
+    std::atomic<bool> blocking;
+    std::atomic<size_t> startedScans;
+    std::atomic<size_t> finishedProcessors;
+};
+
+constexpr size_t gNumThreads = 2u;
+
+/**
+ * @brief Waits until the given condition holds or the timeout expired
+ */
+template <typename Fun>
+bool waitFor(Fun fun) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!fun()) {
+        if (std::chrono::steady_clock::now() > end) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+bool scanFinished(const FakeTable& table) {
+    return table.finishedProcessors.load() == table.startedScans.load() * gNumThreads && table.startedScans.load() != 0;
+}
+
+class ScanManagerTest : public ::testing::Test {
+protected:
+    static StorageConfig createConfig(size_t roundSize) {
+        StorageConfig config;
+        config.numScanThreads = gNumThreads;
+        config.maxActiveScans = 2u;
+        config.scanRoundSize = roundSize;
+        return config;
+    }
+};
+
+/**
+ * @class ScanManager
+ * @test Check if a short scan on another table completes while a long running scan is still active
+ */
+TEST_F(ScanManagerTest, concurrentTables) {
+    FakeTable longTable(true);
+    FakeTable shortTable(false);
+    {
+        ScanManager<FakeTable> manager(createConfig(4u));
+        manager.run();
+
+        EXPECT_EQ(0, manager.scan(1u, &longTable, nullptr));
+        ASSERT_TRUE(waitFor([&longTable] () { return longTable.startedScans.load() == 1u; }));
+        EXPECT_EQ(0, manager.scan(2u, &shortTable, nullptr));
+        EXPECT_TRUE(waitFor([&shortTable] () { return scanFinished(shortTable); }));
+        EXPECT_EQ(0u, longTable.finishedProcessors.load());
+
+        longTable.blocking.store(false);
+        EXPECT_TRUE(waitFor([&longTable] () { return scanFinished(longTable); }));
+    }
+}
+
+/**
+ * @class ScanManager
+ * @test Check if scans exceeding the round size are held back until all scans of the round finished
+ *
+ * The epoch guard is only renewed between rounds, a full round must drain before the next scan starts.
+ */
+TEST_F(ScanManagerTest, roundDrainsBeforeNextScan) {
+    FakeTable longTable(true);
+    FakeTable shortTable(false);
+    FakeTable nextTable(false);
+    {
+        ScanManager<FakeTable> manager(createConfig(2u));
+        manager.run();
+
+        EXPECT_EQ(0, manager.scan(1u, &longTable, nullptr));
+        ASSERT_TRUE(waitFor([&longTable] () { return longTable.startedScans.load() == 1u; }));
+        EXPECT_EQ(0, manager.scan(2u, &shortTable, nullptr));
+        ASSERT_TRUE(waitFor([&shortTable] () { return scanFinished(shortTable); }));
+
+        // The round is full - The scan must not start while the long scan is active
+        EXPECT_EQ(0, manager.scan(3u, &nextTable, nullptr));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_EQ(0u, nextTable.startedScans.load());
+
+        longTable.blocking.store(false);
+        EXPECT_TRUE(waitFor([&longTable] () { return scanFinished(longTable); }));
+        EXPECT_TRUE(waitFor([&nextTable] () { return scanFinished(nextTable); }));
+    }
+}
+
+/**
+ * @class ScanManager
+ * @test Check if a scan on a table with an active scan waits for the active scan even in a new round
+ */
+TEST_F(ScanManagerTest, sameTableWaitsForActiveScan) {
+    FakeTable table(true);
+    {
+        ScanManager<FakeTable> manager(createConfig(4u));
+        manager.run();
+
+        EXPECT_EQ(0, manager.scan(1u, &table, nullptr));
+        ASSERT_TRUE(waitFor([&table] () { return table.startedScans.load() == 1u; }));
+        EXPECT_EQ(0, manager.scan(1u, &table, nullptr));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_EQ(1u, table.startedScans.load());
+
+        table.blocking.store(false);
+        EXPECT_TRUE(waitFor([&table] () { return table.startedScans.load() == 2u && scanFinished(table); }));
+    }
+}
+
+}
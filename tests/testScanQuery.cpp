@@ -0,0 +1,596 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#include <util/LocalScanQuery.hpp>
+#include <util/ScanQuery.hpp>
+
+#include <tellstore/Record.hpp>
+
+#include <crossbow/byte_buffer.hpp>
+#include <crossbow/enum_underlying.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace tell::store;
+
+namespace {
+
+/// Number of distinct values in the field bar
+constexpr int32_t gGroupCount = 5;
+
+/// Count, sum and maximum of the field foo in a group
+using GroupResult = std::tuple<int64_t, int64_t, int32_t>;
+
+class ScanQueryTest : public ::testing::Test {
+protected:
+    ScanQueryTest()
+            : mSchema(TableType::TRANSACTIONAL) {
+        mSchema.addField(FieldType::INT, "foo", true);
+        mSchema.addField(FieldType::INT, "bar", true);
+        mRecord = Record(mSchema);
+        mRecord.idOf("foo", mFooField);
+        mRecord.idOf("bar", mBarField);
+    }
+
+    /**
+     * @brief Creates a scan query without predicates collecting the scan data in mData
+     */
+    std::unique_ptr<LocalScanQuery> createQuery(ScanQueryType queryType, std::unique_ptr<char[]> query,
+            size_t queryLength, uint64_t lowKey = 0x0u, uint64_t highKey = ScanQuery::UNBOUNDED_KEY,
+            uint64_t limit = 0x0u, ScanOrder order = ScanOrder::NONE, Record::id_t orderField = 0x0u) {
+        size_t selectionLength = 16u;
+        std::unique_ptr<char[]> selection(new char[selectionLength]);
+        memset(selection.get(), 0, selectionLength);
+
+        return std::unique_ptr<LocalScanQuery>(new LocalScanQuery(queryType, std::move(selection), selectionLength,
+                std::move(query), queryLength, lowKey, highKey, limit, order, orderField, nullptr, mRecord, 0x1000u,
+                [this] (const char* start, const char* end) {
+            std::unique_lock<decltype(mDataMutex)> _(mDataMutex);
+            mData.append(start, end - start);
+        }));
+    }
+
+    /**
+     * @brief Creates a group by query grouping by the field bar and aggregating the count, sum and maximum of foo
+     */
+    std::unique_ptr<LocalScanQuery> createGroupByQuery(uint64_t lowKey = 0x0u,
+            uint64_t highKey = ScanQuery::UNBOUNDED_KEY) {
+        size_t queryLength = 16u;
+        std::unique_ptr<char[]> query(new char[queryLength]);
+        crossbow::buffer_writer queryWriter(query.get(), queryLength);
+        queryWriter.write<uint16_t>(0x1u);
+        queryWriter.write<uint16_t>(mBarField);
+        queryWriter.write<uint16_t>(mFooField);
+        queryWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::CNT));
+        queryWriter.write<uint16_t>(mFooField);
+        queryWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::SUM));
+        queryWriter.write<uint16_t>(mFooField);
+        queryWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::MAX));
+
+        return createQuery(ScanQueryType::GROUP_BY, std::move(query), queryLength, lowKey, highKey);
+    }
+
+    /**
+     * @brief Aggregates the value into the aggregation state of a group by query created by createGroupByQuery
+     */
+    static void aggregate(const ScanQuery& query, char* state, int32_t value) {
+        auto& record = query.aggregationRecord();
+        Record::id_t cntField, sumField, maxField;
+        record.idOf("0", cntField);
+        record.idOf("1", sumField);
+        record.idOf("2", maxField);
+
+        ++(*reinterpret_cast<int64_t*>(state + record.getFieldMeta(cntField).offset));
+
+        auto& sumMeta = record.getFieldMeta(sumField);
+        *reinterpret_cast<int64_t*>(state + sumMeta.offset) += value;
+        record.setFieldNull(state, sumMeta.nullIdx, false);
+
+        auto& maxMeta = record.getFieldMeta(maxField);
+        auto& maxValue = *reinterpret_cast<int32_t*>(state + maxMeta.offset);
+        if (record.isFieldNull(state, maxMeta.nullIdx) || value > maxValue) {
+            maxValue = value;
+        }
+        record.setFieldNull(state, maxMeta.nullIdx, false);
+    }
+
+    /**
+     * @brief Processes a tuple with the field foo set to the value and bar set to the value modulo the group count
+     *
+     * Group by queries aggregate the tuple into its group with the aggregate function.
+     */
+    void writeTuple(ScanQueryProcessor& processor, uint64_t key, int32_t value) {
+        size_t size;
+        std::unique_ptr<char[]> tuple(mRecord.create(GenericTuple({
+                std::make_pair<crossbow::string, boost::any>("foo", value),
+                std::make_pair<crossbow::string, boost::any>("bar", value % gGroupCount)
+        }), size));
+
+        if (processor.data()->queryType() == ScanQueryType::GROUP_BY) {
+            auto query = processor.data();
+            processor.writeGroupRecord(key, 0u, 0u, [this, query, &tuple] (std::string& groupKey) {
+                query->appendGroupKey(mRecord, tuple.get(), groupKey);
+            }, [query, value] (char* state) {
+                aggregate(*query, state, value);
+            });
+            return;
+        }
+
+        processor.writeRecord(key, size, 0u, 0u, [&tuple, size] (char* dest) {
+            memcpy(dest, tuple.get(), size);
+            return static_cast<uint32_t>(size);
+        });
+    }
+
+    /**
+     * @brief Processes the tuples of the given keys from several scan threads in parallel
+     *
+     * Every thread processes the keys with the same index modulo the number of threads with its own processor, the
+     * field foo is set to the value returned by the value function. All processors are created before the first one
+     * finishes.
+     */
+    template <typename Fun>
+    void writeParallel(ScanQuery& query, size_t numThreads, uint64_t numKeys, Fun valueFun) {
+        std::vector<ScanQueryProcessor> processors;
+        for (decltype(numThreads) i = 0; i < numThreads; ++i) {
+            processors.emplace_back(query.createProcessor());
+        }
+
+        std::vector<std::thread> threads;
+        for (decltype(numThreads) i = 0; i < numThreads; ++i) {
+            threads.emplace_back([this, &processors, i, numThreads, numKeys, valueFun] () {
+                for (auto key = static_cast<uint64_t>(i); key < numKeys; key += numThreads) {
+                    writeTuple(processors[i], key, valueFun(key));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        processors.clear();
+    }
+
+    /**
+     * @brief The keys of all tuples written by the scan in the order they were written
+     */
+    std::vector<uint64_t> writtenKeys() const {
+        std::vector<uint64_t> keys;
+        for (auto& tuple : writtenTuples()) {
+            keys.emplace_back(tuple.first);
+        }
+        return keys;
+    }
+
+    /**
+     * @brief The key and field foo of all tuples written by the scan in the order they were written
+     */
+    std::vector<std::pair<uint64_t, int32_t>> writtenTuples() const {
+        std::vector<std::pair<uint64_t, int32_t>> tuples;
+        auto start = mData.data();
+        auto end = start + mData.size();
+        while (start < end) {
+            auto key = *reinterpret_cast<const uint64_t*>(start);
+            start += sizeof(uint64_t);
+
+            bool isNull;
+            auto value = *reinterpret_cast<const int32_t*>(mRecord.data(start, mFooField, isNull));
+            tuples.emplace_back(key, value);
+            start += mRecord.sizeOfTuple(start);
+        }
+        return tuples;
+    }
+
+    /**
+     * @brief The results of all groups written by a group by query created by createGroupByQuery
+     */
+    std::map<int32_t, GroupResult> writtenGroups(const ScanQuery& query) const {
+        auto& record = query.record();
+        Record::id_t groupField, cntField, sumField, maxField;
+        record.idOf("0", groupField);
+        record.idOf("1", cntField);
+        record.idOf("2", sumField);
+        record.idOf("3", maxField);
+
+        std::map<int32_t, GroupResult> groups;
+        auto start = mData.data();
+        auto end = start + mData.size();
+        while (start < end) {
+            start += sizeof(uint64_t);
+
+            bool isNull;
+            auto group = *reinterpret_cast<const int32_t*>(record.data(start, groupField, isNull));
+            auto result = std::make_tuple(*reinterpret_cast<const int64_t*>(record.data(start, cntField, isNull)),
+                    *reinterpret_cast<const int64_t*>(record.data(start, sumField, isNull)),
+                    *reinterpret_cast<const int32_t*>(record.data(start, maxField, isNull)));
+            EXPECT_TRUE(groups.emplace(group, result).second) << "Group " << group << " written more than once";
+            start += record.sizeOfTuple(start);
+        }
+        return groups;
+    }
+
+    /**
+     * @brief The expected results of the groups when aggregating the given values
+     */
+    static std::map<int32_t, GroupResult> expectedGroups(const std::vector<int32_t>& values) {
+        std::map<int32_t, GroupResult> groups;
+        for (auto value : values) {
+            auto i = groups.emplace(value % gGroupCount, GroupResult(0, 0, value)).first;
+            ++std::get<0>(i->second);
+            std::get<1>(i->second) += value;
+            std::get<2>(i->second) = std::max(std::get<2>(i->second), value);
+        }
+        return groups;
+    }
+
+    Schema mSchema;
+    Record mRecord;
+    Record::id_t mFooField;
+    Record::id_t mBarField;
+
+    /// Data handed to the callback of the scan
+    std::mutex mDataMutex;
+    std::string mData;
+};
+
+/**
+ * @class ScanQuery
+ * @test Check the key range bounds of a query
+ */
+TEST_F(ScanQueryTest, keyRange) {
+    auto query = createQuery(ScanQueryType::FULL, nullptr, 0u, 10u, 20u);
+    EXPECT_TRUE(query->hasKeyRange());
+    EXPECT_FALSE(query->inKeyRange(9u));
+    EXPECT_TRUE(query->inKeyRange(10u));
+    EXPECT_TRUE(query->inKeyRange(19u));
+    EXPECT_FALSE(query->inKeyRange(20u));
+
+    auto openQuery = createQuery(ScanQueryType::FULL, nullptr, 0u, 10u);
+    EXPECT_TRUE(openQuery->hasKeyRange());
+    EXPECT_TRUE(openQuery->inKeyRange(ScanQuery::UNBOUNDED_KEY)) << "Open range must include the largest key";
+
+    auto fullQuery = createQuery(ScanQueryType::FULL, nullptr, 0u);
+    EXPECT_FALSE(fullQuery->hasKeyRange());
+    EXPECT_TRUE(fullQuery->inKeyRange(0u));
+}
+
+/**
+ * @class ScanQueryProcessor
+ * @test Check if only tuples inside the key range are written
+ */
+TEST_F(ScanQueryTest, writeRecordKeyRange) {
+    auto query = createQuery(ScanQueryType::FULL, nullptr, 0u, 10u, 20u);
+    {
+        auto processor = query->createProcessor();
+        for (uint64_t key = 0u; key < 30u; ++key) {
+            writeTuple(processor, key, static_cast<int32_t>(key));
+        }
+    }
+    query->wait();
+
+    std::vector<uint64_t> expected;
+    for (uint64_t key = 10u; key < 20u; ++key) {
+        expected.emplace_back(key);
+    }
+    EXPECT_EQ(expected, writtenKeys());
+}
+
+/**
+ * @class ScanQueryProcessor
+ * @test Check if an aggregation only aggregates tuples inside the key range
+ */
+TEST_F(ScanQueryTest, aggregationKeyRange) {
+    size_t aggregationLength = 4u;
+    std::unique_ptr<char[]> aggregation(new char[aggregationLength]);
+    crossbow::buffer_writer aggregationWriter(aggregation.get(), aggregationLength);
+    aggregationWriter.write<uint16_t>(mFooField);
+    aggregationWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::CNT));
+
+    auto query = createQuery(ScanQueryType::AGGREGATION, std::move(aggregation), aggregationLength, 10u, 20u);
+    auto& resultRecord = query->record();
+    Record::id_t cntField;
+    ASSERT_TRUE(resultRecord.idOf("0", cntField));
+    auto cntOffset = resultRecord.getFieldMeta(cntField).offset;
+
+    {
+        auto processor = query->createProcessor();
+        for (uint64_t key = 0u; key < 30u; ++key) {
+            processor.writeRecord(key, 0u, 0u, 0u, [cntOffset] (char* dest) {
+                ++(*reinterpret_cast<int64_t*>(dest + cntOffset));
+                return 0u;
+            });
+        }
+    }
+    query->wait();
+
+    ASSERT_EQ(sizeof(uint64_t) + resultRecord.staticSize(), mData.size());
+    EXPECT_EQ(10, *reinterpret_cast<const int64_t*>(mData.data() + sizeof(uint64_t) + cntOffset));
+}
+
+/**
+ * @class ScanQueryProcessor
+ * @test Check if an unordered limit smaller than the number of matching tuples stops after the limit
+ */
+TEST_F(ScanQueryTest, limitBelowMatches) {
+    auto query = createQuery(ScanQueryType::FULL, nullptr, 0u, 0x0u, ScanQuery::UNBOUNDED_KEY, 5u);
+    ASSERT_TRUE(query->validLimit());
+    {
+        auto processor = query->createProcessor();
+        for (uint64_t key = 0u; key < 20u; ++key) {
+            EXPECT_EQ(key >= 5u, processor.done());
+            writeTuple(processor, key, static_cast<int32_t>(key));
+        }
+        EXPECT_TRUE(processor.done()) << "Scan must be done after the limit was reached";
+        EXPECT_FALSE(query->claimTuple());
+    }
+    query->wait();
+
+    EXPECT_EQ(std::vector<uint64_t>({0u, 1u, 2u, 3u, 4u}), writtenKeys());
+}
+
+/**
+ * @class ScanQueryProcessor
+ * @test Check if an unordered limit larger than the number of matching tuples returns all tuples
+ */
+TEST_F(ScanQueryTest, limitAboveMatches) {
+    auto query = createQuery(ScanQueryType::FULL, nullptr, 0u, 10u, 30u, 50u);
+    ASSERT_TRUE(query->validLimit());
+    {
+        auto processor = query->createProcessor();
+        for (uint64_t key = 0u; key < 40u; ++key) {
+            writeTuple(processor, key, static_cast<int32_t>(key));
+        }
+        EXPECT_FALSE(processor.done()) << "Tuples outside the key range must not count against the limit";
+    }
+    query->wait();
+
+    std::vector<uint64_t> expected;
+    for (uint64_t key = 10u; key < 30u; ++key) {
+        expected.emplace_back(key);
+    }
+    EXPECT_EQ(expected, writtenKeys());
+}
+
+/**
+ * @class ScanQuery
+ * @test Check if scan threads sharing an unordered limit write exactly limit tuples in total
+ */
+TEST_F(ScanQueryTest, limitParallel) {
+    auto query = createQuery(ScanQueryType::FULL, nullptr, 0u, 0x0u, ScanQuery::UNBOUNDED_KEY, 10u);
+    writeParallel(*query, 4u, 1000u, [] (uint64_t key) {
+        return static_cast<int32_t>(key);
+    });
+    query->wait();
+
+    auto keys = writtenKeys();
+    EXPECT_EQ(10u, keys.size());
+    std::sort(keys.begin(), keys.end());
+    EXPECT_TRUE(std::unique(keys.begin(), keys.end()) == keys.end()) << "Tuples must be written only once";
+}
+
+/**
+ * @class ScanQuery
+ * @test Check if an ascending ordered limit returns the smallest tuples of all scan threads in order
+ */
+TEST_F(ScanQueryTest, orderedLimitAscending) {
+    auto query = createQuery(ScanQueryType::FULL, nullptr, 0u, 0x0u, ScanQuery::UNBOUNDED_KEY, 10u,
+            ScanOrder::ASCENDING, mFooField);
+    ASSERT_TRUE(query->validLimit());
+
+    // Permutation of the values [0, 400) so the smallest values are spread over all threads
+    writeParallel(*query, 4u, 400u, [] (uint64_t key) {
+        return static_cast<int32_t>((key * 37u) % 400u);
+    });
+    query->wait();
+
+    auto tuples = writtenTuples();
+    ASSERT_EQ(10u, tuples.size());
+    for (decltype(tuples.size()) i = 0; i < tuples.size(); ++i) {
+        EXPECT_EQ(static_cast<int32_t>(i), tuples[i].second);
+        EXPECT_EQ(static_cast<int32_t>(i), static_cast<int32_t>((tuples[i].first * 37u) % 400u))
+                << "Key does not belong to the tuple";
+    }
+}
+
+/**
+ * @class ScanQuery
+ * @test Check if a descending ordered limit returns the largest tuples of all scan threads in order
+ */
+TEST_F(ScanQueryTest, orderedLimitDescending) {
+    auto query = createQuery(ScanQueryType::FULL, nullptr, 0u, 0x0u, ScanQuery::UNBOUNDED_KEY, 10u,
+            ScanOrder::DESCENDING, mFooField);
+    ASSERT_TRUE(query->validLimit());
+
+    writeParallel(*query, 4u, 400u, [] (uint64_t key) {
+        return static_cast<int32_t>((key * 37u) % 400u);
+    });
+    query->wait();
+
+    auto tuples = writtenTuples();
+    ASSERT_EQ(10u, tuples.size());
+    for (decltype(tuples.size()) i = 0; i < tuples.size(); ++i) {
+        EXPECT_EQ(static_cast<int32_t>(399u - i), tuples[i].second);
+    }
+}
+
+/**
+ * @class ScanQuery
+ * @test Check if an ordered limit larger than the number of matching tuples returns all tuples in order
+ */
+TEST_F(ScanQueryTest, orderedLimitAboveMatches) {
+    auto query = createQuery(ScanQueryType::FULL, nullptr, 0u, 0x0u, ScanQuery::UNBOUNDED_KEY, 100u,
+            ScanOrder::DESCENDING, mFooField);
+    writeParallel(*query, 3u, 20u, [] (uint64_t key) {
+        return static_cast<int32_t>(key);
+    });
+    query->wait();
+
+    std::vector<uint64_t> expected;
+    for (uint64_t key = 20u; key > 0u; --key) {
+        expected.emplace_back(key - 1u);
+    }
+    EXPECT_EQ(expected, writtenKeys());
+}
+
+/**
+ * @class ScanQuery
+ * @test Check if unsupported limits and orders are rejected
+ */
+TEST_F(ScanQueryTest, invalidLimit) {
+    EXPECT_TRUE(createQuery(ScanQueryType::FULL, nullptr, 0u)->validLimit());
+
+    EXPECT_FALSE(createQuery(ScanQueryType::FULL, nullptr, 0u, 0x0u, ScanQuery::UNBOUNDED_KEY, 0u,
+            ScanOrder::ASCENDING, mFooField)->validLimit()) << "Order without limit must be rejected";
+
+    EXPECT_FALSE(createQuery(ScanQueryType::FULL, nullptr, 0u, 0x0u, ScanQuery::UNBOUNDED_KEY, 10u,
+            ScanOrder::ASCENDING, static_cast<Record::id_t>(mRecord.fieldCount()))->validLimit())
+            << "Order on a non existing field must be rejected";
+
+    EXPECT_FALSE(createQuery(ScanQueryType::FULL, nullptr, 0u, 0x0u, ScanQuery::UNBOUNDED_KEY, 10u,
+            static_cast<ScanOrder>(0xFFu), mFooField)->validLimit()) << "Unknown order must be rejected";
+
+    size_t aggregationLength = 4u;
+    std::unique_ptr<char[]> aggregation(new char[aggregationLength]);
+    crossbow::buffer_writer aggregationWriter(aggregation.get(), aggregationLength);
+    aggregationWriter.write<uint16_t>(mFooField);
+    aggregationWriter.write<uint16_t>(crossbow::to_underlying(AggregationType::CNT));
+    EXPECT_FALSE(createQuery(ScanQueryType::AGGREGATION, std::move(aggregation), aggregationLength, 0x0u,
+            ScanQuery::UNBOUNDED_KEY, 10u)->validLimit()) << "Limit on an aggregation must be rejected";
+
+    // Ordering by a variable size field is not supported
+    Schema textSchema(TableType::TRANSACTIONAL);
+    textSchema.addField(FieldType::TEXT, "text", true);
+    Record textRecord(textSchema);
+    Record::id_t textField;
+    ASSERT_TRUE(textRecord.idOf("text", textField));
+
+    size_t selectionLength = 16u;
+    std::unique_ptr<char[]> selection(new char[selectionLength]);
+    memset(selection.get(), 0, selectionLength);
+    LocalScanQuery textQuery(ScanQueryType::FULL, std::move(selection), selectionLength, nullptr, 0u, 0x0u,
+            ScanQuery::UNBOUNDED_KEY, 10u, ScanOrder::ASCENDING, textField, nullptr, textRecord, 0x1000u,
+            [] (const char* /* start */, const char* /* end */) {
+    });
+    EXPECT_FALSE(textQuery.validLimit()) << "Order on a variable size field must be rejected";
+}
+
+/**
+ * @class ScanQueryProcessor
+ * @test Check if a group by query aggregates every tuple in the key range into its group
+ */
+TEST_F(ScanQueryTest, groupBy) {
+    auto query = createGroupByQuery(10u, 90u);
+    {
+        auto processor = query->createProcessor();
+        for (uint64_t key = 0u; key < 100u; ++key) {
+            writeTuple(processor, key, static_cast<int32_t>(key));
+        }
+    }
+    query->wait();
+
+    std::vector<int32_t> values;
+    for (int32_t value = 10; value < 90; ++value) {
+        values.emplace_back(value);
+    }
+    EXPECT_EQ(expectedGroups(values), writtenGroups(*query));
+}
+
+/**
+ * @class ScanQuery
+ * @test Check if the partial groups of several scan threads are merged into one result per group
+ */
+TEST_F(ScanQueryTest, groupByParallel) {
+    auto query = createGroupByQuery();
+    writeParallel(*query, 4u, 1000u, [] (uint64_t key) {
+        return static_cast<int32_t>((key * 37u) % 1000u);
+    });
+    query->wait();
+
+    std::vector<int32_t> values;
+    for (int32_t value = 0; value < 1000; ++value) {
+        values.emplace_back(value);
+    }
+    EXPECT_EQ(expectedGroups(values), writtenGroups(*query));
+}
+
+/**
+ * @class ScanQuery
+ * @test Check if merging partial groups combines groups present in several partial results and keeps all others
+ */
+TEST_F(ScanQueryTest, mergeGroups) {
+    auto query = createGroupByQuery();
+    auto& aggregationRecord = query->aggregationRecord();
+    auto createState = [&query, &aggregationRecord] (const std::vector<int32_t>& values) {
+        std::unique_ptr<char[]> state(new char[aggregationRecord.staticSize()]);
+        query->initAggregation(state.get());
+        for (auto value : values) {
+            aggregate(*query, state.get(), value);
+        }
+        return state;
+    };
+
+    query->addPartialProcessor();
+    query->addPartialProcessor();
+
+    // Group b is still NULL in the first partial result (i.e. initialized but no value aggregated)
+    ScanQuery::GroupTable first;
+    first.emplace("a", createState({1, 2}));
+    first.emplace("b", createState({}));
+    EXPECT_FALSE(query->mergeGroups(first)) << "Only the last processor must write the groups";
+    EXPECT_TRUE(first.empty());
+
+    ScanQuery::GroupTable second;
+    second.emplace("b", createState({-3, 7}));
+    second.emplace("c", createState({5}));
+    ASSERT_TRUE(query->mergeGroups(second));
+    ASSERT_EQ(3u, second.size());
+
+    Record::id_t cntField, sumField, maxField;
+    aggregationRecord.idOf("0", cntField);
+    aggregationRecord.idOf("1", sumField);
+    aggregationRecord.idOf("2", maxField);
+    auto result = [&aggregationRecord, cntField, sumField, maxField] (const char* state) {
+        bool isNull;
+        return std::make_tuple(*reinterpret_cast<const int64_t*>(aggregationRecord.data(state, cntField, isNull)),
+                *reinterpret_cast<const int64_t*>(aggregationRecord.data(state, sumField, isNull)),
+                *reinterpret_cast<const int32_t*>(aggregationRecord.data(state, maxField, isNull)));
+    };
+    EXPECT_EQ(GroupResult(2, 3, 2), result(second.at("a").get()));
+    EXPECT_EQ(GroupResult(2, 4, 7), result(second.at("b").get()));
+    EXPECT_EQ(GroupResult(1, 5, 5), result(second.at("c").get()));
+
+    auto& sumMeta = aggregationRecord.getFieldMeta(sumField);
+    EXPECT_FALSE(aggregationRecord.isFieldNull(second.at("b").get(), sumMeta.nullIdx));
+}
+
+} // anonymous namespace
@@ -0,0 +1,273 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#include <util/SecondaryIndex.hpp>
+
+#include <crossbow/allocator.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+using namespace tell::store;
+
+namespace {
+
+using Entry = std::tuple<std::string, uint64_t, uint64_t>;
+
+class SecondaryIndexTest : public ::testing::Test {
+protected:
+    SecondaryIndexTest()
+            : mIndex(std::vector<Record::id_t>({0u})) {
+    }
+
+    std::vector<Entry> range(const std::string& lower, const std::string& upper) {
+        std::vector<Entry> result;
+        mIndex.range(lower, upper, [&result] (const std::string& indexKey, uint64_t key, uint64_t version) {
+            result.emplace_back(indexKey, key, version);
+            return true;
+        });
+        return result;
+    }
+
+    SecondaryIndex mIndex;
+};
+
+/**
+ * @class SecondaryIndex
+ * @test Check if the entries are returned ordered by index key, key and version
+ */
+TEST_F(SecondaryIndexTest, insertOrdered) {
+    crossbow::allocator _;
+    EXPECT_TRUE(mIndex.insert("b", 2u, 10u));
+    EXPECT_TRUE(mIndex.insert("a", 3u, 10u));
+    EXPECT_TRUE(mIndex.insert("b", 1u, 12u));
+    EXPECT_TRUE(mIndex.insert("b", 1u, 11u));
+    EXPECT_EQ(4u, mIndex.size());
+
+    std::vector<Entry> expected = {
+        Entry("a", 3u, 10u),
+        Entry("b", 1u, 11u),
+        Entry("b", 1u, 12u),
+        Entry("b", 2u, 10u)
+    };
+    EXPECT_EQ(expected, range(std::string(), std::string()));
+}
+
+/**
+ * @class SecondaryIndex
+ * @test Check if inserting a duplicate entry fails
+ */
+TEST_F(SecondaryIndexTest, insertDuplicate) {
+    crossbow::allocator _;
+    EXPECT_TRUE(mIndex.insert("a", 1u, 10u));
+    EXPECT_FALSE(mIndex.insert("a", 1u, 10u));
+    EXPECT_EQ(1u, mIndex.size());
+}
+
+/**
+ * @class SecondaryIndex
+ * @test Check if the range includes both bounds and the upper bound matches all keys starting with it
+ */
+TEST_F(SecondaryIndexTest, rangeBounds) {
+    crossbow::allocator _;
+    EXPECT_TRUE(mIndex.insert("a", 1u, 10u));
+    EXPECT_TRUE(mIndex.insert("b", 2u, 10u));
+    EXPECT_TRUE(mIndex.insert("bc", 3u, 10u));
+    EXPECT_TRUE(mIndex.insert("c", 4u, 10u));
+
+    std::vector<Entry> expected = {
+        Entry("b", 2u, 10u),
+        Entry("bc", 3u, 10u)
+    };
+    EXPECT_EQ(expected, range("b", "b"));
+
+    expected.emplace_back("c", 4u, 10u);
+    EXPECT_EQ(expected, range("ab", std::string()));
+}
+
+/**
+ * @class SecondaryIndex
+ * @test Check if removed entries are no longer returned
+ */
+TEST_F(SecondaryIndexTest, removeIf) {
+    crossbow::allocator _;
+    for (uint64_t key = 0; key < 100u; ++key) {
+        EXPECT_TRUE(mIndex.insert(std::to_string(key % 10), key, 10u));
+    }
+
+    auto removed = mIndex.removeIf([] (const std::string& /* indexKey */, uint64_t key, uint64_t /* version */) {
+        return (key % 2 == 0);
+    });
+    EXPECT_EQ(50u, removed);
+    EXPECT_EQ(50u, mIndex.size());
+
+    auto entries = range(std::string(), std::string());
+    ASSERT_EQ(50u, entries.size());
+    for (auto& entry : entries) {
+        EXPECT_EQ(1u, std::get<1>(entry) % 2) << "Removed entry still in index";
+    }
+}
+
+/**
+ * @class SecondaryIndex
+ * @test Check if concurrent inserts and removes leave the index in a consistent state
+ */
+TEST_F(SecondaryIndexTest, concurrentInsertRemove) {
+    constexpr uint64_t numThreads = 4u;
+    constexpr uint64_t numKeys = 10000u;
+
+    std::atomic<bool> done(false);
+    std::thread remover([this, &done] () {
+        while (!done.load()) {
+            crossbow::allocator _;
+            mIndex.removeIf([] (const std::string& /* indexKey */, uint64_t /* key */, uint64_t version) {
+                return (version == 0u);
+            });
+        }
+    });
+
+    std::vector<std::thread> inserters;
+    for (uint64_t i = 0; i < numThreads; ++i) {
+        inserters.emplace_back([this, i] () {
+            for (uint64_t key = i; key < numKeys; key += numThreads) {
+                crossbow::allocator _;
+                EXPECT_TRUE(mIndex.insert(std::to_string(key % 100), key, 0u));
+                EXPECT_TRUE(mIndex.insert(std::to_string(key % 100), key, 1u));
+            }
+        });
+    }
+    for (auto& inserter : inserters) {
+        inserter.join();
+    }
+    done.store(true);
+    remover.join();
+
+    crossbow::allocator _;
+    mIndex.removeIf([] (const std::string& /* indexKey */, uint64_t /* key */, uint64_t version) {
+        return (version == 0u);
+    });
+    EXPECT_EQ(numKeys, mIndex.size());
+
+    auto entries = range(std::string(), std::string());
+    ASSERT_EQ(numKeys, entries.size());
+    for (size_t i = 1; i < entries.size(); ++i) {
+        EXPECT_LT(entries[i - 1], entries[i]) << "Entries not ordered";
+    }
+}
+
+/**
+ * @class SecondaryIndexes
+ * @test Check if only the keys modified up to the lowest active version are taken and newer ones stay pending
+ */
+TEST(SecondaryIndexesTest, takeModified) {
+    Schema schema(TableType::TRANSACTIONAL);
+    schema.addField(FieldType::INT, "foo", true);
+    schema.addIndex(crossbow::string("fooIndex"), std::make_pair(false, std::vector<Schema::id_t>({0u})));
+    Record record(schema);
+    SecondaryIndexes indexes(record);
+
+    indexes.modified(1u, 10u);
+    indexes.modified(2u, 12u);
+    indexes.modified(3u, 11u);
+    indexes.modified(1u, 13u);
+
+    bool all;
+    EXPECT_EQ(std::unordered_set<uint64_t>({1u, 3u}), indexes.takeModified(11u, all));
+    EXPECT_FALSE(all);
+
+    // Key 1 is pending again with its newer modification
+    EXPECT_EQ(std::unordered_set<uint64_t>({1u, 2u}), indexes.takeModified(13u, all));
+    EXPECT_TRUE(indexes.takeModified(13u, all).empty());
+}
+
+/**
+ * @class SecondaryIndexes
+ * @test Check if modifications recorded concurrently to takeModified calls are all taken exactly once
+ */
+TEST(SecondaryIndexesTest, modifiedConcurrent) {
+    Schema schema(TableType::TRANSACTIONAL);
+    schema.addField(FieldType::INT, "foo", true);
+    schema.addIndex(crossbow::string("fooIndex"), std::make_pair(false, std::vector<Schema::id_t>({0u})));
+    Record record(schema);
+    SecondaryIndexes indexes(record);
+
+    static constexpr uint64_t threadCount = 4u;
+    static constexpr uint64_t keyCount = 10000u;
+
+    std::atomic<uint64_t> running(threadCount);
+    std::vector<std::thread> threads;
+    for (uint64_t i = 0u; i < threadCount; ++i) {
+        threads.emplace_back([&indexes, &running, i] () {
+            for (uint64_t key = i * keyCount; key < (i + 1) * keyCount; ++key) {
+                indexes.modified(key, 10u + (key % 2u));
+            }
+            --running;
+        });
+    }
+
+    // Only modifications by version 10 are taken while the writers are running, the others must stay pending
+    bool all;
+    std::unordered_set<uint64_t> keys;
+    while (running.load() != 0u) {
+        for (auto key : indexes.takeModified(10u, all)) {
+            EXPECT_TRUE(keys.insert(key).second) << "Key " << key << " taken twice";
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto key : indexes.takeModified(10u, all)) {
+        EXPECT_TRUE(keys.insert(key).second) << "Key " << key << " taken twice";
+    }
+    EXPECT_EQ(threadCount * keyCount / 2u, keys.size());
+
+    auto pending = indexes.takeModified(11u, all);
+    EXPECT_EQ(threadCount * keyCount / 2u, pending.size());
+    for (auto key : pending) {
+        EXPECT_EQ(1u, key % 2u);
+    }
+    EXPECT_TRUE(indexes.takeModified(11u, all).empty());
+}
+
+/**
+ * @class SecondaryIndexes
+ * @test Check if modifications of a table without indexes are not recorded
+ */
+TEST(SecondaryIndexesTest, modifiedWithoutIndexes) {
+    Schema schema(TableType::TRANSACTIONAL);
+    schema.addField(FieldType::INT, "foo", true);
+    Record record(schema);
+    SecondaryIndexes indexes(record);
+
+    indexes.modified(1u, 10u);
+    bool all;
+    EXPECT_TRUE(indexes.takeModified(20u, all).empty());
+    EXPECT_FALSE(all);
+}
+
+} // anonymous namespace
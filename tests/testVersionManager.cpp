@@ -0,0 +1,90 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#include <util/VersionManager.hpp>
+
+#include <commitmanager/SnapshotDescriptor.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace tell;
+using namespace tell::store;
+
+namespace {
+
+class VersionManagerTest : public ::testing::Test {
+protected:
+    static std::unique_ptr<commitmanager::SnapshotDescriptor> createSnapshot(uint64_t lowestActiveVersion,
+            uint64_t baseVersion) {
+        commitmanager::SnapshotDescriptor::BlockType descriptor = 0x0u;
+        return commitmanager::SnapshotDescriptor::create(lowestActiveVersion, baseVersion, baseVersion + 1,
+                reinterpret_cast<const char*>(&descriptor));
+    }
+
+    VersionManager mVersionManager;
+};
+
+/**
+ * @class VersionManager
+ * @test Check if the lowest active version only moves forward
+ */
+TEST_F(VersionManagerTest, lowestActiveVersionRatchet) {
+    EXPECT_EQ(1u, mVersionManager.lowestActiveVersion());
+
+    auto snapshot = createSnapshot(20u, 30u);
+    mVersionManager.addSnapshot(*snapshot);
+    EXPECT_EQ(20u, mVersionManager.lowestActiveVersion());
+
+    auto olderSnapshot = createSnapshot(5u, 10u);
+    mVersionManager.addSnapshot(*olderSnapshot);
+    EXPECT_EQ(20u, mVersionManager.lowestActiveVersion());
+
+    auto newerSnapshot = createSnapshot(25u, 30u);
+    mVersionManager.addSnapshot(*newerSnapshot);
+    EXPECT_EQ(25u, mVersionManager.lowestActiveVersion());
+}
+
+/**
+ * @class VersionManager
+ * @test Check if concurrently added snapshots leave the highest lowest active version
+ */
+TEST_F(VersionManagerTest, concurrentAddSnapshot) {
+    std::vector<std::thread> threads;
+    for (uint64_t t = 0; t < 4u; ++t) {
+        threads.emplace_back([this, t] () {
+            for (uint64_t i = 0; i < 1000u; ++i) {
+                auto snapshot = createSnapshot(i * 4u + t + 1u, i * 4u + t + 1u);
+                mVersionManager.addSnapshot(*snapshot);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(4000u, mVersionManager.lowestActiveVersion());
+}
+
+}
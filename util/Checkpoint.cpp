@@ -0,0 +1,137 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include "Checkpoint.hpp"
+
+#include <crossbow/logger.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tell {
+namespace store {
+namespace {
+
+/**
+ * @brief Magic number identifying a checkpoint file
+ */
+constexpr uint64_t gCheckpointMagic = 0x54454c4c43484b50u;
+
+} // anonymous namespace
+
+CheckpointWriter::CheckpointWriter(const crossbow::string& path, uint64_t redoOffset)
+        : mPath(path),
+          mTmpPath(path + ".tmp"),
+          mFd(::open(mTmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP)) {
+    if (mFd < 0) {
+        throw std::system_error(errno, std::system_category());
+    }
+    write<uint64_t>(gCheckpointMagic);
+    write<uint64_t>(redoOffset);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    if (mFd < 0) {
+        return;
+    }
+    ::close(mFd);
+    ::unlink(mTmpPath.c_str());
+}
+
+void CheckpointWriter::write(const void* data, size_t length) {
+    auto ptr = reinterpret_cast<const char*>(data);
+    while (length != 0u) {
+        auto res = ::write(mFd, ptr, length);
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::system_category());
+        }
+        ptr += res;
+        length -= static_cast<size_t>(res);
+    }
+}
+
+void CheckpointWriter::commit() {
+    if (::fdatasync(mFd) != 0) {
+        throw std::system_error(errno, std::system_category());
+    }
+    ::close(mFd);
+    mFd = -1;
+
+    if (::rename(mTmpPath.c_str(), mPath.c_str()) != 0) {
+        auto error = errno;
+        ::unlink(mTmpPath.c_str());
+        throw std::system_error(error, std::system_category());
+    }
+}
+
+CheckpointReader::CheckpointReader(const crossbow::string& path)
+        : mFd(::open(path.c_str(), O_RDONLY)),
+          mRedoOffset(0u) {
+    if (mFd < 0) {
+        if (errno == ENOENT) {
+            return;
+        }
+        throw std::system_error(errno, std::system_category());
+    }
+
+    if (read<uint64_t>() != gCheckpointMagic) {
+        throw std::runtime_error("Invalid checkpoint file");
+    }
+    mRedoOffset = read<uint64_t>();
+}
+
+CheckpointReader::~CheckpointReader() {
+    if (mFd >= 0) {
+        ::close(mFd);
+    }
+}
+
+void CheckpointReader::read(void* data, size_t length) {
+    auto ptr = reinterpret_cast<char*>(data);
+    while (length != 0u) {
+        auto res = ::read(mFd, ptr, length);
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::system_category());
+        }
+        if (res == 0) {
+            throw std::runtime_error("Unexpected end of checkpoint file");
+        }
+        ptr += res;
+        length -= static_cast<size_t>(res);
+    }
+}
+
+} // namespace store
+} // namespace tell
@@ -0,0 +1,149 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#pragma once
+
+#include <config.h>
+
+#include <crossbow/non_copyable.hpp>
+#include <crossbow/string.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace tell {
+namespace store {
+
+/**
+ * @brief Writes a checkpoint image of the storage to disk
+ *
+ * The image consists of a header followed by arbitrary data and whole pages. Pages are written with one sequential
+ * write of TELL_PAGE_SIZE bytes each. The image is written to a temporary file next to the target path and only
+ * replaces the previous checkpoint when it is committed, a crash while writing the image thus never destroys the last
+ * complete checkpoint.
+ */
+class CheckpointWriter : crossbow::non_copyable, crossbow::non_movable {
+public:
+    /**
+     * @brief Starts a new checkpoint image
+     *
+     * @param path Path to the checkpoint file
+     * @param redoOffset Offset into the redo log file from which on the redo log has to be replayed on top of the image
+     */
+    CheckpointWriter(const crossbow::string& path, uint64_t redoOffset);
+
+    /**
+     * @brief Discards the image if it was not committed
+     */
+    ~CheckpointWriter();
+
+    void write(const void* data, size_t length);
+
+    template <typename T>
+    void write(T value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written");
+        write(&value, sizeof(T));
+    }
+
+    /**
+     * @brief Writes a complete page of TELL_PAGE_SIZE bytes
+     */
+    void writePage(const void* page) {
+        write(page, TELL_PAGE_SIZE);
+    }
+
+    /**
+     * @brief Forces the image to disk and atomically replaces the previous checkpoint with it
+     */
+    void commit();
+
+private:
+    crossbow::string mPath;
+    crossbow::string mTmpPath;
+    int mFd;
+};
+
+/**
+ * @brief Reads a checkpoint image written by the CheckpointWriter
+ */
+class CheckpointReader : crossbow::non_copyable, crossbow::non_movable {
+public:
+    /**
+     * @brief Opens the checkpoint file at the given path
+     *
+     * The reader is not open if no checkpoint exists.
+     */
+    CheckpointReader(const crossbow::string& path);
+
+    ~CheckpointReader();
+
+    bool isOpen() const {
+        return (mFd >= 0);
+    }
+
+    /**
+     * @brief Offset into the redo log file from which on the redo log has to be replayed on top of the image
+     */
+    uint64_t redoOffset() const {
+        return mRedoOffset;
+    }
+
+    void read(void* data, size_t length);
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read");
+        T value;
+        read(&value, sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief Reads a complete page of TELL_PAGE_SIZE bytes
+     */
+    void readPage(void* page) {
+        read(page, TELL_PAGE_SIZE);
+    }
+
+private:
+    int mFd;
+    uint64_t mRedoOffset;
+};
+
+/**
+ * @brief Trait checking whether the table implementation supports checkpoints
+ *
+ * A table supports checkpoints if it provides the two functions `void writeCheckpoint(CheckpointWriter&) const` and
+ * `bool readCheckpoint(CheckpointReader&)`.
+ */
+template <typename Table, typename = void>
+struct SupportsCheckpoint : std::false_type {};
+
+template <typename Table>
+struct SupportsCheckpoint<Table, decltype(std::declval<const Table&>().writeCheckpoint(
+        std::declval<CheckpointWriter&>()), std::declval<Table&>().readCheckpoint(std::declval<CheckpointReader&>()),
+        void())> : std::true_type {};
+
+} // namespace store
+} // namespace tell
@@ -66,6 +66,14 @@ const void* CuckooTable::get(uint64_t key) const {
     return nullptr;
 }
 
+void CuckooTable::prefetch(uint64_t key) const {
+    unsigned cnt = 0;
+    for (auto& hasher : {hash1, hash2, hash3}) {
+        __builtin_prefetch(&at(cnt, hasher(key)));
+        ++cnt;
+    }
+}
+
 auto CuckooTable::at(unsigned h, size_t idx) const -> const EntryT& {
     auto tIdx = idx / ENTRIES_PER_PAGE;
     auto pIdx = idx - tIdx * ENTRIES_PER_PAGE;
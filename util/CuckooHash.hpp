@@ -98,6 +98,11 @@ public:
         return const_cast<void*>(const_cast<const CuckooTable*>(this)->get(key));
     }
 
+    /**
+     * @brief Issues a prefetch for all candidate entries of the key without waiting for them
+     */
+    void prefetch(uint64_t key) const;
+
     Modifier modifier();
 
     size_t capacity() const;
@@ -0,0 +1,209 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#pragma once
+
+#include "LocalScanQuery.hpp"
+#include "StorageConfig.hpp"
+#include "TableManager.hpp"
+
+#include <tellstore/ErrorCode.hpp>
+#include <tellstore/Record.hpp>
+
+#include <commitmanager/SnapshotDescriptor.hpp>
+
+#include <crossbow/non_copyable.hpp>
+#include <crossbow/string.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tell {
+namespace store {
+
+/**
+ * @brief In-process access to a storage backend without going through the network
+ *
+ * Wraps one of the storage implementations (DeltaMainRewriteStore or LogstructuredMemoryStore) and exposes its
+ * operations directly to the caller. Requests are not marshalled and snapshot descriptors are passed by reference
+ * instead of being decoded from a message. Scans use the same ScanQuery machinery as the server but hand the result
+ * buffers to a caller provided callback instead of writing them to remote memory.
+ *
+ * The snapshots still have to be acquired from the commit manager by the caller.
+ */
+template <typename Storage>
+class EmbeddedStore : crossbow::non_copyable, crossbow::non_movable {
+public:
+    using Table = typename Storage::Table;
+
+    /**
+     * @param config Configuration of the storage
+     * @param scanBufferLength Size of the buffers handed to the scan callback
+     */
+    EmbeddedStore(const StorageConfig& config, uint32_t scanBufferLength = 0x100000u)
+            : mConfig(config),
+              mScanBufferLength(scanBufferLength),
+              mStorage(config) {
+    }
+
+    static const char* implementationName() {
+        return Storage::implementationName();
+    }
+
+    /**
+     * @brief The wrapped storage backend
+     */
+    Storage& storage() {
+        return mStorage;
+    }
+
+    bool createTable(const crossbow::string& name, const Schema& schema, uint64_t& tableId) {
+        return mStorage.createTable(name, schema, tableId);
+    }
+
+    std::vector<const Table*> getTables() const {
+        return mStorage.getTables();
+    }
+
+    const Table* getTable(uint64_t tableId) const {
+        return mStorage.getTable(tableId);
+    }
+
+    const Table* getTable(const crossbow::string& name, uint64_t& tableId) const {
+        return mStorage.getTable(name, tableId);
+    }
+
+    /**
+     * @brief Reads the tuple with the given key into the data string
+     *
+     * @param tableId ID of the table to read from
+     * @param key Key of the tuple
+     * @param snapshot Snapshot of the reading transaction
+     * @param data String to copy the tuple's data into
+     * @param version Version of the tuple
+     * @param isNewest Whether the tuple is the newest version of the key
+     * @return Error code of the lookup or 0 if successful
+     */
+    int get(uint64_t tableId, uint64_t key, const commitmanager::SnapshotDescriptor& snapshot, std::string& data,
+            uint64_t& version, bool& isNewest) {
+        return mStorage.get(tableId, key, snapshot, [&data, &version, &isNewest]
+                (size_t size, uint64_t tupleVersion, bool tupleIsNewest) {
+            version = tupleVersion;
+            isNewest = tupleIsNewest;
+            data.resize(size);
+            return &data[0];
+        });
+    }
+
+    int update(uint64_t tableId, uint64_t key, size_t size, const char* data,
+            const commitmanager::SnapshotDescriptor& snapshot) {
+        return mStorage.update(tableId, key, size, data, snapshot);
+    }
+
+    int insert(uint64_t tableId, uint64_t key, size_t size, const char* data,
+            const commitmanager::SnapshotDescriptor& snapshot) {
+        return mStorage.insert(tableId, key, size, data, snapshot);
+    }
+
+    int remove(uint64_t tableId, uint64_t key, const commitmanager::SnapshotDescriptor& snapshot) {
+        return mStorage.remove(tableId, key, snapshot);
+    }
+
+    int revert(uint64_t tableId, uint64_t key, const commitmanager::SnapshotDescriptor& snapshot) {
+        return mStorage.revert(tableId, key, snapshot);
+    }
+
+    void batchWrite(const WriteOperation* operations, size_t count, const commitmanager::SnapshotDescriptor& snapshot,
+            int* results) {
+        mStorage.batchWrite(operations, count, snapshot, results);
+    }
+
+    /**
+     * @brief Executes a scan over the table and blocks until it finished
+     *
+     * The selection and query data use the same format as the scan requests sent by the client (see ScanQuery). The
+     * scan might be shared with other concurrent scans on the same table.
+     *
+     * @param tableId ID of the table to scan
+     * @param snapshot Snapshot of the reading transaction
+     * @param callback Callback receiving the buffers filled by the scan threads (might be invoked concurrently)
+     * @return Error code of the scan or 0 if successful
+     */
+    int scan(uint64_t tableId, const commitmanager::SnapshotDescriptor& snapshot, ScanQueryType queryType,
+            std::unique_ptr<char[]> selection, size_t selectionLength, std::unique_ptr<char[]> query,
+            size_t queryLength, LocalScanQuery::Callback callback, uint64_t lowKey = 0x0u,
+            uint64_t highKey = ScanQuery::UNBOUNDED_KEY, uint64_t limit = 0x0u, ScanOrder order = ScanOrder::NONE,
+            Record::id_t orderField = 0x0u) {
+        if (mConfig.numScanThreads == 0u || selectionLength % 8u != 0u || selectionLength < 16u) {
+            return error::invalid_scan;
+        }
+
+        auto table = mStorage.getTable(tableId);
+        if (!table) {
+            return error::invalid_table;
+        }
+
+        // The scan keeps its own copy of the snapshot as it is checked from the scan threads
+        auto scanSnapshot = commitmanager::SnapshotDescriptor::create(snapshot.lowestActiveVersion(),
+                snapshot.baseVersion(), snapshot.version(), snapshot.data());
+
+        LocalScanQuery scanQuery(queryType, std::move(selection), selectionLength, std::move(query), queryLength,
+                lowKey, highKey, limit, order, orderField, std::move(scanSnapshot), table->record(),
+                mScanBufferLength, std::move(callback));
+        if (!scanQuery.validLimit()) {
+            return error::invalid_scan;
+        }
+
+        auto ec = mStorage.scan(tableId, &scanQuery);
+        if (ec) {
+            return ec;
+        }
+        scanQuery.wait();
+        return 0;
+    }
+
+    /**
+     * @brief Triggers the garbage collection
+     */
+    void forceGC() {
+        mStorage.forceGC();
+    }
+
+    /**
+     * @brief Runs a garbage collection pass and blocks until it finished
+     */
+    void runGC() {
+        mStorage.runGC();
+    }
+
+private:
+    StorageConfig mConfig;
+
+    uint32_t mScanBufferLength;
+
+    Storage mStorage;
+};
+
+} // namespace store
+} // namespace tell
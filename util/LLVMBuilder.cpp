@@ -76,6 +76,115 @@ llvm::Value* LLVMBuilder::createPointerAlign(llvm::Value* value, uintptr_t align
     return result;
 }
 
+llvm::Value* LLVMBuilder::createRangeCheck(llvm::Value* value, llvm::Constant* lower, llvm::Constant* upper,
+        bool isFloat, uint64_t vectorSize /* = 1 */) {
+    if (isFloat) {
+        auto lowerRes = CreateFCmp(llvm::CmpInst::FCMP_OGE, value, getVector(vectorSize, lower));
+        auto upperRes = CreateFCmp(llvm::CmpInst::FCMP_OLE, value, getVector(vectorSize, upper));
+        return CreateAnd(lowerRes, upperRes);
+    }
+
+    // An empty range never matches
+    if (llvm::ConstantExpr::getICmp(llvm::CmpInst::ICMP_SGT, lower, upper)->isOneValue()) {
+        return getVector(vectorSize, getFalse());
+    }
+
+    // -> static_cast<unsigned>(value - lower) <= static_cast<unsigned>(upper - lower)
+    auto distance = CreateSub(value, getVector(vectorSize, lower));
+    return CreateICmp(llvm::CmpInst::ICMP_ULE, distance,
+            getVector(vectorSize, llvm::ConstantExpr::getSub(upper, lower)));
+}
+
+llvm::Value* LLVMBuilder::createListCheck(llvm::Value* value, llvm::Constant* values, uint32_t valueCount,
+        bool isFloat, uint64_t vectorSize /* = 1 */) {
+    LOG_ASSERT(valueCount > 0u, "List must contain values");
+
+    llvm::Value* res = nullptr;
+    for (decltype(valueCount) i = 0; i < valueCount; ++i) {
+        auto rhs = getVector(vectorSize, values->getAggregateElement(i));
+        auto cmp = (isFloat
+                ? CreateFCmp(llvm::CmpInst::FCMP_OEQ, value, rhs)
+                : CreateICmp(llvm::CmpInst::ICMP_EQ, value, rhs));
+        res = (res ? CreateOr(res, cmp) : cmp);
+    }
+    return res;
+}
+
+llvm::Value* LLVMBuilder::createMapCheck(llvm::Value* value, llvm::Constant* base, llvm::GlobalVariable* map,
+        uint32_t mapSize, uint64_t vectorSize /* = 1 */) {
+    // -> auto offset = value - base;
+    auto offset = CreateSub(value, getVector(vectorSize, base));
+
+    // -> auto inRange = static_cast<unsigned>(offset) < mapSize;
+    auto inRange = CreateICmp(llvm::CmpInst::ICMP_ULT, offset,
+            getVector(vectorSize, llvm::ConstantInt::get(base->getType(), mapSize)));
+
+    // Clamp the offset to the map so the lookup never reads out of bounds
+    offset = CreateSelect(inRange, offset, llvm::Constant::getNullValue(offset->getType()));
+    offset = CreateZExtOrBitCast(offset, getInt64VectorTy(vectorSize));
+
+    auto mapData = CreateInBoundsGEP(map->getValueType(), map, { getInt64(0), getInt64(0) });
+
+    // Look up the entry of every element (there is no vector gather in the IR)
+    llvm::Value* entries;
+    if (vectorSize == 1) {
+        entries = CreateAlignedLoad(CreateInBoundsGEP(mapData, offset), 1u);
+    } else {
+        entries = llvm::UndefValue::get(getInt8VectorTy(vectorSize));
+        for (decltype(vectorSize) i = 0; i < vectorSize; ++i) {
+            auto entryOffset = CreateExtractElement(offset, getInt32(i));
+            auto entry = CreateAlignedLoad(CreateInBoundsGEP(mapData, entryOffset), 1u);
+            entries = CreateInsertElement(entries, entry, getInt32(i));
+        }
+    }
+
+    return CreateAnd(inRange, CreateICmp(llvm::CmpInst::ICMP_NE, entries, getInt8Vector(vectorSize, 0)));
+}
+
+llvm::Value* LLVMBuilder::createSearchCheck(llvm::Value* value, llvm::GlobalVariable* sorted, uint32_t size,
+        bool isFloat, uint64_t vectorSize /* = 1 */) {
+    LOG_ASSERT(size > 0u && (size & (size - 1u)) == 0u, "Size must be a power of two");
+
+    auto elementType = sorted->getValueType()->getArrayElementType();
+    auto alignment = elementType->getPrimitiveSizeInBits() / 8u;
+    auto sortedData = CreateInBoundsGEP(sorted->getValueType(), sorted, { getInt64(0), getInt64(0) });
+
+    // Load the array entry at the given (vector) index (there is no vector gather in the IR)
+    auto loadEntries = [this, sortedData, alignment, elementType, vectorSize] (llvm::Value* idx) -> llvm::Value* {
+        if (vectorSize == 1) {
+            return CreateAlignedLoad(CreateInBoundsGEP(sortedData, idx), alignment);
+        }
+        llvm::Value* entries = llvm::UndefValue::get(getVectorTy(elementType, vectorSize));
+        for (decltype(vectorSize) i = 0; i < vectorSize; ++i) {
+            auto entryIdx = CreateExtractElement(idx, getInt32(i));
+            auto entry = CreateAlignedLoad(CreateInBoundsGEP(sortedData, entryIdx), alignment);
+            entries = CreateInsertElement(entries, entry, getInt32(i));
+        }
+        return entries;
+    };
+
+    // Find the last entry not greater than the value (or the first entry if all entries are greater)
+    // -> auto idx = 0;
+    // -> for (auto step = size / 2; step > 0; step /= 2) {
+    // ->     if (sorted[idx + step] <= value) idx += step;
+    // -> }
+    llvm::Value* idx = getInt64Vector(vectorSize, 0);
+    for (auto step = size / 2u; step > 0u; step /= 2u) {
+        auto nextIdx = CreateAdd(idx, getInt64Vector(vectorSize, step));
+        auto entries = loadEntries(nextIdx);
+        auto isLower = (isFloat
+                ? CreateFCmp(llvm::CmpInst::FCMP_OLE, entries, value)
+                : CreateICmp(llvm::CmpInst::ICMP_SLE, entries, value));
+        idx = CreateSelect(isLower, nextIdx, idx);
+    }
+
+    // -> return sorted[idx] == value;
+    auto entries = loadEntries(idx);
+    return (isFloat
+            ? CreateFCmp(llvm::CmpInst::FCMP_OEQ, entries, value)
+            : CreateICmp(llvm::CmpInst::ICMP_EQ, entries, value));
+}
+
 llvm::Type* LLVMBuilder::getFieldTy(FieldType field) {
     switch (field) {
     case FieldType::SMALLINT:
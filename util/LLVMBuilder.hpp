@@ -164,6 +164,46 @@ public:
      * @brief Create an pointer alignment operation with a constant
      */
     llvm::Value* createPointerAlign(llvm::Value* value, uintptr_t alignment);
+
+    /**
+     * @brief Create a check whether the (vector) value lies in the inclusive range [lower, upper]
+     *
+     * Integer values are checked with a single unsigned comparison of their distance to the lower bound.
+     */
+    llvm::Value* createRangeCheck(llvm::Value* value, llvm::Constant* lower, llvm::Constant* upper, bool isFloat,
+            uint64_t vectorSize = 1);
+
+    /**
+     * @brief Create a check whether the (vector) value is equal to any element in the constant array of values
+     */
+    llvm::Value* createListCheck(llvm::Value* value, llvm::Constant* values, uint32_t valueCount, bool isFloat,
+            uint64_t vectorSize = 1);
+
+    /**
+     * @brief Create a lookup of the (vector) integer value in a byte map
+     *
+     * @param value The value to look up
+     * @param base Value corresponding to the first entry in the map
+     * @param map Global byte array with a non-zero entry for every value contained in the set
+     * @param mapSize Number of entries in the map
+     * @param vectorSize Number of elements in the value vector
+     */
+    llvm::Value* createMapCheck(llvm::Value* value, llvm::Constant* base, llvm::GlobalVariable* map, uint32_t mapSize,
+            uint64_t vectorSize = 1);
+
+    /**
+     * @brief Create a branch free binary search for the (vector) value in a sorted array
+     *
+     * Every element needs log2(size) lookups into the array, the lanes of a vector value are loaded one by one.
+     *
+     * @param value The value to search for
+     * @param sorted Global array of the values in ascending order
+     * @param size Number of entries in the array (must be a power of two)
+     * @param isFloat Whether the values are floats or signed integers
+     * @param vectorSize Number of elements in the value vector
+     */
+    llvm::Value* createSearchCheck(llvm::Value* value, llvm::GlobalVariable* sorted, uint32_t size, bool isFloat,
+            uint64_t vectorSize = 1);
 };
 
 /**
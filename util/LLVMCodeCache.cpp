@@ -0,0 +1,84 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include "LLVMCodeCache.hpp"
+
+#include <iterator>
+
+namespace tell {
+namespace store {
+
+size_t LLVMCodeCache::size() const {
+    std::unique_lock<decltype(mMutex)> _(mMutex);
+    return mEntries.size();
+}
+
+LLVMCodeCache::EntryPtr LLVMCodeCache::lookup(const std::string& key) {
+    if (mCapacity == 0u) {
+        ++mMisses;
+        return nullptr;
+    }
+
+    std::unique_lock<decltype(mMutex)> _(mMutex);
+    auto i = mEntries.find(key);
+    if (i == mEntries.end()) {
+        ++mMisses;
+        return nullptr;
+    }
+
+    // Move the entry to the front of the LRU list
+    mLruList.splice(mLruList.begin(), mLruList, i->second);
+    ++mHits;
+    return i->second->second;
+}
+
+void LLVMCodeCache::insert(std::string key, EntryPtr entry) {
+    if (mCapacity == 0u) {
+        return;
+    }
+
+    // Entries are released outside of the lock as destroying the compiled module is expensive
+    LruList evicted;
+    {
+        std::unique_lock<decltype(mMutex)> _(mMutex);
+        auto i = mEntries.find(key);
+        if (i != mEntries.end()) {
+            i->second->second = std::move(entry);
+            mLruList.splice(mLruList.begin(), mLruList, i->second);
+            return;
+        }
+
+        mLruList.emplace_front(key, std::move(entry));
+        mEntries.emplace(std::move(key), mLruList.begin());
+
+        while (mEntries.size() > mCapacity) {
+            auto last = std::prev(mLruList.end());
+            mEntries.erase(last->first);
+            evicted.splice(evicted.end(), mLruList, last);
+            ++mEvictions;
+        }
+    }
+}
+
+} // namespace store
+} // namespace tell
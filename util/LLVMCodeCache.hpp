@@ -0,0 +1,136 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#pragma once
+
+#include <crossbow/non_copyable.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tell {
+namespace store {
+
+class LLVMCodeModule;
+
+/**
+ * @brief Compiled functions stored in the code cache
+ */
+struct LLVMCodeCacheEntry {
+    LLVMCodeCacheEntry()
+            : numConjunct(0u) {
+    }
+
+    /// The module containing the compiled code (might be shared with other entries compiled in the same batch)
+    std::shared_ptr<LLVMCodeModule> module;
+
+    /// Pointers to the compiled functions
+    std::vector<void*> functions;
+
+    /// Number of conjuncts the scan function evaluates (only used by scan functions)
+    uint32_t numConjunct;
+};
+
+/**
+ * @brief Bounded cache mapping a normalized query description to its compiled scan or materialization functions
+ *
+ * Entries are evicted in least recently used order as soon as the cache exceeds its capacity. A scan holds a reference
+ * to the entries it uses so that the compiled code stays valid even when the entry is evicted while the scan is still
+ * running. A capacity of 0 disables the cache.
+ *
+ * The cache is accessed concurrently by the scan threads preparing the query and the materialization functions.
+ */
+class LLVMCodeCache : crossbow::non_copyable, crossbow::non_movable {
+public:
+    using EntryPtr = std::shared_ptr<const LLVMCodeCacheEntry>;
+
+    LLVMCodeCache(size_t capacity)
+            : mCapacity(capacity),
+              mHits(0u),
+              mMisses(0u),
+              mEvictions(0u) {
+    }
+
+    size_t capacity() const {
+        return mCapacity;
+    }
+
+    /**
+     * @brief Number of entries currently in the cache
+     */
+    size_t size() const;
+
+    uint64_t hits() const {
+        return mHits.load();
+    }
+
+    uint64_t misses() const {
+        return mMisses.load();
+    }
+
+    uint64_t evictions() const {
+        return mEvictions.load();
+    }
+
+    /**
+     * @brief Looks up the entry associated with the given key and marks it as most recently used
+     *
+     * @return The entry or null if the key is not in the cache
+     */
+    EntryPtr lookup(const std::string& key);
+
+    /**
+     * @brief Inserts the entry into the cache evicting the least recently used entries if the cache is full
+     *
+     * Replaces an already existing entry with the same key.
+     */
+    void insert(std::string key, EntryPtr entry);
+
+private:
+    using LruList = std::list<std::pair<std::string, EntryPtr>>;
+
+    size_t mCapacity;
+
+    mutable std::mutex mMutex;
+
+    /// List of all entries with the most recently used entry at the front
+    LruList mLruList;
+
+    /// Map from the key to the position of the entry in the LRU list
+    std::unordered_map<std::string, LruList::iterator> mEntries;
+
+    std::atomic<uint64_t> mHits;
+    std::atomic<uint64_t> mMisses;
+    std::atomic<uint64_t> mEvictions;
+};
+
+} // namespace store
+} // namespace tell
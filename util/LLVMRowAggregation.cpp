@@ -41,7 +41,7 @@ LLVMRowAggregationBuilder::LLVMRowAggregationBuilder(const Record& record, llvm:
 }
 
 void LLVMRowAggregationBuilder::build(ScanQuery* query) {
-    auto& destRecord = query->record();
+    auto& destRecord = query->aggregationRecord();
 
     auto i = query->aggregationBegin();
     for (decltype(destRecord.fieldCount()) j = 0u; j < destRecord.fieldCount(); ++i, ++j) {
@@ -41,6 +41,8 @@ LLVMRowScanBuilder::LLVMRowScanBuilder(llvm::Module& module, llvm::TargetMachine
     mFunction->setDoesNotAlias(4);
     mFunction->setOnlyReadsMemory(4);
     mFunction->setDoesNotAlias(5);
+    mFunction->setDoesNotAlias(6);
+    mFunction->setOnlyReadsMemory(6);
 }
 
 void LLVMRowScanBuilder::buildScan(const ScanAST& scanAst) {
@@ -99,9 +101,27 @@ void LLVMRowScanBuilder::buildScan(const ScanAST& scanAst) {
                 auto& rhsAst = predicateAst.fixed;
 
                 // Execute the comparison
-                res = (rhsAst.isFloat
-                        ? CreateFCmp(rhsAst.predicate, lhs, rhsAst.value)
-                        : CreateICmp(rhsAst.predicate, lhs, rhsAst.value));
+                switch (predicateAst.type) {
+                case PredicateType::BETWEEN: {
+                    res = createRangeCheck(lhs, rhsAst.value, rhsAst.upperValue, rhsAst.isFloat);
+                } break;
+
+                case PredicateType::IN_LIST: {
+                    if (rhsAst.valueMap) {
+                        res = createMapCheck(lhs, rhsAst.value, rhsAst.valueMap, rhsAst.mapSize);
+                    } else if (rhsAst.sortedValues) {
+                        res = createSearchCheck(lhs, rhsAst.sortedValues, rhsAst.sortedSize, rhsAst.isFloat);
+                    } else {
+                        res = createListCheck(lhs, rhsAst.values, rhsAst.valueCount, rhsAst.isFloat);
+                    }
+                } break;
+
+                default: {
+                    res = (rhsAst.isFloat
+                            ? CreateFCmp(rhsAst.predicate, lhs, rhsAst.value)
+                            : CreateICmp(rhsAst.predicate, lhs, rhsAst.value));
+                } break;
+                }
                 res = CreateZExtOrBitCast(res, getInt8Ty());
 
                 // The predicate evaluates to false if the value is null
@@ -229,9 +249,13 @@ void LLVMRowScanBuilder::buildScan(const ScanAST& scanAst) {
     for (decltype(scanAst.queries.size()) i = 0; i < scanAst.queries.size(); ++i) {
         auto& query = scanAst.queries[i];
 
+        // Load the snapshot versions of the query
+        auto baseVersion = CreateAlignedLoad(CreateInBoundsGEP(getParam(versionData), getInt64(2 * i)), 8u);
+        auto version = CreateAlignedLoad(CreateInBoundsGEP(getParam(versionData), getInt64(2 * i + 1)), 8u);
+
         // Evaluate validFrom <= version && validTo > baseVersion
-        auto validFromRes = CreateICmp(llvm::CmpInst::ICMP_ULE, getParam(validFrom), getInt64(query.version));
-        auto validToRes = CreateICmp(llvm::CmpInst::ICMP_UGT, getParam(validTo), getInt64(query.baseVersion));
+        auto validFromRes = CreateICmp(llvm::CmpInst::ICMP_ULE, getParam(validFrom), version);
+        auto validToRes = CreateICmp(llvm::CmpInst::ICMP_UGT, getParam(validTo), baseVersion);
         auto res = CreateAnd(validFromRes, validToRes);
 
         // Evaluate (key >> partitionShift) % partitionModulo == partitionNumber
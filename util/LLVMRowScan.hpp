@@ -54,6 +54,7 @@ private:
     static constexpr size_t validTo = 2;
     static constexpr size_t recordData = 3;
     static constexpr size_t resultData = 4;
+    static constexpr size_t versionData = 5;
 
     static llvm::Type* buildReturnTy(llvm::LLVMContext& context) {
         return llvm::Type::getVoidTy(context);
@@ -65,7 +66,8 @@ private:
             { llvm::Type::getInt64Ty(context), "validFrom" },
             { llvm::Type::getInt64Ty(context), "validTo" },
             { llvm::Type::getInt8Ty(context)->getPointerTo(), "recordData" },
-            { llvm::Type::getInt8Ty(context)->getPointerTo(), "resultData" }
+            { llvm::Type::getInt8Ty(context)->getPointerTo(), "resultData" },
+            { llvm::Type::getInt64Ty(context)->getPointerTo(), "versionData" }
         };
     }
 
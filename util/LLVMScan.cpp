@@ -48,22 +48,186 @@
 #include <llvm/Transforms/Scalar.h>
 #include <llvm/Transforms/Vectorize.h>
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <limits>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace tell {
 namespace store {
 
 namespace {
 
-const std::string ROW_MATERIALIZE_NAME = "rowMaterialize.";
+const std::string MATERIALIZE_NAME = "materialize.";
+
+/**
+ * @brief IN-lists with more values are looked up in a byte map if the values are dense or searched in a sorted array
+ */
+constexpr uint32_t gMaxUnrolledListSize = 8u;
+
+/**
+ * @brief Maximum range of values covered by the byte map of an IN-list
+ */
+constexpr uint64_t gMaxValueMapSize = 4096u;
 
 uint32_t memcpyWrapper(const char* src, uint32_t length, char* dest) {
     memcpy(dest, src, length);
     return length;
 }
 
+template <typename T>
+void appendKey(std::string& key, const T& value) {
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+std::string materializeName(size_t queryIdx, size_t builderIdx) {
+    std::stringstream ss;
+    ss << MATERIALIZE_NAME << queryIdx << "." << builderIdx;
+    return ss.str();
+}
+
+/**
+ * @brief Reads a value of a fixed size field stored in an 8 byte slot of an IN_LIST or BETWEEN predicate
+ */
+llvm::Constant* readFixedValue(LLVMBuilder& builder, FieldType type, crossbow::buffer_reader& reader) {
+    switch (type) {
+    case FieldType::SMALLINT: {
+        auto value = builder.getInt16(reader.read<int16_t>());
+        reader.advance(6);
+        return value;
+    } break;
+
+    case FieldType::INT: {
+        auto value = builder.getInt32(reader.read<int32_t>());
+        reader.advance(4);
+        return value;
+    } break;
+
+    case FieldType::BIGINT: {
+        return builder.getInt64(reader.read<int64_t>());
+    } break;
+
+    case FieldType::FLOAT: {
+        auto value = builder.getFloat(reader.read<float>());
+        reader.advance(4);
+        return value;
+    } break;
+
+    case FieldType::DOUBLE: {
+        return builder.getDouble(reader.read<double>());
+    } break;
+
+    default: {
+        LOG_ASSERT(false, "Invalid field");
+        reader.advance(8);
+        return nullptr;
+    } break;
+    }
+}
+
+/**
+ * @brief Initializes the predicate with the value of a variable size field
+ */
+void setVariableValue(llvm::Module& module, LLVMBuilder& builder, const char* data, uint32_t size,
+        VariablePredicateAST& predicateAst) {
+    using namespace llvm;
+
+    predicateAst.size = size;
+    predicateAst.prefix = 0;
+    if (size > 0) {
+        memcpy(&predicateAst.prefix, data, size < sizeof(uint32_t) ? size : sizeof(uint32_t));
+
+        auto value = ConstantDataArray::get(builder.getContext(),
+                makeArrayRef(reinterpret_cast<const uint8_t*>(data), size));
+        predicateAst.value = new GlobalVariable(module, value->getType(), true, GlobalValue::PrivateLinkage, value);
+    }
+}
+
+/**
+ * @brief Builds the byte map of an IN-list on integer values if the values are dense enough
+ */
+void buildValueMap(llvm::Module& module, LLVMBuilder& builder, const std::vector<llvm::Constant*>& values,
+        FixedPredicateAST& predicateAst) {
+    using namespace llvm;
+
+    auto min = std::numeric_limits<int64_t>::max();
+    auto max = std::numeric_limits<int64_t>::min();
+    for (auto value : values) {
+        auto integer = cast<ConstantInt>(value)->getSExtValue();
+        min = std::min(min, integer);
+        max = std::max(max, integer);
+    }
+
+    auto range = static_cast<uint64_t>(max) - static_cast<uint64_t>(min);
+    if (range >= gMaxValueMapSize) {
+        return;
+    }
+
+    std::vector<uint8_t> map(range + 1, 0u);
+    for (auto value : values) {
+        map[static_cast<uint64_t>(cast<ConstantInt>(value)->getSExtValue()) - static_cast<uint64_t>(min)] = 1u;
+    }
+
+    auto mapValue = ConstantDataArray::get(builder.getContext(), makeArrayRef(map));
+    predicateAst.value = ConstantInt::get(values.front()->getType(), min, true);
+    predicateAst.valueMap = new GlobalVariable(module, mapValue->getType(), true, GlobalValue::PrivateLinkage,
+            mapValue);
+    predicateAst.mapSize = static_cast<uint32_t>(map.size());
+}
+
+/**
+ * @brief Builds the sorted array of an IN-list that is searched with a binary search
+ *
+ * Duplicates are removed and the array is padded to the next power of two with the largest value. NaN never compares
+ * equal to any value and is dropped from the list.
+ */
+void buildSortedValues(llvm::Module& module, const std::vector<llvm::Constant*>& values,
+        FixedPredicateAST& predicateAst) {
+    using namespace llvm;
+
+    auto toDouble = [] (Constant* value) {
+        auto& apValue = cast<ConstantFP>(value)->getValueAPF();
+        return (value->getType()->isFloatTy()
+                ? static_cast<double>(apValue.convertToFloat())
+                : apValue.convertToDouble());
+    };
+    auto isLess = [&predicateAst, &toDouble] (Constant* lhs, Constant* rhs) {
+        return (predicateAst.isFloat
+                ? toDouble(lhs) < toDouble(rhs)
+                : cast<ConstantInt>(lhs)->getSExtValue() < cast<ConstantInt>(rhs)->getSExtValue());
+    };
+
+    std::vector<Constant*> sorted;
+    sorted.reserve(values.size());
+    for (auto value : values) {
+        if (predicateAst.isFloat && std::isnan(toDouble(value))) {
+            continue;
+        }
+        sorted.emplace_back(value);
+    }
+    if (sorted.empty()) {
+        return;
+    }
+    std::sort(sorted.begin(), sorted.end(), isLess);
+    sorted.erase(std::unique(sorted.begin(), sorted.end(), [&isLess] (Constant* lhs, Constant* rhs) {
+        return !isLess(lhs, rhs) && !isLess(rhs, lhs);
+    }), sorted.end());
+
+    auto size = 1u;
+    while (size < sorted.size()) {
+        size <<= 1;
+    }
+    sorted.resize(size, sorted.back());
+
+    auto sortedValue = ConstantArray::get(ArrayType::get(sorted.front()->getType(), size), sorted);
+    predicateAst.sortedValues = new GlobalVariable(module, sortedValue->getType(), true, GlobalValue::PrivateLinkage,
+            sortedValue);
+    predicateAst.sortedSize = size;
+}
+
 } // anonymous namespace
 
 LLVMCodeModule::LLVMCodeModule(const std::string& name)
@@ -92,14 +256,133 @@ void LLVMCodeModule::compile() {
     mHandle = mCompiler.addModule(&mModule);
 }
 
-LLVMScanBase::LLVMScanBase(const Record& record, std::vector<ScanQuery*> queries)
+LLVMScanBase::LLVMScanBase(uint64_t tableId, const Record& record, std::vector<ScanQuery*> queries,
+        LLVMCodeCache& codeCache)
         : mRecord(record),
           mQueries(std::move(queries)),
-          mQueryModule("ScanQuery"),
-          mMaterializationModule("Materialization") {
+          mCodeCache(codeCache),
+          mNumConjunct(0u) {
+    // Normalize the order of the queries so batches containing the same selections share the compiled scan code
+    std::stable_sort(mQueries.begin(), mQueries.end(), [] (const ScanQuery* lhs, const ScanQuery* rhs) {
+        if (lhs->selectionLength() != rhs->selectionLength()) {
+            return lhs->selectionLength() < rhs->selectionLength();
+        }
+        return memcmp(lhs->selection(), rhs->selection(), lhs->selectionLength()) < 0;
+    });
+
+    appendKey(mKeyPrefix, tableId);
+
+    mQueryKey = mKeyPrefix;
+    mQueryKey.push_back('S');
+    for (auto q : mQueries) {
+        appendKey(mQueryKey, static_cast<uint32_t>(q->selectionLength()));
+        mQueryKey.append(q->selection(), q->selectionLength());
+    }
+}
+
+bool LLVMScanBase::lookupQueryCode() {
+    LOG_ASSERT(!mQueryCode, "Scan code already loaded");
+    mQueryCode = mCodeCache.lookup(mQueryKey);
+    if (!mQueryCode) {
+        return false;
+    }
+    mNumConjunct = mQueryCode->numConjunct;
+    return true;
+}
+
+LLVMCodeModule& LLVMScanBase::createQueryModule() {
+    LOG_ASSERT(!mQueryModule, "Scan module already created");
+    mQueryModule = std::make_shared<LLVMCodeModule>("ScanQuery");
+    buildScanAST(mQueryModule->getModule());
+    mNumConjunct = mScanAst.numConjunct;
+    return *mQueryModule;
+}
+
+void LLVMScanBase::compileQueryCode(const std::vector<std::string>& names) {
+    LOG_ASSERT(mQueryModule, "Scan module not created");
+    mQueryModule->compile();
+
+    auto entry = std::make_shared<LLVMCodeCacheEntry>();
+    entry->module = std::move(mQueryModule);
+    entry->numConjunct = mNumConjunct;
+    entry->functions.reserve(names.size());
+    for (auto& name : names) {
+        entry->functions.emplace_back(entry->module->findFunction<void*>(name));
+    }
+    mQueryCode = entry;
+    mCodeCache.insert(mQueryKey, std::move(entry));
+}
+
+void LLVMScanBase::compileMaterializationCode(const std::vector<MaterializeBuilder>& builders) {
+    LOG_ASSERT(mMaterializationCode.empty(), "Materialization code already loaded");
+    mMaterializationCode.resize(mQueries.size());
+
+    std::shared_ptr<LLVMCodeModule> module;
+
+    // Map from the query data to the first query with the same data
+    std::unordered_map<QueryDataHolder, size_t> materializeCache;
+
+    // Index and cache key of all queries compiled in the new module
+    std::vector<std::pair<size_t, std::string>> compiled;
+
+    for (decltype(mQueries.size()) i = 0; i < mQueries.size(); ++i) {
+        auto q = mQueries[i];
+        if (q->queryType() == ScanQueryType::FULL) {
+            continue;
+        }
+
+        QueryDataHolder holder(q->query(), q->queryLength(), crossbow::to_underlying(q->queryType()));
+        if (materializeCache.find(holder) != materializeCache.end()) {
+            continue;
+        }
+        materializeCache.emplace(holder, i);
+
+        auto key = materializationKey(q);
+        if (auto entry = mCodeCache.lookup(key)) {
+            mMaterializationCode[i] = std::move(entry);
+            continue;
+        }
+
+        if (!module) {
+            module = std::make_shared<LLVMCodeModule>("Materialization");
+        }
+        for (decltype(builders.size()) j = 0; j < builders.size(); ++j) {
+            builders[j](module->getModule(), module->getTargetMachine(), materializeName(i, j), q);
+        }
+        compiled.emplace_back(i, std::move(key));
+    }
+
+    if (module) {
+        module->compile();
+
+        for (auto& c : compiled) {
+            auto entry = std::make_shared<LLVMCodeCacheEntry>();
+            entry->module = module;
+            entry->functions.reserve(builders.size());
+            for (decltype(builders.size()) j = 0; j < builders.size(); ++j) {
+                entry->functions.emplace_back(module->findFunction<void*>(materializeName(c.first, j)));
+            }
+            mMaterializationCode[c.first] = entry;
+            mCodeCache.insert(std::move(c.second), std::move(entry));
+        }
+    }
+
+    // Share the functions between queries with the same query data
+    for (decltype(mQueries.size()) i = 0; i < mQueries.size(); ++i) {
+        auto q = mQueries[i];
+        if (q->queryType() == ScanQueryType::FULL || mMaterializationCode[i]) {
+            continue;
+        }
+
+        QueryDataHolder holder(q->query(), q->queryLength(), crossbow::to_underlying(q->queryType()));
+        mMaterializationCode[i] = mMaterializationCode[materializeCache.at(holder)];
+    }
+}
+
+void LLVMScanBase::buildScanAST(llvm::Module& module) {
     using namespace llvm;
 
-    LLVMBuilder builder(mQueryModule.getModule().getContext());
+    LLVMBuilder builder(module.getContext());
 
     mScanAst.numConjunct = mQueries.size();
     mScanAst.conjunctProperties.resize(mQueries.size(), {0});
@@ -109,13 +392,10 @@ LLVMScanBase::LLVMScanBase(const Record& record, std::vector<ScanQuery*> queries
         auto q = mQueries[i];
 
         crossbow::buffer_reader queryReader(q->selection(), q->selectionLength());
-        auto snapshot = q->snapshot();
 
         auto numColumns = queryReader.read<uint32_t>();
 
         QueryAST queryAst;
-        queryAst.baseVersion = snapshot->baseVersion();
-        queryAst.version = snapshot->version();
         queryAst.shared = false;
         queryAst.conjunctOffset = mScanAst.numConjunct;
         queryAst.numConjunct = queryReader.read<uint16_t>();
@@ -182,6 +462,60 @@ LLVMScanBase::LLVMScanBase(const Record& record, std::vector<ScanQuery*> queries
 
                 if (predicateType == PredicateType::IS_NULL || predicateType == PredicateType::IS_NOT_NULL) {
                     queryReader.advance(6);
+                } else if (predicateType == PredicateType::IN_LIST || predicateType == PredicateType::BETWEEN) {
+                    fieldAst.needsValue = true;
+
+                    queryReader.advance(2);
+                    auto numValues = queryReader.read<uint32_t>();
+                    LOG_ASSERT(numValues > 0u, "Predicate without values");
+                    LOG_ASSERT(predicateType != PredicateType::BETWEEN || numValues == 2u,
+                            "Between predicate requires a lower and upper bound");
+
+                    if (!fieldAst.isFixedSize) {
+                        LOG_ASSERT(predicateType == PredicateType::IN_LIST, "Invalid predicate on variable size field");
+
+                        // The values of an IN-list on a variable size field are compared one by one as equality
+                        // predicates on the same conjunct
+                        mScanAst.conjunctProperties[conjunct].predicateCount += numValues - 1u;
+                        for (decltype(numValues) k = 0; k < numValues; ++k) {
+                            PredicateAST equalAst(PredicateType::EQUAL, conjunct);
+                            auto size = queryReader.read<uint32_t>();
+                            setVariableValue(module, builder, queryReader.read(size), size, equalAst.variable);
+                            queryReader.align(8u);
+                            fieldAst.predicates.emplace_back(std::move(equalAst));
+                        }
+                        continue;
+                    }
+
+                    std::vector<llvm::Constant*> values;
+                    values.reserve(numValues);
+                    for (decltype(numValues) k = 0; k < numValues; ++k) {
+                        values.emplace_back(readFixedValue(builder, fieldAst.type, queryReader));
+                    }
+
+                    auto& fixedAst = predicateAst.fixed;
+                    fixedAst.value = values.front();
+                    fixedAst.upperValue = values.back();
+                    fixedAst.values = ConstantArray::get(ArrayType::get(values.front()->getType(), numValues),
+                            values);
+                    fixedAst.valueCount = numValues;
+                    fixedAst.valueMap = nullptr;
+                    fixedAst.mapSize = 0u;
+                    fixedAst.sortedValues = nullptr;
+                    fixedAst.sortedSize = 0u;
+                    fixedAst.predicate = CmpInst::BAD_ICMP_PREDICATE;
+                    fixedAst.isFloat = (fieldAst.type == FieldType::FLOAT || fieldAst.type == FieldType::DOUBLE);
+
+                    // Large IN-lists are looked up in a byte map if the values are dense integers and searched in a
+                    // sorted array otherwise instead of comparing every value
+                    if (predicateType == PredicateType::IN_LIST && numValues > gMaxUnrolledListSize) {
+                        if (!fixedAst.isFloat) {
+                            buildValueMap(module, builder, values, fixedAst);
+                        }
+                        if (!fixedAst.valueMap) {
+                            buildSortedValues(module, values, fixedAst);
+                        }
+                    }
                 } else {
                     fieldAst.needsValue = true;
 
@@ -225,20 +559,8 @@ LLVMScanBase::LLVMScanBase(const Record& record, std::vector<ScanQuery*> queries
                     case FieldType::TEXT: {
                         queryReader.advance(2);
                         auto size = queryReader.read<uint32_t>();
-                        auto data = queryReader.read(size);
+                        setVariableValue(module, builder, queryReader.read(size), size, predicateAst.variable);
                         queryReader.align(8u);
-
-                        predicateAst.variable.size = size;
-                        predicateAst.variable.prefix = 0;
-                        if (size > 0) {
-                            memcpy(&predicateAst.variable.prefix, data,
-                                    size < sizeof(uint32_t) ? size : sizeof(uint32_t));
-
-                            auto value = ConstantDataArray::get(builder.getContext(),
-                                    makeArrayRef(reinterpret_cast<const uint8_t*>(data), size));
-                            predicateAst.variable.value = new GlobalVariable(mQueryModule.getModule(), value->getType(),
-                                    true, GlobalValue::PrivateLinkage, value);
-                        }
                     } break;
 
                     default: {
@@ -257,70 +579,71 @@ LLVMScanBase::LLVMScanBase(const Record& record, std::vector<ScanQuery*> queries
     LOG_ASSERT(mScanAst.conjunctProperties.size() == mScanAst.numConjunct, "Number of conjuncts does not match");
 }
 
-LLVMRowScanBase::LLVMRowScanBase(const Record& record, std::vector<ScanQuery*> queries)
-        : LLVMScanBase(record, std::move(queries)),
+std::string LLVMScanBase::materializationKey(ScanQuery* query) const {
+    auto key = mKeyPrefix;
+    key.push_back('M');
+    appendKey(key, crossbow::to_underlying(query->queryType()));
+    key.append(query->query(), query->queryLength());
+    return key;
+}
+
+LLVMRowScanBase::LLVMRowScanBase(uint64_t tableId, const Record& record, std::vector<ScanQuery*> queries,
+        LLVMCodeCache& codeCache)
+        : LLVMScanBase(tableId, record, std::move(queries), codeCache),
           mRowScanFun(nullptr) {
 }
 
 void LLVMRowScanBase::prepareQuery() {
     LOG_ASSERT(!mRowScanFun, "Scan already finalized");
-    LLVMRowScanBuilder::createFunction(mQueryModule.getModule(), mQueryModule.getTargetMachine(), mScanAst);
+    if (!lookupQueryCode()) {
+        auto& module = createQueryModule();
+        LLVMRowScanBuilder::createFunction(module.getModule(), module.getTargetMachine(), mScanAst);
 
-    mQueryModule.compile();
+        compileQueryCode({ LLVMRowScanBuilder::FUNCTION_NAME });
+    }
 
-    mRowScanFun = mQueryModule.findFunction<RowScanFun>(LLVMRowScanBuilder::FUNCTION_NAME);
+    mRowScanFun = reinterpret_cast<RowScanFun>(mQueryCode->functions.at(0));
 }
 
 void LLVMRowScanBase::prepareMaterialization() {
     LOG_ASSERT(mRowMaterializeFuns.empty(), "Scan already finalized");
-    std::unordered_map<QueryDataHolder, std::string> materializeCache;
-    for (decltype(mQueries.size()) i = 0; i < mQueries.size(); ++i) {
-        auto q = mQueries[i];
-        if (q->queryType() == ScanQueryType::FULL) {
-            continue;
+    compileMaterializationCode({
+        [this] (llvm::Module& module, llvm::TargetMachine* target, const std::string& name, ScanQuery* query) {
+            buildRowMaterialization(module, target, name, query);
         }
+    });
 
-        QueryDataHolder holder(q->query(), q->queryLength(), crossbow::to_underlying(q->queryType()));
-        if (materializeCache.find(holder) != materializeCache.end()) {
-            continue;
-        }
+    loadRowMaterialization();
+}
 
-        std::stringstream ss;
-        ss << ROW_MATERIALIZE_NAME << i;
-        auto name = ss.str();
-        materializeCache.emplace(holder, name);
-
-        switch (q->queryType()) {
-        case ScanQueryType::PROJECTION: {
-            LLVMRowProjectionBuilder::createFunction(mRecord, mMaterializationModule.getModule(),
-                    mMaterializationModule.getTargetMachine(), name, q);
-        } break;
-
-        case ScanQueryType::AGGREGATION: {
-            LLVMRowAggregationBuilder::createFunction(mRecord, mMaterializationModule.getModule(),
-                    mMaterializationModule.getTargetMachine(), name, q);
-        } break;
-
-        default: {
-            LOG_ASSERT(false, "Unknown query type");
-        } break;
-        }
+void LLVMRowScanBase::buildRowMaterialization(llvm::Module& module, llvm::TargetMachine* target,
+        const std::string& name, ScanQuery* query) {
+    switch (query->queryType()) {
+    case ScanQueryType::PROJECTION: {
+        LLVMRowProjectionBuilder::createFunction(mRecord, module, target, name, query);
+    } break;
+
+    case ScanQueryType::AGGREGATION:
+    case ScanQueryType::GROUP_BY: {
+        LLVMRowAggregationBuilder::createFunction(mRecord, module, target, name, query);
+    } break;
+
+    default: {
+        LOG_ASSERT(false, "Unknown query type");
+    } break;
     }
+}
 
-    mMaterializationModule.compile();
-
+void LLVMRowScanBase::loadRowMaterialization() {
+    LOG_ASSERT(mMaterializationCode.size() == mQueries.size(), "Materialization code not loaded");
+    mRowMaterializeFuns.reserve(mQueries.size());
     for (decltype(mQueries.size()) i = 0; i < mQueries.size(); ++i) {
-        auto q = mQueries[i];
-
-        if (q->queryType() == ScanQueryType::FULL) {
+        if (mQueries[i]->queryType() == ScanQueryType::FULL) {
             mRowMaterializeFuns.emplace_back(&memcpyWrapper);
             continue;
         }
-
-        QueryDataHolder holder(q->query(), q->queryLength(), crossbow::to_underlying(q->queryType()));
-        auto& name = materializeCache.at(holder);
-        auto fun = mMaterializationModule.findFunction<RowMaterializeFun>(name);
-        mRowMaterializeFuns.emplace_back(fun);
+        mRowMaterializeFuns.emplace_back(reinterpret_cast<RowMaterializeFun>(
+                mMaterializationCode[i]->functions.at(0)));
     }
 }
 
@@ -335,24 +658,45 @@ LLVMRowScanProcessorBase::LLVMRowScanProcessorBase(const Record& record, const s
     LOG_ASSERT(mNumConjuncts >= queries.size(), "More queries than conjuncts");
 
     mQueries.reserve(queries.size());
+    mVersionData.reserve(2 * queries.size());
     for (auto q : queries) {
         mQueries.emplace_back(q->createProcessor());
+
+        auto snapshot = q->snapshot();
+        mVersionData.emplace_back(snapshot->baseVersion());
+        mVersionData.emplace_back(snapshot->version());
     }
 }
 
+bool LLVMRowScanProcessorBase::queriesDone() const {
+    return !mQueries.empty() && std::all_of(mQueries.begin(), mQueries.end(), [] (const ScanQueryProcessor& query) {
+        return query.done();
+    });
+}
+
 void LLVMRowScanProcessorBase::processRowRecord(uint64_t key, uint64_t validFrom, uint64_t validTo, const char* data,
         uint32_t length) {
     LOG_ASSERT(mResult.size() >= mNumConjuncts, "Result array must be larger or equal than number of conjuncts");
 
-    mRowScanFun(key, validFrom, validTo, data, &mResult.front());
+    mRowScanFun(key, validFrom, validTo, data, &mResult.front(), mVersionData.data());
 
     for (decltype(mQueries.size()) i = 0; i < mQueries.size(); ++i) {
-        // Check if the selection string matches the record
-        if (mResult[i] == 0) {
+        // Check if the selection string matches the record and the query still needs tuples
+        if (mResult[i] == 0 || mQueries[i].done()) {
             continue;
         }
 
         auto fun = mRowMaterializeFuns[i];
+        if (mQueries[i].data()->queryType() == ScanQueryType::GROUP_BY) {
+            auto query = mQueries[i].data();
+            mQueries[i].writeGroupRecord(key, validFrom, validTo, [this, query, data] (std::string& groupKey) {
+                query->appendGroupKey(mRecord, data, groupKey);
+            }, [fun, data, length] (char* dest) {
+                fun(data, length, dest);
+            });
+            continue;
+        }
+
         mQueries[i].writeRecord(key, length, validFrom, validTo, [fun, data, length] (char* dest) {
             return fun(data, length, dest);
         });
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <util/LLVMBuilder.hpp>
+#include <util/LLVMCodeCache.hpp>
 #include <util/LLVMJIT.hpp>
 #include <util/ScanQuery.hpp>
 
@@ -38,7 +39,9 @@
 #include <boost/functional/hash.hpp>
 
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -52,8 +55,33 @@ class Record;
  */
 struct FixedPredicateAST {
     /// The value the predicate must match
+    /// Lower bound in case of a BETWEEN predicate, smallest value covered by the value map in case of an IN_LIST
+    /// predicate with a value map.
     llvm::Constant* value;
 
+    /// Upper bound in case of a BETWEEN predicate
+    llvm::Constant* upperValue;
+
+    /// Array of the values in case of an IN_LIST predicate
+    llvm::Constant* values;
+
+    /// Number of values in case of an IN_LIST predicate
+    uint32_t valueCount;
+
+    /// Byte map marking the values of an IN_LIST predicate on dense integer values (or null if the values are compared
+    /// one by one)
+    llvm::GlobalVariable* valueMap;
+
+    /// Number of values covered by the byte map
+    uint32_t mapSize;
+
+    /// Sorted array of the values of a large IN_LIST predicate not fitting into a byte map, padded to a power of two
+    /// with the largest value (or null if the values are not searched)
+    llvm::GlobalVariable* sortedValues;
+
+    /// Number of entries in the sorted array
+    uint32_t sortedSize;
+
     /// Predicate of the comparison
     llvm::CmpInst::Predicate predicate;
 
@@ -122,14 +150,11 @@ struct FieldAST {
 
 /**
  * @brief AST node representing a single query
+ *
+ * The snapshot versions of the query are not part of the AST: They are passed to the scan function at runtime so the
+ * compiled code can be reused by queries with the same selection but a different snapshot.
  */
 struct QueryAST {
-    /// Base version of the snapshot
-    uint64_t baseVersion;
-
-    /// Version of the snapshot
-    uint64_t version;
-
     /// Whether the conjuncts are shared with other queries
     bool shared;
 
@@ -259,35 +284,100 @@ private:
 ;
 class LLVMScanBase {
 protected:
-    LLVMScanBase(const Record& record, std::vector<ScanQuery*> queries);
+    /**
+     * @brief Function adding the materialization function with the given name for the query to the module
+     */
+    using MaterializeBuilder = std::function<void (llvm::Module& /* module */, llvm::TargetMachine* /* target */,
+            const std::string& /* name */, ScanQuery* /* query */)>;
+
+    LLVMScanBase(uint64_t tableId, const Record& record, std::vector<ScanQuery*> queries, LLVMCodeCache& codeCache);
+
+    /**
+     * @brief Looks up the compiled scan functions for the queries in the code cache
+     *
+     * @return Whether the scan functions were found in the cache
+     */
+    bool lookupQueryCode();
+
+    /**
+     * @brief Creates a new module for the scan functions and builds the scan AST from the queries
+     */
+    LLVMCodeModule& createQueryModule();
+
+    /**
+     * @brief Compiles the scan module and adds the scan functions to the code cache
+     *
+     * @param names Name of the functions to add to the cache entry
+     */
+    void compileQueryCode(const std::vector<std::string>& names);
+
+    /**
+     * @brief Looks up or compiles the materialization functions for every query
+     *
+     * All queries not found in the code cache are compiled together in one module.
+     *
+     * @param builders The builders invoked to generate the materialization functions for one query
+     */
+    void compileMaterializationCode(const std::vector<MaterializeBuilder>& builders);
 
     const Record& mRecord;
 
     std::vector<ScanQuery*> mQueries;
 
+    LLVMCodeCache& mCodeCache;
+
+    /// Number of conjuncts the scan function evaluates
+    uint32_t mNumConjunct;
+
+    /// The AST of the scan (only built in case the scan functions were not found in the cache)
     ScanAST mScanAst;
 
-    LLVMCodeModule mQueryModule;
-    LLVMCodeModule mMaterializationModule;
+    /// The compiled scan functions
+    LLVMCodeCache::EntryPtr mQueryCode;
+
+    /// The compiled materialization functions of every query (null in case of a full scan)
+    std::vector<LLVMCodeCache::EntryPtr> mMaterializationCode;
 
 private:
-    void buildScanAST(const Record& record);
+    void buildScanAST(llvm::Module& module);
+
+    std::string materializationKey(ScanQuery* query) const;
+
+    /// Key prefix identifying the table the scan is running on
+    std::string mKeyPrefix;
+
+    /// Key of the scan functions in the code cache
+    std::string mQueryKey;
+
+    std::shared_ptr<LLVMCodeModule> mQueryModule;
 };
 
 class LLVMRowScanBase : public LLVMScanBase {
 public:
     using RowScanFun = void (*) (uint64_t /* key */, uint64_t /* validFrom */, uint64_t /* validTo */,
-            const char* /* recordData */, char* /* destData */);
+            const char* /* recordData */, char* /* destData */, const uint64_t* /* versionData */);
 
     using RowMaterializeFun = uint32_t (*) (const char* /* srcData */, uint32_t /* length */, char* /* destData */);
 
 protected:
-    LLVMRowScanBase(const Record& record, std::vector<ScanQuery*> queries);
+    LLVMRowScanBase(uint64_t tableId, const Record& record, std::vector<ScanQuery*> queries,
+            LLVMCodeCache& codeCache);
 
     void prepareQuery();
 
     void prepareMaterialization();
 
+    /**
+     * @brief Adds the row materialization function of the query to the module
+     */
+    void buildRowMaterialization(llvm::Module& module, llvm::TargetMachine* target, const std::string& name,
+            ScanQuery* query);
+
+    /**
+     * @brief Loads the row materialization functions from the first function of every materialization entry
+     */
+    void loadRowMaterialization();
+
     RowScanFun mRowScanFun;
 
     std::vector<RowMaterializeFun> mRowMaterializeFuns;
@@ -314,6 +404,11 @@ protected:
      */
     void processRowRecord(uint64_t key, uint64_t validFrom, uint64_t validTo, const char* data, uint32_t length);
 
+    /**
+     * @brief Whether every query reached its limit and the processor can stop early
+     */
+    bool queriesDone() const;
+
     const Record& mRecord;
 
     std::vector<ScanQueryProcessor, tbb::cache_aligned_allocator<ScanQueryProcessor>> mQueries;
@@ -324,6 +419,9 @@ protected:
 
     uint32_t mNumConjuncts;
 
+    /// Base version and version of the snapshot of every query passed to the scan functions
+    std::vector<uint64_t> mVersionData;
+
     std::vector<char, tbb::cache_aligned_allocator<char>> mResult;
 };
 
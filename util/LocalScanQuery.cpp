@@ -0,0 +1,106 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include "LocalScanQuery.hpp"
+
+#include <crossbow/logger.hpp>
+
+namespace tell {
+namespace store {
+
+LocalScanQuery::LocalScanQuery(ScanQueryType queryType, std::unique_ptr<char[]> selectionData, size_t selectionLength,
+        std::unique_ptr<char[]> queryData, size_t queryLength, uint64_t lowKey, uint64_t highKey, uint64_t limit,
+        ScanOrder order, Record::id_t orderField, std::unique_ptr<commitmanager::SnapshotDescriptor> snapshot,
+        const Record& record, uint32_t bufferLength, Callback callback)
+        : ScanQuery(queryType, std::move(selectionData), selectionLength, std::move(queryData), queryLength, lowKey,
+                highKey, limit, order, orderField, std::move(snapshot), record),
+          mBufferLength(bufferLength),
+          mCallback(std::move(callback)),
+          mTotalWritten(0u),
+          mActive(0u),
+          mStarted(false) {
+}
+
+void LocalScanQuery::wait() {
+    std::unique_lock<decltype(mMutex)> lock(mMutex);
+    mCondition.wait(lock, [this] () {
+        return (mStarted && mActive == 0u);
+    });
+}
+
+std::tuple<char*, uint32_t> LocalScanQuery::acquireBuffer() {
+    return std::make_tuple(new char[mBufferLength], mBufferLength);
+}
+
+void LocalScanQuery::writeOngoing(const char* start, const char* end, std::error_code& /* ec */) {
+    doWrite(start, end);
+}
+
+void LocalScanQuery::writeLast(const char* start, const char* end, std::error_code& /* ec */) {
+    doWrite(start, end);
+    releaseProcessor();
+}
+
+void LocalScanQuery::writeLast(std::error_code& /* ec */) {
+    releaseProcessor();
+}
+
+ScanQueryProcessor LocalScanQuery::createProcessor() {
+    {
+        std::unique_lock<decltype(mMutex)> _(mMutex);
+        ++mActive;
+        mStarted = true;
+    }
+
+    ScanQueryProcessor processor(this);
+    if (queryType() == ScanQueryType::AGGREGATION) {
+        processor.initAggregationRecord();
+    } else if (queryType() == ScanQueryType::GROUP_BY) {
+        processor.initGroupAggregation();
+    } else if (order() != ScanOrder::NONE) {
+        processor.initOrderedLimit();
+    }
+    return processor;
+}
+
+void LocalScanQuery::doWrite(const char* start, const char* end) {
+    LOG_ASSERT(end >= start, "Invalid buffer");
+
+    if (end != start) {
+        mCallback(start, end);
+        mTotalWritten += static_cast<size_t>(end - start);
+    }
+    delete[] start;
+}
+
+void LocalScanQuery::releaseProcessor() {
+    std::unique_lock<decltype(mMutex)> _(mMutex);
+    LOG_ASSERT(mActive > 0u, "No active scan processor");
+    --mActive;
+    if (mActive == 0u) {
+        mCondition.notify_all();
+    }
+}
+
+} // namespace store
+} // namespace tell
@@ -0,0 +1,141 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#pragma once
+
+#include "ScanQuery.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <system_error>
+#include <tuple>
+
+namespace tell {
+namespace store {
+
+/**
+ * @brief ScanQuery implementation handing the scan data to a callback in the same process
+ *
+ * Every buffer filled by a scan processor is passed to the callback and released as soon as the callback returns. The
+ * buffers have the same format as the scan data written to a remote client (the 8 byte key followed by the tuple padded
+ * to 8 bytes for every tuple). The callback is invoked directly from the scan threads and as such might be invoked
+ * concurrently.
+ */
+class LocalScanQuery final : public ScanQuery {
+public:
+    using Callback = std::function<void(const char* start, const char* end)>;
+
+    LocalScanQuery(ScanQueryType queryType, std::unique_ptr<char[]> selectionData, size_t selectionLength,
+            std::unique_ptr<char[]> queryData, size_t queryLength, uint64_t lowKey, uint64_t highKey, uint64_t limit,
+            ScanOrder order, Record::id_t orderField, std::unique_ptr<commitmanager::SnapshotDescriptor> snapshot,
+            const Record& record, uint32_t bufferLength, Callback callback);
+
+    /**
+     * @brief Blocks until all scan processors of this scan have finished
+     */
+    void wait();
+
+    /**
+     * @brief Total number of bytes handed to the callback
+     */
+    size_t totalWritten() const {
+        return mTotalWritten.load();
+    }
+
+    /**
+     * @brief Allocates a new buffer
+     */
+    virtual std::tuple<char*, uint32_t> acquireBuffer() final override;
+
+    /**
+     * @brief Passes the tuples in the buffer to the callback
+     *
+     * @param start Begin pointer to the buffer containing the tuples
+     * @param end End pointer to the buffer containing the tuples
+     * @param ec Error in case the write fails
+     */
+    virtual void writeOngoing(const char* start, const char* end, std::error_code& ec) final override;
+
+    /**
+     * @brief Passes the last tuples to the callback
+     *
+     * The scan is marked as done in case this was the last active ScanQueryProcessor.
+     *
+     * @param start Begin pointer to the buffer containing the tuples
+     * @param end End pointer to the buffer containing the tuples
+     * @param ec Error in case the write fails
+     */
+    virtual void writeLast(const char* start, const char* end, std::error_code& ec) final override;
+
+    /**
+     * @brief Marks the ScanQueryProcessor as done
+     *
+     * The scan is marked as done in case this was the last active ScanQueryProcessor.
+     *
+     * @param ec Error in case the write fails
+     */
+    virtual void writeLast(std::error_code& ec) final override;
+
+    /**
+     * @brief Create a new ScanQueryProcessor associated with this scan
+     *
+     * Increases the number of active ScanQueryProcessor referencing the shared data.
+     */
+    virtual ScanQueryProcessor createProcessor() final override;
+
+private:
+    /**
+     * @brief Passes the buffer to the callback and releases it afterwards
+     */
+    void doWrite(const char* start, const char* end);
+
+    /**
+     * @brief Decreases the number of active ScanQueryProcessor and wakes up the waiting thread if it was the last
+     */
+    void releaseProcessor();
+
+    /// Size of the buffers handed to the scan processors
+    uint32_t mBufferLength;
+
+    /// Callback receiving the scan data
+    Callback mCallback;
+
+    /// Total number of bytes passed to the callback
+    std::atomic<size_t> mTotalWritten;
+
+    /// Number of currently active ScanQueryProcessor
+    /// Protected by mMutex.
+    uint32_t mActive;
+
+    /// Whether any ScanQueryProcessor has been created
+    /// Protected by mMutex.
+    bool mStarted;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+};
+
+} // namespace store
+} // namespace tell
@@ -47,6 +47,14 @@ uint32_t LogEntry::tryAcquire(uint32_t size, uint32_t type) {
     return 0x0u;
 }
 
+void LogEntry::assign(uint32_t size, uint32_t type) {
+    LOG_ASSERT(size != 0x0u, "Size has to be greater than zero");
+    LOG_ASSERT((size >> 31) == 0, "MSB has to be zero");
+
+    mType = type;
+    mSize.store((size << 1) | 0x1u);
+}
+
 LogEntry* LogPage::append(uint32_t size, uint32_t type /* = 0x0u */) {
     auto entrySize = LogEntry::entrySizeFromSize(size);
     if (entrySize > LogPage::MAX_ENTRY_SIZE) {
@@ -83,27 +91,89 @@ LogEntry* LogPage::appendEntry(uint32_t size, uint32_t entrySize, uint32_t type)
             continue;
         }
 
-        // Try to set the new offset until we succeed or another thread set a higher offset
-        auto nOffset = ((endPosition << 1) | 0x1u);
-        while (offset < nOffset) {
-            // Set new offset, if this fails offset will contain the new offset value
-            if (mOffset.compare_exchange_strong(offset, nOffset)) {
+        if (!advanceOffset(offset, endPosition)) {
+            return nullptr;
+        }
+
+        return entry;
+    }
+}
+
+size_t LogPage::appendEntries(const uint32_t* sizes, const uint32_t* types, size_t count, LogEntry** entries) {
+    auto offset = mOffset.load();
+
+    // Check if page is already sealed
+    if ((offset & 0x1u) == 0) {
+        return 0u;
+    }
+    auto position = (offset >> 1);
+
+    while (true) {
+        // Determine how many of the entries fit into the remaining space of the page
+        size_t num = 0u;
+        uint32_t blockSize = 0u;
+        for (; num < count; ++num) {
+            auto entrySize = LogEntry::entrySizeFromSize(sizes[num]);
+            if (position + blockSize + entrySize > LogPage::MAX_ENTRY_SIZE) {
                 break;
             }
-            // Check if page was sealed in the meantime
-            if ((offset & 0x1u) == 0) {
-                // Check if page was sealed after we completely acquired the space for the log entry
-                if ((offset >> 1) >= endPosition) {
-                    break;
-                }
+            blockSize += entrySize;
+        }
+        if (num == 0u) {
+            return 0u;
+        }
+        auto endPosition = position + blockSize;
 
-                // Page was sealed before we completely acquired the space for the log entry
-                return nullptr;
-            }
+        // Try to acquire the space for all entries at once as a single entry spanning the whole block
+        auto entry = reinterpret_cast<LogEntry*>(this->data() + position);
+        LOG_ASSERT((reinterpret_cast<uintptr_t>(entry) % 16) == 8 , "Position is not 16 byte aligned with offset 8");
+
+        auto res = entry->tryAcquire(blockSize - LogEntry::LOG_ENTRY_SIZE, types[0]);
+        if (res != 0) {
+            position += res;
+            continue;
         }
 
-        return entry;
+        if (!advanceOffset(offset, endPosition)) {
+            return 0u;
+        }
+
+        // Split the block into the individual entries
+        // Concurrent appenders and iterators step over the block as long as the first entry spans the whole block. The
+        // following entries have to be initialized before the first entry is shrunk to its actual size.
+        auto pos = reinterpret_cast<char*>(entry) + LogEntry::entrySizeFromSize(sizes[0]);
+        for (size_t i = 1; i < num; ++i) {
+            entries[i] = reinterpret_cast<LogEntry*>(pos);
+            entries[i]->assign(sizes[i], types[i]);
+            pos += LogEntry::entrySizeFromSize(sizes[i]);
+        }
+        entry->assign(sizes[0], types[0]);
+        entries[0] = entry;
+
+        return num;
+    }
+}
+
+bool LogPage::advanceOffset(uint32_t offset, uint32_t endPosition) {
+    // Try to set the new offset until we succeed or another thread set a higher offset
+    auto nOffset = ((endPosition << 1) | 0x1u);
+    while (offset < nOffset) {
+        // Set new offset, if this fails offset will contain the new offset value
+        if (mOffset.compare_exchange_strong(offset, nOffset)) {
+            break;
+        }
+        // Check if page was sealed in the meantime
+        if ((offset & 0x1u) == 0) {
+            // Check if page was sealed after we completely acquired the space for the log entry
+            if ((offset >> 1) >= endPosition) {
+                break;
+            }
+
+            // Page was sealed before we completely acquired the space for the log entry
+            return false;
+        }
     }
+    return true;
 }
 
 void BaseLogImpl::freeEmptyPageNow(LogPage* page) {
@@ -204,6 +274,23 @@ LogEntry* UnorderedLogImpl::appendEntry(uint32_t size, uint32_t entrySize, uint3
     return nullptr;
 }
 
+size_t UnorderedLogImpl::appendEntries(const uint32_t* sizes, const uint32_t* types, size_t count, LogEntry** entries) {
+    auto head = mHead.load();
+    while (head.writeHead) {
+        // Try to append as many log entries as possible to the page
+        auto num = head.writeHead->appendEntries(sizes, types, count, entries);
+        if (num != 0u) {
+            return num;
+        }
+
+        // The page must be full, acquire a new one
+        head = createPage(head);
+    }
+
+    // This can only happen if the page manager ran out of space
+    return 0u;
+}
+
 UnorderedLogImpl::LogHead UnorderedLogImpl::createPage(LogHead oldHead) {
     auto writeHead = oldHead.writeHead;
 
@@ -302,6 +389,23 @@ LogEntry* OrderedLogImpl::appendEntry(uint32_t size, uint32_t entrySize, uint32_
     return nullptr;
 }
 
+size_t OrderedLogImpl::appendEntries(const uint32_t* sizes, const uint32_t* types, size_t count, LogEntry** entries) {
+    auto head = mHead.load();
+    while (head) {
+        // Try to append as many log entries as possible to the page
+        auto num = head->appendEntries(sizes, types, count, entries);
+        if (num != 0u) {
+            return num;
+        }
+
+        // The page must be full, acquire a new one
+        head = createPage(head);
+    }
+
+    // This can only happen if the page manager ran out of space
+    return 0u;
+}
+
 LogPage* OrderedLogImpl::createPage(LogPage* oldHead) {
     // Check if the old head already has a next pointer
     auto next = oldHead->next().load();
@@ -476,6 +580,27 @@ LogEntry* Log<Impl>::append(uint32_t size, uint32_t type /* = 0x0u */) {
     return Impl::appendEntry(size, entrySize, type);
 }
 
+template <class Impl>
+size_t Log<Impl>::append(const uint32_t* sizes, const uint32_t* types, size_t count, LogEntry** entries) {
+    for (size_t i = 0; i < count; ++i) {
+        auto entrySize = LogEntry::entrySizeFromSize(sizes[i]);
+        if (entrySize > LogPage::MAX_ENTRY_SIZE) {
+            LOG_ASSERT(false, "Tried to append %d bytes but %d bytes is max", entrySize, LogPage::MAX_ENTRY_SIZE);
+            return 0u;
+        }
+    }
+
+    size_t appended = 0u;
+    while (appended < count) {
+        auto num = Impl::appendEntries(sizes + appended, types + appended, count - appended, entries + appended);
+        if (num == 0u) {
+            break;
+        }
+        appended += num;
+    }
+    return appended;
+}
+
 template class Log<UnorderedLogImpl>;
 template class Log<OrderedLogImpl>;
 
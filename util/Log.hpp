@@ -157,6 +157,17 @@ private:
      */
     uint32_t tryAcquire(uint32_t size, uint32_t type);
 
+    /**
+     * @brief Initializes the unsealed LogEntry at this log position
+     *
+     * Must only be called on space already acquired by the caller (i.e. while splitting a block acquired by
+     * LogPage::appendEntries).
+     *
+     * @param size Size of the data payload the entry contains
+     * @param type User specified type of the new entry
+     */
+    void assign(uint32_t size, uint32_t type);
+
     /// Size of the data payload this entry contains shifted to bits 1-31, bit 0 indicates if the entry was sealed
     /// (if 0) or not (if 1)
     std::atomic<uint32_t> mSize;
@@ -267,6 +278,20 @@ public:
      */
     LogEntry* appendEntry(uint32_t size, uint32_t entrySize, uint32_t type);
 
+    /**
+     * @brief Appends multiple new entries to this log page with a single reservation
+     *
+     * The entries are acquired as one contiguous block. Only as many entries as fit into the remaining space of the
+     * page are appended.
+     *
+     * @param sizes Size of the data payload of every new entry
+     * @param types User specified type of every new entry
+     * @param count Number of new entries
+     * @param entries Array receiving the pointer to every allocated LogEntry
+     * @return Number of entries allocated in this page (0 if unable to allocate any entry in this page)
+     */
+    size_t appendEntries(const uint32_t* sizes, const uint32_t* types, size_t count, LogEntry** entries);
+
     /**
      * @brief Page preceeding the current page in the log
      */
@@ -346,6 +371,13 @@ public:
     }
 
 private:
+    /**
+     * @brief Advances the page offset to the end position of space acquired at the given offset
+     *
+     * @return Whether the space was acquired completely before the page was sealed
+     */
+    bool advanceOffset(uint32_t offset, uint32_t endPosition);
+
     std::atomic<LogPage*> mNext;
     std::atomic<uint32_t> mOffset;
     std::atomic<uint32_t> mContext;
@@ -452,6 +484,13 @@ public:
         uint32_t mPos;
     };
 
+    /**
+     * @brief The page manager the log pages are allocated from
+     */
+    const PageManager& pageManager() const {
+        return mPageManager;
+    }
+
     /**
      * @brief Acquires an empty log page from the page manager
      */
@@ -601,6 +640,8 @@ protected:
 
     LogEntry* appendEntry(uint32_t size, uint32_t entrySize, uint32_t type);
 
+    size_t appendEntries(const uint32_t* sizes, const uint32_t* types, size_t count, LogEntry** entries);
+
     /**
      * @brief Page iteration starts from the head
      */
@@ -819,6 +860,8 @@ protected:
 
     LogEntry* appendEntry(uint32_t size, uint32_t entrySize, uint32_t type);
 
+    size_t appendEntries(const uint32_t* sizes, const uint32_t* types, size_t count, LogEntry** entries);
+
     /**
      * @brief Page iteration starts from the tail
      */
@@ -973,6 +1016,20 @@ public:
      */
     LogEntry* append(uint32_t size, uint32_t type = 0x0u);
 
+    /**
+     * @brief Appends multiple new entries to the log
+     *
+     * Reserves the space for as many entries as fit into the current head page with a single atomic operation instead
+     * of one per entry. All appended entries have to be sealed by the caller, even if not all entries were appended.
+     *
+     * @param sizes Size of the data payload of every new entry
+     * @param types User specified type of every new entry
+     * @param count Number of new entries
+     * @param entries Array receiving the pointer to every allocated LogEntry
+     * @return Number of entries appended (less than count if unable to allocate all entries)
+     */
+    size_t append(const uint32_t* sizes, const uint32_t* types, size_t count, LogEntry** entries);
+
     PageIterator pageBegin() {
         return Impl::template pageBeginImpl<PageIterator>();
     }
@@ -0,0 +1,121 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include "Numa.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tell {
+namespace store {
+namespace {
+
+/**
+ * @brief Memory policy preferring allocations on the given node (MPOL_PREFERRED from the kernel headers)
+ */
+constexpr int gPreferredPolicy = 1;
+
+/**
+ * @brief Parses a list of ranges in the format used by sysfs (e.g. "0-7,16-23")
+ */
+std::vector<size_t> readList(const std::string& path) {
+    std::vector<size_t> result;
+    std::ifstream in(path);
+    std::string list;
+    if (!std::getline(in, list)) {
+        return result;
+    }
+
+    size_t pos = 0;
+    while (pos < list.size()) {
+        auto end = list.find(',', pos);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        auto range = list.substr(pos, end - pos);
+        pos = end + 1;
+
+        unsigned long first, last;
+        auto count = sscanf(range.c_str(), "%lu-%lu", &first, &last);
+        if (count < 1) {
+            continue;
+        }
+        if (count == 1) {
+            last = first;
+        }
+        for (auto i = first; i <= last; ++i) {
+            result.emplace_back(i);
+        }
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+size_t numaNodeCount() {
+    static const size_t nodeCount = [] () {
+        auto nodes = readList("/sys/devices/system/node/online");
+        return (nodes.empty() ? size_t(1u) : *std::max_element(nodes.begin(), nodes.end()) + 1);
+    }();
+    return nodeCount;
+}
+
+size_t numaCurrentNode() {
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+        return 0u;
+    }
+    return std::min(static_cast<size_t>(node), numaNodeCount() - 1);
+}
+
+bool numaBindMemory(void* data, size_t length, size_t node) {
+    constexpr size_t bitsPerWord = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> mask(node / bitsPerWord + 1, 0u);
+    mask[node / bitsPerWord] |= (1ul << (node % bitsPerWord));
+    return (syscall(SYS_mbind, data, length, gPreferredPolicy, mask.data(), mask.size() * bitsPerWord + 1, 0) == 0);
+}
+
+bool numaBindThread(size_t node) {
+    auto cpus = readList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (cpus.empty()) {
+        return false;
+    }
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (auto cpu : cpus) {
+        CPU_SET(cpu, &cpuSet);
+    }
+    return (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) == 0);
+}
+
+} // namespace store
+} // namespace tell
@@ -0,0 +1,59 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+#pragma once
+
+#include <cstddef>
+
+namespace tell {
+namespace store {
+
+/**
+ * @brief Number of NUMA nodes in the system
+ *
+ * Returns 1 if no NUMA information is available.
+ */
+size_t numaNodeCount();
+
+/**
+ * @brief NUMA node of the CPU the calling thread is currently running on
+ */
+size_t numaCurrentNode();
+
+/**
+ * @brief Sets the preferred NUMA node for the physical memory backing the given memory region
+ *
+ * Has to be called before the memory is touched for the first time.
+ *
+ * @return Whether the memory policy was successfully set
+ */
+bool numaBindMemory(void* data, size_t length, size_t node);
+
+/**
+ * @brief Restricts the calling thread to the CPUs of the given NUMA node
+ *
+ * @return Whether the CPU affinity was successfully set
+ */
+bool numaBindThread(size_t node);
+
+} // namespace store
+} // namespace tell
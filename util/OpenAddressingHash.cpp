@@ -22,16 +22,24 @@
  */
 #include "OpenAddressingHash.hpp"
 
+#include <crossbow/allocator.hpp>
 #include <crossbow/enum_underlying.hpp>
 #include <crossbow/logger.hpp>
 
 #include <boost/functional/hash.hpp>
 
+#include <algorithm>
+
 namespace tell {
 namespace store {
 
 namespace {
 
+/**
+ * @brief Number of buckets migrated at once by an operation helping with a resize
+ */
+constexpr size_t gMigrationRangeSize = 0x400u;
+
 /**
  * @brief Check the wellformedness of tableId and key
  */
@@ -49,76 +57,127 @@ void checkDataPtr(const void* ptr) {
 
 } // anonymous namespace
 
+OpenAddressingTable::Generation::Generation(size_t capacity)
+        : capacity(capacity),
+          maximumSize((capacity * 3u) / 4u),
+          buckets(new Entry[capacity]),
+          tableHash(capacity),
+          keyHash(capacity),
+          size(0u),
+          next(nullptr),
+          migrateOffset(0u),
+          migrated(0u) {
+}
+
 OpenAddressingTable::OpenAddressingTable(size_t capacity)
-        : mCapacity(capacity),
-          mBuckets(new Entry[mCapacity]),
-          mTableHash(mCapacity),
-          mKeyHash(mCapacity) {
+        : mGeneration(crossbow::allocator::construct<Generation>(capacity)) {
+    LOG_ASSERT(capacity > 1, "Capacity must be larger than 1");
 }
 
 OpenAddressingTable::~OpenAddressingTable() {
-    delete[] mBuckets;
+    auto generation = mGeneration.exchange(nullptr);
+    while (generation != nullptr) {
+        auto next = generation->next.load();
+        crossbow::allocator::destroy_now(generation);
+        generation = next;
+    }
 }
 
-const void* OpenAddressingTable::get(uint64_t table, uint64_t key) const {
-    checkDataKey(table, key);
-
-    return execOnElement(table, key, static_cast<const void*>(nullptr), [] (const Entry& /* entry */, const void* ptr) {
-        return ptr;
-    });
+size_t OpenAddressingTable::capacity() const {
+    auto generation = mGeneration.load();
+    while (auto next = generation->next.load()) {
+        generation = next;
+    }
+    return generation->capacity;
 }
 
-bool OpenAddressingTable::insert(uint64_t table, uint64_t key, void* data, void** actualData /* = nullptr */) {
-    checkDataKey(table, key);
-    checkDataPtr(data);
+OpenAddressingTable::Statistics OpenAddressingTable::statistics() const {
+    auto generation = mGeneration.load();
+    while (auto next = generation->next.load()) {
+        generation = next;
+    }
 
-    auto hash = calculateHash(table, key);
-    for (auto pos = hash; pos < (hash + mCapacity); ++pos) {
-        auto& entry = mBuckets[pos % mCapacity];
+    size_t size = 0u;
+    size_t totalProbeLength = 0u;
+    size_t maxProbeLength = 0u;
+    for (size_t i = 0; i < generation->capacity; ++i) {
+        auto& entry = generation->buckets[i];
         auto ptr = entry.ptr.load();
-
-        // Check if pointer is already acquired (i.e. not a deletion and not free) - Skip bucket if it is
-        // There is no need to check if the insertion will conflict as this will be resolved at a later time.
-        if ((ptr != (crossbow::to_underlying(EntryMarker::DELETED))
-                && (ptr != crossbow::to_underlying(EntryMarker::FREE)))) {
+        if (ptr == crossbow::to_underlying(EntryMarker::FREE) || (ptr & MARKER_MASK) != 0x0u) {
             continue;
         }
 
-        // Try to claim this bucket by setting the pointer to inserting
-        // If this fails somebody else claimed the bucket in the mean time
-        auto insertPtr = (reinterpret_cast<uintptr_t>(data) | crossbow::to_underlying(EntryMarker::INSERTING));
-        if (!entry.ptr.compare_exchange_strong(ptr, insertPtr)) {
+        auto t = entry.tableId.load();
+        auto k = entry.keyId.load();
+        if (entry.ptr.load() != ptr) {
             continue;
         }
 
-        // Write the key and table information
-        // Table has to be written last as it is read last by readers to detect if key was written correctly
-        entry.keyId.store(key);
-        entry.tableId.store(table);
+        auto hash = calculateHash(*generation, t, k);
+        auto probeLength = ((i + generation->capacity - hash) % generation->capacity) + 1;
+        totalProbeLength += probeLength;
+        maxProbeLength = std::max(maxProbeLength, probeLength);
+        ++size;
+    }
 
-        // Check if another insert conflicts with ours
-        // If this fails somebody else is inserting or has already inserted the same key, set pointer to invalid and
-        // free bucket.
-        if (hasInsertConflict(hash, pos, table, key, actualData)) {
-            entry.ptr.store(crossbow::to_underlying(EntryMarker::INVALID));
-            deleteEntry(entry);
-            return false;
+    Statistics statistics;
+    statistics.capacity = generation->capacity;
+    statistics.size = size;
+    statistics.loadFactor = static_cast<double>(size) / static_cast<double>(generation->capacity);
+    statistics.averageProbeLength = (size == 0u ? 0.0 : static_cast<double>(totalProbeLength) / size);
+    statistics.maxProbeLength = maxProbeLength;
+    return statistics;
+}
+
+OpenAddressingTable::View OpenAddressingTable::view() {
+    auto generation = mGeneration.load();
+    while (auto next = generation->next.load()) {
+        // Migrate every remaining bucket so all elements are contained in the next generation
+        for (size_t i = 0; i < generation->capacity; ++i) {
+            migrateEntry(*generation, generation->buckets[i]);
         }
+        generation = next;
+    }
+    return View(generation, generation->capacity);
+}
 
-        // Try to set the pointer from null or deleted to our data pointer
-        // If this fails somebody else set the element to invalid and the bucket has to be released
-        if (!entry.ptr.compare_exchange_strong(insertPtr, reinterpret_cast<uintptr_t>(data))) {
-            deleteEntry(entry);
+const void* OpenAddressingTable::get(uint64_t table, uint64_t key) const {
+    checkDataKey(table, key);
 
-            if (actualData) *actualData = nullptr;
-            return false;
+    return getEntry(mGeneration.load(), table, key);
+}
+
+void OpenAddressingTable::prefetch(uint64_t table, uint64_t key) const {
+    auto generation = mGeneration.load();
+    __builtin_prefetch(&generation->buckets[calculateHash(*generation, table, key)]);
+}
+
+bool OpenAddressingTable::insert(uint64_t table, uint64_t key, void* data, void** actualData /* = nullptr */) {
+    checkDataKey(table, key);
+    checkDataPtr(data);
+
+    auto generation = mGeneration.load();
+    while (true) {
+        generation = writableGeneration(generation, table, key);
+        switch (insertEntry(*generation, table, key, data, actualData, nullptr, 0x0u)) {
+        case InsertResult::SUCCESS: {
+            if (generation->size.load() >= generation->maximumSize) {
+                resize(*generation);
+            }
+            return true;
         }
 
-        return true;
-    }
+        case InsertResult::CONFLICT:
+            return false;
 
-    LOG_ERROR("Hash table is full");
-    return false;
+        case InsertResult::FULL: {
+            resize(*generation);
+        } break;
+
+        case InsertResult::RETRY:
+            break;
+        }
+    }
 }
 
 bool OpenAddressingTable::update(uint64_t table, uint64_t key, const void* oldData, void* newData,
@@ -127,37 +186,93 @@ bool OpenAddressingTable::update(uint64_t table, uint64_t key, const void* oldDa
     checkDataPtr(oldData);
     checkDataPtr(newData);
 
-    return execOnElement(table, key, false, [table, key, oldData, newData, actualData] (Entry& entry, void* /* ptr */) {
+    auto generation = mGeneration.load();
+    while (true) {
+        generation = writableGeneration(generation, table, key);
+
+        uintptr_t ptr;
+        auto frozen = false;
+        auto entry = findEntry(*generation, table, key, ptr, frozen);
+        if (!entry) {
+            // Repeat the search in the next generation if the element might have been migrated
+            if (frozen) {
+                continue;
+            }
+            return false;
+        }
+
+        // Check if the entry was frozen by a resize - Repeat the update in the next generation if it was
+        if ((ptr & MARKER_MASK) != 0x0u) {
+            continue;
+        }
+
         auto expected = reinterpret_cast<uintptr_t>(oldData);
-        if (entry.ptr.compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(newData))) {
+        if (entry->ptr.compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(newData))) {
             return true;
         }
 
-        setActualData(table, key, actualData, entry, expected);
+        if (isFrozen(expected)) {
+            continue;
+        }
+
+        setActualData(table, key, actualData, *entry, expected);
         return false;
-    });
+    }
 }
 
 bool OpenAddressingTable::erase(uint64_t table, uint64_t key, const void* oldData, void** actualData /* = nullptr */) {
     checkDataKey(table, key);
     checkDataPtr(oldData);
 
-    return execOnElement(table, key, true, [table, key, oldData, actualData] (Entry& entry, const void* /* ptr */) {
+    auto generation = mGeneration.load();
+    while (true) {
+        generation = writableGeneration(generation, table, key);
+
+        uintptr_t ptr;
+        auto frozen = false;
+        auto entry = findEntry(*generation, table, key, ptr, frozen);
+        if (!entry) {
+            // Repeat the search in the next generation if the element might have been migrated
+            if (frozen) {
+                continue;
+            }
+            return true;
+        }
+
+        // Check if the entry was frozen by a resize - Repeat the erase in the next generation if it was
+        if ((ptr & MARKER_MASK) != 0x0u) {
+            continue;
+        }
+
         auto expected = reinterpret_cast<uintptr_t>(oldData);
-        if (entry.ptr.compare_exchange_strong(expected, crossbow::to_underlying(EntryMarker::INVALID))) {
-            deleteEntry(entry);
+        if (entry->ptr.compare_exchange_strong(expected, crossbow::to_underlying(EntryMarker::INVALID))) {
+            deleteEntry(*entry);
+            --generation->size;
             return true;
         }
 
-        setActualData(table, key, actualData, entry, expected);
+        if (isFrozen(expected)) {
+            continue;
+        }
+
+        setActualData(table, key, actualData, *entry, expected);
         return false;
-    });
+    }
+}
+
+bool OpenAddressingTable::isFrozen(uintptr_t ptr) {
+    return ((ptr & MARKER_MASK) == crossbow::to_underlying(EntryMarker::FROZEN)
+            || ptr == crossbow::to_underlying(EntryMarker::FROZEN_EMPTY)
+            || ptr == crossbow::to_underlying(EntryMarker::FROZEN_FREE));
 }
 
 void OpenAddressingTable::deleteEntry(Entry& entry) {
     entry.tableId.store(0x0u);
     entry.keyId.store(0x0u);
-    entry.ptr.store(crossbow::to_underlying(EntryMarker::DELETED));
+
+    // The entry might have been frozen by a resize in the meantime, in this case it must not be reused
+    auto expected = crossbow::to_underlying(EntryMarker::INVALID);
+    entry.ptr.compare_exchange_strong(expected, crossbow::to_underlying(EntryMarker::DELETED));
 }
 
 void OpenAddressingTable::setActualData(uint64_t table, uint64_t key, void** actualData, const Entry& entry,
@@ -167,7 +282,7 @@ void OpenAddressingTable::setActualData(uint64_t table, uint64_t key, void** act
     }
 
     while (true) {
-        // Check if pointer is marked as deleted, inserting or invalid (it will never be free)
+        // Check if pointer is marked as deleted, inserting, invalid or frozen (it will never be free)
         if ((ptr & MARKER_MASK) != 0x0u) {
             *actualData = nullptr;
             return;
@@ -197,29 +312,35 @@ void OpenAddressingTable::setActualData(uint64_t table, uint64_t key, void** act
     }
 }
 
-uint64_t OpenAddressingTable::calculateHash(uint64_t table, uint64_t key) const {
-    auto hash = mTableHash(table);
-    boost::hash_combine(hash, mKeyHash(key));
-    return hash;
+size_t OpenAddressingTable::calculateHash(const Generation& generation, uint64_t table, uint64_t key) {
+    auto hash = generation.tableHash(table);
+    boost::hash_combine(hash, generation.keyHash(key));
+    return (hash % generation.capacity);
 }
 
-bool OpenAddressingTable::hasInsertConflict(size_t hash, size_t insertPos, uint64_t table, uint64_t key,
-        void** actualData) {
+OpenAddressingTable::InsertResult OpenAddressingTable::hasInsertConflict(Generation& generation, size_t hash,
+        size_t insertPos, uint64_t table, uint64_t key, void** actualData) {
     auto pos = hash;
-    while (pos < (hash + mCapacity)) {
+    while (pos < (hash + generation.capacity)) {
         // Skip our own entry
         if (pos == insertPos) {
             ++pos;
             continue;
         }
 
-        auto& entry = mBuckets[pos % mCapacity];
+        auto& entry = generation.buckets[pos % generation.capacity];
         auto ptr = entry.ptr.load();
 
+        // Check if the bucket was frozen by a resize - Abort as the insert has to be repeated in the next generation
+        if (isFrozen(ptr)) {
+            if (actualData) *actualData = nullptr;
+            return InsertResult::RETRY;
+        }
+
         // Check if we reached the end of the overflow bucket
         if (ptr == crossbow::to_underlying(EntryMarker::FREE)) {
             LOG_ASSERT(pos > insertPos, "Reached end of overflow before reaching insert element");
-            return false;
+            return InsertResult::SUCCESS;
         }
 
         // Check if pointer is invalid or deleted - Skip bucket if it is
@@ -263,12 +384,12 @@ bool OpenAddressingTable::hasInsertConflict(size_t hash, size_t insertPos, uint6
             // No concurrent insert, no deletion, no invalid, no free element as such the pointer has to be valid
             // Abort as another thread already completed the insert
             if (actualData) *actualData = reinterpret_cast<void*>(ptr);
-            return true;
+            return InsertResult::CONFLICT;
         } else if (pos < insertPos) {
             // Concurrent insert and the element of the other thread is located in a bucket before our own insert bucket
             // Abort our own insert
             if (actualData) *actualData = nullptr;
-            return true;
+            return InsertResult::CONFLICT;
         }
 
         // The element is located in a bucket after our own insert bucket so we try to set the other pointer to invalid
@@ -292,32 +413,106 @@ bool OpenAddressingTable::hasInsertConflict(size_t hash, size_t insertPos, uint6
         // Check if the pointer is already set (not null without marker)
         if ((ptr & POINTER_MASK) == expected) {
             if (actualData) *actualData = reinterpret_cast<void*>(expected);
-            return true;
+            return InsertResult::CONFLICT;
         }
 
         // The pointer changed completely - Recheck the current bucket
     }
 
-    return false;
+    return InsertResult::SUCCESS;
 }
 
-template <typename T, typename F>
-T OpenAddressingTable::execOnElement(uint64_t table, uint64_t key, T notFound, F fun) const {
-    auto hash = calculateHash(table, key);
-    auto pos = hash;
-    while (pos < (hash + mCapacity)) {
-        auto& entry = mBuckets[pos % mCapacity];
+OpenAddressingTable::InsertResult OpenAddressingTable::insertEntry(Generation& generation, uint64_t table,
+        uint64_t key, void* data, void** actualData, const std::atomic<uintptr_t>* source, uintptr_t sourcePtr) {
+    auto hash = calculateHash(generation, table, key);
+    for (auto pos = hash; pos < (hash + generation.capacity); ++pos) {
+        auto& entry = generation.buckets[pos % generation.capacity];
         auto ptr = entry.ptr.load();
 
-        // Check if pointer is marked as deleted, inserting or invalid - Skip bucket if it is
-        if ((ptr & MARKER_MASK) != crossbow::to_underlying(EntryMarker::FREE)) {
-            ++pos;
+        // Check if the bucket was frozen by a resize - The insert has to be repeated in the next generation
+        if (isFrozen(ptr)) {
+            return InsertResult::RETRY;
+        }
+
+        // Check if pointer is already acquired (i.e. not a deletion and not free) - Skip bucket if it is
+        // There is no need to check if the insertion will conflict as this will be resolved at a later time.
+        if ((ptr != (crossbow::to_underlying(EntryMarker::DELETED))
+                && (ptr != crossbow::to_underlying(EntryMarker::FREE)))) {
             continue;
         }
 
+        // Try to claim this bucket by setting the pointer to inserting
+        // If this fails somebody else claimed the bucket in the mean time
+        auto insertPtr = (reinterpret_cast<uintptr_t>(data) | crossbow::to_underlying(EntryMarker::INSERTING));
+        if (!entry.ptr.compare_exchange_strong(ptr, insertPtr)) {
+            continue;
+        }
+
+        // Write the key and table information
+        // Table has to be written last as it is read last by readers to detect if key was written correctly
+        entry.keyId.store(key);
+        entry.tableId.store(table);
+
+        // Check if another insert conflicts with ours
+        // If this fails somebody else is inserting or has already inserted the same key, set pointer to invalid and
+        // free bucket. An element copied by a resize is also aborted when the source entry changed in the meantime as
+        // the element was then already copied by somebody else.
+        auto result = hasInsertConflict(generation, hash, pos, table, key, actualData);
+        if (result == InsertResult::SUCCESS && source != nullptr && source->load() != sourcePtr) {
+            if (actualData) *actualData = nullptr;
+            result = InsertResult::CONFLICT;
+        }
+        if (result != InsertResult::SUCCESS) {
+            entry.ptr.compare_exchange_strong(insertPtr, crossbow::to_underlying(EntryMarker::INVALID));
+            deleteEntry(entry);
+            return result;
+        }
+
+        // Try to set the pointer from inserting to our data pointer
+        // If this fails somebody else (either a conflicting insert or a resize) set the element to invalid and the
+        // bucket has to be released
+        if (!entry.ptr.compare_exchange_strong(insertPtr, reinterpret_cast<uintptr_t>(data))) {
+            deleteEntry(entry);
+
+            if (generation.next.load() != nullptr) {
+                return InsertResult::RETRY;
+            }
+
+            if (actualData) *actualData = nullptr;
+            return InsertResult::CONFLICT;
+        }
+
+        ++generation.size;
+        return InsertResult::SUCCESS;
+    }
+
+    return InsertResult::FULL;
+}
+
+OpenAddressingTable::Entry* OpenAddressingTable::findEntry(const Generation& generation, uint64_t table, uint64_t key,
+        uintptr_t& ptr, bool& frozen) {
+    auto hash = calculateHash(generation, table, key);
+    auto pos = hash;
+    while (pos < (hash + generation.capacity)) {
+        auto& entry = generation.buckets[pos % generation.capacity];
+        ptr = entry.ptr.load();
+
         // Check if this bucket marks the end of the overflow bucket - Return not-found if it is
         if (ptr == crossbow::to_underlying(EntryMarker::FREE)) {
-            return notFound;
+            return nullptr;
+        }
+        if (ptr == crossbow::to_underlying(EntryMarker::FROZEN_FREE)) {
+            frozen = true;
+            return nullptr;
+        }
+
+        // Check if pointer is marked as deleted, inserting, invalid or frozen empty - Skip bucket if it is
+        auto marker = (ptr & MARKER_MASK);
+        if (marker != crossbow::to_underlying(EntryMarker::FREE)
+                && marker != crossbow::to_underlying(EntryMarker::FROZEN)) {
+            frozen = (frozen || ptr == crossbow::to_underlying(EntryMarker::FROZEN_EMPTY));
+            ++pos;
+            continue;
         }
 
         auto t = entry.tableId.load();
@@ -331,6 +526,10 @@ T OpenAddressingTable::execOnElement(uint64_t table, uint64_t key, T notFound, F
             continue;
         }
 
+        if (marker == crossbow::to_underlying(EntryMarker::FROZEN)) {
+            frozen = true;
+        }
+
         // Check if bucket belongs to another element, skip bucket if it does
         if (t != table || k != key) {
             ++pos;
@@ -338,19 +537,177 @@ T OpenAddressingTable::execOnElement(uint64_t table, uint64_t key, T notFound, F
         }
 
         // Element found
-        return fun(entry, reinterpret_cast<const void*>(ptr));
+        return &entry;
+    }
+
+    return nullptr;
+}
+
+const void* OpenAddressingTable::getEntry(const Generation* generation, uint64_t table, uint64_t key) {
+    for (; generation != nullptr; generation = generation->next.load()) {
+        uintptr_t ptr;
+        auto frozen = false;
+        if (findEntry(*generation, table, key, ptr, frozen)) {
+            // A frozen entry without pointer was already copied to the next generation
+            if ((ptr & POINTER_MASK) != 0x0u) {
+                return reinterpret_cast<const void*>(ptr & POINTER_MASK);
+            }
+        } else if (!frozen) {
+            return nullptr;
+        }
     }
+    return nullptr;
+}
 
-    LOG_ERROR("Hash table is full");
-    return notFound;
+OpenAddressingTable::Generation* OpenAddressingTable::writableGeneration(Generation* generation, uint64_t table,
+        uint64_t key) {
+    while (auto next = generation->next.load()) {
+        migrateRange(*generation);
+        migrateOverflow(*generation, table, key);
+        generation = next;
+    }
+    return generation;
 }
 
-template <typename T, typename F>
-T OpenAddressingTable::execOnElement(uint64_t table, uint64_t key, T notFound, F fun) {
-    return const_cast<const OpenAddressingTable*>(this)->execOnElement(table, key, notFound,
-            [&fun] (const Entry& entry, const void* ptr) {
-        return fun(const_cast<Entry&>(entry), const_cast<void*>(ptr));
-    });
+void OpenAddressingTable::resize(Generation& generation) {
+    if (generation.next.load() != nullptr) {
+        return;
+    }
+
+    // Set the newly allocated generation as successor
+    // If this fails another generation was allocated in the meantime by somebody else
+    auto next = crossbow::allocator::construct<Generation>(generation.capacity * 2u);
+    Generation* expected = nullptr;
+    if (!generation.next.compare_exchange_strong(expected, next)) {
+        crossbow::allocator::destroy_now(next);
+        return;
+    }
+    LOG_DEBUG("Resizing hash table from %1% to %2% buckets (%3% elements)", generation.capacity, next->capacity,
+            generation.size.load());
+}
+
+void OpenAddressingTable::migrateRange(Generation& generation) {
+    auto start = generation.migrateOffset.fetch_add(gMigrationRangeSize);
+    if (start >= generation.capacity) {
+        return;
+    }
+
+    auto end = std::min(start + gMigrationRangeSize, generation.capacity);
+    for (auto i = start; i < end; ++i) {
+        migrateEntry(generation, generation.buckets[i]);
+    }
+
+    // Release the generation as soon as the last range was migrated
+    if (generation.migrated.fetch_add(end - start) + (end - start) == generation.capacity) {
+        releaseGenerations();
+    }
+}
+
+void OpenAddressingTable::migrateOverflow(Generation& generation, uint64_t table, uint64_t key) {
+    auto hash = calculateHash(generation, table, key);
+    for (auto pos = hash; pos < (hash + generation.capacity); ++pos) {
+        if (migrateEntry(generation, generation.buckets[pos % generation.capacity])) {
+            return;
+        }
+    }
+}
+
+bool OpenAddressingTable::migrateEntry(Generation& generation, Entry& entry) {
+    auto ptr = entry.ptr.load();
+    while (true) {
+        // Freeze the end of the overflow bucket
+        if (ptr == crossbow::to_underlying(EntryMarker::FREE)) {
+            if (entry.ptr.compare_exchange_strong(ptr, crossbow::to_underlying(EntryMarker::FROZEN_FREE))) {
+                return true;
+            }
+            continue;
+        }
+
+        // Check if the entry was already migrated
+        if (ptr == crossbow::to_underlying(EntryMarker::FROZEN_FREE)) {
+            return true;
+        }
+        if (ptr == crossbow::to_underlying(EntryMarker::FROZEN)
+                || ptr == crossbow::to_underlying(EntryMarker::FROZEN_EMPTY)) {
+            return false;
+        }
+
+        // Freeze deleted and invalid buckets
+        // The owner of an invalid entry will fail to set it to deleted afterwards, the bucket can never be reused.
+        if (ptr == crossbow::to_underlying(EntryMarker::DELETED)
+                || ptr == crossbow::to_underlying(EntryMarker::INVALID)) {
+            if (entry.ptr.compare_exchange_strong(ptr, crossbow::to_underlying(EntryMarker::FROZEN_EMPTY))) {
+                return false;
+            }
+            continue;
+        }
+
+        // Abort any concurrent insert, the inserting thread will repeat its insert in the next generation
+        auto marker = (ptr & MARKER_MASK);
+        if (marker == crossbow::to_underlying(EntryMarker::INSERTING)) {
+            if (entry.ptr.compare_exchange_strong(ptr, crossbow::to_underlying(EntryMarker::INVALID))) {
+                ptr = crossbow::to_underlying(EntryMarker::INVALID);
+            }
+            continue;
+        }
+
+        // Freeze valid entries, any concurrent update or erase will fail and be repeated in the next generation
+        if (marker == 0x0u) {
+            auto frozenPtr = (ptr | crossbow::to_underlying(EntryMarker::FROZEN));
+            if (entry.ptr.compare_exchange_strong(ptr, frozenPtr)) {
+                ptr = frozenPtr;
+            }
+            continue;
+        }
+        LOG_ASSERT(marker == crossbow::to_underlying(EntryMarker::FROZEN), "Unexpected entry marker");
+
+        // Copy the element to the next generation
+        // Table and key of a frozen entry never change. The copy is aborted as soon as the entry does not contain the
+        // frozen pointer anymore as the element was then already copied by somebody else.
+        auto t = entry.tableId.load();
+        auto k = entry.keyId.load();
+        auto data = reinterpret_cast<void*>(ptr & POINTER_MASK);
+        auto next = generation.next.load();
+        while (true) {
+            next = writableGeneration(next, t, k);
+
+            void* actualData = nullptr;
+            auto res = insertEntry(*next, t, k, data, &actualData, &entry.ptr, ptr);
+            if (res == InsertResult::SUCCESS) {
+                break;
+            }
+            if (res == InsertResult::FULL) {
+                resize(*next);
+                continue;
+            }
+
+            // Repeat the copy when it conflicted with a concurrent copy of the same element that is still in progress
+            if (res == InsertResult::CONFLICT && (actualData != nullptr || entry.ptr.load() != ptr)) {
+                break;
+            }
+        }
+
+        // Mark the entry as migrated
+        if (entry.ptr.compare_exchange_strong(ptr, crossbow::to_underlying(EntryMarker::FROZEN))) {
+            return false;
+        }
+    }
+}
+
+void OpenAddressingTable::releaseGenerations() {
+    auto generation = mGeneration.load();
+    while (generation->migrated.load() == generation->capacity) {
+        auto next = generation->next.load();
+        LOG_ASSERT(next != nullptr, "Migrated generation has no successor");
+
+        // Replace the oldest generation and free it using the epoch mechanism
+        // If this fails somebody else replaced the generation in the meantime
+        if (!mGeneration.compare_exchange_strong(generation, next)) {
+            continue;
+        }
+        crossbow::allocator::destroy(generation);
+        generation = next;
+    }
 }
 
 } // namespace store
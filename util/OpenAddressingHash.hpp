@@ -24,8 +24,12 @@
 
 #include "functional.hpp"
 
+#include <crossbow/enum_underlying.hpp>
+
 #include <atomic>
 #include <cstdint>
+#include <memory>
+#include <stdexcept>
 
 namespace tell {
 namespace store {
@@ -41,16 +45,82 @@ namespace store {
  * * Interactions with the table must be made while in an active epoch which manages all pointers
  *
  * These limitations are required to prevent certain ABA problems from arising.
+ *
+ * The hash table grows online when it exceeds a load factor of 0.75: A bucket array of twice the size is allocated as
+ * the next generation and the elements are migrated incrementally by all modifying operations. Every bucket of the old
+ * generation is frozen before its element is copied, operations encountering a frozen bucket continue in the next
+ * generation. The old generation is released through the epoch as soon as all buckets have been migrated.
  */
 class OpenAddressingTable {
+    struct Generation;
+
 public:
+    /**
+     * @brief Statistics about the occupancy of the hash table
+     */
+    struct Statistics {
+        /// Number of buckets in the hash table
+        size_t capacity;
+
+        /// Number of valid elements in the hash table
+        size_t size;
+
+        /// Ratio of valid elements to buckets
+        double loadFactor;
+
+        /// Average number of buckets probed to find an element
+        double averageProbeLength;
+
+        /// Maximum number of buckets probed to find an element
+        size_t maxProbeLength;
+    };
+
+    /**
+     * @brief Fixed bucket array of the hash table used to iterate over its elements
+     *
+     * Iterating over the view returns every element contained in the hash table at the time the view was taken even if
+     * the table is resized in the meantime. The view must only be used in the epoch it was taken in.
+     */
+    class View {
+    public:
+        size_t capacity() const {
+            return mCapacity;
+        }
+
+    private:
+        friend class OpenAddressingTable;
+
+        View(const Generation* generation, size_t capacity)
+                : mGeneration(generation),
+                  mCapacity(capacity) {
+        }
+
+        const Generation* mGeneration;
+        size_t mCapacity;
+    };
+
     OpenAddressingTable(size_t capacity);
 
     ~OpenAddressingTable();
 
-    size_t capacity() const {
-        return mCapacity;
-    }
+    /**
+     * @brief Number of buckets in the newest generation of the hash table
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Collects statistics about the newest generation of the hash table
+     *
+     * Iterates over every bucket of the table. Elements not yet migrated by a resize in progress are not included.
+     */
+    Statistics statistics() const;
+
+    /**
+     * @brief Takes a view on the hash table for iteration
+     *
+     * Completes any resize in progress so all elements are contained in the bucket array of the view.
+     */
+    View view();
 
     /**
      * @brief Looks up the element in the hash table
@@ -73,25 +143,35 @@ public:
     const void* get(uint64_t table, uint64_t key) const;
 
     /**
-     * @brief Invokes the provided function for every valid tuple in the range between start and end bucket
+     * @brief Issues a prefetch for the start bucket of the element without waiting for it
      *
+     * @param table The table ID of the entry
+     * @param key The key ID of the entry
+     */
+    void prefetch(uint64_t table, uint64_t key) const;
+
+    /**
+     * @brief Invokes the provided function for every valid tuple in the range between start and end bucket of the view
+     *
+     * @param view The view to iterate over
      * @param start Offset to the start bucket
      * @param end Offset to the end bucket (end bucket will not be included)
      */
     template <typename F>
-    void forEach(size_t start, size_t end, F fun) {
-        forEachImpl<F, void*>(start, end, std::move(fun));
+    void forEach(const View& view, size_t start, size_t end, F fun) {
+        forEachImpl<F, void*>(*view.mGeneration, start, end, std::move(fun));
     }
 
     /**
-     * @brief Invokes the provided function for every valid tuple in the range between start and end bucket
+     * @brief Invokes the provided function for every valid tuple in the range between start and end bucket of the view
      *
+     * @param view The view to iterate over
      * @param start Offset to the start bucket
      * @param end Offset to the end bucket (end bucket will not be included)
      */
     template <typename F>
-    void forEach(size_t start, size_t end, F fun) const {
-        forEachImpl<F, const void*>(start, end, std::move(fun));
+    void forEach(const View& view, size_t start, size_t end, F fun) const {
+        forEachImpl<F, const void*>(*view.mGeneration, start, end, std::move(fun));
     }
 
     /**
@@ -146,6 +226,36 @@ private:
         std::atomic<uintptr_t> ptr;
     };
 
+    /**
+     * @brief Bucket array of the hash table
+     */
+    struct Generation {
+        Generation(size_t capacity);
+
+        /// Number of buckets in the generation
+        const size_t capacity;
+
+        /// Number of elements after which the generation is resized (Set to 0.75 of the capacity)
+        const size_t maximumSize;
+
+        std::unique_ptr<Entry[]> buckets;
+
+        cuckoo_hash_function tableHash;
+        cuckoo_hash_function keyHash;
+
+        /// Number of valid elements in the generation
+        std::atomic<size_t> size;
+
+        /// Generation the elements are migrated to or null if the generation is not being resized
+        std::atomic<Generation*> next;
+
+        /// Offset of the next range of buckets to be migrated
+        std::atomic<size_t> migrateOffset;
+
+        /// Number of buckets whose migration has completed
+        std::atomic<size_t> migrated;
+    };
+
     /**
      * @brief The potential states a Entry pointer can be tagged with
      */
@@ -161,6 +271,32 @@ private:
 
         /// Data is currently written to the entry
         INSERTING = (0x1u << 2),
+
+        /// The entry was frozen by a resize: Still has to be copied to the next generation if the pointer is set, was
+        /// already copied otherwise (table and key stay valid)
+        FROZEN = (DELETED | INVALID),
+
+        /// The entry was deleted or invalid when it was frozen by a resize (actual pointer will be null)
+        FROZEN_EMPTY = (DELETED | INSERTING),
+
+        /// The entry was free when it was frozen by a resize (actual pointer will be null)
+        FROZEN_FREE = (DELETED | INVALID | INSERTING),
+    };
+
+    /**
+     * @brief Outcome of an insert into a single generation
+     */
+    enum class InsertResult {
+        SUCCESS,
+
+        /// The element already exists or a concurrent insert of the same element took place
+        CONFLICT,
+
+        /// The generation is being resized and the insert has to be repeated in the next generation
+        RETRY,
+
+        /// The generation has no free bucket left
+        FULL,
     };
 
     /**
@@ -174,7 +310,12 @@ private:
     static constexpr uintptr_t MARKER_MASK = ~POINTER_MASK;
 
     /**
-     * @brief Helper function to erase the entries data and set the entry to deleted
+     * @brief Whether the marked Entry pointer belongs to a bucket frozen by a resize
+     */
+    static bool isFrozen(uintptr_t ptr);
+
+    /**
+     * @brief Helper function to erase the entries data and set the entry from invalid to deleted
      */
     static void deleteEntry(Entry& entry);
 
@@ -188,16 +329,17 @@ private:
     static void setActualData(uint64_t table, uint64_t key, void** actualData, const Entry& entry, uintptr_t ptr);
 
     /**
-     * @brief Calculates a 64 bit hash from the table and key ID
+     * @brief Calculates the start bucket of the table and key ID in the given generation
      *
      * Hashes both table and key independently using the Cuckoo hash function and combines the two resulting hashes into
      * one.
      *
+     * @param generation The generation to calculate the bucket for
      * @param table The table ID of the entry
      * @param key The key ID of the entry
-     * @return The 64 bit hash of both table and key
+     * @return The offset to the first bucket of the overflow bucket of table and key
      */
-    uint64_t calculateHash(uint64_t table, uint64_t key) const;
+    static size_t calculateHash(const Generation& generation, uint64_t table, uint64_t key);
 
     /**
      * @brief Checks for any conflicting inserts happening on the same table and key
@@ -205,60 +347,116 @@ private:
      * Scans the overflow buffer and tries to abort any concurrent inserts that are trying to insert in a bucket
      * following the current bucket.
      *
-     * @param hash The hash value of table and key
+     * @param generation The generation the element is inserted in
+     * @param hash The start bucket of table and key
      * @param pos The position the current element will be inserted
      * @param table The table ID of the entry
      * @param key The key ID of the entry
      * @param actualData Pointer to the element which caused the conflict
-     * @return Whether other inserts conflict with the current one
+     * @return Success if no other insert conflicts with the current one, retry if the generation is being resized
+     */
+    static InsertResult hasInsertConflict(Generation& generation, size_t hash, size_t pos, uint64_t table,
+            uint64_t key, void** actualData);
+
+    /**
+     * @brief Tries to insert the element into the given generation
+     *
+     * If a source entry is given the element is only inserted as long as the source still contains the expected
+     * pointer. This prevents a migration from copying an element again that was already copied and erased afterwards.
+     *
+     * @param generation The generation to insert the element in
+     * @param table The table ID of the entry
+     * @param key The key ID of the entry
+     * @param data The new data pointer
+     * @param actualData Pointer to the element which caused the conflict
+     * @param source Entry the element is copied from or null
+     * @param sourcePtr The expected pointer of the source entry
      */
-    bool hasInsertConflict(size_t hash, size_t pos, uint64_t table, uint64_t key, void** actualData);
+    static InsertResult insertEntry(Generation& generation, uint64_t table, uint64_t key, void* data,
+            void** actualData, const std::atomic<uintptr_t>* source, uintptr_t sourcePtr);
 
     /**
-     * @brief Searches the hash table for the element with table and key and executes the function on the element
+     * @brief Searches the generation for the element with table and key
+     *
+     * Skips over buckets frozen by a resize but records their occurrence.
      *
+     * @param generation The generation to search
      * @param table The table ID of the entry
      * @param key The key ID of the entry
-     * @param notFound The value to return when the element was not found
-     * @param fun The function to be executed on the target element, interface must match T fun(Entry&, void* ptr)
-     * @return The return value of fun or notFound if the element was not found
+     * @param ptr The marked pointer of the entry when it was found
+     * @param frozen Set to true when a frozen bucket was encountered
+     * @return The entry of the element (either valid or frozen) or null if the element was not found
      */
-    template <typename T, typename F>
-    T execOnElement(uint64_t table, uint64_t key, T notFound, F fun) const;
+    static Entry* findEntry(const Generation& generation, uint64_t table, uint64_t key, uintptr_t& ptr, bool& frozen);
 
-    template <typename T, typename F>
-    T execOnElement(uint64_t table, uint64_t key, T notFound, F fun);
+    /**
+     * @brief Looks up the element in the given and all following generations
+     */
+    static const void* getEntry(const Generation* generation, uint64_t table, uint64_t key);
+
+    /**
+     * @brief Returns the generation modifications of the element with table and key have to be applied to
+     *
+     * Migrates the overflow bucket of table and key in every generation being resized and helps with migrating the
+     * remaining buckets.
+     */
+    Generation* writableGeneration(Generation* generation, uint64_t table, uint64_t key);
+
+    /**
+     * @brief Allocates the next generation of twice the size if the generation is not already being resized
+     */
+    void resize(Generation& generation);
+
+    /**
+     * @brief Migrates the next range of buckets of the generation
+     */
+    void migrateRange(Generation& generation);
+
+    /**
+     * @brief Migrates every bucket in the overflow bucket of table and key
+     */
+    void migrateOverflow(Generation& generation, uint64_t table, uint64_t key);
+
+    /**
+     * @brief Freezes the bucket and copies its element to the next generation
+     *
+     * @return Whether the bucket was free (i.e. marks the end of an overflow bucket)
+     */
+    bool migrateEntry(Generation& generation, Entry& entry);
+
+    /**
+     * @brief Replaces the oldest generation with its successors as long as they were migrated completely
+     */
+    void releaseGenerations();
 
     /**
      * @brief Invokes the provided function for every valid tuple in the range between start and end bucket
      *
+     * @param generation The generation to iterate over
      * @param start Offset to the start bucket
      * @param end Offset to the end bucket (end bucket will not be included)
      */
     template <typename F, typename T>
-    void forEachImpl(size_t start, size_t end, F fun) const;
+    void forEachImpl(const Generation& generation, size_t start, size_t end, F fun) const;
 
-    size_t mCapacity;
-
-    Entry* mBuckets;
-
-    cuckoo_hash_function mTableHash;
-    cuckoo_hash_function mKeyHash;
+    /// The oldest generation still in use
+    std::atomic<Generation*> mGeneration;
 };
 
 template <typename F, typename T>
-void OpenAddressingTable::forEachImpl(size_t start, size_t end, F fun) const {
-    if (start > end || end > mCapacity) {
+void OpenAddressingTable::forEachImpl(const Generation& generation, size_t start, size_t end, F fun) const {
+    if (start > end || end > generation.capacity) {
         throw std::out_of_range("Invalid for-each bounds");
     }
 
-    auto entryIt = mBuckets + start;
-    auto entryEnd = mBuckets + end;
+    auto entryIt = generation.buckets.get() + start;
+    auto entryEnd = generation.buckets.get() + end;
     while (entryIt != entryEnd) {
         auto ptr = entryIt->ptr.load();
+        auto marker = (ptr & MARKER_MASK);
 
-        // Check if pointer is marked as free, deleted, inserting or invalid - Skip bucket if it is
-        if (ptr == 0x0u || (ptr & MARKER_MASK) != 0x0u) {
+        // Check if pointer is marked as free, deleted, inserting, invalid or frozen empty - Skip bucket if it is
+        if (ptr == 0x0u || (marker != 0x0u && marker != crossbow::to_underlying(EntryMarker::FROZEN))) {
             ++entryIt;
             continue;
         }
@@ -274,7 +472,13 @@ void OpenAddressingTable::forEachImpl(size_t start, size_t end, F fun) const {
             continue;
         }
 
-        fun(t, k, reinterpret_cast<T>(ptr & POINTER_MASK));
+        if ((ptr & POINTER_MASK) != 0x0u) {
+            fun(t, k, reinterpret_cast<T>(ptr & POINTER_MASK));
+        } else if (auto data = getEntry(generation.next.load(), t, k)) {
+            // The element was already copied to the next generation by a resize
+            T element = const_cast<void*>(data);
+            fun(t, k, element);
+        }
         ++entryIt;
     }
 }
@@ -22,72 +22,279 @@
  */
 
 #include "PageManager.hpp"
+#include "Numa.hpp"
 
 #include <crossbow/logger.hpp>
 
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <new>
 
+#include <pthread.h>
+#include <sched.h>
 #include <sys/mman.h>
 #include <memory.h>
 
 namespace tell {
 namespace store {
+namespace {
 
-PageManager::PageManager(size_t size)
-    : mData(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, 0, 0)),
+/**
+ * @brief Number of zeroed pages backed by physical memory the zeroing thread keeps in every pool
+ *
+ * Once a pool holds this many resident pages, further dirty pages are released to the kernel with madvise instead of
+ * being overwritten, the kernel maps them to a zero page again on their next access.
+ */
+constexpr size_t gResidentCleanPages = 64;
+
+/**
+ * @brief Interval in milliseconds in which the zeroing thread checks for dirty pages
+ */
+constexpr int64_t gZeroInterval = 10;
+
+/**
+ * @brief Time in seconds the free pages have to stay above the high watermark before all resident free pages are
+ * released
+ */
+constexpr int64_t gReleaseDelay = 10;
+
+/**
+ * @brief Size of a huge page on the target architecture
+ */
+constexpr size_t gHugePageSize = 0x200000u;
+
+} // anonymous namespace
+
+PageManager::PageManager(size_t size, HugePageMode hugePages, size_t numaNodes)
+    : mMapping(MAP_FAILED),
+      mMappingSize(size),
+      mData(nullptr),
       mSize(size),
-      mPages(size / TELL_PAGE_SIZE, nullptr)
+      mHugePages(hugePages),
+      mNodePages(0u),
+      mFreePages(size / TELL_PAGE_SIZE),
+      mLowWatermark(std::max(size / TELL_PAGE_SIZE / 16, size_t(1u))),
+      mShutdown(false)
 {
-    if (mData == MAP_FAILED) {
-        throw std::bad_alloc();
-    }
     LOG_ASSERT(mSize % TELL_PAGE_SIZE == 0, "Size must divide the page size");
+    if (mHugePages != HugePageMode::NONE && TELL_PAGE_SIZE % gHugePageSize != 0) {
+        LOG_WARN("Page size is not a multiple of the huge page size - Huge pages disabled");
+        mHugePages = HugePageMode::NONE;
+    }
+
+    if (mHugePages == HugePageMode::EXPLICIT) {
+        mMapping = mmap(nullptr, mMappingSize, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
+        if (mMapping == MAP_FAILED) {
+            LOG_WARN("Unable to map memory from the huge page pool - Falling back to transparent huge pages");
+            mHugePages = HugePageMode::TRANSPARENT;
+        } else {
+            mData = mMapping;
+        }
+    }
+
+    if (mHugePages == HugePageMode::TRANSPARENT) {
+        // Over-allocate by one huge page so the page region can be aligned to the huge page size
+        mMappingSize = mSize + gHugePageSize;
+        mMapping = mmap(nullptr, mMappingSize, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+        if (mMapping == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        auto offset = reinterpret_cast<uintptr_t>(mMapping) % gHugePageSize;
+        mData = reinterpret_cast<char*>(mMapping) + (offset == 0 ? 0 : gHugePageSize - offset);
+        if (madvise(mData, mSize, MADV_HUGEPAGE) != 0) {
+            LOG_WARN("Transparent huge pages not available - Falling back to regular pages");
+            mHugePages = HugePageMode::NONE;
+        }
+    }
+
+    if (mMapping == MAP_FAILED) {
+        mMapping = mmap(nullptr, mMappingSize, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+        if (mMapping == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        mData = mMapping;
+    }
+
+    // Partition the region among the NUMA nodes - The memory is not touched yet so the policy applies to all pages
     auto numPages = mSize / TELL_PAGE_SIZE;
-    memset(mData, 0, mSize);
-    auto data = reinterpret_cast<char*>(mData);
-    data += mSize - TELL_PAGE_SIZE; // data does now point to the last page
-    for (decltype(numPages) i = 0ul; i < numPages; ++i) {
-        __attribute__((unused)) auto res = mPages.push(data);
-        LOG_ASSERT(res, "Pusing page did not succeed");
-        data -= TELL_PAGE_SIZE;
+    auto numNodes = std::max(std::min(numaNodes == 0u ? numaNodeCount() : numaNodes, numPages), size_t(1u));
+    mNodePages = (numPages + numNodes - 1) / numNodes;
+    mPools.reserve(numNodes);
+    for (decltype(numNodes) node = 0; node < numNodes; ++node) {
+        auto begin = std::min(node * mNodePages, numPages);
+        auto end = (node + 1 == numNodes ? numPages : std::min(begin + mNodePages, numPages));
+        mPools.emplace_back(new NodePool(end - begin));
+        if (numNodes > 1 && end > begin && !numaBindMemory(reinterpret_cast<char*>(mData) + begin * TELL_PAGE_SIZE,
+                (end - begin) * TELL_PAGE_SIZE, node)) {
+            LOG_WARN("Unable to bind memory to NUMA node %1%", node);
+        }
+
+        // Anonymous memory is already zeroed - All pages start out clean
+        auto& pool = *mPools.back();
+        for (auto i = end; i > begin; --i) {
+            __attribute__((unused)) auto res = pool.cleanPages.push(reinterpret_cast<char*>(mData)
+                    + (i - 1) * TELL_PAGE_SIZE);
+            LOG_ASSERT(res, "Pusing page did not succeed");
+        }
+        LOG_ASSERT(pool.cleanPages.size() == end - begin, "Not all pages were added to the stack");
     }
-    LOG_ASSERT(mPages.size() == numPages, "Not all pages were added to the stack");
+    LOG_INFO("Page manager allocated [size = %1%, hugePages = %2%, numaNodes = %3%]", mSize,
+            hugePageModeName(mHugePages), numNodes);
+
+    mZeroThread = std::thread(&PageManager::zeroThread, this);
 }
 
 PageManager::~PageManager() {
+    {
+        std::unique_lock<decltype(mZeroMutex)> _(mZeroMutex);
+        mShutdown.store(true);
+    }
+    mZeroCondition.notify_one();
+    mZeroThread.join();
+
     // TODO Fix this behavior
     // Wait for all pages to be released
     // This is required as the epoch might delete the PageManager while a previous epoch is being deleted (with a
     // reference to this page manager).
-    while (mPages.capacity() != mPages.size());
-    munmap(mData, mSize);
+    while (mFreePages.load() != mSize / TELL_PAGE_SIZE);
+    munmap(mMapping, mMappingSize);
 }
 
 void* PageManager::alloc() {
+    auto node = numaCurrentNode() % mPools.size();
     void* page;
-    auto success = mPages.pop(page);
-    LOG_ASSERT(!success || (page != nullptr), "Successful pop must not return null pages");
-    LOG_ASSERT(!success || (page >= mData && page < reinterpret_cast<char*>(mData) + mSize), "Page points out of bound");
-    LOG_ASSERT(!success || (reinterpret_cast<char*>(page) - reinterpret_cast<char*>(mData)) % TELL_PAGE_SIZE == 0,
-            "Pointer points not to beginning of page");
-    if (!success) {
-        return nullptr;
+    for (decltype(mPools.size()) i = 0; i < mPools.size(); ++i) {
+        auto& pool = *mPools[(node + i) % mPools.size()];
+        if (pool.residentPages.pop(page) || pool.cleanPages.pop(page)) {
+            checkPage(page);
+            pageTaken(true);
+            return page;
+        }
     }
-    memset(page, 0, TELL_PAGE_SIZE);
-    return page;
+
+    // No clean page available - Zero a dirty page ourselves
+    for (decltype(mPools.size()) i = 0; i < mPools.size(); ++i) {
+        if (mPools[(node + i) % mPools.size()]->dirtyPages.pop(page)) {
+            checkPage(page);
+            pageTaken(true);
+            memset(page, 0, TELL_PAGE_SIZE);
+            return page;
+        }
+    }
+    pageTaken(false);
+    return nullptr;
+}
+
+void* PageManager::allocUninitialized() {
+    auto node = numaCurrentNode() % mPools.size();
+    void* page;
+    for (decltype(mPools.size()) i = 0; i < mPools.size(); ++i) {
+        auto& pool = *mPools[(node + i) % mPools.size()];
+        if (pool.dirtyPages.pop(page) || pool.residentPages.pop(page) || pool.cleanPages.pop(page)) {
+            checkPage(page);
+            pageTaken(true);
+            return page;
+        }
+    }
+    pageTaken(false);
+    return nullptr;
 }
 
 void PageManager::free(void* page) {
     LOG_ASSERT(page != nullptr, "Page must not be null");
-    LOG_ASSERT(page >= mData && page < reinterpret_cast<char*>(mData) + mSize, "Page points out of bound");
-    LOG_ASSERT((reinterpret_cast<char*>(page) - reinterpret_cast<char*>(mData)) % TELL_PAGE_SIZE == 0,
-            "Pointer points not to beginning of page");
-    freeEmpty(page);
+    checkPage(page);
+    auto& pool = *mPools[numaNode(page)];
+    while (!pool.dirtyPages.push(page));
+    pageReturned();
 }
 
 void PageManager::freeEmpty(void* page) {
-    while (!mPages.push(page));
+    auto& pool = *mPools[numaNode(page)];
+    while (!pool.residentPages.push(page));
+    pageReturned();
+}
+
+void PageManager::zeroThread() {
+    // Zeroing pages must not take any CPU time from the request processing
+    struct sched_param param;
+    param.sched_priority = 0;
+    if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0) {
+        LOG_WARN("Unable to lower the priority of the page zeroing thread");
+    }
+
+    auto highWatermark = mSize / TELL_PAGE_SIZE / 2;
+    auto highSince = std::chrono::steady_clock::now();
+    auto released = false;
+
+    std::unique_lock<decltype(mZeroMutex)> lock(mZeroMutex);
+    while (!mShutdown.load()) {
+        // Release the resident free pages once the free pages stayed above the high watermark for a sustained period
+        auto now = std::chrono::steady_clock::now();
+        if (mFreePages.load() <= highWatermark) {
+            highSince = now;
+            released = false;
+        } else if (!released && now - highSince >= std::chrono::seconds(gReleaseDelay)) {
+            releaseCleanPages();
+            released = true;
+        }
+
+        auto zeroed = false;
+        for (auto& pool : mPools) {
+            void* page;
+            if (!pool->dirtyPages.pop(page)) {
+                continue;
+            }
+            zeroed = true;
+
+            if (pool->residentPages.size() < gResidentCleanPages
+                    || madvise(page, TELL_PAGE_SIZE, MADV_DONTNEED) != 0) {
+                memset(page, 0, TELL_PAGE_SIZE);
+                while (!pool->residentPages.push(page));
+            } else {
+                while (!pool->cleanPages.push(page));
+            }
+        }
+
+        if (!zeroed) {
+            mZeroCondition.wait_for(lock, std::chrono::milliseconds(gZeroInterval));
+        }
+    }
+}
+
+void PageManager::releaseCleanPages() {
+    for (auto& pool : mPools) {
+        void* page;
+        while (pool->residentPages.pop(page)) {
+            madvise(page, TELL_PAGE_SIZE, MADV_DONTNEED);
+            while (!pool->cleanPages.push(page));
+        }
+    }
+    LOG_DEBUG("Released resident free pages to the operating system");
+}
+
+void PageManager::pageTaken(bool success) {
+    size_t previous = 0u;
+    if (success) {
+        previous = mFreePages.fetch_sub(1u);
+    }
+
+    // Only notify once when crossing the watermark (or on every failed allocation)
+    if (success && previous != mLowWatermark) {
+        return;
+    }
+
+    std::unique_lock<decltype(mPressureMutex)> _(mPressureMutex);
+    if (mPressureCallback) {
+        mPressureCallback();
+    }
+}
+
+void PageManager::checkPage(__attribute__((unused)) void* page) const {
+    LOG_ASSERT(page != nullptr, "Successful pop must not return null pages");
+    LOG_ASSERT(page >= mData && page < reinterpret_cast<const char*>(mData) + mSize, "Page points out of bound");
+    LOG_ASSERT((reinterpret_cast<const char*>(page) - reinterpret_cast<const char*>(mData)) % TELL_PAGE_SIZE == 0,
+            "Pointer points not to beginning of page");
 }
 
 } // namespace store
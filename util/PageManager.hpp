@@ -23,13 +23,21 @@
 #pragma once
 
 #include <config.h>
+#include "StorageConfig.hpp"
 
 #include <crossbow/allocator.hpp>
 #include <crossbow/fixed_size_stack.hpp>
 #include <crossbow/non_copyable.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace tell {
 namespace store {
@@ -47,12 +55,89 @@ struct PageManagerDeleter {
 * allocated. It keeps an internal list of
 * free pages. All page allocations need to
 * be made through this class.
+*
+* Free pages are kept in two pools: Clean pages are known to be zeroed while dirty pages still contain the data of their
+* previous user. Released pages are zeroed by a low priority background thread and moved to the clean pool so that
+* allocations do not have to zero the page on the hot path.
+*
+* On NUMA systems the memory region is split into one contiguous partition per node, the physical memory of every
+* partition is placed on its node. Every node has its own pools and allocations prefer pages from the node the calling
+* thread is running on.
+*
+* The size of the page manager is only an upper limit: The region is reserved without committing memory and physical
+* memory is only committed when a page is touched. Free pages are returned to the operating system by the zeroing
+* thread, the remaining resident free pages are released as well when the number of free pages stays high for a
+* sustained period. A pressure callback is invoked whenever the number of free pages drops below a low watermark.
 */
 class PageManager: crossbow::non_copyable, crossbow::non_movable {
 private:
+    /**
+     * @brief Free pages of a single NUMA node
+     */
+    struct NodePool {
+        NodePool(size_t capacity)
+                : residentPages(capacity, nullptr),
+                  cleanPages(capacity, nullptr),
+                  dirtyPages(capacity, nullptr) {
+        }
+
+        /// Free pages that are zeroed and backed by physical memory
+        crossbow::fixed_size_stack<void*> residentPages;
+
+        /// Free pages that are zeroed and not backed by physical memory (never touched or released to the kernel)
+        crossbow::fixed_size_stack<void*> cleanPages;
+
+        /// Free pages that still have to be zeroed
+        crossbow::fixed_size_stack<void*> dirtyPages;
+    };
+
+    /// Start and size of the mapped memory region (the page region might be aligned within the mapping)
+    void* mMapping;
+    size_t mMappingSize;
+
     void* mData;
     size_t mSize;
-    crossbow::fixed_size_stack<void*> mPages;
+
+    /// Type of pages actually backing the memory region
+    HugePageMode mHugePages;
+
+    /// Number of pages in the partition of every NUMA node (the last node might hold fewer pages)
+    size_t mNodePages;
+
+    std::vector<std::unique_ptr<NodePool>> mPools;
+
+    /// Number of free pages in all pools
+    std::atomic<size_t> mFreePages;
+
+    /// Number of free pages below which the pressure callback is invoked
+    size_t mLowWatermark;
+
+    std::mutex mPressureMutex;
+    std::function<void()> mPressureCallback;
+
+    std::atomic<bool> mShutdown;
+    std::mutex mZeroMutex;
+    std::condition_variable mZeroCondition;
+    std::thread mZeroThread;
+
+    void zeroThread();
+
+    /**
+     * @brief Checks that the page is a valid page of this page manager
+     */
+    void checkPage(void* page) const;
+
+    /**
+     * @brief Accounts for a page taken from the pools and invokes the pressure callback if required
+     */
+    void pageTaken(bool success);
+
+    /**
+     * @brief Accounts for a page returned to the pools
+     */
+    void pageReturned() {
+        ++mFreePages;
+    }
 public:
     using Ptr = std::unique_ptr<PageManager, PageManagerDeleter>;
 
@@ -61,20 +146,29 @@ public:
      *
      * The resulting page manager is allocated and destroyed within the epoch.
      */
-    static PageManager::Ptr construct(size_t size) {
-        return PageManager::Ptr(crossbow::allocator::construct<PageManager>(size));
+    static PageManager::Ptr construct(size_t size, HugePageMode hugePages = HugePageMode::NONE,
+            size_t numaNodes = 0u) {
+        return PageManager::Ptr(crossbow::allocator::construct<PageManager>(size, hugePages, numaNodes));
     }
 
     /**
     * This class must not instantiated more than once!
     *
-    * The constructor will allocate #size number
-    * of bytes. At the moment, growing and shrinking is
-    * not supported. This might be implemented later.
+    * The constructor will reserve #size number
+    * of bytes of address space.
+    *
+    * The memory is mapped as anonymous memory that is zeroed by the kernel on first access, the pages are not touched
+    * before they are used.
+    *
+    * The region is backed by the requested type of huge pages if available, otherwise the page manager falls back to
+    * transparent huge pages and then to regular pages.
+    *
+    * The region is partitioned among the given number of NUMA nodes (at most one node per page), 0 uses all nodes of
+    * the system.
     *
     * \pre {#size has to be a multiplication of #PAGE_SIZE}
     */
-    PageManager(size_t size);
+    PageManager(size_t size, HugePageMode hugePages = HugePageMode::NONE, size_t numaNodes = 0u);
 
     ~PageManager();
 
@@ -90,15 +184,76 @@ public:
         return mSize;
     }
 
+    /**
+     * @brief Type of pages actually backing the memory region
+     */
+    HugePageMode hugePages() const {
+        return mHugePages;
+    }
+
+    /**
+     * @brief Number of pages currently not allocated
+     */
+    size_t freePages() const {
+        return mFreePages.load();
+    }
+
+    /**
+     * @brief Number of free pages below which the pressure callback is invoked
+     */
+    size_t lowWatermark() const {
+        return mLowWatermark;
+    }
+
+    /**
+     * @brief Sets the function invoked when the page manager runs low on free pages
+     *
+     * The callback is invoked by the allocating thread and must not block. Pass an empty function to remove the
+     * callback.
+     */
+    void setPressureCallback(std::function<void()> callback) {
+        std::unique_lock<decltype(mPressureMutex)> _(mPressureMutex);
+        mPressureCallback = std::move(callback);
+    }
+
+    /**
+     * @brief Number of NUMA nodes the memory region is partitioned into
+     */
+    size_t numaNodes() const {
+        return mPools.size();
+    }
+
+    /**
+     * @brief NUMA node the physical memory of the given page is located on
+     */
+    size_t numaNode(const void* page) const {
+        auto idx = static_cast<size_t>(reinterpret_cast<const char*>(page) - reinterpret_cast<const char*>(mData))
+                / TELL_PAGE_SIZE;
+        return std::min(idx / mNodePages, mPools.size() - 1);
+    }
+
     /**
     * Allocates a new page. It is safe to call this method
     * concurrently. It will return nullptr, if there is no
     * space left.
+    *
+    * The returned page is zeroed. Pages from the NUMA node of the calling thread are preferred.
     */
     void* alloc();
 
+    /**
+    * Allocates a new page without zeroing it. It is safe to
+    * call this method concurrently. It will return nullptr,
+    * if there is no space left.
+    *
+    * Only to be used by callers that overwrite the complete page.
+    */
+    void* allocUninitialized();
+
     /**
     * Returns the given page back to the pool
+    *
+    * The page is zeroed in the background.
     */
     void free(void* page);
 
@@ -106,6 +261,14 @@ public:
     * Returns the given (already zeroed) page back to the pool
     */
     void freeEmpty(void* page);
+
+    /**
+     * @brief Releases the physical memory of the resident clean pages in all pools
+     *
+     * Invoked by the zeroing thread once the number of free pages stayed high for a sustained period. It is safe to
+     * call this method concurrently.
+     */
+    void releaseCleanPages();
 };
 
 } // namespace store
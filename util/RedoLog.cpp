@@ -0,0 +1,291 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include "RedoLog.hpp"
+
+#include <crossbow/allocator.hpp>
+#include <crossbow/enum_underlying.hpp>
+#include <crossbow/logger.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tell {
+namespace store {
+namespace {
+
+/**
+ * @brief Writes the complete buffer to the file
+ */
+void writeAll(int fd, const char* data, size_t length) {
+    while (length != 0u) {
+        auto res = ::write(fd, data, length);
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::system_category());
+        }
+        data += res;
+        length -= static_cast<size_t>(res);
+    }
+}
+
+} // anonymous namespace
+
+RedoLog::RedoLog(PageManager& pageManager, const crossbow::string& path, uint32_t syncInterval)
+        : mLog(pageManager),
+          mSyncInterval(syncInterval),
+          mFd(::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR | S_IRGRP)),
+          mFileSize(0u),
+          mReserved(0u),
+          mSealed(0u),
+          mShutdown(false) {
+    if (mFd < 0) {
+        throw std::system_error(errno, std::system_category());
+    }
+
+    struct stat fileStat;
+    if (::fstat(mFd, &fileStat) != 0) {
+        auto error = errno;
+        ::close(mFd);
+        throw std::system_error(error, std::system_category());
+    }
+    mFileSize = static_cast<uint64_t>(fileStat.st_size);
+    mSyncThread = std::thread(&RedoLog::syncThread, this);
+}
+
+RedoLog::~RedoLog() {
+    {
+        std::unique_lock<decltype(mSyncMutex)> _(mSyncMutex);
+        mShutdown.store(true);
+    }
+    mSyncCondition.notify_one();
+    mSyncThread.join();
+
+    try {
+        sync();
+    } catch (std::system_error& e) {
+        LOG_ERROR("Error while syncing redo log [error = %1%]", e.what());
+    }
+    ::close(mFd);
+}
+
+RedoLogEntry* RedoLog::reserve(const RedoRecord& record) {
+    ++mReserved;
+    auto entry = mLog.append(sizeof(RedoLogEntry) + record.size, crossbow::to_underlying(record.type));
+    if (!entry) {
+        ++mSealed;
+        LOG_ERROR("Failed to reserve space in redo log");
+        return nullptr;
+    }
+    return reinterpret_cast<RedoLogEntry*>(entry->data());
+}
+
+size_t RedoLog::reserve(const RedoRecord* records, size_t count, RedoLogEntry** entries) {
+    std::vector<uint32_t> sizes;
+    std::vector<uint32_t> types;
+    sizes.reserve(count);
+    types.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        sizes.emplace_back(sizeof(RedoLogEntry) + records[i].size);
+        types.emplace_back(crossbow::to_underlying(records[i].type));
+    }
+
+    mReserved += count;
+    std::vector<LogEntry*> logEntries(count, nullptr);
+    auto reserved = mLog.append(sizes.data(), types.data(), count, logEntries.data());
+    for (size_t i = 0; i < reserved; ++i) {
+        entries[i] = reinterpret_cast<RedoLogEntry*>(logEntries[i]->data());
+    }
+
+    if (reserved != count) {
+        mSealed += count - reserved;
+        LOG_ERROR("Failed to reserve space in redo log");
+    }
+    return reserved;
+}
+
+void RedoLog::complete(RedoLogEntry* entry, const RedoRecord& record) {
+    auto redoEntry = new (entry) RedoLogEntry(record.tableId, record.key, record.version);
+    if (record.size != 0u) {
+        memcpy(redoEntry->data(), record.data, record.size);
+    }
+    seal(entry);
+}
+
+void RedoLog::cancel(RedoLogEntry* entry) {
+    new (entry) RedoLogEntry(RedoLogEntry::CANCELLED_TABLE_ID, 0x0u, 0x0u);
+    seal(entry);
+}
+
+bool RedoLog::append(RedoRecordType type, uint64_t tableId, uint64_t key, uint64_t version, const char* data,
+        uint32_t size) {
+    RedoRecord record(type, tableId, key, version, data, size);
+    auto entry = reserve(record);
+    if (!entry) {
+        return false;
+    }
+    complete(entry, record);
+    return true;
+}
+
+size_t RedoLog::append(const RedoRecord* records, size_t count) {
+    std::vector<RedoLogEntry*> entries(count, nullptr);
+    auto appended = reserve(records, count, entries.data());
+    for (size_t i = 0; i < appended; ++i) {
+        complete(entries[i], records[i]);
+    }
+    return appended;
+}
+
+uint64_t RedoLog::sync() {
+    // Records are only written up to the first unsealed record so wait for all records reserved so far
+    auto reserved = mReserved.load();
+    while (mSealed.load() < reserved) {
+        std::this_thread::yield();
+    }
+
+    std::unique_lock<decltype(mFlushMutex)> _(mFlushMutex);
+    flush();
+    if (::fdatasync(mFd) != 0) {
+        throw std::system_error(errno, std::system_category());
+    }
+    return mFileSize;
+}
+
+void RedoLog::discard(uint64_t offset) {
+    if (offset == 0u) {
+        return;
+    }
+
+    if (::fallocate(mFd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(offset)) != 0) {
+        // The records are skipped during replay anyway, failing to release their space is not an error
+        LOG_WARN("Unable to release space of discarded redo log records [error = %1%]", strerror(errno));
+    }
+}
+
+void RedoLog::truncate() {
+    std::unique_lock<decltype(mFlushMutex)> _(mFlushMutex);
+    crossbow::allocator __;
+    __attribute__((unused)) auto res = mLog.truncateLog(mLog.begin(), mLog.sealedEnd());
+    LOG_ASSERT(res, "Truncating the redo log failed");
+
+    if (::ftruncate(mFd, 0) != 0 || ::fdatasync(mFd) != 0) {
+        throw std::system_error(errno, std::system_category());
+    }
+    mFileSize = 0u;
+}
+
+std::unique_ptr<char[]> RedoLog::readFile(const crossbow::string& path, uint64_t offset, size_t& size) {
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            size = 0u;
+            return nullptr;
+        }
+        throw std::system_error(errno, std::system_category());
+    }
+
+    struct stat fileStat;
+    if (::fstat(fd, &fileStat) != 0) {
+        auto error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::system_category());
+    }
+    auto fileSize = static_cast<uint64_t>(fileStat.st_size);
+    size = static_cast<size_t>(fileSize > offset ? fileSize - offset : 0u);
+
+    std::unique_ptr<char[]> data(new char[size]);
+    size_t position = 0u;
+    while (position < size) {
+        auto res = ::pread(fd, data.get() + position, size - position, static_cast<off_t>(offset + position));
+        if (res < 0 && errno == EINTR) {
+            continue;
+        }
+        if (res <= 0) {
+            // A short read only happens if the file was truncated in the meantime
+            break;
+        }
+        position += static_cast<size_t>(res);
+    }
+    size = position;
+    ::close(fd);
+    return data;
+}
+
+void RedoLog::syncThread() {
+    std::unique_lock<decltype(mSyncMutex)> lock(mSyncMutex);
+    while (!mShutdown.load()) {
+        mSyncCondition.wait_for(lock, std::chrono::milliseconds(mSyncInterval));
+        if (mShutdown.load()) {
+            break;
+        }
+
+        try {
+            sync();
+        } catch (std::system_error& e) {
+            LOG_ERROR("Error while syncing redo log [error = %1%]", e.what());
+        }
+    }
+}
+
+void RedoLog::seal(RedoLogEntry* entry) {
+    mLog.seal(LogEntry::entryFromData(reinterpret_cast<char*>(entry)));
+    ++mSealed;
+}
+
+void RedoLog::flush() {
+    crossbow::allocator _;
+    auto begin = mLog.begin();
+    auto end = mLog.sealedEnd();
+
+    // Write the sealed entries with one write per page
+    auto page = begin.page();
+    auto offset = begin.offset();
+    while (true) {
+        auto last = (page == end.page());
+        auto endOffset = (last ? end.offset() : page->offset());
+        if (endOffset > offset) {
+            writeAll(mFd, page->data() + offset, endOffset - offset);
+            mFileSize += endOffset - offset;
+        }
+        if (last) {
+            break;
+        }
+        page = page->next().load();
+        offset = 0u;
+    }
+
+    __attribute__((unused)) auto res = mLog.truncateLog(begin, end);
+    LOG_ASSERT(res, "Truncating the redo log failed");
+}
+
+} // namespace store
+} // namespace tell
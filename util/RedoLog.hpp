@@ -0,0 +1,317 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#pragma once
+
+#include "Log.hpp"
+
+#include <crossbow/non_copyable.hpp>
+#include <crossbow/string.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tell {
+namespace store {
+
+class PageManager;
+
+/**
+ * @brief Type of a record in the redo log
+ */
+enum class RedoRecordType : uint32_t {
+    CREATE_TABLE = 0x1u,
+    INSERT,
+    UPDATE,
+    REMOVE,
+    REVERT,
+};
+
+/**
+ * @brief Header of a record in the redo log
+ *
+ * The header is followed by the data of the modification (the tuple in case of an insert or update, the table name and
+ * schema in case of a table creation).
+ */
+struct RedoLogEntry {
+    /// Table ID of a record reserved for a modification that failed (skipped during replay)
+    static constexpr uint64_t CANCELLED_TABLE_ID = 0x0u;
+
+    RedoLogEntry(uint64_t t, uint64_t k, uint64_t v)
+            : tableId(t),
+              key(k),
+              version(v) {
+    }
+
+    const char* data() const {
+        return reinterpret_cast<const char*>(this) + sizeof(RedoLogEntry);
+    }
+
+    char* data() {
+        return const_cast<char*>(const_cast<const RedoLogEntry*>(this)->data());
+    }
+
+    uint64_t tableId;
+    uint64_t key;
+    uint64_t version;
+};
+
+/**
+ * @brief A single modification appended to the redo log as part of a batch
+ */
+struct RedoRecord {
+    RedoRecord(RedoRecordType ty, uint64_t t, uint64_t k, uint64_t v, const char* d, uint32_t s)
+            : type(ty),
+              tableId(t),
+              key(k),
+              version(v),
+              data(d),
+              size(s) {
+    }
+
+    RedoRecordType type;
+    uint64_t tableId;
+    uint64_t key;
+    uint64_t version;
+    const char* data;
+    uint32_t size;
+};
+
+/**
+ * @brief Durable write-ahead log recording all successful modifications of the storage
+ *
+ * Writers append their redo record to an in-memory ordered log without taking any locks. A background thread writes
+ * all sealed records with one sequential write per log page to the file and syncs the file to disk every sync interval
+ * (group commit). The in-memory log is truncated as soon as the records are written to the file.
+ *
+ * Modifications reserve their record before they are executed and complete it afterwards, so a modification that was
+ * executed can never fail to be logged.
+ *
+ * The on-disk format is a sequence of the sealed LogEntry structures (header, RedoLogEntry and data padded to 16 bytes)
+ * exactly as they are stored in the in-memory log.
+ */
+class RedoLog : crossbow::non_copyable, crossbow::non_movable {
+public:
+    /**
+     * @brief Opens the redo log file for appending
+     *
+     * @param pageManager Page manager to allocate the in-memory log buffer from
+     * @param path Path to the redo log file (created if it does not exist)
+     * @param syncInterval Interval in milliseconds in which the log is flushed and synced to disk
+     */
+    RedoLog(PageManager& pageManager, const crossbow::string& path, uint32_t syncInterval);
+
+    ~RedoLog();
+
+    /**
+     * @brief Reserves the space for the redo record of a modification before the modification is executed
+     *
+     * The reserved record has to be either completed or cancelled, none of the records following it in the log are
+     * written to the file before that.
+     *
+     * @param record The modification (only the type and size of the record are used)
+     * @return The reserved record or null if the log ran out of space
+     */
+    RedoLogEntry* reserve(const RedoRecord& record);
+
+    /**
+     * @brief Reserves the space for the redo records of multiple modifications before they are executed
+     *
+     * @param records The modifications (only the types and sizes of the records are used)
+     * @param count Number of modifications
+     * @param entries Array receiving the reserved records
+     * @return Number of records reserved (less than count if the log ran out of space, the records are reserved in
+     *   order)
+     */
+    size_t reserve(const RedoRecord* records, size_t count, RedoLogEntry** entries);
+
+    /**
+     * @brief Writes the executed modification into its reserved record
+     *
+     * The record is not durable until the next sync of the log.
+     */
+    void complete(RedoLogEntry* entry, const RedoRecord& record);
+
+    /**
+     * @brief Marks the reserved record of a modification that failed as cancelled
+     */
+    void cancel(RedoLogEntry* entry);
+
+    /**
+     * @brief Appends a new redo record to the log
+     *
+     * The record is not durable until the next sync of the log.
+     *
+     * @return Whether the record was successfully appended
+     */
+    bool append(RedoRecordType type, uint64_t tableId, uint64_t key, uint64_t version, const char* data,
+            uint32_t size);
+
+    /**
+     * @brief Appends the redo records of multiple modifications to the log
+     *
+     * The space for the records is reserved in as few atomic operations on the log as possible.
+     *
+     * @return Number of records appended (less than count if the log ran out of space, the records are appended in
+     *   order)
+     */
+    size_t append(const RedoRecord* records, size_t count);
+
+    /**
+     * @brief Writes all records appended so far to the file and forces them to disk
+     *
+     * Waits until all records reserved before the call are completed or cancelled.
+     *
+     * @return Size of the log file after the sync, every record appended before the call is located before this offset
+     */
+    uint64_t sync();
+
+    /**
+     * @brief Releases the disk space of all records located before the given offset in the log file
+     *
+     * The records are replaced by a hole in the file (the offsets of all following records remain valid). Used to drop
+     * the part of the log covered by a checkpoint.
+     */
+    void discard(uint64_t offset);
+
+    /**
+     * @brief Discards all records in the log file
+     *
+     * Records in the in-memory buffer are discarded as well, the caller has to ensure that no records are appended
+     * concurrently.
+     */
+    void truncate();
+
+    /**
+     * @brief Reads all complete records from the redo log file at the given path
+     *
+     * Stops at the first incomplete record (i.e. a record torn by a crash). Table creations are passed first in the
+     * order they were logged, all other records are passed in the order of their version. This is required as the log
+     * order of writes to the same key from different transactions might differ from the order in which they were
+     * applied in memory (the record is reserved before the write is executed). Cancelled records are skipped.
+     *
+     * @param path Path to the redo log file
+     * @param offset Offset in the file of the first record to read
+     * @param fun Function with the signature void(RedoRecordType, const RedoLogEntry&, uint32_t dataSize)
+     * @return Number of records read
+     */
+    template <typename Fun>
+    static size_t replay(const crossbow::string& path, uint64_t offset, Fun fun);
+
+private:
+    /**
+     * @brief Reads the content of the redo log file at the given path starting from the given offset
+     */
+    static std::unique_ptr<char[]> readFile(const crossbow::string& path, uint64_t offset, size_t& size);
+
+    void syncThread();
+
+    /**
+     * @brief Seals the reserved record
+     */
+    void seal(RedoLogEntry* entry);
+
+    /**
+     * @brief Writes all sealed records from the in-memory log to the file
+     *
+     * Must be called with the flush mutex held.
+     */
+    void flush();
+
+    Log<OrderedLogImpl> mLog;
+
+    uint32_t mSyncInterval;
+
+    int mFd;
+
+    /// Current size of the log file (only accessed with the flush mutex held)
+    uint64_t mFileSize;
+
+    /// Mutex serializing all writes to the file
+    std::mutex mFlushMutex;
+
+    /// Number of records reserved so far (including reservations that failed)
+    std::atomic<uint64_t> mReserved;
+
+    /// Number of reserved records that were sealed (or could not be reserved)
+    std::atomic<uint64_t> mSealed;
+
+    std::atomic<bool> mShutdown;
+    std::mutex mSyncMutex;
+    std::condition_variable mSyncCondition;
+    std::thread mSyncThread;
+};
+
+template <typename Fun>
+size_t RedoLog::replay(const crossbow::string& path, uint64_t offset, Fun fun) {
+    size_t size;
+    auto data = readFile(path, offset, size);
+    if (!data) {
+        return 0u;
+    }
+
+    std::vector<const LogEntry*> records;
+    size_t count = 0u;
+    size_t position = 0u;
+    while (position + LogEntry::LOG_ENTRY_SIZE + sizeof(RedoLogEntry) <= size) {
+        auto entry = reinterpret_cast<const LogEntry*>(data.get() + position);
+        auto entrySize = entry->entrySize();
+        if (entry->size() < sizeof(RedoLogEntry) || !entry->sealed() || position + entrySize > size) {
+            break;
+        }
+
+        position += entrySize;
+        if (reinterpret_cast<const RedoLogEntry*>(entry->data())->tableId == RedoLogEntry::CANCELLED_TABLE_ID) {
+            continue;
+        }
+
+        auto type = static_cast<RedoRecordType>(entry->type());
+        if (type == RedoRecordType::CREATE_TABLE) {
+            fun(type, *reinterpret_cast<const RedoLogEntry*>(entry->data()),
+                    static_cast<uint32_t>(entry->size() - sizeof(RedoLogEntry)));
+        } else {
+            records.emplace_back(entry);
+        }
+        ++count;
+    }
+
+    std::stable_sort(records.begin(), records.end(), [] (const LogEntry* lhs, const LogEntry* rhs) {
+        return reinterpret_cast<const RedoLogEntry*>(lhs->data())->version
+                < reinterpret_cast<const RedoLogEntry*>(rhs->data())->version;
+    });
+    for (auto entry : records) {
+        fun(static_cast<RedoRecordType>(entry->type()), *reinterpret_cast<const RedoLogEntry*>(entry->data()),
+                static_cast<uint32_t>(entry->size() - sizeof(RedoLogEntry)));
+    }
+    return count;
+}
+
+} // namespace store
+} // namespace tell
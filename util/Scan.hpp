@@ -23,15 +23,20 @@
 #pragma once
 
 #include <config.h>
+#include "LLVMCodeCache.hpp"
+#include "Numa.hpp"
 #include "ScanQuery.hpp"
+#include "StorageConfig.hpp"
 
 #include <tellstore/ErrorCode.hpp>
 #include <tellstore/Record.hpp>
 
 #include <crossbow/allocator.hpp>
+#include <crossbow/logger.hpp>
 #include <crossbow/non_copyable.hpp>
 #include <crossbow/singleconsumerqueue.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <cstring>
@@ -39,116 +44,110 @@
 #include <mutex>
 #include <tuple>
 #include <thread>
-#include <unordered_map>
 #include <vector>
 
 namespace tell {
 namespace store {
 
+/**
+ * @brief Scheduler executing the shared scans of all tables on a pool of scan threads
+ *
+ * Incoming scan queries are grouped by table into shared scans. Up to maxActiveScans shared scans (over different
+ * tables) are processed at the same time: Every scan thread owns one processor per active scan and alternates between
+ * the active scans, processing scanQuantum morsels of one scan before switching to the next. A long running scan thus
+ * only receives its share of the scan threads while shorter scans started after it complete without waiting for it.
+ *
+ * The master thread (scan thread 0) additionally admits new scans and compiles their code between its own morsels.
+ * Queries on a table with an already active scan are held back until that scan finishes and then share a single scan.
+ *
+ * The scans are processed in rounds: The master holds one epoch guard from the first scan of a round until all scans
+ * of the round finished. A round admits at most scanRoundSize scans, later scans wait until the round drained and the
+ * guard was renewed so memory retired in the meantime can be reclaimed even if the scan threads never run idle.
+ *
+ * On NUMA systems the scan threads are distributed round-robin over the nodes so every node has threads processing the
+ * morsels located on it.
+ */
 template<class Table>
-class ScanThread : crossbow::non_copyable, crossbow::non_movable {
-public:
-    ScanThread()
-        : mData(0),
-          mThread(&ScanThread<Table>::operator(), this) {
-    }
+class ScanManager : crossbow::non_copyable, crossbow::non_movable {
+    using ScanRequest = std::tuple<uint64_t, Table*, ScanQuery*>;
 
-    void stop();
+    /**
+     * @brief A shared scan over one table currently processed by the scan threads
+     */
+    struct ActiveScan {
+        ActiveScan(uint64_t tableId, std::unique_ptr<typename Table::Scan> scan)
+                : tableId(tableId),
+                  scan(std::move(scan)),
+                  remaining(0u) {
+        }
 
-    void prepare(typename Table::Scan* scan) {
-        notify(scan, PointerTag::PREPARE);
-    }
+        uint64_t tableId;
 
-    void process(typename Table::ScanProcessor* processor) {
-        notify(processor, PointerTag::PROCESS);
-    }
+        std::unique_ptr<typename Table::Scan> scan;
 
-    bool isBusy() const {
-        return (mData.load() != 0);
-    }
+        /// One processor for every scan thread, each processor is only accessed by its scan thread and released as soon
+        /// as it has no more work
+        std::vector<std::unique_ptr<typename Table::ScanProcessor>> processors;
 
-private:
-    enum class PointerTag : uintptr_t {
-        STOP = 0x1u,
-        PREPARE = (0x1u << 1),
-        PROCESS = (0x1u << 2),
+        /// Number of processors that have not yet been released
+        std::atomic<size_t> remaining;
     };
 
-    void operator()();
-
-    void notify(void* data, PointerTag tag);
-
-    std::atomic<uintptr_t> mData;
-
-    std::mutex mWaitMutex;
-    std::condition_variable mWaitCondition;
-
-    std::thread mThread;
-};
-
-template <class Table>
-void ScanThread<Table>::stop() {
-    notify(nullptr, PointerTag::STOP);
-
-    mThread.join();
-}
-
-template <class Table>
-void ScanThread<Table>::operator()() {
-    while (true) {
-        uintptr_t data = 0;
-        {
-            std::unique_lock<decltype(mWaitMutex)> waitLock(mWaitMutex);
-            mWaitCondition.wait(waitLock, [this, &data] () {
-                data = mData.load();
-                return data != 0;
-            });
-        }
-
-        if ((data & crossbow::to_underlying(PointerTag::STOP)) != 0) {
-            break;
-        }
-
-        if ((data & crossbow::to_underlying(PointerTag::PREPARE)) != 0) {
-            auto scan = reinterpret_cast<typename Table::Scan*>(data & ~crossbow::to_underlying(PointerTag::PREPARE));
-            scan->prepareMaterialization();
-        } else if ((data & crossbow::to_underlying(PointerTag::PROCESS)) != 0) {
-            auto processor = reinterpret_cast<typename Table::ScanProcessor*>(data &
-                    ~crossbow::to_underlying(PointerTag::PROCESS));
-            processor->process();
-        } else {
-            LOG_ASSERT(false, "Unknown pointer tag");
+    /**
+     * @brief Queries waiting to be admitted as a shared scan
+     */
+    struct PendingScan {
+        PendingScan(uint64_t tableId, Table* table)
+                : tableId(tableId),
+                  table(table) {
         }
 
-        mData.store(0);
-    }
-}
-
-template <class Table>
-void ScanThread<Table>::notify(void* data, ScanThread::PointerTag tag) {
-    {
-        std::unique_lock<decltype(mWaitMutex)> waitLock(mWaitMutex);
-        mData.store(reinterpret_cast<uintptr_t>(data) | crossbow::to_underlying(tag));
-    }
-    mWaitCondition.notify_one();
-}
-
-template<class Table>
-class ScanManager : crossbow::non_copyable, crossbow::non_movable {
-    using ScanRequest = std::tuple<uint64_t, Table*, ScanQuery*>;
+        uint64_t tableId;
+        Table* table;
+        std::vector<ScanQuery*> queries;
+    };
 
     size_t mNumThreads;
+    size_t mMaxActiveScans;
+    size_t mScanQuantum;
+    size_t mRoundSize;
+    LLVMCodeCache mCodeCache;
     crossbow::SingleConsumerQueue<ScanRequest, MAX_QUERY_SHARING> queryQueue;
     std::vector<ScanRequest> mEnqueuedQueries;
     std::atomic<bool> stopScans;
 
-    std::vector<std::unique_ptr<ScanThread<Table>>> mSlaves;
+    /// Scans waiting for admission in order of their arrival (only accessed by the master thread)
+    std::vector<PendingScan> mPendingScans;
+
+    /// Scans currently processed by the scan threads in order of their admission
+    std::mutex mActiveMutex;
+    std::vector<std::shared_ptr<ActiveScan>> mActiveScans;
+
+    /// Counter incremented whenever a new scan is admitted, used to wake up idle slaves
+    std::atomic<uint64_t> mScanGeneration;
+    std::mutex mWaitMutex;
+    std::condition_variable mWaitCondition;
+
+    /// Epoch guard of the master held as long as any scan of the current round is active
+    /// The data structures referenced by the scan processors are only safe to access while the guard is held.
+    std::unique_ptr<crossbow::allocator> mGuard;
+
+    /// Number of scans admitted in the current round (only accessed by the master thread)
+    size_t mRoundScans;
+
+    std::vector<std::thread> mSlaves;
     std::thread mMasterThread;
 public:
-    ScanManager(size_t numThreads)
-        : mNumThreads(numThreads)
+    ScanManager(const StorageConfig& config)
+        : mNumThreads(config.numScanThreads)
+        , mMaxActiveScans(std::max(config.maxActiveScans, size_t(1u)))
+        , mScanQuantum(std::max(config.scanQuantum, size_t(1u)))
+        , mRoundSize(std::max(config.scanRoundSize, size_t(1u)))
+        , mCodeCache(config.scanCodeCacheCapacity)
         , mEnqueuedQueries(MAX_QUERY_SHARING, ScanRequest(0u, nullptr, nullptr))
-        , stopScans(false) {
+        , stopScans(false)
+        , mScanGeneration(0u)
+        , mRoundScans(0u) {
         if (mNumThreads == 0u) {
             LOG_WARN("No scan threads set - Scan will be unavailable");
         }
@@ -159,6 +158,12 @@ public:
         if (mNumThreads != 0u) {
             mMasterThread.join();
         }
+        LOG_INFO("Scan code cache statistics [hits = %1%, misses = %2%, evictions = %3%]", mCodeCache.hits(),
+                mCodeCache.misses(), mCodeCache.evictions());
+    }
+
+    const LLVMCodeCache& codeCache() const {
+        return mCodeCache;
     }
 
     void run();
@@ -170,7 +175,38 @@ public:
 private:
     void operator()();
 
-    bool masterThread();
+    void slaveThread(size_t idx);
+
+    /**
+     * @brief Reads incoming queries and starts scans on all tables without an active scan
+     *
+     * @return Whether a new scan was started
+     */
+    bool admitScans();
+
+    void startScan(PendingScan& pending);
+
+    /**
+     * @brief Processes the next morsels of every active scan with the processors of the given scan thread
+     *
+     * @return Whether the scan thread had any work
+     */
+    bool processScans(size_t idx);
+
+    bool hasActiveScans() {
+        std::unique_lock<decltype(mActiveMutex)> _(mActiveMutex);
+        return !mActiveScans.empty();
+    }
+
+    /**
+     * @brief Binds the scan thread to its NUMA node
+     */
+    void bindThread(size_t idx) {
+        auto numNodes = numaNodeCount();
+        if (numNodes > 1u && !numaBindThread(idx % numNodes)) {
+            LOG_WARN("Unable to bind scan thread %1% to NUMA node %2%", idx, idx % numNodes);
+        }
+    }
 };
 
 template<class Table>
@@ -180,8 +216,8 @@ void ScanManager<Table>::run() {
     }
 
     mSlaves.reserve(mNumThreads - 1);
-    for (decltype(mNumThreads) i = 0; i < mNumThreads - 1; ++i) {
-        mSlaves.emplace_back(new ScanThread<Table>());
+    for (decltype(mNumThreads) i = 1; i < mNumThreads; ++i) {
+        mSlaves.emplace_back(&ScanManager<Table>::slaveThread, this, i);
     }
 
     mMasterThread = std::thread(&ScanManager<Table>::operator(), this);
@@ -189,92 +225,166 @@ void ScanManager<Table>::run() {
 
 template<class Table>
 void ScanManager<Table>::operator()() {
-    while (!stopScans.load()) {
-        if (!masterThread()) {
+    bindThread(0u);
+    while (true) {
+        auto admitted = (!stopScans.load() && admitScans());
+        auto processed = processScans(0u);
+
+        if (!hasActiveScans()) {
+            // The round is over - Renew the epoch so memory retired during the scans can be reclaimed
+            mGuard.reset();
+            mRoundScans = 0u;
+            if (stopScans.load()) {
+                break;
+            }
+        }
+
+        if (!admitted && !processed) {
             std::this_thread::yield();
         }
     }
+
+    {
+        std::unique_lock<decltype(mWaitMutex)> _(mWaitMutex);
+        ++mScanGeneration;
+    }
+    mWaitCondition.notify_all();
     for (auto& slave : mSlaves) {
-        slave->stop();
+        slave.join();
     }
 }
 
 template<class Table>
-bool ScanManager<Table>::masterThread() {
-    // A map of all queries we get during this scan phase. Key is the table id, value is:
-    //  - the Table object
-    //  - the total size
-    //  - a vector of queries - that means the query object and the size of the query
-    std::unordered_map<uint64_t, std::tuple<Table*, std::vector<ScanQuery*>>> queryMap;
-    auto numQueries = queryQueue.readMultiple(mEnqueuedQueries.begin(), mEnqueuedQueries.end());
-    if (numQueries == 0) return false;
+void ScanManager<Table>::slaveThread(size_t idx) {
+    bindThread(idx);
+    while (true) {
+        auto generation = mScanGeneration.load();
+        if (processScans(idx)) {
+            continue;
+        }
+
+        std::unique_lock<decltype(mWaitMutex)> waitLock(mWaitMutex);
+        if (stopScans.load() && !hasActiveScans()) {
+            break;
+        }
+        mWaitCondition.wait(waitLock, [this, generation] () {
+            return mScanGeneration.load() != generation;
+        });
+    }
+}
 
+template<class Table>
+bool ScanManager<Table>::admitScans() {
+    auto numQueries = queryQueue.readMultiple(mEnqueuedQueries.begin(), mEnqueuedQueries.end());
     for (size_t i = 0; i < numQueries; ++i) {
         uint64_t tableId;
         Table* table;
         ScanQuery* query;
         std::tie(tableId, table, query) = mEnqueuedQueries.at(i);
-        auto iter = queryMap.find(tableId);
-        if (iter == queryMap.end()) {
-            auto res = queryMap.emplace(tableId, std::make_tuple(table, std::vector<ScanQuery*>()));
-            iter = res.first;
+        auto iter = std::find_if(mPendingScans.begin(), mPendingScans.end(), [tableId] (const PendingScan& pending) {
+            return pending.tableId == tableId;
+        });
+        if (iter == mPendingScans.end()) {
+            iter = mPendingScans.emplace(mPendingScans.end(), tableId, table);
         }
         if (!query) {
             continue;
         }
-        std::get<1>(iter->second).emplace_back(query);
+        iter->queries.emplace_back(query);
     }
-    // now we have all queries in a map, so we can start the scans
-    for (auto& q : queryMap) {
-        // first we need to create the QBuffer
-        // The QBuffer is the shared object of all scans, it is a byte array containing the combined serialized
-        // selection queries of every scan query.
-        Table* table;
-        std::vector<ScanQuery*> queries;
-        std::tie(table, queries) = std::move(q.second);
 
-        //auto startTime = std::chrono::steady_clock::now();
-        //auto queryCount = queries.size();
-        typename Table::Scan scan(table, std::move(queries));
-
-        if (!mSlaves.empty()) {
-            mSlaves.front()->prepare(&scan);
-        } else {
-            scan.prepareMaterialization();
+    bool admitted = false;
+    for (auto i = mPendingScans.begin(); i != mPendingScans.end();) {
+        // Hold back the remaining scans until the current round drained
+        if (mRoundScans >= mRoundSize) {
+            break;
         }
-        scan.prepareQuery();
-        if (!mSlaves.empty()) {
-            auto& slave = mSlaves.front();
-            while (slave->isBusy()) std::this_thread::yield();
+
+        {
+            std::unique_lock<decltype(mActiveMutex)> _(mActiveMutex);
+            if (mActiveScans.size() >= mMaxActiveScans) {
+                break;
+            }
+
+            // Only one scan per table can be active at a time
+            auto tableId = i->tableId;
+            auto active = std::any_of(mActiveScans.begin(), mActiveScans.end(),
+                    [tableId] (const std::shared_ptr<ActiveScan>& scan) {
+                return scan->tableId == tableId;
+            });
+            if (active) {
+                ++i;
+                continue;
+            }
         }
-        //auto prepareTime = std::chrono::steady_clock::now();
 
-        crossbow::allocator _;
+        startScan(*i);
+        i = mPendingScans.erase(i);
+        admitted = true;
+    }
 
-        auto processors = scan.startScan(mNumThreads);
-        for (decltype(mSlaves.size()) i = 0; i < mSlaves.size(); ++i) {
-            // we do not need to synchronize here, the scan threads start as soon as the processor is set
-            mSlaves[i]->process(processors[i].get());
+    if (admitted) {
+        {
+            std::unique_lock<decltype(mWaitMutex)> _(mWaitMutex);
+            ++mScanGeneration;
         }
+        mWaitCondition.notify_all();
+    }
+    return admitted;
+}
 
-        // do the master thread part of the scan
-        processors[mSlaves.size()]->process();
+template<class Table>
+void ScanManager<Table>::startScan(PendingScan& pending) {
+    // The guard has to be acquired before the scan captures its view of the table
+    if (!mGuard) {
+        mGuard.reset(new crossbow::allocator());
+    }
+    ++mRoundScans;
 
-        // now we need to wait until the other threads are done
-        for (auto& slave : mSlaves) {
-            // as soon as the thread is done, it will unset the processors - this means that the scan is over and
-            // the master can delete the processors savely (which will be done as soon as the scope is left).
-            while (slave->isBusy()) std::this_thread::yield();
-        }
-        //auto endTime = std::chrono::steady_clock::now();
+    std::unique_ptr<typename Table::Scan> scan(new typename Table::Scan(pending.table, std::move(pending.queries),
+            mCodeCache));
+    scan->prepareMaterialization();
+    scan->prepareQuery();
 
-        //auto prepareDuration = std::chrono::duration_cast<std::chrono::milliseconds>(prepareTime - startTime);
-        //auto processDuration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - prepareTime);
-        //auto totalDuration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-        //LOG_INFO("Scan took %1%ms for %2% queries [prepare = %3%, process = %4%]",
-        //         totalDuration.count(), queryCount, prepareDuration.count(), processDuration.count());
+    auto activeScan = std::make_shared<ActiveScan>(pending.tableId, std::move(scan));
+    activeScan->processors = activeScan->scan->startScan(mNumThreads);
+    activeScan->remaining.store(activeScan->processors.size());
+
+    std::unique_lock<decltype(mActiveMutex)> _(mActiveMutex);
+    mActiveScans.emplace_back(std::move(activeScan));
+}
+
+template<class Table>
+bool ScanManager<Table>::processScans(size_t idx) {
+    std::vector<std::shared_ptr<ActiveScan>> scans;
+    {
+        std::unique_lock<decltype(mActiveMutex)> _(mActiveMutex);
+        scans = mActiveScans;
+    }
+
+    bool processed = false;
+    for (auto& scan : scans) {
+        auto& processor = scan->processors[idx];
+        if (!processor) {
+            continue;
+        }
+        processed = true;
+
+        for (decltype(mScanQuantum) i = 0; i < mScanQuantum; ++i) {
+            if (processor->processNext()) {
+                continue;
+            }
+
+            // The processor is done - Releasing it flushes the remaining results to the clients
+            processor.reset();
+            if (--scan->remaining == 0u) {
+                std::unique_lock<decltype(mActiveMutex)> _(mActiveMutex);
+                mActiveScans.erase(std::find(mActiveScans.begin(), mActiveScans.end(), scan));
+            }
+            break;
+        }
     }
-    return true;
+    return processed;
 }
 
 } // namespace store
@@ -0,0 +1,121 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#pragma once
+
+#include "Numa.hpp"
+
+#include <crossbow/non_copyable.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace tell {
+namespace store {
+
+/**
+ * @brief Queue distributing the work of a shared scan in small units (morsels) to the scan threads
+ *
+ * All processors of a scan share the same queue and repeatedly pull the next unprocessed morsel until the queue is
+ * exhausted. Threads finishing early continue with the remaining morsels instead of idling while another thread is
+ * still working through a large static partition.
+ *
+ * The morsels are grouped by the NUMA node holding their data. A thread first processes the morsels of the node it is
+ * running on and only then steals morsels from the other nodes.
+ */
+template <typename Morsel>
+class ScanMorselQueue : crossbow::non_copyable, crossbow::non_movable {
+public:
+    /**
+     * @brief Creates a queue of morsels not associated with any particular NUMA node
+     */
+    ScanMorselQueue(std::vector<Morsel> morsels)
+            : mNumNodes(1u),
+              mNodes(new NodeMorsels[1]) {
+        mNodes[0].morsels = std::move(morsels);
+    }
+
+    /**
+     * @brief Creates a queue with the morsels of every NUMA node in a separate list
+     */
+    ScanMorselQueue(std::vector<std::vector<Morsel>> nodeMorsels)
+            : mNumNodes(std::max(nodeMorsels.size(), size_t(1u))),
+              mNodes(new NodeMorsels[mNumNodes]) {
+        for (decltype(nodeMorsels.size()) i = 0; i < nodeMorsels.size(); ++i) {
+            mNodes[i].morsels = std::move(nodeMorsels[i]);
+        }
+    }
+
+    size_t size() const {
+        size_t result = 0u;
+        for (decltype(mNumNodes) i = 0; i < mNumNodes; ++i) {
+            result += mNodes[i].morsels.size();
+        }
+        return result;
+    }
+
+    /**
+     * @brief Acquires the next unprocessed morsel preferring morsels of the NUMA node of the calling thread
+     *
+     * @return Pointer to the morsel or null if all morsels have been handed out
+     */
+    const Morsel* next() {
+        auto node = (mNumNodes == 1u ? 0u : numaCurrentNode());
+        for (decltype(mNumNodes) i = 0; i < mNumNodes; ++i) {
+            if (auto morsel = mNodes[(node + i) % mNumNodes].next()) {
+                return morsel;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    struct NodeMorsels {
+        NodeMorsels()
+                : nextIdx(0u) {
+        }
+
+        const Morsel* next() {
+            if (nextIdx.load() >= morsels.size()) {
+                return nullptr;
+            }
+            auto idx = nextIdx.fetch_add(1u);
+            return (idx < morsels.size() ? &morsels[idx] : nullptr);
+        }
+
+        std::vector<Morsel> morsels;
+
+        std::atomic<size_t> nextIdx;
+    };
+
+    size_t mNumNodes;
+
+    std::unique_ptr<NodeMorsels[]> mNodes;
+};
+
+} // namespace store
+} // namespace tell
@@ -25,13 +25,64 @@
 
 #include <crossbow/alignment.hpp>
 
+#include <algorithm>
+#include <cstring>
+
 namespace tell {
 namespace store {
 namespace {
 
 const uint16_t gMaxTupleCount = 4u * 1024u;
 
-Record buildScanRecord(ScanQueryType queryType, const char* queryData, const char* queryDataEnd, const Record& record) {
+/**
+ * @brief Offset of the aggregation query into the query data
+ */
+size_t aggregationOffset(ScanQueryType queryType, const char* queryData) {
+    if (queryType != ScanQueryType::GROUP_BY) {
+        return 0u;
+    }
+    auto groupCount = *reinterpret_cast<const uint16_t*>(queryData);
+    return crossbow::align(sizeof(uint16_t) + groupCount * sizeof(Record::id_t), 4u);
+}
+
+/**
+ * @brief Adds a field for every aggregation to the schema
+ *
+ * The fields are named after their position in the target schema starting at the given field id.
+ */
+void addAggregationFields(Schema& schema, Record::id_t fieldId, const char* queryData, const char* queryDataEnd,
+        const Record& record) {
+    AggregationIterator end(queryDataEnd);
+    for (AggregationIterator i(queryData); i != end; ++i, ++fieldId) {
+        Record::id_t id;
+        AggregationType aggType;
+        std::tie(id, aggType) = *i;
+
+        bool notNull;
+        switch (aggType) {
+        case AggregationType::MIN:
+        case AggregationType::MAX:
+        case AggregationType::SUM: {
+            notNull = false;
+        } break;
+
+        case AggregationType::CNT: {
+            notNull = true;
+        } break;
+
+        default: {
+            LOG_ASSERT(false, "Unknown aggregation type");
+            notNull = false;
+        } break;
+        }
+
+        auto& field = record.getFieldMeta(id).field;
+        schema.addField(field.aggType(aggType), crossbow::to_string(fieldId), notNull);
+    }
+}
+
+Record buildScanRecord(ScanQueryType queryType, const char* queryData, const char* queryDataEnd,
+        size_t aggregationOffset, const Record& record) {
     switch (queryType) {
     case ScanQueryType::FULL: {
         return record;
@@ -48,36 +99,23 @@ Record buildScanRecord(ScanQueryType queryType, const char* queryData, const cha
     } break;
     case ScanQueryType::AGGREGATION: {
         Schema schema(TableType::UNKNOWN);
-        Record::id_t fieldId = 0u;
-        AggregationIterator end(queryDataEnd);
-        for (AggregationIterator i(queryData); i != end; ++i, ++fieldId) {
-            Record::id_t id;
-            AggregationType aggType;
-            std::tie(id, aggType) = *i;
-
-            bool notNull;
-            switch (aggType) {
-            case AggregationType::MIN:
-            case AggregationType::MAX:
-            case AggregationType::SUM: {
-                notNull = false;
-            } break;
-
-            case AggregationType::CNT: {
-                notNull = true;
-            } break;
-
-            default: {
-                LOG_ASSERT(false, "Unknown aggregation type");
-                notNull = false;
-            } break;
-            }
+        addAggregationFields(schema, 0u, queryData, queryDataEnd, record);
+        return Record(std::move(schema));
+    } break;
 
-            auto& field = record.getFieldMeta(id).field;
-            schema.addField(field.aggType(aggType), crossbow::to_string(fieldId), notNull);
+    case ScanQueryType::GROUP_BY: {
+        Schema schema(TableType::UNKNOWN);
+        Record::id_t fieldId = 0u;
+        ProjectionIterator end(queryData + sizeof(uint16_t) + *reinterpret_cast<const uint16_t*>(queryData)
+                * sizeof(Record::id_t));
+        for (ProjectionIterator i(queryData + sizeof(uint16_t)); i != end; ++i, ++fieldId) {
+            auto& field = record.getFieldMeta(*i).field;
+            schema.addField(field.type(), crossbow::to_string(fieldId), field.isNotNull());
         }
+        addAggregationFields(schema, fieldId, queryData + aggregationOffset, queryDataEnd, record);
         return Record(std::move(schema));
     } break;
+
     default: {
         LOG_ASSERT(false, "Unknown scan query type");
         return Record();
@@ -85,28 +123,338 @@ Record buildScanRecord(ScanQueryType queryType, const char* queryData, const cha
     }
 }
 
+/**
+ * @brief Retrieves the ids of the fields named "offset" to "offset+count-1" in the record
+ */
+std::vector<Record::id_t> fieldIds(const Record& record, Record::id_t offset, Record::id_t count) {
+    std::vector<Record::id_t> result;
+    result.reserve(count);
+    for (Record::id_t i = 0; i < count; ++i) {
+        Record::id_t id;
+        record.idOf(crossbow::to_string(offset + i), id);
+        result.emplace_back(id);
+    }
+    return result;
+}
+
+template <typename T>
+void combineValue(AggregationType aggType, char* dest, const char* src) {
+    auto& destValue = *reinterpret_cast<T*>(dest);
+    auto srcValue = *reinterpret_cast<const T*>(src);
+    switch (aggType) {
+    case AggregationType::MIN: {
+        if (srcValue < destValue) {
+            destValue = srcValue;
+        }
+    } break;
+
+    case AggregationType::MAX: {
+        if (srcValue > destValue) {
+            destValue = srcValue;
+        }
+    } break;
+
+    case AggregationType::SUM:
+    case AggregationType::CNT: {
+        destValue += srcValue;
+    } break;
+
+    default: {
+        LOG_ASSERT(false, "Unknown aggregation type");
+    } break;
+    }
+}
+
+template <typename T>
+bool valueBefore(ScanOrder order, const char* lhs, const char* rhs) {
+    T lhsValue;
+    T rhsValue;
+    memcpy(&lhsValue, lhs, sizeof(T));
+    memcpy(&rhsValue, rhs, sizeof(T));
+    return (order == ScanOrder::ASCENDING ? lhsValue < rhsValue : lhsValue > rhsValue);
+}
+
 } // anonymous namespace
 
 ScanQuery::ScanQuery(ScanQueryType queryType, std::unique_ptr<char[]> selectionData, size_t selectionLength,
-        std::unique_ptr<char[]> queryData, size_t queryLength,
-        std::unique_ptr<commitmanager::SnapshotDescriptor> snapshot, const Record& record)
+        std::unique_ptr<char[]> queryData, size_t queryLength, uint64_t lowKey, uint64_t highKey, uint64_t limit,
+        ScanOrder order, Record::id_t orderField, std::unique_ptr<commitmanager::SnapshotDescriptor> snapshot,
+        const Record& record)
         : mQueryType(queryType),
           mSelectionData(std::move(selectionData)),
           mSelectionLength(selectionLength),
           mQueryData(std::move(queryData)),
           mQueryLength(queryLength),
+          mAggregationOffset(aggregationOffset(mQueryType, mQueryData.get())),
+          mLowKey(lowKey),
+          mHighKey(highKey),
+          mLimit(limit),
+          mOrder(order),
+          mOrderField(orderField),
+          mRemainingTuples(limit),
           mSnapshot(std::move(snapshot)),
-          mRecord(buildScanRecord(mQueryType, mQueryData.get(), mQueryData.get() + mQueryLength, record)),
-          mMinimumLength(mRecord.staticSize() + ScanQueryProcessor::TUPLE_OVERHEAD) {
+          mRecord(buildScanRecord(mQueryType, mQueryData.get(), mQueryData.get() + mQueryLength, mAggregationOffset,
+                  record)),
+          mMinimumLength(mRecord.staticSize() + ScanQueryProcessor::TUPLE_OVERHEAD),
+          mActivePartialProcessors(0u) {
+    switch (mQueryType) {
+    case ScanQueryType::AGGREGATION: {
+        mAggregationRecord = mRecord;
+    } break;
+
+    case ScanQueryType::GROUP_BY: {
+        Schema schema(TableType::UNKNOWN);
+        addAggregationFields(schema, 0u, mQueryData.get() + mAggregationOffset, mQueryData.get() + mQueryLength,
+                record);
+        mAggregationRecord = Record(std::move(schema));
+    } break;
+
+    default:
+        break;
+    }
 }
 
 ScanQuery::~ScanQuery() = default;
 
+bool ScanQuery::validLimit() const {
+    if (mLimit == 0u) {
+        return (mOrder == ScanOrder::NONE);
+    }
+    if (mQueryType != ScanQueryType::FULL && mQueryType != ScanQueryType::PROJECTION) {
+        return false;
+    }
+
+    switch (mOrder) {
+    case ScanOrder::NONE: {
+        return true;
+    } break;
+
+    case ScanOrder::ASCENDING:
+    case ScanOrder::DESCENDING: {
+        if (mOrderField >= mRecord.fieldCount()) {
+            return false;
+        }
+        switch (mRecord.getFieldMeta(mOrderField).field.type()) {
+        case FieldType::SMALLINT:
+        case FieldType::INT:
+        case FieldType::BIGINT:
+        case FieldType::FLOAT:
+        case FieldType::DOUBLE:
+            return true;
+
+        default:
+            return false;
+        }
+    } break;
+
+    default: {
+        return false;
+    } break;
+    }
+}
+
+bool ScanQuery::orderedBefore(const char* lhs, const char* rhs) const {
+    auto& metadata = mRecord.getFieldMeta(mOrderField);
+    auto& field = metadata.field;
+    if (!field.isNotNull()) {
+        if (mRecord.isFieldNull(lhs, metadata.nullIdx)) {
+            return false;
+        }
+        if (mRecord.isFieldNull(rhs, metadata.nullIdx)) {
+            return true;
+        }
+    }
+
+    switch (field.type()) {
+    case FieldType::SMALLINT: {
+        return valueBefore<int16_t>(mOrder, lhs + metadata.offset, rhs + metadata.offset);
+    } break;
+
+    case FieldType::INT: {
+        return valueBefore<int32_t>(mOrder, lhs + metadata.offset, rhs + metadata.offset);
+    } break;
+
+    case FieldType::BIGINT: {
+        return valueBefore<int64_t>(mOrder, lhs + metadata.offset, rhs + metadata.offset);
+    } break;
+
+    case FieldType::FLOAT: {
+        return valueBefore<float>(mOrder, lhs + metadata.offset, rhs + metadata.offset);
+    } break;
+
+    case FieldType::DOUBLE: {
+        return valueBefore<double>(mOrder, lhs + metadata.offset, rhs + metadata.offset);
+    } break;
+
+    default: {
+        LOG_ASSERT(false, "Unsupported order field type");
+        return false;
+    } break;
+    }
+}
+
+void ScanQuery::initAggregation(char* data) const {
+    memset(data, 0, mAggregationRecord.staticSize());
+
+    auto aggIter = aggregationBegin();
+    for (Record::id_t i = 0; i < mAggregationRecord.fieldCount(); ++i, ++aggIter) {
+        uint16_t destFieldIdx;
+        mAggregationRecord.idOf(crossbow::to_string(i), destFieldIdx);
+        auto& metadata = mAggregationRecord.getFieldMeta(destFieldIdx);
+        auto& field = metadata.field;
+        auto aggType = std::get<1>(*aggIter);
+        field.initAgg(aggType, data + metadata.offset);
+
+        // Set all fields that can be NULL to NULL
+        // Whenever the first value is written the field will be marked as non-NULL
+        if (!field.isNotNull()) {
+            mAggregationRecord.setFieldNull(data, metadata.nullIdx, true);
+        }
+    }
+}
+
+void ScanQuery::combineAggregation(char* dest, const char* src) const {
+    auto aggIter = aggregationBegin();
+    for (Record::id_t i = 0; i < mAggregationRecord.fieldCount(); ++i, ++aggIter) {
+        uint16_t fieldIdx;
+        mAggregationRecord.idOf(crossbow::to_string(i), fieldIdx);
+        auto& metadata = mAggregationRecord.getFieldMeta(fieldIdx);
+        auto& field = metadata.field;
+        auto aggType = std::get<1>(*aggIter);
+
+        // Skip values that are still NULL in the source and take the source value if the destination is still NULL
+        if (!field.isNotNull()) {
+            if (mAggregationRecord.isFieldNull(src, metadata.nullIdx)) {
+                continue;
+            }
+            if (mAggregationRecord.isFieldNull(dest, metadata.nullIdx)) {
+                memcpy(dest + metadata.offset, src + metadata.offset, field.staticSize());
+                mAggregationRecord.setFieldNull(dest, metadata.nullIdx, false);
+                continue;
+            }
+        }
+
+        switch (field.type()) {
+        case FieldType::SMALLINT: {
+            combineValue<int16_t>(aggType, dest + metadata.offset, src + metadata.offset);
+        } break;
+
+        case FieldType::INT: {
+            combineValue<int32_t>(aggType, dest + metadata.offset, src + metadata.offset);
+        } break;
+
+        case FieldType::BIGINT: {
+            combineValue<int64_t>(aggType, dest + metadata.offset, src + metadata.offset);
+        } break;
+
+        case FieldType::FLOAT: {
+            combineValue<float>(aggType, dest + metadata.offset, src + metadata.offset);
+        } break;
+
+        case FieldType::DOUBLE: {
+            combineValue<double>(aggType, dest + metadata.offset, src + metadata.offset);
+        } break;
+
+        default: {
+            LOG_ASSERT(false, "Unsupported aggregation field type");
+        } break;
+        }
+    }
+}
+
+void ScanQuery::appendGroupKey(const Record& record, const char* data, std::string& groupKey) const {
+    for (auto i = groupByBegin(); i != groupByEnd(); ++i) {
+        auto& metadata = record.getFieldMeta(*i);
+        auto& field = metadata.field;
+        if (!field.isNotNull()) {
+            auto isNull = record.isFieldNull(data, metadata.nullIdx);
+            groupKey.push_back(isNull ? 1 : 0);
+            if (isNull) {
+                continue;
+            }
+        }
+
+        if (field.isFixedSized()) {
+            groupKey.append(data + metadata.offset, field.staticSize());
+        } else {
+            auto offsets = reinterpret_cast<const uint32_t*>(data + metadata.offset);
+            auto length = offsets[1] - offsets[0];
+            groupKey.append(reinterpret_cast<const char*>(&length), sizeof(uint32_t));
+            groupKey.append(data + offsets[0], length);
+        }
+    }
+}
+
+void ScanQuery::addPartialProcessor() {
+    std::unique_lock<decltype(mPartialMutex)> _(mPartialMutex);
+    ++mActivePartialProcessors;
+}
+
+bool ScanQuery::mergeGroups(GroupTable& groups) {
+    std::unique_lock<decltype(mPartialMutex)> _(mPartialMutex);
+    LOG_ASSERT(mActivePartialProcessors > 0u, "No active partial processors");
+
+    if (mGroups.empty()) {
+        mGroups.swap(groups);
+    } else {
+        for (auto& group : groups) {
+            auto i = mGroups.find(group.first);
+            if (i == mGroups.end()) {
+                mGroups.emplace(group.first, std::move(group.second));
+            } else {
+                combineAggregation(i->second.get(), group.second.get());
+            }
+        }
+        groups.clear();
+    }
+
+    if (--mActivePartialProcessors != 0u) {
+        return false;
+    }
+    groups.swap(mGroups);
+    return true;
+}
+
+bool ScanQuery::mergeOrderedTuples(OrderedTuples& tuples) {
+    std::unique_lock<decltype(mPartialMutex)> _(mPartialMutex);
+    LOG_ASSERT(mActivePartialProcessors > 0u, "No active partial processors");
+
+    auto comp = [this] (const OrderedTuple& lhs, const OrderedTuple& rhs) {
+        return orderedBefore(lhs.data.data(), rhs.data.data());
+    };
+
+    // Only keep the first limit tuples of all processors merged so far
+    std::move(tuples.begin(), tuples.end(), std::back_inserter(mOrderedTuples));
+    tuples.clear();
+    if (mOrderedTuples.size() > mLimit) {
+        std::nth_element(mOrderedTuples.begin(), mOrderedTuples.begin() + (mLimit - 1u), mOrderedTuples.end(), comp);
+        mOrderedTuples.erase(mOrderedTuples.begin() + mLimit, mOrderedTuples.end());
+    }
+
+    if (--mActivePartialProcessors != 0u) {
+        return false;
+    }
+    std::sort(mOrderedTuples.begin(), mOrderedTuples.end(), comp);
+    tuples.swap(mOrderedTuples);
+    return true;
+}
+
 ScanQueryProcessor::~ScanQueryProcessor() {
     if (!mData) {
         return;
     }
 
+    // Only the processor merging the last partial groups writes the groups of all processors
+    if (mData->queryType() == ScanQueryType::GROUP_BY) {
+        if (mData->mergeGroups(mGroups)) {
+            writeGroups();
+        }
+    } else if (mData->order() != ScanOrder::NONE) {
+        if (mData->mergeOrderedTuples(mOrderedTuples)) {
+            writeOrderedTuples();
+        }
+    }
+
     std::error_code ec;
     if (mBuffer) {
         mData->writeLast(mBuffer, mBufferWriter.data(), ec);
@@ -127,7 +475,11 @@ ScanQueryProcessor::ScanQueryProcessor(ScanQueryProcessor&& other)
           mBuffer(std::move(other.mBuffer)),
           mBufferWriter(other.mBufferWriter),
           mTotalWritten(other.mTotalWritten),
-          mTupleCount(other.mTupleCount) {
+          mTupleCount(other.mTupleCount),
+          mGroups(std::move(other.mGroups)),
+          mGroupKey(std::move(other.mGroupKey)),
+          mOrderedTuples(std::move(other.mOrderedTuples)),
+          mOrderedTuple(std::move(other.mOrderedTuple)) {
     other.mData = nullptr;
     other.mBuffer = nullptr;
     other.mTotalWritten = 0u;
@@ -149,6 +501,11 @@ ScanQueryProcessor& ScanQueryProcessor::operator=(ScanQueryProcessor&& other) {
     mTupleCount = other.mTupleCount;
     other.mTupleCount = 0u;
 
+    mGroups = std::move(other.mGroups);
+    mGroupKey = std::move(other.mGroupKey);
+    mOrderedTuples = std::move(other.mOrderedTuples);
+    mOrderedTuple = std::move(other.mOrderedTuple);
+
     return *this;
 }
 
@@ -156,25 +513,17 @@ void ScanQueryProcessor::initAggregationRecord() {
     ensureBufferSpace(mData->minimumLength());
 
     mBufferWriter.write<uint64_t>(0u);
-    auto tupleData = mBufferWriter.data();
-    mBufferWriter.set(0, mData->minimumLength() - TUPLE_OVERHEAD);
+    mData->initAggregation(mBufferWriter.data());
+    mBufferWriter.advance(mData->minimumLength() - TUPLE_OVERHEAD);
+}
 
-    auto& record = mData->record();
-    auto aggIter = mData->aggregationBegin();
-    for (Record::id_t i = 0; i < record.fieldCount(); ++i, ++aggIter) {
-        uint16_t destFieldIdx;
-        record.idOf(crossbow::to_string(i), destFieldIdx);
-        auto& metadata = record.getFieldMeta(destFieldIdx);
-        auto& field = metadata.field;
-        auto aggType = std::get<1>(*aggIter);
-        field.initAgg(aggType, tupleData + metadata.offset);
+void ScanQueryProcessor::initGroupAggregation() {
+    mData->addPartialProcessor();
+}
 
-        // Set all fields that can be NULL to NULL
-        // Whenever the first value is written the field will be marked as non-NULL
-        if (!field.isNotNull()) {
-            record.setFieldNull(tupleData, metadata.nullIdx, true);
-        }
-    }
+void ScanQueryProcessor::initOrderedLimit() {
+    mData->addPartialProcessor();
+    mOrderedTuples.reserve(std::min(mData->limit(), uint64_t(1024u)));
 }
 
 void ScanQueryProcessor::ensureBufferSpace(uint32_t length) {
@@ -207,5 +556,134 @@ void ScanQueryProcessor::ensureBufferSpace(uint32_t length) {
     }
 }
 
+void ScanQueryProcessor::writeGroups() {
+    auto& record = mData->record();
+    auto& aggregationRecord = mData->aggregationRecord();
+
+    auto groupCount = mData->groupByCount();
+    auto groupIds = fieldIds(record, 0u, groupCount);
+    auto aggregationCount = aggregationRecord.fieldCount();
+    auto destIds = fieldIds(record, groupCount, aggregationCount);
+    auto srcIds = fieldIds(aggregationRecord, 0u, aggregationCount);
+
+    // Position and length of every group value in the group key (or null if the value is NULL)
+    std::vector<std::tuple<const char*, uint32_t>> values(groupCount);
+
+    for (auto& group : mGroups) {
+        // Decode the group values from the group key
+        auto pos = group.first.data();
+        uint32_t heapSize = 0u;
+        for (decltype(groupCount) i = 0; i < groupCount; ++i) {
+            auto& field = record.getFieldMeta(groupIds[i]).field;
+            if (!field.isNotNull() && *(pos++) != 0) {
+                values[i] = std::make_tuple(nullptr, 0u);
+                continue;
+            }
+
+            uint32_t length;
+            if (field.isFixedSized()) {
+                length = field.staticSize();
+            } else {
+                memcpy(&length, pos, sizeof(uint32_t));
+                pos += sizeof(uint32_t);
+                heapSize += length;
+            }
+            values[i] = std::make_tuple(pos, length);
+            pos += length;
+        }
+
+        auto tupleLength = crossbow::align(record.staticSize() + heapSize, 8u);
+        ensureBufferSpace(tupleLength + TUPLE_OVERHEAD);
+
+        // Write key
+        mBufferWriter.write<uint64_t>(0u);
+
+        auto tupleData = mBufferWriter.data();
+        memset(tupleData, 0, tupleLength);
+
+        // Write the group values, variable sized values are written to the heap in the order of their fields
+        auto heapOffset = record.staticSize();
+        for (decltype(groupCount) i = 0; i < groupCount; ++i) {
+            auto& metadata = record.getFieldMeta(groupIds[i]);
+            auto& field = metadata.field;
+
+            const char* value;
+            uint32_t length;
+            std::tie(value, length) = values[i];
+            if (!field.isNotNull()) {
+                record.setFieldNull(tupleData, metadata.nullIdx, value == nullptr);
+            }
+
+            if (field.isFixedSized()) {
+                if (value) {
+                    memcpy(tupleData + metadata.offset, value, length);
+                }
+            } else {
+                *reinterpret_cast<uint32_t*>(tupleData + metadata.offset) = heapOffset;
+                if (value) {
+                    memcpy(tupleData + heapOffset, value, length);
+                    heapOffset += length;
+                }
+            }
+        }
+        if (record.varSizeFieldCount() != 0) {
+            *reinterpret_cast<uint32_t*>(tupleData + record.staticSize() - sizeof(uint32_t)) = heapOffset;
+        }
+
+        // Write the aggregation values
+        auto state = group.second.get();
+        for (decltype(aggregationCount) i = 0; i < aggregationCount; ++i) {
+            auto& destMetadata = record.getFieldMeta(destIds[i]);
+            auto& srcMetadata = aggregationRecord.getFieldMeta(srcIds[i]);
+            memcpy(tupleData + destMetadata.offset, state + srcMetadata.offset, destMetadata.field.staticSize());
+            if (!destMetadata.field.isNotNull()) {
+                record.setFieldNull(tupleData, destMetadata.nullIdx,
+                        aggregationRecord.isFieldNull(state, srcMetadata.nullIdx));
+            }
+        }
+
+        mBufferWriter.advance(tupleLength);
+        ++mTupleCount;
+    }
+    mGroups.clear();
+}
+
+void ScanQueryProcessor::addOrderedTuple(uint64_t key) {
+    auto comp = [this] (const ScanQuery::OrderedTuple& lhs, const ScanQuery::OrderedTuple& rhs) {
+        return mData->orderedBefore(lhs.data.data(), rhs.data.data());
+    };
+
+    if (mOrderedTuples.size() < mData->limit()) {
+        mOrderedTuples.emplace_back(key, std::move(mOrderedTuple));
+        std::push_heap(mOrderedTuples.begin(), mOrderedTuples.end(), comp);
+        mOrderedTuple = std::string();
+        return;
+    }
+
+    // Replace the tuple ordered last if the new tuple is ordered before it
+    if (!mData->orderedBefore(mOrderedTuple.data(), mOrderedTuples.front().data.data())) {
+        return;
+    }
+    std::pop_heap(mOrderedTuples.begin(), mOrderedTuples.end(), comp);
+    auto& last = mOrderedTuples.back();
+    last.key = key;
+    last.data.swap(mOrderedTuple);
+    std::push_heap(mOrderedTuples.begin(), mOrderedTuples.end(), comp);
+}
+
+void ScanQueryProcessor::writeOrderedTuples() {
+    for (auto& tuple : mOrderedTuples) {
+        auto tupleLength = crossbow::align(static_cast<uint32_t>(tuple.data.size()), 8u);
+        ensureBufferSpace(tupleLength + TUPLE_OVERHEAD);
+
+        mBufferWriter.write<uint64_t>(tuple.key);
+        memcpy(mBufferWriter.data(), tuple.data.data(), tuple.data.size());
+        mBufferWriter.advance(tupleLength);
+
+        ++mTupleCount;
+    }
+    mOrderedTuples.clear();
+}
+
 } // namespace store
 } // namespace tell
@@ -32,11 +32,16 @@
 #include <crossbow/logger.hpp>
 #include <crossbow/non_copyable.hpp>
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <system_error>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace tell {
@@ -150,12 +155,45 @@ private:
  *     - 2 bytes: The data if its size is between 1 and 2 bytes long padding otherwise
  *     - 4 bytes: The data if its size is between 2 and 4 bytes long padding otherwise
  *     - The data if it is larger than 4 bytes or if it is variable size length (padded to 8 bytes)
+ *   - For each IN_LIST or BETWEEN predicate the data is replaced by:
+ *     - 2 bytes: Padding
+ *     - 4 bytes: The number of values (at least one, always two for BETWEEN: the inclusive lower and upper bound)
+ *     - For each value: 8 bytes holding the value of a fixed size column or the 4 byte size followed by the data of a
+ *       variable size column (padded to 8 bytes), BETWEEN is only supported on fixed size columns
  */
 class ScanQuery {
 public:
+    /**
+     * @brief Upper key bound denoting a scan without upper bound on the key
+     */
+    static constexpr uint64_t UNBOUNDED_KEY = std::numeric_limits<uint64_t>::max();
+
+    /**
+     * @brief Map from the encoded group key to the aggregation state of the group
+     */
+    using GroupTable = std::unordered_map<std::string, std::unique_ptr<char[]>>;
+
+    /**
+     * @brief Tuple kept by a scan with an ordered limit
+     */
+    struct OrderedTuple {
+        OrderedTuple(uint64_t key, std::string data)
+                : key(key),
+                  data(std::move(data)) {
+        }
+
+        uint64_t key;
+
+        /// The tuple in the format of the target schema
+        std::string data;
+    };
+
+    using OrderedTuples = std::vector<OrderedTuple>;
+
     ScanQuery(ScanQueryType queryType, std::unique_ptr<char[]> selectionData, size_t selectionLength,
-            std::unique_ptr<char[]> queryData, size_t queryLength,
-            std::unique_ptr<commitmanager::SnapshotDescriptor> snapshot, const Record& record);
+            std::unique_ptr<char[]> queryData, size_t queryLength, uint64_t lowKey, uint64_t highKey, uint64_t limit,
+            ScanOrder order, Record::id_t orderField, std::unique_ptr<commitmanager::SnapshotDescriptor> snapshot,
+            const Record& record);
 
     virtual ~ScanQuery();
 
@@ -190,15 +228,114 @@ public:
     }
 
     AggregationIterator aggregationBegin() const {
-        LOG_ASSERT(mQueryType == ScanQueryType::AGGREGATION, "Query type not aggregation");
-        return AggregationIterator(mQueryData.get());
+        LOG_ASSERT(mQueryType == ScanQueryType::AGGREGATION || mQueryType == ScanQueryType::GROUP_BY,
+                "Query type not aggregation");
+        return AggregationIterator(mQueryData.get() + mAggregationOffset);
     }
 
     AggregationIterator aggregationEnd() const {
-        LOG_ASSERT(mQueryType == ScanQueryType::AGGREGATION, "Query type not aggregation");
+        LOG_ASSERT(mQueryType == ScanQueryType::AGGREGATION || mQueryType == ScanQueryType::GROUP_BY,
+                "Query type not aggregation");
         return AggregationIterator(mQueryData.get() + mQueryLength);
     }
 
+    ProjectionIterator groupByBegin() const {
+        LOG_ASSERT(mQueryType == ScanQueryType::GROUP_BY, "Query type not group by");
+        return ProjectionIterator(mQueryData.get() + sizeof(uint16_t));
+    }
+
+    ProjectionIterator groupByEnd() const {
+        LOG_ASSERT(mQueryType == ScanQueryType::GROUP_BY, "Query type not group by");
+        return ProjectionIterator(mQueryData.get() + sizeof(uint16_t) + groupByCount() * sizeof(Record::id_t));
+    }
+
+    /**
+     * @brief Number of columns the tuples are grouped by
+     */
+    uint16_t groupByCount() const {
+        LOG_ASSERT(mQueryType == ScanQueryType::GROUP_BY, "Query type not group by");
+        return *reinterpret_cast<const uint16_t*>(mQueryData.get());
+    }
+
+    /**
+     * @brief Smallest key (inclusive) of the tuples the scan is interested in
+     */
+    uint64_t lowKey() const {
+        return mLowKey;
+    }
+
+    /**
+     * @brief Largest key (exclusive) of the tuples the scan is interested in or UNBOUNDED_KEY if the range is open
+     */
+    uint64_t highKey() const {
+        return mHighKey;
+    }
+
+    /**
+     * @brief Whether the scan is restricted to a range of keys
+     */
+    bool hasKeyRange() const {
+        return (mLowKey != 0x0u || mHighKey != UNBOUNDED_KEY);
+    }
+
+    /**
+     * @brief Whether the key lies in the key range of the scan
+     */
+    bool inKeyRange(uint64_t key) const {
+        return (key >= mLowKey && (key < mHighKey || mHighKey == UNBOUNDED_KEY));
+    }
+
+    /**
+     * @brief Maximum number of tuples the scan returns or 0 if the scan has no limit
+     */
+    uint64_t limit() const {
+        return mLimit;
+    }
+
+    /**
+     * @brief Order of the tuples kept by a scan with a limit
+     */
+    ScanOrder order() const {
+        return mOrder;
+    }
+
+    /**
+     * @brief Whether the limit and order are supported by the query
+     *
+     * Limits are only supported on full and projection scans, ordered limits additionally require a fixed size numeric
+     * order column in the target schema.
+     */
+    bool validLimit() const;
+
+    /**
+     * @brief Claims one of the remaining tuples of an unordered limit
+     *
+     * @return Whether the tuple can still be written
+     */
+    bool claimTuple() {
+        auto remaining = mRemainingTuples.load();
+        while (remaining != 0u) {
+            if (mRemainingTuples.compare_exchange_weak(remaining, remaining - 1u)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Whether all tuples of an unordered limit were written and the query does not need any more tuples
+     */
+    bool limitReached() const {
+        return (mLimit != 0u && mOrder == ScanOrder::NONE && mRemainingTuples.load() == 0u);
+    }
+
+    /**
+     * @brief Whether the lhs tuple is ordered before the rhs tuple (both in the format of the target schema)
+     *
+     * Tuples where the order column is NULL are ordered last.
+     */
+    bool orderedBefore(const char* lhs, const char* rhs) const;
+
     const commitmanager::SnapshotDescriptor* snapshot() const {
         return mSnapshot.get();
     }
@@ -207,10 +344,67 @@ public:
         return mRecord;
     }
 
+    /**
+     * @brief Record containing the aggregation values of an aggregation or group by query
+     *
+     * For aggregations this is the target schema, for group by queries this only contains the aggregation values
+     * of a single group.
+     */
+    const Record& aggregationRecord() const {
+        return mAggregationRecord;
+    }
+
     uint32_t minimumLength() const {
         return mMinimumLength;
     }
 
+    /**
+     * @brief Initializes the aggregation values in the given tuple (in the aggregation record format)
+     *
+     * All nullable aggregation values are set to NULL until the first value is aggregated.
+     */
+    void initAggregation(char* data) const;
+
+    /**
+     * @brief Merges the aggregation values of the src tuple into the dest tuple (both in the aggregation record format)
+     */
+    void combineAggregation(char* dest, const char* src) const;
+
+    /**
+     * @brief Appends the group key of the tuple to the given string
+     *
+     * For every group by column the key contains one null byte (only if the column is nullable) followed by the value
+     * of the column (unless it is NULL). Variable sized values are prefixed with their 4 byte length.
+     *
+     * @param record Record of the tuple
+     * @param data Pointer to the tuple's data
+     * @param groupKey String to append the key to
+     */
+    void appendGroupKey(const Record& record, const char* data, std::string& groupKey) const;
+
+    /**
+     * @brief Registers a processor producing partial groups or ordered tuples for this query
+     */
+    void addPartialProcessor();
+
+    /**
+     * @brief Merges the partial groups of a processor with the partial groups of all previous processors
+     *
+     * @param groups Partial groups of the processor, contains the merged groups of all processors in case the
+     *     processor was the last one
+     * @return Whether the processor was the last one and has to write the groups
+     */
+    bool mergeGroups(GroupTable& groups);
+
+    /**
+     * @brief Merges the ordered tuples of a processor with the ordered tuples of all previous processors
+     *
+     * @param tuples Ordered tuples of the processor, contains the first limit tuples of all processors (in order) in
+     *     case the processor was the last one
+     * @return Whether the processor was the last one and has to write the tuples
+     */
+    bool mergeOrderedTuples(OrderedTuples& tuples);
+
     /**
      * @brief Acquires a new buffer
      */
@@ -263,19 +457,54 @@ private:
     /// The query data
     /// This is null when the query type is a full scan, the projection query in case the query type is a projection or
     /// an aggregation query in case the query type is an aggregation.
+    /// In case the query type is a group by the data contains 2 bytes for the number of group by columns, the 2 byte
+    /// column id of every group by column and (aligned to 4 bytes) the aggregation query.
     std::unique_ptr<char[]> mQueryData;
 
     /// Length of the query data string
     size_t mQueryLength;
 
+    /// Offset of the aggregation query into the query data
+    size_t mAggregationOffset;
+
+    /// Lower (inclusive) bound on the key of the tuples to scan
+    uint64_t mLowKey;
+
+    /// Upper (exclusive) bound on the key of the tuples to scan
+    uint64_t mHighKey;
+
+    /// Maximum number of tuples to return (or 0 if unlimited)
+    uint64_t mLimit;
+
+    /// Order of the tuples kept by the limit
+    ScanOrder mOrder;
+
+    /// Id of the order column in the target schema
+    Record::id_t mOrderField;
+
+    /// Number of tuples an unordered limit can still write
+    std::atomic<uint64_t> mRemainingTuples;
+
     /// Snapshot to check the validity of tuples against
     std::unique_ptr<commitmanager::SnapshotDescriptor> mSnapshot;
 
     /// Record containing the target schema
+    /// For group by queries the group by columns are named "0" to "n-1" followed by the aggregations.
     Record mRecord;
 
+    /// Record containing the aggregation values
+    Record mAggregationRecord;
+
     /// Minimum size a tuple requires (i.e. minimum static size)
     uint32_t mMinimumLength;
+
+    /// Partial groups and ordered tuples merged from all processors that have finished
+    std::mutex mPartialMutex;
+    GroupTable mGroups;
+    OrderedTuples mOrderedTuples;
+
+    /// Number of processors that have not yet merged their partial results
+    size_t mActivePartialProcessors;
 };
 
 /**
@@ -306,6 +535,13 @@ public:
         return mData;
     }
 
+    /**
+     * @brief Whether the query does not need any more tuples because its limit was reached
+     */
+    bool done() const {
+        return mData->limitReached();
+    }
+
     /**
      * @brief Process the tuple according to the query data associated with this processor
      *
@@ -319,6 +555,35 @@ public:
     template <typename Fun>
     void writeRecord(uint64_t key, uint32_t length, uint64_t validFrom, uint64_t validTo, Fun fun);
 
+    /**
+     * @brief Process the tuple according to the group by query associated with this processor
+     *
+     * Aggregates the tuple into the processor local aggregation state of its group.
+     *
+     * @param key Key of the tuple
+     * @param validFrom Valid-From version of the tuple
+     * @param validTo Valid-To version of the tuple
+     * @param keyFun Function to append the group key of the tuple to a string
+     * @param fun Function to aggregate the tuple into the aggregation state
+     */
+    template <typename KeyFun, typename Fun>
+    void writeGroupRecord(uint64_t key, uint64_t validFrom, uint64_t validTo, KeyFun keyFun, Fun fun);
+
+    /**
+     * @brief Looks up the aggregation state of the group the tuple belongs to
+     *
+     * Creates and initializes the state if the tuple is the first of its group. Allows callers to aggregate many tuples
+     * into their groups in a single pass after their states were collected.
+     *
+     * @param key Key of the tuple
+     * @param validFrom Valid-From version of the tuple
+     * @param validTo Valid-To version of the tuple
+     * @param keyFun Function to append the group key of the tuple to a string
+     * @return The aggregation state of the group or nullptr if the tuple is not part of the scan
+     */
+    template <typename KeyFun>
+    char* groupState(uint64_t key, uint64_t validFrom, uint64_t validTo, KeyFun keyFun);
+
     /**
      * @brief Initializes the aggregation tuple
      *
@@ -326,6 +591,20 @@ public:
      */
     void initAggregationRecord();
 
+    /**
+     * @brief Initializes the group aggregation
+     *
+     * The groups are kept local to the processor until it finishes.
+     */
+    void initGroupAggregation();
+
+    /**
+     * @brief Initializes the ordered limit
+     *
+     * The first tuples in order are kept local to the processor until it finishes.
+     */
+    void initOrderedLimit();
+
 //private:
     /**
      * @brief Ensures that the buffer can hold at least the number of bytes
@@ -336,6 +615,21 @@ public:
      */
     void ensureBufferSpace(uint32_t length);
 
+    /**
+     * @brief Writes one tuple for every group into the buffer
+     */
+    void writeGroups();
+
+    /**
+     * @brief Keeps the tuple materialized in mOrderedTuple if it is among the first limit tuples in order
+     */
+    void addOrderedTuple(uint64_t key);
+
+    /**
+     * @brief Writes the ordered tuples into the buffer
+     */
+    void writeOrderedTuples();
+
     /// Shared data holding information about the scan
     ScanQuery* mData;
 
@@ -350,10 +644,26 @@ public:
 
     /// Number of tuples written to the buffer
     uint16_t mTupleCount;
+
+    /// Processor local aggregation state of every group
+    ScanQuery::GroupTable mGroups;
+
+    /// Group key of the current tuple (kept to reuse its memory)
+    std::string mGroupKey;
+
+    /// Processor local heap of the first tuples in order (the top element is ordered last)
+    ScanQuery::OrderedTuples mOrderedTuples;
+
+    /// Current tuple of an ordered limit (kept to reuse its memory)
+    std::string mOrderedTuple;
 };
 
 template <typename Fun>
 void ScanQueryProcessor::writeRecord(uint64_t key, uint32_t length, uint64_t validFrom, uint64_t validTo, Fun fun) {
+    if (!mData->inKeyRange(key)) {
+        return;
+    }
+
     auto snapshot = mData->snapshot();
     if (snapshot && !snapshot->inReadSet(validFrom, validTo)) {
         return;
@@ -361,7 +671,19 @@ void ScanQueryProcessor::writeRecord(uint64_t key, uint32_t length, uint64_t val
 
     if (mData->queryType() == ScanQueryType::AGGREGATION) {
         fun(mBuffer + 8);
+    } else if (mData->order() != ScanOrder::NONE) {
+        // Materialize the tuple to check if it belongs to the first tuples in order
+        mOrderedTuple.resize(length);
+        auto bytesWritten = fun(&mOrderedTuple[0]);
+        LOG_ASSERT(bytesWritten <= length, "Bytes written must be smaller than the length");
+        mOrderedTuple.resize(bytesWritten);
+
+        addOrderedTuple(key);
     } else {
+        if (mData->limit() != 0u && !mData->claimTuple()) {
+            return;
+        }
+
         ensureBufferSpace(length + TUPLE_OVERHEAD);
 
         // Write key
@@ -377,5 +699,35 @@ void ScanQueryProcessor::writeRecord(uint64_t key, uint32_t length, uint64_t val
     }
 }
 
+template <typename KeyFun, typename Fun>
+void ScanQueryProcessor::writeGroupRecord(uint64_t key, uint64_t validFrom, uint64_t validTo, KeyFun keyFun,
+        Fun fun) {
+    if (auto state = groupState(key, validFrom, validTo, keyFun)) {
+        fun(state);
+    }
+}
+
+template <typename KeyFun>
+char* ScanQueryProcessor::groupState(uint64_t key, uint64_t validFrom, uint64_t validTo, KeyFun keyFun) {
+    if (!mData->inKeyRange(key)) {
+        return nullptr;
+    }
+
+    auto snapshot = mData->snapshot();
+    if (snapshot && !snapshot->inReadSet(validFrom, validTo)) {
+        return nullptr;
+    }
+
+    mGroupKey.clear();
+    keyFun(mGroupKey);
+
+    auto& state = mGroups[mGroupKey];
+    if (!state) {
+        state.reset(new char[mData->aggregationRecord().staticSize()]);
+        mData->initAggregation(state.get());
+    }
+    return state.get();
+}
+
 } //namespace store
 } //namespace tell
@@ -0,0 +1,325 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#include "SecondaryIndex.hpp"
+
+#include "Checkpoint.hpp"
+
+#include <crossbow/allocator.hpp>
+#include <crossbow/logger.hpp>
+
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+namespace tell {
+namespace store {
+
+SecondaryIndex::SecondaryIndex(std::vector<Record::id_t> fields)
+        : mFields(std::move(fields)),
+          mHead(std::string(), 0x0u, 0x0u, MAX_HEIGHT),
+          mSize(0x0u) {
+}
+
+SecondaryIndex::~SecondaryIndex() {
+    for (auto node = pointer(mHead.next[0].load()); node != nullptr;) {
+        auto next = pointer(node->next[0].load());
+        crossbow::allocator::destroy_now(node);
+        node = next;
+    }
+}
+
+bool SecondaryIndex::insert(const std::string& indexKey, uint64_t key, uint64_t version) {
+    Node* preds[MAX_HEIGHT];
+    Node* succs[MAX_HEIGHT];
+
+    Node* node = nullptr;
+    while (true) {
+        if (find(indexKey, key, version, preds, succs)) {
+            if (node) {
+                crossbow::allocator::destroy_now(node);
+            }
+            return false;
+        }
+
+        if (!node) {
+            node = crossbow::allocator::construct<Node>(indexKey, key, version, randomHeight());
+        }
+        for (decltype(node->height) i = 0; i < node->height; ++i) {
+            node->next[i].store(reinterpret_cast<uintptr_t>(succs[i]));
+        }
+
+        // The entry is part of the index as soon as it is linked into the lowest level
+        auto expected = reinterpret_cast<uintptr_t>(succs[0]);
+        if (preds[0]->next[0].compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(node))) {
+            break;
+        }
+    }
+
+    for (decltype(node->height) i = 1; i < node->height; ++i) {
+        while (true) {
+            auto expected = reinterpret_cast<uintptr_t>(succs[i]);
+            if (preds[i]->next[i].compare_exchange_strong(expected, reinterpret_cast<uintptr_t>(node))) {
+                break;
+            }
+
+            // The predecessor changed - Search the new position and update the successor of the node on this level
+            find(indexKey, key, version, preds, succs);
+            auto next = node->next[i].load();
+            if (isMarked(next) || !node->next[i].compare_exchange_strong(next, reinterpret_cast<uintptr_t>(succs[i]))) {
+                LOG_ASSERT(false, "Entry was removed while being inserted");
+                break;
+            }
+        }
+    }
+    node->linked.store(true);
+
+    ++mSize;
+    return true;
+}
+
+void SecondaryIndex::writeCheckpoint(CheckpointWriter& writer) const {
+    range(std::string(), std::string(), [&writer] (const std::string& indexKey, uint64_t key, uint64_t version) {
+        writer.write<uint32_t>(indexKey.size() + 1);
+        writer.write<uint64_t>(key);
+        writer.write<uint64_t>(version);
+        writer.write(indexKey.data(), indexKey.size());
+        return true;
+    });
+    writer.write<uint32_t>(0x0u);
+}
+
+void SecondaryIndex::readCheckpoint(CheckpointReader& reader) {
+    while (auto size = reader.read<uint32_t>()) {
+        auto key = reader.read<uint64_t>();
+        auto version = reader.read<uint64_t>();
+        std::string indexKey(size - 1, '\0');
+        reader.read(&indexKey[0], indexKey.size());
+        insert(indexKey, key, version);
+    }
+}
+
+int SecondaryIndex::compare(const Node* node, const std::string& indexKey, uint64_t key, uint64_t version) {
+    auto res = node->indexKey.compare(indexKey);
+    if (res != 0) {
+        return res;
+    }
+    if (node->key != key) {
+        return (node->key < key ? -1 : 1);
+    }
+    if (node->version != version) {
+        return (node->version < version ? -1 : 1);
+    }
+    return 0;
+}
+
+uint32_t SecondaryIndex::randomHeight() {
+    static thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 0x1u;
+
+    // Xorshift random number generator
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    auto random = state * 0x2545F4914F6CDD1Du;
+
+    // Every level is reached with a probability of 1/4
+    uint32_t height = 1;
+    for (; height < MAX_HEIGHT && (random & 0x3u) == 0x0u; ++height, random >>= 2) {
+    }
+    return height;
+}
+
+bool SecondaryIndex::find(const std::string& indexKey, uint64_t key, uint64_t version, Node** preds, Node** succs) {
+retry:
+    auto pred = &mHead;
+    Node* curr = nullptr;
+    for (auto level = MAX_HEIGHT; level > 0; --level) {
+        auto i = level - 1;
+        curr = pointer(pred->next[i].load());
+        while (curr != nullptr) {
+            auto succ = curr->next[i].load();
+
+            // Unlink the deleted nodes from the level
+            while (isMarked(succ)) {
+                auto expected = reinterpret_cast<uintptr_t>(curr);
+                if (!pred->next[i].compare_exchange_strong(expected, succ & ~static_cast<uintptr_t>(0x1u))) {
+                    goto retry;
+                }
+                curr = pointer(succ);
+                if (curr == nullptr) {
+                    break;
+                }
+                succ = curr->next[i].load();
+            }
+            if (curr == nullptr || compare(curr, indexKey, key, version) >= 0) {
+                break;
+            }
+            pred = curr;
+            curr = pointer(succ);
+        }
+        preds[i] = pred;
+        succs[i] = curr;
+    }
+    return (curr != nullptr && compare(curr, indexKey, key, version) == 0);
+}
+
+const SecondaryIndex::Node* SecondaryIndex::lowerBound(const std::string& indexKey) const {
+    auto pred = &mHead;
+    for (auto level = MAX_HEIGHT; level > 0; --level) {
+        auto i = level - 1;
+        for (auto curr = pointer(pred->next[i].load()); curr != nullptr && curr->indexKey.compare(indexKey) < 0;
+                curr = pointer(curr->next[i].load())) {
+            pred = curr;
+        }
+    }
+    return pred;
+}
+
+bool SecondaryIndex::remove(Node* node) {
+    // Mark the upper levels first so no new node is linked behind the node after it was removed from the lowest level
+    for (auto i = node->height - 1; i > 0; --i) {
+        auto next = node->next[i].load();
+        while (!isMarked(next) && !node->next[i].compare_exchange_strong(next, next | 0x1u)) {
+        }
+    }
+
+    // The node is removed by whoever marks the lowest level
+    auto next = node->next[0].load();
+    while (true) {
+        if (isMarked(next)) {
+            return false;
+        }
+        if (node->next[0].compare_exchange_strong(next, next | 0x1u)) {
+            break;
+        }
+    }
+
+    // Unlink the node from all levels before it is released
+    Node* preds[MAX_HEIGHT];
+    Node* succs[MAX_HEIGHT];
+    find(node->indexKey, node->key, node->version, preds, succs);
+
+    --mSize;
+    crossbow::allocator::destroy(node);
+    return true;
+}
+
+SecondaryIndexes::SecondaryIndexes(const Record& record)
+        : mRecord(record),
+          mModified(nullptr),
+          mModifiedAll(false) {
+    for (auto& index : mRecord.schema().indexes()) {
+        mIndexes.emplace(index.first, std::unique_ptr<SecondaryIndex>(new SecondaryIndex(index.second.second)));
+    }
+}
+
+SecondaryIndexes::~SecondaryIndexes() {
+    auto modification = mModified.load();
+    while (modification) {
+        auto next = modification->next;
+        delete modification;
+        modification = next;
+    }
+}
+
+void SecondaryIndexes::insert(uint64_t key, const char* data, uint64_t version) {
+    for (auto& index : mIndexes) {
+        index.second->insert(mRecord.indexKey(data, index.second->fields()), key, version);
+    }
+    modified(key, version);
+}
+
+void SecondaryIndexes::modified(uint64_t key, uint64_t version) {
+    if (mIndexes.empty()) {
+        return;
+    }
+
+    auto modification = new Modification(key, version);
+    pushModified(modification, modification);
+}
+
+std::unordered_set<uint64_t> SecondaryIndexes::takeModified(uint64_t minVersion, bool& all) {
+    all = mModifiedAll.exchange(false);
+    auto modification = mModified.exchange(nullptr);
+
+    std::unordered_set<uint64_t> keys;
+    Modification* pendingFirst = nullptr;
+    Modification* pendingLast = nullptr;
+    while (modification) {
+        auto next = modification->next;
+        if (modification->version <= minVersion) {
+            keys.emplace(modification->key);
+            delete modification;
+        } else {
+            modification->next = pendingFirst;
+            pendingFirst = modification;
+            if (!pendingLast) {
+                pendingLast = modification;
+            }
+        }
+        modification = next;
+    }
+
+    if (pendingFirst) {
+        pushModified(pendingFirst, pendingLast);
+    }
+    return keys;
+}
+
+void SecondaryIndexes::pushModified(Modification* first, Modification* last) {
+    auto head = mModified.load();
+    do {
+        last->next = head;
+    } while (!mModified.compare_exchange_weak(head, first));
+}
+
+void SecondaryIndexes::writeCheckpoint(CheckpointWriter& writer) const {
+    writer.write<uint64_t>(mIndexes.size());
+    for (auto& index : mIndexes) {
+        writer.write<uint32_t>(index.first.size());
+        writer.write(index.first.data(), index.first.size());
+        index.second->writeCheckpoint(writer);
+    }
+}
+
+void SecondaryIndexes::readCheckpoint(CheckpointReader& reader) {
+    auto count = reader.read<uint64_t>();
+    for (decltype(count) i = 0; i < count; ++i) {
+        auto nameLength = reader.read<uint32_t>();
+        std::unique_ptr<char[]> name(new char[nameLength]);
+        reader.read(name.get(), nameLength);
+
+        auto index = find(crossbow::string(name.get(), nameLength));
+        if (!index) {
+            LOG_ERROR("Checkpoint contains unknown index %1%", crossbow::string(name.get(), nameLength));
+            throw std::runtime_error("Unknown index in checkpoint");
+        }
+        index->readCheckpoint(reader);
+    }
+
+    // The restored entries might refer to records modified before the checkpoint
+    mModifiedAll.store(true);
+}
+
+} // namespace store
+} // namespace tell
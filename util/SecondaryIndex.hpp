@@ -0,0 +1,321 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#pragma once
+
+#include <tellstore/Record.hpp>
+
+#include <crossbow/non_copyable.hpp>
+#include <crossbow/string.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace tell {
+namespace store {
+
+class CheckpointReader;
+class CheckpointWriter;
+
+/**
+ * @brief Lock-Free ordered secondary index over the fields of a table
+ *
+ * The index is a concurrent skip list associating the encoded values of the indexed fields (see Record::indexKey) with
+ * the key of the record and the version of the write producing these values. The entries are ordered by index key, key
+ * and version.
+ *
+ * Entries are never modified: Every insert and update of a record adds an entry for the new values and the entries are
+ * only removed by the garbage collection once no active snapshot can read them. An entry might thus refer to values
+ * that were overwritten in the meantime and lookups have to verify it against the record visible in their snapshot.
+ *
+ * Interactions with the index must be made while in an active epoch which manages all entries.
+ */
+class SecondaryIndex : crossbow::non_copyable, crossbow::non_movable {
+public:
+    /// Maximum height of the skip list
+    static constexpr uint32_t MAX_HEIGHT = 16;
+
+    SecondaryIndex(std::vector<Record::id_t> fields);
+
+    ~SecondaryIndex();
+
+    /**
+     * @brief The indexed fields in the order they are encoded in the index key
+     */
+    const std::vector<Record::id_t>& fields() const {
+        return mFields;
+    }
+
+    /**
+     * @brief Number of entries in the index
+     */
+    size_t size() const {
+        return mSize.load();
+    }
+
+    /**
+     * @brief Adds an entry associating the index key with the given key and version
+     *
+     * @return False if the entry already exists
+     */
+    bool insert(const std::string& indexKey, uint64_t key, uint64_t version);
+
+    /**
+     * @brief Invokes the function for every entry with an index key in the range [lower, upper]
+     *
+     * The index keys are compared to the upper bound on the length of the bound only: A bound encoding the values of
+     * the leading fields includes all entries starting with these values. An empty bound leaves the range open on that
+     * side.
+     *
+     * @param fun Function taking the index key, key and version of the entry and returning false to stop the iteration
+     */
+    template <typename Fun>
+    void range(const std::string& lower, const std::string& upper, Fun fun) const;
+
+    /**
+     * @brief Removes all entries for which the predicate returns true
+     *
+     * Entries still being inserted are skipped. Must not be called concurrently with another removeIf.
+     *
+     * @param fun Predicate taking the index key, key and version of the entry
+     * @return Number of removed entries
+     */
+    template <typename Fun>
+    size_t removeIf(Fun fun);
+
+    /**
+     * @brief Writes all entries to the checkpoint
+     */
+    void writeCheckpoint(CheckpointWriter& writer) const;
+
+    /**
+     * @brief Restores the entries written by writeCheckpoint
+     */
+    void readCheckpoint(CheckpointReader& reader);
+
+private:
+    struct Node : crossbow::non_copyable, crossbow::non_movable {
+        Node(std::string _indexKey, uint64_t _key, uint64_t _version, uint32_t _height)
+                : indexKey(std::move(_indexKey)),
+                  key(_key),
+                  version(_version),
+                  height(_height),
+                  linked(false),
+                  next(new std::atomic<uintptr_t>[_height]) {
+            for (decltype(height) i = 0; i < height; ++i) {
+                next[i].store(0x0u);
+            }
+        }
+
+        std::string indexKey;
+        uint64_t key;
+        uint64_t version;
+        uint32_t height;
+
+        /// Whether the node was linked into all levels of the skip list
+        std::atomic<bool> linked;
+
+        /// Successor on every level, the lowest bit marks the node as deleted on that level
+        std::unique_ptr<std::atomic<uintptr_t>[]> next;
+    };
+
+    static Node* pointer(uintptr_t ptr) {
+        return reinterpret_cast<Node*>(ptr & ~static_cast<uintptr_t>(0x1u));
+    }
+
+    static bool isMarked(uintptr_t ptr) {
+        return (ptr & 0x1u) != 0x0u;
+    }
+
+    static int compare(const Node* node, const std::string& indexKey, uint64_t key, uint64_t version);
+
+    static uint32_t randomHeight();
+
+    /**
+     * @brief Searches the predecessor and successor of the entry on every level
+     *
+     * Unlinks all deleted nodes encountered during the search.
+     *
+     * @return Whether the entry exists (i.e. it is the successor on the lowest level)
+     */
+    bool find(const std::string& indexKey, uint64_t key, uint64_t version, Node** preds, Node** succs);
+
+    /**
+     * @brief Finds the node preceding the first entry with an index key not less than the given key
+     */
+    const Node* lowerBound(const std::string& indexKey) const;
+
+    /**
+     * @brief Marks the node as deleted on all levels and unlinks it
+     *
+     * @return Whether the node was removed by this call
+     */
+    bool remove(Node* node);
+
+    std::vector<Record::id_t> mFields;
+    Node mHead;
+    std::atomic<size_t> mSize;
+};
+
+template <typename Fun>
+void SecondaryIndex::range(const std::string& lower, const std::string& upper, Fun fun) const {
+    for (auto node = pointer(lowerBound(lower)->next[0].load()); node != nullptr;) {
+        auto next = node->next[0].load();
+
+        if (!upper.empty() && memcmp(node->indexKey.data(), upper.data(),
+                std::min(node->indexKey.size(), upper.size())) > 0) {
+            break;
+        }
+        if (!isMarked(next) && !fun(node->indexKey, node->key, node->version)) {
+            break;
+        }
+        node = pointer(next);
+    }
+}
+
+template <typename Fun>
+size_t SecondaryIndex::removeIf(Fun fun) {
+    size_t removed = 0;
+    for (auto node = pointer(mHead.next[0].load()); node != nullptr;) {
+        auto next = node->next[0].load();
+
+        if (!isMarked(next) && node->linked.load() && fun(node->indexKey, node->key, node->version) && remove(node)) {
+            ++removed;
+
+            // The successor can only be unlinked by another remove so the pointer stays valid after the removal
+            next = node->next[0].load();
+        }
+        node = pointer(next);
+    }
+    return removed;
+}
+
+/**
+ * @brief The secondary indexes of a table as declared in its schema
+ */
+class SecondaryIndexes : crossbow::non_copyable, crossbow::non_movable {
+public:
+    using IndexMap = std::unordered_map<crossbow::string, std::unique_ptr<SecondaryIndex>>;
+
+    SecondaryIndexes(const Record& record);
+
+    ~SecondaryIndexes();
+
+    bool empty() const {
+        return mIndexes.empty();
+    }
+
+    const IndexMap& indexes() const {
+        return mIndexes;
+    }
+
+    /**
+     * @brief Looks up the index with the given name
+     *
+     * @return The index or null if the table has no index with this name
+     */
+    SecondaryIndex* find(const crossbow::string& name) const {
+        auto i = mIndexes.find(name);
+        return (i == mIndexes.end() ? nullptr : i->second.get());
+    }
+
+    /**
+     * @brief Adds the values of the record written with the given version to all indexes
+     *
+     * The record is marked as modified by the version.
+     */
+    void insert(uint64_t key, const char* data, uint64_t version);
+
+    /**
+     * @brief Marks the record as modified (inserted, updated, removed or reverted) by the given version
+     *
+     * Index entries only become obsolete when their record is modified, the garbage collection only checks the entries
+     * of modified records. Lock-free, the modification is pushed onto a list taken by the garbage collection.
+     */
+    void modified(uint64_t key, uint64_t version);
+
+    /**
+     * @brief Takes the keys of all records modified by a version not newer than the given version
+     *
+     * Modifications by newer versions are kept until they are no longer newer than the version passed to a later call.
+     * Must only be called by one thread at a time.
+     *
+     * @param minVersion Lowest version still read by an active snapshot
+     * @param all Set to whether the entries of all records have to be checked (e.g. after restoring a checkpoint)
+     */
+    std::unordered_set<uint64_t> takeModified(uint64_t minVersion, bool& all);
+
+    /**
+     * @brief Writes the entries of all indexes to the checkpoint
+     */
+    void writeCheckpoint(CheckpointWriter& writer) const;
+
+    /**
+     * @brief Restores the entries written by writeCheckpoint
+     */
+    void readCheckpoint(CheckpointReader& reader);
+
+private:
+    /**
+     * @brief Key and version of a modification not yet taken by the garbage collection
+     */
+    struct Modification {
+        Modification(uint64_t k, uint64_t v)
+                : key(k),
+                  version(v),
+                  next(nullptr) {
+        }
+
+        uint64_t key;
+        uint64_t version;
+        Modification* next;
+    };
+
+    /**
+     * @brief Pushes the chain of modifications from first to last onto the modification list
+     */
+    void pushModified(Modification* first, Modification* last);
+
+    const Record& mRecord;
+    IndexMap mIndexes;
+
+    /// Head of the list of all modifications not yet taken by the garbage collection
+    ///
+    /// Writers only push onto the list while the garbage collection always takes the complete list at once, as such
+    /// the list is not subject to the ABA problem.
+    std::atomic<Modification*> mModified;
+
+    /// Whether the entries of all records have to be checked
+    std::atomic<bool> mModifiedAll;
+};
+
+} // namespace store
+} // namespace tell
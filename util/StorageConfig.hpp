@@ -25,13 +25,51 @@
 #include <cstdint>
 #include <config.h>
 
+#include <crossbow/string.hpp>
+
 namespace tell {
 namespace store {
+
+/**
+ * @brief Type of pages backing the memory region of the page manager
+ */
+enum class HugePageMode {
+    /// Regular pages of the operating system
+    NONE,
+
+    /// Transparent huge pages requested with madvise
+    TRANSPARENT,
+
+    /// Huge pages reserved in the hugetlbfs pool
+    EXPLICIT,
+};
+
+inline const char* hugePageModeName(HugePageMode mode) {
+    switch (mode) {
+    case HugePageMode::TRANSPARENT:
+        return "transparent";
+    case HugePageMode::EXPLICIT:
+        return "explicit";
+    default:
+        return "none";
+    }
+}
+
 struct StorageConfig {
     uint16_t gcInterval = 60;
     size_t totalMemory = TOTAL_MEMORY;
+    HugePageMode hugePages = HugePageMode::TRANSPARENT;
     size_t numScanThreads = 2;
     size_t hashMapCapacity = HASHMAP_CAPACITY;
+    bool hashMapPerTable = false;
+    size_t scanCodeCacheCapacity = 256;
+    size_t maxActiveScans = 4;
+    size_t scanQuantum = 1;
+    size_t scanRoundSize = 16;
+    crossbow::string redoLogPath;
+    uint32_t redoLogSyncInterval = 10;
+    bool redoLogSyncOnCommit = false;
+    uint32_t checkpointInterval = 0;
 };
 } // namespace store
 } // namespace tell
@@ -22,22 +22,40 @@
  */
 #pragma once
 
+#include <config.h>
+#include "Checkpoint.hpp"
+#include "PageManager.hpp"
+#include "RedoLog.hpp"
 #include "StorageConfig.hpp"
 #include "Scan.hpp"
 #include "VersionManager.hpp"
+#include "WriteOperation.hpp"
 
+#include <tellstore/ErrorCode.hpp>
 #include <tellstore/Record.hpp>
+#include <tellstore/StdTypes.hpp>
 
 #include <commitmanager/SnapshotDescriptor.hpp>
 
+#include <crossbow/alignment.hpp>
 #include <crossbow/allocator.hpp>
+#include <crossbow/byte_buffer.hpp>
 #include <crossbow/concurrent_map.hpp>
+#include <crossbow/enum_underlying.hpp>
 #include <crossbow/string.hpp>
 
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
 #include <thread>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
+#include <cstring>
+#include <functional>
+#include <string>
 #include <vector>
 #include <atomic>
 
@@ -73,6 +91,7 @@ private:
     PageManager& mPageManager;
     VersionManager& mVersionManager;
     ScanManager<Table> mScanManager;
+    std::unique_ptr<RedoLog> mRedoLog;
     std::atomic<bool> mShutDown;
     mutable tbb::spin_rw_mutex mTablesMutex;
     tbb::concurrent_unordered_map<crossbow::string, uint64_t> mNames;
@@ -86,6 +105,7 @@ private:
         std::unique_lock<std::mutex> lock(mGCMutex);
         auto begin = Clock::now();
         auto duration = std::chrono::seconds(mConfig.gcInterval);
+        auto lastCheckpoint = begin;
         while (!mShutDown.load()) {
             auto now = Clock::now();
             if (begin + duration > now) {
@@ -93,15 +113,25 @@ private:
             }
             if (mShutDown.load()) return;
             begin = Clock::now();
-            std::vector<Table*> tables;
-            tables.reserve(mNames.size());
-            {
-                typename decltype(mTablesMutex)::scoped_lock _(mTablesMutex, false);
-                for (auto& p : mTables) {
-                    tables.push_back(p.second);
+
+            // All tables and records logged before this point are contained in the main after the GC run
+            auto checkpoint = (mRedoLog && mConfig.checkpointInterval != 0u
+                    && lastCheckpoint + std::chrono::seconds(mConfig.checkpointInterval) <= begin);
+            uint64_t redoOffset = 0u;
+            if (checkpoint) {
+                try {
+                    redoOffset = mRedoLog->sync();
+                } catch (std::system_error& e) {
+                    LOG_ERROR("Error while syncing redo log [error = %1%]", e.what());
+                    checkpoint = false;
                 }
             }
-            mGC.run(tables, mVersionManager.lowestActiveVersion());
+
+            auto tables = collectGarbage();
+            if (checkpoint) {
+                writeCheckpoint(tables, redoOffset, SupportsCheckpoint<Table>());
+                lastCheckpoint = begin;
+            }
         }
     }
 
@@ -111,15 +141,20 @@ public:
         , mGC(gc)
         , mPageManager(pageManager)
         , mVersionManager(versionManager)
-        , mScanManager(config.numScanThreads)
+        , mScanManager(config)
         , mShutDown(false)
         , mLastTableIdx(0)
         , mGCThread(std::bind(&TableManager::gcThread, this))
     {
+        // Run the garbage collection early when the storage runs low on memory
+        mPageManager.setPressureCallback([this] () {
+            forceGC();
+        });
         mScanManager.run();
     }
 
     ~TableManager() {
+        mPageManager.setPressureCallback(std::function<void()>());
         mShutDown.store(true);
         mStopCondition.notify_all();
         mGCThread.join();
@@ -133,6 +168,43 @@ public:
         return mConfig;
     }
 
+    /**
+     * @brief Recovers the tables from the last checkpoint and the redo log and starts logging all subsequent
+     *        modifications
+     *
+     * Does nothing if no redo log is configured. Must be called before the first request is processed.
+     *
+     * @param args Additional arguments passed to createTable when recreating the logged tables
+     */
+    template <typename... Args>
+    void openRedoLog(Args&&... args) {
+        if (mConfig.redoLogPath.empty()) {
+            return;
+        }
+
+        auto redoOffset = readCheckpoint(SupportsCheckpoint<Table>(), args...);
+
+        crossbow::allocator _;
+        auto count = RedoLog::replay(mConfig.redoLogPath, redoOffset,
+                [this, &args...] (RedoRecordType type, const RedoLogEntry& record, uint32_t size) {
+            replayRecord(type, record, size, args...);
+        });
+        LOG_INFO("Replayed %1% records from redo log", count);
+
+        mRedoLog.reset(new RedoLog(mPageManager, mConfig.redoLogPath, mConfig.redoLogSyncInterval));
+    }
+
+    /**
+     * @brief Forces all modifications logged so far to disk
+     *
+     * Called before a transaction completion is acknowledged, does nothing if the redo log is only synced periodically.
+     */
+    void syncRedoLog() {
+        if (mRedoLog && mConfig.redoLogSyncOnCommit) {
+            mRedoLog->sync();
+        }
+    }
+
     template <typename... Args>
     bool createTable(const crossbow::string& name,
                      const Schema& schema,
@@ -152,11 +224,31 @@ public:
             }
         }
 
+        // The table must not be created if its creation can not be logged, its records would be skipped on replay
+        size_t size = 0u;
+        std::unique_ptr<char[]> data;
+        if (mRedoLog) {
+            data = serializeTable(name, schema, size);
+        }
+        RedoRecord redoRecord(RedoRecordType::CREATE_TABLE, idx, 0x0u, 0x0u, data.get(), size);
+        RedoLogEntry* redoEntry = nullptr;
+        if (mRedoLog) {
+            redoEntry = mRedoLog->reserve(redoRecord);
+            if (!redoEntry) {
+                mNames.erase(name);
+                return false;
+            }
+        }
+
         auto ptr = crossbow::allocator::construct<Table>(mPageManager, name, schema, idx, std::forward<Args>(args)...);
         LOG_ASSERT(ptr, "Unable to allocate table");
         __attribute__((unused)) auto res = mTables.insert(std::make_pair(idx, ptr));
         LOG_ASSERT(res.second, "Insert with unique id failed");
 
+        if (redoEntry) {
+            mRedoLog->complete(redoEntry, redoRecord);
+        }
+
         return true;
     }
 
@@ -193,13 +285,58 @@ public:
         });
     }
 
+    /**
+     * @brief Reads the tuples of all keys from the table with a single snapshot
+     *
+     * The keys are resolved in groups of MULTI_GET_PREFETCH_SIZE: Prefetches for the hash table buckets of all keys in
+     * the group are issued first, then prefetches for their record headers and only then the records are read. This
+     * overlaps the cache misses of the independent lookups instead of stalling on every one of them.
+     *
+     * @param fun The materialization function taking the key index, size, version and whether the tuple is the newest
+     *   one and returning a pointer where the result will be written
+     * @param errorFun Function taking the key index and error code invoked for every key that could not be read
+     * @return Error code or 0 if the table exists
+     */
+    template <typename Fun, typename ErrorFun>
+    int multiGet(uint64_t tableId, const uint64_t* keys, size_t count,
+            const commitmanager::SnapshotDescriptor& snapshot, Fun fun, ErrorFun errorFun)
+    {
+        crossbow::allocator _;
+        mVersionManager.addSnapshot(snapshot);
+        return executeTable(tableId, [keys, count, &snapshot, &fun, &errorFun] (Table* table) {
+            for (size_t groupStart = 0; groupStart < count; groupStart += MULTI_GET_PREFETCH_SIZE) {
+                auto groupEnd = std::min(groupStart + MULTI_GET_PREFETCH_SIZE, count);
+                for (auto i = groupStart; i < groupEnd; ++i) {
+                    table->prefetch(keys[i]);
+                }
+                for (auto i = groupStart; i < groupEnd; ++i) {
+                    table->prefetchRecord(keys[i]);
+                }
+                for (auto i = groupStart; i < groupEnd; ++i) {
+                    auto ec = table->get(keys[i], snapshot, [i, &fun] (size_t size, uint64_t version, bool isNewest) {
+                        return fun(i, size, version, isNewest);
+                    });
+                    if (ec) {
+                        errorFun(i, ec);
+                    }
+                }
+            }
+            return 0;
+        });
+    }
+
     int update(uint64_t tableId, uint64_t key, size_t size, const char* data,
             const commitmanager::SnapshotDescriptor& snapshot)
     {
         crossbow::allocator _;
         mVersionManager.addSnapshot(snapshot);
-        return executeTable(tableId, [key, size, data, &snapshot] (Table* table) {
-            return table->update(key, size, data, snapshot);
+        RedoRecord record(RedoRecordType::UPDATE, tableId, key, snapshot.version(), data, size);
+        return executeLogged(record, [key, size, data, &snapshot] (Table* table) {
+            auto ec = table->update(key, size, data, snapshot);
+            if (!ec) {
+                table->indexes().insert(key, data, snapshot.version());
+            }
+            return ec;
         });
     }
 
@@ -208,8 +345,13 @@ public:
     {
         crossbow::allocator _;
         mVersionManager.addSnapshot(snapshot);
-        return executeTable(tableId, [key, size, data, &snapshot] (Table* table) {
-            return table->insert(key, size, data, snapshot);
+        RedoRecord record(RedoRecordType::INSERT, tableId, key, snapshot.version(), data, size);
+        return executeLogged(record, [key, size, data, &snapshot] (Table* table) {
+            auto ec = table->insert(key, size, data, snapshot);
+            if (!ec) {
+                table->indexes().insert(key, data, snapshot.version());
+            }
+            return ec;
         });
     }
 
@@ -217,8 +359,13 @@ public:
     {
         crossbow::allocator _;
         mVersionManager.addSnapshot(snapshot);
-        return executeTable(tableId, [key, &snapshot] (Table* table) {
-            return table->remove(key, snapshot);
+        RedoRecord record(RedoRecordType::REMOVE, tableId, key, snapshot.version(), nullptr, 0u);
+        return executeLogged(record, [key, &snapshot] (Table* table) {
+            auto ec = table->remove(key, snapshot);
+            if (!ec) {
+                table->indexes().modified(key, snapshot.version());
+            }
+            return ec;
         });
     }
 
@@ -226,8 +373,143 @@ public:
     {
         crossbow::allocator _;
         mVersionManager.addSnapshot(snapshot);
-        return executeTable(tableId, [key, &snapshot] (Table* table) {
-            return table->revert(key, snapshot);
+        RedoRecord record(RedoRecordType::REVERT, tableId, key, snapshot.version(), nullptr, 0u);
+        return executeLogged(record, [key, &snapshot] (Table* table) {
+            auto ec = table->revert(key, snapshot);
+            if (!ec) {
+                table->indexes().modified(key, snapshot.version());
+            }
+            return ec;
+        });
+    }
+
+    /**
+     * @brief Executes all modifications of the batch with a single snapshot
+     *
+     * The modifications are executed in order, a failed modification does not abort the remaining ones. Consecutive
+     * modifications on the same table are executed as one batch on the table so their log space is reserved together.
+     * The redo records of all modifications are reserved together before they are executed, modifications whose
+     * record could not be reserved are not executed and fail.
+     *
+     * @param operations The modifications to execute
+     * @param count Number of modifications in the batch
+     * @param results Array receiving the error code (or 0 on success) of every modification
+     */
+    void batchWrite(const WriteOperation* operations, size_t count, const commitmanager::SnapshotDescriptor& snapshot,
+            int* results)
+    {
+        crossbow::allocator _;
+        mVersionManager.addSnapshot(snapshot);
+
+        std::vector<RedoRecord> redoRecords;
+        std::vector<RedoLogEntry*> redoEntries;
+        auto reserved = count;
+        if (mRedoLog) {
+            redoRecords.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                auto& op = operations[i];
+                redoRecords.emplace_back(redoRecordType(op.type), op.tableId, op.key, snapshot.version(), op.data,
+                        op.size);
+            }
+            redoEntries.resize(count, nullptr);
+            reserved = mRedoLog->reserve(redoRecords.data(), count, redoEntries.data());
+            std::fill(results + reserved, results + count, error::out_of_memory);
+        }
+
+        for (size_t begin = 0; begin < reserved;) {
+            auto tableId = operations[begin].tableId;
+            auto end = begin + 1;
+            while (end < reserved && operations[end].tableId == tableId) {
+                ++end;
+            }
+
+            auto ec = executeTable(tableId, [operations, begin, end, &snapshot, results] (Table* table) {
+                table->batchWrite(operations + begin, end - begin, snapshot, results + begin);
+
+                // Only inserts and updates write new values that have to be added to the secondary indexes
+                for (auto i = begin; i < end; ++i) {
+                    auto& op = operations[i];
+                    if (results[i]) {
+                        continue;
+                    }
+                    if (op.type == WriteType::INSERT || op.type == WriteType::UPDATE) {
+                        table->indexes().insert(op.key, op.data, snapshot.version());
+                    } else {
+                        table->indexes().modified(op.key, snapshot.version());
+                    }
+                }
+                return 0;
+            });
+            if (ec) {
+                std::fill(results + begin, results + end, ec);
+            }
+            begin = end;
+        }
+
+        if (!mRedoLog) {
+            return;
+        }
+
+        for (size_t i = 0; i < reserved; ++i) {
+            if (results[i]) {
+                mRedoLog->cancel(redoEntries[i]);
+            } else {
+                mRedoLog->complete(redoEntries[i], redoRecords[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief Reads all tuples whose values of the indexed fields lie in the given range of the secondary index
+     *
+     * The index entries visible in the snapshot are verified against the tuple read from the table: Only entries
+     * written by the version of the tuple visible in the snapshot and matching its values are returned. The tuples are
+     * returned in the order of the index.
+     *
+     * @param lower Encoded lower bound of the range (see Record::indexKey), empty for an open bound
+     * @param upper Encoded upper bound of the range compared on the length of the bound only, empty for an open bound
+     * @param fun The materialization function taking the key, size, version and whether the tuple is the newest one and
+     *   returning a pointer where the result will be written
+     * @return Error code or 0 if the table and index exist
+     */
+    template <typename Fun>
+    int indexScan(uint64_t tableId, const crossbow::string& indexName, const std::string& lower,
+            const std::string& upper, const commitmanager::SnapshotDescriptor& snapshot, Fun fun)
+    {
+        crossbow::allocator _;
+        mVersionManager.addSnapshot(snapshot);
+        return executeTable(tableId, [&indexName, &lower, &upper, &snapshot, &fun] (Table* table) -> int {
+            auto index = table->indexes().find(indexName);
+            if (!index) {
+                return error::invalid_index;
+            }
+
+            std::vector<char> buffer;
+            index->range(lower, upper, [table, index, &snapshot, &fun, &buffer]
+                    (const std::string& indexKey, uint64_t key, uint64_t version) {
+                if (!snapshot.inReadSet(version)) {
+                    return true;
+                }
+
+                uint64_t tupleVersion = 0x0u;
+                bool tupleIsNewest = false;
+                auto ec = table->get(key, snapshot, [&buffer, &tupleVersion, &tupleIsNewest]
+                        (size_t size, uint64_t readVersion, bool isNewest) {
+                    buffer.resize(size);
+                    tupleVersion = readVersion;
+                    tupleIsNewest = isNewest;
+                    return buffer.data();
+                });
+                if (ec || tupleVersion != version
+                        || table->record().indexKey(buffer.data(), index->fields()) != indexKey) {
+                    return true;
+                }
+
+                auto dest = fun(key, buffer.size(), tupleVersion, tupleIsNewest);
+                memcpy(dest, buffer.data(), buffer.size());
+                return true;
+            });
+            return 0;
         });
     }
 
@@ -245,7 +527,258 @@ public:
         mStopCondition.notify_all();
     }
 
+    /**
+     * @brief Runs a garbage collection pass over all tables and blocks until it finished
+     */
+    void runGC() {
+        std::unique_lock<std::mutex> _(mGCMutex);
+        collectGarbage();
+    }
+
 private:
+    /**
+     * @brief Garbage collects all tables and their secondary indexes
+     *
+     * The caller must hold the GC mutex.
+     *
+     * @return The tables that were garbage collected
+     */
+    std::vector<Table*> collectGarbage() {
+        std::vector<Table*> tables;
+        tables.reserve(mNames.size());
+        {
+            typename decltype(mTablesMutex)::scoped_lock _(mTablesMutex, false);
+            for (auto& p : mTables) {
+                tables.push_back(p.second);
+            }
+        }
+        auto minVersion = mVersionManager.lowestActiveVersion();
+        mGC.run(tables, minVersion);
+        for (auto table : tables) {
+            collectIndexes(table, minVersion);
+        }
+        return tables;
+    }
+
+    /**
+     * @brief Serializes the name and schema of a table
+     *
+     * The data consists of the length of the name, the name padded to 8 bytes and the serialized schema.
+     */
+    static std::unique_ptr<char[]> serializeTable(const crossbow::string& name, const Schema& schema, size_t& size) {
+        auto nameLength = crossbow::align(sizeof(uint32_t) + name.size(), sizeof(uint64_t));
+        size = nameLength + schema.serializedLength();
+        std::unique_ptr<char[]> data(new char[size]);
+        memset(data.get(), 0, size);
+        crossbow::buffer_writer writer(data.get(), size);
+        writer.write<uint32_t>(name.size());
+        writer.write(name.data(), name.size());
+        writer.align(sizeof(uint64_t));
+        schema.serialize(writer);
+        return data;
+    }
+
+    /**
+     * @brief Recreates the table with the given ID from its serialized name and schema
+     */
+    template <typename... Args>
+    Table* recreateTable(uint64_t tableId, const char* data, size_t size, Args&... args) {
+        crossbow::buffer_reader reader(data, size);
+        auto nameLength = reader.read<uint32_t>();
+        crossbow::string name(reader.read(nameLength), nameLength);
+        reader.align(sizeof(uint64_t));
+        auto schema = Schema::deserialize(reader);
+
+        // Table IDs are assigned sequentially, reset the counter to recreate the table with the original ID
+        auto lastIdx = mLastTableIdx.load();
+        mLastTableIdx.store(tableId - 1);
+        uint64_t idx;
+        auto res = createTable(name, schema, idx, args...);
+        mLastTableIdx.store(std::max(lastIdx, tableId));
+        if (!res) {
+            LOG_ERROR("Unable to recreate table %1%", name);
+            return nullptr;
+        }
+        return lookupTable(idx);
+    }
+
+    /**
+     * @brief Removes all entries from the secondary indexes of the table that no active snapshot can read
+     *
+     * Every active snapshot reads the newest version of a record not greater than the lowest active version or a
+     * newer one. The entries up to the lowest active version are thus only required if they were written by exactly
+     * this version of the record, all other entries were overwritten, reverted or deleted in the meantime.
+     */
+    void collectIndexes(Table* table, uint64_t minVersion) {
+        if (table->indexes().empty()) {
+            return;
+        }
+
+        // Only entries of records modified by a version not newer than the lowest active version can become obsolete
+        bool all;
+        auto modified = table->indexes().takeModified(minVersion, all);
+        if (modified.empty() && !all) {
+            return;
+        }
+
+        // The snapshot reuses its base version as its own so it does not read the writes of any active transaction
+        crossbow::allocator _;
+        commitmanager::SnapshotDescriptor::BlockType descriptor = 0x0u;
+        auto snapshot = commitmanager::SnapshotDescriptor::create(0x0u, minVersion, minVersion,
+                reinterpret_cast<const char*>(&descriptor));
+
+        std::vector<char> buffer;
+        for (auto& index : table->indexes().indexes()) {
+            auto removed = index.second->removeIf([table, minVersion, all, &modified, &snapshot, &buffer]
+                    (const std::string& /* indexKey */, uint64_t key, uint64_t version) {
+                if (version > minVersion || (!all && modified.count(key) == 0u)) {
+                    return false;
+                }
+
+                uint64_t tupleVersion = 0x0u;
+                auto ec = table->get(key, *snapshot, [&buffer, &tupleVersion]
+                        (size_t size, uint64_t readVersion, bool /* isNewest */) {
+                    buffer.resize(size);
+                    tupleVersion = readVersion;
+                    return buffer.data();
+                });
+                return (ec || tupleVersion != version);
+            });
+            LOG_TRACE("Removed %1% entries from index %2% of table %3%", removed, index.first, table->tableId());
+        }
+    }
+
+    void writeCheckpoint(const std::vector<Table*>& /* tables */, uint64_t /* redoOffset */, std::false_type) {
+    }
+
+    /**
+     * @brief Writes the name, schema and main pages of all tables to the checkpoint file
+     *
+     * The part of the redo log before the given offset is discarded once the checkpoint is complete.
+     */
+    void writeCheckpoint(const std::vector<Table*>& tables, uint64_t redoOffset, std::true_type) {
+        auto path = mConfig.redoLogPath + ".checkpoint";
+        try {
+            crossbow::allocator _;
+            CheckpointWriter writer(path, redoOffset);
+            for (auto table : tables) {
+                size_t size;
+                auto data = serializeTable(table->tableName(), table->schema(), size);
+                writer.write<uint64_t>(table->tableId());
+                writer.write<uint64_t>(size);
+                writer.write(data.get(), size);
+                table->writeCheckpoint(writer);
+                table->indexes().writeCheckpoint(writer);
+            }
+            writer.write<uint64_t>(0x0u);
+            writer.commit();
+        } catch (std::exception& e) {
+            LOG_ERROR("Error while writing checkpoint [error = %1%]", e.what());
+            return;
+        }
+        mRedoLog->discard(redoOffset);
+        LOG_INFO("Wrote checkpoint of %1% tables [redoOffset = %2%]", tables.size(), redoOffset);
+    }
+
+    template <typename... Args>
+    uint64_t readCheckpoint(std::false_type, Args&... /* args */) {
+        if (mConfig.checkpointInterval != 0u) {
+            LOG_WARN("Checkpoints are not supported by this storage implementation");
+        }
+        return 0x0u;
+    }
+
+    /**
+     * @brief Recreates all tables from the checkpoint file
+     *
+     * @return Offset in the redo log from which on the redo log has to be replayed
+     */
+    template <typename... Args>
+    uint64_t readCheckpoint(std::true_type, Args&... args) {
+        CheckpointReader reader(mConfig.redoLogPath + ".checkpoint");
+        if (!reader.isOpen()) {
+            return 0x0u;
+        }
+
+        size_t count = 0u;
+        while (auto tableId = reader.read<uint64_t>()) {
+            auto size = reader.read<uint64_t>();
+            std::unique_ptr<char[]> data(new char[size]);
+            reader.read(data.get(), size);
+
+            auto table = recreateTable(tableId, data.get(), size, args...);
+            if (!table || !table->readCheckpoint(reader)) {
+                throw std::runtime_error("Unable to restore table from checkpoint");
+            }
+            table->indexes().readCheckpoint(reader);
+            ++count;
+        }
+        LOG_INFO("Restored %1% tables from checkpoint [redoOffset = %2%]", count, reader.redoOffset());
+        return reader.redoOffset();
+    }
+
+    template <typename... Args>
+    void replayRecord(RedoRecordType type, const RedoLogEntry& record, uint32_t size, Args&... args) {
+        if (type == RedoRecordType::CREATE_TABLE) {
+            // The table might have been created before the checkpoint was written
+            if (!lookupTable(record.tableId)) {
+                recreateTable(record.tableId, record.data(), size, args...);
+            }
+            return;
+        }
+
+        auto table = lookupTable(record.tableId);
+        if (!table) {
+            LOG_ERROR("Redo log record for unknown table %1%", record.tableId);
+            return;
+        }
+
+        // Replay the modification with a snapshot that can read all previous versions
+        commitmanager::SnapshotDescriptor::BlockType descriptor = 0x0u;
+        auto snapshot = commitmanager::SnapshotDescriptor::create(0x0u, record.version - 1, record.version,
+                reinterpret_cast<const char*>(&descriptor));
+
+        int ec = 0;
+        switch (type) {
+        case RedoRecordType::INSERT: {
+            ec = table->insert(record.key, size, record.data(), *snapshot);
+            if (!ec) {
+                table->indexes().insert(record.key, record.data(), record.version);
+            }
+        } break;
+
+        case RedoRecordType::UPDATE: {
+            ec = table->update(record.key, size, record.data(), *snapshot);
+            if (!ec) {
+                table->indexes().insert(record.key, record.data(), record.version);
+            }
+        } break;
+
+        case RedoRecordType::REMOVE: {
+            ec = table->remove(record.key, *snapshot);
+            if (!ec) {
+                table->indexes().modified(record.key, record.version);
+            }
+        } break;
+
+        case RedoRecordType::REVERT: {
+            ec = table->revert(record.key, *snapshot);
+            if (!ec) {
+                table->indexes().modified(record.key, record.version);
+            }
+        } break;
+
+        default: {
+            LOG_ERROR("Unknown redo log record type %1%", crossbow::to_underlying(type));
+        } break;
+        }
+
+        if (ec) {
+            LOG_DEBUG("Replaying redo log record failed [table = %1%, key = %2%, error = %3%]", record.tableId,
+                    record.key, ec);
+        }
+    }
+
     const Table* lookupTable(uint64_t tableId) const {
         typename decltype(mTablesMutex)::scoped_lock _(mTablesMutex, false);
         auto i = mTables.find(tableId);
@@ -256,6 +789,47 @@ private:
         return const_cast<Table*>(const_cast<const TableManager*>(this)->lookupTable(tableId));
     }
 
+    static RedoRecordType redoRecordType(WriteType type) {
+        switch (type) {
+        case WriteType::INSERT:
+            return RedoRecordType::INSERT;
+        case WriteType::UPDATE:
+            return RedoRecordType::UPDATE;
+        case WriteType::REMOVE:
+            return RedoRecordType::REMOVE;
+        default:
+            return RedoRecordType::REVERT;
+        }
+    }
+
+    /**
+     * @brief Executes the modification on the table after reserving its redo record
+     *
+     * A modification whose record can not be reserved is not executed, the record of a failed modification is
+     * cancelled.
+     *
+     * @return Error code or 0 if the modification succeeded
+     */
+    template <typename Fun>
+    int executeLogged(const RedoRecord& record, Fun fun) {
+        if (!mRedoLog) {
+            return executeTable(record.tableId, std::move(fun));
+        }
+
+        auto redoEntry = mRedoLog->reserve(record);
+        if (!redoEntry) {
+            return error::out_of_memory;
+        }
+
+        auto ec = executeTable(record.tableId, std::move(fun));
+        if (ec) {
+            mRedoLog->cancel(redoEntry);
+        } else {
+            mRedoLog->complete(redoEntry, record);
+        }
+        return ec;
+    }
+
     template <typename Fun>
     int executeTable(uint64_t tableId, Fun fun) {
         auto table = lookupTable(tableId);
@@ -0,0 +1,57 @@
+/*
+ * (C) Copyright 2015 ETH Zurich Systems Group (http://www.systems.ethz.ch/) and others.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Contributors:
+ *     Markus Pilman <mpilman@inf.ethz.ch>
+ *     Simon Loesing <sloesing@inf.ethz.ch>
+ *     Thomas Etter <etterth@gmail.com>
+ *     Kevin Bocksrocker <kevin.bocksrocker@gmail.com>
+ *     Lucas Braun <braunl@inf.ethz.ch>
+ */
+
+#pragma once
+
+#include <tellstore/StdTypes.hpp>
+
+#include <cstdint>
+
+namespace tell {
+namespace store {
+
+/**
+ * @brief A single modification executed as part of a batch write
+ */
+struct WriteOperation {
+    WriteOperation(WriteType ty, uint64_t t, uint64_t k, uint32_t s, const char* d)
+            : type(ty),
+              tableId(t),
+              key(k),
+              size(s),
+              data(d) {
+    }
+
+    WriteType type;
+    uint64_t tableId;
+    uint64_t key;
+
+    /// Size of the tuple's data (0 for remove and revert)
+    uint32_t size;
+
+    /// The tuple's data (null for remove and revert)
+    const char* data;
+};
+
+} // namespace store
+} // namespace tell